@@ -9,14 +9,26 @@ typedef int MPI_Comm;
 typedef int MPI_Datatype;
 typedef int MPI_Status;
 typedef int MPI_Fint;
+typedef intptr_t MPI_Aint;
+typedef int MPI_Request;
+typedef int MPI_Op;
 
 #define MPI_STATUS_IGNORE 0
+#define MPI_REQUEST_NULL 0
 #define MPI_COMM_WORLD 0
 #define MPI_COMM_NULL 1
+#define MPI_ANY_SOURCE -1
+#define MPI_MAX 1
 #define MPI_INT 1
 #define MPI_DOUBLE 4
 #define MPI_CHAR 5
 #define MPI_BYTE 6
+#define MPI_FLOAT 7
+#define MPI_INT64_T 8
+#define MPI_INT8_T 9
+#define MPI_IDENT 0
+#define MPI_CONGRUENT 1
+#define MPI_UNEQUAL 3
 
 static int MPI_Init( int *argc, char ***argv) { return 0;};
 static int MPI_Initialized( int *flag ) { *flag = 0; return 0;};
@@ -27,6 +39,9 @@ static int MPI_Comm_rank( MPI_Comm comm, int *rank ) { return 0; };
 static int MPI_Comm_size( MPI_Comm comm, int *size ) { return 0; };
 
 static int MPI_Barrier(MPI_Comm comm) { return 0; };
+static int MPI_Bcast(void *buffer, int count, MPI_Datatype datatype, int root, MPI_Comm comm) { return 0; };
+static int MPI_Allreduce(const void *sendbuf, void *recvbuf, int count, MPI_Datatype datatype,
+               MPI_Op op, MPI_Comm comm) { return 0; };
 static int MPI_Gather(const void *sendbuf, int sendcount, MPI_Datatype sendtype,
                void *recvbuf, int recvcount, MPI_Datatype recvtype,
                int root, MPI_Comm comm) { return 0; };
@@ -38,7 +53,22 @@ static int MPI_Send(const void *buf, int count, MPI_Datatype datatype, int dest,
 static int MPI_Recv(void *buf, int count, MPI_Datatype datatype, int source, int tag,
              MPI_Comm comm, MPI_Status *status) { return 0; };
 static int MPI_Comm_split(MPI_Comm comm, int color, int key, MPI_Comm *newcomm) { return 0; };
+static int MPI_Comm_dup(MPI_Comm comm, MPI_Comm *newcomm) { *newcomm = comm; return 0; };
+static int MPI_Comm_free(MPI_Comm *comm) { return 0; };
+static int MPI_Comm_compare(MPI_Comm comm1, MPI_Comm comm2, int *result) { *result = MPI_IDENT; return 0; };
 static MPI_Comm MPI_Comm_f2c( MPI_Fint comm ) { return comm; };
 static MPI_Fint MPI_Comm_c2f( MPI_Comm comm ) { return comm; };
+static int MPI_Type_contiguous(int count, MPI_Datatype oldtype, MPI_Datatype *newtype) { return 0; };
+static int MPI_Type_create_hvector(int count, int blocklength, MPI_Aint stride, MPI_Datatype oldtype,
+             MPI_Datatype *newtype) { return 0; };
+static int MPI_Type_commit(MPI_Datatype *datatype) { return 0; };
+static int MPI_Type_free(MPI_Datatype *datatype) { return 0; };
+static int MPI_Send_init(const void *buf, int count, MPI_Datatype datatype, int dest, int tag,
+             MPI_Comm comm, MPI_Request *request) { return 0; };
+static int MPI_Recv_init(void *buf, int count, MPI_Datatype datatype, int source, int tag,
+             MPI_Comm comm, MPI_Request *request) { return 0; };
+static int MPI_Start(MPI_Request *request) { return 0; };
+static int MPI_Wait(MPI_Request *request, MPI_Status *status) { return 0; };
+static int MPI_Request_free(MPI_Request *request) { return 0; };
 
 #endif
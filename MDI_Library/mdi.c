@@ -29,15 +29,21 @@ Contents:
 #include "mdi.h"
 #include "mdi_global.h"
 #include "mdi_general.h"
+#include "mdi_custom.h"
+#include "mdi_filter.h"
 #include "mdi_mpi.h"
 #include "mdi_lib.h"
+#include "mdi_async.h"
+#include "mdi_ensemble.h"
+#include "mdi_request.h"
+#include "mdi_units.h"
 #include "physconst.h"
 
 /*! \brief MDI major version number */
 const int MDI_MAJOR_VERSION = 1;
 
 /*! \brief MDI minor version number */
-const int MDI_MINOR_VERSION = 2;
+const int MDI_MINOR_VERSION = 3;
 
 /*! \brief MDI patch version number */
 const int MDI_PATCH_VERSION = 0;
@@ -54,6 +60,12 @@ const int MDI_LABEL_LENGTH = 64;
 /*! \brief value of a null communicator */
 const MDI_Comm MDI_COMM_NULL = 0;
 
+/*! \brief value of a null persistent request */
+const MDI_Request MDI_REQUEST_NULL = 0;
+
+/*! \brief value of the default context */
+const MDI_Context MDI_CONTEXT_DEFAULT = 0;
+
 // MDI data types
 /*! \brief integer data type */
 const int MDI_INT          = 1;
@@ -63,6 +75,14 @@ const int MDI_DOUBLE       = 2;
 const int MDI_CHAR         = 3;
 /*! \brief character data type */
 const int MDI_BYTE         = 6;
+/*! \brief single precision float data type */
+const int MDI_FLOAT        = 7;
+/*! \brief 64-bit integer data type */
+const int MDI_INT64        = 8;
+/*! \brief 8-bit integer data type */
+const int MDI_INT8         = 9;
+/*! \brief double precision complex data type */
+const int MDI_COMPLEX_DOUBLE = 10;
 
 // MDI communication types
 /*! \brief TCP/IP communication method */
@@ -80,6 +100,20 @@ const int MDI_DRIVER    = 1;
 /*! \brief Engine role type */
 const int MDI_ENGINE    = 2;
 
+// plugin cache modes
+/*! \brief Plugins are unloaded after each launch */
+const int MDI_PLUGIN_UNLOAD    = 0;
+/*! \brief Plugins remain loaded between launches, but are initialized by each launch */
+const int MDI_PLUGIN_RESIDENT  = 1;
+/*! \brief Plugins remain loaded between launches, and their engine persists from one launch to the next */
+const int MDI_PLUGIN_KEEPALIVE = 2;
+
+// asynchronous plugin modes
+/*! \brief Asynchronous plugins run on worker threads */
+const int MDI_ASYNC_THREAD    = 0;
+/*! \brief Asynchronous plugins run as coroutines on the thread of their driver */
+const int MDI_ASYNC_COROUTINE = 1;
+
 
 /*! \brief Initialize communication through the MDI library
  *
@@ -102,7 +136,7 @@ int MDI_Init(const char* options, void* world_comm)
   */
   int ret = general_init(options, world_comm);
   if ( ret == 0 ) {
-    is_initialized = 1;
+    active_context->is_initialized = 1;
   }
   return ret;
 }
@@ -128,7 +162,7 @@ MDI_Comm MDI_Accept_Communicator(MDI_Comm* comm)
  */
 MDI_Comm MDI_Accept_communicator(MDI_Comm* comm)
 {
-  if ( is_initialized == 0 ) {
+  if ( active_context->is_initialized == 0 ) {
     mdi_error("MDI_Accept_Communicator called but MDI has not been initialized");
     return 1;
   }
@@ -153,11 +187,15 @@ MDI_Comm MDI_Accept_communicator(MDI_Comm* comm)
  */
 int MDI_Send(const void* buf, int count, MDI_Datatype datatype, MDI_Comm comm)
 {
-  if ( is_initialized == 0 ) {
+  if ( active_context->is_initialized == 0 ) {
     mdi_error("MDI_Send called but MDI has not been initialized");
     return 1;
   }
-  return general_send(buf, count, datatype, comm);
+  if ( count < 0 ) {
+    mdi_error("MDI_Send called with a negative count");
+    return 1;
+  }
+  return general_send(buf, (size_t)count, datatype, comm);
 }
 
 
@@ -177,238 +215,738 @@ int MDI_Send(const void* buf, int count, MDI_Datatype datatype, MDI_Comm comm)
  */
 int MDI_Recv(void* buf, int count, MDI_Datatype datatype, MDI_Comm comm)
 {
-  if ( is_initialized == 0 ) {
+  if ( active_context->is_initialized == 0 ) {
     mdi_error("MDI_Recv called but MDI has not been initialized");
     return 1;
   }
-  return general_recv(buf, count, datatype, comm);
+  if ( count < 0 ) {
+    mdi_error("MDI_Recv called with a negative count");
+    return 1;
+  }
+  return general_recv(buf, (size_t)count, datatype, comm);
 }
 
 
-/*! \brief Send a command of length \p MDI_COMMAND_LENGTH through the MDI connection
+/*! \brief Send data through the MDI connection, using a 64-bit count
  *
+ * This function is identical to MDI_Send(), except that \p count may exceed the range of an int.
+ * Messages with more than \p INT_MAX elements can only be sent to codes that use MDI version 1.3
+ * or higher.
  * If running with MPI, this function must be called only by rank \p 0.
  * The function returns \p 0 on a success.
  *
  * \param [in]       buf
  *                   Pointer to the data to be sent.
+ * \param [in]       count
+ *                   Number of values (integers, double precision floats, characters, etc.) to be sent.
+ * \param [in]       datatype
+ *                   MDI handle (MDI_INT, MDI_DOUBLE, MDI_CHAR, etc.) corresponding to the type of data to be sent.
  * \param [in]       comm
  *                   MDI communicator associated with the intended recipient code.
  */
-int MDI_Send_Command(const char* buf, MDI_Comm comm)
+int MDI_Send_c(const void* buf, int64_t count, MDI_Datatype datatype, MDI_Comm comm)
 {
-  return MDI_Send_command(buf, comm);
+  if ( active_context->is_initialized == 0 ) {
+    mdi_error("MDI_Send_c called but MDI has not been initialized");
+    return 1;
+  }
+  if ( count < 0 || (uint64_t)count > SIZE_MAX ) {
+    mdi_error("MDI_Send_c called with an invalid count");
+    return 1;
+  }
+  return general_send(buf, (size_t)count, datatype, comm);
 }
 
 
-/*! \brief Send a command of length \p MDI_COMMAND_LENGTH through the MDI connection
+/*! \brief Receive data through the MDI connection, using a 64-bit count
  *
+ * This function is identical to MDI_Recv(), except that \p count may exceed the range of an int.
  * If running with MPI, this function must be called only by rank \p 0.
  * The function returns \p 0 on a success.
  *
  * \param [in]       buf
- *                   Pointer to the data to be sent.
+ *                   Pointer to the buffer where the received data will be stored.
+ * \param [in]       count
+ *                   Number of values (integers, double precision floats, characters, etc.) to be received.
+ * \param [in]       datatype
+ *                   MDI handle (MDI_INT, MDI_DOUBLE, MDI_CHAR, etc.) corresponding to the type of data to be received.
  * \param [in]       comm
- *                   MDI communicator associated with the intended recipient code.
+ *                   MDI communicator associated with the connection to the sending code.
  */
-int MDI_Send_command(const char* buf, MDI_Comm comm)
+int MDI_Recv_c(void* buf, int64_t count, MDI_Datatype datatype, MDI_Comm comm)
 {
-  if ( is_initialized == 0 ) {
-    mdi_error("MDI_Send_Command called but MDI has not been initialized");
+  if ( active_context->is_initialized == 0 ) {
+    mdi_error("MDI_Recv_c called but MDI has not been initialized");
     return 1;
   }
-  return general_send_command(buf, comm);
+  if ( count < 0 || (uint64_t)count > SIZE_MAX ) {
+    mdi_error("MDI_Recv_c called with an invalid count");
+    return 1;
+  }
+  return general_recv(buf, (size_t)count, datatype, comm);
 }
 
 
-/*! \brief Receive a command of length \p MDI_COMMAND_LENGTH through the MDI connection
+/*! \brief Send a strided array through the MDI connection
  *
+ * The array is described by the extent of each of its dimensions and the distance in memory,
+ * in bytes, between consecutive elements of each dimension.
+ * Dimensions are listed from the slowest-varying to the fastest-varying.
+ * The elements are sent in that order, so the message is identical to the one sent by MDI_Send()
+ * for the equivalent contiguous array, and may be received by either MDI_Recv() or MDI_Recv_strided().
  * If running with MPI, this function must be called only by rank \p 0.
  * The function returns \p 0 on a success.
  *
  * \param [in]       buf
- *                   Pointer to the buffer where the received data will be stored.
+ *                   Pointer to the first element of the array.
+ * \param [in]       ndims
+ *                   Number of dimensions of the array.
+ * \param [in]       shape
+ *                   Extent of each dimension of the array.
+ * \param [in]       strides
+ *                   Distance in memory, in bytes, between consecutive elements of each dimension.
+ * \param [in]       datatype
+ *                   MDI handle (MDI_INT, MDI_DOUBLE, MDI_CHAR, etc.) corresponding to the type of data to be sent.
  * \param [in]       comm
- *                   MDI communicator associated with the connection to the sending code.
+ *                   MDI communicator associated with the intended recipient code.
  */
-int MDI_Recv_Command(char* buf, MDI_Comm comm)
+int MDI_Send_strided(const void* buf, int ndims, const int64_t* shape, const int64_t* strides,
+                     MDI_Datatype datatype, MDI_Comm comm)
 {
-  return MDI_Recv_command(buf, comm);
+  if ( active_context->is_initialized == 0 ) {
+    mdi_error("MDI_Send_strided called but MDI has not been initialized");
+    return 1;
+  }
+  strided_desc desc;
+  if ( strided_init(&desc, ndims, shape, strides, datatype) != 0 ) {
+    return 1;
+  }
+  return general_send_strided(buf, &desc, datatype, comm);
 }
 
 
-/*! \brief Receive a command of length \p MDI_COMMAND_LENGTH through the MDI connection
+/*! \brief Receive data through the MDI connection into a strided array
  *
+ * The layout of the array is described as for MDI_Send_strided().
+ * The message may have been sent by either MDI_Send() or MDI_Send_strided().
  * If running with MPI, this function must be called only by rank \p 0.
  * The function returns \p 0 on a success.
  *
- * \param [in]       buf
- *                   Pointer to the buffer where the received data will be stored.
+ * \param [out]      buf
+ *                   Pointer to the first element of the array.
+ * \param [in]       ndims
+ *                   Number of dimensions of the array.
+ * \param [in]       shape
+ *                   Extent of each dimension of the array.
+ * \param [in]       strides
+ *                   Distance in memory, in bytes, between consecutive elements of each dimension.
+ * \param [in]       datatype
+ *                   MDI handle (MDI_INT, MDI_DOUBLE, MDI_CHAR, etc.) corresponding to the type of data to be received.
  * \param [in]       comm
  *                   MDI communicator associated with the connection to the sending code.
  */
-int MDI_Recv_command(char* buf, MDI_Comm comm)
+int MDI_Recv_strided(void* buf, int ndims, const int64_t* shape, const int64_t* strides,
+                     MDI_Datatype datatype, MDI_Comm comm)
 {
-  if ( is_initialized == 0 ) {
-    mdi_error("MDI_Recv_Command called but MDI has not been initialized");
+  if ( active_context->is_initialized == 0 ) {
+    mdi_error("MDI_Recv_strided called but MDI has not been initialized");
     return 1;
   }
-  return general_recv_command(buf, comm);
+  strided_desc desc;
+  if ( strided_init(&desc, ndims, shape, strides, datatype) != 0 ) {
+    return 1;
+  }
+  return general_recv_strided(buf, &desc, datatype, comm);
 }
 
 
-/*! \brief Determine the conversion factor between two units
+/*! \brief Send several arrays through the MDI connection as a single message
  *
- * The function determines the conversion factor from \p in_unit to \p out_unit.
- * The function requires that \p in_unit and \p out_unit be members of the same category of unit (\em i.e. charge, energy, force, etc.).
- * For example, calling \p MDI_Conversion_Factor(\p "kilojoule_per_mol",\p "atomic_unit_of_energy") will return the conversion factor from kilojoule/mol to hartrees.
+ * Each segment of the message is described by a buffer, a count, and a datatype.
+ * The segments are sent together, with a single header, and must be received by a
+ * matching call to MDI_Recvv().
+ * At most 64 segments may be sent in a single message.
+ * If running with MPI, this function must be called only by rank \p 0.
  * The function returns \p 0 on a success.
  *
- * All quantities communicated through MDI must be represented using atomic units.
- * When unit conversions are necessary, this function should be used to obtain the conversion factors, as this will ensure that all drivers and engines use conversion factors that are self-consistent across codes.
- * Use of conversion factors that are not self-consistent can result in numerical instabilities.
+ * \param [in]       nseg
+ *                   Number of segments in the message.
+ * \param [in]       bufs
+ *                   Pointer to the data of each segment.
+ * \param [in]       counts
+ *                   Number of values (integers, double precision floats, characters, etc.) in each segment.
+ * \param [in]       datatypes
+ *                   MDI handle (MDI_INT, MDI_DOUBLE, MDI_CHAR, etc.) of each segment.
+ * \param [in]       comm
+ *                   MDI communicator associated with the intended recipient code.
+ */
+int MDI_Sendv(int nseg, const void* const* bufs, const int64_t* counts, const MDI_Datatype* datatypes,
+              MDI_Comm comm)
+{
+  if ( active_context->is_initialized == 0 ) {
+    mdi_error("MDI_Sendv called but MDI has not been initialized");
+    return 1;
+  }
+  if ( nseg < 1 || nseg > MDI_VECTOR_MAX_SEGMENTS ) {
+    mdi_error("MDI_Sendv called with an invalid number of segments");
+    return 1;
+  }
+  size_t counts_t[MDI_VECTOR_MAX_SEGMENTS];
+  int iseg;
+  for ( iseg = 0; iseg < nseg; iseg++ ) {
+    if ( counts[iseg] < 0 || (uint64_t)counts[iseg] > SIZE_MAX ) {
+      mdi_error("MDI_Sendv called with an invalid count");
+      return 1;
+    }
+    counts_t[iseg] = (size_t)counts[iseg];
+  }
+  return general_sendv(nseg, bufs, counts_t, datatypes, comm);
+}
+
+
+/*! \brief Receive several arrays through the MDI connection as a single message
  *
- * The following is a list of the unit categories, along with the names of the units associated with each category:
+ * The number of segments, and the count and datatype of each segment, must agree with those
+ * passed to the corresponding call to MDI_Sendv().
+ * If running with MPI, this function must be called only by rank \p 0.
+ * The function returns \p 0 on a success.
  *
- * - charge
- *    - atomic_unit_of_charge
- *    - coulomb
- * - energy
- *    - atomic_unit_of_energy
- *    - calorie
- *    - electron_volt
- *    - hartree
- *    - inverse_meter_energy
- *    - joule
- *    - kelvin_energy
- *    - kilocalorie
- *    - kilocalorie_per_mol
- *    - kilojoule
- *    - kilojoule_per_mol
- *    - rydberg
- * - force
- *    - atomic_unit_of_force
- *    - newton
- * - length
- *    - angstrom
- *    - atomic_unit_of_length
- *    - bohr
- *    - meter
- *    - nanometer
- *    - picometer
- * - mass
- *    - atomic_mass_unit
- *    - atomic_unit_of_mass
- *    - gram
- *    - kilogram
- * - time
- *    - atomic_unit_of_time
- *    - picosecond
- *    - second
+ * \param [in]       nseg
+ *                   Number of segments in the message.
+ * \param [out]      bufs
+ *                   Pointer to the buffer where each segment will be stored.
+ * \param [in]       counts
+ *                   Number of values (integers, double precision floats, characters, etc.) in each segment.
+ * \param [in]       datatypes
+ *                   MDI handle (MDI_INT, MDI_DOUBLE, MDI_CHAR, etc.) of each segment.
+ * \param [in]       comm
+ *                   MDI communicator associated with the connection to the sending code.
+ */
+int MDI_Recvv(int nseg, void* const* bufs, const int64_t* counts, const MDI_Datatype* datatypes,
+              MDI_Comm comm)
+{
+  if ( active_context->is_initialized == 0 ) {
+    mdi_error("MDI_Recvv called but MDI has not been initialized");
+    return 1;
+  }
+  if ( nseg < 1 || nseg > MDI_VECTOR_MAX_SEGMENTS ) {
+    mdi_error("MDI_Recvv called with an invalid number of segments");
+    return 1;
+  }
+  size_t counts_t[MDI_VECTOR_MAX_SEGMENTS];
+  int iseg;
+  for ( iseg = 0; iseg < nseg; iseg++ ) {
+    if ( counts[iseg] < 0 || (uint64_t)counts[iseg] > SIZE_MAX ) {
+      mdi_error("MDI_Recvv called with an invalid count");
+      return 1;
+    }
+    counts_t[iseg] = (size_t)counts[iseg];
+  }
+  return general_recvv(nseg, bufs, counts_t, datatypes, comm);
+}
+
+
+/*! \brief Create a persistent request for sending data through the MDI connection
  *
- * All conversion factors were acquired from the <a href="https://physics.nist.gov/cuu/Constants/Table/allascii.txt">NIST CODATA</a>, 
- * except the conversion factors for calorie, kilocalorie, and kilocalorie_per_mol, which were obtained from the <a href="https://www.nist.gov/pml/nist-guide-si-appendix-b9-factors-units-listed-kind-quantity-or-field-science"> NIST Guide to the SI</a>.
+ * The buffer, count, datatype, and communicator are bound to the request, so that the same
+ * message can be sent repeatedly by calling MDI_Start().
+ * Each call to MDI_Start() sends the current contents of \p buf, and is matched by an ordinary
+ * call to MDI_Recv() or by a persistent receive request.
+ * If running with MPI, this function must be called only by rank \p 0.
+ * The function returns \p 0 on a success.
  *
- * \param [in]       in_unit
- *                   Name of the unit to convert from.
- * \param [in]       out_unit
- *                   Name of the unit to convert to.
- * \param [out]      conv
- *                   Conversion factor from in_unit to out_unit
+ * \param [in]       buf
+ *                   Pointer to the data to be sent.
+ * \param [in]       count
+ *                   Number of values (integers, double precision floats, characters, etc.) to be sent.
+ * \param [in]       datatype
+ *                   MDI handle (MDI_INT, MDI_DOUBLE, MDI_CHAR, etc.) corresponding to the type of data to be sent.
+ * \param [in]       comm
+ *                   MDI communicator associated with the intended recipient code.
+ * \param [out]      request
+ *                   Handle of the new persistent request.
  */
-int MDI_Conversion_Factor(const char* in_unit, const char* out_unit, double* conv)
+int MDI_Send_init(const void* buf, int64_t count, MDI_Datatype datatype, MDI_Comm comm,
+                  MDI_Request* request)
 {
-  return MDI_Conversion_factor(in_unit, out_unit, conv);
+  if ( active_context->is_initialized == 0 ) {
+    mdi_error("MDI_Send_init called but MDI has not been initialized");
+    return 1;
+  }
+  if ( count < 0 || (uint64_t)count > SIZE_MAX ) {
+    mdi_error("MDI_Send_init called with an invalid count");
+    return 1;
+  }
+  return request_init((void*)buf, (size_t)count, datatype, comm, 1, request);
 }
 
 
-/*! \brief Determine the conversion factor between two units
+/*! \brief Create a persistent request for receiving data through the MDI connection
  *
- * The function determines the conversion factor from \p in_unit to \p out_unit.
- * The function requires that \p in_unit and \p out_unit be members of the same category of unit (\em i.e. charge, energy, force, etc.).
- * For example, calling \p MDI_Conversion_Factor(\p "kilojoule_per_mol",\p "atomic_unit_of_energy") will return the conversion factor from kilojoule/mol to hartrees.
+ * The buffer, count, datatype, and communicator are bound to the request, so that the same
+ * message can be received repeatedly by calling MDI_Start().
+ * If running with MPI, this function must be called only by rank \p 0.
  * The function returns \p 0 on a success.
  *
- * All quantities communicated through MDI must be represented using atomic units.
- * When unit conversions are necessary, this function should be used to obtain the conversion factors, as this will ensure that all drivers and engines use conversion factors that are self-consistent across codes.
- * Use of conversion factors that are not self-consistent can result in numerical instabilities.
+ * \param [in]       buf
+ *                   Pointer to the buffer where the received data will be stored.
+ * \param [in]       count
+ *                   Number of values (integers, double precision floats, characters, etc.) to be received.
+ * \param [in]       datatype
+ *                   MDI handle (MDI_INT, MDI_DOUBLE, MDI_CHAR, etc.) corresponding to the type of data to be received.
+ * \param [in]       comm
+ *                   MDI communicator associated with the connection to the sending code.
+ * \param [out]      request
+ *                   Handle of the new persistent request.
+ */
+int MDI_Recv_init(void* buf, int64_t count, MDI_Datatype datatype, MDI_Comm comm,
+                  MDI_Request* request)
+{
+  if ( active_context->is_initialized == 0 ) {
+    mdi_error("MDI_Recv_init called but MDI has not been initialized");
+    return 1;
+  }
+  if ( count < 0 || (uint64_t)count > SIZE_MAX ) {
+    mdi_error("MDI_Recv_init called with an invalid count");
+    return 1;
+  }
+  return request_init(buf, (size_t)count, datatype, comm, 0, request);
+}
+
+
+/*! \brief Perform the send or receive described by a persistent request
  *
- * The following is a list of the unit categories, along with the names of the units associated with each category:
+ * Unlike MPI_Start, this function is blocking: it returns once the transfer has completed.
+ * If running with MPI, this function must be called only by rank \p 0.
+ * The function returns \p 0 on a success.
  *
- * - charge
- *    - atomic_unit_of_charge
- *    - coulomb
- * - energy
- *    - atomic_unit_of_energy
- *    - calorie
- *    - electron_volt
- *    - hartree
- *    - inverse_meter_energy
- *    - joule
- *    - kelvin_energy
- *    - kilocalorie
- *    - kilocalorie_per_mol
- *    - kilojoule
- *    - kilojoule_per_mol
- *    - rydberg
- * - force
- *    - atomic_unit_of_force
- *    - newton
- * - length
- *    - angstrom
- *    - atomic_unit_of_length
- *    - bohr
- *    - meter
- *    - nanometer
- *    - picometer
- * - mass
- *    - atomic_mass_unit
- *    - atomic_unit_of_mass
- *    - gram
- *    - kilogram
- * - time
- *    - atomic_unit_of_time
- *    - picosecond
- *    - second
+ * \param [in]       request
+ *                   Handle of a request created by MDI_Send_init() or MDI_Recv_init().
+ */
+int MDI_Start(MDI_Request request)
+{
+  if ( active_context->is_initialized == 0 ) {
+    mdi_error("MDI_Start called but MDI has not been initialized");
+    return 1;
+  }
+  return request_start(request);
+}
+
+
+/*! \brief Free a persistent request
  *
- * All conversion factors were acquired from the <a href="https://physics.nist.gov/cuu/Constants/Table/allascii.txt">NIST CODATA</a>, 
- * except the conversion factors for calorie, kilocalorie, and kilocalorie_per_mol, which were obtained from the <a href="https://www.nist.gov/pml/nist-guide-si-appendix-b9-factors-units-listed-kind-quantity-or-field-science"> NIST Guide to the SI</a>.
+ * The function returns \p 0 on a success.
  *
- * \param [in]       in_unit
- *                   Name of the unit to convert from.
- * \param [in]       out_unit
- *                   Name of the unit to convert to.
- * \param [out]      conv
- *                   Conversion factor from in_unit to out_unit
+ * \param [in,out]   request
+ *                   Handle of the request, which is set to \p MDI_REQUEST_NULL.
  */
-int MDI_Conversion_factor(const char* in_unit, const char* out_unit, double* conv)
+int MDI_Request_free(MDI_Request* request)
 {
-  // Except where otherwise noted, all values are from:
-  //   - https://physics.nist.gov/cuu/Constants/Table/allascii.txt
-
-  // mass
-  double atomic_unit_of_mass = 1.0;
-  double kilogram = 1.0 / pc_atomic_unit_of_mass;
-  double gram = kilogram / 1000.0;
-  double atomic_mass_unit = kilogram * pc_atomic_mass_unit_kilogram_relationship;
+  if ( active_context->is_initialized == 0 ) {
+    mdi_error("MDI_Request_free called but MDI has not been initialized");
+    return 1;
+  }
+  return request_free(request);
+}
 
-  // charge
-  double atomic_unit_of_charge = 1.0;
-  double coulomb = 1.0 / pc_atomic_unit_of_charge;
 
-  // energy
-  double atomic_unit_of_energy = 1.0;
-  double hartree = 1.0;
-  double joule = 1.0 / pc_atomic_unit_of_energy;
-  double kilojoule = joule * 1000.0;
-  double kilojoule_per_mol = 1.0 / pc_hartree2kJmol;
-  double calorie = joule * pc_calorie_joule_relationship;
-  double kilocalorie = calorie * 1000.0;
-  double kilocalorie_per_mol = 1.0 / pc_hartree2kcalmol;
-  double electron_volt = pc_electron_volt_hartree_relationship;
-  double rydberg = electron_volt * pc_Rydberg_constant_times_hc_in_eV;
-  double kelvin_energy = pc_kelvin_hartree_relationship;
-  double inverse_meter_energy = pc_inverse_meter_hartree_relationship;
+/*! \brief Send data that is produced in chunks by a callback
+ *
+ * Instead of reading the data from a buffer, this function calls \p producer for each
+ * consecutive chunk of at most \p chunk_size values.
+ * The producer is passed a buffer to fill, the offset of the chunk within the message and the
+ * number of values in the chunk, both counted in values, and \p ctx, and returns \p 0 on a
+ * success.
+ * The message is identical to the one sent by MDI_Send_c(), and may be received by
+ * MDI_Recv_c() or MDI_Recv_stream().
+ * If running with MPI, this function must be called only by rank \p 0.
+ * The function returns \p 0 on a success.
+ *
+ * \param [in]       count
+ *                   Number of values (integers, double precision floats, characters, etc.) to be sent.
+ * \param [in]       datatype
+ *                   MDI handle (MDI_INT, MDI_DOUBLE, MDI_CHAR, etc.) corresponding to the type of data to be sent.
+ * \param [in]       chunk_size
+ *                   Largest number of values passed to a single call of \p producer.
+ * \param [in]       producer
+ *                   Function that fills each chunk of the message.
+ * \param [in]       ctx
+ *                   Pointer passed to each call of \p producer.
+ * \param [in]       comm
+ *                   MDI communicator associated with the intended recipient code.
+ */
+int MDI_Send_stream(int64_t count, MDI_Datatype datatype, int64_t chunk_size,
+                    MDI_Stream_callback_t producer, void* ctx, MDI_Comm comm)
+{
+  if ( active_context->is_initialized == 0 ) {
+    mdi_error("MDI_Send_stream called but MDI has not been initialized");
+    return 1;
+  }
+  if ( count < 0 || (uint64_t)count > SIZE_MAX ) {
+    mdi_error("MDI_Send_stream called with an invalid count");
+    return 1;
+  }
+  if ( chunk_size < 1 || (uint64_t)chunk_size > SIZE_MAX ) {
+    mdi_error("MDI_Send_stream called with an invalid chunk size");
+    return 1;
+  }
+  return general_send_stream((size_t)count, datatype, (size_t)chunk_size, producer, ctx, comm);
+}
+
+
+/*! \brief Receive data that is delivered in chunks to a callback
+ *
+ * Instead of storing the data in a buffer, this function calls \p consumer for each
+ * consecutive chunk of at most \p chunk_size values.
+ * The consumer is passed a buffer holding the chunk, the offset of the chunk within the message
+ * and the number of values in the chunk, both counted in values, and \p ctx, and returns \p 0
+ * on a success.
+ * The buffer is only valid for the duration of the call.
+ * If running with MPI, this function must be called only by rank \p 0.
+ * The function returns \p 0 on a success.
+ *
+ * \param [in]       count
+ *                   Number of values (integers, double precision floats, characters, etc.) to be received.
+ * \param [in]       datatype
+ *                   MDI handle (MDI_INT, MDI_DOUBLE, MDI_CHAR, etc.) corresponding to the type of data to be received.
+ * \param [in]       chunk_size
+ *                   Largest number of values passed to a single call of \p consumer.
+ * \param [in]       consumer
+ *                   Function that processes each chunk of the message.
+ * \param [in]       ctx
+ *                   Pointer passed to each call of \p consumer.
+ * \param [in]       comm
+ *                   MDI communicator associated with the connection to the sending code.
+ */
+int MDI_Recv_stream(int64_t count, MDI_Datatype datatype, int64_t chunk_size,
+                    MDI_Stream_callback_t consumer, void* ctx, MDI_Comm comm)
+{
+  if ( active_context->is_initialized == 0 ) {
+    mdi_error("MDI_Recv_stream called but MDI has not been initialized");
+    return 1;
+  }
+  if ( count < 0 || (uint64_t)count > SIZE_MAX ) {
+    mdi_error("MDI_Recv_stream called with an invalid count");
+    return 1;
+  }
+  if ( chunk_size < 1 || (uint64_t)chunk_size > SIZE_MAX ) {
+    mdi_error("MDI_Recv_stream called with an invalid chunk size");
+    return 1;
+  }
+  return general_recv_stream((size_t)count, datatype, (size_t)chunk_size, consumer, ctx, comm);
+}
+
+
+/*! \brief Send data in a specified unit through the MDI connection
+ *
+ * The message is tagged with \p units, so that the receiving code can convert the data while
+ * receiving it.
+ * If the receiving code calls MDI_Recv(), the data is received in atomic units.
+ * If the connected code uses an MDI version older than 1.3, the data is converted to atomic
+ * units before it is sent.
+ * If running with MPI, this function must be called only by rank \p 0.
+ * The function returns \p 0 on a success.
+ *
+ * \param [in]       buf
+ *                   Pointer to the data to be sent.
+ * \param [in]       count
+ *                   Number of values to be sent.
+ * \param [in]       datatype
+ *                   MDI handle (MDI_DOUBLE, MDI_FLOAT, or MDI_COMPLEX_DOUBLE) corresponding to the type of data to be sent.
+ * \param [in]       units
+ *                   Name of the unit of the data, as accepted by MDI_Conversion_factor().
+ * \param [in]       comm
+ *                   MDI communicator associated with the intended recipient code.
+ */
+int MDI_Send_units(const void* buf, int64_t count, MDI_Datatype datatype, const char* units,
+                   MDI_Comm comm)
+{
+  if ( active_context->is_initialized == 0 ) {
+    mdi_error("MDI_Send_units called but MDI has not been initialized");
+    return 1;
+  }
+  if ( count < 0 || (uint64_t)count > SIZE_MAX ) {
+    mdi_error("MDI_Send_units called with an invalid count");
+    return 1;
+  }
+  if ( datatype != MDI_DOUBLE && datatype != MDI_FLOAT && datatype != MDI_COMPLEX_DOUBLE ) {
+    mdi_error("MDI_Send_units called with a datatype that is not floating-point");
+    return 1;
+  }
+  int unit_id = units_get_id(units);
+  if ( unit_id == 0 ) {
+    mdi_error("MDI_Send_units called with an unrecognized unit");
+    return 1;
+  }
+  return general_send_units(buf, (size_t)count, datatype, unit_id, comm);
+}
+
+
+/*! \brief Receive data through the MDI connection, converting it to a specified unit
+ *
+ * The data is converted from the unit it was sent in, or from atomic units if it was sent by
+ * MDI_Send(), while it is received.
+ * If running with MPI, this function must be called only by rank \p 0.
+ * The function returns \p 0 on a success.
+ *
+ * \param [in]       buf
+ *                   Pointer to the buffer where the received data will be stored.
+ * \param [in]       count
+ *                   Number of values to be received.
+ * \param [in]       datatype
+ *                   MDI handle (MDI_DOUBLE, MDI_FLOAT, or MDI_COMPLEX_DOUBLE) corresponding to the type of data to be received.
+ * \param [in]       units
+ *                   Name of the unit in which the data is stored, as accepted by MDI_Conversion_factor().
+ * \param [in]       comm
+ *                   MDI communicator associated with the connection to the sending code.
+ */
+int MDI_Recv_units(void* buf, int64_t count, MDI_Datatype datatype, const char* units,
+                   MDI_Comm comm)
+{
+  if ( active_context->is_initialized == 0 ) {
+    mdi_error("MDI_Recv_units called but MDI has not been initialized");
+    return 1;
+  }
+  if ( count < 0 || (uint64_t)count > SIZE_MAX ) {
+    mdi_error("MDI_Recv_units called with an invalid count");
+    return 1;
+  }
+  if ( datatype != MDI_DOUBLE && datatype != MDI_FLOAT && datatype != MDI_COMPLEX_DOUBLE ) {
+    mdi_error("MDI_Recv_units called with a datatype that is not floating-point");
+    return 1;
+  }
+  if ( units_get_id(units) == 0 ) {
+    mdi_error("MDI_Recv_units called with an unrecognized unit");
+    return 1;
+  }
+  return general_recv_units(buf, (size_t)count, datatype, units, comm);
+}
+
+
+/*! \brief Send a command of length \p MDI_COMMAND_LENGTH through the MDI connection
+ *
+ * If running with MPI, this function must be called only by rank \p 0.
+ * The function returns \p 0 on a success.
+ *
+ * \param [in]       buf
+ *                   Pointer to the data to be sent.
+ * \param [in]       comm
+ *                   MDI communicator associated with the intended recipient code.
+ */
+int MDI_Send_Command(const char* buf, MDI_Comm comm)
+{
+  return MDI_Send_command(buf, comm);
+}
+
+
+/*! \brief Send a command of length \p MDI_COMMAND_LENGTH through the MDI connection
+ *
+ * If running with MPI, this function must be called only by rank \p 0.
+ * The function returns \p 0 on a success.
+ *
+ * \param [in]       buf
+ *                   Pointer to the data to be sent.
+ * \param [in]       comm
+ *                   MDI communicator associated with the intended recipient code.
+ */
+int MDI_Send_command(const char* buf, MDI_Comm comm)
+{
+  if ( active_context->is_initialized == 0 ) {
+    mdi_error("MDI_Send_Command called but MDI has not been initialized");
+    return 1;
+  }
+  return general_send_command(buf, comm);
+}
+
+
+/*! \brief Receive a command of length \p MDI_COMMAND_LENGTH through the MDI connection
+ *
+ * If running with MPI, this function must be called only by rank \p 0.
+ * The function returns \p 0 on a success.
+ *
+ * \param [in]       buf
+ *                   Pointer to the buffer where the received data will be stored.
+ * \param [in]       comm
+ *                   MDI communicator associated with the connection to the sending code.
+ */
+int MDI_Recv_Command(char* buf, MDI_Comm comm)
+{
+  return MDI_Recv_command(buf, comm);
+}
+
+
+/*! \brief Receive a command of length \p MDI_COMMAND_LENGTH through the MDI connection
+ *
+ * If running with MPI, this function must be called only by rank \p 0.
+ * The function returns \p 0 on a success.
+ *
+ * \param [in]       buf
+ *                   Pointer to the buffer where the received data will be stored.
+ * \param [in]       comm
+ *                   MDI communicator associated with the connection to the sending code.
+ */
+int MDI_Recv_command(char* buf, MDI_Comm comm)
+{
+  if ( active_context->is_initialized == 0 ) {
+    mdi_error("MDI_Recv_Command called but MDI has not been initialized");
+    return 1;
+  }
+  return general_recv_command(buf, comm);
+}
+
+
+/*! \brief Determine the conversion factor between two units
+ *
+ * The function determines the conversion factor from \p in_unit to \p out_unit.
+ * The function requires that \p in_unit and \p out_unit be members of the same category of unit (\em i.e. charge, energy, force, etc.).
+ * For example, calling \p MDI_Conversion_Factor(\p "kilojoule_per_mol",\p "atomic_unit_of_energy") will return the conversion factor from kilojoule/mol to hartrees.
+ * The function returns \p 0 on a success.
+ *
+ * All quantities communicated through MDI must be represented using atomic units.
+ * When unit conversions are necessary, this function should be used to obtain the conversion factors, as this will ensure that all drivers and engines use conversion factors that are self-consistent across codes.
+ * Use of conversion factors that are not self-consistent can result in numerical instabilities.
+ *
+ * The following is a list of the unit categories, along with the names of the units associated with each category:
+ *
+ * - charge
+ *    - atomic_unit_of_charge
+ *    - coulomb
+ * - energy
+ *    - atomic_unit_of_energy
+ *    - calorie
+ *    - electron_volt
+ *    - hartree
+ *    - inverse_meter_energy
+ *    - joule
+ *    - kelvin_energy
+ *    - kilocalorie
+ *    - kilocalorie_per_mol
+ *    - kilojoule
+ *    - kilojoule_per_mol
+ *    - rydberg
+ * - force
+ *    - atomic_unit_of_force
+ *    - newton
+ * - length
+ *    - angstrom
+ *    - atomic_unit_of_length
+ *    - bohr
+ *    - meter
+ *    - nanometer
+ *    - picometer
+ * - mass
+ *    - atomic_mass_unit
+ *    - atomic_unit_of_mass
+ *    - gram
+ *    - kilogram
+ * - time
+ *    - atomic_unit_of_time
+ *    - picosecond
+ *    - second
+ *
+ * All conversion factors were acquired from the <a href="https://physics.nist.gov/cuu/Constants/Table/allascii.txt">NIST CODATA</a>, 
+ * except the conversion factors for calorie, kilocalorie, and kilocalorie_per_mol, which were obtained from the <a href="https://www.nist.gov/pml/nist-guide-si-appendix-b9-factors-units-listed-kind-quantity-or-field-science"> NIST Guide to the SI</a>.
+ *
+ * \param [in]       in_unit
+ *                   Name of the unit to convert from.
+ * \param [in]       out_unit
+ *                   Name of the unit to convert to.
+ * \param [out]      conv
+ *                   Conversion factor from in_unit to out_unit
+ */
+int MDI_Conversion_Factor(const char* in_unit, const char* out_unit, double* conv)
+{
+  return MDI_Conversion_factor(in_unit, out_unit, conv);
+}
+
+
+/*! \brief Determine the conversion factor between two units
+ *
+ * The function determines the conversion factor from \p in_unit to \p out_unit.
+ * The function requires that \p in_unit and \p out_unit be members of the same category of unit (\em i.e. charge, energy, force, etc.).
+ * For example, calling \p MDI_Conversion_Factor(\p "kilojoule_per_mol",\p "atomic_unit_of_energy") will return the conversion factor from kilojoule/mol to hartrees.
+ * The function returns \p 0 on a success.
+ *
+ * All quantities communicated through MDI must be represented using atomic units.
+ * When unit conversions are necessary, this function should be used to obtain the conversion factors, as this will ensure that all drivers and engines use conversion factors that are self-consistent across codes.
+ * Use of conversion factors that are not self-consistent can result in numerical instabilities.
+ *
+ * The following is a list of the unit categories, along with the names of the units associated with each category:
+ *
+ * - charge
+ *    - atomic_unit_of_charge
+ *    - coulomb
+ * - energy
+ *    - atomic_unit_of_energy
+ *    - calorie
+ *    - electron_volt
+ *    - hartree
+ *    - inverse_meter_energy
+ *    - joule
+ *    - kelvin_energy
+ *    - kilocalorie
+ *    - kilocalorie_per_mol
+ *    - kilojoule
+ *    - kilojoule_per_mol
+ *    - rydberg
+ * - force
+ *    - atomic_unit_of_force
+ *    - newton
+ * - length
+ *    - angstrom
+ *    - atomic_unit_of_length
+ *    - bohr
+ *    - meter
+ *    - nanometer
+ *    - picometer
+ * - mass
+ *    - atomic_mass_unit
+ *    - atomic_unit_of_mass
+ *    - gram
+ *    - kilogram
+ * - time
+ *    - atomic_unit_of_time
+ *    - picosecond
+ *    - second
+ *
+ * All conversion factors were acquired from the <a href="https://physics.nist.gov/cuu/Constants/Table/allascii.txt">NIST CODATA</a>, 
+ * except the conversion factors for calorie, kilocalorie, and kilocalorie_per_mol, which were obtained from the <a href="https://www.nist.gov/pml/nist-guide-si-appendix-b9-factors-units-listed-kind-quantity-or-field-science"> NIST Guide to the SI</a>.
+ *
+ * \param [in]       in_unit
+ *                   Name of the unit to convert from.
+ * \param [in]       out_unit
+ *                   Name of the unit to convert to.
+ * \param [out]      conv
+ *                   Conversion factor from in_unit to out_unit
+ */
+int MDI_Conversion_factor(const char* in_unit, const char* out_unit, double* conv)
+{
+  // Except where otherwise noted, all values are from:
+  //   - https://physics.nist.gov/cuu/Constants/Table/allascii.txt
+
+  // mass
+  double atomic_unit_of_mass = 1.0;
+  double kilogram = 1.0 / pc_atomic_unit_of_mass;
+  double gram = kilogram / 1000.0;
+  double atomic_mass_unit = kilogram * pc_atomic_mass_unit_kilogram_relationship;
+
+  // charge
+  double atomic_unit_of_charge = 1.0;
+  double coulomb = 1.0 / pc_atomic_unit_of_charge;
+
+  // energy
+  double atomic_unit_of_energy = 1.0;
+  double hartree = 1.0;
+  double joule = 1.0 / pc_atomic_unit_of_energy;
+  double kilojoule = joule * 1000.0;
+  double kilojoule_per_mol = 1.0 / pc_hartree2kJmol;
+  double calorie = joule * pc_calorie_joule_relationship;
+  double kilocalorie = calorie * 1000.0;
+  double kilocalorie_per_mol = 1.0 / pc_hartree2kcalmol;
+  double electron_volt = pc_electron_volt_hartree_relationship;
+  double rydberg = electron_volt * pc_Rydberg_constant_times_hc_in_eV;
+  double kelvin_energy = pc_kelvin_hartree_relationship;
+  double inverse_meter_energy = pc_inverse_meter_hartree_relationship;
 
   // force
   double atomic_unit_of_force = 1.0;
@@ -721,11 +1259,11 @@ int MDI_Get_Role(int* role)
  */
 int MDI_Get_role(int* role)
 {
-  if ( is_initialized == 0 ) {
+  if ( active_context->is_initialized == 0 ) {
     mdi_error("MDI_Get_Role called but MDI has not been initialized");
     return 1;
   }
-  code* this_code = get_code(current_code);
+  code* this_code = get_code(active_context->current_code);
   if (strcmp(this_code->role, "DRIVER") == 0) {
     *role = MDI_DRIVER;
   }
@@ -784,12 +1322,16 @@ int MDI_Register_Node(const char* node_name)
  */
 int MDI_Register_node(const char* node_name)
 {
-  if ( is_initialized == 0 ) {
+  if ( active_context->is_initialized == 0 ) {
     mdi_error("MDI_Register_Node called but MDI has not been initialized");
     return 1;
   }
-  code* this_code = get_code(current_code);
-  return register_node(this_code->nodes, node_name);
+  code* this_code = get_code(active_context->current_code);
+  int ret = register_node(this_code->nodes, node_name);
+  if ( ret == 0 && this_code->registry_frozen ) {
+    ret = general_update_frozen_registry(node_name, MDI_LIST_NODES);
+  }
+  return ret;
 }
 
 
@@ -825,7 +1367,7 @@ int MDI_Check_Node_Exists(const char* node_name, MDI_Comm comm, int* flag)
  */
 int MDI_Check_node_exists(const char* node_name, MDI_Comm comm, int* flag)
 {
-  if ( is_initialized == 0 ) {
+  if ( active_context->is_initialized == 0 ) {
     mdi_error("MDI_Check_Node_Exists called but MDI has not been initialized");
     return 1;
   }
@@ -835,10 +1377,10 @@ int MDI_Check_node_exists(const char* node_name, MDI_Comm comm, int* flag)
     mdi_error("Node name is greater than MDI_COMMAND_LENGTH");
     return 2;
   }
-  vector* node_vec = get_node_vector(comm);
+  registry* node_reg = get_node_registry(comm);
 
   // find the node
-  int node_index = get_node_index(node_vec, node_name);
+  int node_index = get_node_index(node_reg, node_name);
   if ( node_index == -1 ) {
     *flag = 0;
   }
@@ -859,161 +1401,400 @@ int MDI_Check_node_exists(const char* node_name, MDI_Comm comm, int* flag)
  * \param [out]      nnodes
  *                   On return, the number of nodes supported by the engine.
  */
-int MDI_Get_NNodes(MDI_Comm comm, int* nnodes)
+int MDI_Get_NNodes(MDI_Comm comm, int* nnodes)
+{
+  return MDI_Get_nnodes(comm, nnodes);
+}
+
+
+/*! \brief Get the number of nodes on a specified engine
+ *
+ * The function returns \p 0 on a success.
+ *
+ * \param [in]       comm
+ *                   MDI communicator of the engine.  If comm is set to 
+ *                   MDI_COMM_NULL, the function will check for the calling engine.
+ * \param [out]      nnodes
+ *                   On return, the number of nodes supported by the engine.
+ */
+int MDI_Get_nnodes(MDI_Comm comm, int* nnodes)
+{
+  if ( active_context->is_initialized == 0 ) {
+    mdi_error("MDI_Get_NNodes called but MDI has not been initialized");
+    return 1;
+  }
+
+  registry* node_reg = get_node_registry(comm);
+  *nnodes = (int)node_reg->entries.size;
+
+  return 0;
+}
+
+
+/*! \brief Get the name of a node on a specified engine
+ *
+ * The function returns \p 0 on a success.
+ *
+ * \param [in]       index
+ *                   Index of the node on the specified engine.
+ * \param [in]       comm
+ *                   MDI communicator of the engine.  If comm is set to 
+ *                   MDI_COMM_NULL, the function will check for the calling engine.
+ * \param [out]      name
+ *                   On return, the name of the node
+ */
+int MDI_Get_Node(int index, MDI_Comm comm, char* name)
+{
+  return MDI_Get_node(index, comm, name);
+}
+
+
+/*! \brief Get the name of a node on a specified engine
+ *
+ * The function returns \p 0 on a success.
+ *
+ * \param [in]       index
+ *                   Index of the node on the specified engine.
+ * \param [in]       comm
+ *                   MDI communicator of the engine.  If comm is set to 
+ *                   MDI_COMM_NULL, the function will check for the calling engine.
+ * \param [out]      name
+ *                   On return, the name of the node
+ */
+int MDI_Get_node(int index, MDI_Comm comm, char* name)
+{
+  if ( active_context->is_initialized == 0 ) {
+    mdi_error("MDI_Get_Node called but MDI has not been initialized");
+    return 1;
+  }
+  registry* node_reg = get_node_registry(comm);
+  if ( node_reg == NULL ) {
+    mdi_error("MDI_Get_Node unable to find node registry");
+    return 1;
+  }
+
+  node* ret_node = registry_get(node_reg, index);
+  if ( ret_node == NULL ) {
+    mdi_error("MDI_Get_Node unable to find node");
+    return 1;
+  }
+  snprintf(name, MDI_NAME_LENGTH, "%s", ret_node->name);
+  return 0;
+}
+
+
+/*! \brief Register a command on a specified node
+ *
+ * The function returns \p 0 on a success.
+ *
+ * \param [in]       node_name
+ *                   Name of the node on which the command will be registered.
+ * \param [in]       command_name
+ *                   Name of the command.
+ */
+int MDI_Register_Command(const char* node_name, const char* command_name)
+{
+  return MDI_Register_command(node_name, command_name);
+}
+
+
+/*! \brief Register a command on a specified node
+ *
+ * The function returns \p 0 on a success.
+ *
+ * \param [in]       node_name
+ *                   Name of the node on which the command will be registered.
+ * \param [in]       command_name
+ *                   Name of the command.
+ */
+int MDI_Register_command(const char* node_name, const char* command_name)
+{
+  if ( active_context->is_initialized == 0 ) {
+    mdi_error("MDI_Register_Command called but MDI has not been initialized");
+    return 1;
+  }
+  code* this_code = get_code(active_context->current_code);
+  int ret = register_command(this_code->nodes, node_name, command_name);
+  if ( ret == 0 && this_code->registry_frozen ) {
+    ret = general_update_frozen_registry(node_name, MDI_LIST_COMMANDS);
+  }
+  return ret;
+}
+
+
+/*! \brief Check whether a command is supported on specified node on a specified engine
+ *
+ * The function returns \p 0 on a success.
+ *
+ * \param [in]       node_name
+ *                   Name of the command's node.
+ * \param [in]       command_name
+ *                   Name of the command.
+ * \param [in]       comm
+ *                   MDI communicator of the engine.  If comm is set to 
+ *                   MDI_COMM_NULL, the function will check for the calling engine.
+ * \param [out]      flag
+ *                   On return, 1 if the command is supported and 0 otherwise.
+ */
+int MDI_Check_Command_Exists(const char* node_name, const char* command_name, MDI_Comm comm, int* flag)
+{
+  return MDI_Check_command_exists(node_name, command_name, comm, flag);
+}
+
+
+/*! \brief Check whether a command is supported on specified node on a specified engine
+ *
+ * The function returns \p 0 on a success.
+ *
+ * \param [in]       node_name
+ *                   Name of the command's node.
+ * \param [in]       command_name
+ *                   Name of the command.
+ * \param [in]       comm
+ *                   MDI communicator of the engine.  If comm is set to 
+ *                   MDI_COMM_NULL, the function will check for the calling engine.
+ * \param [out]      flag
+ *                   On return, 1 if the command is supported and 0 otherwise.
+ */
+int MDI_Check_command_exists(const char* node_name, const char* command_name, MDI_Comm comm, int* flag)
+{
+  if ( active_context->is_initialized == 0 ) {
+    mdi_error("MDI_Check_Command_Exists called but MDI has not been initialized");
+    return 1;
+  }
+
+  // confirm that the node_name size is not greater than MDI_COMMAND_LENGTH
+  if ( strlen(node_name) > COMMAND_LENGTH ) {
+    mdi_error("Node name is greater than MDI_COMMAND_LENGTH");
+    return 2;
+  }
+
+  // confirm that the command_name size is not greater than MDI_COMMAND_LENGTH
+  if ( strlen(command_name) > COMMAND_LENGTH ) {
+    mdi_error("Cannot chcek command name with length greater than MDI_COMMAND_LENGTH");
+    return 3;
+  }
+
+  registry* node_reg = get_node_registry(comm);
+
+  // find the node
+  int node_index = get_node_index(node_reg, node_name);
+  if ( node_index == -1 ) {
+    mdi_error("Could not find the node");
+    return 1;
+  }
+  node* target_node = registry_get(node_reg, node_index);
+
+  // find the command
+  int command_index = get_command_index(target_node, command_name);
+  if ( command_index == -1 ) {
+    *flag = 0;
+  }
+  else {
+    *flag = 1;
+  }
+  return 0;
+}
+
+
+/*! \brief Get the number of commands supported for a specified node on a specified engine
+ *
+ * The function returns \p 0 on a success.
+ *
+ * \param [in]       node_name
+ *                   Name of the node.
+ * \param [in]       comm
+ *                   MDI communicator of the engine.  If comm is set to 
+ *                   MDI_COMM_NULL, the function will check for the calling engine.
+ * \param [out]      nnodes
+ *                   On return, the number of commands supported on the specified engine
+ *                   on the specified node.
+ */
+int MDI_Get_NCommands(const char* node_name, MDI_Comm comm, int* ncommands)
 {
-  return MDI_Get_nnodes(comm, nnodes);
+  return MDI_Get_ncommands(node_name, comm, ncommands);
 }
 
 
-/*! \brief Get the number of nodes on a specified engine
+/*! \brief Get the number of commands supported for a specified node on a specified engine
  *
  * The function returns \p 0 on a success.
  *
+ * \param [in]       node_name
+ *                   Name of the node.
  * \param [in]       comm
  *                   MDI communicator of the engine.  If comm is set to 
  *                   MDI_COMM_NULL, the function will check for the calling engine.
  * \param [out]      nnodes
- *                   On return, the number of nodes supported by the engine.
+ *                   On return, the number of commands supported on the specified engine
+ *                   on the specified node.
  */
-int MDI_Get_nnodes(MDI_Comm comm, int* nnodes)
+int MDI_Get_ncommands(const char* node_name, MDI_Comm comm, int* ncommands)
 {
-  if ( is_initialized == 0 ) {
-    mdi_error("MDI_Get_NNodes called but MDI has not been initialized");
+  if ( active_context->is_initialized == 0 ) {
+    mdi_error("MDI_Get_NCommands called but MDI has not been initialized");
     return 1;
   }
 
-  vector* node_vec = get_node_vector(comm);
-  *nnodes = (int)node_vec->size;
+  // confirm that the node_name size is not greater than MDI_COMMAND_LENGTH
+  if ( strlen(node_name) > COMMAND_LENGTH ) {
+    mdi_error("Node name is greater than MDI_COMMAND_LENGTH");
+    return 2;
+  }
+
+  registry* node_reg = get_node_registry(comm);
+
+  // find the node
+  int node_index = get_node_index(node_reg, node_name);
+  if ( node_index == -1 ) {
+    mdi_error("Could not find the node");
+    return 1;
+  }
+  node* target_node = registry_get(node_reg, node_index);
 
+  *ncommands = (int)target_node->commands->entries.size;
   return 0;
 }
 
 
-/*! \brief Get the name of a node on a specified engine
+/*! \brief Get the name of a command on a specified node on a specified engine
  *
  * The function returns \p 0 on a success.
  *
+ * \param [in]       node_name
+ *                   Name of the node on which the command is located.
  * \param [in]       index
- *                   Index of the node on the specified engine.
+ *                   Index of the command on the specified node.
  * \param [in]       comm
  *                   MDI communicator of the engine.  If comm is set to 
  *                   MDI_COMM_NULL, the function will check for the calling engine.
  * \param [out]      name
- *                   On return, the name of the node
+ *                   On return, the name of the command
  */
-int MDI_Get_Node(int index, MDI_Comm comm, char* name)
+int MDI_Get_Command(const char* node_name, int index, MDI_Comm comm, char* name)
 {
-  return MDI_Get_node(index, comm, name);
+  return MDI_Get_command(node_name, index, comm, name);
 }
 
 
-/*! \brief Get the name of a node on a specified engine
+/*! \brief Get the name of a command on a specified node on a specified engine
  *
  * The function returns \p 0 on a success.
  *
+ * \param [in]       node_name
+ *                   Name of the node on which the command is located.
  * \param [in]       index
- *                   Index of the node on the specified engine.
+ *                   Index of the command on the specified node.
  * \param [in]       comm
  *                   MDI communicator of the engine.  If comm is set to 
  *                   MDI_COMM_NULL, the function will check for the calling engine.
  * \param [out]      name
- *                   On return, the name of the node
+ *                   On return, the name of the command
  */
-int MDI_Get_node(int index, MDI_Comm comm, char* name)
+int MDI_Get_command(const char* node_name, int index, MDI_Comm comm, char* name)
 {
-  if ( is_initialized == 0 ) {
-    mdi_error("MDI_Get_Node called but MDI has not been initialized");
+  if ( active_context->is_initialized == 0 ) {
+    mdi_error("MDI_Get_Command called but MDI has not been initialized");
     return 1;
   }
-  vector* node_vec = get_node_vector(comm);
-  if ( node_vec == NULL ) {
-    mdi_error("MDI_Get_Node unable to find node vector");
+  registry* node_reg = get_node_registry(comm);
+
+  // find the node
+  int node_index = get_node_index(node_reg, node_name);
+  if ( node_index == -1 ) {
+    mdi_error("MDI_Get_Command could not find the requested node");
     return 1;
   }
+  node* target_node = registry_get(node_reg, node_index);
 
-  node* ret_node = vector_get(node_vec, index);
-  if ( ret_node == NULL ) {
-    mdi_error("MDI_Get_Node unable to find node");
+  if ( target_node->commands->entries.size <= index ) {
+    mdi_error("MDI_Get_Command failed because the command does not exist");
     return 1;
   }
-  snprintf(name, MDI_NAME_LENGTH, "%s", ret_node->name);
+
+  char* target_command = registry_get( target_node->commands, index );
+  snprintf(name, MDI_NAME_LENGTH, "%s", target_command);
   return 0;
 }
 
 
-/*! \brief Register a command on a specified node
+/*! \brief Register a callback on a specified node
  *
  * The function returns \p 0 on a success.
  *
  * \param [in]       node_name
- *                   Name of the node on which the command will be registered.
- * \param [in]       command_name
- *                   Name of the command.
+ *                   Name of the node on which the callback will be registered.
+ * \param [in]       callback_name
+ *                   Name of the callback.
  */
-int MDI_Register_Command(const char* node_name, const char* command_name)
+int MDI_Register_Callback(const char* node_name, const char* callback_name)
 {
-  return MDI_Register_command(node_name, command_name);
+  return MDI_Register_callback(node_name, callback_name);
 }
 
 
-/*! \brief Register a command on a specified node
+/*! \brief Register a callback on a specified node
  *
  * The function returns \p 0 on a success.
  *
  * \param [in]       node_name
- *                   Name of the node on which the command will be registered.
- * \param [in]       command_name
- *                   Name of the command.
+ *                   Name of the node on which the callback will be registered.
+ * \param [in]       callback_name
+ *                   Name of the callback.
  */
-int MDI_Register_command(const char* node_name, const char* command_name)
+int MDI_Register_callback(const char* node_name, const char* callback_name)
 {
-  if ( is_initialized == 0 ) {
-    mdi_error("MDI_Register_Command called but MDI has not been initialized");
+  if ( active_context->is_initialized == 0 ) {
+    mdi_error("MDI_Register_Callback called but MDI has not been initialized");
     return 1;
   }
-  code* this_code = get_code(current_code);
-  return register_command(this_code->nodes, node_name, command_name);
+  code* this_code = get_code(active_context->current_code);
+  int ret = register_callback(this_code->nodes, node_name, callback_name);
+  if ( ret == 0 && this_code->registry_frozen ) {
+    ret = general_update_frozen_registry(node_name, MDI_LIST_CALLBACKS);
+  }
+  return ret;
 }
 
 
-/*! \brief Check whether a command is supported on specified node on a specified engine
+/*! \brief Check whether a callback exists on specified node on a specified engine
  *
  * The function returns \p 0 on a success.
  *
  * \param [in]       node_name
- *                   Name of the command's node.
+ *                   Name of the callbacks's node.
  * \param [in]       command_name
- *                   Name of the command.
+ *                   Name of the callback.
  * \param [in]       comm
  *                   MDI communicator of the engine.  If comm is set to 
  *                   MDI_COMM_NULL, the function will check for the calling engine.
  * \param [out]      flag
- *                   On return, 1 if the command is supported and 0 otherwise.
+ *                   On return, 1 if the callback is supported and 0 otherwise.
  */
-int MDI_Check_Command_Exists(const char* node_name, const char* command_name, MDI_Comm comm, int* flag)
+int MDI_Check_Callback_Exists(const char* node_name, const char* callback_name, MDI_Comm comm, int* flag)
 {
-  return MDI_Check_command_exists(node_name, command_name, comm, flag);
+  return MDI_Check_callback_exists(node_name, callback_name, comm, flag);
 }
 
 
-/*! \brief Check whether a command is supported on specified node on a specified engine
+/*! \brief Check whether a callback exists on specified node on a specified engine
  *
  * The function returns \p 0 on a success.
  *
  * \param [in]       node_name
- *                   Name of the command's node.
+ *                   Name of the callbacks's node.
  * \param [in]       command_name
- *                   Name of the command.
+ *                   Name of the callback.
  * \param [in]       comm
  *                   MDI communicator of the engine.  If comm is set to 
  *                   MDI_COMM_NULL, the function will check for the calling engine.
  * \param [out]      flag
- *                   On return, 1 if the command is supported and 0 otherwise.
+ *                   On return, 1 if the callback is supported and 0 otherwise.
  */
-int MDI_Check_command_exists(const char* node_name, const char* command_name, MDI_Comm comm, int* flag)
+int MDI_Check_callback_exists(const char* node_name, const char* callback_name, MDI_Comm comm, int* flag)
 {
-  if ( is_initialized == 0 ) {
-    mdi_error("MDI_Check_Command_Exists called but MDI has not been initialized");
+  if ( active_context->is_initialized == 0 ) {
+    mdi_error("MDI_Check_Callback_Exists called but MDI has not been initialized");
     return 1;
   }
 
@@ -1023,25 +1804,25 @@ int MDI_Check_command_exists(const char* node_name, const char* command_name, MD
     return 2;
   }
 
-  // confirm that the command_name size is not greater than MDI_COMMAND_LENGTH
-  if ( strlen(command_name) > COMMAND_LENGTH ) {
-    mdi_error("Cannot chcek command name with length greater than MDI_COMMAND_LENGTH");
+  // confirm that the callback_name size is not greater than MDI_COMMAND_LENGTH
+  if ( strlen(callback_name) > COMMAND_LENGTH ) {
+    mdi_error("Cannot check callback name with length greater than MDI_COMMAND_LENGTH");
     return 3;
   }
 
-  vector* node_vec = get_node_vector(comm);
+  registry* node_reg = get_node_registry(comm);
 
   // find the node
-  int node_index = get_node_index(node_vec, node_name);
+  int node_index = get_node_index(node_reg, node_name);
   if ( node_index == -1 ) {
     mdi_error("Could not find the node");
-    return 1;
+    return 4;
   }
-  node* target_node = vector_get(node_vec, node_index);
+  node* target_node = registry_get(node_reg, node_index);
 
-  // find the command
-  int command_index = get_command_index(target_node, command_name);
-  if ( command_index == -1 ) {
+  // find the callback
+  int callback_index = get_callback_index(target_node, callback_name);
+  if ( callback_index == -1 ) {
     *flag = 0;
   }
   else {
@@ -1051,7 +1832,7 @@ int MDI_Check_command_exists(const char* node_name, const char* command_name, MD
 }
 
 
-/*! \brief Get the number of commands supported for a specified node on a specified engine
+/*! \brief Get the number of callbacks on a specified node on a specified engine
  *
  * The function returns \p 0 on a success.
  *
@@ -1060,17 +1841,17 @@ int MDI_Check_command_exists(const char* node_name, const char* command_name, MD
  * \param [in]       comm
  *                   MDI communicator of the engine.  If comm is set to 
  *                   MDI_COMM_NULL, the function will check for the calling engine.
- * \param [out]      nnodes
- *                   On return, the number of commands supported on the specified engine
- *                   on the specified node.
+ * \param [out]      ncallbacks
+ *                   On return, the number of callbacks on the specified node
+ *                   on the specified engine.
  */
-int MDI_Get_NCommands(const char* node_name, MDI_Comm comm, int* ncommands)
+int MDI_Get_NCallbacks(const char* node_name, MDI_Comm comm, int* ncallbacks)
 {
-  return MDI_Get_ncommands(node_name, comm, ncommands);
+  return MDI_Get_ncallbacks(node_name, comm, ncallbacks);
 }
 
 
-/*! \brief Get the number of commands supported for a specified node on a specified engine
+/*! \brief Get the number of callbacks on a specified node on a specified engine
  *
  * The function returns \p 0 on a success.
  *
@@ -1079,14 +1860,14 @@ int MDI_Get_NCommands(const char* node_name, MDI_Comm comm, int* ncommands)
  * \param [in]       comm
  *                   MDI communicator of the engine.  If comm is set to 
  *                   MDI_COMM_NULL, the function will check for the calling engine.
- * \param [out]      nnodes
- *                   On return, the number of commands supported on the specified engine
- *                   on the specified node.
+ * \param [out]      ncallbacks
+ *                   On return, the number of callbacks on the specified node
+ *                   on the specified engine.
  */
-int MDI_Get_ncommands(const char* node_name, MDI_Comm comm, int* ncommands)
+int MDI_Get_ncallbacks(const char* node_name, MDI_Comm comm, int* ncallbacks)
 {
-  if ( is_initialized == 0 ) {
-    mdi_error("MDI_Get_NCommands called but MDI has not been initialized");
+  if ( active_context->is_initialized == 0 ) {
+    mdi_error("MDI_Get_NCallbacks called but MDI has not been initialized");
     return 1;
   }
 
@@ -1096,311 +1877,608 @@ int MDI_Get_ncommands(const char* node_name, MDI_Comm comm, int* ncommands)
     return 2;
   }
 
-  vector* node_vec = get_node_vector(comm);
+  registry* node_reg = get_node_registry(comm);
 
   // find the node
-  int node_index = get_node_index(node_vec, node_name);
+  int node_index = get_node_index(node_reg, node_name);
   if ( node_index == -1 ) {
     mdi_error("Could not find the node");
-    return 1;
+    return 3;
   }
-  node* target_node = vector_get(node_vec, node_index);
+  node* target_node = registry_get(node_reg, node_index);
 
-  *ncommands = (int)target_node->commands->size;
+  *ncallbacks = (int)target_node->callbacks->entries.size;
   return 0;
 }
 
 
-/*! \brief Get the name of a command on a specified node on a specified engine
+/*! \brief Get the name of a callback on a specified node on a specified engine
  *
  * The function returns \p 0 on a success.
  *
  * \param [in]       node_name
- *                   Name of the node on which the command is located.
+ *                   Name of the node on which the callback is located.
  * \param [in]       index
- *                   Index of the command on the specified node.
+ *                   Index of the callback on the specified node.
  * \param [in]       comm
  *                   MDI communicator of the engine.  If comm is set to 
  *                   MDI_COMM_NULL, the function will check for the calling engine.
  * \param [out]      name
- *                   On return, the name of the command
+ *                   On return, the name of the callback
  */
-int MDI_Get_Command(const char* node_name, int index, MDI_Comm comm, char* name)
+int MDI_Get_Callback(const char* node_name, int index, MDI_Comm comm, char* name)
 {
-  return MDI_Get_command(node_name, index, comm, name);
+  return MDI_Get_callback(node_name, index, comm, name);
 }
 
 
-/*! \brief Get the name of a command on a specified node on a specified engine
+/*! \brief Get the name of a callback on a specified node on a specified engine
  *
  * The function returns \p 0 on a success.
  *
  * \param [in]       node_name
- *                   Name of the node on which the command is located.
+ *                   Name of the node on which the callback is located.
  * \param [in]       index
- *                   Index of the command on the specified node.
+ *                   Index of the callback on the specified node.
  * \param [in]       comm
  *                   MDI communicator of the engine.  If comm is set to 
  *                   MDI_COMM_NULL, the function will check for the calling engine.
  * \param [out]      name
- *                   On return, the name of the command
+ *                   On return, the name of the callback
  */
-int MDI_Get_command(const char* node_name, int index, MDI_Comm comm, char* name)
+int MDI_Get_callback(const char* node_name, int index, MDI_Comm comm, char* name)
 {
-  if ( is_initialized == 0 ) {
-    mdi_error("MDI_Get_Command called but MDI has not been initialized");
+  if ( active_context->is_initialized == 0 ) {
+    mdi_error("MDI_Get_Callback called but MDI has not been initialized");
     return 1;
   }
-  vector* node_vec = get_node_vector(comm);
+
+  registry* node_reg = get_node_registry(comm);
 
   // find the node
-  int node_index = get_node_index(node_vec, node_name);
+  int node_index = get_node_index(node_reg, node_name);
   if ( node_index == -1 ) {
     mdi_error("MDI_Get_Command could not find the requested node");
-    return 1;
+    return 2;
   }
-  node* target_node = vector_get(node_vec, node_index);
+  node* target_node = registry_get(node_reg, node_index);
 
-  if ( target_node->commands->size <= index ) {
+  if ( target_node->callbacks->entries.size <= index ) {
     mdi_error("MDI_Get_Command failed because the command does not exist");
+    return 3;
+  }
+
+  char* target_callback = registry_get( target_node->callbacks, index );
+  snprintf(name, MDI_NAME_LENGTH, "%s", target_callback);
+  return 0;
+}
+
+
+/*! \brief Freeze the registry of nodes, commands, and callbacks
+ *
+ * An engine may call this function once it has registered its nodes, commands, and callbacks.
+ * The registry is then given perfect hash tables, and the replies to the builtin commands that
+ * query the registry (\p <COMMANDS, \p <CALLBACKS, \p <NODES, \p <NCOMMANDS, and \p <NCALLBACKS)
+ * are formed once, rather than on each query.
+ * Registrations remain permitted after this call, and update the frozen registry.
+ * The function returns \p 0 on a success.
+ */
+int MDI_Freeze_Registry()
+{
+  if ( active_context->is_initialized == 0 ) {
+    mdi_error("MDI_Freeze_Registry called but MDI has not been initialized");
     return 1;
   }
+  return general_freeze_registry();
+}
 
-  char* target_command = vector_get( target_node->commands, index );
-  snprintf(name, MDI_NAME_LENGTH, "%s", target_command);
+
+/*! \brief Register a function that responds to a command
+ *
+ * If the command is not yet registered on the node, it is registered.
+ * Each node holds its handlers in a hash table, so each command that is received by
+ * \p MDI_Serve, or that is sent to an engine library by its driver, is dispatched to its
+ * handler in constant time, without any comparison of command names by the engine.
+ * Commands are dispatched to the handlers of the engine's current node, which is the first
+ * registered node until the engine responds to a command that names another node, such as
+ * \p @FORCES, so a command may have a different handler on each node.
+ * A command without a handler on the current node is passed to the function set by
+ * \p MDI_Set_Execute_Command_Func.
+ * Registering a second handler for the same command on the same node replaces the first.
+ * The builtin commands (\p <NAME, \p <VERSION, \p <COMMANDS, etc.) are answered by the library,
+ * and are never passed to a handler.
+ * The function returns \p 0 on a success.
+ *
+ * \param [in]       node_name
+ *                   Name of the node on which the command will be registered.
+ * \param [in]       command_name
+ *                   Name of the command.
+ * \param [in]       handler
+ *                   Function that responds to the command.
+ * \param [in]       ctx
+ *                   Pointer that is passed to each call of \p handler.
+ */
+int MDI_Register_Command_Handler(const char* node_name, const char* command_name,
+                                 MDI_Command_handler_t handler, void* ctx)
+{
+  return MDI_Register_command_handler(node_name, command_name, handler, ctx);
+}
+
+
+/*! \brief Register a function that responds to a command
+ *
+ * If the command is not yet registered on the node, it is registered.
+ * Each node holds its handlers in a hash table, so each command that is received by
+ * \p MDI_Serve, or that is sent to an engine library by its driver, is dispatched to its
+ * handler in constant time, without any comparison of command names by the engine.
+ * Commands are dispatched to the handlers of the engine's current node, which is the first
+ * registered node until the engine responds to a command that names another node, such as
+ * \p @FORCES, so a command may have a different handler on each node.
+ * A command without a handler on the current node is passed to the function set by
+ * \p MDI_Set_Execute_Command_Func.
+ * Registering a second handler for the same command on the same node replaces the first.
+ * The builtin commands (\p <NAME, \p <VERSION, \p <COMMANDS, etc.) are answered by the library,
+ * and are never passed to a handler.
+ * The function returns \p 0 on a success.
+ *
+ * \param [in]       node_name
+ *                   Name of the node on which the command will be registered.
+ * \param [in]       command_name
+ *                   Name of the command.
+ * \param [in]       handler
+ *                   Function that responds to the command.
+ * \param [in]       ctx
+ *                   Pointer that is passed to each call of \p handler.
+ */
+int MDI_Register_command_handler(const char* node_name, const char* command_name,
+                                 MDI_Command_handler_t handler, void* ctx)
+{
+  if ( active_context->is_initialized == 0 ) {
+    mdi_error("MDI_Register_Command_Handler called but MDI has not been initialized");
+    return 1;
+  }
+  return general_register_command_handler(node_name, command_name, handler, ctx);
+}
+
+
+/*! \brief Respond to commands through the registered command handlers, until \p EXIT is received
+ *
+ * Each command that is received is dispatched to its handler, after which the next command is received.
+ * After \p EXIT has been dispatched, the function returns.
+ * An engine that is linked to its driver as a library, and not launched as a plugin, passes
+ * \p MDI_COMM_NULL; the function then returns immediately, and the driver dispatches each
+ * command to its handler when the command is sent.
+ * If running with MPI, this function must be called only by rank \p 0.
+ * The function returns \p 0 on a success.
+ *
+ * \param [in]       comm
+ *                   MDI communicator associated with the driver, or \p MDI_COMM_NULL.
+ */
+int MDI_Serve(MDI_Comm comm)
+{
+  if ( active_context->is_initialized == 0 ) {
+    mdi_error("MDI_Serve called but MDI has not been initialized");
+    return 1;
+  }
+  return general_serve(comm);
+}
+
+
+/*! \brief Create a new context
+ *
+ * A context holds all of the state of the library, including its codes and communicators.
+ * The state of each context is independent of the state of every other context, so that
+ * different threads can use different contexts at the same time.
+ * The function returns \p 0 on a success.
+ *
+ * \param [out]      context
+ *                   On return, the handle of the new context.
+ */
+int MDI_Context_create(MDI_Context* context)
+{
+  return new_context(context);
+}
+
+
+/*! \brief Free a context, together with all of the codes and communicators in it
+ *
+ * The default context and the context that is active on the calling thread cannot be freed.
+ * The function returns \p 0 on a success.
+ *
+ * \param [in]       context
+ *                   Handle of the context.
+ */
+int MDI_Context_free(MDI_Context context)
+{
+  return delete_context(context);
+}
+
+
+/*! \brief Select the context that is used by the MDI calls of the calling thread
+ *
+ * Each thread initially uses \p MDI_CONTEXT_DEFAULT.
+ * A context may be selected by several threads, but must only be used by one thread at a time.
+ * The function returns \p 0 on a success.
+ *
+ * \param [in]       context
+ *                   Handle of the context.
+ */
+int MDI_Set_context(MDI_Context context)
+{
+  return enter_context(context, NULL);
+}
+
+
+/*! \brief Get the context that is used by the MDI calls of the calling thread
+ *
+ * The function returns \p 0 on a success.
+ *
+ * \param [out]      context
+ *                   On return, the handle of the context.
+ */
+int MDI_Get_context(MDI_Context* context)
+{
+  *context = active_context->id;
   return 0;
 }
 
 
-/*! \brief Register a callback on a specified node
+/*! \brief Initialize MDI within a context
  *
+ * This function is equivalent to \p MDI_Init, called while \p context is selected.
  * The function returns \p 0 on a success.
  *
- * \param [in]       node_name
- *                   Name of the node on which the callback will be registered.
- * \param [in]       callback_name
- *                   Name of the callback.
+ * \param [in]       context
+ *                   Handle of the context.
+ * \param [in]       options
+ *                   Options describing the communication method used to connect to codes.
+ * \param [in, out]  world_comm
+ *                   On input, the MPI communicator that spans all of the codes.
+ *                   On output, the MPI communicator that spans the single code corresponding to the calling rank.
+ *                   Only used if the "-method MPI" option is provided.
  */
-int MDI_Register_Callback(const char* node_name, const char* callback_name)
+int MDI_Init_ctx(MDI_Context context, const char* options, void* world_comm)
 {
-  return MDI_Register_callback(node_name, callback_name);
+  mdi_context* previous;
+  int ret = enter_context(context, &previous);
+  if ( ret != 0 ) { return ret; }
+  ret = MDI_Init(options, world_comm);
+  leave_context(previous);
+  return ret;
 }
 
 
-/*! \brief Register a callback on a specified node
+/*! \brief Accept a new MDI communicator within a context
  *
+ * This function is equivalent to \p MDI_Accept_communicator, called while \p context is selected.
  * The function returns \p 0 on a success.
  *
- * \param [in]       node_name
- *                   Name of the node on which the callback will be registered.
- * \param [in]       callback_name
- *                   Name of the callback.
+ * \param [in]       context
+ *                   Handle of the context.
+ * \param [out]      comm
+ *                   On return, the new communicator, or \p MDI_COMM_NULL if no new communicators are available.
  */
-int MDI_Register_callback(const char* node_name, const char* callback_name)
+int MDI_Accept_communicator_ctx(MDI_Context context, MDI_Comm* comm)
 {
-  if ( is_initialized == 0 ) {
-    mdi_error("MDI_Register_Callback called but MDI has not been initialized");
-    return 1;
-  }
-  code* this_code = get_code(current_code);
-  return register_callback(this_code->nodes, node_name, callback_name);
+  mdi_context* previous;
+  int ret = enter_context(context, &previous);
+  if ( ret != 0 ) { return ret; }
+  ret = MDI_Accept_communicator(comm);
+  leave_context(previous);
+  return ret;
 }
 
 
-/*! \brief Check whether a callback exists on specified node on a specified engine
+/*! \brief Send data through the MDI connection, within a context
  *
+ * This function is equivalent to \p MDI_Send, called while \p context is selected.
  * The function returns \p 0 on a success.
  *
- * \param [in]       node_name
- *                   Name of the callbacks's node.
- * \param [in]       command_name
- *                   Name of the callback.
+ * \param [in]       context
+ *                   Handle of the context.
+ * \param [in]       buf
+ *                   Pointer to the data to be sent.
+ * \param [in]       count
+ *                   Number of values (integers, double precision floats, characters, etc.) to be sent.
+ * \param [in]       datatype
+ *                   MDI handle (MDI_INT, MDI_DOUBLE, MDI_CHAR, etc.) corresponding to the type of data to be sent.
  * \param [in]       comm
- *                   MDI communicator of the engine.  If comm is set to 
- *                   MDI_COMM_NULL, the function will check for the calling engine.
- * \param [out]      flag
- *                   On return, 1 if the callback is supported and 0 otherwise.
+ *                   MDI communicator associated with the intended recipient code.
  */
-int MDI_Check_Callback_Exists(const char* node_name, const char* callback_name, MDI_Comm comm, int* flag)
+int MDI_Send_ctx(MDI_Context context, const void* buf, int count, MDI_Datatype datatype, MDI_Comm comm)
 {
-  return MDI_Check_callback_exists(node_name, callback_name, comm, flag);
+  mdi_context* previous;
+  int ret = enter_context(context, &previous);
+  if ( ret != 0 ) { return ret; }
+  ret = MDI_Send(buf, count, datatype, comm);
+  leave_context(previous);
+  return ret;
 }
 
 
-/*! \brief Check whether a callback exists on specified node on a specified engine
+/*! \brief Receive data through the MDI connection, within a context
  *
+ * This function is equivalent to \p MDI_Recv, called while \p context is selected.
  * The function returns \p 0 on a success.
  *
- * \param [in]       node_name
- *                   Name of the callbacks's node.
- * \param [in]       command_name
- *                   Name of the callback.
+ * \param [in]       context
+ *                   Handle of the context.
+ * \param [out]      buf
+ *                   Pointer to the buffer where the received data will be stored.
+ * \param [in]       count
+ *                   Number of values (integers, double precision floats, characters, etc.) to be received.
+ * \param [in]       datatype
+ *                   MDI handle (MDI_INT, MDI_DOUBLE, MDI_CHAR, etc.) corresponding to the type of data to be received.
  * \param [in]       comm
- *                   MDI communicator of the engine.  If comm is set to 
- *                   MDI_COMM_NULL, the function will check for the calling engine.
- * \param [out]      flag
- *                   On return, 1 if the callback is supported and 0 otherwise.
+ *                   MDI communicator associated with the connection to the sending code.
  */
-int MDI_Check_callback_exists(const char* node_name, const char* callback_name, MDI_Comm comm, int* flag)
+int MDI_Recv_ctx(MDI_Context context, void* buf, int count, MDI_Datatype datatype, MDI_Comm comm)
 {
-  if ( is_initialized == 0 ) {
-    mdi_error("MDI_Check_Callback_Exists called but MDI has not been initialized");
-    return 1;
-  }
-
-  // confirm that the node_name size is not greater than MDI_COMMAND_LENGTH
-  if ( strlen(node_name) > COMMAND_LENGTH ) {
-    mdi_error("Node name is greater than MDI_COMMAND_LENGTH");
-    return 2;
-  }
-
-  // confirm that the callback_name size is not greater than MDI_COMMAND_LENGTH
-  if ( strlen(callback_name) > COMMAND_LENGTH ) {
-    mdi_error("Cannot check callback name with length greater than MDI_COMMAND_LENGTH");
-    return 3;
-  }
-
-  vector* node_vec = get_node_vector(comm);
-
-  // find the node
-  int node_index = get_node_index(node_vec, node_name);
-  if ( node_index == -1 ) {
-    mdi_error("Could not find the node");
-    return 4;
-  }
-  node* target_node = vector_get(node_vec, node_index);
-
-  // find the callback
-  int callback_index = get_callback_index(target_node, callback_name);
-  if ( callback_index == -1 ) {
-    *flag = 0;
-  }
-  else {
-    *flag = 1;
-  }
-  return 0;
+  mdi_context* previous;
+  int ret = enter_context(context, &previous);
+  if ( ret != 0 ) { return ret; }
+  ret = MDI_Recv(buf, count, datatype, comm);
+  leave_context(previous);
+  return ret;
 }
 
 
-/*! \brief Get the number of callbacks on a specified node on a specified engine
+/*! \brief Send a command of length \p MDI_COMMAND_LENGTH through the MDI connection, within a context
  *
+ * This function is equivalent to \p MDI_Send_command, called while \p context is selected.
+ * With the LINK method, the engine executes the command on the calling thread, within \p context.
  * The function returns \p 0 on a success.
  *
- * \param [in]       node_name
- *                   Name of the node.
+ * \param [in]       context
+ *                   Handle of the context.
+ * \param [in]       buf
+ *                   Pointer to the data to be sent.
  * \param [in]       comm
- *                   MDI communicator of the engine.  If comm is set to 
- *                   MDI_COMM_NULL, the function will check for the calling engine.
- * \param [out]      ncallbacks
- *                   On return, the number of callbacks on the specified node
- *                   on the specified engine.
+ *                   MDI communicator associated with the intended recipient code.
  */
-int MDI_Get_NCallbacks(const char* node_name, MDI_Comm comm, int* ncallbacks)
+int MDI_Send_command_ctx(MDI_Context context, const char* buf, MDI_Comm comm)
 {
-  return MDI_Get_ncallbacks(node_name, comm, ncallbacks);
+  mdi_context* previous;
+  int ret = enter_context(context, &previous);
+  if ( ret != 0 ) { return ret; }
+  ret = MDI_Send_command(buf, comm);
+  leave_context(previous);
+  return ret;
 }
 
 
-/*! \brief Get the number of callbacks on a specified node on a specified engine
+/*! \brief Receive a command of length \p MDI_COMMAND_LENGTH through the MDI connection, within a context
  *
+ * This function is equivalent to \p MDI_Recv_command, called while \p context is selected.
  * The function returns \p 0 on a success.
  *
- * \param [in]       node_name
- *                   Name of the node.
+ * \param [in]       context
+ *                   Handle of the context.
+ * \param [out]      buf
+ *                   Pointer to the buffer where the received data will be stored.
  * \param [in]       comm
- *                   MDI communicator of the engine.  If comm is set to 
- *                   MDI_COMM_NULL, the function will check for the calling engine.
- * \param [out]      ncallbacks
- *                   On return, the number of callbacks on the specified node
- *                   on the specified engine.
+ *                   MDI communicator associated with the connection to the sending code.
  */
-int MDI_Get_ncallbacks(const char* node_name, MDI_Comm comm, int* ncallbacks)
+int MDI_Recv_command_ctx(MDI_Context context, char* buf, MDI_Comm comm)
 {
-  if ( is_initialized == 0 ) {
-    mdi_error("MDI_Get_NCallbacks called but MDI has not been initialized");
-    return 1;
-  }
+  mdi_context* previous;
+  int ret = enter_context(context, &previous);
+  if ( ret != 0 ) { return ret; }
+  ret = MDI_Recv_command(buf, comm);
+  leave_context(previous);
+  return ret;
+}
 
-  // confirm that the node_name size is not greater than MDI_COMMAND_LENGTH
-  if ( strlen(node_name) > COMMAND_LENGTH ) {
-    mdi_error("Node name is greater than MDI_COMMAND_LENGTH");
-    return 2;
-  }
 
-  vector* node_vec = get_node_vector(comm);
+/*! \brief Set the callback MDI uses for MDI_Execute_Command, within a context
+ *
+ * This function is equivalent to \p MDI_Set_execute_command_func, called while \p context is selected.
+ * The function returns \p 0 on a success.
+ *
+ * \param [in]       context
+ *                   Handle of the context.
+ * \param [in]       generic_command
+ *                   Function pointer to the generic execute_command function
+ * \param [in]       class_object
+ *                   Pointer to the object that is passed to the execute_command function
+ */
+int MDI_Set_execute_command_func_ctx(MDI_Context context,
+                                     int (*generic_command)(const char*, MDI_Comm, void*),
+                                     void* class_object)
+{
+  mdi_context* previous;
+  int ret = enter_context(context, &previous);
+  if ( ret != 0 ) { return ret; }
+  ret = MDI_Set_execute_command_func(generic_command, class_object);
+  leave_context(previous);
+  return ret;
+}
 
-  // find the node
-  int node_index = get_node_index(node_vec, node_name);
-  if ( node_index == -1 ) {
-    mdi_error("Could not find the node");
-    return 3;
-  }
-  node* target_node = vector_get(node_vec, node_index);
 
-  *ncallbacks = (int)target_node->callbacks->size;
-  return 0;
+/*! \brief Register a communication method
+ *
+ * After this call, codes may connect through the method by passing its name to the
+ * \p -method option of MDI_Init().
+ * The method only needs to move bytes between two codes.
+ * The library forms the headers and bodies of messages, exchanges version numbers, and
+ * negotiates features exactly as it does for the builtin TCP method.
+ * The functions of the method are:
+ *   - \p init: called by MDI_Init() with the role and options of the code, and may set a
+ *     pointer to the state of the method.
+ *   - \p accept: called by drivers from MDI_Accept_Communicator() with the state of the method.
+ *     It sets a pointer to a new connection, or to NULL if no connection is pending.
+ *   - \p connect: called by engines from MDI_Init() with the state of the method, and sets
+ *     a pointer to the connection with the driver.
+ *   - \p send and \p recv: send or receive a number of bytes through a connection, and return
+ *     only once all of the bytes have been transferred.
+ *   - \p del: called with a connection that is no longer used.
+ *
+ * Each function returns \p 0 on a success.
+ * Only \p send, \p recv, and at least one of \p accept and \p connect are required.
+ * Methods are shared by all contexts, and are not protected by a lock, so they must be registered
+ * before any code is initialized with them and before any other thread makes an MDI call.
+ * The function returns \p 0 on a success.
+ *
+ * \param [in]       name
+ *                   Name of the method, which must differ from the name of any builtin or
+ *                   previously registered method.
+ * \param [in]       init
+ *                   Function that initializes the method for a code, or NULL.
+ * \param [in]       accept
+ *                   Function that accepts a connection from an engine, or NULL if drivers cannot use the method.
+ * \param [in]       connect
+ *                   Function that connects an engine to its driver, or NULL if engines cannot use the method.
+ * \param [in]       send
+ *                   Function that sends bytes through a connection.
+ * \param [in]       recv
+ *                   Function that receives bytes through a connection.
+ * \param [in]       del
+ *                   Function that closes a connection, or NULL.
+ */
+int MDI_Register_Method(const char* name, MDI_Method_init_t init, MDI_Method_connect_t accept,
+                        MDI_Method_connect_t connect, MDI_Method_send_t send,
+                        MDI_Method_recv_t recv, MDI_Method_delete_t del)
+{
+  return MDI_Register_method(name, init, accept, connect, send, recv, del);
 }
 
 
-/*! \brief Get the name of a callback on a specified node on a specified engine
+/*! \brief Register a communication method
+ *
+ * After this call, codes may connect through the method by passing its name to the
+ * \p -method option of MDI_Init().
+ * The method only needs to move bytes between two codes.
+ * The library forms the headers and bodies of messages, exchanges version numbers, and
+ * negotiates features exactly as it does for the builtin TCP method.
+ * The functions of the method are:
+ *   - \p init: called by MDI_Init() with the role and options of the code, and may set a
+ *     pointer to the state of the method.
+ *   - \p accept: called by drivers from MDI_Accept_Communicator() with the state of the method.
+ *     It sets a pointer to a new connection, or to NULL if no connection is pending.
+ *   - \p connect: called by engines from MDI_Init() with the state of the method, and sets
+ *     a pointer to the connection with the driver.
+ *   - \p send and \p recv: send or receive a number of bytes through a connection, and return
+ *     only once all of the bytes have been transferred.
+ *   - \p del: called with a connection that is no longer used.
+ *
+ * Each function returns \p 0 on a success.
+ * Only \p send, \p recv, and at least one of \p accept and \p connect are required.
+ * Methods are shared by all contexts, and are not protected by a lock, so they must be registered
+ * before any code is initialized with them and before any other thread makes an MDI call.
+ * The function returns \p 0 on a success.
  *
+ * \param [in]       name
+ *                   Name of the method, which must differ from the name of any builtin or
+ *                   previously registered method.
+ * \param [in]       init
+ *                   Function that initializes the method for a code, or NULL.
+ * \param [in]       accept
+ *                   Function that accepts a connection from an engine, or NULL if drivers cannot use the method.
+ * \param [in]       connect
+ *                   Function that connects an engine to its driver, or NULL if engines cannot use the method.
+ * \param [in]       send
+ *                   Function that sends bytes through a connection.
+ * \param [in]       recv
+ *                   Function that receives bytes through a connection.
+ * \param [in]       del
+ *                   Function that closes a connection, or NULL.
+ */
+int MDI_Register_method(const char* name, MDI_Method_init_t init, MDI_Method_connect_t accept,
+                        MDI_Method_connect_t connect, MDI_Method_send_t send,
+                        MDI_Method_recv_t recv, MDI_Method_delete_t del)
+{
+  return custom_register(name, init, accept, connect, send, recv, del);
+}
+
+
+/*! \brief Register a filter, so that it can be attached to communicators by name
+ *
+ * A filter is a stage through which the body of each message sent or received through a
+ * communicator passes.
+ * \p on_send is passed a pointer to the body of each message that is sent, before it is encoded
+ * by any negotiated codecs.
+ * It may leave the body unchanged, in which case it is sent without being copied, or point it at
+ * a transformed copy that it owns, which must remain valid until \p on_send is next called.
+ * \p on_recv is passed the body of each message that is received, after it has been decoded, and
+ * may transform it in place.
+ * Both are also passed the count and datatype of the body, the communicator, and \p state, and
+ * return \p 0 on a success; a nonzero return causes the send or receive to fail.
+ * A filter must not change the count or datatype of the body.
+ * Commands do not pass through filters.
+ * Filters are shared by all contexts, and are not protected by a lock, so they must be registered
+ * before any other thread makes an MDI call.
+ * The builtin \p finite filter verifies that every floating point value in a message is finite.
  * The function returns \p 0 on a success.
  *
- * \param [in]       node_name
- *                   Name of the node on which the callback is located.
- * \param [in]       index
- *                   Index of the callback on the specified node.
- * \param [in]       comm
- *                   MDI communicator of the engine.  If comm is set to 
- *                   MDI_COMM_NULL, the function will check for the calling engine.
- * \param [out]      name
- *                   On return, the name of the callback
+ * \param [in]       name
+ *                   Name of the filter, which must differ from the name of any previously registered filter.
+ * \param [in]       on_send
+ *                   Function that may replace the body of each message sent, or NULL.
+ * \param [in]       on_recv
+ *                   Function that may transform the body of each message received, or NULL.
+ * \param [in]       state
+ *                   Pointer passed to each call of \p on_send and \p on_recv.
  */
-int MDI_Get_Callback(const char* node_name, int index, MDI_Comm comm, char* name)
+int MDI_Register_filter(const char* name, MDI_Filter_send_t on_send, MDI_Filter_recv_t on_recv,
+                        void* state)
 {
-  return MDI_Get_callback(node_name, index, comm, name);
+  return filter_register(name, on_send, on_recv, state);
 }
 
 
-/*! \brief Get the name of a callback on a specified node on a specified engine
+/*! \brief Attach a registered filter to the end of the filter chain of a communicator
  *
+ * The body of each message that is sent passes through the filters of a communicator in the
+ * order in which they were attached, and the body of each message that is received passes
+ * through them in the reverse order.
+ * Filters may also be attached to every communicator of a code with the \p -filter option of
+ * MDI_Init().
  * The function returns \p 0 on a success.
  *
- * \param [in]       node_name
- *                   Name of the node on which the callback is located.
- * \param [in]       index
- *                   Index of the callback on the specified node.
  * \param [in]       comm
- *                   MDI communicator of the engine.  If comm is set to 
- *                   MDI_COMM_NULL, the function will check for the calling engine.
- * \param [out]      name
- *                   On return, the name of the callback
+ *                   MDI communicator to which the filter is attached.
+ * \param [in]       name
+ *                   Name of the filter.
  */
-int MDI_Get_callback(const char* node_name, int index, MDI_Comm comm, char* name)
+int MDI_Filter_push(MDI_Comm comm, const char* name)
 {
-  if ( is_initialized == 0 ) {
-    mdi_error("MDI_Get_Callback called but MDI has not been initialized");
+  if ( active_context->is_initialized == 0 ) {
+    mdi_error("MDI_Filter_push called but MDI has not been initialized");
+    return 1;
+  }
+  communicator* this_comm = get_communicator(active_context->current_code, comm);
+  if ( this_comm == NULL ) {
+    mdi_error("MDI_Filter_push called with an invalid communicator");
     return 1;
   }
+  int filter_index = filter_find(name);
+  if ( filter_index < 0 ) {
+    mdi_error("MDI_Filter_push called with an unrecognized filter");
+    return 1;
+  }
+  return filter_push(this_comm, filter_index);
+}
 
-  vector* node_vec = get_node_vector(comm);
 
-  // find the node
-  int node_index = get_node_index(node_vec, node_name);
-  if ( node_index == -1 ) {
-    mdi_error("MDI_Get_Command could not find the requested node");
-    return 2;
+/*! \brief Detach the most recently attached filter from the filter chain of a communicator
+ *
+ * The function returns \p 0 on a success.
+ *
+ * \param [in]       comm
+ *                   MDI communicator from which the filter is detached.
+ */
+int MDI_Filter_pop(MDI_Comm comm)
+{
+  if ( active_context->is_initialized == 0 ) {
+    mdi_error("MDI_Filter_pop called but MDI has not been initialized");
+    return 1;
   }
-  node* target_node = vector_get(node_vec, node_index);
-
-  if ( target_node->callbacks->size <= index ) {
-    mdi_error("MDI_Get_Command failed because the command does not exist");
-    return 3;
+  communicator* this_comm = get_communicator(active_context->current_code, comm);
+  if ( this_comm == NULL ) {
+    mdi_error("MDI_Filter_pop called with an invalid communicator");
+    return 1;
   }
-
-  char* target_callback = vector_get( target_node->callbacks, index );
-  snprintf(name, MDI_NAME_LENGTH, "%s", target_callback);
-  return 0;
+  return filter_pop(this_comm);
 }
 
 
@@ -1413,11 +2491,11 @@ int MDI_Get_callback(const char* node_name, int index, MDI_Comm comm, char* name
  */
 int MDI_MPI_get_world_comm(void* world_comm)
 {
-  if ( is_initialized == 0 ) {
+  if ( active_context->is_initialized == 0 ) {
     mdi_error("MDI_MPI_get_world_comm called but MDI has not been initialized");
     return 1;
   }
-  code* this_code = get_code(current_code);
+  code* this_code = get_code(active_context->current_code);
 
   if ( this_code->language == MDI_LANGUAGE_PYTHON ) {
     mdi_error("MDI_MPI_get_world_comm was called by a Python code");
@@ -1442,6 +2520,7 @@ int MDI_MPI_get_world_comm(void* world_comm)
 
 /*! \brief Launch an MDI plugin instance
  *
+ * Whether the plugin remains loaded afterwards is selected by MDI_Set_plugin_cache().
  * The function returns \p 0 on a success.
  *
  * \param [in]       plugin_name
@@ -1465,6 +2544,143 @@ int MDI_Launch_plugin(const char* plugin_name, const char* options, void* mpi_co
 }
 
 
+/*! \brief Launch an MDI plugin instance whose engine runs on a worker thread
+ *
+ * Unlike MDI_Launch_plugin(), this function returns as soon as the worker thread has started,
+ * together with an MDI communicator through which the calling driver sends commands to the
+ * engine, in the same way as to an engine that is connected through TCP.
+ * Commands and data pass between the threads through a pair of lock-free rings, so the driver
+ * can do other work, or drive several plugin instances at once, while each engine computes.
+ * The driver finishes the engine by sending \p EXIT, which waits for the worker thread to finish.
+ * MDI_Set_async_plugin_mode() selects whether the engine runs on a worker thread or as a coroutine.
+ * The function returns \p 0 on a success.
+ *
+ * \param [in]       plugin_name
+ *                   Name of the plugin.
+ * \param [in]       options
+ *                   Command-line options for the plugin.
+ * \param [in]       mpi_comm_ptr
+ *                   Pointer to an MPI intra-communicator that spans all ranks that will run this plugin instance.
+ * \param [out]      comm
+ *                   On return, the MDI communicator associated with the engine.
+ */
+int MDI_Launch_plugin_async(const char* plugin_name, const char* options, void* mpi_comm_ptr,
+                            MDI_Comm* comm) {
+  return async_launch_plugin(plugin_name, options, mpi_comm_ptr, comm);
+}
+
+
+/*! \brief Select how later calls to MDI_Launch_plugin_async run their engines
+ *
+ * With \p MDI_ASYNC_THREAD, which is the default, each engine runs on a worker thread.
+ * With \p MDI_ASYNC_COROUTINE, each engine runs as a coroutine on the thread of the driver,
+ * which switches to the engine whenever the driver waits for it, and back to the driver whenever
+ * the engine waits for a command or data.
+ * Coroutines cost no more than their stacks, so thousands of engines can run at once, but an
+ * engine only gives up the thread within MDI calls, and must not wait for anything else.
+ * The function returns \p 0 on a success.
+ *
+ * \param [in]       mode
+ *                   MDI_ASYNC_THREAD or MDI_ASYNC_COROUTINE.
+ * \param [in]       stack_size
+ *                   Size, in bytes, of the stack of each engine, or \p 0 for the default, which
+ *                   is 256 KiB for a coroutine and the system's default for a thread.
+ */
+int MDI_Set_async_plugin_mode(int mode, int64_t stack_size) {
+  if ( mode != MDI_ASYNC_THREAD && mode != MDI_ASYNC_COROUTINE ) {
+    mdi_error("Error in MDI_Set_async_plugin_mode: Mode not recognized");
+    return 1;
+  }
+  if ( stack_size < 0 ) {
+    mdi_error("Error in MDI_Set_async_plugin_mode: Invalid stack size");
+    return 1;
+  }
+  active_context->async_mode = mode;
+  active_context->async_stack_size = (size_t) stack_size;
+  return 0;
+}
+
+
+/*! \brief Launch an ensemble of MDI plugin instances, and share out a list of tasks among them
+ *
+ * This function is collective over the MPI communicator, which it partitions into the driver
+ * ranks, which are the first \p driver_nranks ranks, and a number of plugin instances of
+ * \p plugin_nranks ranks each.
+ * Each instance runs one task at a time, as a launch of the plugin in which \p task_callback is
+ * the driver node callback, and then asks the first driver rank for another task, so that
+ * instances which finish early take on more of the tasks.
+ * Every launch of an instance runs on the same ranks, and the partition is kept for later calls
+ * with the same communicator and numbers of ranks, so the communicator is only split once.
+ * MDI_Set_plugin_cache() applies to each launch, so the engine of each instance can remain
+ * connected from one task to the next.
+ * The function returns once every task has finished, and returns \p 0 on a success.
+ *
+ * \param [in]       plugin_name
+ *                   Name of the plugin.
+ * \param [in]       options
+ *                   Command-line options for the plugin.
+ * \param [in]       mpi_comm_ptr
+ *                   Pointer to the MPI communicator that is partitioned, such as the one
+ *                   returned by MDI_MPI_get_world_comm().
+ * \param [in]       driver_nranks
+ *                   Number of ranks that run the driver rather than plugin instances, which must be
+ *                   at least 1.
+ * \param [in]       plugin_nranks
+ *                   Number of ranks that run each plugin instance.
+ * \param [in]       ntasks
+ *                   Number of tasks, which are numbered from \p 0.
+ * \param [in]       task_callback
+ *                   Function that drives the engine of an instance through a task, which is
+ *                   passed the instance's MPI intra-communicator, the MDI communicator of its
+ *                   engine, the index of the task, and \p class_object.
+ * \param [in]       class_object
+ *                   Pointer to the object that is passed to \p task_callback.
+ */
+int MDI_Launch_plugin_ensemble(const char* plugin_name, const char* options, void* mpi_comm_ptr,
+                               int driver_nranks, int plugin_nranks, int ntasks,
+                               MDI_Ensemble_task_callback_t task_callback,
+                               void* class_object) {
+  return ensemble_launch(plugin_name, options, mpi_comm_ptr, driver_nranks, plugin_nranks, ntasks,
+                         task_callback, class_object);
+}
+
+
+/*! \brief Select whether later calls to MDI_Launch_plugin keep their plugin loaded
+ *
+ * With \p MDI_PLUGIN_UNLOAD, which is the default, each launch loads and unloads its plugin.
+ * With \p MDI_PLUGIN_RESIDENT, a plugin remains loaded after it is launched, so that later
+ * launches of the same plugin do not load it again, but each launch still initializes the plugin.
+ * With \p MDI_PLUGIN_KEEPALIVE, the engine created by the first launch also remains connected,
+ * and later launches call the driver node callback directly, so that the engine keeps its state.
+ * Plugins that remain loaded are unloaded by MDI_Unload_plugin().
+ * The function returns \p 0 on a success.
+ *
+ * \param [in]       mode
+ *                   MDI_PLUGIN_UNLOAD, MDI_PLUGIN_RESIDENT, or MDI_PLUGIN_KEEPALIVE.
+ */
+int MDI_Set_plugin_cache(int mode) {
+  if ( mode != MDI_PLUGIN_UNLOAD && mode != MDI_PLUGIN_RESIDENT && mode != MDI_PLUGIN_KEEPALIVE ) {
+    mdi_error("Error in MDI_Set_plugin_cache: Mode not recognized");
+    return 1;
+  }
+  active_context->plugin_cache_mode = mode;
+  return 0;
+}
+
+
+/*! \brief Unload a plugin that remained loaded after it was launched
+ *
+ * If the plugin was launched with \p MDI_PLUGIN_KEEPALIVE, its engine is also deleted.
+ * The function returns \p 0 on a success.
+ *
+ * \param [in]       plugin_name
+ *                   Name of the plugin.
+ */
+int MDI_Unload_plugin(const char* plugin_name) {
+  return library_unload_plugin(plugin_name);
+}
+
+
 /*! \brief Set the callback MDI uses for MDI_Execute_Command
  *
  * The function returns \p 0 on a success.
@@ -1485,7 +2701,7 @@ int MDI_Set_Execute_Command_Func(int (*generic_command)(const char*, MDI_Comm, v
  *                   Function pointer to the generic execute_command function
  */
 int MDI_Set_execute_command_func(int (*generic_command)(const char*, MDI_Comm, void*), void* class_object) {
-  code* this_code = get_code(current_code);
+  code* this_code = get_code(active_context->current_code);
   this_code->execute_command = generic_command;
   this_code->execute_command_obj = class_object;
   this_code->called_set_execute_command_func = 1;
@@ -1497,7 +2713,7 @@ int MDI_Set_execute_command_func(int (*generic_command)(const char*, MDI_Comm, v
  *
  */
 int MDI_Get_Current_Code() {
-  return current_code;
+  return active_context->current_code;
 }
 
 
@@ -39,10 +39,16 @@ MDI_COMMAND_LENGTH = ctypes.c_int.in_dll(mdi, "MDI_COMMAND_LENGTH").value
 MDI_NAME_LENGTH = ctypes.c_int.in_dll(mdi, "MDI_NAME_LENGTH").value
 MDI_LABEL_LENGTH = ctypes.c_int.in_dll(mdi, "MDI_LABEL_LENGTH").value
 MDI_COMM_NULL = ctypes.c_int.in_dll(mdi, "MDI_COMM_NULL").value
+MDI_REQUEST_NULL = ctypes.c_int.in_dll(mdi, "MDI_REQUEST_NULL").value
+MDI_CONTEXT_DEFAULT = ctypes.c_int.in_dll(mdi, "MDI_CONTEXT_DEFAULT").value
 MDI_INT = ctypes.c_int.in_dll(mdi, "MDI_INT").value
 MDI_DOUBLE = ctypes.c_int.in_dll(mdi, "MDI_DOUBLE").value
 MDI_CHAR = ctypes.c_int.in_dll(mdi, "MDI_CHAR").value
 MDI_BYTE = ctypes.c_int.in_dll(mdi, "MDI_BYTE").value
+MDI_FLOAT = ctypes.c_int.in_dll(mdi, "MDI_FLOAT").value
+MDI_INT64 = ctypes.c_int.in_dll(mdi, "MDI_INT64").value
+MDI_INT8 = ctypes.c_int.in_dll(mdi, "MDI_INT8").value
+MDI_COMPLEX_DOUBLE = ctypes.c_int.in_dll(mdi, "MDI_COMPLEX_DOUBLE").value
 MDI_TCP = ctypes.c_int.in_dll(mdi, "MDI_TCP").value
 MDI_MPI = ctypes.c_int.in_dll(mdi, "MDI_MPI").value
 MDI_LINK = ctypes.c_int.in_dll(mdi, "MDI_LINK").value
@@ -63,6 +69,15 @@ mpi4py_comms = {}
 # dictionary of function callbacks
 execute_command_dict = {}
 
+# dictionary of command handlers, keyed by the integer that the library passes to each call of a handler
+command_handler_dict = {}
+
+# the integers passed to the command handlers, keyed by the code and the names of the node and command
+command_handler_ids = {}
+
+# the codes that were initialized with the -persistent option, which keep their state after EXIT
+persistent_codes = set()
+
 # set_world_size
 mdi.MDI_Set_World_Size.argtypes = [ctypes.c_int]
 mdi.MDI_Set_World_Size.restype = None
@@ -77,11 +92,24 @@ mdi.MDI_Get_Current_Code.restype = ctypes.c_int
 def MDI_Get_Current_Code():
     return mdi.MDI_Get_Current_Code()
 
+# the key under which the Python state of the current code is stored
+# code handles are only unique within a context, so the key includes the context
+def current_code_key():
+    return ( MDI_Get_context(), MDI_Get_Current_Code() )
+
 # delete all Python state associated with the current code
+# a persistent engine keeps the state that is not specific to the communicator
 def delete_code_state(mdi_comm):
-    current_code = MDI_Get_Current_Code()
+    current_code = current_code_key()
+    if current_code in persistent_codes:
+        if mdi_comm in mpi4py_comms:
+            del mpi4py_comms[mdi_comm]
+        return
     if current_code in execute_command_dict.keys():
         del execute_command_dict[current_code]
+    for key in list(command_handler_ids.keys()):
+        if key[:2] == current_code:
+            del command_handler_dict[command_handler_ids.pop(key)]
 
     # if there is an mpi4py communicator associated with this mdi_comm, delete it
     if mdi_comm in mpi4py_comms:
@@ -123,6 +151,18 @@ def mpi4py_get_np_array(buf, count, datatype, mdi_comm):
     elif datatype == MDI_BYTE:
         mpi_type = MPI.BYTE
         datasize = ctypes.sizeof( ctypes.c_char )
+    elif datatype == MDI_FLOAT:
+        mpi_type = MPI.FLOAT
+        datasize = ctypes.sizeof( ctypes.c_float )
+    elif datatype == MDI_INT64:
+        mpi_type = MPI.INT64_T
+        datasize = ctypes.sizeof( ctypes.c_int64 )
+    elif datatype == MDI_INT8:
+        mpi_type = MPI.INT8_T
+        datasize = ctypes.sizeof( ctypes.c_int8 )
+    elif datatype == MDI_COMPLEX_DOUBLE:
+        mpi_type = MPI.C_DOUBLE_COMPLEX
+        datasize = 2 * ctypes.sizeof( ctypes.c_double )
     else:
         raise Exception("MDI Error: MDI type not recognized")
 
@@ -467,6 +507,8 @@ def MDI_Init(arg1, comm):
     ret = mdi.MDI_Init(ctypes.c_char_p(command), mpi_communicator_ptr )
     if ret != 0:
         raise Exception("MDI Error: MDI_Init failed")
+    if "-persistent" in args:
+        persistent_codes.add( current_code_key() )
 
     return ret
 
@@ -485,8 +527,9 @@ def MDI_Accept_Communicator():
     return comm.value
 
 # MDI_Send
-mdi.MDI_Send.argtypes = [ctypes.POINTER(ctypes.c_char), ctypes.c_int, ctypes.c_int, ctypes.c_int]
-mdi.MDI_Send.restype = ctypes.c_int
+# counts are passed to MDI_Send_c, so that messages with more than 2^31 - 1 elements are supported
+mdi.MDI_Send_c.argtypes = [ctypes.POINTER(ctypes.c_char), ctypes.c_int64, ctypes.c_int, ctypes.c_int]
+mdi.MDI_Send_c.restype = ctypes.c_int
 def MDI_Send(arg1, arg2, arg3, arg4):
     use_numpy = False
     if found_numpy:
@@ -505,6 +548,31 @@ def MDI_Send(arg1, arg2, arg3, arg4):
         if use_numpy:
             data_temp = arg1.astype(np.float64)
             data = data_temp.ctypes.data_as(ctypes.c_char_p)
+    elif (arg3 == MDI_FLOAT):
+        arg_type = ctypes.c_float
+        mdi_type = MDI_FLOAT
+        if use_numpy:
+            data_temp = arg1.astype(np.float32)
+            data = data_temp.ctypes.data_as(ctypes.c_char_p)
+    elif (arg3 == MDI_INT64):
+        arg_type = ctypes.c_int64
+        mdi_type = MDI_INT64
+        if use_numpy:
+            data_temp = arg1.astype(np.int64)
+            data = data_temp.ctypes.data_as(ctypes.c_char_p)
+    elif (arg3 == MDI_INT8):
+        arg_type = ctypes.c_int8
+        mdi_type = MDI_INT8
+        if use_numpy:
+            data_temp = arg1.astype(np.int8)
+            data = data_temp.ctypes.data_as(ctypes.c_char_p)
+    elif (arg3 == MDI_COMPLEX_DOUBLE):
+        # complex values are stored as pairs of doubles
+        arg_type = ctypes.c_double*2
+        mdi_type = MDI_COMPLEX_DOUBLE
+        if use_numpy:
+            data_temp = arg1.astype(np.complex128)
+            data = data_temp.ctypes.data_as(ctypes.c_char_p)
     elif (arg3 == MDI_BYTE):
         arg_type = ctypes.c_char
         mdi_type = MDI_BYTE
@@ -520,28 +588,24 @@ def MDI_Send(arg1, arg2, arg3, arg4):
     elif arg3 == MDI_BYTE:
         data = ctypes.c_char_p(arg1)
 
-    elif (arg3 == MDI_INT or arg3 == MDI_DOUBLE or arg3 == MDI_BYTE) and not use_numpy:
+    elif not use_numpy:
         if not isinstance(arg1, list):
             if arg2 == 1:
-                if arg3 == MDI_DOUBLE:
-                    data_temp = ctypes.pointer((ctypes.c_double)(arg1))
-                elif arg3 == MDI_INT:
-                    data_temp = ctypes.pointer((ctypes.c_int)(arg1))
-                elif arg3 == MDI_BYTE:
-                    data_temp = ctypes.pointer((ctypes.c_char)(arg1))
-                data = ctypes.cast(data_temp, ctypes.POINTER(ctypes.c_char))
+                arg1 = [ arg1 ]
             else:
-                raise Exception("MDI Error: MDI_Send requires a list if length != 1 and datatype = MDI_INT or MDI_DOUBLE")
+                raise Exception("MDI Error: MDI_Send requires a list if length != 1 and datatype is numeric")
+        if arg3 == MDI_COMPLEX_DOUBLE:
+            data_temp = (arg_type*arg2)(*[ arg_type(complex(val).real, complex(val).imag) for val in arg1 ])
         else:
             data_temp = (arg_type*arg2)(*arg1)
-            data = ctypes.cast(data_temp, ctypes.POINTER(ctypes.c_char))
+        data = ctypes.cast(data_temp, ctypes.POINTER(ctypes.c_char))
 
-    ret = mdi.MDI_Send(data, arg2, ctypes.c_int(mdi_type), arg4)
+    ret = mdi.MDI_Send_c(data, arg2, ctypes.c_int(mdi_type), arg4)
     if ret != 0:
         raise Exception("MDI Error: MDI_Send failed")
 
 # MDI_Recv
-mdi.MDI_Recv.restype = ctypes.c_int
+mdi.MDI_Recv_c.restype = ctypes.c_int
 def MDI_Recv(arg2, arg3, arg4, buf = None):
     if buf is None:
         use_numpy = False
@@ -551,26 +615,58 @@ def MDI_Recv(arg2, arg3, arg4, buf = None):
         raise Exception("MDI Error: Attempting to use a Numpy array, but the Numpy package was not found")
     if (arg3 == MDI_INT):
         if use_numpy:
-            mdi.MDI_Recv.argtypes = [np.ctypeslib.ndpointer(dtype=np.int32, flags='C_CONTIGUOUS'), 
-                                     ctypes.c_int, ctypes.c_int, ctypes.c_int]
+            mdi.MDI_Recv_c.argtypes = [np.ctypeslib.ndpointer(dtype=np.int32, flags='C_CONTIGUOUS'), 
+                                       ctypes.c_int64, ctypes.c_int, ctypes.c_int]
         else:
-            mdi.MDI_Recv.argtypes = [ctypes.POINTER(ctypes.c_char), ctypes.c_int, ctypes.c_int, ctypes.c_int]
+            mdi.MDI_Recv_c.argtypes = [ctypes.POINTER(ctypes.c_char), ctypes.c_int64, ctypes.c_int, ctypes.c_int]
         arg_type = ctypes.c_int
         mdi_type = MDI_INT
     elif (arg3 == MDI_DOUBLE):
         if use_numpy:
-            mdi.MDI_Recv.argtypes = [np.ctypeslib.ndpointer(dtype=np.float64, flags='C_CONTIGUOUS'), 
-                                     ctypes.c_int, ctypes.c_int, ctypes.c_int]
+            mdi.MDI_Recv_c.argtypes = [np.ctypeslib.ndpointer(dtype=np.float64, flags='C_CONTIGUOUS'), 
+                                       ctypes.c_int64, ctypes.c_int, ctypes.c_int]
         else:
-            mdi.MDI_Recv.argtypes = [ctypes.POINTER(ctypes.c_char), ctypes.c_int, ctypes.c_int, ctypes.c_int]
+            mdi.MDI_Recv_c.argtypes = [ctypes.POINTER(ctypes.c_char), ctypes.c_int64, ctypes.c_int, ctypes.c_int]
         arg_type = ctypes.c_double
         mdi_type = MDI_DOUBLE
+    elif (arg3 == MDI_FLOAT):
+        if use_numpy:
+            mdi.MDI_Recv_c.argtypes = [np.ctypeslib.ndpointer(dtype=np.float32, flags='C_CONTIGUOUS'), 
+                                       ctypes.c_int64, ctypes.c_int, ctypes.c_int]
+        else:
+            mdi.MDI_Recv_c.argtypes = [ctypes.POINTER(ctypes.c_char), ctypes.c_int64, ctypes.c_int, ctypes.c_int]
+        arg_type = ctypes.c_float
+        mdi_type = MDI_FLOAT
+    elif (arg3 == MDI_INT64):
+        if use_numpy:
+            mdi.MDI_Recv_c.argtypes = [np.ctypeslib.ndpointer(dtype=np.int64, flags='C_CONTIGUOUS'), 
+                                       ctypes.c_int64, ctypes.c_int, ctypes.c_int]
+        else:
+            mdi.MDI_Recv_c.argtypes = [ctypes.POINTER(ctypes.c_char), ctypes.c_int64, ctypes.c_int, ctypes.c_int]
+        arg_type = ctypes.c_int64
+        mdi_type = MDI_INT64
+    elif (arg3 == MDI_INT8):
+        if use_numpy:
+            mdi.MDI_Recv_c.argtypes = [np.ctypeslib.ndpointer(dtype=np.int8, flags='C_CONTIGUOUS'), 
+                                       ctypes.c_int64, ctypes.c_int, ctypes.c_int]
+        else:
+            mdi.MDI_Recv_c.argtypes = [ctypes.POINTER(ctypes.c_char), ctypes.c_int64, ctypes.c_int, ctypes.c_int]
+        arg_type = ctypes.c_int8
+        mdi_type = MDI_INT8
+    elif (arg3 == MDI_COMPLEX_DOUBLE):
+        if use_numpy:
+            mdi.MDI_Recv_c.argtypes = [np.ctypeslib.ndpointer(dtype=np.complex128, flags='C_CONTIGUOUS'), 
+                                       ctypes.c_int64, ctypes.c_int, ctypes.c_int]
+        else:
+            mdi.MDI_Recv_c.argtypes = [ctypes.POINTER(ctypes.c_char), ctypes.c_int64, ctypes.c_int, ctypes.c_int]
+        arg_type = ctypes.c_double*2
+        mdi_type = MDI_COMPLEX_DOUBLE
     elif (arg3 == MDI_BYTE):
-        mdi.MDI_Recv.argtypes = [ctypes.POINTER(ctypes.c_char), ctypes.c_int, ctypes.c_int, ctypes.c_int]
+        mdi.MDI_Recv_c.argtypes = [ctypes.POINTER(ctypes.c_char), ctypes.c_int64, ctypes.c_int, ctypes.c_int]
         arg_type = ctypes.c_char
         mdi_type = MDI_BYTE
     elif (arg3 == MDI_CHAR):
-        mdi.MDI_Recv.argtypes = [ctypes.POINTER(ctypes.c_char), ctypes.c_int, ctypes.c_int, ctypes.c_int]
+        mdi.MDI_Recv_c.argtypes = [ctypes.POINTER(ctypes.c_char), ctypes.c_int64, ctypes.c_int, ctypes.c_int]
         arg_type = ctypes.c_char
         mdi_type = MDI_CHAR
     else:
@@ -580,7 +676,7 @@ def MDI_Recv(arg2, arg3, arg4, buf = None):
         arg_size = ctypes.sizeof(arg_type)
         buf = (ctypes.c_char*(arg2*arg_size))()
 
-    ret = mdi.MDI_Recv(buf, arg2, ctypes.c_int(mdi_type), arg4)
+    ret = mdi.MDI_Recv_c(buf, arg2, ctypes.c_int(mdi_type), arg4)
     if ret != 0:
         raise Exception("MDI Error: MDI_Recv failed")
 
@@ -593,6 +689,12 @@ def MDI_Recv(arg2, arg3, arg4, buf = None):
         # if this is an MDI_CHAR, convert it to a python string
         presult = ctypes.cast(result, ctypes.c_char_p).value
         presult = presult.decode('utf-8')
+    elif (arg3 == MDI_COMPLEX_DOUBLE):
+        # convert each pair of doubles to a python complex number
+        if arg2 == 1:
+            presult = complex(result[0][0], result[0][1])
+        else:
+            presult = [ complex(result[i][0], result[i][1]) for i in range(arg2) ]
     else:
         if arg2 == 1:
             presult = result[0]
@@ -601,6 +703,212 @@ def MDI_Recv(arg2, arg3, arg4, buf = None):
 
     return presult
 
+# MDI_Send_c and MDI_Recv_c
+# MDI_Send and MDI_Recv already accept counts of any size
+MDI_Send_c = MDI_Send
+MDI_Recv_c = MDI_Recv
+
+# MDI_Send_strided
+mdi.MDI_Send_strided.argtypes = [ctypes.c_void_p, ctypes.c_int, ctypes.POINTER(ctypes.c_int64),
+                                 ctypes.POINTER(ctypes.c_int64), ctypes.c_int, ctypes.c_int]
+mdi.MDI_Send_strided.restype = ctypes.c_int
+def MDI_Send_strided(arg1, arg3, arg4):
+    if not found_numpy:
+        raise Exception("MDI Error: MDI_Send_strided requires numpy")
+    ndims = arg1.ndim
+    shape = (ctypes.c_int64*ndims)(*arg1.shape)
+    strides = (ctypes.c_int64*ndims)(*arg1.strides)
+    ret = mdi.MDI_Send_strided(arg1.ctypes.data, ndims, shape, strides, arg3, arg4)
+    if ret != 0:
+        raise Exception("MDI Error: MDI_Send_strided failed")
+
+# MDI_Recv_strided
+mdi.MDI_Recv_strided.argtypes = [ctypes.c_void_p, ctypes.c_int, ctypes.POINTER(ctypes.c_int64),
+                                 ctypes.POINTER(ctypes.c_int64), ctypes.c_int, ctypes.c_int]
+mdi.MDI_Recv_strided.restype = ctypes.c_int
+def MDI_Recv_strided(arg1, arg3, arg4):
+    if not found_numpy:
+        raise Exception("MDI Error: MDI_Recv_strided requires numpy")
+    if not arg1.flags.writeable:
+        raise Exception("MDI Error: MDI_Recv_strided requires a writeable array")
+    ndims = arg1.ndim
+    shape = (ctypes.c_int64*ndims)(*arg1.shape)
+    strides = (ctypes.c_int64*ndims)(*arg1.strides)
+    ret = mdi.MDI_Recv_strided(arg1.ctypes.data, ndims, shape, strides, arg3, arg4)
+    if ret != 0:
+        raise Exception("MDI Error: MDI_Recv_strided failed")
+
+# MDI_Sendv
+mdi.MDI_Sendv.argtypes = [ctypes.c_int, ctypes.POINTER(ctypes.c_void_p), ctypes.POINTER(ctypes.c_int64),
+                          ctypes.POINTER(ctypes.c_int), ctypes.c_int]
+mdi.MDI_Sendv.restype = ctypes.c_int
+def MDI_Sendv(arg1, arg3, arg4):
+    if not found_numpy:
+        raise Exception("MDI Error: MDI_Sendv requires numpy")
+    nseg = len(arg1)
+    arrays = [ np.ascontiguousarray(array) for array in arg1 ]
+    bufs = (ctypes.c_void_p*nseg)(*[ array.ctypes.data for array in arrays ])
+    counts = (ctypes.c_int64*nseg)(*[ array.size for array in arrays ])
+    datatypes = (ctypes.c_int*nseg)(*arg3)
+    ret = mdi.MDI_Sendv(nseg, bufs, counts, datatypes, arg4)
+    if ret != 0:
+        raise Exception("MDI Error: MDI_Sendv failed")
+
+# MDI_Recvv
+mdi.MDI_Recvv.argtypes = [ctypes.c_int, ctypes.POINTER(ctypes.c_void_p), ctypes.POINTER(ctypes.c_int64),
+                          ctypes.POINTER(ctypes.c_int), ctypes.c_int]
+mdi.MDI_Recvv.restype = ctypes.c_int
+def MDI_Recvv(arg1, arg3, arg4):
+    if not found_numpy:
+        raise Exception("MDI Error: MDI_Recvv requires numpy")
+    nseg = len(arg1)
+    for array in arg1:
+        if not array.flags['C_CONTIGUOUS'] or not array.flags.writeable:
+            raise Exception("MDI Error: MDI_Recvv requires writeable, contiguous arrays")
+    bufs = (ctypes.c_void_p*nseg)(*[ array.ctypes.data for array in arg1 ])
+    counts = (ctypes.c_int64*nseg)(*[ array.size for array in arg1 ])
+    datatypes = (ctypes.c_int*nseg)(*arg3)
+    ret = mdi.MDI_Recvv(nseg, bufs, counts, datatypes, arg4)
+    if ret != 0:
+        raise Exception("MDI Error: MDI_Recvv failed")
+
+# MDI_Send_init
+# the array must remain alive, and must not be reallocated, until the request is freed
+mdi.MDI_Send_init.argtypes = [ctypes.c_void_p, ctypes.c_int64, ctypes.c_int, ctypes.c_int,
+                              ctypes.POINTER(ctypes.c_int)]
+mdi.MDI_Send_init.restype = ctypes.c_int
+def MDI_Send_init(arg1, arg3, arg4):
+    if not found_numpy:
+        raise Exception("MDI Error: MDI_Send_init requires numpy")
+    if not arg1.flags['C_CONTIGUOUS']:
+        raise Exception("MDI Error: MDI_Send_init requires a contiguous array")
+    request = ctypes.c_int()
+    ret = mdi.MDI_Send_init(arg1.ctypes.data, arg1.size, arg3, arg4, ctypes.byref(request))
+    if ret != 0:
+        raise Exception("MDI Error: MDI_Send_init failed")
+    return request.value
+
+# MDI_Recv_init
+# the array must remain alive, and must not be reallocated, until the request is freed
+mdi.MDI_Recv_init.argtypes = [ctypes.c_void_p, ctypes.c_int64, ctypes.c_int, ctypes.c_int,
+                              ctypes.POINTER(ctypes.c_int)]
+mdi.MDI_Recv_init.restype = ctypes.c_int
+def MDI_Recv_init(arg1, arg3, arg4):
+    if not found_numpy:
+        raise Exception("MDI Error: MDI_Recv_init requires numpy")
+    if not arg1.flags['C_CONTIGUOUS'] or not arg1.flags.writeable:
+        raise Exception("MDI Error: MDI_Recv_init requires a writeable, contiguous array")
+    request = ctypes.c_int()
+    ret = mdi.MDI_Recv_init(arg1.ctypes.data, arg1.size, arg3, arg4, ctypes.byref(request))
+    if ret != 0:
+        raise Exception("MDI Error: MDI_Recv_init failed")
+    return request.value
+
+# MDI_Start
+mdi.MDI_Start.argtypes = [ctypes.c_int]
+mdi.MDI_Start.restype = ctypes.c_int
+def MDI_Start(arg1):
+    ret = mdi.MDI_Start(arg1)
+    if ret != 0:
+        raise Exception("MDI Error: MDI_Start failed")
+
+# MDI_Request_free
+mdi.MDI_Request_free.argtypes = [ctypes.POINTER(ctypes.c_int)]
+mdi.MDI_Request_free.restype = ctypes.c_int
+def MDI_Request_free(arg1):
+    request = ctypes.c_int(arg1)
+    ret = mdi.MDI_Request_free(ctypes.byref(request))
+    if ret != 0:
+        raise Exception("MDI Error: MDI_Request_free failed")
+
+# MDI_Send_stream and MDI_Recv_stream
+stream_func_type = ctypes.CFUNCTYPE(ctypes.c_int, ctypes.c_void_p, ctypes.c_int64, ctypes.c_int64, ctypes.c_void_p)
+mdi.MDI_Send_stream.argtypes = [ctypes.c_int64, ctypes.c_int, ctypes.c_int64, stream_func_type, ctypes.c_void_p,
+                                ctypes.c_int]
+mdi.MDI_Send_stream.restype = ctypes.c_int
+mdi.MDI_Recv_stream.argtypes = [ctypes.c_int64, ctypes.c_int, ctypes.c_int64, stream_func_type, ctypes.c_void_p,
+                                ctypes.c_int]
+mdi.MDI_Recv_stream.restype = ctypes.c_int
+
+def stream_get_dtype(datatype):
+    if datatype == MDI_INT:
+        return np.intc
+    elif datatype == MDI_DOUBLE:
+        return np.float64
+    elif datatype == MDI_CHAR or datatype == MDI_BYTE:
+        return np.uint8
+    elif datatype == MDI_FLOAT:
+        return np.float32
+    elif datatype == MDI_INT64:
+        return np.int64
+    elif datatype == MDI_INT8:
+        return np.int8
+    elif datatype == MDI_COMPLEX_DOUBLE:
+        return np.complex128
+    else:
+        raise Exception("MDI Error: MDI type not recognized")
+
+def stream_get_chunk(buf, count, dtype):
+    nbytes = count * np.dtype(dtype).itemsize
+    return np.ctypeslib.as_array( ctypes.cast(buf, ctypes.POINTER(ctypes.c_char*nbytes)).contents ).view(dtype)
+
+# the producer is called as producer(offset, count), and returns an array of count values
+def MDI_Send_stream(arg2, arg3, chunk_size, producer, arg4):
+    if not found_numpy:
+        raise Exception("MDI Error: MDI_Send_stream requires numpy")
+    dtype = stream_get_dtype(arg3)
+    def stream_callback(buf, offset, count, ctx):
+        try:
+            stream_get_chunk(buf, count, dtype)[:] = producer(offset, count)
+            return 0
+        except Exception as e:
+            sys.stderr.write("MDI Error in MDI_Send_stream producer: \n" + str(e) + "\n")
+            sys.stderr.flush()
+            return -1
+    ret = mdi.MDI_Send_stream(arg2, arg3, chunk_size, stream_func_type(stream_callback), None, arg4)
+    if ret != 0:
+        raise Exception("MDI Error: MDI_Send_stream failed")
+
+# the consumer is called as consumer(chunk, offset), where chunk is only valid during the call
+def MDI_Recv_stream(arg2, arg3, chunk_size, consumer, arg4):
+    if not found_numpy:
+        raise Exception("MDI Error: MDI_Recv_stream requires numpy")
+    dtype = stream_get_dtype(arg3)
+    def stream_callback(buf, offset, count, ctx):
+        try:
+            consumer(stream_get_chunk(buf, count, dtype), offset)
+            return 0
+        except Exception as e:
+            sys.stderr.write("MDI Error in MDI_Recv_stream consumer: \n" + str(e) + "\n")
+            sys.stderr.flush()
+            return -1
+    ret = mdi.MDI_Recv_stream(arg2, arg3, chunk_size, stream_func_type(stream_callback), None, arg4)
+    if ret != 0:
+        raise Exception("MDI Error: MDI_Recv_stream failed")
+
+# MDI_Send_units
+mdi.MDI_Send_units.argtypes = [ctypes.c_void_p, ctypes.c_int64, ctypes.c_int, ctypes.c_char_p, ctypes.c_int]
+mdi.MDI_Send_units.restype = ctypes.c_int
+def MDI_Send_units(arg1, arg3, units, arg4):
+    if not found_numpy:
+        raise Exception("MDI Error: MDI_Send_units requires numpy")
+    data = np.ascontiguousarray(arg1)
+    ret = mdi.MDI_Send_units(data.ctypes.data, data.size, arg3, units.encode('utf-8'), arg4)
+    if ret != 0:
+        raise Exception("MDI Error: MDI_Send_units failed")
+
+# MDI_Recv_units
+mdi.MDI_Recv_units.argtypes = [ctypes.c_void_p, ctypes.c_int64, ctypes.c_int, ctypes.c_char_p, ctypes.c_int]
+mdi.MDI_Recv_units.restype = ctypes.c_int
+def MDI_Recv_units(arg1, arg3, units, arg4):
+    if not found_numpy:
+        raise Exception("MDI Error: MDI_Recv_units requires numpy")
+    if not arg1.flags['C_CONTIGUOUS'] or not arg1.flags.writeable:
+        raise Exception("MDI Error: MDI_Recv_units requires a writeable, contiguous array")
+    ret = mdi.MDI_Recv_units(arg1.ctypes.data, arg1.size, arg3, units.encode('utf-8'), arg4)
+    if ret != 0:
+        raise Exception("MDI Error: MDI_Recv_units failed")
+
 # MDI_Send_Command
 mdi.MDI_Send_Command.argtypes = [ctypes.POINTER(ctypes.c_char), ctypes.c_int]
 mdi.MDI_Send_Command.restype = ctypes.c_int
@@ -665,7 +973,7 @@ def MDI_Execute_Command_py(command, comm, class_obj):
     command_py = command_py.decode('utf-8')
 
     # get the current code
-    current_code = MDI_Get_Current_Code()
+    current_code = current_code_key()
 
     class_obj_real = execute_command_dict[current_code][1]
     ret = execute_command_dict[current_code][0](command_py, comm, class_obj_real)
@@ -683,7 +991,7 @@ mdi.MDI_Set_Execute_Command_Func.restype = ctypes.c_int
 def MDI_Set_Execute_Command_Func(func, class_obj):
     global execute_command_dict
 
-    current_code = MDI_Get_Current_Code()
+    current_code = current_code_key()
 
     # store the generic execute command function for future use
     execute_command_dict[current_code] = ( func, class_obj )
@@ -695,6 +1003,53 @@ def MDI_Set_Execute_Command_Func(func, class_obj):
     if ret != 0:
         raise Exception("MDI Error: MDI_Set_Execute_Command_Func failed")
 
+# the command has already been matched to its handler by the library, so it is not decoded here
+def MDI_Command_Handler_py(command, comm, handler_id):
+    handler = command_handler_dict[handler_id]
+    ret = handler[0](comm, handler[1])
+    if ret is None:
+        ret = 0
+    return ret
+
+# MDI_Register_Command_Handler
+MDI_Command_Handler_c = execute_command_func_type( MDI_Command_Handler_py )
+mdi.MDI_Register_Command_Handler.argtypes = [ctypes.POINTER(ctypes.c_char), ctypes.POINTER(ctypes.c_char),
+                                             execute_command_func_type, ctypes.c_void_p]
+mdi.MDI_Register_Command_Handler.restype = ctypes.c_int
+def MDI_Register_Command_Handler(node_name, command_name, func, class_obj):
+    key = current_code_key() + ( node_name, command_name )
+
+    # a handler that is registered again for the same command on the same node keeps its integer
+    if key in command_handler_ids:
+        handler_id = command_handler_ids[key]
+    else:
+        handler_id = len(command_handler_ids) + 1
+        while handler_id in command_handler_dict:
+            handler_id += 1
+    command_handler_dict[handler_id] = ( func, class_obj )
+
+    node = node_name.encode('utf-8')
+    command = command_name.encode('utf-8')
+    ret = mdi.MDI_Register_Command_Handler( ctypes.c_char_p(node), ctypes.c_char_p(command),
+                                            MDI_Command_Handler_c, ctypes.c_void_p(handler_id) )
+    if ret != 0:
+        if key not in command_handler_ids:
+            del command_handler_dict[handler_id]
+        raise Exception("MDI Error: MDI_Register_Command_Handler failed")
+    command_handler_ids[key] = handler_id
+
+# MDI_Serve
+mdi.MDI_Serve.argtypes = [ctypes.c_int]
+mdi.MDI_Serve.restype = ctypes.c_int
+def MDI_Serve(comm):
+    ret = mdi.MDI_Serve(comm)
+    if ret != 0:
+        raise Exception("MDI Error: MDI_Serve failed")
+
+    # unless the commands of an engine library will be dispatched later, EXIT has been received
+    if comm != MDI_COMM_NULL:
+        delete_code_state(comm)
+
 
 
 ##################################################
@@ -876,3 +1231,68 @@ def MDI_Get_Callback(node_name, index, arg2):
         raise Exception("MDI Error: MDI_Get_Callback failed")
 
     return c_ptr_to_py_str(callback_name, MDI_COMMAND_LENGTH)
+
+# MDI_Freeze_Registry
+mdi.MDI_Freeze_Registry.argtypes = []
+mdi.MDI_Freeze_Registry.restype = ctypes.c_int
+def MDI_Freeze_Registry():
+    ret = mdi.MDI_Freeze_Registry()
+    if ret != 0:
+        raise Exception("MDI Error: MDI_Freeze_Registry failed")
+
+    return ret
+
+
+
+##################################################
+# Context management functions                   #
+##################################################
+
+# MDI_Context_create
+mdi.MDI_Context_create.argtypes = [ctypes.POINTER(ctypes.c_int)]
+mdi.MDI_Context_create.restype = ctypes.c_int
+def MDI_Context_create():
+    context = ctypes.c_int()
+    ret = mdi.MDI_Context_create(ctypes.byref(context))
+    if ret != 0:
+        raise Exception("MDI Error: MDI_Context_create failed")
+
+    return context.value
+
+# MDI_Context_free
+mdi.MDI_Context_free.argtypes = [ctypes.c_int]
+mdi.MDI_Context_free.restype = ctypes.c_int
+def MDI_Context_free(context):
+    ret = mdi.MDI_Context_free(context)
+    if ret != 0:
+        raise Exception("MDI Error: MDI_Context_free failed")
+
+    # delete the Python state of the codes in the context
+    for key in list(execute_command_dict.keys()):
+        if key[0] == context:
+            del execute_command_dict[key]
+    for key in list(command_handler_ids.keys()):
+        if key[0] == context:
+            del command_handler_dict[command_handler_ids.pop(key)]
+    for key in list(persistent_codes):
+        if key[0] == context:
+            persistent_codes.discard(key)
+
+# MDI_Set_context
+mdi.MDI_Set_context.argtypes = [ctypes.c_int]
+mdi.MDI_Set_context.restype = ctypes.c_int
+def MDI_Set_context(context):
+    ret = mdi.MDI_Set_context(context)
+    if ret != 0:
+        raise Exception("MDI Error: MDI_Set_context failed")
+
+# MDI_Get_context
+mdi.MDI_Get_context.argtypes = [ctypes.POINTER(ctypes.c_int)]
+mdi.MDI_Get_context.restype = ctypes.c_int
+def MDI_Get_context():
+    context = ctypes.c_int()
+    ret = mdi.MDI_Get_context(ctypes.byref(context))
+    if ret != 0:
+        raise Exception("MDI Error: MDI_Get_context failed")
+
+    return context.value
@@ -0,0 +1,717 @@
+/*! \file
+ *
+ * \brief Plugins that run on a worker thread, or as coroutines on the driver's thread
+ *
+ * A plugin launched by MDI_Launch_plugin_async runs its engine on a worker thread, within a
+ * context of its own, while the driver continues on its own thread.
+ * The two codes communicate through a pair of single-producer, single-consumer rings, one for
+ * each direction, which carry the same messages, including their headers, that the TCP method
+ * would carry.
+ * Each ring is only written by one thread and only read by the other, so the rings are lock-free:
+ * a thread that finds its ring full or empty polls it until the other thread makes progress.
+ *
+ * With MDI_ASYNC_COROUTINE, each engine instead runs as a coroutine on a small stack of its own,
+ * on the thread of the driver, so that thousands of engines cost no more than their stacks.
+ * The rings are the same, but a code that finds its ring full or empty switches to the other
+ * code rather than polling: an engine yields back to its driver, and a driver resumes the engine,
+ * which runs until it next waits for the driver.
+ * The coroutines use ucontext on POSIX systems, and fibers on Windows.
+ */
+#if defined(__APPLE__)
+// the ucontext functions are only declared with the X/Open interfaces
+#define _XOPEN_SOURCE 600
+#define _DARWIN_C_SOURCE
+#endif
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "mdi.h"
+#include "mdi_async.h"
+#include "mdi_datatype.h"
+#include "mdi_global.h"
+#include "mdi_lib.h"
+
+#ifndef _WIN32
+#include <sched.h>
+#include <sys/mman.h>
+#include <ucontext.h>
+#include <unistd.h>
+#endif
+
+/*! \brief Stack and saved registers of an engine that runs as a coroutine */
+typedef struct async_coroutine_struct {
+#ifdef _WIN32
+  /*! \brief Fiber on which the engine runs */
+  LPVOID fiber;
+  /*! \brief Fiber that most recently resumed the engine */
+  LPVOID caller;
+#else
+  /*! \brief Saved registers of the engine */
+  ucontext_t engine;
+  /*! \brief Saved registers of the driver, while the engine runs */
+  ucontext_t caller;
+  /*! \brief Memory of the stack, which begins with a guard page */
+  void* stack;
+  /*! \brief Size, in bytes, of the memory of the stack */
+  size_t stack_bytes;
+#endif
+} async_coroutine;
+
+#ifndef _WIN32
+// makecontext only passes int arguments, so a new coroutine finds its plugin here
+static MDI_THREAD_LOCAL async_plugin* async_starting = NULL;
+#endif
+
+
+/*! \brief Load a counter that is written by another thread
+ */
+static size_t async_load_size(size_t* ptr) {
+#ifdef _WIN32
+  size_t value = *(volatile size_t*) ptr;
+  MemoryBarrier();
+  return value;
+#else
+  return __atomic_load_n(ptr, __ATOMIC_ACQUIRE);
+#endif
+}
+
+
+/*! \brief Store a counter that is read by another thread
+ */
+static void async_store_size(size_t* ptr, size_t value) {
+#ifdef _WIN32
+  MemoryBarrier();
+  *(volatile size_t*) ptr = value;
+#else
+  __atomic_store_n(ptr, value, __ATOMIC_RELEASE);
+#endif
+}
+
+
+/*! \brief Load a flag that is written by another thread
+ */
+static int async_load_flag(int* ptr) {
+#ifdef _WIN32
+  int value = *(volatile int*) ptr;
+  MemoryBarrier();
+  return value;
+#else
+  return __atomic_load_n(ptr, __ATOMIC_ACQUIRE);
+#endif
+}
+
+
+/*! \brief Store a flag that is read by another thread
+ */
+static void async_store_flag(int* ptr, int value) {
+#ifdef _WIN32
+  MemoryBarrier();
+  *(volatile int*) ptr = value;
+#else
+  __atomic_store_n(ptr, value, __ATOMIC_RELEASE);
+#endif
+}
+
+
+/*! \brief Wait briefly for the other thread to make progress
+ *
+ * The ring is polled without yielding for the first ASYNC_SPIN_COUNT calls, which keeps short
+ * exchanges fast, after which each call yields to other threads.
+ *
+ * \param [in, out]  nspin
+ *                   Number of times the caller has polled the ring without making progress.
+ */
+static void async_pause(int* nspin) {
+  if ( *nspin < ASYNC_SPIN_COUNT ) {
+    (*nspin)++;
+    return;
+  }
+#ifdef _WIN32
+  SwitchToThread();
+#else
+  sched_yield();
+#endif
+}
+
+
+/*! \brief Switch from a driver to the coroutine of its engine, until the engine next waits
+ *
+ * \param [in]       plugin
+ *                   The plugin.
+ */
+static void async_resume(async_plugin* plugin) {
+  async_coroutine* coroutine = plugin->coroutine;
+  mdi_context* driver_context = active_context;
+#ifdef _WIN32
+  coroutine->caller = GetCurrentFiber();
+  SwitchToFiber(coroutine->fiber);
+#else
+  async_starting = plugin;
+  swapcontext(&coroutine->caller, &coroutine->engine);
+#endif
+  active_context = driver_context;
+}
+
+
+/*! \brief Switch from the coroutine of an engine back to the driver that resumed it
+ *
+ * \param [in]       plugin
+ *                   The plugin.
+ */
+static void async_yield(async_plugin* plugin) {
+  async_coroutine* coroutine = plugin->coroutine;
+  mdi_context* engine_context = active_context;
+#ifdef _WIN32
+  SwitchToFiber(coroutine->caller);
+#else
+  swapcontext(&coroutine->engine, &coroutine->caller);
+#endif
+  active_context = engine_context;
+}
+
+
+/*! \brief Wait for the other code of a plugin to make progress on a ring
+ *
+ * A worker thread polls, while a coroutine switches to the other code.
+ * A driver that has resumed its engine once without any progress is waiting for an engine
+ * that is itself waiting for the driver, which is reported as an error.
+ * The function returns \p 0 on a success.
+ *
+ * \param [in]       data
+ *                   Method data of the communicator.
+ * \param [in, out]  nspin
+ *                   Number of times the caller has waited without making progress.
+ */
+static int async_wait(async_data* data, int* nspin) {
+  async_plugin* plugin = data->plugin;
+  if ( plugin->coroutine == NULL ) {
+    async_pause(nspin);
+    return 0;
+  }
+  if ( ! data->is_driver ) {
+    async_yield(plugin);
+    return 0;
+  }
+  if ( *nspin > 0 ) {
+    mdi_error("Error in MDI: The plugin engine and its driver are each waiting for the other");
+    return 1;
+  }
+  (*nspin)++;
+  async_resume(plugin);
+  return 0;
+}
+
+
+/*! \brief Write bytes to the outgoing ring of a communicator
+ *
+ * Messages larger than the ring are written in pieces, as the other thread reads them.
+ * The function returns \p 0 on a success.
+ *
+ * \param [in]       data
+ *                   Method data of the communicator.
+ * \param [in]       buf
+ *                   Pointer to the bytes to be written.
+ * \param [in]       nbytes
+ *                   Number of bytes to be written.
+ */
+static int async_ring_write(async_data* data, const char* buf, size_t nbytes) {
+  async_ring* ring = data->out;
+  int nspin = 0;
+  while ( nbytes > 0 ) {
+    size_t head = ring->head;
+    size_t space = ring->capacity - ( head - async_load_size(&ring->tail) );
+    if ( space == 0 ) {
+      if ( async_load_flag(data->peer_done) ) {
+        mdi_error("Error in MDI: The connected plugin code finished before it received a message");
+        return 1;
+      }
+      if ( async_wait(data, &nspin) != 0 ) {
+        return 1;
+      }
+      continue;
+    }
+
+    // copy as much as fits, wrapping around the end of the ring
+    size_t nwrite = ( nbytes < space ) ? nbytes : space;
+    size_t offset = head & ( ring->capacity - 1 );
+    size_t nfirst = ring->capacity - offset;
+    if ( nfirst > nwrite ) {
+      nfirst = nwrite;
+    }
+    memcpy(ring->data + offset, buf, nfirst);
+    memcpy(ring->data, buf + nfirst, nwrite - nfirst);
+    async_store_size(&ring->head, head + nwrite);
+
+    buf += nwrite;
+    nbytes -= nwrite;
+    nspin = 0;
+  }
+  return 0;
+}
+
+
+/*! \brief Read bytes from the incoming ring of a communicator
+ *
+ * The function returns \p 0 on a success.
+ *
+ * \param [in]       data
+ *                   Method data of the communicator.
+ * \param [out]      buf
+ *                   Pointer to the buffer where the bytes will be stored.
+ * \param [in]       nbytes
+ *                   Number of bytes to be read.
+ */
+static int async_ring_read(async_data* data, char* buf, size_t nbytes) {
+  async_ring* ring = data->in;
+  int nspin = 0;
+  while ( nbytes > 0 ) {
+    size_t tail = ring->tail;
+    size_t available = async_load_size(&ring->head) - tail;
+    if ( available == 0 ) {
+      // the other code may have written its last bytes just before it finished
+      if ( async_load_flag(data->peer_done) && async_load_size(&ring->head) == tail ) {
+        mdi_error("Error in MDI: The connected plugin code finished before it sent a message");
+        return 1;
+      }
+      if ( async_wait(data, &nspin) != 0 ) {
+        return 1;
+      }
+      continue;
+    }
+
+    // copy as much as is available, wrapping around the end of the ring
+    size_t nread = ( nbytes < available ) ? nbytes : available;
+    size_t offset = tail & ( ring->capacity - 1 );
+    size_t nfirst = ring->capacity - offset;
+    if ( nfirst > nread ) {
+      nfirst = nread;
+    }
+    memcpy(buf, ring->data + offset, nfirst);
+    memcpy(buf + nfirst, ring->data, nread - nfirst);
+    async_store_size(&ring->tail, tail + nread);
+
+    buf += nread;
+    nbytes -= nread;
+    nspin = 0;
+  }
+  return 0;
+}
+
+
+/*! \brief Create a communicator through which one code of an asynchronous plugin reaches the other
+ *
+ * Both codes use this build of the library, so the version numbers and features are set
+ * directly, rather than exchanged through the rings.
+ * The function returns the handle of the new communicator, or \p MDI_COMM_NULL on a failure.
+ *
+ * \param [in]       this_code
+ *                   The code that owns the communicator.
+ * \param [in]       plugin
+ *                   The plugin.
+ * \param [in]       is_driver
+ *                   \p 1 if this_code is the driver, or \p 0 if it is the engine.
+ */
+static MDI_Comm async_new_communicator(code* this_code, async_plugin* plugin, int is_driver) {
+  MDI_Comm comm_id = new_communicator(this_code->id, MDI_METHOD_ASYNC);
+  if ( comm_id == MDI_COMM_NULL ) {
+    mdi_error("Error in MDI: unable to create a communicator for an asynchronous plugin");
+    return MDI_COMM_NULL;
+  }
+  communicator* new_comm = get_communicator(this_code->id, comm_id);
+  new_comm->send = async_send;
+  new_comm->recv = async_recv;
+  new_comm->delete = communicator_delete_async;
+  new_comm->partial_body = 1;
+  new_comm->mdi_version[0] = MDI_MAJOR_VERSION;
+  new_comm->mdi_version[1] = MDI_MINOR_VERSION;
+  new_comm->mdi_version[2] = MDI_PATCH_VERSION;
+  new_comm->features = MDI_FEATURE_LARGE_COUNT | MDI_FEATURE_VECTOR | MDI_FEATURE_UNITS | MDI_FEATURE_REGISTRY_KEY;
+
+  async_data* data = malloc(sizeof(async_data));
+  data->plugin = plugin;
+  data->is_driver = is_driver;
+  if ( is_driver ) {
+    data->out = &plugin->to_engine;
+    data->in = &plugin->to_driver;
+    data->peer_done = &plugin->engine_done;
+  }
+  else {
+    data->out = &plugin->to_driver;
+    data->in = &plugin->to_engine;
+    data->peer_done = &plugin->driver_done;
+  }
+  new_comm->method_data = data;
+
+  return comm_id;
+}
+
+
+/*! \brief Run the plugin's initialization function, on the worker thread or in the coroutine
+ *
+ * \param [in]       plugin
+ *                   The plugin.
+ */
+static void async_run_engine(async_plugin* plugin) {
+  // the engine is initialized within the plugin's own context
+  mdi_context* previous;
+  if ( enter_context(plugin->context, &previous) == 0 ) {
+    active_context->async_plugin = plugin;
+    plugin->ret = plugin->plugin_init();
+    if ( plugin->ret != 0 ) {
+      mdi_error("MDI plugin init function returned non-zero exit code");
+    }
+    leave_context(previous);
+  }
+  else {
+    plugin->ret = 1;
+  }
+
+  async_store_flag(&plugin->engine_done, 1);
+}
+
+
+/*! \brief Entry point of the worker thread of a plugin
+ *
+ * \param [in]       arg
+ *                   The plugin.
+ */
+#ifdef _WIN32
+static DWORD WINAPI async_run(LPVOID arg) {
+#else
+static void* async_run(void* arg) {
+#endif
+  async_run_engine((async_plugin*) arg);
+  return 0;
+}
+
+
+/*! \brief Entry point of the coroutine of a plugin
+ *
+ * Once the engine finishes, control returns to the driver for the last time.
+ */
+#ifdef _WIN32
+static VOID CALLBACK async_run_coroutine(LPVOID arg) {
+  async_plugin* plugin = (async_plugin*) arg;
+  async_run_engine(plugin);
+
+  // a fiber must never return
+  SwitchToFiber(plugin->coroutine->caller);
+}
+#else
+static void async_run_coroutine() {
+  async_run_engine(async_starting);
+}
+#endif
+
+
+/*! \brief Create the coroutine of a plugin, without running it
+ *
+ * The function returns \p 0 on a success.
+ *
+ * \param [in]       plugin
+ *                   The plugin.
+ * \param [in]       stack_size
+ *                   Size, in bytes, of the coroutine's stack.
+ */
+static int async_new_coroutine(async_plugin* plugin, size_t stack_size) {
+  async_coroutine* coroutine = calloc(1, sizeof(async_coroutine));
+  if ( coroutine == NULL ) {
+    return 1;
+  }
+  plugin->coroutine = coroutine;
+#ifdef _WIN32
+  // only a fiber can switch to another fiber
+  if ( ! IsThreadAFiber() && ConvertThreadToFiber(NULL) == NULL ) {
+    return 1;
+  }
+  coroutine->fiber = CreateFiber(stack_size, async_run_coroutine, plugin);
+  if ( coroutine->fiber == NULL ) {
+    return 1;
+  }
+#else
+  // the page below the stack is left inaccessible, so that an overflow faults
+  size_t page_size = (size_t) sysconf(_SC_PAGESIZE);
+  stack_size = ( ( stack_size + page_size - 1 ) / page_size ) * page_size;
+  coroutine->stack = mmap(NULL, stack_size + page_size, PROT_READ | PROT_WRITE,
+                          MAP_PRIVATE | MAP_ANON, -1, 0);
+  if ( coroutine->stack == MAP_FAILED ) {
+    coroutine->stack = NULL;
+    return 1;
+  }
+  coroutine->stack_bytes = stack_size + page_size;
+  if ( mprotect(coroutine->stack, page_size, PROT_NONE) != 0 ||
+       getcontext(&coroutine->engine) != 0 ) {
+    return 1;
+  }
+  coroutine->engine.uc_stack.ss_sp = (char*) coroutine->stack + page_size;
+  coroutine->engine.uc_stack.ss_size = stack_size;
+  coroutine->engine.uc_link = &coroutine->caller;
+  makecontext(&coroutine->engine, async_run_coroutine, 0);
+#endif
+  return 0;
+}
+
+
+/*! \brief Free a plugin, after its engine has finished
+ *
+ * \param [in]       plugin
+ *                   The plugin.
+ */
+static void async_free_plugin(async_plugin* plugin) {
+  if ( plugin->context >= 0 ) {
+    delete_context(plugin->context);
+  }
+  if ( plugin->handle != NULL ) {
+    library_close_plugin(plugin->handle);
+  }
+  if ( plugin->coroutine != NULL ) {
+#ifdef _WIN32
+    if ( plugin->coroutine->fiber != NULL ) {
+      DeleteFiber(plugin->coroutine->fiber);
+    }
+#else
+    if ( plugin->coroutine->stack != NULL ) {
+      munmap(plugin->coroutine->stack, plugin->coroutine->stack_bytes);
+    }
+#endif
+    free( plugin->coroutine );
+  }
+  free( plugin->to_engine.data );
+  free( plugin->to_driver.data );
+  free( plugin );
+}
+
+
+/*! \brief Launch an MDI plugin whose engine runs on a worker thread, or as a coroutine
+ *
+ * The active context's async_mode selects which, and a coroutine runs until its engine first
+ * waits for the driver before this returns.
+ * The function returns \p 0 on a success.
+ *
+ * \param [in]       plugin_name
+ *                   Name of the plugin.
+ * \param [in]       options
+ *                   Command-line options for the plugin.
+ * \param [in]       mpi_comm_ptr
+ *                   Pointer to an MPI intra-communicator that spans all ranks that will run this plugin instance.
+ * \param [out]      comm
+ *                   On return, the MDI communicator through which the driver reaches the engine.
+ */
+int async_launch_plugin(const char* plugin_name, const char* options, void* mpi_comm_ptr, MDI_Comm* comm) {
+  int ret;
+  *comm = MDI_COMM_NULL;
+  code* this_code = get_code(active_context->current_code);
+  if ( strcmp(this_code->role, "DRIVER") != 0 ) {
+    mdi_error("Error in MDI_Launch_plugin_async: Only a driver may launch a plugin");
+    return 1;
+  }
+
+  async_plugin* plugin = calloc(1, sizeof(async_plugin));
+  if ( plugin == NULL ) {
+    mdi_error("Error in MDI_Launch_plugin_async: Unable to allocate the plugin");
+    return 1;
+  }
+  plugin->context = -1;
+  plugin->mpi_comm = *(MPI_Comm*) mpi_comm_ptr;
+  MPI_Comm_rank( plugin->mpi_comm, &plugin->rank );
+  size_t capacity = ( active_context->async_mode == MDI_ASYNC_COROUTINE ) ?
+    ASYNC_COROUTINE_RING_CAPACITY : ASYNC_RING_CAPACITY;
+  plugin->to_engine.capacity = capacity;
+  plugin->to_driver.capacity = capacity;
+  plugin->to_engine.data = malloc( capacity );
+  plugin->to_driver.data = malloc( capacity );
+  if ( plugin->to_engine.data == NULL || plugin->to_driver.data == NULL ) {
+    mdi_error("Error in MDI_Launch_plugin_async: Unable to allocate the rings");
+    async_free_plugin(plugin);
+    return 1;
+  }
+
+  // load the plugin, and create the context in which its engine will run
+  ret = library_open_plugin(plugin_name, &plugin->handle, &plugin->plugin_init);
+  if ( ret != 0 ) {
+    async_free_plugin(plugin);
+    return ret;
+  }
+  ret = new_context(&plugin->context);
+  if ( ret != 0 ) {
+    plugin->context = -1;
+    async_free_plugin(plugin);
+    return ret;
+  }
+
+  // create the driver's communicator, which owns the plugin from now on
+  // the communicator is returned directly, rather than by MDI_Accept_Communicator
+  MDI_Comm comm_id = async_new_communicator(this_code, plugin, 1);
+  if ( comm_id == MDI_COMM_NULL ) {
+    async_free_plugin(plugin);
+    return 1;
+  }
+  get_communicator(this_code->id, comm_id)->returned = 1;
+
+  size_t stack_size = active_context->async_stack_size;
+  if ( active_context->async_mode == MDI_ASYNC_COROUTINE ) {
+    // start the coroutine, which runs until its engine waits for the first command
+    if ( stack_size == 0 ) {
+      stack_size = ASYNC_DEFAULT_STACK_SIZE;
+    }
+    if ( async_new_coroutine(plugin, stack_size) != 0 ) {
+      mdi_error("Error in MDI_Launch_plugin_async: Unable to create the coroutine");
+      plugin->engine_done = 1;
+      delete_communicator(this_code->id, comm_id);
+      return 1;
+    }
+    plugin->started = 1;
+    async_resume(plugin);
+  }
+  else {
+    // start the worker thread
+#ifdef _WIN32
+    plugin->thread = CreateThread(NULL, stack_size, async_run, plugin, 0, NULL);
+    plugin->started = ( plugin->thread != NULL );
+#else
+    pthread_attr_t attr;
+    pthread_attr_init(&attr);
+    if ( stack_size > 0 ) {
+      pthread_attr_setstacksize(&attr, stack_size);
+    }
+    plugin->started = ( pthread_create(&plugin->thread, &attr, async_run, plugin) == 0 );
+    pthread_attr_destroy(&attr);
+#endif
+    if ( ! plugin->started ) {
+      mdi_error("Error in MDI_Launch_plugin_async: Unable to start the worker thread");
+      plugin->engine_done = 1;
+      delete_communicator(this_code->id, comm_id);
+      return 1;
+    }
+  }
+
+  *comm = comm_id;
+  return 0;
+}
+
+
+/*! \brief Initialize the communicator of the engine of an asynchronous plugin
+ *
+ * This is called by MDI_Init, in place of library_initialize, when the plugin's engine
+ * initializes itself with the LINK method.
+ * The function returns \p 0 on a success.
+ */
+int async_initialize() {
+  code* this_code = get_code(active_context->current_code);
+  async_plugin* plugin = active_context->async_plugin;
+
+  // set the engine's mpi communicator
+  this_code->intra_MPI_comm = plugin->mpi_comm;
+  this_code->intra_rank = plugin->rank;
+
+  if ( async_new_communicator(this_code, plugin, 0) == MDI_COMM_NULL ) {
+    return 1;
+  }
+  return 0;
+}
+
+
+/*! \brief Send data through an MDI connection to or from an asynchronous plugin
+ *
+ * \param [in]       buf
+ *                   Pointer to the data to be sent.
+ * \param [in]       count
+ *                   Number of values (integers, double precision floats, characters, etc.) to be sent.
+ * \param [in]       datatype
+ *                   MDI handle (MDI_INT, MDI_DOUBLE, MDI_CHAR, etc.) corresponding to the type of data to be sent.
+ * \param [in]       comm
+ *                   MDI communicator associated with the intended recipient code.
+ * \param [in]       msg_flag
+ *                   Type of role this data has within a message.
+ *                   0: Not part of a message.
+ *                   1: The header of a message.
+ *                   2: The body (data) of a message.
+ */
+int async_send(const void* buf, size_t count, MDI_Datatype datatype, MDI_Comm comm, int msg_flag) {
+  communicator* this = get_communicator(active_context->current_code, comm);
+  async_data* data = (async_data*) this->method_data;
+
+  // as with TCP, only rank 0 of the plugin instance communicates
+  if ( data->plugin->rank != 0 ) {
+    return 0;
+  }
+
+  size_t datasize = datatype_size(datatype);
+  if ( datasize == 0 ) {
+    mdi_error("MDI data type not recognized in async_send");
+    return 1;
+  }
+
+  return async_ring_write(data, (const char*) buf, count * datasize);
+}
+
+
+/*! \brief Receive data through an MDI connection to or from an asynchronous plugin
+ *
+ * \param [in]       buf
+ *                   Pointer to the buffer where the received data will be stored.
+ * \param [in]       count
+ *                   Number of values (integers, double precision floats, characters, etc.) to be received.
+ * \param [in]       datatype
+ *                   MDI handle (MDI_INT, MDI_DOUBLE, MDI_CHAR, etc.) corresponding to the type of data to be received.
+ * \param [in]       comm
+ *                   MDI communicator associated with the connection to the sending code.
+ * \param [in]       msg_flag
+ *                   Type of role this data has within a message.
+ *                   0: Not part of a message.
+ *                   1: The header of a message.
+ *                   2: The body (data) of a message.
+ */
+int async_recv(void* buf, size_t count, MDI_Datatype datatype, MDI_Comm comm, int msg_flag) {
+  communicator* this = get_communicator(active_context->current_code, comm);
+  async_data* data = (async_data*) this->method_data;
+
+  // as with TCP, only rank 0 of the plugin instance communicates
+  if ( data->plugin->rank != 0 ) {
+    return 0;
+  }
+
+  size_t datasize = datatype_size(datatype);
+  if ( datasize == 0 ) {
+    mdi_error("MDI data type not recognized in async_recv");
+    return 1;
+  }
+
+  return async_ring_read(data, (char*) buf, count * datasize);
+}
+
+
+/*! \brief Function for asynchronous-plugin-specific deletion operations for communicator deletion
+ *
+ * Deleting the driver's communicator waits for the engine to finish, and then frees the plugin.
+ * A coroutine is resumed until its engine finishes.
+ */
+int communicator_delete_async(void* comm) {
+  communicator* this_comm = (communicator*) comm;
+  async_data* data = (async_data*) this_comm->method_data;
+  async_plugin* plugin = data->plugin;
+  int is_driver = data->is_driver;
+  free( data );
+  if ( ! is_driver ) {
+    return 0;
+  }
+
+  // an engine that is still waiting for a message will find that the driver is finished
+  async_store_flag(&plugin->driver_done, 1);
+  if ( plugin->started && plugin->coroutine != NULL ) {
+    while ( ! plugin->engine_done ) {
+      async_resume(plugin);
+    }
+  }
+  else if ( plugin->started ) {
+#ifdef _WIN32
+    WaitForSingleObject(plugin->thread, INFINITE);
+    CloseHandle(plugin->thread);
+#else
+    pthread_join(plugin->thread, NULL);
+#endif
+  }
+
+  async_free_plugin(plugin);
+  return 0;
+}
@@ -0,0 +1,103 @@
+/*! \file
+ *
+ * \brief Plugins that run on a worker thread, or as coroutines on the driver's thread
+ */
+
+#ifndef MDI_ASYNC_IMPL
+#define MDI_ASYNC_IMPL
+
+#include "mdi.h"
+#include "mdi_global.h"
+#include "mdi_lib.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <pthread.h>
+#endif
+
+/*! \brief Communication method of communicators to a plugin that runs on a worker thread */
+#define MDI_METHOD_ASYNC 6
+
+/*! \brief Capacity, in bytes, of each ring through which an asynchronous plugin communicates.
+Must be a power of two. */
+#define ASYNC_RING_CAPACITY ( 1 << 20 )
+
+/*! \brief Capacity, in bytes, of each ring of a plugin that runs as a coroutine.
+Must be a power of two.
+A coroutine's rings are smaller, because a full ring simply switches to the other code. */
+#define ASYNC_COROUTINE_RING_CAPACITY ( 1 << 16 )
+
+/*! \brief Default size, in bytes, of the stack of a plugin that runs as a coroutine */
+#define ASYNC_DEFAULT_STACK_SIZE ( 1 << 18 )
+
+/*! \brief Number of times a thread polls a ring before it yields to other threads */
+#define ASYNC_SPIN_COUNT 1024
+
+typedef struct async_ring_struct {
+  /*! \brief Storage of the ring */
+  char* data;
+  /*! \brief Size of the storage of the ring, which is a power of two */
+  size_t capacity;
+  /*! \brief Total number of bytes written to the ring, which is only updated by the producer */
+  size_t head;
+  /*! \brief Total number of bytes read from the ring, which is only updated by the consumer */
+  size_t tail;
+} async_ring;
+
+struct async_coroutine_struct;
+
+typedef struct async_plugin_struct {
+  /*! \brief Ring through which the driver sends to the engine */
+  async_ring to_engine;
+  /*! \brief Ring through which the engine sends to the driver */
+  async_ring to_driver;
+  /*! \brief Handle of the loaded plugin library */
+  void* handle;
+  /*! \brief The plugin's initialization function */
+  MDI_Plugin_init_t plugin_init;
+  /*! \brief MPI intra-communicator for the engine */
+  MPI_Comm mpi_comm;
+  /*! \brief Rank of this process within mpi_comm */
+  int rank;
+  /*! \brief Handle of the context in which the engine runs */
+  int context;
+  /*! \brief Value returned by the plugin's initialization function */
+  int ret;
+  /*! \brief Flag whether the plugin's initialization function has returned */
+  int engine_done;
+  /*! \brief Flag whether the driver has deleted its communicator to the engine */
+  int driver_done;
+  /*! \brief Flag whether the worker thread or coroutine was started */
+  int started;
+  /*! \brief Stack and saved registers of the engine, if it runs as a coroutine, or NULL if it
+  runs on a worker thread */
+  struct async_coroutine_struct* coroutine;
+  /*! \brief Worker thread on which the engine runs */
+#ifdef _WIN32
+  HANDLE thread;
+#else
+  pthread_t thread;
+#endif
+} async_plugin;
+
+typedef struct async_data_struct {
+  /*! \brief The plugin to which the communicator connects */
+  async_plugin* plugin;
+  /*! \brief Ring through which this code sends */
+  async_ring* out;
+  /*! \brief Ring through which this code receives */
+  async_ring* in;
+  /*! \brief Flag that is set once the connected code is finished */
+  int* peer_done;
+  /*! \brief Flag whether this is the driver's communicator, which owns the plugin */
+  int is_driver;
+} async_data;
+
+int async_launch_plugin(const char* plugin_name, const char* options, void* mpi_comm_ptr, MDI_Comm* comm);
+int async_initialize();
+int async_send(const void* buf, size_t count, MDI_Datatype datatype, MDI_Comm comm, int msg_flag);
+int async_recv(void* buf, size_t count, MDI_Datatype datatype, MDI_Comm comm, int msg_flag);
+int communicator_delete_async(void* comm);
+
+#endif
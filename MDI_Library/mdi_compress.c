@@ -0,0 +1,559 @@
+/*! \file
+ *
+ * \brief Lossless compression of large message bodies
+ *
+ * When the compression feature has been negotiated for a communicator, message bodies that
+ * are larger than a threshold are passed through a byte-shuffle filter, which groups the
+ * n-th byte of every element together, and then through a small LZ77-class codec that uses
+ * the LZ4 block format.  The codec is implemented here, so that no external dependencies are
+ * required.  Bodies that do not shrink by at least one eighth are sent uncompressed.
+ *
+ * Unless a threshold is provided through the \p -compress_threshold option, the threshold is
+ * determined the first time it is needed by timing the codec on a smooth sample grid of
+ * doubles at a range of sizes, and selecting the smallest size for which the time spent
+ * compressing and decompressing is less than the time saved sending the smaller body over a
+ * link with a bandwidth of \p COMPRESS_LINK_BANDWIDTH.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+#include "mdi.h"
+#include "mdi_compress.h"
+#include "mdi_datatype.h"
+
+#ifdef _WIN32
+  #include <windows.h>
+#else
+  #include <pthread.h>
+#endif
+
+// Parameters of the LZ codec
+#define LZ_HASH_LOG 12
+#define LZ_MIN_MATCH 4
+#define LZ_LAST_LITERALS 5
+#define LZ_MF_LIMIT 12
+#define LZ_MAX_OFFSET 65535
+
+/*! \brief Threshold selected by calibration, which is shared by every context */
+static size_t calibrated_threshold = 0;
+
+/*! \brief Guard that ensures the calibration is performed only once, by the first thread that needs it */
+#ifdef _WIN32
+static INIT_ONCE calibration_once = INIT_ONCE_STATIC_INIT;
+#else
+static pthread_once_t calibration_once = PTHREAD_ONCE_INIT;
+#endif
+
+
+/*! \brief Group the n-th byte of every element of an array together
+ */
+static void shuffle(const unsigned char* in, size_t nbytes, size_t elemsize, unsigned char* out) {
+  size_t count = nbytes / elemsize;
+  size_t i, ibyte;
+  for ( ibyte = 0; ibyte < elemsize; ibyte++ ) {
+    unsigned char* plane = out + ibyte * count;
+    for ( i = 0; i < count; i++ ) {
+      plane[i] = in[i * elemsize + ibyte];
+    }
+  }
+  // any trailing bytes that do not form a complete element are copied unmodified
+  memcpy(out + count * elemsize, in + count * elemsize, nbytes - count * elemsize);
+}
+
+
+/*! \brief Reverse the byte-shuffle filter
+ */
+static void unshuffle(const unsigned char* in, size_t nbytes, size_t elemsize, unsigned char* out) {
+  size_t count = nbytes / elemsize;
+  size_t i, ibyte;
+  for ( ibyte = 0; ibyte < elemsize; ibyte++ ) {
+    const unsigned char* plane = in + ibyte * count;
+    for ( i = 0; i < count; i++ ) {
+      out[i * elemsize + ibyte] = plane[i];
+    }
+  }
+  memcpy(out + count * elemsize, in + count * elemsize, nbytes - count * elemsize);
+}
+
+
+/*! \brief Return the largest size of a block of \p n bytes after LZ compression
+ */
+static size_t lz_bound(size_t n) {
+  return n + ( n / 255 ) + 16;
+}
+
+
+static uint32_t lz_read32(const unsigned char* p) {
+  uint32_t value;
+  memcpy(&value, p, sizeof(uint32_t));
+  return value;
+}
+
+
+static uint32_t lz_hash(uint32_t sequence) {
+  return ( sequence * 2654435761U ) >> ( 32 - LZ_HASH_LOG );
+}
+
+
+static unsigned char* lz_write_length(unsigned char* op, size_t length) {
+  while ( length >= 255 ) {
+    *op++ = 255;
+    length -= 255;
+  }
+  *op++ = (unsigned char)length;
+  return op;
+}
+
+
+/*! \brief Compress a block of data using the LZ4 block format
+ *
+ * The function returns the size of the compressed block.
+ * The destination must be at least \p lz_bound(n) bytes long.
+ */
+static size_t lz_compress(const unsigned char* src, size_t n, unsigned char* dst) {
+  size_t table[1 << LZ_HASH_LOG];
+  memset(table, 0, sizeof(table));
+
+  const unsigned char* ip = src;
+  const unsigned char* anchor = src;
+  const unsigned char* end = src + n;
+  unsigned char* op = dst;
+
+  if ( n > LZ_MF_LIMIT ) {
+    const unsigned char* mflimit = end - LZ_MF_LIMIT;
+    const unsigned char* matchlimit = end - LZ_LAST_LITERALS;
+
+    while ( ip < mflimit ) {
+      uint32_t sequence = lz_read32(ip);
+      uint32_t h = lz_hash(sequence);
+      const unsigned char* ref = src + table[h];
+      table[h] = (size_t)( ip - src );
+
+      if ( ref >= ip || (size_t)( ip - ref ) > LZ_MAX_OFFSET || lz_read32(ref) != sequence ) {
+        // skip ahead faster through data that is not compressing
+        ip += 1 + ( ( ip - anchor ) >> 6 );
+        continue;
+      }
+
+      // extend the match
+      const unsigned char* mp = ip + LZ_MIN_MATCH;
+      const unsigned char* rp = ref + LZ_MIN_MATCH;
+      while ( mp < matchlimit && *mp == *rp ) {
+        mp++;
+        rp++;
+      }
+
+      // write the sequence
+      size_t nliterals = (size_t)( ip - anchor );
+      size_t match_length = (size_t)( mp - ip ) - LZ_MIN_MATCH;
+      size_t offset = (size_t)( ip - ref );
+      unsigned char* token = op++;
+      *token = (unsigned char)( ( ( nliterals >= 15 ? 15 : nliterals ) << 4 ) |
+                                ( match_length >= 15 ? 15 : match_length ) );
+      if ( nliterals >= 15 ) {
+        op = lz_write_length(op, nliterals - 15);
+      }
+      memcpy(op, anchor, nliterals);
+      op += nliterals;
+      *op++ = (unsigned char)( offset & 0xFF );
+      *op++ = (unsigned char)( offset >> 8 );
+      if ( match_length >= 15 ) {
+        op = lz_write_length(op, match_length - 15);
+      }
+
+      ip = mp;
+      anchor = ip;
+    }
+  }
+
+  // write the final literals
+  size_t nliterals = (size_t)( end - anchor );
+  *op++ = (unsigned char)( ( nliterals >= 15 ? 15 : nliterals ) << 4 );
+  if ( nliterals >= 15 ) {
+    op = lz_write_length(op, nliterals - 15);
+  }
+  memcpy(op, anchor, nliterals);
+  op += nliterals;
+
+  return (size_t)( op - dst );
+}
+
+
+/*! \brief Decompress a block of data in the LZ4 block format
+ *
+ * The function returns \p 0 if the block decompresses to exactly \p dst_n bytes.
+ */
+static int lz_decompress(const unsigned char* src, size_t n, unsigned char* dst, size_t dst_n) {
+  const unsigned char* ip = src;
+  const unsigned char* iend = src + n;
+  unsigned char* op = dst;
+  unsigned char* oend = dst + dst_n;
+
+  while ( ip < iend ) {
+    unsigned int token = *ip++;
+
+    // copy the literals
+    size_t nliterals = token >> 4;
+    if ( nliterals == 15 ) {
+      unsigned char b;
+      do {
+        if ( ip >= iend ) { return 1; }
+        b = *ip++;
+        nliterals += b;
+      } while ( b == 255 );
+    }
+    if ( nliterals > (size_t)( iend - ip ) || nliterals > (size_t)( oend - op ) ) {
+      return 1;
+    }
+    memcpy(op, ip, nliterals);
+    ip += nliterals;
+    op += nliterals;
+
+    // the final sequence has no match
+    if ( ip == iend ) {
+      break;
+    }
+
+    // copy the match
+    if ( iend - ip < 2 ) { return 1; }
+    size_t offset = (size_t)ip[0] | ( (size_t)ip[1] << 8 );
+    ip += 2;
+    if ( offset == 0 || offset > (size_t)( op - dst ) ) {
+      return 1;
+    }
+    size_t match_length = token & 15;
+    if ( match_length == 15 ) {
+      unsigned char b;
+      do {
+        if ( ip >= iend ) { return 1; }
+        b = *ip++;
+        match_length += b;
+      } while ( b == 255 );
+    }
+    match_length += LZ_MIN_MATCH;
+    if ( match_length > (size_t)( oend - op ) ) {
+      return 1;
+    }
+    const unsigned char* ref = op - offset;
+    if ( offset >= match_length ) {
+      memcpy(op, ref, match_length);
+    }
+    else {
+      size_t i;
+      for ( i = 0; i < match_length; i++ ) {
+        op[i] = ref[i];
+      }
+    }
+    op += match_length;
+  }
+
+  return ( op == oend ) ? 0 : 1;
+}
+
+
+/*! \brief Shuffle and compress a block of data, prefixed by its uncompressed size
+ *
+ * The function returns the size of the compressed block.
+ * The destination must be at least \p COMPRESS_PREFIX_LENGTH + \p lz_bound(nbytes) bytes long.
+ */
+static size_t compress_block(const unsigned char* in, size_t nbytes, size_t elemsize,
+                             unsigned char* scratch, unsigned char* out) {
+  const unsigned char* lz_in = in;
+  if ( elemsize > 1 ) {
+    shuffle(in, nbytes, elemsize, scratch);
+    lz_in = scratch;
+  }
+
+  uint64_t nbytes64 = (uint64_t)nbytes;
+  int ibyte;
+  for ( ibyte = 0; ibyte < COMPRESS_PREFIX_LENGTH; ibyte++ ) {
+    out[ibyte] = (unsigned char)( nbytes64 >> ( 8 * ibyte ) );
+  }
+  return COMPRESS_PREFIX_LENGTH + lz_compress(lz_in, nbytes, out + COMPRESS_PREFIX_LENGTH);
+}
+
+
+/*! \brief Measure the throughput of the codec and select the compression threshold
+ *
+ * The function returns the smallest tested message size for which compression is expected
+ * to reduce the total transfer time, or \p SIZE_MAX if there is no such size.
+ */
+static size_t compress_calibrate() {
+  size_t max_bytes = COMPRESS_MAX_THRESHOLD;
+  size_t ndoubles = max_bytes / sizeof(double);
+  double* sample = malloc( max_bytes );
+  unsigned char* scratch = malloc( max_bytes );
+  unsigned char* compressed = malloc( COMPRESS_PREFIX_LENGTH + lz_bound(max_bytes) );
+  unsigned char* restored = malloc( max_bytes );
+  if ( sample == NULL || scratch == NULL || compressed == NULL || restored == NULL ) {
+    free( sample );
+    free( scratch );
+    free( compressed );
+    free( restored );
+    return SIZE_MAX;
+  }
+
+  // use a smooth function on a grid, which is representative of densities and similar fields
+  size_t i;
+  for ( i = 0; i < ndoubles; i++ ) {
+    double x = (double)( i % 64 ) - 32.0;
+    double y = (double)( ( i / 64 ) % 64 ) - 32.0;
+    double z = (double)( i / 4096 ) - 16.0;
+    sample[i] = 1.0 / ( 1.0 + 0.01 * ( x*x + y*y + z*z ) );
+  }
+
+  size_t threshold = SIZE_MAX;
+  size_t nbytes;
+  for ( nbytes = COMPRESS_MIN_THRESHOLD; nbytes <= max_bytes; nbytes *= 4 ) {
+    size_t compressed_bytes = 0;
+    int nreps = 0;
+    clock_t start = clock();
+    clock_t elapsed;
+    do {
+      compressed_bytes = compress_block((unsigned char*)sample, nbytes, sizeof(double), scratch, compressed);
+      lz_decompress(compressed + COMPRESS_PREFIX_LENGTH, compressed_bytes - COMPRESS_PREFIX_LENGTH,
+                    scratch, nbytes);
+      unshuffle(scratch, nbytes, sizeof(double), restored);
+      nreps++;
+      elapsed = clock() - start;
+    } while ( elapsed < CLOCKS_PER_SEC / 200 );
+
+    double codec_time = ( (double)elapsed / CLOCKS_PER_SEC ) / nreps;
+    double saved_time = 0.0;
+    if ( compressed_bytes < nbytes ) {
+      saved_time = (double)( nbytes - compressed_bytes ) / COMPRESS_LINK_BANDWIDTH;
+    }
+    if ( codec_time < saved_time ) {
+      threshold = nbytes;
+      break;
+    }
+  }
+
+  free( sample );
+  free( scratch );
+  free( compressed );
+  free( restored );
+  return threshold;
+}
+
+
+/*! \brief Store the threshold selected by calibration, which is called through calibration_once
+ */
+#ifdef _WIN32
+static BOOL CALLBACK compress_calibrate_once(PINIT_ONCE once, PVOID parameter, PVOID* context) {
+  calibrated_threshold = compress_calibrate();
+  return TRUE;
+}
+#else
+static void compress_calibrate_once(void) {
+  calibrated_threshold = compress_calibrate();
+}
+#endif
+
+
+/*! \brief Return the minimum size, in bytes, of a message body that is compressed
+ *
+ * \param [in]       this_code
+ *                   Pointer to the code that is sending the message.
+ */
+size_t compress_get_threshold(code* this_code) {
+  if ( this_code->compress_threshold >= 0 ) {
+    return (size_t)this_code->compress_threshold;
+  }
+#ifdef _WIN32
+  InitOnceExecuteOnce(&calibration_once, compress_calibrate_once, NULL, NULL);
+#else
+  pthread_once(&calibration_once, compress_calibrate_once);
+#endif
+  return calibrated_threshold;
+}
+
+
+/*! \brief Return the size of the elements of a message body, which is used by the byte-shuffle
+ *
+ * \param [in]       header_type
+ *                   Header flags describing any encoding applied to the body before compression.
+ * \param [in]       datatype
+ *                   MDI handle (MDI_INT, MDI_DOUBLE, MDI_CHAR, etc.) of the message.
+ */
+size_t compress_elemsize(int header_type, MDI_Datatype datatype) {
+  if ( header_type & MDI_HEADER_DELTA ) {
+    return 1;
+  }
+  else if ( header_type & MDI_HEADER_FLOAT32 ) {
+    return sizeof(float);
+  }
+  else if ( header_type & MDI_HEADER_BFLOAT16 ) {
+    return sizeof(uint16_t);
+  }
+  // complex values are shuffled as their real and imaginary components
+  const datatype_info* info = datatype_get_info(datatype);
+  if ( info == NULL ) {
+    return 0;
+  }
+  return info->word_size;
+}
+
+
+/*! \brief Compress the body of a message, if doing so is worthwhile
+ *
+ * On input, \p wire_buf, \p wire_bytes, and \p header_type describe the body of the message as
+ * produced by any preceding codec: if \p wire_buf differs from \p buf, it points to
+ * \p wire_bytes bytes of encoded data, which are returned to the buffer pool if compression
+ * succeeds; otherwise the body is the raw contents of \p buf.
+ * If the body is compressed, \p MDI_HEADER_COMPRESS is added to \p header_type, and
+ * \p wire_buf points to a buffer of \p wire_bytes bytes that was allocated from the buffer
+ * pool and must be returned to it by the caller.
+ * The function returns \p 0 on a success.
+ *
+ * \param [in]       comm
+ *                   Pointer to the communicator.
+ * \param [in]       buf
+ *                   Pointer to the data to be sent.
+ * \param [in]       count
+ *                   Number of elements in the message.
+ * \param [in]       datatype
+ *                   MDI handle (MDI_INT, MDI_DOUBLE, MDI_CHAR, etc.) of the message.
+ * \param [in, out]  wire_buf
+ *                   Pointer to the data that should be sent.
+ * \param [in, out]  wire_bytes
+ *                   Number of bytes that should be sent.
+ * \param [in, out]  header_type
+ *                   Header flags describing the encoding.
+ */
+int compress_encode(communicator* comm, const void* buf, size_t count, MDI_Datatype datatype,
+                    void** wire_buf, size_t* wire_bytes, int* header_type) {
+  if ( ! ( comm->features & MDI_FEATURE_COMPRESS ) ) {
+    return 0;
+  }
+
+  // messages are only exchanged by rank 0
+  code* this_code = get_code(active_context->current_code);
+  if ( this_code->intra_rank != 0 ) {
+    return 0;
+  }
+
+  // determine the body that would be compressed
+  int encoded = ( *wire_buf != buf );
+  size_t elemsize = compress_elemsize(*header_type, datatype);
+  if ( elemsize == 0 ) {
+    return 0;
+  }
+  const unsigned char* in = (const unsigned char*)*wire_buf;
+  size_t nbytes = encoded ? *wire_bytes : count * datatype_size(datatype);
+
+  if ( nbytes == 0 || nbytes < compress_get_threshold(this_code) ) {
+    return 0;
+  }
+
+  unsigned char* out = pool_alloc( COMPRESS_PREFIX_LENGTH + lz_bound(nbytes) );
+  unsigned char* scratch = NULL;
+  if ( elemsize > 1 ) {
+    scratch = pool_alloc( nbytes );
+  }
+  if ( out == NULL || ( elemsize > 1 && scratch == NULL ) ) {
+    pool_free( out );
+    pool_free( scratch );
+    mdi_error("Error in MDI_Send: unable to allocate compression buffer");
+    return 1;
+  }
+
+  size_t compressed_bytes = compress_block(in, nbytes, elemsize, scratch, out);
+  pool_free( scratch );
+
+  // only use the compressed body if it is substantially smaller
+  if ( compressed_bytes > nbytes - nbytes / 8 ) {
+    pool_free( out );
+    return 0;
+  }
+
+  if ( encoded ) {
+    pool_free( *wire_buf );
+  }
+  *wire_buf = out;
+  *wire_bytes = compressed_bytes;
+  *header_type |= MDI_HEADER_COMPRESS;
+  return 0;
+}
+
+
+/*! \brief Determine the uncompressed size of a compressed body
+ *
+ * The function returns \p 0 on a success.
+ *
+ * \param [in]       wire_buf
+ *                   Pointer to the compressed body.
+ * \param [in]       wire_bytes
+ *                   Size of the compressed body, in bytes.
+ * \param [out]      nbytes
+ *                   Size of the uncompressed body, in bytes.
+ */
+int compress_decoded_size(const void* wire_buf, size_t wire_bytes, size_t* nbytes) {
+  if ( wire_bytes < COMPRESS_PREFIX_LENGTH ) {
+    mdi_error("Error in MDI_Recv: truncated compressed message");
+    return 1;
+  }
+  const unsigned char* in = (const unsigned char*)wire_buf;
+  uint64_t nbytes64 = 0;
+  int ibyte;
+  for ( ibyte = 0; ibyte < COMPRESS_PREFIX_LENGTH; ibyte++ ) {
+    nbytes64 |= (uint64_t)in[ibyte] << ( 8 * ibyte );
+  }
+  *nbytes = (size_t)nbytes64;
+  return 0;
+}
+
+
+/*! \brief Decompress a compressed body directly into the receive buffer
+ *
+ * The function returns \p 0 on a success.
+ *
+ * \param [in]       wire_buf
+ *                   Pointer to the compressed body.
+ * \param [in]       wire_bytes
+ *                   Size of the compressed body, in bytes.
+ * \param [out]      buf
+ *                   Pointer to the buffer where the uncompressed body will be stored.
+ * \param [in]       nbytes
+ *                   Size of the uncompressed body, in bytes.
+ * \param [in]       elemsize
+ *                   Size of the elements of the body, in bytes, as returned by \p compress_elemsize.
+ */
+int compress_decode(const void* wire_buf, size_t wire_bytes, void* buf, size_t nbytes, size_t elemsize) {
+  size_t encoded_nbytes;
+  int ret = compress_decoded_size(wire_buf, wire_bytes, &encoded_nbytes);
+  if ( ret != 0 ) { return ret; }
+  if ( elemsize == 0 || encoded_nbytes != nbytes ) {
+    mdi_error("Error in MDI_Recv: compressed message has an inconsistent size");
+    return 1;
+  }
+
+  const unsigned char* lz_in = (const unsigned char*)wire_buf + COMPRESS_PREFIX_LENGTH;
+  size_t lz_bytes = wire_bytes - COMPRESS_PREFIX_LENGTH;
+
+  // without a shuffle, the body can be decompressed in place
+  if ( elemsize == 1 ) {
+    ret = lz_decompress(lz_in, lz_bytes, (unsigned char*)buf, nbytes);
+  }
+  else {
+    unsigned char* scratch = pool_alloc( nbytes );
+    if ( scratch == NULL ) {
+      mdi_error("Error in MDI_Recv: unable to allocate decompression buffer");
+      return 1;
+    }
+    ret = lz_decompress(lz_in, lz_bytes, scratch, nbytes);
+    if ( ret == 0 ) {
+      unshuffle(scratch, nbytes, elemsize, (unsigned char*)buf);
+    }
+    pool_free( scratch );
+  }
+  if ( ret != 0 ) {
+    mdi_error("Error in MDI_Recv: corrupt compressed message");
+    return 1;
+  }
+
+  return 0;
+}
@@ -0,0 +1,29 @@
+/*! \file
+ *
+ * \brief Lossless compression of large message bodies
+ */
+
+#ifndef MDI_COMPRESS
+#define MDI_COMPRESS
+
+#include "mdi.h"
+#include "mdi_global.h"
+
+// Smallest and largest message sizes, in bytes, considered when calibrating the compression threshold
+#define COMPRESS_MIN_THRESHOLD 4096
+#define COMPRESS_MAX_THRESHOLD 1048576
+
+// Nominal link bandwidth, in bytes per second, against which the cost of compression is weighed
+#define COMPRESS_LINK_BANDWIDTH 1.25e8
+
+// Number of bytes at the start of a compressed body that record the size of the uncompressed body
+#define COMPRESS_PREFIX_LENGTH 8
+
+size_t compress_get_threshold(code* this_code);
+size_t compress_elemsize(int header_type, MDI_Datatype datatype);
+int compress_encode(communicator* comm, const void* buf, size_t count, MDI_Datatype datatype,
+                    void** wire_buf, size_t* wire_bytes, int* header_type);
+int compress_decoded_size(const void* wire_buf, size_t wire_bytes, size_t* nbytes);
+int compress_decode(const void* wire_buf, size_t wire_bytes, void* buf, size_t nbytes, size_t elemsize);
+
+#endif
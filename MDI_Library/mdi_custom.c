@@ -0,0 +1,358 @@
+/*! \file
+ *
+ * \brief Communication through methods registered with MDI_Register_Method
+ *
+ * A registered method only moves bytes.
+ * The library forms the headers and bodies of messages, exchanges version numbers, and
+ * negotiates features exactly as it does for the TCP method.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "mdi.h"
+#include "mdi_custom.h"
+#include "mdi_datatype.h"
+#include "mdi_global.h"
+#include "mdi_general.h"
+
+/*! \brief Methods that have been registered with MDI_Register_Method
+ *
+ * The table is shared by all contexts.
+ * Entries are never removed, so a method index remains valid for the lifetime of the process.
+ */
+static custom_method custom_methods[MDI_MAX_CUSTOM_METHODS];
+
+/*! \brief Number of methods that have been registered */
+static int ncustom_methods = 0;
+
+
+/*! \brief Register a communication method
+ *
+ * The function returns \p 0 on a success.
+ *
+ * \param [in]       name
+ *                   Name of the method.
+ * \param [in]       init
+ *                   Function that initializes the method for a code, or NULL.
+ * \param [in]       accept
+ *                   Function that accepts a connection from an engine, or NULL if drivers cannot use the method.
+ * \param [in]       connect
+ *                   Function that connects an engine to its driver, or NULL if engines cannot use the method.
+ * \param [in]       send
+ *                   Function that sends bytes through a connection.
+ * \param [in]       recv
+ *                   Function that receives bytes through a connection.
+ * \param [in]       del
+ *                   Function that closes a connection, or NULL.
+ */
+int custom_register(const char* name, MDI_Method_init_t init, MDI_Method_connect_t accept,
+                    MDI_Method_connect_t connect, MDI_Method_send_t send, MDI_Method_recv_t recv,
+                    MDI_Method_delete_t del) {
+  if ( name == NULL || name[0] == '\0' || strlen(name) >= NAME_LENGTH ) {
+    mdi_error("Error in MDI_Register_Method: Invalid method name");
+    return 1;
+  }
+  if ( strchr(name, ' ') != NULL ) {
+    mdi_error("Error in MDI_Register_Method: Method names cannot contain spaces");
+    return 1;
+  }
+  if ( strcmp(name, "MPI") == 0 || strcmp(name, "TCP") == 0 ||
+       strcmp(name, "LINK") == 0 || strcmp(name, "TEST") == 0 ) {
+    mdi_error("Error in MDI_Register_Method: The name of a builtin method cannot be registered");
+    return 1;
+  }
+  if ( custom_find(name) >= 0 ) {
+    mdi_error("Error in MDI_Register_Method: A method with this name has already been registered");
+    return 1;
+  }
+  if ( send == NULL || recv == NULL ) {
+    mdi_error("Error in MDI_Register_Method: The send and recv functions are required");
+    return 1;
+  }
+  if ( accept == NULL && connect == NULL ) {
+    mdi_error("Error in MDI_Register_Method: At least one of the accept and connect functions is required");
+    return 1;
+  }
+  if ( ncustom_methods >= MDI_MAX_CUSTOM_METHODS ) {
+    mdi_error("Error in MDI_Register_Method: Too many methods have been registered");
+    return 1;
+  }
+
+  custom_method* new_method = &custom_methods[ncustom_methods];
+  snprintf(new_method->name, NAME_LENGTH, "%s", name);
+  new_method->init = init;
+  new_method->accept = accept;
+  new_method->connect = connect;
+  new_method->send = send;
+  new_method->recv = recv;
+  new_method->del = del;
+  ncustom_methods++;
+
+  return 0;
+}
+
+
+/*! \brief Return the index of the registered method with a given name, or \p -1 if there is none
+ *
+ * \param [in]       name
+ *                   Name of the method.
+ */
+int custom_find(const char* name) {
+  int imethod;
+  for (imethod = 0; imethod < ncustom_methods; imethod++) {
+    if ( strcmp(custom_methods[imethod].name, name) == 0 ) {
+      return imethod;
+    }
+  }
+  return -1;
+}
+
+
+/*! \brief Create a communicator for a new connection through a registered method
+ *
+ * If the version numbers or features cannot be exchanged, the communicator is deleted, which
+ * also closes the connection, so that it is never returned by MDI_Accept_Communicator().
+ *
+ * \param [in]       method
+ *                   The method.
+ * \param [in]       connection
+ *                   The connection returned by the accept or connect function of the method.
+ */
+static int custom_new_communicator(const custom_method* method, void* connection) {
+  code* this_code = get_code(active_context->current_code);
+
+  MDI_Comm comm_id = new_communicator(this_code->id, MDI_METHOD_CUSTOM);
+  if ( comm_id == MDI_COMM_NULL ) {
+    mdi_error("Error in MDI: unable to create a communicator for a registered method");
+    return 1;
+  }
+  communicator* new_comm = get_communicator(this_code->id, comm_id);
+  new_comm->send = custom_send;
+  new_comm->recv = custom_recv;
+  new_comm->delete = communicator_delete_custom;
+  new_comm->partial_body = 1;
+
+  custom_data* data = malloc(sizeof(custom_data));
+  data->method = method;
+  data->connection = connection;
+  new_comm->method_data = data;
+
+  // communicate the version number between codes
+  // only do this if not in i-PI compatibility mode
+  if ( active_context->ipi_compatibility != 1 ) {
+    int version[3];
+    version[0] = MDI_MAJOR_VERSION;
+    version[1] = MDI_MINOR_VERSION;
+    version[2] = MDI_PATCH_VERSION;
+    if ( custom_send(&version[0], 3, MDI_INT, comm_id, 0) != 0 ||
+         custom_recv(&new_comm->mdi_version[0], 3, MDI_INT, comm_id, 0) != 0 ) {
+      mdi_error("Error in MDI: unable to exchange version numbers through a registered method");
+      delete_communicator(this_code->id, comm_id);
+      return 1;
+    }
+
+    // negotiate any optional features
+    if ( general_negotiate_features(comm_id) != 0 ) {
+      mdi_error("Error in MDI: unable to negotiate features through a registered method");
+      delete_communicator(this_code->id, comm_id);
+      return 1;
+    }
+  }
+
+  return 0;
+}
+
+
+/*! \brief Initialize a code that uses a registered method
+ *
+ * Engines connect to their driver immediately, while drivers accept connections
+ * through MDI_Accept_Communicator().
+ * The function returns \p 0 on a success.
+ *
+ * \param [in]       method_index
+ *                   Index of the method, as returned by custom_find().
+ * \param [in]       role
+ *                   Role of the code, either \p "DRIVER" or \p "ENGINE".
+ * \param [in]       options
+ *                   Options passed to MDI_Init().
+ */
+int custom_initialize(int method_index, const char* role, const char* options) {
+  code* this_code = get_code(active_context->current_code);
+  const custom_method* method = &custom_methods[method_index];
+  this_code->custom_method = method_index;
+  this_code->custom_state = NULL;
+
+  int is_driver = ( strcmp(role, "DRIVER") == 0 );
+  if ( is_driver && method->accept == NULL ) {
+    mdi_error("Error in MDI_Init: This method cannot be used by a driver");
+    return 1;
+  }
+  if ( ! is_driver && method->connect == NULL ) {
+    mdi_error("Error in MDI_Init: This method cannot be used by an engine");
+    return 1;
+  }
+
+  // as with TCP, only rank 0 of each code communicates with other codes
+  if ( this_code->intra_rank != 0 ) {
+    return 0;
+  }
+
+  if ( method->init != NULL ) {
+    if ( method->init(role, options, &this_code->custom_state) != 0 ) {
+      mdi_error("Error in MDI_Init: Initialization of the method failed");
+      return 1;
+    }
+  }
+
+  if ( ! is_driver ) {
+    void* connection = NULL;
+    if ( method->connect(this_code->custom_state, &connection) != 0 ) {
+      mdi_error("Error in MDI_Init: Unable to connect to the driver");
+      return 1;
+    }
+    return custom_new_communicator(method, connection);
+  }
+
+  return 0;
+}
+
+
+/*! \brief Accept a connection through the registered method of the current code, if one is pending
+ *
+ * The function returns \p 0 on a success, including when no connection was pending.
+ */
+int custom_accept_connection() {
+  code* this_code = get_code(active_context->current_code);
+  if ( this_code->intra_rank != 0 ) {
+    return 0;
+  }
+
+  const custom_method* method = &custom_methods[this_code->custom_method];
+  void* connection = NULL;
+  if ( method->accept(this_code->custom_state, &connection) != 0 ) {
+    mdi_error("Error in MDI: Unable to accept a connection through a registered method");
+    return 1;
+  }
+  if ( connection == NULL ) {
+    return 0;
+  }
+  return custom_new_communicator(method, connection);
+}
+
+
+/*! \brief Connect a persistent engine to its next driver through the registered method of the current code
+ *
+ * The function returns \p 0 on a success.
+ */
+int custom_reconnect() {
+  code* this_code = get_code(active_context->current_code);
+  if ( this_code->intra_rank != 0 ) {
+    return 0;
+  }
+
+  const custom_method* method = &custom_methods[this_code->custom_method];
+  void* connection = NULL;
+  if ( method->connect(this_code->custom_state, &connection) != 0 ) {
+    mdi_error("Error in MDI_Accept_Communicator: Unable to connect to the next driver");
+    return 1;
+  }
+  return custom_new_communicator(method, connection);
+}
+
+
+/*! \brief Send data through an MDI connection, using a registered method
+ *
+ * \param [in]       buf
+ *                   Pointer to the data to be sent.
+ * \param [in]       count
+ *                   Number of values (integers, double precision floats, characters, etc.) to be sent.
+ * \param [in]       datatype
+ *                   MDI handle (MDI_INT, MDI_DOUBLE, MDI_CHAR, etc.) corresponding to the type of data to be sent.
+ * \param [in]       comm
+ *                   MDI communicator associated with the intended recipient code.
+ * \param [in]       msg_flag
+ *                   Type of role this data has within a message.
+ *                   0: Not part of a message.
+ *                   1: The header of a message.
+ *                   2: The body (data) of a message.
+ */
+int custom_send(const void* buf, size_t count, MDI_Datatype datatype, MDI_Comm comm, int msg_flag) {
+  // only send from rank 0
+  code* this_code = get_code(active_context->current_code);
+  if ( this_code->intra_rank != 0 ) {
+    return 0;
+  }
+
+  size_t datasize = datatype_size(datatype);
+  if ( datasize == 0 ) {
+    mdi_error("MDI data type not recognized in custom_send");
+    return 1;
+  }
+
+  communicator* this = get_communicator(active_context->current_code, comm);
+  custom_data* data = (custom_data*) this->method_data;
+  if ( data->method->send(buf, (int64_t)(count * datasize), data->connection) != 0 ) {
+    this->broken = 1;
+    mdi_error("Error in MDI: The send function of a registered method failed");
+    return 1;
+  }
+
+  return 0;
+}
+
+
+/*! \brief Receive data through an MDI connection, using a registered method
+ *
+ * \param [in]       buf
+ *                   Pointer to the buffer where the received data will be stored.
+ * \param [in]       count
+ *                   Number of values (integers, double precision floats, characters, etc.) to be received.
+ * \param [in]       datatype
+ *                   MDI handle (MDI_INT, MDI_DOUBLE, MDI_CHAR, etc.) corresponding to the type of data to be received.
+ * \param [in]       comm
+ *                   MDI communicator associated with the connection to the sending code.
+ * \param [in]       msg_flag
+ *                   Type of role this data has within a message.
+ *                   0: Not part of a message.
+ *                   1: The header of a message.
+ *                   2: The body (data) of a message.
+ */
+int custom_recv(void* buf, size_t count, MDI_Datatype datatype, MDI_Comm comm, int msg_flag) {
+  // only recv from rank 0
+  code* this_code = get_code(active_context->current_code);
+  if ( this_code->intra_rank != 0 ) {
+    return 0;
+  }
+
+  size_t datasize = datatype_size(datatype);
+  if ( datasize == 0 ) {
+    mdi_error("MDI data type not recognized in custom_recv");
+    return 1;
+  }
+
+  communicator* this = get_communicator(active_context->current_code, comm);
+  custom_data* data = (custom_data*) this->method_data;
+  if ( data->method->recv(buf, (int64_t)(count * datasize), data->connection) != 0 ) {
+    this->broken = 1;
+    mdi_error("Error in MDI: The recv function of a registered method failed");
+    return 1;
+  }
+
+  return 0;
+}
+
+
+/*! \brief Function for registered-method-specific deletion operations for communicator deletion
+ */
+int communicator_delete_custom(void* comm) {
+  communicator* this_comm = (communicator*) comm;
+  custom_data* data = (custom_data*) this_comm->method_data;
+
+  // close the connection
+  if ( data->method->del != NULL ) {
+    data->method->del(data->connection);
+  }
+
+  free(data);
+  return 0;
+}
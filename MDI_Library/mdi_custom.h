@@ -0,0 +1,53 @@
+/*! \file
+ *
+ * \brief Communication through methods registered with MDI_Register_Method
+ */
+
+#ifndef MDI_CUSTOM_IMPL
+#define MDI_CUSTOM_IMPL
+
+#include "mdi.h"
+#include "mdi_global.h"
+
+/*! \brief Communication method of communicators that use a registered method */
+#define MDI_METHOD_CUSTOM 5
+
+/*! \brief Maximum number of methods that may be registered */
+#define MDI_MAX_CUSTOM_METHODS 16
+
+typedef struct custom_method_struct {
+  /*! \brief Name of the method, as given to the -method option */
+  char name[NAME_LENGTH];
+  /*! \brief Function that initializes the method for a code */
+  MDI_Method_init_t init;
+  /*! \brief Function that accepts a connection from an engine */
+  MDI_Method_connect_t accept;
+  /*! \brief Function that connects an engine to its driver */
+  MDI_Method_connect_t connect;
+  /*! \brief Function that sends bytes through a connection */
+  MDI_Method_send_t send;
+  /*! \brief Function that receives bytes through a connection */
+  MDI_Method_recv_t recv;
+  /*! \brief Function that closes a connection, or NULL */
+  MDI_Method_delete_t del;
+} custom_method;
+
+typedef struct custom_data_struct {
+  /*! \brief Method used by the communicator */
+  const custom_method* method;
+  /*! \brief Connection returned by the accept or connect function of the method */
+  void* connection;
+} custom_data;
+
+int custom_register(const char* name, MDI_Method_init_t init, MDI_Method_connect_t accept,
+                    MDI_Method_connect_t connect, MDI_Method_send_t send, MDI_Method_recv_t recv,
+                    MDI_Method_delete_t del);
+int custom_find(const char* name);
+int custom_initialize(int method_index, const char* role, const char* options);
+int custom_accept_connection();
+int custom_reconnect();
+int custom_send(const void* buf, size_t count, MDI_Datatype datatype, MDI_Comm comm, int msg_flag);
+int custom_recv(void* buf, size_t count, MDI_Datatype datatype, MDI_Comm comm, int msg_flag);
+int communicator_delete_custom(void* comm);
+
+#endif
@@ -0,0 +1,59 @@
+/*! \file
+ *
+ * \brief Properties of the MDI datatypes
+ *
+ * Every transport and codec determines the size and MPI representation of a datatype from
+ * the table in this file, so supporting a new datatype only requires adding an entry here.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include "mdi.h"
+#include "mdi_datatype.h"
+
+/*! \brief Properties of each datatype, indexed by the value of its MDI handle
+ *
+ * Entries with a size of \p 0 do not correspond to a datatype.
+ */
+static const datatype_info datatype_table[] = {
+  { 0, 0, MPI_BYTE },                                 // 0: unused
+  { sizeof(int), sizeof(int), MPI_INT },              // 1: MDI_INT
+  { sizeof(double), sizeof(double), MPI_DOUBLE },     // 2: MDI_DOUBLE
+  { sizeof(char), sizeof(char), MPI_CHAR },           // 3: MDI_CHAR
+  { 0, 0, MPI_BYTE },                                 // 4: unused
+  { 0, 0, MPI_BYTE },                                 // 5: unused
+  { sizeof(char), sizeof(char), MPI_BYTE },           // 6: MDI_BYTE
+  { sizeof(float), sizeof(float), MPI_FLOAT },        // 7: MDI_FLOAT
+  { sizeof(int64_t), sizeof(int64_t), MPI_INT64_T },  // 8: MDI_INT64
+  { sizeof(int8_t), sizeof(int8_t), MPI_INT8_T },     // 9: MDI_INT8
+  { 2 * sizeof(double), sizeof(double), MPI_DOUBLE }, // 10: MDI_COMPLEX_DOUBLE
+};
+
+
+/*! \brief Return the properties of an MDI datatype, or \p NULL if the datatype is not recognized
+ *
+ * \param [in]       datatype
+ *                   MDI handle (MDI_INT, MDI_DOUBLE, MDI_CHAR, etc.)
+ */
+const datatype_info* datatype_get_info(MDI_Datatype datatype) {
+  size_t ntypes = sizeof(datatype_table) / sizeof(datatype_table[0]);
+  if ( datatype < 0 || (size_t)datatype >= ntypes || datatype_table[datatype].size == 0 ) {
+    return NULL;
+  }
+  return &datatype_table[datatype];
+}
+
+
+/*! \brief Return the size of a single element of an MDI datatype, or \p 0 if the datatype is not recognized
+ *
+ * \param [in]       datatype
+ *                   MDI handle (MDI_INT, MDI_DOUBLE, MDI_CHAR, etc.)
+ */
+size_t datatype_size(MDI_Datatype datatype) {
+  const datatype_info* info = datatype_get_info(datatype);
+  if ( info == NULL ) {
+    return 0;
+  }
+  return info->size;
+}
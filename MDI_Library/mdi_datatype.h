@@ -0,0 +1,25 @@
+/*! \file
+ *
+ * \brief Properties of the MDI datatypes
+ */
+
+#ifndef MDI_DATATYPE
+#define MDI_DATATYPE
+
+#include <mpi.h>
+#include "mdi.h"
+
+typedef struct datatype_info_struct {
+  /*! \brief Size of a single element, in bytes */
+  size_t size;
+  /*! \brief Size of the scalar components of an element, in bytes.
+  This differs from size only for complex types. */
+  size_t word_size;
+  /*! \brief MPI datatype corresponding to the scalar components of an element */
+  MPI_Datatype mpi_type;
+} datatype_info;
+
+const datatype_info* datatype_get_info(MDI_Datatype datatype);
+size_t datatype_size(MDI_Datatype datatype);
+
+#endif
@@ -0,0 +1,350 @@
+/*! \file
+ *
+ * \brief Temporal delta codec for repeated per-step arrays
+ *
+ * Drivers commonly exchange the same arrays (coordinates, forces, etc.) with an engine on
+ * every step of a simulation, and consecutive frames of these arrays differ only slightly.
+ * When the delta feature has been negotiated for a communicator, each numeric message is
+ * XORed against the previous message sent with the same command, and the result is stored
+ * as a 4-bit count of significant bytes per word, followed by the significant bytes.
+ * Words that are unchanged, or that differ only in their low-order mantissa bits, therefore
+ * compress to a fraction of their size.  The encoding is lossless.
+ *
+ * A keyframe (the raw message) is sent whenever no previous frame is available, whenever
+ * the encoded message would not be smaller than the raw message, and periodically every
+ * \p DELTA_KEYFRAME_INTERVAL messages.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include "mdi.h"
+#include "mdi_delta.h"
+#include "mdi_datatype.h"
+
+/*! \brief Return the size of the words that are XORed for an MDI datatype, or \p 0 if unsupported
+ *
+ * Only datatypes whose scalar components are 32-bit or 64-bit words are delta-encoded.
+ *
+ * \param [in]       datatype
+ *                   MDI handle (MDI_INT, MDI_DOUBLE, etc.)
+ */
+static size_t delta_wordsize(MDI_Datatype datatype) {
+  const datatype_info* info = datatype_get_info(datatype);
+  if ( info == NULL || datatype == MDI_CHAR || datatype == MDI_BYTE ) {
+    return 0;
+  }
+  if ( info->word_size != sizeof(uint32_t) && info->word_size != sizeof(uint64_t) ) {
+    return 0;
+  }
+  return info->word_size;
+}
+
+
+/*! \brief Load a word of \p wordsize bytes into an unsigned 64-bit integer
+ */
+static uint64_t delta_load(const unsigned char* ptr, size_t wordsize) {
+  if ( wordsize == sizeof(uint64_t) ) {
+    uint64_t word;
+    memcpy(&word, ptr, sizeof(uint64_t));
+    return word;
+  }
+  else {
+    uint32_t word;
+    memcpy(&word, ptr, sizeof(uint32_t));
+    return (uint64_t)word;
+  }
+}
+
+
+/*! \brief Store the low \p wordsize bytes of an unsigned 64-bit integer
+ */
+static void delta_store(unsigned char* ptr, uint64_t word, size_t wordsize) {
+  if ( wordsize == sizeof(uint64_t) ) {
+    memcpy(ptr, &word, sizeof(uint64_t));
+  }
+  else {
+    uint32_t word32 = (uint32_t)word;
+    memcpy(ptr, &word32, sizeof(uint32_t));
+  }
+}
+
+
+/*! \brief Find the frame associated with the current command of a communicator
+ *
+ * The function returns \p NULL if no such frame exists.
+ *
+ * \param [in]       comm
+ *                   Pointer to the communicator.
+ * \param [in]       direction
+ *                   0 for frames that were sent, 1 for frames that were received.
+ */
+static delta_frame* delta_find_frame(communicator* comm, int direction) {
+  if ( comm->delta_frames == NULL ) {
+    return NULL;
+  }
+  int iframe;
+  for ( iframe = 0; iframe < comm->delta_frames->size; iframe++ ) {
+    delta_frame* frame = vector_get(comm->delta_frames, iframe);
+    if ( frame->direction == direction &&
+         frame->msg_index == comm->command_msg &&
+         strcmp( frame->command, comm->command ) == 0 ) {
+      return frame;
+    }
+  }
+  return NULL;
+}
+
+
+/*! \brief Determine whether a message is eligible for delta encoding
+ *
+ * The function returns \p 1 if the message may be delta-encoded and \p 0 otherwise.
+ *
+ * \param [in]       comm
+ *                   Pointer to the communicator.
+ * \param [in]       count
+ *                   Number of elements in the message.
+ * \param [in]       datatype
+ *                   MDI handle (MDI_INT, MDI_DOUBLE, etc.) of the message.
+ */
+int delta_applies(communicator* comm, size_t count, MDI_Datatype datatype) {
+  if ( ! ( comm->features & MDI_FEATURE_DELTA ) ) {
+    return 0;
+  }
+  if ( delta_wordsize(datatype) == 0 || count < DELTA_MIN_COUNT ) {
+    return 0;
+  }
+
+  // messages are only exchanged by rank 0
+  code* this_code = get_code(active_context->current_code);
+  if ( this_code->intra_rank != 0 ) {
+    return 0;
+  }
+  return 1;
+}
+
+
+/*! \brief Record the contents of a message as the reference frame for subsequent messages
+ *
+ * The function returns \p 0 on a success.
+ *
+ * \param [in]       comm
+ *                   Pointer to the communicator.
+ * \param [in]       buf
+ *                   Pointer to the contents of the message.
+ * \param [in]       count
+ *                   Number of elements in the message.
+ * \param [in]       datatype
+ *                   MDI handle (MDI_INT, MDI_DOUBLE, etc.) of the message.
+ * \param [in]       direction
+ *                   0 if the message was sent, 1 if it was received.
+ */
+int delta_keyframe(communicator* comm, const void* buf, size_t count, MDI_Datatype datatype,
+                   int direction) {
+  size_t nbytes = count * datatype_size(datatype);
+
+  if ( comm->delta_frames == NULL ) {
+    comm->delta_frames = malloc( sizeof(vector) );
+    vector_init(comm->delta_frames, sizeof(delta_frame));
+  }
+
+  delta_frame* frame = delta_find_frame(comm, direction);
+  if ( frame == NULL ) {
+    delta_frame new_frame;
+    snprintf(new_frame.command, COMMAND_LENGTH, "%s", comm->command);
+    new_frame.msg_index = comm->command_msg;
+    new_frame.direction = direction;
+    new_frame.datatype = datatype;
+    new_frame.count = 0;
+    new_frame.age = 0;
+    new_frame.data = NULL;
+    vector_push_back(comm->delta_frames, &new_frame);
+    frame = vector_get(comm->delta_frames, (int)comm->delta_frames->size - 1);
+  }
+
+  if ( frame->data == NULL || frame->count * datatype_size(frame->datatype) != nbytes ) {
+    free( frame->data );
+    frame->data = malloc( nbytes );
+    if ( frame->data == NULL ) {
+      mdi_error("Error in delta codec: unable to allocate frame");
+      return 1;
+    }
+  }
+  memcpy(frame->data, buf, nbytes);
+  frame->datatype = datatype;
+  frame->count = count;
+  frame->age = 0;
+
+  return 0;
+}
+
+
+/*! \brief Encode a message relative to the previous message sent with the same command
+ *
+ * On return, \p header_type is either \p MDI_HEADER_KEYFRAME, in which case \p wire_buf
+ * points to \p buf and the message should be sent unmodified, or \p MDI_HEADER_DELTA, in
+ * which case \p wire_buf points to a buffer of \p wire_bytes bytes that was allocated from
+ * the buffer pool and must be returned to it by the caller.
+ * The function returns \p 0 on a success.
+ *
+ * \param [in]       comm
+ *                   Pointer to the communicator.
+ * \param [in]       buf
+ *                   Pointer to the data to be sent.
+ * \param [in]       count
+ *                   Number of elements in the message.
+ * \param [in]       datatype
+ *                   MDI handle (MDI_INT, MDI_DOUBLE, etc.) of the message.
+ * \param [out]      wire_buf
+ *                   Pointer to the data that should be sent.
+ * \param [out]      wire_bytes
+ *                   Number of bytes that should be sent.
+ * \param [out]      header_type
+ *                   Header flag describing the encoding.
+ */
+int delta_encode(communicator* comm, const void* buf, size_t count, MDI_Datatype datatype,
+                 void** wire_buf, size_t* wire_bytes, int* header_type) {
+  size_t wordsize = delta_wordsize(datatype);
+  size_t raw_bytes = count * datatype_size(datatype);
+  size_t nwords = raw_bytes / wordsize;
+  delta_frame* frame = delta_find_frame(comm, 0);
+
+  *wire_buf = (void*)buf;
+  *wire_bytes = raw_bytes;
+  *header_type = MDI_HEADER_KEYFRAME;
+
+  // send a keyframe if there is no usable reference frame
+  if ( frame == NULL || frame->datatype != datatype || frame->count != count ||
+       frame->age >= DELTA_KEYFRAME_INTERVAL ) {
+    return delta_keyframe(comm, buf, count, datatype, 0);
+  }
+
+  // the significant byte counts are stored first, two per byte, followed by the significant bytes
+  // the encoding is abandoned as soon as it reaches the size of the raw message
+  size_t nnibble_bytes = ( nwords + 1 ) / 2;
+  unsigned char* out = pool_alloc( nnibble_bytes + raw_bytes + wordsize );
+  if ( out == NULL ) {
+    mdi_error("Error in delta codec: unable to allocate encoding buffer");
+    return 1;
+  }
+  memset(out, 0, nnibble_bytes);
+
+  const unsigned char* cur = (const unsigned char*)buf;
+  size_t pos = nnibble_bytes;
+  size_t i;
+  for ( i = 0; i < nwords && pos < raw_bytes; i++ ) {
+    uint64_t x = delta_load(cur + i * wordsize, wordsize) ^ delta_load(frame->data + i * wordsize, wordsize);
+    size_t nsig = 0;
+    while ( nsig < wordsize && ( x >> ( 8 * nsig ) ) != 0 ) {
+      nsig++;
+    }
+    out[i / 2] |= (unsigned char)( nsig << ( 4 * ( i % 2 ) ) );
+    size_t ibyte;
+    for ( ibyte = 0; ibyte < nsig; ibyte++ ) {
+      out[pos + ibyte] = (unsigned char)( x >> ( 8 * ibyte ) );
+    }
+    pos += nsig;
+  }
+
+  // fall back to a keyframe if the encoding does not reduce the message size
+  if ( i < nwords || pos >= raw_bytes ) {
+    pool_free( out );
+    return delta_keyframe(comm, buf, count, datatype, 0);
+  }
+
+  memcpy(frame->data, buf, raw_bytes);
+  frame->age++;
+
+  *wire_buf = out;
+  *wire_bytes = pos;
+  *header_type = MDI_HEADER_DELTA;
+  return 0;
+}
+
+
+/*! \brief Decode a delta-encoded message
+ *
+ * The function returns \p 0 on a success.
+ *
+ * \param [in]       comm
+ *                   Pointer to the communicator.
+ * \param [in]       wire_buf
+ *                   Pointer to the encoded message.
+ * \param [in]       wire_bytes
+ *                   Number of bytes in the encoded message.
+ * \param [out]      buf
+ *                   Pointer to the buffer where the decoded data will be stored.
+ * \param [in]       count
+ *                   Number of elements in the message.
+ * \param [in]       datatype
+ *                   MDI handle (MDI_INT, MDI_DOUBLE, etc.) of the message.
+ */
+int delta_decode(communicator* comm, const void* wire_buf, size_t wire_bytes,
+                 void* buf, size_t count, MDI_Datatype datatype) {
+  size_t wordsize = delta_wordsize(datatype);
+  size_t raw_bytes = count * datatype_size(datatype);
+  size_t nwords = raw_bytes / wordsize;
+  delta_frame* frame = delta_find_frame(comm, 1);
+  if ( frame == NULL || frame->datatype != datatype || frame->count != count ) {
+    mdi_error("Error in MDI_Recv: delta-encoded message received without a reference frame");
+    return 1;
+  }
+
+  size_t nnibble_bytes = ( nwords + 1 ) / 2;
+  if ( wire_bytes < nnibble_bytes ) {
+    mdi_error("Error in MDI_Recv: truncated delta-encoded message");
+    return 1;
+  }
+
+  const unsigned char* in = (const unsigned char*)wire_buf;
+  unsigned char* out = (unsigned char*)buf;
+  size_t pos = nnibble_bytes;
+  size_t i;
+  for ( i = 0; i < nwords; i++ ) {
+    size_t nsig = ( in[i / 2] >> ( 4 * ( i % 2 ) ) ) & 0xF;
+    if ( nsig > wordsize || pos + nsig > wire_bytes ) {
+      mdi_error("Error in MDI_Recv: corrupt delta-encoded message");
+      return 1;
+    }
+    uint64_t x = 0;
+    size_t ibyte;
+    for ( ibyte = 0; ibyte < nsig; ibyte++ ) {
+      x |= (uint64_t)in[pos + ibyte] << ( 8 * ibyte );
+    }
+    pos += nsig;
+    delta_store(out + i * wordsize, x ^ delta_load(frame->data + i * wordsize, wordsize), wordsize);
+  }
+  if ( pos != wire_bytes ) {
+    mdi_error("Error in MDI_Recv: corrupt delta-encoded message");
+    return 1;
+  }
+
+  memcpy(frame->data, buf, raw_bytes);
+  frame->age++;
+
+  return 0;
+}
+
+
+/*! \brief Free all frames associated with a communicator
+ *
+ * The function returns \p 0 on a success.
+ *
+ * \param [in]       comm
+ *                   Pointer to the communicator.
+ */
+int delta_free(communicator* comm) {
+  if ( comm->delta_frames == NULL ) {
+    return 0;
+  }
+  int iframe;
+  for ( iframe = 0; iframe < comm->delta_frames->size; iframe++ ) {
+    delta_frame* frame = vector_get(comm->delta_frames, iframe);
+    free( frame->data );
+  }
+  vector_free(comm->delta_frames);
+  free( comm->delta_frames );
+  comm->delta_frames = NULL;
+  return 0;
+}
@@ -0,0 +1,44 @@
+/*! \file
+ *
+ * \brief Temporal delta codec for repeated per-step arrays
+ */
+
+#ifndef MDI_DELTA
+#define MDI_DELTA
+
+#include "mdi.h"
+#include "mdi_global.h"
+
+// Number of delta-encoded messages that may be sent before a keyframe is forced
+#define DELTA_KEYFRAME_INTERVAL 64
+
+// Minimum number of elements for which a message is delta-encoded
+#define DELTA_MIN_COUNT 16
+
+typedef struct delta_frame_struct {
+  /*! \brief Command that preceded the message */
+  char command[COMMAND_LENGTH];
+  /*! \brief Index of the message since the command */
+  int msg_index;
+  /*! \brief Direction of the message: 0 if it was sent, 1 if it was received */
+  int direction;
+  /*! \brief MDI datatype of the message */
+  MDI_Datatype_Type datatype;
+  /*! \brief Number of elements in the message */
+  size_t count;
+  /*! \brief Number of delta-encoded messages since the last keyframe */
+  int age;
+  /*! \brief Contents of the previous message */
+  unsigned char* data;
+} delta_frame;
+
+int delta_applies(communicator* comm, size_t count, MDI_Datatype datatype);
+int delta_encode(communicator* comm, const void* buf, size_t count, MDI_Datatype datatype,
+                 void** wire_buf, size_t* wire_bytes, int* header_type);
+int delta_decode(communicator* comm, const void* wire_buf, size_t wire_bytes,
+                 void* buf, size_t count, MDI_Datatype datatype);
+int delta_keyframe(communicator* comm, const void* buf, size_t count, MDI_Datatype datatype,
+                   int direction);
+int delta_free(communicator* comm);
+
+#endif
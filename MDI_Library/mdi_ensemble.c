@@ -0,0 +1,250 @@
+/*! \file
+ *
+ * \brief Ensembles of plugin instances that share out a list of tasks
+ *
+ * MDI_Launch_plugin_ensemble partitions an MPI communicator into a group of driver ranks,
+ * followed by groups of plugin_nranks ranks that each run one plugin instance at a time.
+ * The first driver rank assigns the tasks: whenever an instance finishes a task, it asks for
+ * another, so that instances which finish early take on more of the tasks.
+ * Each task is a separate launch of the plugin on the same ranks, and the partition is kept by
+ * the context, so that later ensembles over the same ranks do not split the communicator again.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "mdi.h"
+#include "mdi_ensemble.h"
+#include "mdi_global.h"
+#include "mdi_lib.h"
+
+typedef struct ensemble_task_struct {
+  /*! \brief Callback that drives the engine of the plugin through the task */
+  MDI_Ensemble_task_callback_t task_callback;
+  /*! \brief Object that is passed to task_callback */
+  void* class_object;
+  /*! \brief Index of the task */
+  int task;
+} ensemble_task;
+
+
+/*! \brief Driver node callback of each launch, which passes the task to the user's callback
+ */
+static int ensemble_run_task(void* mpi_comm_ptr, MDI_Comm comm, void* arg) {
+  ensemble_task* task = (ensemble_task*) arg;
+  return task->task_callback(mpi_comm_ptr, comm, task->task, task->class_object);
+}
+
+
+/*! \brief Free the partition of the ranks that is kept by the active context
+ *
+ * This must be called before MPI is finalized.
+ * The function returns \p 0 on a success.
+ */
+int ensemble_free_partition() {
+  ensemble_partition* partition = &active_context->ensemble;
+  if ( partition->initialized ) {
+    MPI_Comm_free(&partition->task_comm);
+    MPI_Comm_free(&partition->intra_comm);
+    partition->initialized = 0;
+  }
+  return 0;
+}
+
+
+/*! \brief Partition an MPI communicator into the driver ranks and the plugin instances
+ *
+ * The partition of the previous call is reused if it is of the same communicator, with the same
+ * numbers of ranks.
+ * The handle of a freed communicator may be reused by MPI for a new one, so the communicator is
+ * also compared with the duplicate that was made of it, which has the same group only if it is
+ * still the communicator that was partitioned.
+ * This is collective over the communicator.
+ * The function returns \p 0 on a success.
+ *
+ * \param [in]       parent
+ *                   The MPI communicator.
+ * \param [in]       driver_nranks
+ *                   Number of ranks, at the start of parent, that run the driver.
+ * \param [in]       plugin_nranks
+ *                   Number of ranks that run each plugin instance.
+ */
+static int ensemble_partition_ranks(MPI_Comm parent, int driver_nranks, int plugin_nranks) {
+  ensemble_partition* partition = &active_context->ensemble;
+  if ( partition->initialized && partition->parent == parent &&
+       partition->driver_nranks == driver_nranks && partition->plugin_nranks == plugin_nranks ) {
+    int result = MPI_UNEQUAL;
+    MPI_Comm_compare(parent, partition->task_comm, &result);
+    if ( result == MPI_CONGRUENT ) {
+      return 0;
+    }
+  }
+  ensemble_free_partition();
+
+  int rank = 0;
+  MPI_Comm_rank(parent, &rank);
+  int color = 0;
+  if ( rank >= driver_nranks ) {
+    color = ( ( rank - driver_nranks ) / plugin_nranks ) + 1;
+  }
+  if ( MPI_Comm_dup(parent, &partition->task_comm) != 0 ) {
+    mdi_error("Error in MDI_Launch_plugin_ensemble: Unable to duplicate the MPI communicator");
+    return 1;
+  }
+  if ( MPI_Comm_split(parent, color, rank, &partition->intra_comm) != 0 ) {
+    MPI_Comm_free(&partition->task_comm);
+    mdi_error("Error in MDI_Launch_plugin_ensemble: Unable to split the MPI communicator");
+    return 1;
+  }
+  partition->parent = parent;
+  partition->driver_nranks = driver_nranks;
+  partition->plugin_nranks = plugin_nranks;
+  partition->initialized = 1;
+  return 0;
+}
+
+
+/*! \brief Assign each task to the first plugin instance that asks for one
+ *
+ * This runs on the first driver rank, and returns once every instance has been told to stop.
+ * The function returns \p 0 if every task was run and none of them failed.
+ *
+ * \param [in]       ninstances
+ *                   Number of plugin instances.
+ * \param [in]       ntasks
+ *                   Number of tasks.
+ */
+static int ensemble_assign_tasks(int ninstances, int ntasks) {
+  MPI_Comm task_comm = active_context->ensemble.task_comm;
+  int next_task = 0;
+  int nstopped = 0;
+  int nfailed = 0;
+  while ( nstopped < ninstances ) {
+    // each request holds the rank of the instance's first rank, and whether its last task failed
+    int request[2];
+    MPI_Recv(request, 2, MPI_INT, MPI_ANY_SOURCE, ENSEMBLE_TASK_TAG, task_comm, MPI_STATUS_IGNORE);
+
+    // an instance whose task failed is given no more tasks
+    int task = -1;
+    if ( request[1] != 0 ) {
+      nfailed++;
+      nstopped++;
+    }
+    else if ( next_task < ntasks ) {
+      task = next_task;
+      next_task++;
+    }
+    else {
+      nstopped++;
+    }
+    MPI_Send(&task, 1, MPI_INT, request[0], ENSEMBLE_TASK_TAG, task_comm);
+  }
+
+  // if every instance failed, some of the tasks were never assigned
+  if ( nfailed > 0 ) {
+    char message[128];
+    snprintf(message, sizeof(message),
+             "Error in MDI_Launch_plugin_ensemble: %d tasks failed, and %d tasks were not run",
+             nfailed, ntasks - next_task);
+    mdi_error(message);
+    return 1;
+  }
+  return 0;
+}
+
+
+/*! \brief Launch plugin instances on a partition of an MPI communicator, and share out tasks among them
+ *
+ * This is collective over the communicator.
+ * The function returns \p 0 on a success.
+ * On the ranks of an instance whose task failed, it returns a nonzero value as soon as the instance
+ * is told to stop, without waiting for the other instances.
+ * On the driver ranks, it returns once every instance has stopped, and returns a nonzero value if
+ * any task failed or was not run.
+ *
+ * \param [in]       plugin_name
+ *                   Name of the plugin.
+ * \param [in]       options
+ *                   Command-line options for the plugin.
+ * \param [in]       mpi_comm_ptr
+ *                   Pointer to the MPI communicator that is partitioned.
+ * \param [in]       driver_nranks
+ *                   Number of ranks, at the start of the communicator, that run the driver.
+ * \param [in]       plugin_nranks
+ *                   Number of ranks that run each plugin instance.
+ * \param [in]       ntasks
+ *                   Number of tasks.
+ * \param [in]       task_callback
+ *                   Function that drives the engine of an instance through a task.
+ * \param [in]       class_object
+ *                   Object that is passed to task_callback.
+ */
+int ensemble_launch(const char* plugin_name, const char* options, void* mpi_comm_ptr,
+                    int driver_nranks, int plugin_nranks, int ntasks,
+                    MDI_Ensemble_task_callback_t task_callback, void* class_object) {
+  code* this_code = get_code(active_context->current_code);
+  if ( strcmp(this_code->role, "DRIVER") != 0 ) {
+    mdi_error("Error in MDI_Launch_plugin_ensemble: Only a driver may launch a plugin");
+    return 1;
+  }
+  if ( driver_nranks < 1 || plugin_nranks < 1 || ntasks < 0 ) {
+    mdi_error("Error in MDI_Launch_plugin_ensemble: Invalid number of ranks or tasks");
+    return 1;
+  }
+
+  MPI_Comm parent = *(MPI_Comm*) mpi_comm_ptr;
+  int rank = 0;
+  int size = 1;
+  MPI_Comm_rank(parent, &rank);
+  MPI_Comm_size(parent, &size);
+  if ( size <= driver_nranks || ( size - driver_nranks ) % plugin_nranks != 0 ) {
+    mdi_error("Error in MDI_Launch_plugin_ensemble: The ranks that do not run the driver must form whole plugin instances");
+    return 1;
+  }
+  if ( ensemble_partition_ranks(parent, driver_nranks, plugin_nranks) != 0 ) {
+    return 1;
+  }
+  ensemble_partition* partition = &active_context->ensemble;
+
+  // the first driver rank assigns the tasks, and then tells the other driver ranks whether they all ran
+  if ( rank < driver_nranks ) {
+    int status = 0;
+    if ( rank == 0 ) {
+      status = ensemble_assign_tasks( ( size - driver_nranks ) / plugin_nranks, ntasks );
+    }
+    MPI_Bcast(&status, 1, MPI_INT, 0, partition->intra_comm);
+    return status;
+  }
+
+  // run tasks until the first driver rank has none left
+  int intra_rank = 0;
+  MPI_Comm_rank(partition->intra_comm, &intra_rank);
+  int failed = 0;
+  while ( 1 ) {
+    int task = -1;
+    if ( intra_rank == 0 ) {
+      int request[2] = { rank, failed };
+      MPI_Send(request, 2, MPI_INT, 0, ENSEMBLE_TASK_TAG, partition->task_comm);
+      MPI_Recv(&task, 1, MPI_INT, 0, ENSEMBLE_TASK_TAG, partition->task_comm, MPI_STATUS_IGNORE);
+    }
+    MPI_Bcast(&task, 1, MPI_INT, 0, partition->intra_comm);
+    if ( task < 0 ) {
+      break;
+    }
+
+    // every rank of the instance stops if the task failed on any of them
+    ensemble_task this_task;
+    this_task.task_callback = task_callback;
+    this_task.class_object = class_object;
+    this_task.task = task;
+    int ret = library_launch_plugin(plugin_name, options, &partition->intra_comm,
+                                    ensemble_run_task, &this_task);
+    int task_failed = ( ret != 0 );
+    MPI_Allreduce(&task_failed, &failed, 1, MPI_INT, MPI_MAX, partition->intra_comm);
+  }
+
+  if ( failed ) {
+    mdi_error("Error in MDI_Launch_plugin_ensemble: A task failed");
+    return 1;
+  }
+  return 0;
+}
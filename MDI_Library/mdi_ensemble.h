@@ -0,0 +1,20 @@
+/*! \file
+ *
+ * \brief Ensembles of plugin instances that share out a list of tasks
+ */
+
+#ifndef MDI_ENSEMBLE_IMPL
+#define MDI_ENSEMBLE_IMPL
+
+#include "mdi.h"
+#include "mdi_global.h"
+
+/*! \brief MPI tag of the messages through which tasks are requested and assigned */
+#define ENSEMBLE_TASK_TAG 7301
+
+int ensemble_launch(const char* plugin_name, const char* options, void* mpi_comm_ptr,
+                    int driver_nranks, int plugin_nranks, int ntasks,
+                    MDI_Ensemble_task_callback_t task_callback, void* class_object);
+int ensemble_free_partition();
+
+#endif
@@ -0,0 +1,264 @@
+/*! \file
+ *
+ * \brief Filter stages that transform the bodies of messages
+ *
+ * A filter stage sits between general_send or general_recv and the communication method.
+ * The stages attached to a communicator form a chain.
+ * The body of each message that is sent passes through the on_send function of each stage, in
+ * the order in which the stages were attached, before it is encoded by any negotiated codecs.
+ * The body of each message that is received passes through the on_recv function of each stage,
+ * in the reverse order, after it has been decoded.
+ * Stages preserve the count and datatype of the body, so they do not affect the header of the
+ * message, and a communicator without stages takes the same path as before.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "mdi.h"
+#include "mdi_filter.h"
+#include "mdi_datatype.h"
+#include "mdi_global.h"
+
+
+/*! \brief Verify that the values in the body of a message are finite
+ *
+ * Bodies that do not hold floating point values are passed through unchanged.
+ * The function returns \p 0 on a success.
+ *
+ * \param [in]       buf
+ *                   Pointer to the body of the message.
+ * \param [in]       count
+ *                   Number of values in the body.
+ * \param [in]       datatype
+ *                   MDI handle (MDI_INT, MDI_DOUBLE, MDI_CHAR, etc.) of the body.
+ */
+static int filter_finite_check(const void* buf, int64_t count, MDI_Datatype datatype) {
+  int64_t i;
+  if ( datatype == MDI_DOUBLE || datatype == MDI_COMPLEX_DOUBLE ) {
+    int64_t n = ( datatype == MDI_COMPLEX_DOUBLE ) ? 2 * count : count;
+    const double* values = (const double*) buf;
+    for ( i = 0; i < n; i++ ) {
+      if ( ! isfinite(values[i]) ) {
+        mdi_error("Error in MDI: the finite filter found a value that is not finite");
+        return 1;
+      }
+    }
+  }
+  else if ( datatype == MDI_FLOAT ) {
+    const float* values = (const float*) buf;
+    for ( i = 0; i < count; i++ ) {
+      if ( ! isfinite(values[i]) ) {
+        mdi_error("Error in MDI: the finite filter found a value that is not finite");
+        return 1;
+      }
+    }
+  }
+  return 0;
+}
+
+
+/*! \brief Send function of the builtin \p finite filter, which passes the body through unchanged
+ */
+static int filter_finite_send(const void** buf, int64_t count, MDI_Datatype datatype, MDI_Comm comm,
+                              void* state) {
+  return filter_finite_check(*buf, count, datatype);
+}
+
+
+/*! \brief Receive function of the builtin \p finite filter
+ */
+static int filter_finite_recv(void* buf, int64_t count, MDI_Datatype datatype, MDI_Comm comm,
+                              void* state) {
+  return filter_finite_check(buf, count, datatype);
+}
+
+
+/*! \brief Filters that may be selected by name
+ *
+ * The table is shared by all contexts, and begins with the builtin filters.
+ * Entries are never removed, so a filter index remains valid for the lifetime of the process.
+ */
+static filter_entry registered_filters[MDI_MAX_REGISTERED_FILTERS] = {
+  { "finite", { filter_finite_send, filter_finite_recv, NULL } }
+};
+
+/*! \brief Number of filters in registered_filters */
+static int nregistered_filters = 1;
+
+
+/*! \brief Register a filter, so that it can be selected by name
+ *
+ * The function returns \p 0 on a success.
+ *
+ * \param [in]       name
+ *                   Name of the filter.
+ * \param [in]       on_send
+ *                   Function that may replace the body of each message sent, or NULL.
+ * \param [in]       on_recv
+ *                   Function that may transform the body of each message received, or NULL.
+ * \param [in]       state
+ *                   Pointer passed to each call of \p on_send and \p on_recv.
+ */
+int filter_register(const char* name, MDI_Filter_send_t on_send, MDI_Filter_recv_t on_recv, void* state) {
+  if ( name == NULL || name[0] == '\0' || strlen(name) >= NAME_LENGTH || strchr(name, ' ') != NULL ) {
+    mdi_error("Error in MDI_Register_filter: Invalid filter name");
+    return 1;
+  }
+  if ( filter_find(name) >= 0 ) {
+    mdi_error("Error in MDI_Register_filter: A filter with this name has already been registered");
+    return 1;
+  }
+  if ( nregistered_filters >= MDI_MAX_REGISTERED_FILTERS ) {
+    mdi_error("Error in MDI_Register_filter: Too many filters have been registered");
+    return 1;
+  }
+
+  filter_entry* new_filter = &registered_filters[nregistered_filters];
+  snprintf(new_filter->name, NAME_LENGTH, "%s", name);
+  new_filter->stage.on_send = on_send;
+  new_filter->stage.on_recv = on_recv;
+  new_filter->stage.state = state;
+  nregistered_filters++;
+
+  return 0;
+}
+
+
+/*! \brief Return the index of the registered filter with a given name, or \p -1 if there is none
+ *
+ * \param [in]       name
+ *                   Name of the filter.
+ */
+int filter_find(const char* name) {
+  int ifilter;
+  for (ifilter = 0; ifilter < nregistered_filters; ifilter++) {
+    if ( strcmp(registered_filters[ifilter].name, name) == 0 ) {
+      return ifilter;
+    }
+  }
+  return -1;
+}
+
+
+/*! \brief Attach a registered filter to the end of the chain of a communicator
+ *
+ * The function returns \p 0 on a success.
+ *
+ * \param [in]       this_comm
+ *                   Pointer to the communicator.
+ * \param [in]       filter_index
+ *                   Index of the filter, as returned by filter_find().
+ */
+int filter_push(communicator* this_comm, int filter_index) {
+  if ( this_comm->nfilters >= MDI_MAX_FILTERS ) {
+    mdi_error("Error in MDI: Too many filters are attached to this communicator");
+    return 1;
+  }
+  this_comm->filters[this_comm->nfilters] = registered_filters[filter_index].stage;
+  this_comm->nfilters++;
+  return 0;
+}
+
+
+/*! \brief Detach the filter at the end of the chain of a communicator
+ *
+ * The function returns \p 0 on a success.
+ *
+ * \param [in]       this_comm
+ *                   Pointer to the communicator.
+ */
+int filter_pop(communicator* this_comm) {
+  if ( this_comm->nfilters == 0 ) {
+    mdi_error("Error in MDI_Filter_pop: No filters are attached to this communicator");
+    return 1;
+  }
+  this_comm->nfilters--;
+  return 0;
+}
+
+
+/*! \brief Attach the filters selected by the -filter option of a code to a new communicator
+ *
+ * The function returns \p 0 on a success.
+ *
+ * \param [in]       this_code
+ *                   Pointer to the code.
+ * \param [in]       this_comm
+ *                   Pointer to the communicator.
+ */
+int filter_attach_code_filters(code* this_code, communicator* this_comm) {
+  int ifilter;
+  this_comm->nfilters = 0;
+  for (ifilter = 0; ifilter < this_code->nfilters; ifilter++) {
+    int ret = filter_push(this_comm, this_code->filters[ifilter]);
+    if ( ret != 0 ) { return ret; }
+  }
+  return 0;
+}
+
+
+/*! \brief Pass the body of a message that is about to be sent through the chain of a communicator
+ *
+ * Each stage may replace the body with a transformed copy that it owns, which must remain valid
+ * until the stage is next called; otherwise, the body is passed on without being copied.
+ * The function returns \p 0 on a success.
+ *
+ * \param [in]       this_comm
+ *                   Pointer to the communicator.
+ * \param [in, out]  buf
+ *                   On input, pointer to the body of the message.
+ *                   On output, pointer to the body that should be sent.
+ * \param [in]       count
+ *                   Number of values in the body.
+ * \param [in]       datatype
+ *                   MDI handle (MDI_INT, MDI_DOUBLE, MDI_CHAR, etc.) of the body.
+ * \param [in]       comm
+ *                   MDI communicator associated with the intended recipient code.
+ */
+int filter_send(communicator* this_comm, const void** buf, size_t count, MDI_Datatype datatype, MDI_Comm comm) {
+  int ifilter;
+  for (ifilter = 0; ifilter < this_comm->nfilters; ifilter++) {
+    filter_stage* stage = &this_comm->filters[ifilter];
+    if ( stage->on_send != NULL ) {
+      int ret = stage->on_send(buf, (int64_t)count, datatype, comm, stage->state);
+      if ( ret != 0 ) {
+        mdi_error("Error in MDI_Send: A filter rejected the message");
+        return ret;
+      }
+    }
+  }
+  return 0;
+}
+
+
+/*! \brief Pass the body of a message that has been received through the chain of a communicator
+ *
+ * The stages are called in the reverse order of filter_send, and transform the body in place.
+ * The function returns \p 0 on a success.
+ *
+ * \param [in]       this_comm
+ *                   Pointer to the communicator.
+ * \param [in, out]  buf
+ *                   Pointer to the body of the message.
+ * \param [in]       count
+ *                   Number of values in the body.
+ * \param [in]       datatype
+ *                   MDI handle (MDI_INT, MDI_DOUBLE, MDI_CHAR, etc.) of the body.
+ * \param [in]       comm
+ *                   MDI communicator associated with the connection to the sending code.
+ */
+int filter_recv(communicator* this_comm, void* buf, size_t count, MDI_Datatype datatype, MDI_Comm comm) {
+  int ifilter;
+  for (ifilter = this_comm->nfilters - 1; ifilter >= 0; ifilter--) {
+    filter_stage* stage = &this_comm->filters[ifilter];
+    if ( stage->on_recv != NULL ) {
+      int ret = stage->on_recv(buf, (int64_t)count, datatype, comm, stage->state);
+      if ( ret != 0 ) {
+        mdi_error("Error in MDI_Recv: A filter rejected the message");
+        return ret;
+      }
+    }
+  }
+  return 0;
+}
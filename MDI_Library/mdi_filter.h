@@ -0,0 +1,30 @@
+/*! \file
+ *
+ * \brief Filter stages that transform the bodies of messages
+ */
+
+#ifndef MDI_FILTER_IMPL
+#define MDI_FILTER_IMPL
+
+#include "mdi.h"
+#include "mdi_global.h"
+
+/*! \brief Largest number of filters that may be registered, including the builtin filters */
+#define MDI_MAX_REGISTERED_FILTERS 32
+
+typedef struct filter_entry_struct {
+  /*! \brief Name of the filter, as given to the -filter option */
+  char name[NAME_LENGTH];
+  /*! \brief Stage that is attached to a communicator when the filter is selected */
+  filter_stage stage;
+} filter_entry;
+
+int filter_register(const char* name, MDI_Filter_send_t on_send, MDI_Filter_recv_t on_recv, void* state);
+int filter_find(const char* name);
+int filter_push(communicator* this_comm, int filter_index);
+int filter_pop(communicator* this_comm);
+int filter_attach_code_filters(code* this_code, communicator* this_comm);
+int filter_send(communicator* this_comm, const void** buf, size_t count, MDI_Datatype datatype, MDI_Comm comm);
+int filter_recv(communicator* this_comm, void* buf, size_t count, MDI_Datatype datatype, MDI_Comm comm);
+
+#endif
@@ -7,12 +7,22 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <limits.h>
 #include "mdi.h"
 #include "mdi_general.h"
 #include "mdi_mpi.h"
 #include "mdi_tcp.h"
 #include "mdi_lib.h"
+#include "mdi_async.h"
 #include "mdi_test.h"
+#include "mdi_custom.h"
+#include "mdi_filter.h"
+#include "mdi_delta.h"
+#include "mdi_compress.h"
+#include "mdi_precision.h"
+#include "mdi_datatype.h"
+#include "mdi_units.h"
+#include "mdi_regcache.h"
 
 /*! \brief Initialize communication through the MDI library
  *
@@ -27,15 +37,15 @@
  *                   Only used if the "-method MPI" option is provided.
  */
 int general_init(const char* options, void* world_comm) {
-  // If this is the first time MDI has initialized, initialize the code vector
-  if ( ! is_initialized ) {
-    vector_init(&codes, sizeof(code));
+  // If this is the first time MDI has initialized, initialize the code slot map
+  if ( ! active_context->is_initialized ) {
+    slot_map_init(&active_context->codes, sizeof(code), 0);
   }
 
   // MDI assumes that each call to general_init corresponds to a new code, so create a new code now
   // Note that unless using the LINK communication method, general_init should only be called once
-  current_code = new_code();
-  code* this_code = get_code(current_code);
+  active_context->current_code = new_code();
+  code* this_code = get_code(active_context->current_code);
 
   char* strtol_ptr;
   int i, ret;
@@ -138,9 +148,54 @@ int general_init(const char* options, void* world_comm) {
     }
     //-ipi
     else if (strcmp(argv[iarg],"-ipi") == 0) {
-      ipi_compatibility = 1;
+      active_context->ipi_compatibility = 1;
       iarg += 1;
     }
+    //-delta
+    else if (strcmp(argv[iarg],"-delta") == 0) {
+      this_code->features |= MDI_FEATURE_DELTA;
+      iarg += 1;
+    }
+    //-compress
+    else if (strcmp(argv[iarg],"-compress") == 0) {
+      this_code->features |= MDI_FEATURE_COMPRESS;
+      iarg += 1;
+    }
+    //-compress_threshold
+    else if (strcmp(argv[iarg],"-compress_threshold") == 0) {
+      if (iarg+2 > argc) {
+	mdi_error("Error in MDI_Init: Argument missing from -compress_threshold option");
+	return 1;
+      }
+      this_code->compress_threshold = strtol( argv[iarg+1], &strtol_ptr, 10 );
+      if ( this_code->compress_threshold < 0 ) {
+	mdi_error("Error in MDI_Init: Invalid -compress_threshold argument");
+	return 1;
+      }
+      iarg += 2;
+    }
+    //-precision
+    else if (strcmp(argv[iarg],"-precision") == 0) {
+      if (iarg+2 > argc) {
+	mdi_error("Error in MDI_Init: Argument missing from -precision option");
+	return 1;
+      }
+      if ( strcmp(argv[iarg+1], "double") == 0 ) {
+	this_code->features &= ~( MDI_FEATURE_FLOAT32 | MDI_FEATURE_BFLOAT16 );
+      }
+      else if ( strcmp(argv[iarg+1], "float") == 0 ) {
+	this_code->features |= MDI_FEATURE_FLOAT32;
+      }
+      else if ( strcmp(argv[iarg+1], "bfloat16") == 0 ) {
+	// a code that accepts bfloat16 also accepts float32
+	this_code->features |= MDI_FEATURE_FLOAT32 | MDI_FEATURE_BFLOAT16;
+      }
+      else {
+	mdi_error("Error in MDI_Init: Invalid -precision argument");
+	return 1;
+      }
+      iarg += 2;
+    }
     //-out
     else if (strcmp(argv[iarg],"-out") == 0) {
       if (iarg+2 > argc) {
@@ -171,6 +226,41 @@ int general_init(const char* options, void* world_comm) {
       has_plugin_path = 1;
       iarg += 2;
     }
+    //-registry_cache
+    else if (strcmp(argv[iarg],"-registry_cache") == 0) {
+      if (iarg+2 > argc) {
+	mdi_error("Error in MDI_Init: Argument missing from -registry_cache option");
+	return 1;
+      }
+      free( this_code->registry_cache_path );
+      this_code->registry_cache_path = malloc( ( strlen(argv[iarg+1]) + 1 ) * sizeof(char) );
+      snprintf(this_code->registry_cache_path, strlen(argv[iarg+1]) + 1, "%s", argv[iarg+1]);
+      iarg += 2;
+    }
+    //-persistent
+    else if (strcmp(argv[iarg],"-persistent") == 0) {
+      this_code->persistent = 1;
+      iarg += 1;
+    }
+    //-filter
+    else if (strcmp(argv[iarg],"-filter") == 0) {
+      if (iarg+2 > argc) {
+	mdi_error("Error in MDI_Init: Argument missing from -filter option");
+	return 1;
+      }
+      int filter_index = filter_find(argv[iarg+1]);
+      if ( filter_index < 0 ) {
+	mdi_error("Error in MDI_Init: Filter not recognized");
+	return 1;
+      }
+      if ( this_code->nfilters >= MDI_MAX_FILTERS ) {
+	mdi_error("Error in MDI_Init: Too many -filter options");
+	return 1;
+      }
+      this_code->filters[this_code->nfilters] = filter_index;
+      this_code->nfilters++;
+      iarg += 2;
+    }
     //_language
     else if (strcmp(argv[iarg],"_language") == 0) {
       if (iarg+2 > argc) {
@@ -290,16 +380,16 @@ int general_init(const char* options, void* world_comm) {
 
   // if the method is not LIB, ensure that MDI has not been previously initialized
   if ( strcmp(method, "LINK") != 0 ) {
-    if ( is_initialized == 1 ) {
+    if ( active_context->is_initialized == 1 ) {
       mdi_error("MDI_Init called after MDI was already initialized");
       return 1;
     }
   }
 
   // ensure that the name of this code is not the same as the name of any of the other codes
-  for (i = 0; i < codes.size; i++) {
-    if ( i != current_code ) {
-      code* other_code = vector_get(&codes, i);
+  for (i = 0; i < active_context->codes.slots.size; i++) {
+    code* other_code = slot_map_at(&active_context->codes, i);
+    if ( other_code != NULL && other_code->id != active_context->current_code ) {
       if (strcmp(this_code->name, other_code->name) == 0) {
 	mdi_error("MDI_Init found multiple codes with the same name");
 	return 1;
@@ -308,17 +398,18 @@ int general_init(const char* options, void* world_comm) {
   }
 
   // Check if this is an engine being used as a library
+  // the engine of an asynchronous plugin runs on its own thread, and instead receives its commands
   if (strcmp(this_code->role, "ENGINE") == 0) {
-    if ( strcmp(method, "LINK") == 0 ) {
+    if ( strcmp(method, "LINK") == 0 && active_context->async_plugin == NULL ) {
       this_code->is_library = 1;
     }
   }
 
   // ensure that at most one driver has been initialized
   if (strcmp(this_code->role, "DRIVER") == 0) {
-    for (i = 0; i < codes.size; i++) {
-      if ( i != current_code ) {
-	code* other_code = vector_get(&codes, i);
+    for (i = 0; i < active_context->codes.slots.size; i++) {
+      code* other_code = slot_map_at(&active_context->codes, i);
+      if ( other_code != NULL && other_code->id != active_context->current_code ) {
 	if (strcmp(this_code->role, other_code->role) == 0) {
 	  mdi_error("MDI_Init found multiple drivers");
 	  return 1;
@@ -333,6 +424,18 @@ int general_init(const char* options, void* world_comm) {
     use_mpi4py = 1;
   }
 
+  // a persistent engine must be able to connect to later drivers on its own
+  if ( this_code->persistent ) {
+    if ( strcmp(role, "ENGINE") != 0 ) {
+      mdi_error("Error in MDI_Init: The -persistent option is only available to engines");
+      return 1;
+    }
+    if ( strcmp(method, "TCP") != 0 && custom_find(method) < 0 ) {
+      mdi_error("Error in MDI_Init: The -persistent option requires the TCP method or a registered method");
+      return 1;
+    }
+  }
+
   if ( strcmp(role, "DRIVER") == 0 ) {
     // initialize this code as a driver
 
@@ -355,6 +458,12 @@ int general_init(const char* options, void* world_comm) {
     else if ( strcmp(method, "TEST") == 0 ) {
       test_initialize();
     }
+    else if ( custom_find(method) >= 0 ) {
+      ret = custom_initialize(custom_find(method), role, options);
+      if ( ret != 0 ) {
+	return ret;
+      }
+    }
     else {
       mdi_error("Error in MDI_Init: Method not recognized");
       return 1;
@@ -365,7 +474,7 @@ int general_init(const char* options, void* world_comm) {
     // initialize this code as an engine
 
     if ( strcmp(method, "MPI") == 0 ) {
-      code* this_code = get_code(current_code);
+      code* this_code = get_code(active_context->current_code);
       mpi_identify_codes(this_code->name, use_mpi4py, mpi_communicator);
       mpi_initialized = 1;
     }
@@ -378,6 +487,11 @@ int general_init(const char* options, void* world_comm) {
 	mdi_error("Error in MDI_Init: -port option not provided");
 	return 1;
       }
+      if ( this_code->persistent ) {
+        this_code->driver_hostname = malloc( ( strlen(hostname) + 1 ) * sizeof(char) );
+        snprintf(this_code->driver_hostname, strlen(hostname) + 1, "%s", hostname);
+        this_code->driver_port = port;
+      }
       if ( this_code->intra_rank == 0 ) {
 	tcp_request_connection(port, hostname);
       }
@@ -387,11 +501,25 @@ int general_init(const char* options, void* world_comm) {
 	mdi_error("Error in MDI_Init: -driver_name option not provided");
 	return 1;
       }
-      library_initialize();
+      if ( active_context->async_plugin != NULL ) {
+	ret = async_initialize();
+	if ( ret != 0 ) {
+	  return ret;
+	}
+      }
+      else {
+	library_initialize();
+      }
     }
     else if ( strcmp(method, "TEST") == 0 ) {
       test_initialize();
     }
+    else if ( custom_find(method) >= 0 ) {
+      ret = custom_initialize(custom_find(method), role, options);
+      if ( ret != 0 ) {
+	return ret;
+      }
+    }
     else {
       mdi_error("Error in MDI_Init: method not recognized");
       return 1;
@@ -411,6 +539,76 @@ int general_init(const char* options, void* world_comm) {
 }
 
 
+/*! \brief Return the oldest communicator of a code that has not yet been returned by
+ * MDI_Accept_Communicator, or \p MDI_COMM_NULL if there is none
+ *
+ * \param [in]       this_code
+ *                   The code.
+ */
+static MDI_Comm general_next_new_communicator(code* this_code) {
+  while ( this_code->returned_comms < this_code->new_comms->size ) {
+    MDI_Comm comm = *(MDI_Comm*)vector_get(this_code->new_comms, this_code->returned_comms);
+    this_code->returned_comms++;
+
+    // once every communicator has been returned, the vector can be emptied
+    if ( this_code->returned_comms == this_code->new_comms->size ) {
+      this_code->new_comms->size = 0;
+      this_code->returned_comms = 0;
+    }
+
+    // skip communicators that were deleted, or returned by other means, before they could be returned
+    communicator* this_comm = slot_map_get(this_code->comms, comm);
+    if ( this_comm != NULL && ! this_comm->returned ) {
+      this_comm->returned = 1;
+      return comm;
+    }
+  }
+  return MDI_COMM_NULL;
+}
+
+
+/*! \brief Connect a persistent engine to its next driver
+ *
+ * Communicators through which EXIT has been received, or whose connection broke because the
+ * driver quit without sending EXIT, are deleted first.
+ * If a driver is still connected, the function returns \p MDI_COMM_NULL; otherwise, the
+ * function waits until the next driver accepts the connection, and returns the new communicator.
+ *
+ * \param [in]       this_code
+ *                   The engine.
+ */
+static MDI_Comm general_reconnect(code* this_code) {
+  int connected = 0;
+  size_t icomm;
+  for (icomm = 0; icomm < this_code->comms->slots.size; icomm++) {
+    communicator* this_comm = slot_map_at( this_code->comms, icomm );
+    if ( this_comm != NULL ) {
+      if ( strcmp( this_comm->command, "EXIT" ) == 0 || this_comm->broken ) {
+        delete_communicator(this_code->id, this_comm->id);
+      }
+      else {
+        connected = 1;
+      }
+    }
+  }
+  if ( connected || this_code->intra_rank != 0 ) {
+    return MDI_COMM_NULL;
+  }
+
+  int ret;
+  if ( this_code->custom_method >= 0 ) {
+    ret = custom_reconnect();
+  }
+  else {
+    ret = tcp_request_connection(this_code->driver_port, this_code->driver_hostname);
+  }
+  if ( ret != 0 ) {
+    return MDI_COMM_NULL;
+  }
+  return general_next_new_communicator(this_code);
+}
+
+
 /*! \brief Accept a new MDI communicator
  *
  * The function returns an MDI_Comm that describes a connection between two codes.
@@ -422,22 +620,41 @@ int general_accept_communicator() {
   library_accept_communicator();
 
   // if MDI hasn't returned some connections, do that now
-  code* this_code = get_code(current_code);
-  if ( this_code->returned_comms < this_code->next_comm - 1 ) {
-    this_code->returned_comms++;
-    return this_code->returned_comms;
+  code* this_code = get_code(active_context->current_code);
+  MDI_Comm comm = general_next_new_communicator(this_code);
+  if ( comm != MDI_COMM_NULL ) {
+    return comm;
+  }
+
+  // a persistent engine connects to its next driver once its previous driver has sent EXIT
+  if ( this_code->persistent ) {
+    return general_reconnect(this_code);
   }
 
   // check for any production codes connecting via TCP
-  if ( tcp_socket > 0 ) {
+  if ( active_context->tcp_socket > 0 ) {
 
     //accept a connection via TCP
     tcp_accept_connection();
 
     // if MDI hasn't returned some connections, do that now
-    if ( this_code->returned_comms < this_code->comms->size ) {
-      this_code->returned_comms++;
-      return (MDI_Comm)this_code->returned_comms;
+    comm = general_next_new_communicator(this_code);
+    if ( comm != MDI_COMM_NULL ) {
+      return comm;
+    }
+
+  }
+
+  // check for any codes connecting through a registered method
+  if ( this_code->custom_method >= 0 ) {
+
+    // accept a connection through the registered method
+    custom_accept_connection();
+
+    // if MDI hasn't returned some connections, do that now
+    comm = general_next_new_communicator(this_code);
+    if ( comm != MDI_COMM_NULL ) {
+      return comm;
     }
 
   }
@@ -447,99 +664,166 @@ int general_accept_communicator() {
 }
 
 
-/*! \brief Send a message through the MDI connection
+/*! \brief Negotiate optional features with the code on the other end of a new communicator
  *
- * If running with MPI, this function must be called only by rank \p 0.
+ * Each code advertises the features it is willing to use, and the communicator enables only
+ * those features that are supported by both codes.
+ * This is only done if the connected code uses MDI version 1.3 or higher.
  * The function returns \p 0 on a success.
  *
- * \param [in]       buf
- *                   Pointer to the data to be sent.
+ * \param [in]       comm
+ *                   MDI communicator associated with the connected code.
+ */
+int general_negotiate_features(MDI_Comm comm) {
+  int ret;
+  code* this_code = get_code(active_context->current_code);
+  communicator* this = get_communicator(active_context->current_code, comm);
+
+  this->features = 0;
+  if ( ! ( this->mdi_version[0] > 1 ||
+           ( this->mdi_version[0] == 1 && this->mdi_version[1] >= 3 ) ) ) {
+    return 0;
+  }
+
+  int local_features = this_code->features;
+  int remote_features = 0;
+  ret = this->send(&local_features, 1, MDI_INT, comm, 0);
+  if ( ret != 0 ) {
+    mdi_error("Error in MDI: unable to send the supported features");
+    return ret;
+  }
+  ret = this->recv(&remote_features, 1, MDI_INT, comm, 0);
+  if ( ret != 0 ) {
+    mdi_error("Error in MDI: unable to receive the supported features");
+    return ret;
+  }
+
+  this->features = local_features & remote_features;
+  return 0;
+}
+
+
+/*! \brief Send the header of a message through the MDI connection
+ *
+ * The function returns \p 0 on a success.
+ *
+ * \param [in]       this_comm
+ *                   Pointer to the communicator through which the message is sent.
  * \param [in]       count
- *                   Number of values (integers, double precision floats, characters, etc.) to be sent.
+ *                   Number of values in the body of the message.
  * \param [in]       datatype
- *                   MDI handle (MDI_INT, MDI_DOUBLE, MDI_CHAR, etc.) corresponding to the type of data to be sent.
+ *                   MDI handle (MDI_INT, MDI_DOUBLE, MDI_CHAR, etc.) of the body of the message.
+ * \param [in]       header_type
+ *                   Header flags describing the encoding of the body.
+ * \param [in]       wire_bytes
+ *                   Size of an encoded body, in bytes.
+ * \param [in]       unit_id
+ *                   Identifier of the unit of the body, or \p 0 if the body is in atomic units.
  * \param [in]       comm
  *                   MDI communicator associated with the intended recipient code.
  */
-int general_send(const void* buf, int count, MDI_Datatype datatype, MDI_Comm comm) {
-  int ret = 0;
-
-  communicator* this = get_communicator(current_code, comm);
-
-  // send message header information
+int general_send_header(communicator* this_comm, size_t count, MDI_Datatype datatype,
+                        int header_type, size_t wire_bytes, int unit_id, MDI_Comm comm) {
   // only do this if communicating with MDI version 1.1 or higher
-  if ( ( this->mdi_version[0] > 1 ||
-         ( this->mdi_version[0] == 1 && this->mdi_version[1] >= 1 ) )
-       && ipi_compatibility != 1 ) {
+  if ( ( this_comm->mdi_version[0] > 1 ||
+         ( this_comm->mdi_version[0] == 1 && this_comm->mdi_version[1] >= 1 ) )
+       && active_context->ipi_compatibility != 1 ) {
 
     // prepare the header information
-    size_t nheader = 4;
-    int* header = (int*) malloc( nheader * sizeof(int) );
-    header[0] = 0;        // error flag
-    header[1] = 0;        // header type
-    header[2] = datatype; // datatype
-    header[3] = count;    // count
+    // the extended header is used if any optional features were negotiated
+    int header[MDI_HEADER_LENGTH_EXT];
+    size_t nheader = ( this_comm->features != 0 ) ? MDI_HEADER_LENGTH_EXT : MDI_HEADER_LENGTH;
 
-    // send the header
-    ret = this->send((void*)header, (int)nheader, MDI_INT, comm, 1);
-    if ( ret != 0 ) { return ret; }
+    // the basic header can only describe counts that fit in an int
+    if ( count > INT_MAX && ! ( this_comm->features & MDI_FEATURE_LARGE_COUNT ) ) {
+      mdi_error("Error in MDI_Send: count exceeds the limit supported by the connected code");
+      return 1;
+    }
 
-    free( header );
-  }
+    if ( unit_id != 0 ) {
+      header_type |= MDI_HEADER_UNITS;
+    }
 
-  // send the data
-  ret = this->send(buf, count, datatype, comm, 2);
-  if ( ret != 0 ) { return ret; }
+    header[0] = 0;           // error flag
+    header[1] = header_type; // header type
+    header[2] = datatype;    // datatype
+    header[3] = (int)( count & 0x7FFFFFFF );      // count (low bits)
+    header[4] = (int)( wire_bytes & 0x7FFFFFFF ); // size of an encoded body, in bytes (low bits)
+    header[5] = (int)( wire_bytes >> 31 );        // size of an encoded body, in bytes (high bits)
+    header[6] = (int)( count >> 31 );             // count (high bits)
+    header[7] = unit_id;     // unit of the body
+
+    // send the header
+    return this_comm->send((void*)header, nheader, MDI_INT, comm, 1);
+  }
 
   return 0;
 }
 
 
-/*! \brief Receive a message through the MDI connection
+/*! \brief Receive and validate the header of a message through the MDI connection
  *
- * If running with MPI, this function must be called only by rank \p 0.
+ * If no header is exchanged with the connected code, \p header_type and \p wire_bytes are set to \p 0.
  * The function returns \p 0 on a success.
  *
- * \param [in]       buf
- *                   Pointer to the buffer where the received data will be stored.
+ * \param [in]       this_comm
+ *                   Pointer to the communicator through which the message is received.
  * \param [in]       count
- *                   Number of values (integers, double precision floats, characters, etc.) to be received.
+ *                   Number of values expected in the body of the message.
  * \param [in]       datatype
- *                   MDI handle (MDI_INT, MDI_DOUBLE, MDI_CHAR, etc.) corresponding to the type of data to be received.
+ *                   MDI handle (MDI_INT, MDI_DOUBLE, MDI_CHAR, etc.) expected for the body of the message.
+ * \param [out]      header_type
+ *                   Header flags describing the encoding of the body.
+ * \param [out]      wire_bytes
+ *                   Size of an encoded body, in bytes.
+ * \param [out]      unit_id
+ *                   Identifier of the unit of the body, or \p 0 if the body is in atomic units.
  * \param [in]       comm
  *                   MDI communicator associated with the connection to the sending code.
  */
-int general_recv(void* buf, int count, MDI_Datatype datatype, MDI_Comm comm) {
-  int ret = 0;
-
-  communicator* this = get_communicator(current_code, comm);
+int general_recv_header(communicator* this_comm, size_t count, MDI_Datatype datatype,
+                        int* header_type, size_t* wire_bytes, int* unit_id, MDI_Comm comm) {
+  *header_type = 0;
+  *wire_bytes = 0;
+  *unit_id = 0;
 
-  // receive message header information
   // only do this if communicating with MDI version 1.1 or higher
-  if ( ( this->mdi_version[0] > 1 ||
-         ( this->mdi_version[0] == 1 && this->mdi_version[1] >= 1 ) )
-       && ipi_compatibility != 1 ) {
+  if ( ( this_comm->mdi_version[0] > 1 ||
+         ( this_comm->mdi_version[0] == 1 && this_comm->mdi_version[1] >= 1 ) )
+       && active_context->ipi_compatibility != 1 ) {
 
     // prepare buffer to hold header information
-    size_t nheader = 4;
-    int* header = (int*) malloc( nheader * sizeof(int) );
+    // the extended header is used if any optional features were negotiated
+    int header[MDI_HEADER_LENGTH_EXT];
+    size_t nheader = ( this_comm->features != 0 ) ? MDI_HEADER_LENGTH_EXT : MDI_HEADER_LENGTH;
 
     // initialize the header with the expected data
     // this is important when ranks other than 0 call this function
     header[0] = 0;
     header[1] = 0;
     header[2] = datatype;
-    header[3] = count;
+    header[3] = (int)( count & 0x7FFFFFFF );
+    header[4] = 0;
+    header[5] = 0;
+    header[6] = (int)( count >> 31 );
+    header[7] = 0;
 
     // receive the header
-    ret = this->recv((void*)header, (int)nheader, MDI_INT, comm, 1);
+    int ret = this_comm->recv((void*)header, nheader, MDI_INT, comm, 1);
     if ( ret != 0 ) { return ret; }
 
     // analyze the header information
     int error_flag = header[0];
-    int header_type = header[1];
+    *header_type = header[1];
     int send_datatype = header[2];
-    int send_count = header[3];
+    size_t send_count = (size_t)header[3];
+    if ( nheader == MDI_HEADER_LENGTH_EXT ) {
+      send_count |= (size_t)header[6] << 31;
+    }
+    *wire_bytes = (size_t)header[4] | ( (size_t)header[5] << 31 );
+    if ( header[1] & MDI_HEADER_UNITS ) {
+      *unit_id = header[7];
+    }
 
     // verify that the error flag is zero
     if ( error_flag != 0 ) {
@@ -547,10 +831,17 @@ int general_recv(void* buf, int count, MDI_Datatype datatype, MDI_Comm comm) {
       return error_flag;
     }
 
-    // verify that the header type is zero
-    if ( header_type != 0 ) {
+    // verify that the header type is supported
+    int type = *header_type;
+    if ( ( type & ~( MDI_HEADER_KEYFRAME | MDI_HEADER_ENCODED | MDI_HEADER_UNITS ) ) != 0 ||
+         ( ( type & ( MDI_HEADER_KEYFRAME | MDI_HEADER_DELTA ) ) &&
+           ! ( this_comm->features & MDI_FEATURE_DELTA ) ) ||
+         ( ( type & MDI_HEADER_COMPRESS ) && ! ( this_comm->features & MDI_FEATURE_COMPRESS ) ) ||
+         ( ( type & MDI_HEADER_FLOAT32 ) && ! ( this_comm->features & MDI_FEATURE_FLOAT32 ) ) ||
+         ( ( type & MDI_HEADER_BFLOAT16 ) && ! ( this_comm->features & MDI_FEATURE_BFLOAT16 ) ) ||
+         ( ( type & MDI_HEADER_UNITS ) && ! ( this_comm->features & MDI_FEATURE_UNITS ) ) ) {
       mdi_error("Error in MDI_Recv: unsupported header type");
-      return error_flag;
+      return 1;
     }
 
     // verify agreement regarding the datatype
@@ -564,118 +855,1066 @@ int general_recv(void* buf, int count, MDI_Datatype datatype, MDI_Comm comm) {
       mdi_error("Error in MDI_Recv: inconsistent count");
       return 1;
     }
-
-    free( header );
   }
 
-  // receive the data
-  ret = this->recv(buf, count, datatype, comm, 2);
-  if ( ret != 0 ) { return ret; }
-
   return 0;
 }
 
 
-/*! \brief Send a command of length \p MDI_COMMAND_LENGTH through the MDI connection
+/*! \brief Send a message, tagged with the unit of its body, through the MDI connection
  *
  * If running with MPI, this function must be called only by rank \p 0.
  * The function returns \p 0 on a success.
  *
  * \param [in]       buf
  *                   Pointer to the data to be sent.
+ * \param [in]       count
+ *                   Number of values (integers, double precision floats, characters, etc.) to be sent.
+ * \param [in]       datatype
+ *                   MDI handle (MDI_INT, MDI_DOUBLE, MDI_CHAR, etc.) corresponding to the type of data to be sent.
+ * \param [in]       unit_id
+ *                   Identifier of the unit of the data, or \p 0 if the data is in atomic units.
+ * \param [in]       filtered
+ *                   \p 1 if the data passes through the filter stages of the communicator, or \p 0 for a command.
  * \param [in]       comm
  *                   MDI communicator associated with the intended recipient code.
  */
-int general_send_command(const char* buf, MDI_Comm comm) {
-  // ensure that the driver is the current code
-  library_set_driver_current();
+static int general_send_tagged(const void* buf, size_t count, MDI_Datatype datatype, int unit_id,
+                               int filtered, MDI_Comm comm) {
+  int ret = 0;
 
-  communicator* this = get_communicator(current_code, comm);
-  int method = this->method;
+  communicator* this = get_communicator(active_context->current_code, comm);
 
-  int count = MDI_COMMAND_LENGTH;
-  char* command = malloc( MDI_COMMAND_LENGTH * sizeof(char) );
-  int ret;
+  // pass the data through the filter stages of this communicator
+  if ( filtered && this->nfilters > 0 ) {
+    ret = filter_send(this, &buf, count, datatype, comm);
+    if ( ret != 0 ) { return ret; }
+  }
 
-  snprintf(command, COMMAND_LENGTH, "%s", buf);
-  if ( method == MDI_LINK ) {
-    // set the command for the engine to execute
-    library_set_command(command, comm);
+  // encode the body of the message, if any codecs have been negotiated for this communicator
+  int header_type = 0;
+  void* wire_buf = (void*)buf;
+  size_t wire_bytes = 0;
+  ret = precision_encode(this, buf, count, datatype, &wire_buf, &wire_bytes, &header_type);
+  if ( ret != 0 ) { return ret; }
+  if ( header_type == 0 && delta_applies(this, count, datatype) ) {
+    ret = delta_encode(this, buf, count, datatype, &wire_buf, &wire_bytes, &header_type);
+    if ( ret != 0 ) { return ret; }
+  }
+  ret = compress_encode(this, buf, count, datatype, &wire_buf, &wire_bytes, &header_type);
+  if ( ret != 0 ) { return ret; }
 
-    if ( command[0] == '<' ) {
-      // execute the command, so that the data from the engine can be received later by the driver
-      ret = library_execute_command(comm);
-      if ( ret != 0 ) {
-	mdi_error("Error in MDI_Send_Command: Unable to execute receive command through library");
-	return ret;
-      }
-    }
-    else if ( command[0] == '>' ) {
-      // flag the command to be executed after the next call to MDI_Send
-      library_data* libd = (library_data*) this->method_data;
-      libd->execute_on_send = 1;
-    }
-    else if ( plugin_mode && ( strcmp( command, "EXIT" ) == 0 || command[0] == '@' ) ) {
-      // this command should be received by MDI_Recv_command, rather than through the execute_command callback
-      ret = general_send( command, count, MDI_CHAR, comm );
-      if ( ret != 0 ) {
-	mdi_error("Error in MDI_Send_Command: Unable to send command");
-	return ret;
-      }
-    }
-    else {
-      // this is a command that neither sends nor receives data, so execute it now
-      ret = library_execute_command(comm);
-      if ( ret != 0 ) {
-	mdi_error("Error in MDI_Send_Command: Unable to execute command through library");
-	return ret;
-      }
-    }
+  // send message header information
+  ret = general_send_header(this, count, datatype, header_type, wire_bytes, unit_id, comm);
+  if ( ret != 0 ) {
+    if ( wire_buf != buf ) { pool_free( wire_buf ); }
+    return ret;
+  }
+
+  // send the data
+  if ( wire_buf != buf ) {
+    ret = this->send(wire_buf, wire_bytes, MDI_BYTE, comm, 2);
+    pool_free( wire_buf );
   }
   else {
-    ret = general_send( command, count, MDI_CHAR, comm );
-    if ( ret != 0 ) {
-      mdi_error("Error in MDI_Send_Command: Unable to send command");
-      return ret;
-    }
+    ret = this->send(buf, count, datatype, comm, 2);
   }
+  if ( ret != 0 ) { return ret; }
 
-  // if the command was "EXIT", delete this communicator
-  // if running in plugin mode, the plugin system will delete the communicator instead
-  if ( ! plugin_mode && strcmp( command, "EXIT" ) == 0 ) {
-    delete_communicator(current_code, comm);
+  this->command_msg++;
+  return 0;
+}
 
-    // if MDI called MPI_Init, and there are no more communicators, call MPI_Finalize now
-    if ( initialized_mpi == 1 ) {
-      code* this_code = get_code(current_code);
-      if ( this_code->comms->size == 0 ) {
-	MPI_Finalize();
-      }
-    }
-  }
 
-  free( command );
-  return ret;
+/*! \brief Send a message through the MDI connection
+ *
+ * If running with MPI, this function must be called only by rank \p 0.
+ * The function returns \p 0 on a success.
+ *
+ * \param [in]       buf
+ *                   Pointer to the data to be sent.
+ * \param [in]       count
+ *                   Number of values (integers, double precision floats, characters, etc.) to be sent.
+ * \param [in]       datatype
+ *                   MDI handle (MDI_INT, MDI_DOUBLE, MDI_CHAR, etc.) corresponding to the type of data to be sent.
+ * \param [in]       comm
+ *                   MDI communicator associated with the intended recipient code.
+ */
+int general_send(const void* buf, size_t count, MDI_Datatype datatype, MDI_Comm comm) {
+  return general_send_tagged(buf, count, datatype, 0, 1, comm);
 }
 
 
-/*! \brief Respond to a general built-in command
+/*! \brief Send a message whose body is in a specified unit through the MDI connection
  *
+ * If the connected code supports unit tags, the data is sent as it is, together with the
+ * identifier of its unit, and is converted by the receiving code.
+ * Otherwise, the data is converted to atomic units before it is sent.
  * If running with MPI, this function must be called only by rank \p 0.
- * The function returns \p 1 if the command is a built-in command and \p 0 otherwise.
+ * The function returns \p 0 on a success.
  *
  * \param [in]       buf
- *                   Pointer to the buffer for the command name.
+ *                   Pointer to the data to be sent.
+ * \param [in]       count
+ *                   Number of values to be sent.
+ * \param [in]       datatype
+ *                   MDI handle (MDI_DOUBLE, MDI_FLOAT, or MDI_COMPLEX_DOUBLE) corresponding to the type of data to be sent.
+ * \param [in]       unit_id
+ *                   Identifier of the unit of the data.
  * \param [in]       comm
- *                   MDI communicator associated with the connection to the sending code.
+ *                   MDI communicator associated with the intended recipient code.
  */
-int general_builtin_command(const char* buf, MDI_Comm comm) {
+int general_send_units(const void* buf, size_t count, MDI_Datatype datatype, int unit_id, MDI_Comm comm) {
   int ret = 0;
 
-  // check if this command corresponds to one of MDI's standard built-in commands
-  if ( strcmp( buf, "<NAME" ) == 0 ) {
-    code* this_code = get_code(current_code);
-    MDI_Send(this_code->name, NAME_LENGTH, MDI_CHAR, comm);
+  communicator* this = get_communicator(active_context->current_code, comm);
+
+  if ( this->features & MDI_FEATURE_UNITS ) {
+    return general_send_tagged(buf, count, datatype, unit_id, 1, comm);
+  }
+
+  // the connected code expects atomic units
+  double factor = 1.0;
+  ret = units_factor(unit_id, NULL, &factor);
+  if ( ret != 0 ) { return ret; }
+  if ( factor == 1.0 ) {
+    return general_send_tagged(buf, count, datatype, 0, 1, comm);
+  }
+  size_t nbytes = count * datatype_size(datatype);
+  void* converted = pool_alloc( nbytes + 1 );
+  if ( converted == NULL ) {
+    mdi_error("Error in MDI_Send_units: unable to allocate conversion buffer");
+    return 1;
+  }
+  memcpy(converted, buf, nbytes);
+  ret = units_scale(converted, count, datatype, factor);
+  if ( ret == 0 ) {
+    ret = general_send_tagged(converted, count, datatype, 0, 1, comm);
+  }
+  pool_free( converted );
+  return ret;
+}
+
+
+/*! \brief Decode the body of a message that was encoded by one or more codecs
+ *
+ * The function returns \p 0 on a success.
+ *
+ * \param [in]       this_comm
+ *                   Pointer to the communicator through which the message was received.
+ * \param [in]       wire_buf
+ *                   Pointer to the body of the message, as it was received.
+ * \param [in]       wire_bytes
+ *                   Size of the body of the message, in bytes.
+ * \param [in]       header_type
+ *                   Header flags describing the encoding.
+ * \param [out]      buf
+ *                   Pointer to the buffer where the decoded data will be stored.
+ * \param [in]       count
+ *                   Number of values in the decoded message.
+ * \param [in]       datatype
+ *                   MDI handle (MDI_INT, MDI_DOUBLE, MDI_CHAR, etc.) of the decoded message.
+ */
+int general_decode_body(communicator* this_comm, void* wire_buf, size_t wire_bytes, int header_type,
+                        void* buf, size_t count, MDI_Datatype datatype) {
+  int ret = 0;
+  int encoded = header_type & ( MDI_HEADER_ENCODED & ~MDI_HEADER_COMPRESS );
+
+  // undo the compression
+  void* body = wire_buf;
+  size_t body_bytes = wire_bytes;
+  void* body_alloc = NULL;
+  if ( header_type & MDI_HEADER_COMPRESS ) {
+    ret = compress_decoded_size(wire_buf, wire_bytes, &body_bytes);
+    if ( ret != 0 ) { return ret; }
+
+    // the size comes from the peer, so reject any size that no codec could have produced
+    // before allocating for it: none of the codecs enlarges the body
+    if ( body_bytes > count * datatype_size(datatype) ) {
+      mdi_error("Error in MDI_Recv: compressed message is larger than the receive buffer");
+      return 1;
+    }
+    size_t elemsize = compress_elemsize(header_type, datatype);
+
+    // if the data was not otherwise encoded, decompress it directly into the receive buffer
+    if ( ! encoded ) {
+      return compress_decode(wire_buf, wire_bytes, buf, count * datatype_size(datatype), elemsize);
+    }
+
+    body_alloc = pool_alloc( body_bytes );
+    if ( body_alloc == NULL ) {
+      mdi_error("Error in MDI_Recv: unable to allocate decompression buffer");
+      return 1;
+    }
+    ret = compress_decode(wire_buf, wire_bytes, body_alloc, body_bytes, elemsize);
+    body = body_alloc;
+  }
+
+  // undo any other encoding
+  if ( ret == 0 ) {
+    if ( header_type & MDI_HEADER_DELTA ) {
+      ret = delta_decode(this_comm, body, body_bytes, buf, count, datatype);
+    }
+    else if ( header_type & ( MDI_HEADER_FLOAT32 | MDI_HEADER_BFLOAT16 ) ) {
+      ret = precision_decode(body, body_bytes, header_type, buf, count);
+    }
+  }
+
+  pool_free( body_alloc );
+  return ret;
+}
+
+
+/*! \brief Receive the body of a message whose header has already been received
+ *
+ * The function returns \p 0 on a success.
+ *
+ * \param [in]       this
+ *                   Pointer to the communicator through which the message is received.
+ * \param [out]      buf
+ *                   Pointer to the buffer where the decoded data will be stored.
+ * \param [in]       count
+ *                   Number of values in the decoded message.
+ * \param [in]       datatype
+ *                   MDI handle (MDI_INT, MDI_DOUBLE, MDI_CHAR, etc.) of the decoded message.
+ * \param [in]       header_type
+ *                   Header flags describing the encoding.
+ * \param [in]       wire_bytes
+ *                   Size of an encoded body, in bytes.
+ * \param [in]       unit_id
+ *                   Identifier of the unit of the body, or \p 0 if the body is in atomic units.
+ * \param [in]       to_unit
+ *                   Name of the unit in which the data is stored, or \p NULL for atomic units.
+ * \param [in]       comm
+ *                   MDI communicator associated with the connection to the sending code.
+ */
+static int general_recv_body(communicator* this, void* buf, size_t count, MDI_Datatype datatype,
+                             int header_type, size_t wire_bytes, int unit_id, const char* to_unit,
+                             MDI_Comm comm) {
+  int ret = 0;
+
+  // determine the factor that converts the body to the requested unit
+  // if the units are incompatible, the body is still received, so that the connection remains usable
+  double factor = 1.0;
+  int units_ret = 0;
+  if ( unit_id != 0 || to_unit != NULL ) {
+    units_ret = units_factor(unit_id, to_unit, &factor);
+    if ( units_ret != 0 ) {
+      factor = 1.0;
+    }
+  }
+
+  if ( header_type & MDI_HEADER_ENCODED ) {
+    void* wire_buf = pool_alloc( wire_bytes );
+    if ( wire_buf == NULL ) {
+      mdi_error("Error in MDI_Recv: unable to allocate receive buffer");
+      return 1;
+    }
+    ret = this->recv(wire_buf, wire_bytes, MDI_BYTE, comm, 2);
+    if ( ret == 0 ) {
+      ret = general_decode_body(this, wire_buf, wire_bytes, header_type, buf, count, datatype);
+    }
+    pool_free( wire_buf );
+  }
+  else if ( factor != 1.0 && this->partial_body && ! ( header_type & MDI_HEADER_KEYFRAME ) ) {
+    // convert each piece of the body as soon as it is received, while it is still in cache
+    size_t elemsize = datatype_size(datatype);
+    size_t chunk = MDI_UNITS_CHUNK_BYTES / elemsize;
+    size_t offset;
+    for ( offset = 0; offset < count; offset += chunk ) {
+      size_t n = ( count - offset < chunk ) ? count - offset : chunk;
+      void* piece = (char*)buf + offset * elemsize;
+      ret = this->recv(piece, n, datatype, comm, 2);
+      if ( ret != 0 ) { return ret; }
+      units_scale(piece, n, datatype, factor);
+    }
+    return 0;
+  }
+  else {
+    ret = this->recv(buf, count, datatype, comm, 2);
+  }
+  if ( ret == 0 && ( header_type & MDI_HEADER_KEYFRAME ) ) {
+    ret = delta_keyframe(this, buf, count, datatype, 1);
+  }
+
+  // the reference frame of the delta codec is kept in the units of the sender
+  if ( ret == 0 && factor != 1.0 ) {
+    ret = units_scale(buf, count, datatype, factor);
+  }
+  if ( ret == 0 ) {
+    ret = units_ret;
+  }
+  return ret;
+}
+
+
+/*! \brief Receive a message through the MDI connection
+ *
+ * If running with MPI, this function must be called only by rank \p 0.
+ * The function returns \p 0 on a success.
+ *
+ * \param [in]       buf
+ *                   Pointer to the buffer where the received data will be stored.
+ * \param [in]       count
+ *                   Number of values (integers, double precision floats, characters, etc.) to be received.
+ * \param [in]       datatype
+ *                   MDI handle (MDI_INT, MDI_DOUBLE, MDI_CHAR, etc.) corresponding to the type of data to be received.
+ * \param [in]       comm
+ *                   MDI communicator associated with the connection to the sending code.
+ */
+int general_recv(void* buf, size_t count, MDI_Datatype datatype, MDI_Comm comm) {
+  return general_recv_units(buf, count, datatype, NULL, comm);
+}
+
+
+/*! \brief Receive a message into a buffer in a specified unit through the MDI connection
+ *
+ * If running with MPI, this function must be called only by rank \p 0.
+ * The function returns \p 0 on a success.
+ *
+ * \param [in]       buf
+ *                   Pointer to the buffer where the received data will be stored.
+ * \param [in]       count
+ *                   Number of values to be received.
+ * \param [in]       datatype
+ *                   MDI handle (MDI_INT, MDI_DOUBLE, MDI_CHAR, etc.) corresponding to the type of data to be received.
+ * \param [in]       to_unit
+ *                   Name of the unit in which the data is stored, or \p NULL for atomic units.
+ * \param [in]       filtered
+ *                   \p 1 if the data passes through the filter stages of the communicator, or \p 0 for a command.
+ * \param [in]       comm
+ *                   MDI communicator associated with the connection to the sending code.
+ */
+static int general_recv_tagged(void* buf, size_t count, MDI_Datatype datatype, const char* to_unit,
+                               int filtered, MDI_Comm comm) {
+  int ret = 0;
+  int header_type = 0;
+  size_t wire_bytes = 0;
+  int unit_id = 0;
+
+  communicator* this = get_communicator(active_context->current_code, comm);
+
+  // receive message header information
+  ret = general_recv_header(this, count, datatype, &header_type, &wire_bytes, &unit_id, comm);
+  if ( ret != 0 ) { return ret; }
+
+  // receive the data
+  // the body has been taken off the wire even if it is then rejected, so the message is counted
+  // either way, to keep the count in step with the sender, which keys the delta frames on it
+  ret = general_recv_body(this, buf, count, datatype, header_type, wire_bytes, unit_id, to_unit, comm);
+  this->command_msg++;
+  if ( ret != 0 ) { return ret; }
+
+  // pass the data through the filter stages of this communicator
+  if ( filtered && this->nfilters > 0 ) {
+    ret = filter_recv(this, buf, count, datatype, comm);
+    if ( ret != 0 ) { return ret; }
+  }
+
+  return 0;
+}
+
+
+/*! \brief Receive a message into a buffer in a specified unit through the MDI connection
+ *
+ * The body of the message is converted from the unit it was tagged with, or from atomic units
+ * if it was not tagged, to the requested unit.
+ * If running with MPI, this function must be called only by rank \p 0.
+ * The function returns \p 0 on a success.
+ *
+ * \param [in]       buf
+ *                   Pointer to the buffer where the received data will be stored.
+ * \param [in]       count
+ *                   Number of values to be received.
+ * \param [in]       datatype
+ *                   MDI handle (MDI_INT, MDI_DOUBLE, MDI_CHAR, etc.) corresponding to the type of data to be received.
+ * \param [in]       to_unit
+ *                   Name of the unit in which the data is stored, or \p NULL for atomic units.
+ * \param [in]       comm
+ *                   MDI communicator associated with the connection to the sending code.
+ */
+int general_recv_units(void* buf, size_t count, MDI_Datatype datatype, const char* to_unit, MDI_Comm comm) {
+  return general_recv_tagged(buf, count, datatype, to_unit, 1, comm);
+}
+
+
+/*! \brief Send a message from a strided array through the MDI connection
+ *
+ * The body of the message is identical to the one sent by general_send for the
+ * contiguous array obtained by walking the elements of the strided array in order.
+ * If running with MPI, this function must be called only by rank \p 0.
+ * The function returns \p 0 on a success.
+ *
+ * \param [in]       buf
+ *                   Pointer to the first element of the array.
+ * \param [in]       desc
+ *                   Descriptor of the layout of the array.
+ * \param [in]       datatype
+ *                   MDI handle (MDI_INT, MDI_DOUBLE, MDI_CHAR, etc.) corresponding to the type of data to be sent.
+ * \param [in]       comm
+ *                   MDI communicator associated with the intended recipient code.
+ */
+int general_send_strided(const void* buf, const strided_desc* desc, MDI_Datatype datatype, MDI_Comm comm) {
+  int ret = 0;
+
+  // contiguous arrays are sent directly
+  if ( desc->nouter == 0 ) {
+    return general_send(buf, desc->count, datatype, comm);
+  }
+
+  communicator* this = get_communicator(active_context->current_code, comm);
+
+  // if the method cannot send directly from the array, if the body may need to be encoded,
+  // or if the body passes through filter stages, pack the array into a contiguous buffer
+  if ( this->send_strided == NULL || ( this->features & MDI_FEATURE_CODECS ) || this->nfilters > 0 ) {
+    void* packed = pool_alloc( desc->count * desc->elemsize );
+    if ( packed == NULL ) {
+      mdi_error("Error in MDI_Send_strided: unable to allocate packing buffer");
+      return 1;
+    }
+    strided_pack(desc, buf, 0, desc->nruns, packed);
+    ret = general_send(packed, desc->count, datatype, comm);
+    pool_free( packed );
+    return ret;
+  }
+
+  // send message header information
+  ret = general_send_header(this, desc->count, datatype, 0, 0, 0, comm);
+  if ( ret != 0 ) { return ret; }
+
+  // send the data
+  ret = this->send_strided(buf, desc, datatype, comm);
+  if ( ret != 0 ) { return ret; }
+
+  this->command_msg++;
+  return 0;
+}
+
+
+/*! \brief Receive a message into a strided array through the MDI connection
+ *
+ * If running with MPI, this function must be called only by rank \p 0.
+ * The function returns \p 0 on a success.
+ *
+ * \param [out]      buf
+ *                   Pointer to the first element of the array.
+ * \param [in]       desc
+ *                   Descriptor of the layout of the array.
+ * \param [in]       datatype
+ *                   MDI handle (MDI_INT, MDI_DOUBLE, MDI_CHAR, etc.) corresponding to the type of data to be received.
+ * \param [in]       comm
+ *                   MDI communicator associated with the connection to the sending code.
+ */
+int general_recv_strided(void* buf, const strided_desc* desc, MDI_Datatype datatype, MDI_Comm comm) {
+  int ret = 0;
+
+  // contiguous arrays are received directly
+  if ( desc->nouter == 0 ) {
+    return general_recv(buf, desc->count, datatype, comm);
+  }
+
+  communicator* this = get_communicator(active_context->current_code, comm);
+
+  // if the method cannot receive directly into the array, if the body may be encoded,
+  // or if the body passes through filter stages, receive into a contiguous buffer and unpack it
+  if ( this->recv_strided == NULL || ( this->features & MDI_FEATURE_CODECS ) || this->nfilters > 0 ) {
+    void* packed = pool_alloc( desc->count * desc->elemsize );
+    if ( packed == NULL ) {
+      mdi_error("Error in MDI_Recv_strided: unable to allocate packing buffer");
+      return 1;
+    }
+    ret = general_recv(packed, desc->count, datatype, comm);
+    if ( ret == 0 ) {
+      strided_unpack(desc, packed, 0, desc->nruns, buf);
+    }
+    pool_free( packed );
+    return ret;
+  }
+
+  // receive message header information
+  int header_type = 0;
+  size_t wire_bytes = 0;
+  int unit_id = 0;
+  ret = general_recv_header(this, desc->count, datatype, &header_type, &wire_bytes, &unit_id, comm);
+  if ( ret != 0 ) { return ret; }
+
+  // receive the data
+  ret = this->recv_strided(buf, desc, datatype, comm);
+  if ( ret != 0 ) { return ret; }
+  this->command_msg++;
+
+  // convert data that was sent in a unit other than atomic units
+  if ( unit_id != 0 ) {
+    double factor = 1.0;
+    ret = units_factor(unit_id, NULL, &factor);
+    if ( ret != 0 ) { return ret; }
+    size_t irun;
+    for ( irun = 0; ret == 0 && irun < desc->nruns && factor != 1.0; irun++ ) {
+      ret = units_scale((char*)buf + strided_run_offset(desc, irun), desc->run_bytes / desc->elemsize,
+                        datatype, factor);
+    }
+    if ( ret != 0 ) { return ret; }
+  }
+
+  return 0;
+}
+
+
+/*! \brief Free the copies of the filtered segments of a vectored message
+ *
+ * \param [in]       copies
+ *                   The copies.
+ * \param [in]       ncopies
+ *                   Number of copies.
+ */
+static void general_free_copies(void** copies, int ncopies) {
+  int icopy;
+  for ( icopy = 0; icopy < ncopies; icopy++ ) {
+    pool_free( copies[icopy] );
+  }
+}
+
+
+/*! \brief Send a vectored message, consisting of several segments, through the MDI connection
+ *
+ * If vectored messages were negotiated with the connected code, the segments are sent as a
+ * single message whose header is followed by a table describing each segment.
+ * Otherwise, each segment is sent as a separate message.
+ * If running with MPI, this function must be called only by rank \p 0.
+ * The function returns \p 0 on a success.
+ *
+ * \param [in]       nseg
+ *                   Number of segments in the message.
+ * \param [in]       bufs
+ *                   Pointer to the data of each segment.
+ * \param [in]       counts
+ *                   Number of values in each segment.
+ * \param [in]       datatypes
+ *                   MDI handle (MDI_INT, MDI_DOUBLE, MDI_CHAR, etc.) of each segment.
+ * \param [in]       comm
+ *                   MDI communicator associated with the intended recipient code.
+ */
+int general_sendv(int nseg, const void* const* bufs, const size_t* counts, const MDI_Datatype* datatypes,
+                  MDI_Comm comm) {
+  int ret = 0;
+  int iseg;
+  size_t nbytes[MDI_VECTOR_MAX_SEGMENTS];
+  size_t total_bytes = 0;
+
+  if ( nseg < 1 || nseg > MDI_VECTOR_MAX_SEGMENTS ) {
+    mdi_error("Error in MDI_Sendv: invalid number of segments");
+    return 1;
+  }
+  for ( iseg = 0; iseg < nseg; iseg++ ) {
+    size_t datasize = datatype_size(datatypes[iseg]);
+    if ( datasize == 0 ) {
+      mdi_error("Error in MDI_Sendv: MDI data type not recognized");
+      return 1;
+    }
+    nbytes[iseg] = counts[iseg] * datasize;
+    total_bytes += nbytes[iseg];
+  }
+
+  communicator* this = get_communicator(active_context->current_code, comm);
+
+  // pass each segment through the filter stages of this communicator before anything is sent,
+  // so that a rejected segment leaves the connection as it was, even if the segments are sent
+  // as separate messages
+  // a stage's output is only valid until the stage is next called, so each one is copied
+  const void* filtered[MDI_VECTOR_MAX_SEGMENTS];
+  void* copies[MDI_VECTOR_MAX_SEGMENTS];
+  int ncopies = 0;
+  if ( this->nfilters > 0 ) {
+    for ( iseg = 0; iseg < nseg; iseg++ ) {
+      filtered[iseg] = bufs[iseg];
+      ret = filter_send(this, &filtered[iseg], counts[iseg], datatypes[iseg], comm);
+      if ( ret == 0 && filtered[iseg] != bufs[iseg] ) {
+        copies[ncopies] = pool_alloc(nbytes[iseg]);
+        memcpy(copies[ncopies], filtered[iseg], nbytes[iseg]);
+        filtered[iseg] = copies[ncopies];
+        ncopies++;
+      }
+      if ( ret != 0 ) {
+        general_free_copies(copies, ncopies);
+        return ret;
+      }
+    }
+    bufs = filtered;
+  }
+
+  // if the connected code does not support vectored messages, send each segment separately
+  if ( ! ( this->features & MDI_FEATURE_VECTOR ) ) {
+    for ( iseg = 0; iseg < nseg && ret == 0; iseg++ ) {
+      ret = general_send_tagged(bufs[iseg], counts[iseg], datatypes[iseg], 0, 0, comm);
+    }
+    general_free_copies(copies, ncopies);
+    return ret;
+  }
+
+  // prepare the header, followed by the segment table
+  int header[MDI_HEADER_LENGTH_EXT + MDI_VECTOR_ENTRY_LENGTH * MDI_VECTOR_MAX_SEGMENTS];
+  size_t nheader = MDI_HEADER_LENGTH_EXT + MDI_VECTOR_ENTRY_LENGTH * (size_t)nseg;
+  header[0] = 0;                 // error flag
+  header[1] = MDI_HEADER_VECTOR; // header type
+  header[2] = MDI_BYTE;          // datatype
+  header[3] = (int)( total_bytes & 0x7FFFFFFF ); // size of the body, in bytes (low bits)
+  header[4] = 0;
+  header[5] = 0;
+  header[6] = (int)( total_bytes >> 31 );        // size of the body, in bytes (high bits)
+  header[7] = nseg;              // number of segments
+  for ( iseg = 0; iseg < nseg; iseg++ ) {
+    int* entry = &header[MDI_HEADER_LENGTH_EXT + MDI_VECTOR_ENTRY_LENGTH * iseg];
+    entry[0] = datatypes[iseg];
+    entry[1] = (int)( counts[iseg] & 0x7FFFFFFF );
+    entry[2] = (int)( counts[iseg] >> 31 );
+  }
+  ret = this->send((void*)header, nheader, MDI_INT, comm, 1);
+
+  // send the data
+  if ( ret == 0 && this->send_vector != NULL ) {
+    ret = this->send_vector(nseg, bufs, nbytes, comm);
+  }
+  else {
+    for ( iseg = 0; iseg < nseg && ret == 0; iseg++ ) {
+      ret = this->send(bufs[iseg], counts[iseg], datatypes[iseg], comm, 2);
+    }
+  }
+  general_free_copies(copies, ncopies);
+  if ( ret != 0 ) { return ret; }
+
+  this->command_msg++;
+  return 0;
+}
+
+
+/*! \brief Receive a vectored message, consisting of several segments, through the MDI connection
+ *
+ * The segments must agree in number, count, and datatype with those passed to the
+ * corresponding call to general_sendv.
+ * If running with MPI, this function must be called only by rank \p 0.
+ * The function returns \p 0 on a success.
+ *
+ * \param [in]       nseg
+ *                   Number of segments in the message.
+ * \param [out]      bufs
+ *                   Pointer to the buffer where each segment will be stored.
+ * \param [in]       counts
+ *                   Number of values in each segment.
+ * \param [in]       datatypes
+ *                   MDI handle (MDI_INT, MDI_DOUBLE, MDI_CHAR, etc.) of each segment.
+ * \param [in]       comm
+ *                   MDI communicator associated with the connection to the sending code.
+ */
+int general_recvv(int nseg, void* const* bufs, const size_t* counts, const MDI_Datatype* datatypes,
+                  MDI_Comm comm) {
+  int ret = 0;
+  int iseg;
+  size_t nbytes[MDI_VECTOR_MAX_SEGMENTS];
+  size_t total_bytes = 0;
+
+  if ( nseg < 1 || nseg > MDI_VECTOR_MAX_SEGMENTS ) {
+    mdi_error("Error in MDI_Recvv: invalid number of segments");
+    return 1;
+  }
+  for ( iseg = 0; iseg < nseg; iseg++ ) {
+    size_t datasize = datatype_size(datatypes[iseg]);
+    if ( datasize == 0 ) {
+      mdi_error("Error in MDI_Recvv: MDI data type not recognized");
+      return 1;
+    }
+    nbytes[iseg] = counts[iseg] * datasize;
+    total_bytes += nbytes[iseg];
+  }
+
+  communicator* this = get_communicator(active_context->current_code, comm);
+
+  // if the connected code does not support vectored messages, receive each segment separately
+  if ( ! ( this->features & MDI_FEATURE_VECTOR ) ) {
+    for ( iseg = 0; iseg < nseg; iseg++ ) {
+      ret = general_recv(bufs[iseg], counts[iseg], datatypes[iseg], comm);
+      if ( ret != 0 ) { return ret; }
+    }
+    return 0;
+  }
+
+  // initialize the header with the expected data
+  // this is important when ranks other than 0 call this function
+  int header[MDI_HEADER_LENGTH_EXT + MDI_VECTOR_ENTRY_LENGTH * MDI_VECTOR_MAX_SEGMENTS];
+  int expected[MDI_HEADER_LENGTH_EXT + MDI_VECTOR_ENTRY_LENGTH * MDI_VECTOR_MAX_SEGMENTS];
+  size_t nheader = MDI_HEADER_LENGTH_EXT + MDI_VECTOR_ENTRY_LENGTH * (size_t)nseg;
+  expected[0] = 0;
+  expected[1] = MDI_HEADER_VECTOR;
+  expected[2] = MDI_BYTE;
+  expected[3] = (int)( total_bytes & 0x7FFFFFFF );
+  expected[4] = 0;
+  expected[5] = 0;
+  expected[6] = (int)( total_bytes >> 31 );
+  expected[7] = nseg;
+  for ( iseg = 0; iseg < nseg; iseg++ ) {
+    int* entry = &expected[MDI_HEADER_LENGTH_EXT + MDI_VECTOR_ENTRY_LENGTH * iseg];
+    entry[0] = datatypes[iseg];
+    entry[1] = (int)( counts[iseg] & 0x7FFFFFFF );
+    entry[2] = (int)( counts[iseg] >> 31 );
+  }
+  memcpy(header, expected, nheader * sizeof(int));
+
+  // receive the header and the segment table
+  ret = this->recv((void*)header, nheader, MDI_INT, comm, 1);
+  if ( ret != 0 ) { return ret; }
+
+  // verify that the error flag is zero
+  if ( header[0] != 0 ) {
+    mdi_error("Error in MDI_Recvv: nonzero error flag received");
+    return header[0];
+  }
+
+  // verify that the message is a vectored message
+  if ( header[1] != MDI_HEADER_VECTOR ) {
+    mdi_error("Error in MDI_Recvv: message was not sent by MDI_Sendv");
+    return 1;
+  }
+
+  // verify agreement regarding the segments
+  if ( memcmp(header, expected, nheader * sizeof(int)) != 0 ) {
+    mdi_error("Error in MDI_Recvv: inconsistent segments");
+    return 1;
+  }
+
+  // receive the data
+  if ( this->recv_vector != NULL ) {
+    ret = this->recv_vector(nseg, bufs, nbytes, comm);
+    if ( ret != 0 ) { return ret; }
+  }
+  else {
+    for ( iseg = 0; iseg < nseg; iseg++ ) {
+      ret = this->recv(bufs[iseg], counts[iseg], datatypes[iseg], comm, 2);
+      if ( ret != 0 ) { return ret; }
+    }
+  }
+  this->command_msg++;
+
+  // pass each segment through the filter stages of this communicator
+  for ( iseg = 0; iseg < nseg && this->nfilters > 0; iseg++ ) {
+    ret = filter_recv(this, bufs[iseg], counts[iseg], datatypes[iseg], comm);
+    if ( ret != 0 ) { return ret; }
+  }
+
+  return 0;
+}
+
+
+/*! \brief Send a message whose body is produced in chunks by a callback
+ *
+ * The producer is called once for each chunk of the body, and fills a buffer of at most
+ * \p chunk_size elements.
+ * If the method can transfer the body of a message in pieces, each chunk is sent as soon as
+ * it is produced, and the body is sent without any encoding, so that only a single chunk is
+ * held in memory.
+ * Otherwise, the chunks are gathered into a contiguous buffer that is sent by general_send.
+ * If running with MPI, this function must be called only by rank \p 0.
+ * The function returns \p 0 on a success.
+ *
+ * \param [in]       count
+ *                   Number of values (integers, double precision floats, characters, etc.) to be sent.
+ * \param [in]       datatype
+ *                   MDI handle (MDI_INT, MDI_DOUBLE, MDI_CHAR, etc.) corresponding to the type of data to be sent.
+ * \param [in]       chunk_size
+ *                   Largest number of values passed to a single call of the producer.
+ * \param [in]       producer
+ *                   Function that fills each chunk of the body.
+ * \param [in]       ctx
+ *                   Pointer passed to each call of the producer.
+ * \param [in]       comm
+ *                   MDI communicator associated with the intended recipient code.
+ */
+int general_send_stream(size_t count, MDI_Datatype datatype, size_t chunk_size,
+                        MDI_Stream_callback_t producer, void* ctx, MDI_Comm comm) {
+  int ret = 0;
+
+  communicator* this = get_communicator(active_context->current_code, comm);
+
+  size_t elemsize = datatype_size(datatype);
+  if ( elemsize == 0 ) {
+    mdi_error("MDI data type not recognized in MDI_Send_stream");
+    return 1;
+  }
+  if ( chunk_size > count ) {
+    chunk_size = count;
+  }
+
+  // if the body cannot be sent in pieces, or if it passes through filter stages,
+  // gather it into a contiguous buffer
+  if ( ! this->partial_body || this->nfilters > 0 ) {
+    char* full = pool_alloc( count * elemsize + 1 );
+    if ( full == NULL ) {
+      mdi_error("Error in MDI_Send_stream: unable to allocate send buffer");
+      return 1;
+    }
+    size_t offset;
+    for ( offset = 0; offset < count; offset += chunk_size ) {
+      size_t n = ( count - offset < chunk_size ) ? count - offset : chunk_size;
+      ret = producer(full + offset * elemsize, (int64_t)offset, (int64_t)n, ctx);
+      if ( ret != 0 ) {
+        mdi_error("Error in MDI_Send_stream: producer callback failed");
+        pool_free( full );
+        return ret;
+      }
+    }
+    ret = general_send(full, count, datatype, comm);
+    pool_free( full );
+    return ret;
+  }
+
+  // send message header information
+  ret = general_send_header(this, count, datatype, 0, 0, 0, comm);
+  if ( ret != 0 ) { return ret; }
+
+  // produce and send each chunk of the body
+  void* chunk = pool_alloc( chunk_size * elemsize + 1 );
+  if ( chunk == NULL ) {
+    mdi_error("Error in MDI_Send_stream: unable to allocate chunk buffer");
+    return 1;
+  }
+  size_t offset;
+  for ( offset = 0; offset < count; offset += chunk_size ) {
+    size_t n = ( count - offset < chunk_size ) ? count - offset : chunk_size;
+    ret = producer(chunk, (int64_t)offset, (int64_t)n, ctx);
+    if ( ret != 0 ) {
+      mdi_error("Error in MDI_Send_stream: producer callback failed");
+      break;
+    }
+    ret = this->send(chunk, n, datatype, comm, 2);
+    if ( ret != 0 ) { break; }
+  }
+  pool_free( chunk );
+  if ( ret != 0 ) { return ret; }
+
+  this->command_msg++;
+  return 0;
+}
+
+
+/*! \brief Receive a message whose body is delivered in chunks to a callback
+ *
+ * The consumer is called once for each chunk of the body, with a buffer of at most
+ * \p chunk_size elements.
+ * If the method can transfer the body of a message in pieces and the body was not encoded,
+ * each chunk is delivered as soon as it is received, so that only a single chunk is held in
+ * memory.
+ * Otherwise, the complete body is received and decoded before it is delivered.
+ * If running with MPI, this function must be called only by rank \p 0.
+ * The function returns \p 0 on a success.
+ *
+ * \param [in]       count
+ *                   Number of values (integers, double precision floats, characters, etc.) to be received.
+ * \param [in]       datatype
+ *                   MDI handle (MDI_INT, MDI_DOUBLE, MDI_CHAR, etc.) corresponding to the type of data to be received.
+ * \param [in]       chunk_size
+ *                   Largest number of values passed to a single call of the consumer.
+ * \param [in]       consumer
+ *                   Function that processes each chunk of the body.
+ * \param [in]       ctx
+ *                   Pointer passed to each call of the consumer.
+ * \param [in]       comm
+ *                   MDI communicator associated with the connection to the sending code.
+ */
+int general_recv_stream(size_t count, MDI_Datatype datatype, size_t chunk_size,
+                        MDI_Stream_callback_t consumer, void* ctx, MDI_Comm comm) {
+  int ret = 0;
+  int header_type = 0;
+  size_t wire_bytes = 0;
+  int unit_id = 0;
+
+  communicator* this = get_communicator(active_context->current_code, comm);
+
+  size_t elemsize = datatype_size(datatype);
+  if ( elemsize == 0 ) {
+    mdi_error("MDI data type not recognized in MDI_Recv_stream");
+    return 1;
+  }
+  if ( chunk_size > count ) {
+    chunk_size = count;
+  }
+
+  // receive message header information
+  if ( this->partial_body ) {
+    ret = general_recv_header(this, count, datatype, &header_type, &wire_bytes, &unit_id, comm);
+    if ( ret != 0 ) { return ret; }
+  }
+
+  // if the body cannot be received in pieces, or if it passes through filter stages,
+  // receive it into a contiguous buffer
+  if ( ! this->partial_body || ( header_type & ~MDI_HEADER_UNITS ) != 0 || this->nfilters > 0 ) {
+    char* full = pool_alloc( count * elemsize + 1 );
+    if ( full == NULL ) {
+      mdi_error("Error in MDI_Recv_stream: unable to allocate receive buffer");
+      return 1;
+    }
+    if ( this->partial_body ) {
+      ret = general_recv_body(this, full, count, datatype, header_type, wire_bytes, unit_id, NULL, comm);
+      this->command_msg++;
+      if ( ret == 0 && this->nfilters > 0 ) {
+        ret = filter_recv(this, full, count, datatype, comm);
+      }
+    }
+    else {
+      ret = general_recv(full, count, datatype, comm);
+    }
+    size_t offset;
+    for ( offset = 0; ret == 0 && offset < count; offset += chunk_size ) {
+      size_t n = ( count - offset < chunk_size ) ? count - offset : chunk_size;
+      ret = consumer(full + offset * elemsize, (int64_t)offset, (int64_t)n, ctx);
+      if ( ret != 0 ) {
+        mdi_error("Error in MDI_Recv_stream: consumer callback failed");
+      }
+    }
+    pool_free( full );
+    return ret;
+  }
+
+  // convert data that was sent in a unit other than atomic units
+  double factor = 1.0;
+  if ( unit_id != 0 ) {
+    ret = units_factor(unit_id, NULL, &factor);
+    if ( ret != 0 ) { return ret; }
+  }
+
+  // receive and deliver each chunk of the body
+  void* chunk = pool_alloc( chunk_size * elemsize + 1 );
+  if ( chunk == NULL ) {
+    mdi_error("Error in MDI_Recv_stream: unable to allocate chunk buffer");
+    return 1;
+  }
+  size_t offset;
+  for ( offset = 0; offset < count; offset += chunk_size ) {
+    size_t n = ( count - offset < chunk_size ) ? count - offset : chunk_size;
+    ret = this->recv(chunk, n, datatype, comm, 2);
+    if ( ret == 0 && factor != 1.0 ) {
+      ret = units_scale(chunk, n, datatype, factor);
+    }
+    if ( ret != 0 ) { break; }
+    ret = consumer(chunk, (int64_t)offset, (int64_t)n, ctx);
+    if ( ret != 0 ) {
+      mdi_error("Error in MDI_Recv_stream: consumer callback failed");
+      break;
+    }
+  }
+  pool_free( chunk );
+  if ( ret != 0 ) { return ret; }
+
+  this->command_msg++;
+  return 0;
+}
+
+
+/*! \brief Send a command of length \p MDI_COMMAND_LENGTH through the MDI connection
+ *
+ * If running with MPI, this function must be called only by rank \p 0.
+ * The function returns \p 0 on a success.
+ *
+ * \param [in]       buf
+ *                   Pointer to the data to be sent.
+ * \param [in]       comm
+ *                   MDI communicator associated with the intended recipient code.
+ */
+int general_send_command(const char* buf, MDI_Comm comm) {
+  // ensure that the driver is the current code
+  library_set_driver_current();
+
+  communicator* this = get_communicator(active_context->current_code, comm);
+  int method = this->method;
+
+  int count = MDI_COMMAND_LENGTH;
+  char command[COMMAND_LENGTH];
+  int ret;
+
+  snprintf(command, COMMAND_LENGTH, "%s", buf);
+  if ( method == MDI_LINK ) {
+    // set the command for the engine to execute
+    library_set_command(command, comm);
+
+    if ( command[0] == '<' ) {
+      // execute the command, so that the data from the engine can be received later by the driver
+      ret = library_execute_command(comm);
+      if ( ret != 0 ) {
+	mdi_error("Error in MDI_Send_Command: Unable to execute receive command through library");
+	return ret;
+      }
+    }
+    else if ( command[0] == '>' ) {
+      // flag the command to be executed after the next call to MDI_Send
+      library_data* libd = (library_data*) this->method_data;
+      libd->execute_on_send = 1;
+    }
+    else if ( active_context->plugin_resident && strcmp( command, "EXIT" ) == 0 ) {
+      // the engine of a resident plugin persists until the plugin is unloaded
+      ret = 0;
+    }
+    else if ( active_context->plugin_mode && ! active_context->plugin_resident &&
+              ( strcmp( command, "EXIT" ) == 0 || command[0] == '@' ) ) {
+      // this command should be received by MDI_Recv_command, rather than through the execute_command callback
+      ret = general_send_tagged( command, count, MDI_CHAR, 0, 0, comm );
+      if ( ret != 0 ) {
+	mdi_error("Error in MDI_Send_Command: Unable to send command");
+	return ret;
+      }
+    }
+    else {
+      // this is a command that neither sends nor receives data, so execute it now
+      ret = library_execute_command(comm);
+      if ( ret != 0 ) {
+	mdi_error("Error in MDI_Send_Command: Unable to execute command through library");
+	return ret;
+      }
+    }
+  }
+  else {
+    ret = general_send_tagged( command, count, MDI_CHAR, 0, 0, comm );
+    if ( ret != 0 ) {
+      mdi_error("Error in MDI_Send_Command: Unable to send command");
+      return ret;
+    }
+  }
+
+  // record the command, so that the messages that follow it can be associated with it
+  snprintf(this->command, COMMAND_LENGTH, "%s", command);
+  this->command_msg = 0;
+
+  // if the command was "EXIT", delete this communicator
+  // if running in plugin mode, the plugin system will delete the communicator instead
+  if ( ! active_context->plugin_mode && strcmp( command, "EXIT" ) == 0 ) {
+    delete_communicator(active_context->current_code, comm);
+
+    // if MDI called MPI_Init, and there are no more communicators, call MPI_Finalize now
+    if ( initialized_mpi == 1 ) {
+      code* this_code = get_code(active_context->current_code);
+      if ( this_code->comms->size == 0 ) {
+	MPI_Finalize();
+      }
+    }
+  }
+
+  return ret;
+}
+
+
+/*! \brief Respond to a general built-in command
+ *
+ * If running with MPI, this function must be called only by rank \p 0.
+ * The function returns \p 1 if the command is a built-in command and \p 0 otherwise.
+ *
+ * \param [in]       buf
+ *                   Pointer to the buffer for the command name.
+ * \param [in]       comm
+ *                   MDI communicator associated with the connection to the sending code.
+ */
+int general_builtin_command(const char* buf, MDI_Comm comm) {
+  int ret = 0;
+
+  // check if this command corresponds to one of MDI's standard built-in commands
+  if ( strcmp( buf, "<NAME" ) == 0 ) {
+    code* this_code = get_code(active_context->current_code);
+    MDI_Send(this_code->name, NAME_LENGTH, MDI_CHAR, comm);
     ret = 1;
   }
   else if ( strcmp( buf, "<VERSION" ) == 0 ) {
@@ -710,9 +1949,15 @@ int general_builtin_command(const char* buf, MDI_Comm comm) {
     send_nnodes(comm);
     ret = 1;
   }
+  else if ( strcmp( buf, "<REGKEY" ) == 0 ) {
+    send_registry_key(comm);
+    ret = 1;
+  }
   else if ( strcmp( buf, "EXIT" ) == 0 ) {
     // if the MDI Library called MPI_Init, call MPI_Finalize now
-    if ( initialized_mpi == 1 ) {
+    // a persistent engine keeps MPI, since it will serve another driver
+    code* this_code = get_code(active_context->current_code);
+    if ( initialized_mpi == 1 && ! this_code->persistent ) {
       MPI_Finalize();
     }
   }
@@ -732,13 +1977,13 @@ int general_builtin_command(const char* buf, MDI_Comm comm) {
  */
 int general_recv_command(char* buf, MDI_Comm comm) {
   int ret;
-  code* this_code = get_code(current_code);
-  communicator* this = get_communicator(current_code, comm);
+  code* this_code = get_code(active_context->current_code);
+  communicator* this = get_communicator(active_context->current_code, comm);
 
   // if this is a linked library, call the driver's node callback
   if ( this->method == MDI_LINK ) {
-    int iengine = current_code;
-    communicator* engine_comm = get_communicator(current_code, comm);
+    int iengine = active_context->current_code;
+    communicator* engine_comm = get_communicator(active_context->current_code, comm);
 
     // get the driver code to which this communicator connects
     library_data* libd = (library_data*) engine_comm->method_data;
@@ -750,13 +1995,14 @@ int general_recv_command(char* buf, MDI_Comm comm) {
     library_data* driver_lib = (library_data*) driver_comm->method_data;
 
     // set the current code to the driver
-    current_code = idriver;
+    active_context->current_code = idriver;
 
     void* class_obj = driver_lib->driver_callback_obj;
-    ret = driver_lib->driver_node_callback(&driver_lib->mpi_comm, driver_comm_handle, class_obj);
+    driver_lib->driver_node_ret = driver_lib->driver_node_callback(&driver_lib->mpi_comm, driver_comm_handle,
+                                                                   class_obj);
 
     // set the current code to the engine
-    current_code = iengine;
+    active_context->current_code = iengine;
 
     //return 0;
   }
@@ -768,12 +2014,16 @@ int general_recv_command(char* buf, MDI_Comm comm) {
   int count = MDI_COMMAND_LENGTH;
   int datatype = MDI_CHAR;
 
-  ret = general_recv( buf, count, datatype, comm );
+  ret = general_recv_tagged( buf, count, datatype, NULL, 0, comm );
   if ( ret != 0 ) {
     mdi_error("Error in MDI_Recv_Command: Unable to receive command");
     return ret;
   }
 
+  // record the command, so that the messages that follow it can be associated with it
+  snprintf(this->command, COMMAND_LENGTH, "%s", buf);
+  this->command_msg = 0;
+
   // check if this command corresponds to one of MDI's standard built-in commands
   int builtin_flag = general_builtin_command(buf, comm);
   if ( builtin_flag == 1 ) {
@@ -792,12 +2042,12 @@ int general_recv_command(char* buf, MDI_Comm comm) {
  *
  * The function returns \p 0 on a success.
  *
- * \param [in]       node_vec
- *                   Vector of nodes, into which the new node will be added.
+ * \param [in]       node_reg
+ *                   Registry of nodes, into which the new node will be added.
  * \param [in]       node_name
  *                   Name of the node.
  */
-int register_node(vector* node_vec, const char* node_name)
+int register_node(registry* node_reg, const char* node_name)
 {
   // confirm that the node_name size is not greater than MDI_COMMAND_LENGTH
   if ( strlen(node_name) > COMMAND_LENGTH ) {
@@ -806,21 +2056,22 @@ int register_node(vector* node_vec, const char* node_name)
   }
 
   // confirm that this node is not already registered
-  int node_index = get_node_index(node_vec, node_name);
+  int node_index = get_node_index(node_reg, node_name);
   if ( node_index != -1 ) {
     mdi_error("This node is already registered"); 
     return 1;
   }
 
   node new_node;
-  vector* command_vec = malloc(sizeof(vector));
-  vector* callback_vec = malloc(sizeof(vector));
-  vector_init(command_vec, sizeof(char[COMMAND_LENGTH]));
-  vector_init(callback_vec, sizeof(char[COMMAND_LENGTH]));
-  new_node.commands = command_vec;
-  new_node.callbacks = callback_vec;
+  registry* command_reg = malloc(sizeof(registry));
+  registry* callback_reg = malloc(sizeof(registry));
+  registry_init(command_reg, sizeof(char[COMMAND_LENGTH]));
+  registry_init(callback_reg, sizeof(char[COMMAND_LENGTH]));
+  new_node.commands = command_reg;
+  new_node.callbacks = callback_reg;
+  new_node.handlers = NULL;
   snprintf(new_node.name, COMMAND_LENGTH, "%s", node_name);
-  vector_push_back(node_vec, &new_node);
+  registry_add(node_reg, &new_node);
   return 0;
 }
 
@@ -829,14 +2080,14 @@ int register_node(vector* node_vec, const char* node_name)
  *
  * The function returns \p 0 on a success.
  *
- * \param [in]       node_vec
- *                   Vector of nodes, into which the new node will be added.
+ * \param [in]       node_reg
+ *                   Registry of nodes, into which the new node will be added.
  * \param [in]       node_name
  *                   Name of the node on which the command will be registered.
  * \param [in]       command_name
  *                   Name of the command.
  */
-int register_command(vector* node_vec, const char* node_name, const char* command_name)
+int register_command(registry* node_reg, const char* node_name, const char* command_name)
 {
   // confirm that the node_name size is not greater than MDI_COMMAND_LENGTH
   if ( strlen(node_name) > COMMAND_LENGTH ) {
@@ -851,12 +2102,12 @@ int register_command(vector* node_vec, const char* node_name, const char* comman
   }
 
   // find the node
-  int node_index = get_node_index(node_vec, node_name);
+  int node_index = get_node_index(node_reg, node_name);
   if ( node_index == -1 ) {
     mdi_error("Attempting to register a command on an unregistered node");
     return 1;
   }
-  node* target_node = vector_get(node_vec, node_index);
+  node* target_node = registry_get(node_reg, node_index);
 
   // confirm that this command is not already registered
   int command_index = get_command_index(target_node, command_name);
@@ -868,7 +2119,7 @@ int register_command(vector* node_vec, const char* node_name, const char* comman
   // register this command
   char new_command[COMMAND_LENGTH];
   snprintf(new_command, COMMAND_LENGTH, "%s", command_name);
-  vector_push_back( target_node->commands, &new_command );
+  registry_add( target_node->commands, &new_command );
 
   return 0;
 }
@@ -878,14 +2129,14 @@ int register_command(vector* node_vec, const char* node_name, const char* comman
  *
  * The function returns \p 0 on a success.
  *
- * \param [in]       node_vec
- *                   Vector of nodes, into which the new node will be added.
+ * \param [in]       node_reg
+ *                   Registry of nodes, into which the new node will be added.
  * \param [in]       node_name
  *                   Name of the node on which the callback will be registered.
  * \param [in]       callback_name
  *                   Name of the callback.
  */
-int register_callback(vector* node_vec, const char* node_name, const char* callback_name)
+int register_callback(registry* node_reg, const char* node_name, const char* callback_name)
 {
   // confirm that the node_name size is not greater than MDI_COMMAND_LENGTH
   if ( strlen(node_name) > COMMAND_LENGTH ) {
@@ -900,12 +2151,12 @@ int register_callback(vector* node_vec, const char* node_name, const char* callb
   }
 
   // find the node
-  int node_index = get_node_index(node_vec, node_name);
+  int node_index = get_node_index(node_reg, node_name);
   if ( node_index == -1 ) {
     mdi_error("Attempting to register a callback on an unregistered node");
     return 1;
   }
-  node* target_node = vector_get(node_vec, node_index);
+  node* target_node = registry_get(node_reg, node_index);
 
   // confirm that this callback is not already registered
   int callback_index = get_callback_index(target_node, callback_name);
@@ -917,12 +2168,159 @@ int register_callback(vector* node_vec, const char* node_name, const char* callb
   // register this callback
   char new_callback[COMMAND_LENGTH];
   snprintf(new_callback, COMMAND_LENGTH, "%s", callback_name);
-  vector_push_back( target_node->callbacks, &new_callback );
+  registry_add( target_node->callbacks, &new_callback );
+
+  return 0;
+}
+
+
+/*! \brief Form one of the lists that describe the registry of a code
+ *
+ * Each name in the list is padded with spaces to MDI_COMMAND_LENGTH characters and followed by
+ * a delimiter.
+ * In the lists of commands and callbacks, the name of each node is followed by the names of its
+ * commands or callbacks, and the last name associated with each node is delimited by a semicolon.
+ * The function returns \p 0 on a success.
+ *
+ * \param [in]       this_code
+ *                   The code whose registry is described.
+ * \param [in]       list_type
+ *                   MDI_LIST_COMMANDS, MDI_LIST_CALLBACKS, or MDI_LIST_NODES.
+ * \param [out]      list
+ *                   The list, whose data is allocated by this function.
+ */
+static int form_name_list(code* this_code, int list_type, name_list* list) {
+  int nnodes = (int)this_code->nodes->entries.size;
+  int inode, iname;
+  int stride = MDI_COMMAND_LENGTH + 1;
+
+  // determine the number of commands or callbacks
+  list->nnames = 0;
+  if ( list_type != MDI_LIST_NODES ) {
+    for (inode = 0; inode < nnodes; inode++) {
+      node* this_node = registry_get(this_code->nodes, inode);
+      registry* names = ( list_type == MDI_LIST_COMMANDS ) ? this_node->commands : this_node->callbacks;
+      list->nnames += (int)names->entries.size;
+    }
+  }
+
+  // allocate memory for the list
+  list->count = ( list->nnames + nnodes ) * stride;
+  list->data = malloc( ( list->count + 1 ) * sizeof(char) );
+  memset( list->data, ' ', list->count );
+
+  // form the list
+  int islot = 0;
+  for (inode = 0; inode < nnodes; inode++) {
+    // add the name of this node to the list
+    node* this_node = registry_get(this_code->nodes, inode);
+    char* entry = &list->data[ islot * stride ];
+    memcpy( entry, this_node->name, strlen(this_node->name) );
+    islot++;
+    if ( list_type == MDI_LIST_NODES ) {
+      entry[stride - 1] = ',';
+      continue;
+    }
+    registry* names = ( list_type == MDI_LIST_COMMANDS ) ? this_node->commands : this_node->callbacks;
+    int nnames = (int)names->entries.size;
+    entry[stride - 1] = ( nnames > 0 ) ? ',' : ';';
+
+    // add the commands or callbacks for this node
+    for (iname = 0; iname < nnames; iname++) {
+      char* name = registry_get(names, iname);
+      entry = &list->data[ islot * stride ];
+      memcpy( entry, name, strlen(name) );
+      entry[stride - 1] = ( iname == nnames - 1 ) ? ';' : ',';
+      islot++;
+    }
+  }
+  list->data[ list->count ] = '\0';
 
   return 0;
 }
 
 
+/*! \brief Return one of the frozen lists that describe the registry of a code, forming it if necessary
+ *
+ * \param [in]       this_code
+ *                   The code whose registry is described, which must have called MDI_Freeze_Registry().
+ * \param [in]       list_type
+ *                   MDI_LIST_COMMANDS, MDI_LIST_CALLBACKS, or MDI_LIST_NODES.
+ */
+static name_list* get_frozen_list(code* this_code, int list_type) {
+  name_list* list = &this_code->frozen_lists[list_type];
+  if ( list->data == NULL ) {
+    form_name_list(this_code, list_type, list);
+  }
+  return list;
+}
+
+
+/*! \brief Send one of the lists that describe the registry of the current code
+ *
+ * If running with MPI, this function must be called only by rank \p 0.
+ * The function returns \p 0 on a success.
+ *
+ * \param [in]       list_type
+ *                   MDI_LIST_COMMANDS, MDI_LIST_CALLBACKS, or MDI_LIST_NODES.
+ * \param [in]       comm
+ *                   MDI communicator associated with the intended recipient code.
+ */
+static int send_name_list(int list_type, MDI_Comm comm) {
+  code* this_code = get_code(active_context->current_code);
+  if ( this_code->intra_rank != 0 ) {
+    mdi_error("Attempting to send registry information from the incorrect rank");
+    return 1;
+  }
+
+  // if the registry is frozen, the list is formed only once
+  if ( this_code->registry_frozen ) {
+    name_list* list = get_frozen_list(this_code, list_type);
+    return general_send( list->data, list->count, MDI_CHAR, comm );
+  }
+
+  name_list list;
+  form_name_list(this_code, list_type, &list);
+  int ret = general_send( list.data, list.count, MDI_CHAR, comm );
+  free( list.data );
+  return ret;
+}
+
+
+/*! \brief Send the number of commands or callbacks of the current code
+ *
+ * If running with MPI, this function must be called only by rank \p 0.
+ * The function returns \p 0 on a success.
+ *
+ * \param [in]       list_type
+ *                   MDI_LIST_COMMANDS or MDI_LIST_CALLBACKS.
+ * \param [in]       comm
+ *                   MDI communicator associated with the intended recipient code.
+ */
+static int send_name_count(int list_type, MDI_Comm comm) {
+  code* this_code = get_code(active_context->current_code);
+  if ( this_code->intra_rank != 0 ) {
+    mdi_error("Attempting to send registry information from the incorrect rank");
+    return 1;
+  }
+
+  int nnames = 0;
+  if ( this_code->registry_frozen ) {
+    nnames = get_frozen_list(this_code, list_type)->nnames;
+  }
+  else {
+    int inode;
+    for (inode = 0; inode < (int)this_code->nodes->entries.size; inode++) {
+      node* this_node = registry_get(this_code->nodes, inode);
+      registry* names = ( list_type == MDI_LIST_COMMANDS ) ? this_node->commands : this_node->callbacks;
+      nnames += (int)names->entries.size;
+    }
+  }
+
+  return general_send( &nnames, 1, MDI_INT, comm );
+}
+
+
 /*! \brief Send the list of supported commands
  *
  * If running with MPI, this function must be called only by rank \p 0.
@@ -932,478 +2330,622 @@ int register_callback(vector* node_vec, const char* node_name, const char* callb
  *                   MDI communicator associated with the intended recipient code.
  */
 int send_command_list(MDI_Comm comm) {
-  code* this_code = get_code(current_code);
+  return send_name_list(MDI_LIST_COMMANDS, comm);
+}
+
+
+/*! \brief Send the list of callbacks
+ *
+ * If running with MPI, this function must be called only by rank \p 0.
+ * The function returns \p 0 on a success.
+ *
+ * \param [in]       comm
+ *                   MDI communicator associated with the intended recipient code.
+ */
+int send_callback_list(MDI_Comm comm) {
+  return send_name_list(MDI_LIST_CALLBACKS, comm);
+}
+
+
+/*! \brief Send the list of nodes
+ *
+ * If running with MPI, this function must be called only by rank \p 0.
+ * The function returns \p 0 on a success.
+ *
+ * \param [in]       comm
+ *                   MDI communicator associated with the intended recipient code.
+ */
+int send_node_list(MDI_Comm comm) {
+  return send_name_list(MDI_LIST_NODES, comm);
+}
+
+
+/*! \brief Send the number of supported commands
+ *
+ * If running with MPI, this function must be called only by rank \p 0.
+ * The function returns \p 0 on a success.
+ *
+ * \param [in]       comm
+ *                   MDI communicator associated with the intended recipient code.
+ */
+int send_ncommands(MDI_Comm comm) {
+  return send_name_count(MDI_LIST_COMMANDS, comm);
+}
+
+
+/*! \brief Send the number of supported callbacks
+ *
+ * If running with MPI, this function must be called only by rank \p 0.
+ * The function returns \p 0 on a success.
+ *
+ * \param [in]       comm
+ *                   MDI communicator associated with the intended recipient code.
+ */
+int send_ncallbacks(MDI_Comm comm) {
+  return send_name_count(MDI_LIST_CALLBACKS, comm);
+}
+
+
+/*! \brief Send the number of supported nodes
+ *
+ * If running with MPI, this function must be called only by rank \p 0.
+ * The function returns \p 0 on a success.
+ *
+ * \param [in]       comm
+ *                   MDI communicator associated with the intended recipient code.
+ */
+int send_nnodes(MDI_Comm comm) {
+  code* this_code = get_code(active_context->current_code);
   if ( this_code->intra_rank != 0 ) {
-    mdi_error("Attempting to send command information from the incorrect rank");
+    mdi_error("Attempting to send callback information from the incorrect rank");
     return 1;
   }
-  int ncommands = 0;
-  int nnodes = (int)this_code->nodes->size;
-  int inode, icommand;
+  int nnodes = (int)this_code->nodes->entries.size;
+  int ret = general_send( &nnodes, 1, MDI_INT, comm );
+  return ret;
+}
+
+
+/*! \brief Register the nodes, commands, or callbacks described by one of the lists of a registry
+ *
+ * The list has the form sent in reply to \p <NODES, \p <COMMANDS, or \p <CALLBACKS.
+ * The function returns \p 0 on a success.
+ *
+ * \param [in]       node_reg
+ *                   Registry of nodes, into which the names will be registered.
+ * \param [in]       list_type
+ *                   MDI_LIST_COMMANDS, MDI_LIST_CALLBACKS, or MDI_LIST_NODES.
+ * \param [in]       list
+ *                   The list.
+ */
+static int parse_name_list(registry* node_reg, int list_type, const name_list* list) {
   int stride = MDI_COMMAND_LENGTH + 1;
+  int nentries = list->count / stride;
+  char current_node[COMMAND_LENGTH];
+  char name[COMMAND_LENGTH];
+  int node_flag = 1;
+  int ientry;
 
-  // determine the number of commands
-  for (inode = 0; inode < nnodes; inode++) {
-    node* this_node = vector_get(this_code->nodes, inode);
-    ncommands += (int)this_node->commands->size;
-  }
+  current_node[0] = '\0';
+  for (ientry = 0; ientry < nentries; ientry++) {
+    // find the end of the name
+    const char* name_start = &list->data[ ientry * stride ];
+    const char* name_end = memchr( name_start, ' ', MDI_COMMAND_LENGTH );
+    int name_length = ( name_end == NULL ) ? MDI_COMMAND_LENGTH : (int)(name_end - name_start);
+    snprintf(name, COMMAND_LENGTH, "%.*s", name_length, name_start);
 
-  // allocate memory for the commands list
-  int count = ( ncommands + nnodes ) * stride;
-  char* commands = malloc( count * sizeof(char) );
+    if ( list_type == MDI_LIST_NODES ) {
+      register_node(node_reg, name);
+      continue;
+    }
 
-  // form the list of commands
-  int islot = 0;
-  for (inode = 0; inode < nnodes; inode++) {
-    // add the name of this node to the list
-    node* this_node = vector_get(this_code->nodes, inode);
-    int length = (int)strlen(this_node->name);
-    snprintf(&commands[ islot * stride ], COMMAND_LENGTH, "%s", this_node->name);
-    int ichar;
-    for (ichar = length; ichar < stride-1; ichar++) {
-      snprintf(&commands[ islot * stride + ichar ], sizeof(char*), "%c", ' ');
+    if ( node_flag == 1 ) { // node
+      // store the name of the current node
+      snprintf(current_node, COMMAND_LENGTH, "%s", name);
     }
-    if ( this_node->commands->size > 0 ) {
-      snprintf(&commands[ islot * stride + stride - 1 ], sizeof(char*), "%c", ',');
+    else if ( list_type == MDI_LIST_COMMANDS ) {
+      register_command(node_reg, current_node, name);
     }
     else {
-      snprintf(&commands[ islot * stride + stride - 1 ], sizeof(char*), "%c", ';');
+      register_callback(node_reg, current_node, name);
     }
-    islot++;
 
-    // add the commands for this node
-    for (icommand = 0; icommand < this_node->commands->size; icommand++) {
-      char* command = vector_get(this_node->commands, icommand);
-      length = (int)strlen(command);
-      snprintf(&commands[ islot * stride ], COMMAND_LENGTH, "%s", command);
-      for (ichar = length; ichar < stride-1; ichar++) {
-	snprintf(&commands[ islot * stride + ichar ], sizeof(char*), "%c", ' ');
-      }
-      if ( icommand == this_node->commands->size - 1 ) {
-	snprintf(&commands[ islot * stride + stride - 1 ], sizeof(char*), "%c", ';');
-      }
-      else {
-	snprintf(&commands[ islot * stride + stride - 1 ], sizeof(char*), "%c", ',');
-      }
-      islot++;
+    // determine whether the next name is for a node or a command
+    if ( name_start[stride - 1] == ';' ) {
+      node_flag = 1;
+    }
+    else if ( name_start[stride - 1] == ',' ) {
+      node_flag = 0;
+    }
+    else {
+      mdi_error("Error obtaining node information: could not parse delimiter");
+      return 1;
     }
   }
 
-  int ret = general_send( commands, count, MDI_CHAR, comm );
-  free( commands );
-  return ret;
+  return 0;
 }
 
 
-/*! \brief Send the list of callbacks
+/*! \brief Form a registry of nodes from the lists that describe it
  *
- * If running with MPI, this function must be called only by rank \p 0.
+ * The registry is given perfect hash tables, since the registry of a connected code does not change.
  * The function returns \p 0 on a success.
  *
- * \param [in]       comm
- *                   MDI communicator associated with the intended recipient code.
+ * \param [in]       node_reg
+ *                   Empty registry of nodes, into which the nodes, commands, and callbacks will be registered.
+ * \param [in]       lists
+ *                   The lists that describe the registry, indexed by MDI_LIST_COMMANDS,
+ *                   MDI_LIST_CALLBACKS, and MDI_LIST_NODES.
  */
-int send_callback_list(MDI_Comm comm) {
-  code* this_code = get_code(current_code);
-  if ( this_code->intra_rank != 0 ) {
-    mdi_error("Attempting to send callback information from the incorrect rank");
-    return 1;
+int parse_name_lists(registry* node_reg, const name_list* lists) {
+  int ret = parse_name_list(node_reg, MDI_LIST_NODES, &lists[MDI_LIST_NODES]);
+  if ( ret == 0 ) {
+    ret = parse_name_list(node_reg, MDI_LIST_COMMANDS, &lists[MDI_LIST_COMMANDS]);
   }
-  int ncallbacks = 0;
-  int nnodes = (int)this_code->nodes->size;
-  int inode, icallback;
-  int stride = MDI_COMMAND_LENGTH + 1;
-
-  // determine the number of callbakcs
-  for (inode = 0; inode < nnodes; inode++) {
-    node* this_node = vector_get(this_code->nodes, inode);
-    ncallbacks += (int)this_node->callbacks->size;
+  if ( ret == 0 ) {
+    ret = parse_name_list(node_reg, MDI_LIST_CALLBACKS, &lists[MDI_LIST_CALLBACKS]);
   }
-
-  // allocate memory for the callbacks list
-  int count = ( ncallbacks + nnodes ) * stride;
-  char* callbacks = malloc( count * sizeof(char) );
-
-  // form the list of callbacks
-  int islot = 0;
-  for (inode = 0; inode < nnodes; inode++) {
-    // add the name of this node to the list
-    node* this_node = vector_get(this_code->nodes, inode);
-    int length = (int)strlen(this_node->name);
-    snprintf(&callbacks[ islot * stride ], COMMAND_LENGTH, "%s", this_node->name);
-    int ichar;
-    for (ichar = length; ichar < stride-1; ichar++) {
-      snprintf(&callbacks[ islot * stride + ichar ], sizeof(char*), "%c", ' ');
-    }
-    if ( this_node->callbacks->size > 0 ) {
-      snprintf(&callbacks[ islot * stride + stride - 1 ], sizeof(char*), "%c", ',');
-    }
-    else {
-      snprintf(&callbacks[ islot * stride + stride - 1 ], sizeof(char*), "%c", ';');
-    }
-    islot++;
-
-    // add the callbacks for this node
-    for (icallback = 0; icallback < this_node->callbacks->size; icallback++) {
-      char* callback = vector_get(this_node->callbacks, icallback);
-      length = (int)strlen(callback);
-      snprintf(&callbacks[ islot * stride ], COMMAND_LENGTH, "%s", callback);
-      for (ichar = length; ichar < stride-1; ichar++) {
-	snprintf(&callbacks[ islot * stride + ichar ], sizeof(char*), "%c", ' ');
-      }
-      if ( icallback == this_node->callbacks->size - 1 ) {
-	snprintf(&callbacks[ islot * stride + stride - 1 ], sizeof(char*), "%c", ';');
-      }
-      else {
-	snprintf(&callbacks[ islot * stride + stride - 1 ], sizeof(char*), "%c", ',');
-      }
-      islot++;
-    }
+  if ( ret != 0 ) {
+    return ret;
   }
 
-  int ret = general_send( callbacks, count, MDI_CHAR, comm );
-  free( callbacks );
-  return ret;
+  registry_freeze(node_reg);
+  int inode;
+  for (inode = 0; inode < (int)node_reg->entries.size; inode++) {
+    node* this_node = registry_get(node_reg, inode);
+    registry_freeze(this_node->commands);
+    registry_freeze(this_node->callbacks);
+  }
+  return 0;
 }
 
 
-/*! \brief Send the list of nodes
+/*! \brief Receive one of the lists that describe the registry of a connected code
  *
- * If running with MPI, this function must be called only by rank \p 0.
  * The function returns \p 0 on a success.
  *
+ * \param [in]       count_command
+ *                   Command that requests the number of names in the list, or NULL for the list of nodes.
+ * \param [in]       list_command
+ *                   Command that requests the list.
+ * \param [in]       nnodes
+ *                   Number of nodes of the connected code.
+ * \param [out]      list
+ *                   The list, whose data is allocated by this function.
  * \param [in]       comm
- *                   MDI communicator associated with the intended recipient code.
+ *                   MDI communicator associated with the connected code.
  */
-int send_node_list(MDI_Comm comm) {
-  code* this_code = get_code(current_code);
-  if ( this_code->intra_rank != 0 ) {
-    mdi_error("Attempting to send node information from the incorrect rank");
-    return 1;
-  }
-  int nnodes = (int)this_code->nodes->size;
-  int inode;
+static int recv_name_list(const char* count_command, const char* list_command, int nnodes,
+                          name_list* list, MDI_Comm comm) {
   int stride = MDI_COMMAND_LENGTH + 1;
 
-  // allocate memory for the node list
-  int count = nnodes * stride;
-  char* node_list = malloc( count * sizeof(char) );
-
-  // form the list of nodes
-  for (inode = 0; inode < nnodes; inode++) {
-    // add the name of this node to the list
-    node* this_node = vector_get(this_code->nodes, inode);
-    int length = (int)strlen(this_node->name);
-    snprintf(&node_list[ inode * stride ], COMMAND_LENGTH, "%s", this_node->name);
-    int ichar;
-    for (ichar = length; ichar < stride-1; ichar++) {
-      snprintf(&node_list[ inode * stride + ichar ], COMMAND_LENGTH, "%c", ' ');
-    }
-    snprintf(&node_list[ inode * stride + stride - 1 ], COMMAND_LENGTH, "%c", ',');
+  // get the number of commands or callbacks
+  list->nnames = 0;
+  if ( count_command != NULL ) {
+    MDI_Send_Command(count_command, comm);
+    MDI_Recv(&list->nnames, 1, MDI_INT, comm);
   }
 
-  int ret = general_send( node_list, count, MDI_CHAR, comm );
-  free( node_list );
+  // get the list
+  list->count = ( list->nnames + nnodes ) * stride;
+  list->data = malloc( ( list->count + 1 ) * sizeof(char) );
+  MDI_Send_Command(list_command, comm);
+  int ret = MDI_Recv(list->data, list->count, MDI_CHAR, comm);
+  list->data[ list->count ] = '\0';
   return ret;
 }
 
 
-/*! \brief Send the number of supported commands
+/*! \brief Get information about the nodes of a particular code
  *
+ * If the connected code identifies its registry, and a code with the same name, MDI version,
+ * and registry has already been queried, the communicator shares the registry that was
+ * obtained from that code, and the registry is not queried again.
  * If running with MPI, this function must be called only by rank \p 0.
  * The function returns \p 0 on a success.
  *
  * \param [in]       comm
- *                   MDI communicator associated with the intended recipient code.
+ *                   MDI communicator associated with the connection to the sending code.
  */
-int send_ncommands(MDI_Comm comm) {
-  code* this_code = get_code(current_code);
-  if ( this_code->intra_rank != 0 ) {
-    mdi_error("Attempting to send command information from the incorrect rank");
-    return 1;
+int get_node_info(MDI_Comm comm) {
+  code* this_code = get_code(active_context->current_code);
+  communicator* this = get_communicator(active_context->current_code, comm);
+  int ret;
+
+  // identify the registry of the connected code, and look for it in the registry cache
+  registry_key key;
+  int use_cache = ( this->features & MDI_FEATURE_REGISTRY_KEY ) != 0;
+  if ( use_cache ) {
+    ret = MDI_Send_Command("<REGKEY", comm);
+    if ( ret != 0 ) {
+      mdi_error("Error in MDI: Unable to request the registry key of the connected code");
+      return ret;
+    }
+    ret = MDI_Recv(key.name, NAME_LENGTH, MDI_CHAR, comm);
+    if ( ret != 0 ) {
+      mdi_error("Error in MDI: Unable to receive the name in the registry key of the connected code");
+      return ret;
+    }
+    ret = MDI_Recv(&key.hash, 1, MDI_INT64, comm);
+    if ( ret != 0 ) {
+      mdi_error("Error in MDI: Unable to receive the hash in the registry key of the connected code");
+      return ret;
+    }
+    key.name[NAME_LENGTH - 1] = '\0';
+    memcpy(key.mdi_version, this->mdi_version, sizeof(key.mdi_version));
+
+    registry* cached = regcache_find(this_code, &key);
+    if ( cached != NULL ) {
+      free_node_registry(this->nodes);
+      this->nodes = cached;
+      this->shared_nodes = 1;
+      return 0;
+    }
   }
-  int ncommands = 0;
-  int nnodes = (int)this_code->nodes->size;
-  int inode;
-  int stride = MDI_COMMAND_LENGTH + 1;
 
-  // determine the number of commands
-  for (inode = 0; inode < nnodes; inode++) {
-    node* this_node = vector_get(this_code->nodes, inode);
-    ncommands += (int)this_node->commands->size;
+  // get the lists that describe the registry
+  name_list lists[MDI_NLISTS];
+  int nnodes;
+  MDI_Send_Command("<NNODES",comm);
+  MDI_Recv(&nnodes, 1, MDI_INT, comm);
+  recv_name_list(NULL, "<NODES", nnodes, &lists[MDI_LIST_NODES], comm);
+  recv_name_list("<NCOMMANDS", "<COMMANDS", nnodes, &lists[MDI_LIST_COMMANDS], comm);
+  recv_name_list("<NCALLBACKS", "<CALLBACKS", nnodes, &lists[MDI_LIST_CALLBACKS], comm);
+
+  ret = parse_name_lists(this->nodes, lists);
+
+  // share the registry through the cache, unless it changed after it was identified
+  if ( ret == 0 && use_cache && regcache_hash(lists) == key.hash ) {
+    // the registry is only shared once the cache owns it, even if it could not be written to the file
+    int owned = 0;
+    ret = regcache_insert(this_code, &key, this->nodes, lists, &owned);
+    this->shared_nodes = owned;
+  }
+
+  // free the memory
+  int ilist;
+  for (ilist = 0; ilist < MDI_NLISTS; ilist++) {
+    free( lists[ilist].data );
   }
 
-  int ret = general_send( &ncommands, 1, MDI_INT, comm );
   return ret;
 }
 
 
-/*! \brief Send the number of supported callbacks
+/*! \brief Send the key that identifies the registry of the current code
  *
+ * The key consists of the name of the code, followed by a hash of the lists that describe its registry.
  * If running with MPI, this function must be called only by rank \p 0.
  * The function returns \p 0 on a success.
  *
  * \param [in]       comm
  *                   MDI communicator associated with the intended recipient code.
  */
-int send_ncallbacks(MDI_Comm comm) {
-  code* this_code = get_code(current_code);
+int send_registry_key(MDI_Comm comm) {
+  code* this_code = get_code(active_context->current_code);
   if ( this_code->intra_rank != 0 ) {
-    mdi_error("Attempting to send callback information from the incorrect rank");
+    mdi_error("Attempting to send registry information from the incorrect rank");
     return 1;
   }
-  int ncallbacks = 0;
-  int nnodes = (int)this_code->nodes->size;
-  int inode;
-  int stride = MDI_COMMAND_LENGTH + 1;
 
-  // determine the number of callbacks
-  for (inode = 0; inode < nnodes; inode++) {
-    node* this_node = vector_get(this_code->nodes, inode);
-    ncallbacks += (int)this_node->callbacks->size;
+  // if the registry is frozen, the lists are formed only once
+  name_list lists[MDI_NLISTS];
+  int ilist;
+  for (ilist = 0; ilist < MDI_NLISTS; ilist++) {
+    if ( this_code->registry_frozen ) {
+      lists[ilist] = *get_frozen_list(this_code, ilist);
+    }
+    else {
+      form_name_list(this_code, ilist, &lists[ilist]);
+    }
+  }
+  int64_t hash = (int64_t) regcache_hash(lists);
+  if ( ! this_code->registry_frozen ) {
+    for (ilist = 0; ilist < MDI_NLISTS; ilist++) {
+      free( lists[ilist].data );
+    }
   }
 
-  int ret = general_send( &ncallbacks, 1, MDI_INT, comm );
+  int ret = general_send( this_code->name, NAME_LENGTH, MDI_CHAR, comm );
+  if ( ret == 0 ) {
+    ret = general_send( &hash, 1, MDI_INT64, comm );
+  }
   return ret;
 }
 
 
-/*! \brief Send the number of supported nodes
+/*! \brief Get the node registry associated with a particular communicator
  *
- * If running with MPI, this function must be called only by rank \p 0.
- * The function returns \p 0 on a success.
+ * The function returns the node registry for the communicator.
  *
  * \param [in]       comm
- *                   MDI communicator associated with the intended recipient code.
+ *                   MDI communicator of the engine.  If comm is set to 
+ *                   MDI_COMM_NULL, the function will return the node registry for the calling engine.
  */
-int send_nnodes(MDI_Comm comm) {
-  code* this_code = get_code(current_code);
-  if ( this_code->intra_rank != 0 ) {
-    mdi_error("Attempting to send callback information from the incorrect rank");
-    return 1;
+registry* get_node_registry(MDI_Comm comm) {
+  // get the registry of nodes associated with the communicator
+  registry* node_reg;
+  code* this_code = get_code(active_context->current_code);
+  if ( comm == MDI_COMM_NULL ) {
+    node_reg = this_code->nodes;
   }
-  int nnodes = (int)this_code->nodes->size;
-  int ret = general_send( &nnodes, 1, MDI_INT, comm );
-  return ret;
+  else {
+    communicator* this = get_communicator(active_context->current_code, comm);
+    if ( ! this->shared_nodes && this->nodes->entries.size == 0 ) {
+      // acquire node information for this communicator
+      get_node_info(comm);
+    }
+    node_reg = this->nodes;
+  }
+  return node_reg;
 }
 
 
-/*! \brief Get information about the nodes of a particular code
+/*! \brief Freeze the registry of the current code
  *
- * If running with MPI, this function must be called only by rank \p 0.
+ * Each registry of nodes, commands, and callbacks is given a perfect hash table, and the lists
+ * that are sent in reply to the builtin commands that query the registry are formed once.
  * The function returns \p 0 on a success.
- *
- * \param [in]       comm
- *                   MDI communicator associated with the connection to the sending code.
  */
-int get_node_info(MDI_Comm comm) {
-  size_t stride = MDI_COMMAND_LENGTH + 1;
-  communicator* this = get_communicator(current_code, comm);
-  char* current_node = malloc( MDI_COMMAND_LENGTH * sizeof(char) );
-
-  // get the number of nodes
-  int nnodes_int;
-  MDI_Send_Command("<NNODES",comm);
-  MDI_Recv(&nnodes_int, 1, MDI_INT, comm);
-  size_t nnodes = nnodes_int;
-
-  // get the nodes
-  size_t list_size = nnodes * stride * sizeof(char);
-  char* node_list = malloc( list_size );
-  MDI_Send_Command("<NODES",comm);
-  MDI_Recv(node_list, (int)(nnodes * stride), MDI_CHAR, comm);
+int general_freeze_registry() {
+  code* this_code = get_code(active_context->current_code);
+  this_code->registry_frozen = 1;
 
-  // register the nodes
+  // build perfect hash tables
+  registry_freeze(this_code->nodes);
   int inode;
-  int ichar;
-  for (inode = 0; inode < nnodes; inode++) {
-    // find the end of the node name
-    char* name_start = &node_list[ inode * stride ];
-    char* name_end = strchr( name_start, ' ' );
-    int name_length;
-    if (name_end == NULL) {
-      name_length = MDI_COMMAND_LENGTH;
-    }
-    else {
-      name_length = (int)(name_end - name_start);
-    }
-    if ( name_length > MDI_COMMAND_LENGTH ) {
-      mdi_error("Error obtaining node information: could not parse node name");
-      return 1;
+  for (inode = 0; inode < (int)this_code->nodes->entries.size; inode++) {
+    node* this_node = registry_get(this_code->nodes, inode);
+    registry_freeze(this_node->commands);
+    registry_freeze(this_node->callbacks);
+    if ( this_node->handlers != NULL ) {
+      registry_freeze(this_node->handlers);
     }
+  }
 
-    // construct the name of the node
-    char* node_name = malloc( MDI_COMMAND_LENGTH * sizeof(char) );
-    snprintf(node_name, COMMAND_LENGTH, "%s", name_start);
-    for (ichar = name_length; ichar < MDI_COMMAND_LENGTH; ichar++) {
-      node_name[ichar] = '\0';
-    }
+  // form the lists
+  int ilist;
+  for (ilist = 0; ilist < MDI_NLISTS; ilist++) {
+    free( this_code->frozen_lists[ilist].data );
+    this_code->frozen_lists[ilist].data = NULL;
+    get_frozen_list(this_code, ilist);
+  }
+
+  return 0;
+}
 
-    // register this node
-    register_node(this->nodes, node_name);
 
-    // free the memory for the node name
-    free( node_name );
+/*! \brief Update the frozen registry of the current code after a registration
+ *
+ * Only the registry that received the new entry, and the lists that include the entry,
+ * are rebuilt.
+ * The function returns \p 0 on a success.
+ *
+ * \param [in]       node_name
+ *                   Name of the node that was registered, or on which a command or callback was registered.
+ * \param [in]       list_type
+ *                   MDI_LIST_NODES if a node was registered, MDI_LIST_COMMANDS if a command was registered,
+ *                   or MDI_LIST_CALLBACKS if a callback was registered.
+ */
+int general_update_frozen_registry(const char* node_name, int list_type) {
+  code* this_code = get_code(active_context->current_code);
+  int node_index = get_node_index(this_code->nodes, node_name);
+  if ( node_index == -1 ) {
+    mdi_error("Attempting to update the registry of an unregistered node");
+    return 1;
   }
+  node* this_node = registry_get(this_code->nodes, node_index);
 
-  // get the number of commands
-  int ncommands;
-  MDI_Send_Command("<NCOMMANDS",comm);
-  MDI_Recv(&ncommands, 1, MDI_INT, comm);
-
-  // get the list of commands
-  int count = (int)( ( ncommands + nnodes ) * stride );
-  char* commands = malloc( count * sizeof(char) );
-  MDI_Send_Command("<COMMANDS",comm);
-  MDI_Recv(commands, count, MDI_CHAR, comm);
+  // rebuild the perfect hash table of the registry that changed
+  int ilist;
+  if ( list_type == MDI_LIST_NODES ) {
+    registry_freeze(this_code->nodes);
+    registry_freeze(this_node->commands);
+    registry_freeze(this_node->callbacks);
+  }
+  else if ( list_type == MDI_LIST_COMMANDS ) {
+    registry_freeze(this_node->commands);
+  }
+  else {
+    registry_freeze(this_node->callbacks);
+  }
 
-  // register the commands
-  int node_flag = 1;
-  for (inode = 0; inode < nnodes + ncommands; inode++) {
-    // find the end of the name
-    char* name_start = &commands[ inode * stride ];
-    char* name_end = strchr( name_start, ' ' );
-    int name_length;
-    if (name_end == NULL) {
-      name_length = MDI_COMMAND_LENGTH;
-    }
-    else {
-      name_length = (int)(name_end - name_start);
-    }
-    if ( name_length > MDI_COMMAND_LENGTH ) {
-      mdi_error("Error obtaining node information: could not parse command name");
-      return 1;
+  // every list includes the names of the nodes
+  for (ilist = 0; ilist < MDI_NLISTS; ilist++) {
+    if ( list_type == MDI_LIST_NODES || ilist == list_type ) {
+      free( this_code->frozen_lists[ilist].data );
+      this_code->frozen_lists[ilist].data = NULL;
+      get_frozen_list(this_code, ilist);
     }
+  }
 
-    // construct the name
-    char* command_name = malloc( MDI_COMMAND_LENGTH * sizeof(char) );
-    snprintf(command_name, COMMAND_LENGTH, "%s", name_start);
-    for (ichar = name_length; ichar < MDI_COMMAND_LENGTH; ichar++) {
-      command_name[ichar] = '\0';
-    }
-    //printf("DRIVER COMMAND: %d %d %s\n",inode,name_length,command_name);
+  return 0;
+}
 
-    if ( node_flag == 1 ) { // node
-      // store the name of the current node
-      snprintf(current_node, COMMAND_LENGTH, "%s", command_name);
-    }
-    else { // command
-      // register this command
-      register_command(this->nodes, current_node, command_name);
-    }
 
-    // determine whether the next name is for a node or a command
-    if ( name_start[stride - 1] == ';' ) {
-      node_flag = 1;
-    }
-    else if ( name_start[stride - 1] == ',' ) {
-      node_flag = 0;
+/*! \brief Register a handler that responds to a command received by the current code
+ *
+ * If the command is not yet registered on the node, it is registered.
+ * Each node has its own handlers, and a handler that was previously registered for the command
+ * on the same node is replaced.
+ * The function returns \p 0 on a success.
+ *
+ * \param [in]       node_name
+ *                   Name of the node on which the command will be registered.
+ * \param [in]       command_name
+ *                   Name of the command.
+ * \param [in]       handler
+ *                   Function that responds to the command.
+ * \param [in]       ctx
+ *                   Pointer that is passed to each call of \p handler.
+ */
+int general_register_command_handler(const char* node_name, const char* command_name,
+                                     MDI_Command_handler_t handler, void* ctx) {
+  code* this_code = get_code(active_context->current_code);
+  int ret;
+
+  if ( handler == NULL ) {
+    mdi_error("Error in MDI_Register_Command_Handler: The handler must not be NULL");
+    return 1;
+  }
+  if ( strlen(command_name) >= COMMAND_LENGTH ) {
+    mdi_error("Error in MDI_Register_Command_Handler: Command name is too long");
+    return 1;
+  }
+
+  // register the command, unless it is already registered on this node
+  int node_index = get_node_index(this_code->nodes, node_name);
+  if ( node_index == -1 ) {
+    mdi_error("Error in MDI_Register_Command_Handler: Attempting to register a command handler on an unregistered node");
+    return 1;
+  }
+  node* target_node = registry_get(this_code->nodes, node_index);
+  if ( get_command_index(target_node, command_name) == -1 ) {
+    ret = register_command(this_code->nodes, node_name, command_name);
+    if ( ret == 0 && this_code->registry_frozen ) {
+      ret = general_update_frozen_registry(node_name, MDI_LIST_COMMANDS);
     }
-    else {
-      mdi_error("Error obtaining node information: could not parse delimiter");
-      return 1;
+    if ( ret != 0 ) {
+      return ret;
     }
-
-    // free the memory for the node name
-    free( command_name );
   }
 
+  // add the handler, or replace the handler that was previously registered for this command on this node
+  target_node = registry_get(this_code->nodes, node_index);
+  if ( target_node->handlers == NULL ) {
+    target_node->handlers = malloc(sizeof(registry));
+    registry_init(target_node->handlers, sizeof(command_handler));
+  }
+  int handler_index = registry_find(target_node->handlers, command_name);
+  if ( handler_index == -1 ) {
+    command_handler new_handler;
+    snprintf(new_handler.name, COMMAND_LENGTH, "%s", command_name);
+    new_handler.handler = handler;
+    new_handler.ctx = ctx;
+    registry_add(target_node->handlers, &new_handler);
+    if ( this_code->registry_frozen ) {
+      registry_freeze(target_node->handlers);
+    }
+  }
+  else {
+    command_handler* this_handler = registry_get(target_node->handlers, handler_index);
+    this_handler->handler = handler;
+    this_handler->ctx = ctx;
+  }
 
-  // get the number of callbacks
-  int ncallbacks;
-  MDI_Send_Command("<NCALLBACKS",comm);
-  MDI_Recv(&ncallbacks, 1, MDI_INT, comm);
+  return 0;
+}
 
-  // get the list of callbacks
-  count = (int)( ( ncallbacks + nnodes ) * stride );
-  char* callbacks = malloc( count * sizeof(char) );
-  MDI_Send_Command("<CALLBACKS",comm);
-  MDI_Recv(callbacks, count, MDI_CHAR, comm);
-  //printf("~~~CALLBACKS: %d %s\n",ncallbacks,callbacks);
 
-  // register the callbacks
-  node_flag = 1;
-  for (inode = 0; inode < nnodes + ncallbacks; inode++) {
-    // find the end of the name
-    char* name_start = &callbacks[ inode * stride ];
-    char* name_end = strchr( name_start, ' ' );
-    int name_length;
-    if (name_end == NULL) {
-      name_length = MDI_COMMAND_LENGTH;
-    }
-    else {
-      name_length = (int)(name_end - name_start);
-    }
-    if ( name_length > MDI_COMMAND_LENGTH ) {
-      mdi_error("Error obtaining node information: could not parse callback name");
-      return 1;
-    }
+/*! \brief Respond to a command that is not a builtin command
+ *
+ * The handler registered for the command on the code's current node is called if there is one;
+ * otherwise, the execute_command function of the current code is called.
+ * A command that is the name of one of the code's nodes, such as \p @FORCES, then moves the code
+ * to that node.
+ * A code that has neither does not need to respond to \p EXIT or to the names of its nodes, but
+ * any other command is an error.
+ * The function returns the value returned by the handler, or \p 0 on a success.
+ *
+ * \param [in]       command
+ *                   Name of the command.
+ * \param [in]       comm
+ *                   MDI communicator associated with the connection to the sending code.
+ */
+int general_execute_command(const char* command, MDI_Comm comm) {
+  code* this_code = get_code(active_context->current_code);
+  int ret;
 
-    // construct the name
-    char* callback_name = malloc( MDI_COMMAND_LENGTH * sizeof(char) );
-    snprintf(callback_name, COMMAND_LENGTH, "%s", name_start);
-    for (ichar = name_length; ichar < MDI_COMMAND_LENGTH; ichar++) {
-      callback_name[ichar] = '\0';
+  command_handler* this_handler = NULL;
+  if ( this_code->current_node < (int)this_code->nodes->entries.size ) {
+    node* current = registry_get(this_code->nodes, this_code->current_node);
+    if ( current->handlers != NULL ) {
+      int handler_index = registry_find(current->handlers, command);
+      if ( handler_index >= 0 ) {
+        this_handler = registry_get(current->handlers, handler_index);
+      }
     }
-    //printf("DRIVER CALLBACK: %d %d %s\n",inode,name_length,callback_name);
+  }
 
-    if ( node_flag == 1 ) { // node
-      // store the name of the current node
-      snprintf(current_node, COMMAND_LENGTH, "%s", callback_name);
-    }
-    else { // callback
-      // register this callback
-      register_callback(this->nodes, current_node, callback_name);
-    }
+  if ( this_handler != NULL ) {
+    ret = this_handler->handler(command, comm, this_handler->ctx);
+  }
+  else if ( this_code->execute_command != NULL ) {
+    ret = this_code->execute_command(command, comm, this_code->execute_command_obj);
+  }
+  else {
+    ret = 0;
+  }
 
-    // determine whether the next name is for a node or a callback
-    if ( name_start[stride - 1] == ';' ) {
-      node_flag = 1;
-    }
-    else if ( name_start[stride - 1] == ',' ) {
-      node_flag = 0;
-    }
-    else {
-      mdi_error("Error obtaining node information: could not parse delimiter");
-      return 1;
+  // move to the node that the command names, if any
+  int node_index = -1;
+  if ( ret == 0 && command[0] == '@' ) {
+    node_index = get_node_index(this_code->nodes, command);
+    if ( node_index >= 0 ) {
+      this_code->current_node = node_index;
     }
-
-    // free the memory for the node name
-    free( callback_name );
   }
-  
-  // free the memory
-  free( node_list );
-  free( commands );
-  free( callbacks );
-  free( current_node );
 
-  return 0;
+  // a code that has neither a handler nor an execute_command function only needs to respond
+  // to EXIT and to the names of its nodes
+  if ( this_handler == NULL && this_code->execute_command == NULL &&
+       node_index < 0 && strcmp(command, "EXIT") != 0 ) {
+    mdi_error("Error in MDI: No handler is registered for the command on the current node");
+    return 1;
+  }
+  return ret;
 }
 
 
-/*! \brief Get the node vector associated with a particular communicator
+/*! \brief Respond to commands through the command handlers of the current code, until \p EXIT is received
  *
- * The function returns the node vector for the communicator.
+ * An engine that is linked to its driver as a library, and not launched as a plugin, receives
+ * its commands when the driver sends them.
+ * Such an engine passes \p MDI_COMM_NULL, and the function returns immediately.
+ * Command handlers respond at the first registered node, until a command moves the code to another node.
+ * If running with MPI, this function must be called only by rank \p 0.
+ * The function returns \p 0 on a success.
  *
  * \param [in]       comm
- *                   MDI communicator of the engine.  If comm is set to 
- *                   MDI_COMM_NULL, the function will return the node vector for the calling engine.
+ *                   MDI communicator associated with the driver, or \p MDI_COMM_NULL.
  */
-vector* get_node_vector(MDI_Comm comm) {
-  // get the vector of nodes associated with the communicator
-  vector* node_vec;
-  code* this_code = get_code(current_code);
+int general_serve(MDI_Comm comm) {
+  code* this_code = get_code(active_context->current_code);
+
+  // each driver that is served starts at the first node
+  this_code->current_node = 0;
+
   if ( comm == MDI_COMM_NULL ) {
-    node_vec = this_code->nodes;
-  }
-  else {
-    communicator* this = get_communicator(current_code, comm);
-    if ( this->nodes->size == 0 ) {
-      // acquire node information for this communicator
-      get_node_info(comm);
+    if ( this_code->is_library == 0 || active_context->plugin_mode ) {
+      mdi_error("Error in MDI_Serve: Only an engine library may be served without a communicator");
+      return 1;
     }
-    node_vec = this->nodes;
+
+    // the driver will call library_execute_command for each command
+    this_code->called_set_execute_command_func = 1;
+    return 0;
+  }
+
+  if ( this_code->intra_rank != 0 ) {
+    mdi_error("Error in MDI_Serve: MDI_Serve must only be called by rank 0");
+    return 1;
   }
-  return node_vec;
+
+  char command[COMMAND_LENGTH];
+  int ret;
+  do {
+    ret = general_recv_command(command, comm);
+    if ( ret != 0 ) {
+      mdi_error("Error in MDI_Serve: Unable to receive command");
+      return ret;
+    }
+    ret = general_execute_command(command, comm);
+    if ( ret != 0 ) {
+      mdi_error("Error in MDI_Serve: Unable to respond to command");
+      return ret;
+    }
+  } while ( strcmp(command, "EXIT") != 0 );
+
+  return 0;
 }
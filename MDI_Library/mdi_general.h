@@ -8,21 +8,41 @@
 
 #include "mdi.h"
 #include "mdi_global.h"
+#include "mdi_strided.h"
 
 /*! \brief Function pointer to the generic execute_command function */
 extern int (*execute_command)(const char*, MDI_Comm);
 
 int general_init(const char* options, void* world_comm);
 int general_accept_communicator();
-int general_send(const void* buf, int count, MDI_Datatype datatype, MDI_Comm comm);
-int general_recv(void* buf, int count, MDI_Datatype datatype, MDI_Comm comm);
+int general_negotiate_features(MDI_Comm comm);
+int general_send(const void* buf, size_t count, MDI_Datatype datatype, MDI_Comm comm);
+int general_recv(void* buf, size_t count, MDI_Datatype datatype, MDI_Comm comm);
+int general_send_units(const void* buf, size_t count, MDI_Datatype datatype, int unit_id, MDI_Comm comm);
+int general_recv_units(void* buf, size_t count, MDI_Datatype datatype, const char* to_unit, MDI_Comm comm);
+int general_send_header(communicator* this_comm, size_t count, MDI_Datatype datatype,
+                        int header_type, size_t wire_bytes, int unit_id, MDI_Comm comm);
+int general_recv_header(communicator* this_comm, size_t count, MDI_Datatype datatype,
+                        int* header_type, size_t* wire_bytes, int* unit_id, MDI_Comm comm);
+int general_send_strided(const void* buf, const strided_desc* desc, MDI_Datatype datatype, MDI_Comm comm);
+int general_recv_strided(void* buf, const strided_desc* desc, MDI_Datatype datatype, MDI_Comm comm);
+int general_sendv(int nseg, const void* const* bufs, const size_t* counts, const MDI_Datatype* datatypes,
+                  MDI_Comm comm);
+int general_recvv(int nseg, void* const* bufs, const size_t* counts, const MDI_Datatype* datatypes,
+                  MDI_Comm comm);
+int general_send_stream(size_t count, MDI_Datatype datatype, size_t chunk_size,
+                        MDI_Stream_callback_t producer, void* ctx, MDI_Comm comm);
+int general_recv_stream(size_t count, MDI_Datatype datatype, size_t chunk_size,
+                        MDI_Stream_callback_t consumer, void* ctx, MDI_Comm comm);
+int general_decode_body(communicator* this_comm, void* wire_buf, size_t wire_bytes, int header_type,
+                        void* buf, size_t count, MDI_Datatype datatype);
 int general_send_command(const char* buf, MDI_Comm comm);
 int general_recv_command(char* buf, MDI_Comm comm);
 int general_builtin_command(const char* buf, MDI_Comm comm);
 
-int register_node(vector* node_vec, const char* node_name);
-int register_command(vector* node_vec, const char* node_name, const char* command_name);
-int register_callback(vector* node_vec, const char* node_name, const char* callback_name);
+int register_node(registry* node_reg, const char* node_name);
+int register_command(registry* node_reg, const char* node_name, const char* command_name);
+int register_callback(registry* node_reg, const char* node_name, const char* callback_name);
 
 int send_command_list(MDI_Comm comm);
 int send_callback_list(MDI_Comm comm);
@@ -31,6 +51,14 @@ int send_ncommands(MDI_Comm comm);
 int send_ncallbacks(MDI_Comm comm);
 int send_nnodes(MDI_Comm comm);
 int get_node_info(MDI_Comm comm);
-vector* get_node_vector(MDI_Comm comm);
+int parse_name_lists(registry* node_reg, const name_list* lists);
+int send_registry_key(MDI_Comm comm);
+registry* get_node_registry(MDI_Comm comm);
+int general_freeze_registry();
+int general_update_frozen_registry(const char* node_name, int list_type);
+int general_register_command_handler(const char* node_name, const char* command_name,
+                                     MDI_Command_handler_t handler, void* ctx);
+int general_execute_command(const char* command, MDI_Comm comm);
+int general_serve(MDI_Comm comm);
 
 #endif
@@ -8,26 +8,44 @@
 #include <string.h>
 #include <errno.h>
 #include "mdi_global.h"
-
-/*! \brief Vector containing all codes that have been initiailized on this rank
- * Typically, this will only include a single code, unless the communication method is LIBRARY */
-vector codes;
-
-/*! \brief Index of the active code */
-int current_code = 0;
-
-/*! \brief Flag for whether MDI is running in i-PI compatibility mode */
-int ipi_compatibility = 0;
-
-/*! \brief Flag for whether MDI has been previously initialized */
-int is_initialized = 0;
+#include "mdi_delta.h"
+#include "mdi_tcp.h"
+#include "mdi_filter.h"
+#include "mdi_regcache.h"
+#include "mdi_lib.h"
+#include "mdi_ensemble.h"
+
+#ifdef _WIN32
+  #include <windows.h>
+#else
+  #include <pthread.h>
+#endif
+
+/*! \brief Context used by the MDI calls of any thread that has not selected another context */
+static mdi_context default_context = { .current_code = 0, .tcp_socket = -1, .id = 0 };
+
+/*! \brief Context whose state is used by the MDI calls of this thread */
+MDI_THREAD_LOCAL mdi_context* active_context = &default_context;
+
+/*! \brief All contexts that currently exist, indexed by the low bits of their handles.
+ * Entries are only written while holding contexts_lock, so a context can be created or deleted
+ * by one thread while other threads use their own contexts. */
+static mdi_context* contexts[MDI_MAX_CONTEXTS] = { &default_context };
+
+/*! \brief Number of times each entry of contexts has been reused, which forms the high bits of
+ * the handles of its contexts */
+static int context_generations[MDI_MAX_CONTEXTS];
+
+/*! \brief Lock that serializes the creation and deletion of contexts */
+#ifdef _WIN32
+static SRWLOCK contexts_lock = SRWLOCK_INIT;
+#else
+static pthread_mutex_t contexts_lock = PTHREAD_MUTEX_INITIALIZER;
+#endif
 
 /*! \brief Flag for whether MDI called MPI_Init */
 int initialized_mpi = 0;
 
-/*! \brief Flag for whether MDI is currently operating in plugin mode */
-int plugin_mode = 0;
-
 /*! \brief Internal copy of MPI_COMM_WORLD, used when MDI initializes MPI */
 MPI_Comm mdi_mpi_comm_world;
 
@@ -155,23 +173,559 @@ void* vector_get(vector* v, int index) {
   return ( void* )( v->data + (index * v->stride) );
 }
 
-/*! \brief Determine the index of a node within a vector of nodes
+/*! \brief Initialize a slot map
  *
- * \param [in]       v
- *                   Pointer to the vector
- * \param [in]       node_name
- *                   Name of the node
+ * A slot map stores each of its elements at a fixed address, and identifies it by a handle
+ * that encodes the index of its slot and the generation of that slot.
+ * Looking up an element from its handle takes constant time, and a handle to an element that
+ * has been deleted is not mistaken for a handle to a later element stored in the same slot.
+ *
+ * \param [in]       m
+ *                   Pointer to the slot map
+ * \param [in]       stride
+ *                   Size of each element
+ * \param [in]       base
+ *                   Handle of the first element stored in the slot map
+ */
+int slot_map_init(slot_map* m, size_t stride, int base) {
+  vector_init(&m->slots, sizeof(slot));
+  vector_init(&m->free_slots, sizeof(size_t));
+  m->stride = stride;
+  m->base = base;
+  m->size = 0;
+  return 0;
+}
+
+/*! \brief Add an element to a slot map
+ *
+ * The element is copied into the slot map, and the function returns its handle.
+ * If the slot map is full, the function returns \p -1.
+ *
+ * \param [in]       m
+ *                   Pointer to the slot map
+ * \param [in]       element
+ *                   Pointer to the element that will be added to the slot map
+ */
+int slot_map_insert(slot_map* m, void* element) {
+  size_t index;
+  slot* this_slot;
+
+  if ( m->free_slots.size > 0 ) {
+    // reuse the most recently freed slot
+    index = *(size_t*)vector_get(&m->free_slots, (int)m->free_slots.size - 1);
+    vector_delete(&m->free_slots, (int)m->free_slots.size - 1);
+    this_slot = vector_get(&m->slots, (int)index);
+  }
+  else {
+    // create a new slot
+    index = m->slots.size;
+    if ( index + m->base > SLOT_MAP_INDEX_MASK ) {
+      mdi_error("Slot map is full");
+      return -1;
+    }
+    slot new_slot;
+    new_slot.element = malloc(m->stride);
+    new_slot.generation = 0;
+    new_slot.occupied = 0;
+    vector_push_back(&m->slots, &new_slot);
+    this_slot = vector_get(&m->slots, (int)index);
+  }
+
+  memcpy(this_slot->element, element, m->stride);
+  this_slot->occupied = 1;
+  m->size++;
+
+  return ( this_slot->generation << SLOT_MAP_INDEX_BITS ) | (int)( index + m->base );
+}
+
+/*! \brief Return a pointer to the element of a slot map that corresponds to a handle
+ *
+ * The function returns NULL if there is no such element, including if the element has been deleted.
+ *
+ * \param [in]       m
+ *                   Pointer to the slot map
+ * \param [in]       handle
+ *                   Handle of the element
+ */
+void* slot_map_get(slot_map* m, int handle) {
+  if ( handle < 0 ) {
+    return NULL;
+  }
+  size_t index = (size_t)( ( handle & SLOT_MAP_INDEX_MASK ) - m->base );
+  if ( ( handle & SLOT_MAP_INDEX_MASK ) < m->base || index >= m->slots.size ) {
+    return NULL;
+  }
+  slot* this_slot = (slot*)( m->slots.data + ( index * m->slots.stride ) );
+  if ( ! this_slot->occupied || this_slot->generation != ( handle >> SLOT_MAP_INDEX_BITS ) ) {
+    return NULL;
+  }
+  return this_slot->element;
+}
+
+/*! \brief Return a pointer to the element stored in a slot of a slot map
+ *
+ * This is used to iterate over all of the elements of a slot map.
+ * The function returns NULL if the slot does not currently hold an element.
+ *
+ * \param [in]       m
+ *                   Pointer to the slot map
+ * \param [in]       index
+ *                   Index of the slot, which must be less than the number of slots
+ */
+void* slot_map_at(slot_map* m, size_t index) {
+  slot* this_slot = vector_get(&m->slots, (int)index);
+  if ( this_slot == NULL || ! this_slot->occupied ) {
+    return NULL;
+  }
+  return this_slot->element;
+}
+
+/*! \brief Return the handle that the next element added to a slot map will have
+ *
+ * \param [in]       m
+ *                   Pointer to the slot map
+ */
+int slot_map_next_handle(slot_map* m) {
+  if ( m->free_slots.size > 0 ) {
+    size_t index = *(size_t*)vector_get(&m->free_slots, (int)m->free_slots.size - 1);
+    slot* this_slot = vector_get(&m->slots, (int)index);
+    return ( this_slot->generation << SLOT_MAP_INDEX_BITS ) | (int)( index + m->base );
+  }
+  return (int)( m->slots.size + m->base );
+}
+
+/*! \brief Remove an element from a slot map
+ *
+ * The memory of the element is kept for reuse by a later element, so pointers to the
+ * element remain valid, but its handle does not.
+ *
+ * \param [in]       m
+ *                   Pointer to the slot map
+ * \param [in]       handle
+ *                   Handle of the element that will be removed from the slot map
+ */
+int slot_map_delete(slot_map* m, int handle) {
+  if ( slot_map_get(m, handle) == NULL ) {
+    mdi_error("Slot map accessed with an invalid handle");
+    return 1;
+  }
+  size_t index = (size_t)( ( handle & SLOT_MAP_INDEX_MASK ) - m->base );
+  slot* this_slot = vector_get(&m->slots, (int)index);
+  this_slot->occupied = 0;
+  this_slot->generation = ( this_slot->generation + 1 ) & SLOT_MAP_GENERATION_MASK;
+  vector_push_back(&m->free_slots, &index);
+  m->size--;
+  return 0;
+}
+
+/*! \brief Free all data associated with a slot map
+ *
+ * \param [in]       m
+ *                   Pointer to the slot map that will be freed
+ */
+int slot_map_free(slot_map* m) {
+  size_t islot;
+  for ( islot = 0; islot < m->slots.size; islot++ ) {
+    slot* this_slot = vector_get(&m->slots, (int)islot);
+    free( this_slot->element );
+  }
+  vector_free(&m->slots);
+  vector_free(&m->free_slots);
+  return 0;
+}
+
+/*! \brief Determine the size class of a buffer
+ *
+ * Returns \p POOL_NCLASSES if the buffer is too large to be retained by the pool.
+ *
+ * \param [in]       nbytes
+ *                   Size of the buffer, in bytes
+ */
+static int pool_size_class(size_t nbytes) {
+  int iclass = 0;
+  size_t class_bytes = (size_t)1 << POOL_MIN_CLASS_BITS;
+  while ( class_bytes < nbytes && iclass < POOL_NCLASSES ) {
+    class_bytes <<= 1;
+    iclass++;
+  }
+  return iclass;
+}
+
+/*! \brief Allocate a buffer from the buffer pool
+ *
+ * The buffer is rounded up to the next power of two, and is reused from a buffer of the same
+ * size class that was previously returned to the pool, if one is available.
+ * Returns NULL if the buffer could not be allocated.
+ *
+ * \param [in]       nbytes
+ *                   Minimum size of the buffer, in bytes
+ */
+void* pool_alloc(size_t nbytes) {
+  int iclass = pool_size_class(nbytes);
+  size_t* block = NULL;
+  if ( iclass < POOL_NCLASSES ) {
+    pool_class* this_class = &active_context->pool_classes[iclass];
+    if ( this_class->nfree > 0 ) {
+      this_class->nfree--;
+      block = this_class->free_blocks[this_class->nfree];
+    }
+    else {
+      block = malloc( POOL_HEADER_BYTES + ( (size_t)1 << ( POOL_MIN_CLASS_BITS + iclass ) ) );
+    }
+  }
+  else {
+    block = malloc( POOL_HEADER_BYTES + nbytes );
+  }
+  if ( block == NULL ) {
+    return NULL;
+  }
+  block[0] = (size_t)iclass;
+  return (unsigned char*)block + POOL_HEADER_BYTES;
+}
+
+/*! \brief Return a buffer to the buffer pool
+ *
+ * \param [in]       buf
+ *                   Buffer returned by pool_alloc, or NULL
+ */
+void pool_free(void* buf) {
+  if ( buf == NULL ) {
+    return;
+  }
+  size_t* block = (size_t*)( (unsigned char*)buf - POOL_HEADER_BYTES );
+  int iclass = (int)block[0];
+  pool_class* this_class = ( iclass < POOL_NCLASSES ) ? &active_context->pool_classes[iclass] : NULL;
+  if ( this_class != NULL && this_class->nfree < POOL_DEPTH ) {
+    this_class->free_blocks[this_class->nfree] = block;
+    this_class->nfree++;
+  }
+  else {
+    free( block );
+  }
+}
+
+/*! \brief Free all buffers retained by the buffer pool
+ */
+int pool_release() {
+  int iclass;
+  for ( iclass = 0; iclass < POOL_NCLASSES; iclass++ ) {
+    pool_class* this_class = &active_context->pool_classes[iclass];
+    while ( this_class->nfree > 0 ) {
+      this_class->nfree--;
+      free( this_class->free_blocks[this_class->nfree] );
+    }
+  }
+  return 0;
+}
+
+/*! \brief Compute the hash of a name of at most COMMAND_LENGTH characters
+ *
+ * \param [in]       name
+ *                   The name.
+ * \param [in]       seed
+ *                   Seed that selects one of a family of independent hash functions.
+ */
+static unsigned int registry_hash(const char* name, unsigned int seed) {
+  // FNV-1a, starting from a basis that depends on the seed
+  unsigned int hash = 2166136261u ^ ( seed * 0x9E3779B9u );
+  int ichar;
+  for ( ichar = 0; ichar < COMMAND_LENGTH && name[ichar] != '\0'; ichar++ ) {
+    hash ^= (unsigned char)name[ichar];
+    hash *= 16777619u;
+  }
+
+  // mix the bits, so that the low bits depend on every character and on the seed
+  hash ^= hash >> 16;
+  hash *= 0x85EBCA6Bu;
+  hash ^= hash >> 13;
+  hash *= 0xC2B2AE35u;
+  hash ^= hash >> 16;
+  return hash;
+}
+
+/*! \brief Return the name of an entry of a registry
+ *
+ * \param [in]       r
+ *                   Pointer to the registry
+ * \param [in]       index
+ *                   Index of the entry
+ */
+static const char* registry_name(registry* r, int index) {
+  return (const char*)( r->entries.data + ( index * r->entries.stride ) );
+}
+
+/*! \brief Rebuild the hash table of a registry, using linear probing
+ *
+ * \param [in]       r
+ *                   Pointer to the registry
+ * \param [in]       nbuckets
+ *                   Number of buckets, which must be a power of two
+ */
+static void registry_rehash(registry* r, size_t nbuckets) {
+  free( r->buckets );
+  free( r->displacements );
+  r->displacements = NULL;
+  r->ngroups = 0;
+  r->perfect = 0;
+  r->nbuckets = nbuckets;
+  r->buckets = calloc(r->nbuckets, sizeof(int));
+
+  size_t mask = r->nbuckets - 1;
+  int ientry;
+  for ( ientry = 0; ientry < (int)r->entries.size; ientry++ ) {
+    size_t ibucket = registry_hash(registry_name(r, ientry), 0) & mask;
+    while ( r->buckets[ibucket] != 0 ) {
+      ibucket = ( ibucket + 1 ) & mask;
+    }
+    r->buckets[ibucket] = ientry + 1;
+  }
+}
+
+/*! \brief Initialize a registry
+ *
+ * A registry is a vector of named entries, together with a hash table that locates an
+ * entry from its name in constant time.
+ *
+ * \param [in]       r
+ *                   Pointer to the registry
+ * \param [in]       stride
+ *                   Size of each entry, which begins with a name of COMMAND_LENGTH characters
+ */
+int registry_init(registry* r, size_t stride) {
+  vector_init(&r->entries, stride);
+  r->buckets = NULL;
+  r->displacements = NULL;
+  registry_rehash(r, 8);
+  return 0;
+}
+
+/*! \brief Append an entry to a registry
+ *
+ * The caller is responsible for ensuring that no entry with the same name is registered.
+ * If the hash table of the registry is perfect, it is replaced by an ordinary hash table,
+ * until registry_freeze is called again.
+ *
+ * \param [in]       r
+ *                   Pointer to the registry
+ * \param [in]       entry
+ *                   Pointer to the entry that will be appended to the registry
+ */
+int registry_add(registry* r, void* entry) {
+  vector_push_back(&r->entries, entry);
+
+  // keep the hash table at most half full, so that probe sequences remain short
+  size_t nbuckets = r->nbuckets;
+  while ( 2 * r->entries.size > nbuckets ) {
+    nbuckets *= 2;
+  }
+  if ( r->perfect || nbuckets != r->nbuckets ) {
+    registry_rehash(r, nbuckets);
+  }
+  else {
+    size_t mask = r->nbuckets - 1;
+    int index = (int)r->entries.size - 1;
+    size_t ibucket = registry_hash(registry_name(r, index), 0) & mask;
+    while ( r->buckets[ibucket] != 0 ) {
+      ibucket = ( ibucket + 1 ) & mask;
+    }
+    r->buckets[ibucket] = index + 1;
+  }
+  return 0;
+}
+
+/*! \brief Determine the index of the entry of a registry that has a particular name
+ *
+ * The function returns -1 if there is no such entry.
+ *
+ * \param [in]       r
+ *                   Pointer to the registry
+ * \param [in]       name
+ *                   Name of the entry
+ */
+int registry_find(registry* r, const char* name) {
+  size_t mask = r->nbuckets - 1;
+
+  // with a perfect hash table, the only candidate is in the bucket selected by the displacement
+  if ( r->perfect ) {
+    size_t igroup = registry_hash(name, 0) & ( r->ngroups - 1 );
+    size_t ibucket = registry_hash(name, r->displacements[igroup]) & mask;
+    int index = r->buckets[ibucket] - 1;
+    if ( index >= 0 && strncmp( name, registry_name(r, index), COMMAND_LENGTH ) == 0 ) {
+      return index;
+    }
+    return -1;
+  }
+
+  size_t ibucket = registry_hash(name, 0) & mask;
+  while ( r->buckets[ibucket] != 0 ) {
+    int index = r->buckets[ibucket] - 1;
+    if ( strncmp( name, registry_name(r, index), COMMAND_LENGTH ) == 0 ) {
+      return index;
+    }
+    ibucket = ( ibucket + 1 ) & mask;
+  }
+  return -1;
+}
+
+/*! \brief Replace the hash table of a registry with a perfect hash table
+ *
+ * The entries are divided into groups by their hash, and the groups are placed from the largest
+ * to the smallest.
+ * For each group, a displacement is chosen such that hashing the names of the group with that
+ * displacement as the seed places each entry of the group in a distinct, empty bucket.
+ * If no such displacements are found, the ordinary hash table is kept.
+ * The function returns \p 0 if a perfect hash table was built.
+ *
+ * \param [in]       r
+ *                   Pointer to the registry
  */
-int get_node_index(vector* v, const char* node_name) {
-  int inode;
-  int node_index = -1;
-  for ( inode = 0; inode < v->size; inode++ ) {
-    node* this_node = vector_get(v, inode);
-    if ( strcmp( node_name, this_node->name ) == 0 ) {
-      node_index = inode;
+int registry_freeze(registry* r) {
+  int nentries = (int)r->entries.size;
+  size_t nbuckets = 8;
+  while ( nbuckets < 2 * (size_t)nentries ) {
+    nbuckets *= 2;
+  }
+  size_t ngroups = 1;
+  while ( 4 * ngroups < (size_t)nentries ) {
+    ngroups *= 2;
+  }
+
+  int* group_of = malloc( ( nentries + 1 ) * sizeof(int) );
+  int* group_size = calloc(ngroups, sizeof(int));
+  int* members = malloc( ( nentries + 1 ) * sizeof(int) );
+  int ientry;
+  for ( ientry = 0; ientry < nentries; ientry++ ) {
+    group_of[ientry] = (int)( registry_hash(registry_name(r, ientry), 0) & ( ngroups - 1 ) );
+    group_size[ group_of[ientry] ]++;
+  }
+  int max_group_size = 0;
+  size_t igroup;
+  for ( igroup = 0; igroup < ngroups; igroup++ ) {
+    if ( group_size[igroup] > max_group_size ) {
+      max_group_size = group_size[igroup];
+    }
+  }
+
+  // try increasingly sparse tables, until the displacements of every group are found
+  int attempt;
+  int placed = 0;
+  int* buckets = NULL;
+  unsigned int* displacements = NULL;
+  for ( attempt = 0; attempt < 4; attempt++ ) {
+    free( buckets );
+    free( displacements );
+    buckets = calloc(nbuckets, sizeof(int));
+    displacements = calloc(ngroups, sizeof(unsigned int));
+    size_t mask = nbuckets - 1;
+    placed = 1;
+
+    int size;
+    for ( size = max_group_size; size > 0 && placed; size-- ) {
+      for ( igroup = 0; igroup < ngroups && placed; igroup++ ) {
+        if ( group_size[igroup] != size ) {
+          continue;
+        }
+        int nmembers = 0;
+        for ( ientry = 0; ientry < nentries; ientry++ ) {
+          if ( group_of[ientry] == (int)igroup ) {
+            members[nmembers] = ientry;
+            nmembers++;
+          }
+        }
+
+        // search for a displacement that places every member of the group
+        unsigned int displacement;
+        int found = 0;
+        for ( displacement = 1; displacement <= 4096 && ! found; displacement++ ) {
+          int imember;
+          found = 1;
+          for ( imember = 0; imember < nmembers; imember++ ) {
+            size_t ibucket = registry_hash(registry_name(r, members[imember]), displacement) & mask;
+            if ( buckets[ibucket] != 0 ) {
+              // undo the placement of the previous members
+              int jmember;
+              for ( jmember = 0; jmember < imember; jmember++ ) {
+                buckets[ registry_hash(registry_name(r, members[jmember]), displacement) & mask ] = 0;
+              }
+              found = 0;
+              break;
+            }
+            buckets[ibucket] = members[imember] + 1;
+          }
+          if ( found ) {
+            displacements[igroup] = displacement;
+          }
+        }
+        if ( ! found ) {
+          placed = 0;
+        }
+      }
     }
+    if ( placed ) {
+      break;
+    }
+    nbuckets *= 2;
+  }
+  free( group_of );
+  free( group_size );
+  free( members );
+
+  if ( ! placed ) {
+    free( buckets );
+    free( displacements );
+    return 1;
   }
-  return node_index;
+
+  free( r->buckets );
+  free( r->displacements );
+  r->buckets = buckets;
+  r->nbuckets = nbuckets;
+  r->displacements = displacements;
+  r->ngroups = ngroups;
+  r->perfect = 1;
+  return 0;
+}
+
+/*! \brief Return a pointer to an entry of a registry
+ *
+ * \param [in]       r
+ *                   Pointer to the registry
+ * \param [in]       index
+ *                   Index of the entry within the registry
+ */
+void* registry_get(registry* r, int index) {
+  return vector_get(&r->entries, index);
+}
+
+/*! \brief Free all data associated with a registry
+ *
+ * \param [in]       r
+ *                   Pointer to the registry that will be freed
+ */
+int registry_free(registry* r) {
+  vector_free(&r->entries);
+  free( r->buckets );
+  free( r->displacements );
+  return 0;
+}
+
+/*! \brief Allocate and initialize a registry of nodes
+ */
+registry* new_node_registry() {
+  registry* r = malloc(sizeof(registry));
+  registry_init(r, sizeof(node));
+  return r;
+}
+
+/*! \brief Determine the index of a node within a registry of nodes
+ *
+ * \param [in]       r
+ *                   Pointer to the registry
+ * \param [in]       node_name
+ *                   Name of the node
+ */
+int get_node_index(registry* r, const char* node_name) {
+  return registry_find(r, node_name);
 }
 
 /*! \brief Determine the index of a command within a node
@@ -182,14 +736,7 @@ int get_node_index(vector* v, const char* node_name) {
  *                   Name of the command
  */
 int get_command_index(node* n, const char* command_name) {
-  int icommand;
-  int command_index = -1;
-  for ( icommand = 0; icommand < n->commands->size; icommand++ ) {
-    if ( strcmp( command_name, vector_get( n->commands, icommand ) ) == 0 ) {
-      command_index = icommand;
-    }
-  }
-  return command_index;
+  return registry_find(n->commands, command_name);
 }
 
 /*! \brief Determine the index of a callback within a node
@@ -200,32 +747,32 @@ int get_command_index(node* n, const char* command_name) {
  *                   Name of the callback
  */
 int get_callback_index(node* n, const char* callback_name) {
-  int icallback;
-  int callback_index = -1;
-  for ( icallback = 0; icallback < n->callbacks->size; icallback++ ) {
-    if ( strcmp( callback_name, vector_get( n->callbacks, icallback ) ) == 0 ) {
-      callback_index = icallback;
-    }
-  }
-  return callback_index;
+  return registry_find(n->callbacks, callback_name);
 }
 
 
-/*! \brief Determine the index of a callback within a node
+/*! \brief Free a registry of nodes, including the commands and callbacks of each node
  */
-int free_node_vector(vector* v) {
+int free_node_registry(registry* r) {
   int inode = 0;
-  size_t nnodes = v->size;
+  size_t nnodes = r->entries.size;
   for ( inode = 0; inode < nnodes; inode++ ) {
-    node* this_node = vector_get(v, inode);
-
-    // free the "commands" and "callbacks" vectors for this node
-    vector_free(this_node->commands);
-    vector_free(this_node->callbacks);
+    node* this_node = registry_get(r, inode);
+
+    // free the "commands", "callbacks", and "handlers" registries for this node
+    registry_free(this_node->commands);
+    registry_free(this_node->callbacks);
+    free( this_node->commands );
+    free( this_node->callbacks );
+    if ( this_node->handlers != NULL ) {
+      registry_free(this_node->handlers);
+      free( this_node->handlers );
+    }
   }
 
-  // free this node vector
-  vector_free(v);
+  // free this node registry
+  registry_free(r);
+  free( r );
 
   return 0;
 }
@@ -237,38 +784,61 @@ int free_node_vector(vector* v) {
 int new_code() {
   code new_code;
   new_code.returned_comms = 0;
-  new_code.next_comm = 1;
   new_code.intra_MPI_comm = MPI_COMM_WORLD;
   new_code.language = MDI_LANGUAGE_C;
 
   // initialize the character buffer for the plugin path
   new_code.plugin_path = malloc(PLUGIN_PATH_LENGTH * sizeof(char));
   snprintf(new_code.plugin_path, PLUGIN_PATH_LENGTH, "");
+  new_code.registry_cache_path = NULL;
+  new_code.registry_cache_loaded = 0;
+
+  // initialize the node registry
+  new_code.nodes = new_node_registry();
+  new_code.registry_frozen = 0;
+  int ilist;
+  for (ilist = 0; ilist < MDI_NLISTS; ilist++) {
+    new_code.frozen_lists[ilist].data = NULL;
+  }
+
+  // command handlers respond at the first node until the code moves to another
+  new_code.current_node = 0;
 
-  // initialize the node vector
-  vector* node_vec = malloc(sizeof(vector));
-  vector_init(node_vec, sizeof(node));
-  new_code.nodes = node_vec;
+  // initialize the comms slot map
+  // communicator handles start from 1, so that they are never equal to MDI_COMM_NULL
+  slot_map* comms_map = malloc(sizeof(slot_map));
+  slot_map_init(comms_map, sizeof(communicator), 1);
+  new_code.comms = comms_map;
 
-  // initialize the comms vector
-  vector* comms_vec = malloc(sizeof(vector));
-  vector_init(comms_vec, sizeof(communicator));
-  new_code.comms = comms_vec;
+  // initialize the vector of communicators that have not been returned by MDI_Accept_Communicator
+  vector* new_comms_vec = malloc(sizeof(vector));
+  vector_init(new_comms_vec, sizeof(MDI_Comm_Type));
+  new_code.new_comms = new_comms_vec;
 
   new_code.is_library = 0;
-  new_code.id = (int)codes.size;
+  new_code.id = slot_map_next_handle(&active_context->codes);
   new_code.intra_rank = 0;
   new_code.called_set_execute_command_func = 0;
+  new_code.execute_command = NULL;
+  new_code.execute_command_obj = NULL;
+  new_code.features = MDI_FEATURE_LARGE_COUNT | MDI_FEATURE_VECTOR | MDI_FEATURE_UNITS | MDI_FEATURE_REGISTRY_KEY;
+  new_code.compress_threshold = -1;
+  new_code.nfilters = 0;
+  new_code.custom_method = -1;
+  new_code.persistent = 0;
+  new_code.driver_hostname = NULL;
+  new_code.driver_port = 0;
+  new_code.custom_state = NULL;
 
   // Set the MPI callbacks
   //new_code.mdi_mpi_recv = MPI_Recv;
   //int (*mpi4py_recv_callback)(void*, int, int, MDI_Comm_Type);
 
-  // add the new code to the global vector of codes
-  vector_push_back( &codes, &new_code );
+  // add the new code to the global slot map of codes
+  slot_map_insert( &active_context->codes, &new_code );
 
-  // return the index of the new code
-  return (int)codes.size - 1;
+  // return the handle of the new code
+  return new_code.id;
 }
 
 
@@ -276,16 +846,11 @@ int new_code() {
  * Returns a pointer to the code
  */
 code* get_code(int code_id) {
-  // Search through all of the codes for the one that matches code_id
-  int icode;
-  for (icode = 0; icode < codes.size; icode++ ) {
-    code* this_code = vector_get(&codes, icode);
-    if ( this_code->id == code_id ) {
-      return this_code;
-    }
+  code* this_code = slot_map_get(&active_context->codes, code_id);
+  if ( this_code == NULL ) {
+    mdi_error("Code not found");
   }
-  mdi_error("Code not found");
-  return NULL;
+  return this_code;
 }
 
 
@@ -293,49 +858,231 @@ code* get_code(int code_id) {
  * Returns 0 on success
  */
 int delete_code(int code_id) {
-  code* this_code = get_code(code_id);
-
-  // Search through all of the codes for the one that matches code_id
-  int icode;
-  int code_index;
-  int code_found = 0;
-  for (icode = 0; icode < codes.size; icode++ ) {
-    code* code = vector_get(&codes, icode);
-    if ( code->id == code_id ) {
-      code_found = 1;
-      code_index = icode;
-
-      // stop searching
-      icode = (int)codes.size;
-    }
-  }
-  if ( code_found != 1 ) {
+  code* this_code = slot_map_get(&active_context->codes, code_id);
+  if ( this_code == NULL ) {
     mdi_error("Code not found during delete");
     return 1;
   }
 
   // delete the plugin path
   free( this_code->plugin_path );
+  free( this_code->registry_cache_path );
+  free( this_code->driver_hostname );
+
+  // delete the node registry
+  free_node_registry(this_code->nodes);
+  int ilist;
+  for (ilist = 0; ilist < MDI_NLISTS; ilist++) {
+    free( this_code->frozen_lists[ilist].data );
+  }
+
+  // delete the comms slot map
+  size_t icomm;
+  for (icomm = 0; icomm < this_code->comms->slots.size; icomm++) {
+    communicator* this_comm = slot_map_at( this_code->comms, icomm );
+    if ( this_comm != NULL ) {
+      delete_communicator(code_id, this_comm->id);
+    }
+  }
+  slot_map_free( this_code->comms );
+  free( this_code->comms );
+  vector_free( this_code->new_comms );
+  free( this_code->new_comms );
+
+  // delete the data for this code from the global slot map of codes
+  slot_map_delete(&active_context->codes, code_id);
+
+  // once no codes remain, the buffers retained by the pool are no longer needed
+  if ( active_context->codes.size == 0 ) {
+    pool_release();
+  }
+
+  return 0;
+}
+
+
+/*! \brief Acquire the lock that serializes the creation and deletion of contexts
+ */
+static void lock_contexts() {
+#ifdef _WIN32
+  AcquireSRWLockExclusive(&contexts_lock);
+#else
+  pthread_mutex_lock(&contexts_lock);
+#endif
+}
+
 
-  // delete the node vector
-  free_node_vector(this_code->nodes);
+/*! \brief Release the lock that serializes the creation and deletion of contexts
+ */
+static void unlock_contexts() {
+#ifdef _WIN32
+  ReleaseSRWLockExclusive(&contexts_lock);
+#else
+  pthread_mutex_unlock(&contexts_lock);
+#endif
+}
+
+
+/*! \brief Return the context that corresponds to a context handle, or NULL if there is none
+ *
+ * The caller must hold contexts_lock.
+ *
+ * \param [in]       context_id
+ *                   Handle of the context.
+ */
+static mdi_context* find_context_locked(int context_id) {
+  if ( context_id < 0 ) {
+    return NULL;
+  }
+  mdi_context* this_context = contexts[ context_id & ( MDI_MAX_CONTEXTS - 1 ) ];
+  if ( this_context == NULL || this_context->id != context_id ) {
+    return NULL;
+  }
+  return this_context;
+}
+
+
+/*! \brief Return the context that corresponds to a context handle, or NULL if there is none
+ *
+ * \param [in]       context_id
+ *                   Handle of the context.
+ */
+static mdi_context* find_context(int context_id) {
+  lock_contexts();
+  mdi_context* this_context = find_context_locked(context_id);
+  unlock_contexts();
+  return this_context;
+}
+
+
+/*! \brief Create a new context, which holds library state that is independent of any other context
+ *
+ * The function returns \p 0 on a success.
+ *
+ * \param [out]      context_id
+ *                   On return, the handle of the new context.
+ */
+int new_context(int* context_id) {
+  mdi_context* new_ctx = calloc(1, sizeof(mdi_context));
+  if ( new_ctx == NULL ) {
+    mdi_error("Unable to allocate context");
+    return 1;
+  }
+  new_ctx->tcp_socket = -1;
+
+  lock_contexts();
+  int index = 1;
+  while ( index < MDI_MAX_CONTEXTS && contexts[index] != NULL ) {
+    index++;
+  }
+  if ( index == MDI_MAX_CONTEXTS ) {
+    unlock_contexts();
+    free( new_ctx );
+    mdi_error("Unable to create context: too many contexts");
+    return 1;
+  }
+  new_ctx->id = ( context_generations[index] << CONTEXT_INDEX_BITS ) | index;
+  contexts[index] = new_ctx;
+  unlock_contexts();
+
+  *context_id = new_ctx->id;
+  return 0;
+}
+
+
+/*! \brief Delete a context, together with all of the codes and communicators in it
+ *
+ * The default context and the context that is active on the calling thread cannot be deleted.
+ * The context is removed from the list of contexts before it is torn down, so if several threads
+ * delete the same context, only one of them succeeds.
+ * The function returns \p 0 on a success.
+ *
+ * \param [in]       context_id
+ *                   Handle of the context.
+ */
+int delete_context(int context_id) {
+  lock_contexts();
+  mdi_context* this_context = find_context_locked(context_id);
+  if ( this_context == NULL ) {
+    unlock_contexts();
+    mdi_error("Context not found during delete");
+    return 1;
+  }
+  if ( this_context == &default_context || this_context == active_context ) {
+    unlock_contexts();
+    mdi_error("Unable to delete the default context or the active context");
+    return 1;
+  }
 
-  // delete the comms vector
-  int icomm;
-  size_t ncomms = this_code->comms->size;
-  for (icomm = 0; icomm < ncomms; icomm++) {
-    communicator* this_comm = vector_get( this_code->comms, (int)this_code->comms->size - 1 );
-    delete_communicator(code_id, this_comm->id);
+  // remove the context from the list of contexts, so that its handle is no longer valid
+  int index = context_id & ( MDI_MAX_CONTEXTS - 1 );
+  contexts[index] = NULL;
+  context_generations[index] = ( context_generations[index] + 1 ) & CONTEXT_GENERATION_MASK;
+  unlock_contexts();
+
+  // delete the state of the context, from within the context
+  mdi_context* previous = active_context;
+  active_context = this_context;
+  // delete any resident plugin engines while their drivers still exist, and close the plugins
+  library_free_plugins();
+  ensemble_free_partition();
+  if ( this_context->is_initialized ) {
+    size_t icode;
+    for ( icode = 0; icode < this_context->codes.slots.size; icode++ ) {
+      code* this_code = slot_map_at(&this_context->codes, icode);
+      if ( this_code != NULL ) {
+        delete_code(this_code->id);
+      }
+    }
+    slot_map_free(&this_context->codes);
   }
-  vector_free( this_code->comms );
+  if ( this_context->requests_initialized ) {
+    vector_free(&this_context->requests);
+  }
+  regcache_free();
+  tcp_stop_listening();
+  pool_release();
+  active_context = previous;
+
+  free( this_context );
+  return 0;
+}
 
-  // delete the data for this code from the global vector of codes
-  vector_delete(&codes, code_index);
 
+/*! \brief Make a context active on the calling thread
+ *
+ * The function returns \p 0 on a success.
+ *
+ * \param [in]       context_id
+ *                   Handle of the context.
+ * \param [out]      previous
+ *                   If not NULL, on return, the context that was previously active, which can be
+ *                   restored with leave_context.
+ */
+int enter_context(int context_id, mdi_context** previous) {
+  mdi_context* this_context = find_context(context_id);
+  if ( this_context == NULL ) {
+    mdi_error("Context not found");
+    return 1;
+  }
+  if ( previous != NULL ) {
+    *previous = active_context;
+  }
+  active_context = this_context;
   return 0;
 }
 
 
+/*! \brief Restore the context that was active before a call to enter_context
+ *
+ * \param [in]       previous
+ *                   The context returned by enter_context.
+ */
+void leave_context(mdi_context* previous) {
+  active_context = previous;
+}
+
+
 /*! \brief Create a new communicator structure and add it to the list of communicators
  * Returns the handle of the new communicator
  */
@@ -344,19 +1091,36 @@ int new_communicator(int code_id, int method) {
 
   communicator new_comm;
   new_comm.method = method;
-  vector* node_vec = malloc(sizeof(vector));
-  vector_init(node_vec, sizeof(node));
-  new_comm.nodes = node_vec;
-  new_comm.id = this_code->next_comm;
+  new_comm.nodes = new_node_registry();
+  new_comm.shared_nodes = 0;
+  new_comm.id = slot_map_next_handle(this_code->comms);
   new_comm.code_id = code_id;
   new_comm.mdi_version[0] = 0;
   new_comm.mdi_version[1] = 0;
   new_comm.mdi_version[2] = 0;
-  this_code->next_comm++;
-
+  new_comm.features = 0;
+  new_comm.command[0] = '\0';
+  new_comm.command_msg = 0;
+  new_comm.delta_frames = NULL;
+  new_comm.broken = 0;
+
+  new_comm.send_strided = NULL;
+  new_comm.recv_strided = NULL;
+  new_comm.send_vector = NULL;
+  new_comm.recv_vector = NULL;
+  new_comm.partial_body = 0;
+  new_comm.returned = 0;
   new_comm.delete = communicator_delete;
 
-  vector_push_back( this_code->comms, &new_comm );
+  // attach the filters selected by the code
+  filter_attach_code_filters(this_code, &new_comm);
+
+  // if the communicator cannot be stored, return a null handle
+  if ( slot_map_insert( this_code->comms, &new_comm ) < 0 ) {
+    free_node_registry(new_comm.nodes);
+    return 0;
+  }
+  vector_push_back( this_code->new_comms, &new_comm.id );
 
   return new_comm.id;
 }
@@ -367,17 +1131,15 @@ int new_communicator(int code_id, int method) {
  */
 communicator* get_communicator(int code_id, MDI_Comm_Type comm_id) {
   code* this_code = get_code(code_id);
+  if ( this_code == NULL ) {
+    return NULL;
+  }
 
-  // Search through all of the communicators for the one that matches comm_id
-  int icomm;
-  for (icomm = 0; icomm < this_code->comms->size; icomm++ ) {
-    communicator* comm = vector_get(this_code->comms, icomm);
-    if ( comm->id == comm_id ) {
-      return comm;
-    }
+  communicator* comm = slot_map_get(this_code->comms, comm_id);
+  if ( comm == NULL ) {
+    mdi_error("Communicator not found");
   }
-  mdi_error("Communicator not found");
-  return NULL;
+  return comm;
 }
 
 
@@ -386,23 +1148,8 @@ communicator* get_communicator(int code_id, MDI_Comm_Type comm_id) {
  */
 int delete_communicator(int code_id, MDI_Comm_Type comm_id) {
   code* this_code = get_code(code_id);
-  communicator* this_comm = get_communicator(code_id, comm_id);
-
-  // Search through all of the communicators for the one that matches comm_id
-  size_t icomm;
-  size_t comm_index;
-  int comm_found = 0;
-  for (icomm = 0; icomm < this_code->comms->size; icomm++ ) {
-    communicator* comm = vector_get(this_code->comms, (int)icomm);
-    if ( comm->id == comm_id ) {
-      comm_found = 1;
-      comm_index = icomm;
-
-      // stop searching
-      icomm = this_code->comms->size;
-    }
-  }
-  if ( comm_found != 1 ) {
+  communicator* this_comm = slot_map_get(this_code->comms, comm_id);
+  if ( this_comm == NULL ) {
     mdi_error("Communicator not found during delete"); 
     return 1;
   }
@@ -410,11 +1157,16 @@ int delete_communicator(int code_id, MDI_Comm_Type comm_id) {
   // do any method-specific deletion operations
   this_comm->delete(this_comm);
 
-  // delete the node vector
-  free_node_vector(this_comm->nodes);
+  // delete the node registry, unless it is shared through the registry cache
+  if ( ! this_comm->shared_nodes ) {
+    free_node_registry(this_comm->nodes);
+  }
+
+  // delete any frames stored by the delta codec
+  delta_free(this_comm);
 
-  // delete the data for this communicator from the code's vector of communicators
-  vector_delete(this_code->comms, (int)comm_index);
+  // delete the data for this communicator from the code's slot map of communicators
+  slot_map_delete(this_code->comms, comm_id);
 
   return 0;
 }
@@ -7,6 +7,7 @@
 #define MDI_GLOBAL
 
 #include <mpi.h>
+#include <stdint.h>
 
 #ifdef _WIN32
   #include <winsock2.h>
@@ -21,11 +22,58 @@
   #define mdi_strdup strdup
 #endif
 
+#ifdef _WIN32
+  #define MDI_THREAD_LOCAL __declspec(thread)
+#else
+  #define MDI_THREAD_LOCAL __thread
+#endif
+
 // Hard-coded values
 #define COMMAND_LENGTH 12
 #define NAME_LENGTH 12
 #define PLUGIN_PATH_LENGTH 2048
 
+// Message header layout
+#define MDI_HEADER_LENGTH 4
+#define MDI_HEADER_LENGTH_EXT 8
+
+// Header type flags, describing how the body of a message is encoded
+#define MDI_HEADER_KEYFRAME 1
+#define MDI_HEADER_DELTA 2
+#define MDI_HEADER_COMPRESS 4
+#define MDI_HEADER_FLOAT32 8
+#define MDI_HEADER_BFLOAT16 16
+
+// Header type flag indicating that the message consists of several segments, which are
+// described by a table that follows the extended header
+#define MDI_HEADER_VECTOR 32
+
+// Largest number of segments in a vectored message
+#define MDI_VECTOR_MAX_SEGMENTS 64
+
+// Number of header entries that describe each segment of a vectored message
+#define MDI_VECTOR_ENTRY_LENGTH 3
+
+// Header type flag indicating that the body of a message is in the unit whose identifier is
+// stored in the last entry of the extended header, rather than in atomic units
+#define MDI_HEADER_UNITS 64
+
+// Header type flags indicating that the body of a message is not sent in its native format
+#define MDI_HEADER_ENCODED ( MDI_HEADER_DELTA | MDI_HEADER_COMPRESS | MDI_HEADER_FLOAT32 | MDI_HEADER_BFLOAT16 )
+
+// Optional features that are negotiated between codes when a communicator is created
+#define MDI_FEATURE_DELTA 1
+#define MDI_FEATURE_COMPRESS 2
+#define MDI_FEATURE_FLOAT32 4
+#define MDI_FEATURE_BFLOAT16 8
+#define MDI_FEATURE_LARGE_COUNT 16
+#define MDI_FEATURE_VECTOR 32
+#define MDI_FEATURE_UNITS 64
+#define MDI_FEATURE_REGISTRY_KEY 128
+
+// Optional features that encode the body of a message, and therefore require a contiguous buffer
+#define MDI_FEATURE_CODECS ( MDI_FEATURE_DELTA | MDI_FEATURE_COMPRESS | MDI_FEATURE_FLOAT32 | MDI_FEATURE_BFLOAT16 )
+
 // Defined languages
 #define MDI_LANGUAGE_C 1
 #define MDI_LANGUAGE_FORTRAN 2
@@ -46,6 +94,104 @@ typedef struct dynamic_array_struct {
   size_t size; //number of elements actually stored
 } vector;
 
+// Number of bits of a slot map handle that hold the index of its slot
+#define SLOT_MAP_INDEX_BITS 20
+
+// Mask for the bits of a slot map handle that hold the index of its slot
+#define SLOT_MAP_INDEX_MASK ( ( 1 << SLOT_MAP_INDEX_BITS ) - 1 )
+
+// Mask for the generation of a slot, which is stored in the remaining bits of a handle
+#define SLOT_MAP_GENERATION_MASK ( ( 1 << ( 31 - SLOT_MAP_INDEX_BITS ) ) - 1 )
+
+typedef struct registry_struct {
+  /*! \brief The entries of this registry, in the order in which they were registered.
+  Each entry begins with its name, which has at most COMMAND_LENGTH characters. */
+  vector entries;
+  /*! \brief Open-addressing hash table of the entries, keyed on their names.
+  Each bucket holds the index of an entry plus one, or 0 if the bucket is empty. */
+  int* buckets;
+  /*! \brief Number of buckets, which is a power of two */
+  size_t nbuckets;
+  /*! \brief Flag whether the hash table is perfect, so that each entry is found in the bucket
+  selected by its displacement, without probing */
+  int perfect;
+  /*! \brief For a perfect hash table, the seed used to hash the names of each group of entries */
+  unsigned int* displacements;
+  /*! \brief For a perfect hash table, the number of groups of entries, which is a power of two */
+  size_t ngroups;
+} registry;
+
+// Builtin lists that describe the registry of a code
+#define MDI_LIST_COMMANDS 0
+#define MDI_LIST_CALLBACKS 1
+#define MDI_LIST_NODES 2
+#define MDI_NLISTS 3
+
+typedef struct name_list_struct {
+  /*! \brief The padded, delimited names that form the list, or NULL if the list must be formed again */
+  char* data;
+  /*! \brief Number of characters in the list */
+  int count;
+  /*! \brief Number of commands or callbacks in the list */
+  int nnames;
+} name_list;
+
+typedef struct slot_struct {
+  /*! \brief The element stored in this slot, which is allocated when the slot is first used */
+  void* element;
+  /*! \brief Number of times the element stored in this slot has been deleted */
+  int generation;
+  /*! \brief Flag whether this slot currently holds an element */
+  int occupied;
+} slot;
+
+typedef struct slot_map_struct {
+  /*! \brief The slots of this slot map */
+  vector slots;
+  /*! \brief Indices of the slots that do not currently hold an element */
+  vector free_slots;
+  /*! \brief Size of each element */
+  size_t stride;
+  /*! \brief Handle of the first element stored in this slot map */
+  int base;
+  /*! \brief Number of elements actually stored */
+  size_t size;
+} slot_map;
+
+// The smallest size class of the buffer pool holds 2^POOL_MIN_CLASS_BITS bytes
+#define POOL_MIN_CLASS_BITS 6
+
+// Number of size classes of the buffer pool, each of which is twice the size of the previous one
+// Larger buffers are allocated and freed directly
+#define POOL_NCLASSES 20
+
+// Largest number of free buffers retained by each size class of the buffer pool
+#define POOL_DEPTH 4
+
+// Size of the header that precedes each buffer of the pool, which preserves the alignment of malloc
+#define POOL_HEADER_BYTES 16
+
+typedef struct pool_class_struct {
+  /*! \brief Free buffers of this size class, including their headers */
+  void* free_blocks[POOL_DEPTH];
+  /*! \brief Number of free buffers */
+  int nfree;
+} pool_class;
+
+struct strided_desc_struct;
+
+// Largest number of filter stages that may be attached to a communicator or code
+#define MDI_MAX_FILTERS 8
+
+typedef struct filter_stage_struct {
+  /*! \brief Function that may replace the body of each message sent, or NULL */
+  int (*on_send)(const void**, int64_t, MDI_Datatype_Type, MDI_Comm_Type, void*);
+  /*! \brief Function that may transform the body of each message received in place, or NULL */
+  int (*on_recv)(void*, int64_t, MDI_Datatype_Type, MDI_Comm_Type, void*);
+  /*! \brief Pointer passed to each call of on_send and on_recv */
+  void* state;
+} filter_stage;
+
 typedef struct communicator_struct {
   /*! \brief Communication method used by this communicator */
   int method;
@@ -58,13 +204,50 @@ typedef struct communicator_struct {
   /*! \brief The MDI version of the connected code */
   int mdi_version[3];
   /*! \brief The nodes supported by the connected code */
-  vector* nodes;
+  registry* nodes;
+  /*! \brief Flag whether nodes is a shared copy held by the registry cache of the context,
+  rather than a registry owned by this communicator */
+  int shared_nodes;
+  /*! \brief Optional features that both this code and the connected code support */
+  int features;
+  /*! \brief Most recent command sent or received through this communicator */
+  char command[COMMAND_LENGTH];
+  /*! \brief Number of messages sent or received since the most recent command */
+  int command_msg;
+  /*! \brief Previous frames sent or received through this communicator, used by the delta codec */
+  vector* delta_frames;
   /*! \brief Method-specific information for this communicator */
   void* method_data;
   /*! \brief Function pointer for method-specific send operations */
-  int (*send)(const void*, int, MDI_Datatype_Type, MDI_Comm_Type, int);
+  int (*send)(const void*, size_t, MDI_Datatype_Type, MDI_Comm_Type, int);
   /*! \brief Function pointer for method-specific receive operations */
-  int (*recv)(void*, int, MDI_Datatype_Type, MDI_Comm_Type, int);
+  int (*recv)(void*, size_t, MDI_Datatype_Type, MDI_Comm_Type, int);
+  /*! \brief Function pointer for method-specific operations that send the body of a message
+  from a strided array, or NULL if the method has no such operation */
+  int (*send_strided)(const void*, const struct strided_desc_struct*, MDI_Datatype_Type, MDI_Comm_Type);
+  /*! \brief Function pointer for method-specific operations that receive the body of a message
+  into a strided array, or NULL if the method has no such operation */
+  int (*recv_strided)(void*, const struct strided_desc_struct*, MDI_Datatype_Type, MDI_Comm_Type);
+  /*! \brief Function pointer for method-specific operations that send the body of a vectored
+  message from several buffers, or NULL if the method has no such operation */
+  int (*send_vector)(int, const void* const*, const size_t*, MDI_Comm_Type);
+  /*! \brief Function pointer for method-specific operations that receive the body of a vectored
+  message into several buffers, or NULL if the method has no such operation */
+  int (*recv_vector)(int, void* const*, const size_t*, MDI_Comm_Type);
+  /*! \brief Flag whether the body of a message may be transferred through several calls to send
+  or recv, each covering consecutive elements of the body */
+  int partial_body;
+  /*! \brief Flag whether the communicator has already been returned to the code, so that
+  MDI_Accept_Communicator must not return it */
+  int returned;
+  /*! \brief Flag whether the connection broke while a message was sent or received through it,
+  so that a persistent engine can replace it */
+  int broken;
+  /*! \brief Filter stages through which the body of each message passes, in the order in which
+  they transform sent messages */
+  filter_stage filters[MDI_MAX_FILTERS];
+  /*! \brief Number of filter stages attached to this communicator */
+  int nfilters;
   /*! \brief Function pointer for method-specific deletion operations */
   int (*delete)(void*);
 } communicator;
@@ -72,12 +255,23 @@ typedef struct communicator_struct {
 typedef struct node_struct {
   /*! \brief Name of the node */
   char name[COMMAND_LENGTH];
-  /*! \brief Vector containing all the commands supported at this node */
-  vector* commands;
-  /*! \brief Vector containing all the callbacks associated with this node */
-  vector* callbacks;
+  /*! \brief Registry containing all the commands supported at this node */
+  registry* commands;
+  /*! \brief Registry containing all the callbacks associated with this node */
+  registry* callbacks;
+  /*! \brief Registry containing the command handlers of this node, or NULL if none have been registered */
+  registry* handlers;
 } node;
 
+typedef struct command_handler_struct {
+  /*! \brief Name of the command */
+  char name[COMMAND_LENGTH];
+  /*! \brief Function that responds to the command */
+  int (*handler)(const char*, MDI_Comm_Type, void*);
+  /*! \brief Pointer that is passed to each call of handler */
+  void* ctx;
+} command_handler;
+
 typedef struct code_struct {
   /*! \brief Name of the driver/engine */
   char name[NAME_LENGTH];
@@ -85,28 +279,59 @@ typedef struct code_struct {
   char role[NAME_LENGTH];
   /*! \brief Handle for this code */
   int id;
-  /*! \brief The number of communicator handles that have been returned by MDI_Accept_Connection() */
+  /*! \brief The number of entries of new_comms that have been returned by MDI_Accept_Connection() */
   int returned_comms;
-  /*! \brief The handle of the next communicator */
-  int next_comm;
+  /*! \brief Handles of the communicators that have not yet been returned by MDI_Accept_Connection() */
+  vector* new_comms;
   /*! \brief Native language of this code */
   int language;
   /*! \brief Rank of this process within its associated code */
   int intra_rank;
   /*! \brief Flag whether this code has called set_execute_command_func */
   int called_set_execute_command_func;
+  /*! \brief Optional features this code is willing to negotiate with connected codes */
+  int features;
+  /*! \brief Minimum size, in bytes, of a message body that is compressed (-1 to calibrate automatically) */
+  long compress_threshold;
   /*! \brief MPI intra-communicator that spans all ranks associated with this code */
   MPI_Comm intra_MPI_comm;
-  /*! \brief Vector containing all nodes supported by this code */
-  vector* nodes;
-  /*! \brief Vector containing all communicators associated with this code */
-  vector* comms;
+  /*! \brief Registry containing all nodes supported by this code */
+  registry* nodes;
+  /*! \brief Flag whether MDI_Freeze_Registry() has been called by this code */
+  int registry_frozen;
+  /*! \brief If the registry is frozen, the lists that are sent in reply to the builtin
+  commands that query the registry, indexed by MDI_LIST_COMMANDS, MDI_LIST_CALLBACKS, and MDI_LIST_NODES */
+  name_list frozen_lists[MDI_NLISTS];
+  /*! \brief Slot map containing all communicators associated with this code */
+  slot_map* comms;
   /*! \brief Path to the plugins available to this code */
   char* plugin_path;
+  /*! \brief Path to the file in which the registries of connected codes are cached, or NULL */
+  char* registry_cache_path;
+  /*! \brief Flag whether the file at registry_cache_path has been read */
+  int registry_cache_loaded;
   /*! \brief Function pointer to the generic execute_command_function */
   int (*execute_command)(const char*, MDI_Comm_Type, void*);
   /*! \brief Pointer to the class object that is passed to any call to execute_command */
   void* execute_command_obj;
+  /*! \brief Index of the node at which this code responds to commands through its command handlers.
+  The code moves to a node when it responds to the name of the node. */
+  int current_node;
+  /*! \brief Indices of the registered filters selected by the -filter option, which are attached
+  to each new communicator of this code */
+  int filters[MDI_MAX_FILTERS];
+  /*! \brief Number of filters selected by the -filter option */
+  int nfilters;
+  /*! \brief Index of the registered method used by this code, or -1 if it uses a builtin method */
+  int custom_method;
+  /*! \brief State returned by the init function of the registered method used by this code */
+  void* custom_state;
+  /*! \brief Flag whether this engine connects to a new driver after each driver sends EXIT */
+  int persistent;
+  /*! \brief Hostname of the driver to which this engine connects through TCP, or NULL */
+  char* driver_hostname;
+  /*! \brief Port of the driver to which this engine connects through TCP */
+  int driver_port;
   /*! \brief Flag whether this code is being used as a library
   0: Not a library
   1: Is an ENGINE library, but has not connected to the driver
@@ -114,25 +339,86 @@ typedef struct code_struct {
   int is_library;
 } code;
 
-/*! \brief Vector containing all codes that have been initiailized on this rank Typically, 
-this will only include a single code, unless the communication method is LIBRARY */
-extern vector codes;
-
-/*! \brief Index of the active code */
-extern int current_code;
-
-/*! \brief Flag for whether MDI is running in i-PI compatibility mode */
-extern int ipi_compatibility;
+// Number of bits of a context handle that hold the index of the context
+#define CONTEXT_INDEX_BITS 14
+
+// Largest number of contexts that can exist at the same time, including the default context
+#define MDI_MAX_CONTEXTS ( 1 << CONTEXT_INDEX_BITS )
+
+// Mask for the generation of a context, which is stored in the remaining bits of its handle
+#define CONTEXT_GENERATION_MASK ( ( 1 << ( 31 - CONTEXT_INDEX_BITS ) ) - 1 )
+
+struct async_plugin_struct;
+
+typedef struct ensemble_partition_struct {
+  /*! \brief Flag whether the partition has been created */
+  int initialized;
+  /*! \brief MPI communicator that was partitioned */
+  MPI_Comm parent;
+  /*! \brief Number of ranks, at the start of parent, that run the driver */
+  int driver_nranks;
+  /*! \brief Number of ranks that run each plugin instance */
+  int plugin_nranks;
+  /*! \brief Duplicate of parent, through which tasks are assigned */
+  MPI_Comm task_comm;
+  /*! \brief MPI intra-communicator of the drivers, or of the plugin instance, that includes this rank */
+  MPI_Comm intra_comm;
+} ensemble_partition;
+
+typedef struct context_struct {
+  /*! \brief Slot map containing all codes that have been initiailized in this context on this rank.
+  Typically, this will only include a single code, unless the communication method is LIBRARY */
+  slot_map codes;
+  /*! \brief Index of the active code */
+  int current_code;
+  /*! \brief Flag for whether MDI is running in i-PI compatibility mode */
+  int ipi_compatibility;
+  /*! \brief Flag for whether MDI has been previously initialized */
+  int is_initialized;
+  /*! \brief Flag for whether MDI is currently operating in plugin mode */
+  int plugin_mode;
+  /*! \brief Flag for whether the driver node callback of a resident plugin engine is running */
+  int plugin_resident;
+  /*! \brief Whether MDI_Launch_plugin keeps plugins loaded: MDI_PLUGIN_UNLOAD, MDI_PLUGIN_RESIDENT,
+  or MDI_PLUGIN_KEEPALIVE */
+  int plugin_cache_mode;
+  /*! \brief Vector containing the plugins that remain loaded between launches */
+  vector plugin_cache;
+  /*! \brief Flag whether the plugin cache has been initialized */
+  int plugin_cache_initialized;
+  /*! \brief Plugin launched by MDI_Launch_plugin_async, if this context was created for its engine */
+  struct async_plugin_struct* async_plugin;
+  /*! \brief How MDI_Launch_plugin_async runs engines: MDI_ASYNC_THREAD or MDI_ASYNC_COROUTINE */
+  int async_mode;
+  /*! \brief Size, in bytes, of the stack of each engine launched by MDI_Launch_plugin_async,
+  or 0 for the default */
+  size_t async_stack_size;
+  /*! \brief Partition of the ranks that was most recently used by MDI_Launch_plugin_ensemble */
+  ensemble_partition ensemble;
+  /*! \brief Socket over which a driver will listen for incoming connections */
+  sock_t tcp_socket;
+  /*! \brief Vector containing all persistent requests.
+  The handle of a request is its index in this vector, plus one. */
+  vector requests;
+  /*! \brief Flag whether the vector of requests has been initialized */
+  int requests_initialized;
+  /*! \brief Vector containing the registries of connected codes, each of which is shared by
+  every communicator to a code with the same name, MDI version, and registry */
+  vector registry_cache;
+  /*! \brief Flag whether the registry cache has been initialized */
+  int registry_cache_initialized;
+  /*! \brief Free buffers retained by the buffer pool, by size class */
+  pool_class pool_classes[POOL_NCLASSES];
+  /*! \brief Handle of this context */
+  int id;
+} mdi_context;
 
-/*! \brief Flag for whether MDI has been previously initialized */
-extern int is_initialized;
+/*! \brief Context whose state is used by the MDI calls of this thread */
+extern MDI_THREAD_LOCAL mdi_context* active_context;
 
 /*! \brief Flag for whether MDI called MPI_Init */
 extern int initialized_mpi;
 
-/*! \brief Flag for whether MDI is currently operating in plugin mode */
-extern int plugin_mode;
-
 /*! \brief Internal copy of MPI_COMM_WORLD, used when MDI initializes MPI */
 extern MPI_Comm mdi_mpi_comm_world;
 
@@ -163,10 +449,35 @@ void* vector_get(vector* v, int index);
 int vector_delete(vector* v, int index);
 int vector_free(vector* v);
 
-int get_node_index(vector* v, const char* node_name);
+int slot_map_init(slot_map* m, size_t stride, int base);
+int slot_map_insert(slot_map* m, void* element);
+void* slot_map_get(slot_map* m, int handle);
+void* slot_map_at(slot_map* m, size_t index);
+int slot_map_next_handle(slot_map* m);
+int slot_map_delete(slot_map* m, int handle);
+int slot_map_free(slot_map* m);
+
+void* pool_alloc(size_t nbytes);
+void pool_free(void* buf);
+int pool_release();
+
+int registry_init(registry* r, size_t stride);
+int registry_add(registry* r, void* entry);
+int registry_find(registry* r, const char* name);
+int registry_freeze(registry* r);
+void* registry_get(registry* r, int index);
+int registry_free(registry* r);
+
+registry* new_node_registry();
+int get_node_index(registry* r, const char* node_name);
 int get_command_index(node* n, const char* command_name);
 int get_callback_index(node* n, const char* callback_name);
-int free_node_vector(vector* v);
+int free_node_registry(registry* r);
+
+int new_context(int* context_id);
+int delete_context(int context_id);
+int enter_context(int context_id, mdi_context** previous);
+void leave_context(mdi_context* previous);
 
 int new_communicator(int code_id, int method);
 communicator* get_communicator(int code_id, MDI_Comm_Type comm_id);
@@ -12,6 +12,7 @@
 #include "mdi_lib.h"
 #include "mdi_global.h"
 #include "mdi_general.h"
+#include "mdi_datatype.h"
 
 #ifdef _WIN32
 #include <windows.h>
@@ -20,16 +21,19 @@
 #endif
 
 
-/*! \brief Launch an MDI plugin
+/*! \brief Load a plugin library and its initialization function
+ *
+ * The function returns \p 0 on a success.
  *
+ * \param [in]       plugin_name
+ *                   Name of the plugin.
+ * \param [out]      handle_ptr
+ *                   Handle of the loaded plugin library.
+ * \param [out]      init_ptr
+ *                   The plugin's initialization function.
  */
-int library_launch_plugin(const char* plugin_name, const char* options, void* mpi_comm_ptr,
-                          MDI_Driver_node_callback_t driver_node_callback,
-                          void* driver_callback_object) {
-  int ret;
-  int driver_code_id = current_code;
-  code* this_code = get_code(driver_code_id);
-  MPI_Comm mpi_comm = *(MPI_Comm*) mpi_comm_ptr;
+int library_open_plugin(const char* plugin_name, void** handle_ptr, MDI_Plugin_init_t* init_ptr) {
+  code* this_code = get_code(active_context->current_code);
 
   // Note: Eventually, should probably replace this code with libltdl
   // Get the path to the plugin
@@ -48,11 +52,13 @@ int library_launch_plugin(const char* plugin_name, const char* options, void* mp
   if ( ! plugin_handle ) {
     // Unable to find the plugin library
     mdi_error("Unable to open MDI plugin");
+    free( plugin_init_name );
     return -1;
   }
 
   // Load a plugin's initialization function
   MDI_Plugin_init_t plugin_init = (MDI_Plugin_init_t) (intptr_t) GetProcAddress( plugin_handle, plugin_init_name );
+  free( plugin_init_name );
   if ( ! plugin_init ) {
     mdi_error("Unable to load MDI plugin init function");
     FreeLibrary( plugin_handle );
@@ -68,16 +74,18 @@ int library_launch_plugin(const char* plugin_name, const char* options, void* mp
     // Attempt to open a library with a .dylib extension
     snprintf(plugin_path, PLUGIN_PATH_LENGTH, "%s/lib%s.dylib", this_code->plugin_path, plugin_name);
     plugin_handle = dlopen(plugin_path, RTLD_NOW);
-    free( plugin_path );
-    if ( ! plugin_handle ) {
-      // Unable to find the plugin library
-      mdi_error("Unable to open MDI plugin");
-      return -1;
-    }
+  }
+  free( plugin_path );
+  if ( ! plugin_handle ) {
+    // Unable to find the plugin library
+    mdi_error("Unable to open MDI plugin");
+    free( plugin_init_name );
+    return -1;
   }
 
   // Load a plugin's initialization function
   MDI_Plugin_init_t plugin_init = (MDI_Plugin_init_t) (intptr_t) dlsym(plugin_handle, plugin_init_name);
+  free( plugin_init_name );
   if ( ! plugin_init ) {
     mdi_error("Unable to load MDI plugin init function");
     dlclose( plugin_handle );
@@ -85,19 +93,141 @@ int library_launch_plugin(const char* plugin_name, const char* options, void* mp
   }
 #endif
 
-  // free memory from loading the plugin's initialization function
-  free( plugin_init_name );
+  *handle_ptr = (void*) plugin_handle;
+  *init_ptr = plugin_init;
+  return 0;
+}
+
+
+/*! \brief Close a plugin library
+ *
+ * \param [in]       handle
+ *                   Handle of the plugin library.
+ */
+void library_close_plugin(void* handle) {
+#ifdef _WIN32
+  FreeLibrary( (HINSTANCE) handle );
+#else
+  dlclose( handle );
+#endif
+}
+
+
+/*! \brief Return the index of a plugin in the plugin cache of the active context, or -1 if it is not loaded
+ *
+ * \param [in]       plugin_name
+ *                   Name of the plugin.
+ */
+static int library_find_plugin(const char* plugin_name) {
+  if ( ! active_context->plugin_cache_initialized ) {
+    return -1;
+  }
+  size_t ientry;
+  for (ientry = 0; ientry < active_context->plugin_cache.size; ientry++) {
+    plugin_entry* entry = vector_get(&active_context->plugin_cache, ientry);
+    if ( strncmp(entry->name, plugin_name, PLUGIN_PATH_LENGTH) == 0 ) {
+      return (int) ientry;
+    }
+  }
+  return -1;
+}
+
+
+/*! \brief Call the driver node callback for the engine of a resident plugin
+ *
+ * The engine already exists, so the callback is called directly, rather than from the engine's
+ * first call to MDI_Recv_command, and each command is executed through the engine's handlers.
+ * The function returns \p 0 on a success.
+ *
+ * \param [in]       entry
+ *                   Plugin cache entry of the plugin.
+ * \param [in]       mpi_comm
+ *                   MPI intra-communicator for the engine.
+ * \param [in]       driver_node_callback
+ *                   Function pointer to the driver node's callback function.
+ * \param [in]       driver_callback_object
+ *                   Pointer to the class object that is passed to driver_node_callback.
+ */
+static int library_run_resident(plugin_entry* entry, MPI_Comm mpi_comm,
+                                MDI_Driver_node_callback_t driver_node_callback,
+                                void* driver_callback_object) {
+  int driver_code_id = active_context->current_code;
+  if ( entry->driver_code != driver_code_id ) {
+    mdi_error("Error in MDI_Launch_plugin: The plugin engine is resident in another driver");
+    return -1;
+  }
+  communicator* driver_comm = get_communicator(driver_code_id, entry->comm);
+  library_data* libd = (library_data*) driver_comm->method_data;
+  if ( libd->mpi_comm != mpi_comm ) {
+    mdi_error("Error in MDI_Launch_plugin: The plugin engine is resident on another MPI communicator");
+    return -1;
+  }
+
+  // Set the driver callback function to be used by this launch
+  libd->driver_callback_obj = driver_callback_object;
+  libd->driver_node_callback = driver_node_callback;
+
+  active_context->plugin_mode = 1;
+  active_context->plugin_resident = 1;
+  int ret = driver_node_callback(&libd->mpi_comm, entry->comm, driver_callback_object);
+  active_context->plugin_resident = 0;
+  active_context->plugin_mode = 0;
+  active_context->current_code = driver_code_id;
+  if ( ret != 0 ) {
+    mdi_error("MDI driver node callback returned non-zero exit code");
+    return -1;
+  }
+  return 0;
+}
+
+
+/*! \brief Launch an MDI plugin
+ *
+ * Depending on the plugin cache mode of the active context, the plugin remains loaded afterwards,
+ * and its engine may also remain connected to the driver.
+ */
+int library_launch_plugin(const char* plugin_name, const char* options, void* mpi_comm_ptr,
+                          MDI_Driver_node_callback_t driver_node_callback,
+                          void* driver_callback_object) {
+  int ret;
+  int driver_code_id = active_context->current_code;
+  MPI_Comm mpi_comm = *(MPI_Comm*) mpi_comm_ptr;
+  int cache_mode = active_context->plugin_cache_mode;
+
+  // Use the plugin if it is already loaded
+  void* plugin_handle = NULL;
+  MDI_Plugin_init_t plugin_init = NULL;
+  int ientry = library_find_plugin(plugin_name);
+  int cached = ( ientry >= 0 );
+  if ( cached ) {
+    plugin_entry* entry = vector_get(&active_context->plugin_cache, ientry);
+    if ( entry->comm != MDI_COMM_NULL ) {
+      return library_run_resident(entry, mpi_comm, driver_node_callback, driver_callback_object);
+    }
+    plugin_handle = entry->handle;
+    plugin_init = entry->plugin_init;
+  }
+  else {
+    ret = library_open_plugin(plugin_name, &plugin_handle, &plugin_init);
+    if ( ret != 0 ) {
+      return ret;
+    }
+  }
 
   // initialize a communicator for the driver
   int icomm = library_initialize();
-  communicator* driver_comm = get_communicator(current_code, icomm);
+  communicator* driver_comm = get_communicator(active_context->current_code, icomm);
   library_data* libd = (library_data*) driver_comm->method_data;
-  libd->connected_code = (int)codes.size;
+  libd->connected_code = slot_map_next_handle(&active_context->codes);
 
   MDI_Comm comm;
   ret = MDI_Accept_Communicator(&comm);
   if ( ret != 0 || comm == MDI_COMM_NULL ) {
     mdi_error("MDI unable to create communicator for plugin");
+    delete_communicator(driver_code_id, icomm);
+    if ( ! cached ) {
+      library_close_plugin(plugin_handle);
+    }
     return -1;
   }
 
@@ -109,69 +239,172 @@ int library_launch_plugin(const char* plugin_name, const char* options, void* mp
   libd->mpi_comm = mpi_comm;
 
   // Initialize an instance of the plugin
-  plugin_mode = 1;
+  active_context->plugin_mode = 1;
   ret = plugin_init();
+  active_context->plugin_mode = 0;
+  active_context->current_code = driver_code_id;
+  int driver_node_ret = libd->driver_node_ret;
   if ( ret != 0 ) {
     mdi_error("MDI plugin init function returned non-zero exit code");
+
+    // Delete the engine, and close the plugin unless it remains in the cache
+    delete_communicator(driver_code_id, comm);
+    if ( ! cached ) {
+      library_close_plugin(plugin_handle);
+    }
     return -1;
   }
-  plugin_mode = 0;
-  current_code = driver_code_id;
 
-  // Delete the driver's communicator to the engine
+  // Delete the driver's communicator to the engine, unless the engine remains resident
   // This will also delete the engine code and its communicator
-  delete_communicator(driver_code_id, comm);
+  if ( cache_mode != MDI_PLUGIN_KEEPALIVE ) {
+    delete_communicator(driver_code_id, comm);
+    comm = MDI_COMM_NULL;
+  }
 
-  // Close the plugin library
-#ifdef _WIN32
-  FreeLibrary( plugin_handle );
-#else
-  dlclose( plugin_handle );
-#endif
+  // Add the plugin to the cache, or close it
+  // The cache may have changed while the plugin ran, so the entry is looked up again
+  ientry = library_find_plugin(plugin_name);
+  if ( ientry >= 0 ) {
+    plugin_entry* entry = vector_get(&active_context->plugin_cache, ientry);
+    entry->driver_code = driver_code_id;
+    entry->comm = comm;
+  }
+  else if ( cache_mode != MDI_PLUGIN_UNLOAD ) {
+    if ( ! active_context->plugin_cache_initialized ) {
+      vector_init(&active_context->plugin_cache, sizeof(plugin_entry));
+      active_context->plugin_cache_initialized = 1;
+    }
+    plugin_entry entry;
+    snprintf(entry.name, PLUGIN_PATH_LENGTH, "%s", plugin_name);
+    entry.handle = plugin_handle;
+    entry.plugin_init = plugin_init;
+    entry.driver_code = driver_code_id;
+    entry.comm = comm;
+    vector_push_back(&active_context->plugin_cache, &entry);
+  }
+  else {
+    // Close the plugin library
+    library_close_plugin(plugin_handle);
+  }
+
+  if ( driver_node_ret != 0 ) {
+    mdi_error("MDI driver node callback returned non-zero exit code");
+    return -1;
+  }
+  return 0;
+}
+
+
+/*! \brief Unload a plugin that remained loaded after it was launched
+ *
+ * If the plugin has a resident engine, the engine is deleted first.
+ * The function returns \p 0 on a success.
+ *
+ * \param [in]       plugin_name
+ *                   Name of the plugin.
+ */
+int library_unload_plugin(const char* plugin_name) {
+  int ientry = library_find_plugin(plugin_name);
+  if ( ientry < 0 ) {
+    mdi_error("Error in MDI_Unload_plugin: The plugin is not loaded");
+    return 1;
+  }
+  plugin_entry entry = *(plugin_entry*) vector_get(&active_context->plugin_cache, ientry);
+  vector_delete(&active_context->plugin_cache, ientry);
 
+  // Delete the driver's communicator to the resident engine, which also deletes the engine code
+  if ( entry.comm != MDI_COMM_NULL ) {
+    delete_communicator(entry.driver_code, entry.comm);
+  }
+  library_close_plugin(entry.handle);
   return 0;
 }
 
 
+/*! \brief Unload every plugin in the plugin cache of the active context, and free the cache
+ *
+ */
+int library_free_plugins() {
+  if ( ! active_context->plugin_cache_initialized ) {
+    return 0;
+  }
+  while ( active_context->plugin_cache.size > 0 ) {
+    plugin_entry* entry = vector_get(&active_context->plugin_cache, active_context->plugin_cache.size - 1);
+    library_unload_plugin(entry->name);
+  }
+  vector_free(&active_context->plugin_cache);
+  active_context->plugin_cache_initialized = 0;
+  return 0;
+}
+
+
+/*! \brief Record that two library communicators are connected to each other
+ *
+ * \param [in]       this_comm
+ *                   Communicator of one code.
+ * \param [in]       other_comm
+ *                   Matching communicator of the connected code.
+ */
+static void library_link_peers(communicator* this_comm, communicator* other_comm) {
+  ((library_data*) this_comm->method_data)->peer = other_comm;
+  ((library_data*) other_comm->method_data)->peer = this_comm;
+}
+
+
 /*! \brief Perform initialization of a communicator for library-based communication
  *
  */
 int library_initialize() {
-  code* this_code = get_code(current_code);
+  code* this_code = get_code(active_context->current_code);
 
   MDI_Comm comm_id = new_communicator(this_code->id, MDI_LINK);
   communicator* new_comm = get_communicator(this_code->id, comm_id);
   new_comm->delete = communicator_delete_lib;
   new_comm->send = library_send;
   new_comm->recv = library_recv;
+  new_comm->send_strided = library_send_strided;
+  new_comm->recv_strided = library_recv_strided;
+  new_comm->send_vector = library_send_vector;
+  new_comm->recv_vector = library_recv_vector;
 
   // set the MDI version number of the new communicator
   new_comm->mdi_version[0] = MDI_MAJOR_VERSION;
   new_comm->mdi_version[1] = MDI_MINOR_VERSION;
   new_comm->mdi_version[2] = MDI_PATCH_VERSION;
 
+  // both codes share this library, so the extended header and vectored messages are always supported
+  new_comm->features = MDI_FEATURE_LARGE_COUNT | MDI_FEATURE_VECTOR | MDI_FEATURE_UNITS | MDI_FEATURE_REGISTRY_KEY;
+
   // allocate the method data
   library_data* libd = malloc(sizeof(library_data));
   libd->connected_code = -1;
-  libd->buf_allocated = 0;
+  libd->buf_in_use = 0;
+  libd->buf = NULL;
+  libd->buf_capacity = 0;
+  libd->body_offset = 0;
+  libd->lent_body = NULL;
+  libd->peer = NULL;
   libd->execute_on_send = 0;
   libd->mpi_comm = MPI_COMM_NULL;
+  libd->driver_node_ret = 0;
   new_comm->method_data = libd;
 
   // if this is an engine, go ahead and set the driver as the connected code
   if ( strcmp(this_code->role, "ENGINE") == 0 ) {
-    int engine_code = current_code;
+    int engine_code = active_context->current_code;
     library_set_driver_current();
-    int driver_code_id = current_code;
+    int driver_code_id = active_context->current_code;
     libd->connected_code = driver_code_id;
-    current_code = engine_code;
+    active_context->current_code = engine_code;
 
     // set the engine's mpi communicator
-    if ( plugin_mode ) {
+    if ( active_context->plugin_mode ) {
       code* driver_code = get_code(driver_code_id);
       MDI_Comm matching_handle = library_get_matching_handle(comm_id);
       communicator* driver_comm = get_communicator(driver_code->id, matching_handle);
       library_data* driver_libd = (library_data*) driver_comm->method_data;
+      library_link_peers(new_comm, driver_comm);
       libd->mpi_comm = driver_libd->mpi_comm;
       this_code->intra_MPI_comm = libd->mpi_comm;
       MPI_Comm_rank( this_code->intra_MPI_comm, &this_code->intra_rank );
@@ -186,7 +419,7 @@ int library_initialize() {
  *
  */
 int library_set_driver_current() {
-  code* this_code = get_code(current_code);
+  code* this_code = get_code(active_context->current_code);
 
   // check if the current code is an ENGINE that is linked as a LIBRARY
   if ( strcmp(this_code->role, "ENGINE") == 0 ) {
@@ -194,10 +427,10 @@ int library_set_driver_current() {
       // the calling code must actually be the driver, so update current_code
       int icode;
       int found_driver = 0;
-      for ( icode = 0; icode < codes.size; icode++ ) {
-	code* other_code = vector_get(&codes, icode);
-	if ( strcmp(other_code->role, "DRIVER") == 0 ) {
-	  current_code = icode;
+      for ( icode = 0; icode < active_context->codes.slots.size; icode++ ) {
+	code* other_code = slot_map_at(&active_context->codes, icode);
+	if ( other_code != NULL && strcmp(other_code->role, "DRIVER") == 0 ) {
+	  active_context->current_code = other_code->id;
 	  found_driver = 1;
 	}
       }
@@ -216,13 +449,13 @@ int library_set_driver_current() {
  *
  */
 int library_accept_communicator() {
-  code* this_code = get_code(current_code);
+  code* this_code = get_code(active_context->current_code);
   if ( this_code->called_set_execute_command_func ) {
     // library codes are not permitted to call MDI_Accept_communicator after calling
     // MDI_Set_execute_command_func, so assume that this call is being made by the driver
     library_set_driver_current();
   }
-  this_code = get_code(current_code);
+  this_code = get_code(active_context->current_code);
 
   // if this is a DRIVER, check if there are any ENGINES that are linked to it
   if ( strcmp(this_code->role, "DRIVER") == 0 ) {
@@ -230,9 +463,9 @@ int library_accept_communicator() {
     int icode;
     int found_engine = 0;
     int iengine = 0;
-    for ( icode = 0; icode < codes.size; icode++ ) {
-      code* other_code = vector_get(&codes, icode);
-      if ( strcmp(other_code->role, "ENGINE") == 0 ) {
+    for ( icode = 0; icode < active_context->codes.slots.size; icode++ ) {
+      code* other_code = slot_map_at(&active_context->codes, icode);
+      if ( other_code != NULL && strcmp(other_code->role, "ENGINE") == 0 ) {
 	if ( other_code->is_library == 1 ) {
 	  // flag that this library has connected to the driver
 	  other_code->is_library = 2;
@@ -251,9 +484,13 @@ int library_accept_communicator() {
 
       // set the connected code for the driver
       code* engine_code = get_code(iengine);
-      communicator* this_comm = get_communicator(current_code, icomm);
+      communicator* this_comm = get_communicator(active_context->current_code, icomm);
       library_data* libd = (library_data*) this_comm->method_data;
       libd->connected_code = engine_code->id;
+
+      // cache the engine's matching communicator
+      MDI_Comm engine_comm_handle = library_get_matching_handle(icomm);
+      library_link_peers(this_comm, get_communicator(engine_code->id, engine_comm_handle));
     }
 
   }
@@ -271,10 +508,15 @@ int library_accept_communicator() {
  *                   MDI communicator associated with the linked code.
  */
 int library_get_matching_handle(MDI_Comm comm) {
-  communicator* this = get_communicator(current_code, comm);
+  communicator* this = get_communicator(active_context->current_code, comm);
 
-  // get the engine code to which this communicator connects
+  // use the matching communicator cached when the codes connected
   library_data* libd = (library_data*) this->method_data;
+  if ( libd->peer != NULL ) {
+    return libd->peer->id;
+  }
+
+  // get the engine code to which this communicator connects
   int iengine = libd->connected_code;
   code* engine_code = get_code(iengine);
 
@@ -282,10 +524,13 @@ int library_get_matching_handle(MDI_Comm comm) {
   int icomm;
   int found_self = 0;
   int engine_comm_handle = 0;
-  for ( icomm = 0; icomm < engine_code->comms->size; icomm++ ) {
-    communicator* engine_comm = vector_get(engine_code->comms, icomm);
+  for ( icomm = 0; icomm < engine_code->comms->slots.size; icomm++ ) {
+    communicator* engine_comm = slot_map_at(engine_code->comms, icomm);
+    if ( engine_comm == NULL ) {
+      continue;
+    }
     library_data* engine_lib = (library_data*) engine_comm->method_data;
-    if ( engine_lib->connected_code == current_code ) {
+    if ( engine_lib->connected_code == active_context->current_code ) {
       found_self = 1;
       engine_comm_handle = engine_comm->id;
     }
@@ -301,6 +546,21 @@ int library_get_matching_handle(MDI_Comm comm) {
 }
 
 
+/*! \brief Return the matching communicator of the code to which a library communicator connects
+ *
+ * \param [in]       libd
+ *                   Library data of the communicator.
+ * \param [in]       comm
+ *                   MDI communicator associated with the linked code.
+ */
+static communicator* library_get_peer(library_data* libd, MDI_Comm comm) {
+  if ( libd->peer != NULL ) {
+    return libd->peer;
+  }
+  return get_communicator(libd->connected_code, library_get_matching_handle(comm));
+}
+
+
 /*! \brief Set the next command that will be executed through the library communicator
  *
  * If running with MPI, this function must be called only by rank \p 0.
@@ -312,16 +572,12 @@ int library_get_matching_handle(MDI_Comm comm) {
  *                   MDI communicator associated with the intended recipient code.
  */
 int library_set_command(const char* command, MDI_Comm comm) {
-  int idriver = current_code;
-  communicator* this = get_communicator(current_code, comm);
-
-  // get the engine code to which this communicator connects
+  int idriver = active_context->current_code;
+  communicator* this = get_communicator(active_context->current_code, comm);
   library_data* libd = (library_data*) this->method_data;
-  int iengine = libd->connected_code;
 
   // get the matching engine communicator
-  MDI_Comm engine_comm_handle = library_get_matching_handle(comm);
-  communicator* engine_comm = get_communicator(iengine, engine_comm_handle);
+  communicator* engine_comm = library_get_peer(libd, comm);
 
   // set the command
   library_data* engine_lib = (library_data*) engine_comm->method_data;
@@ -344,38 +600,134 @@ int library_set_command(const char* command, MDI_Comm comm) {
 int library_execute_command(MDI_Comm comm) {
   int ret = 0;
 
-  int idriver = current_code;
-  communicator* this = get_communicator(current_code, comm);
+  int idriver = active_context->current_code;
+  communicator* this = get_communicator(active_context->current_code, comm);
 
   // get the engine code to which this communicator connects
   library_data* libd = (library_data*) this->method_data;
   int iengine = libd->connected_code;
-  code* engine_code = get_code(iengine);
 
-  MDI_Comm engine_comm_handle = library_get_matching_handle(comm);
-  communicator* engine_comm = get_communicator(iengine, engine_comm_handle);
+  communicator* engine_comm = library_get_peer(libd, comm);
+  MDI_Comm engine_comm_handle = engine_comm->id;
   library_data* engine_lib = (library_data*) engine_comm->method_data;
 
   // set the current code to the engine
-  current_code = iengine;
+  active_context->current_code = iengine;
 
   // check if this command corresponds to one of MDI's standard built-in commands
   int builtin_flag = general_builtin_command(engine_lib->command, engine_comm_handle);
 
   if ( builtin_flag == 0 ) {
-    // call execute_command now
-    void* class_obj = engine_code->execute_command_obj;
-    ret = engine_code->execute_command(engine_lib->command,engine_comm_handle,class_obj);
+    // call the handler for this command, or execute_command, now
+    ret = general_execute_command(engine_lib->command, engine_comm_handle);
   }
 
   // set the current code to the driver
-  current_code = idriver;
+  active_context->current_code = idriver;
 
   return ret;
 }
 
 
 
+/*! \brief Return the rank of this process on the engine side of a library-based connection
+ *
+ * \param [in]       this_code
+ *                   The code that is currently active.
+ * \param [in]       libd
+ *                   Library data of the communicator.
+ */
+static int library_engine_rank(code* this_code, library_data* libd) {
+  if ( this_code->is_library ) {
+    return this_code->intra_rank;
+  }
+  code* other_code = get_code(libd->connected_code);
+  return other_code->intra_rank;
+}
+
+
+/*! \brief Return a pointer to the body of the message held by a sending communicator
+ *
+ * \param [in]       libd
+ *                   Library data of the sending communicator.
+ */
+static const char* library_sent_body(library_data* libd) {
+  if ( libd->lent_body != NULL ) {
+    return (const char*)libd->lent_body;
+  }
+  return (const char*)libd->buf + libd->body_offset;
+}
+
+
+/*! \brief Ensure that libd->buf can hold a message of a given size
+ *
+ * The buffer is only reallocated when it is too small, so that a sequence of messages of
+ * similar size does not allocate any memory after the first message.
+ * The function returns \p 0 on a success.
+ *
+ * \param [in]       libd
+ *                   Library data of the sending communicator.
+ * \param [in]       msg_bytes
+ *                   Size of the message, in bytes.
+ */
+static int library_reserve_buffer(library_data* libd, size_t msg_bytes) {
+  if ( msg_bytes <= libd->buf_capacity ) {
+    return 0;
+  }
+  void* new_buf = realloc( libd->buf, msg_bytes );
+  if ( new_buf == NULL ) {
+    mdi_error("MDI Error: unable to allocate message buffer");
+    return 1;
+  }
+  libd->buf = new_buf;
+  libd->buf_capacity = msg_bytes;
+  return 0;
+}
+
+
+/*! \brief Return a pointer to the location in libd->buf where the body of a message is stored
+ *
+ * If no header was sent, the buffer holds only the body.
+ * The function returns NULL on an allocation failure.
+ *
+ * \param [in]       libd
+ *                   Library data of the sending communicator.
+ * \param [in]       body_bytes
+ *                   Size of the body of the message, in bytes.
+ */
+static char* library_body_buffer(library_data* libd, size_t body_bytes) {
+  if ( libd->buf_in_use == 0 ) {
+    // libd->buf is not in use, which means there is no header
+    if ( library_reserve_buffer(libd, body_bytes) != 0 ) {
+      return NULL;
+    }
+    libd->buf_in_use = 1;
+    libd->body_offset = 0;
+  }
+  return (char*)libd->buf + libd->body_offset;
+}
+
+
+/*! \brief Complete the sending of the body of a message
+ *
+ * \param [in]       libd
+ *                   Library data of the sending communicator.
+ * \param [in]       comm
+ *                   MDI communicator associated with the intended recipient code.
+ */
+static void library_body_sent(library_data* libd, MDI_Comm comm) {
+  // check whether the recipient code should now execute its command
+  if ( libd->execute_on_send == 1 ) {
+    // have the recipient code execute its command
+    library_execute_command(comm);
+
+    // turn off the execute_on_send flag
+    libd->execute_on_send = 0;
+  }
+}
+
+
+
 /*! \brief Function to handle sending data through an MDI connection, using library-based communication
  *
  * \param [in]       buf
@@ -392,55 +744,26 @@ int library_execute_command(MDI_Comm comm) {
  *                   1: The header of a message.
  *                   2: The body (data) of a message.
  */
-int library_send(const void* buf, int count, MDI_Datatype datatype, MDI_Comm comm, int msg_flag) {
-  if ( datatype != MDI_INT && datatype != MDI_DOUBLE && datatype != MDI_CHAR && datatype != MDI_BYTE ) {
+int library_send(const void* buf, size_t count, MDI_Datatype datatype, MDI_Comm comm, int msg_flag) {
+  if ( datatype_size(datatype) == 0 ) {
     mdi_error("MDI data type not recognized in library_send");
     return 1;
   }
 
-  code* this_code = get_code(current_code);
-  communicator* this = get_communicator(current_code, comm);
+  code* this_code = get_code(active_context->current_code);
+  communicator* this = get_communicator(active_context->current_code, comm);
   library_data* libd = (library_data*) this->method_data;
 
-  code* other_code = get_code(libd->connected_code);
-
-  // get the rank of this process on the engine
-  int engine_rank = 0;
-  if ( this_code->is_library ) {
-    engine_rank = this_code->intra_rank;
-  }
-  else {
-    engine_rank = other_code->intra_rank;
-  }
-
   // only send from rank 0
-  if ( engine_rank == 0 ) {
+  if ( library_engine_rank(this_code, libd) == 0 ) {
 
     // determine the byte size of the data type being sent
-    size_t datasize;
-    if (datatype == MDI_INT) {
-      datasize = sizeof(int);
-    }
-    else if (datatype == MDI_DOUBLE) {
-      datasize = sizeof(double);
-    }
-    else if (datatype == MDI_CHAR) {
-      datasize = sizeof(char);
-    }
-    else if (datatype == MDI_BYTE) {
-      datasize = sizeof(char);
-    }
-    else {
-      mdi_error("MDI Error: Unrecognized data type");
-      return 1;
-    }
-
-    int nheader_actual = 4; // actual number of elements of nheader that were sent
+    size_t datasize = datatype_size(datatype);
 
     if ( msg_flag == 1 ) { // message header
 
-      // confirm that libd->buf is not already allocated
-      if ( libd->buf_allocated != 0 ) {
+      // confirm that libd->buf is not already in use
+      if ( libd->buf_in_use != 0 ) {
 	mdi_error("MDI recv buffer already allocated");
 	return 1;
       }
@@ -448,61 +771,66 @@ int library_send(const void* buf, int count, MDI_Datatype datatype, MDI_Comm com
       // get the size of the message body, based on the header information
       int* header = (int*)buf;
       int body_type = header[2];
-      int body_size = header[3];
-      size_t body_stride;
-      if (body_type == MDI_INT) {
-	body_stride = sizeof(int);
+      size_t body_size = (size_t)header[3];
+      if ( count >= MDI_HEADER_LENGTH_EXT ) {
+	body_size |= (size_t)header[6] << 31;
       }
-      else if (body_type == MDI_DOUBLE) {
-	body_stride = sizeof(double);
-      }
-      else if (body_type == MDI_CHAR) {
-	body_stride = sizeof(char);
+      size_t body_stride = datatype_size(body_type);
+      if ( body_stride == 0 ) {
+	mdi_error("MDI Error: Unrecognized data type");
+	return 1;
       }
-      else if (body_type == MDI_BYTE) {
+
+      // an encoded body is sent as bytes
+      if ( count >= MDI_HEADER_LENGTH_EXT && ( header[1] & MDI_HEADER_ENCODED ) ) {
 	body_stride = sizeof(char);
-      }
-      else {
-	mdi_error("MDI Error: Unrecognized data type");
+	body_size = (size_t)header[4] | ( (size_t)header[5] << 31 );
       }
 
-      int msg_bytes = ( (int)datasize * count ) + ( (int)body_stride * body_size );
+      size_t msg_bytes = ( datasize * count ) + ( body_stride * body_size );
 
-      // allocate the memory required for the entire message
-      libd->buf = malloc( msg_bytes );
-      libd->buf_allocated = 1;
+      // ensure that libd->buf can hold the entire message
+      if ( library_reserve_buffer(libd, msg_bytes) != 0 ) {
+	return 1;
+      }
+      libd->buf_in_use = 1;
 
       // copy the header into libd->buf
-      memcpy(libd->buf, buf, nheader_actual * sizeof(int));
+      libd->body_offset = datasize * count;
+      memcpy(libd->buf, buf, libd->body_offset);
 
     }
     else if ( msg_flag == 2 ) { // message body
 
-      // confirm that libd->buf has been allocated
-      int has_header = 1;
-      if ( libd->buf_allocated == 0 ) {
-	// libd->buf has not been allocated, which means there is no header
-	has_header = 0;
-	libd->buf = malloc( datasize * count );
-	libd->buf_allocated = 1;
-      }
-
-      int offset = 0;
-      if ( has_header == 1 ) {
-	offset = nheader_actual * sizeof(int);
+      if ( libd->execute_on_send == 1 ) {
+        // the recipient receives the body while it executes its command, so lend it the body,
+        // which it copies straight into its own buffer
+        if ( libd->buf_in_use == 0 ) {
+          libd->buf_in_use = 1;
+          libd->body_offset = 0;
+        }
+        libd->lent_body = buf;
+        library_body_sent(libd, comm);
+        libd->lent_body = NULL;
+
+        // if the recipient did not receive the body, keep a copy of it for a later call to MDI_Recv
+        if ( libd->buf_in_use == 1 ) {
+          if ( library_reserve_buffer(libd, libd->body_offset + datasize * count) != 0 ) {
+            return 1;
+          }
+          memcpy((char*)libd->buf + libd->body_offset, buf, datasize * count);
+        }
+        return 0;
       }
 
       // copy the body into libd->buf
-      memcpy((char*)libd->buf + offset, buf, datasize * count);
-
-      // check whether the recipient code should now execute its command
-      if ( libd->execute_on_send == 1 ) {
-	// have the recipient code execute its command
-	library_execute_command(comm);
-
-	// turn off the execute_on_send flag
-	libd->execute_on_send = 0;
+      char* body = library_body_buffer(libd, datasize * count);
+      if ( body == NULL ) {
+	return 1;
       }
+      memcpy(body, buf, datasize * count);
+
+      library_body_sent(libd, comm);
 
     }
     else {
@@ -535,53 +863,29 @@ int library_send(const void* buf, int count, MDI_Datatype datatype, MDI_Comm com
  *                   1: The header of a message.
  *                   2: The body (data) of a message.
  */
-int library_recv(void* buf, int count, MDI_Datatype datatype, MDI_Comm comm, int msg_flag) {
-  code* this_code = get_code(current_code);
-  communicator* this = get_communicator(current_code, comm);
+int library_recv(void* buf, size_t count, MDI_Datatype datatype, MDI_Comm comm, int msg_flag) {
+  code* this_code = get_code(active_context->current_code);
+  communicator* this = get_communicator(active_context->current_code, comm);
   library_data* libd = (library_data*) this->method_data;
 
-  code* other_code = get_code(libd->connected_code);
-  MDI_Comm other_comm_handle = library_get_matching_handle(comm);
-  communicator* other_comm = get_communicator(libd->connected_code, other_comm_handle);
+  communicator* other_comm = library_get_peer(libd, comm);
   library_data* other_lib = (library_data*) other_comm->method_data;
 
   // only recv from rank 0 of the engine
-  int engine_rank = 0;
-  if ( this_code->is_library ) {
-    engine_rank = this_code->intra_rank;
-  }
-  else {
-    engine_rank = other_code->intra_rank;
-  }
-  if ( engine_rank != 0 ) {
+  if ( library_engine_rank(this_code, libd) != 0 ) {
     return 0;
   }
 
-  if ( datatype != MDI_INT && datatype != MDI_DOUBLE && datatype != MDI_CHAR && datatype != MDI_BYTE ) {
+  if ( datatype_size(datatype) == 0 ) {
     mdi_error("MDI data type not recognized in library_send");
     return 1;
   }
 
   // determine the byte size of the data type being sent
-  size_t datasize;
-  if (datatype == MDI_INT) {
-    datasize = sizeof(int);
-  }
-  else if (datatype == MDI_DOUBLE) {
-    datasize = sizeof(double);
-  }
-  else if (datatype == MDI_CHAR) {
-    datasize = sizeof(char);
-  }
-  else if (datatype == MDI_BYTE) {
-    datasize = sizeof(char);
-  }
-  else {
-    mdi_error("MDI Error: Unrecognized data type");
-  }
+  size_t datasize = datatype_size(datatype);
 
-  // confirm that libd->buf is initialized
-  if ( other_lib->buf_allocated != 1 ) {
+  // confirm that libd->buf holds a message
+  if ( other_lib->buf_in_use != 1 ) {
     mdi_error("MDI send buffer is not allocated");
     return 1;
   }
@@ -590,7 +894,7 @@ int library_recv(void* buf, int count, MDI_Datatype datatype, MDI_Comm comm, int
   // only do this if communicating with MDI version 1.1 or higher
   if ( ( this->mdi_version[0] > 1 ||
 	 ( this->mdi_version[0] == 1 && this->mdi_version[1] >= 1 ) )
-       && ipi_compatibility != 1 ) {
+       && active_context->ipi_compatibility != 1 ) {
 
     if ( msg_flag == 1 ) { // message header
 
@@ -599,13 +903,10 @@ int library_recv(void* buf, int count, MDI_Datatype datatype, MDI_Comm comm, int
     }
     else if ( msg_flag == 2 ) { // message body
 
-      int nheader = 4;
-      int offset = nheader * sizeof(int);
-      memcpy(buf, (char*)other_lib->buf + offset, count * datasize);
+      memcpy(buf, library_sent_body(other_lib), count * datasize);
 
-      // free the memory of libd->buf
-      free( other_lib->buf );
-      other_lib->buf_allocated = 0;
+      // release libd->buf, which is retained for the next message
+      other_lib->buf_in_use = 0;
 
     }
     else {
@@ -622,6 +923,171 @@ int library_recv(void* buf, int count, MDI_Datatype datatype, MDI_Comm comm, int
 
 
 
+/*! \brief Send the body of a message from a strided array, using library-based communication
+ *
+ * The array is gathered directly into the message buffer.
+ *
+ * \param [in]       buf
+ *                   Pointer to the first element of the array.
+ * \param [in]       desc
+ *                   Descriptor of the layout of the array.
+ * \param [in]       datatype
+ *                   MDI handle (MDI_INT, MDI_DOUBLE, MDI_CHAR, etc.) corresponding to the type of data to be sent.
+ * \param [in]       comm
+ *                   MDI communicator associated with the intended recipient code.
+ */
+int library_send_strided(const void* buf, const strided_desc* desc, MDI_Datatype datatype, MDI_Comm comm) {
+  code* this_code = get_code(active_context->current_code);
+  communicator* this = get_communicator(active_context->current_code, comm);
+  library_data* libd = (library_data*) this->method_data;
+
+  // only send from rank 0
+  if ( library_engine_rank(this_code, libd) == 0 ) {
+    char* body = library_body_buffer(libd, desc->count * desc->elemsize);
+    if ( body == NULL ) {
+      return 1;
+    }
+    strided_pack(desc, buf, 0, desc->nruns, body);
+
+    library_body_sent(libd, comm);
+  }
+
+  return 0;
+}
+
+
+
+/*! \brief Receive the body of a message into a strided array, using library-based communication
+ *
+ * The message buffer is scattered directly into the array.
+ *
+ * \param [out]      buf
+ *                   Pointer to the first element of the array.
+ * \param [in]       desc
+ *                   Descriptor of the layout of the array.
+ * \param [in]       datatype
+ *                   MDI handle (MDI_INT, MDI_DOUBLE, MDI_CHAR, etc.) corresponding to the type of data to be received.
+ * \param [in]       comm
+ *                   MDI communicator associated with the connection to the sending code.
+ */
+int library_recv_strided(void* buf, const strided_desc* desc, MDI_Datatype datatype, MDI_Comm comm) {
+  code* this_code = get_code(active_context->current_code);
+  communicator* this = get_communicator(active_context->current_code, comm);
+  library_data* libd = (library_data*) this->method_data;
+
+  communicator* other_comm = library_get_peer(libd, comm);
+  library_data* other_lib = (library_data*) other_comm->method_data;
+
+  // only recv from rank 0 of the engine
+  if ( library_engine_rank(this_code, libd) != 0 ) {
+    return 0;
+  }
+
+  // confirm that libd->buf holds a message
+  if ( other_lib->buf_in_use != 1 ) {
+    mdi_error("MDI send buffer is not allocated");
+    return 1;
+  }
+
+  strided_unpack(desc, library_sent_body(other_lib), 0, desc->nruns, buf);
+
+  // release libd->buf, which is retained for the next message
+  other_lib->buf_in_use = 0;
+
+  return 0;
+}
+
+
+
+/*! \brief Send the body of a vectored message, using library-based communication
+ *
+ * The segments are copied directly into the message buffer.
+ *
+ * \param [in]       nseg
+ *                   Number of segments in the message.
+ * \param [in]       bufs
+ *                   Pointer to the data of each segment.
+ * \param [in]       nbytes
+ *                   Size of each segment, in bytes.
+ * \param [in]       comm
+ *                   MDI communicator associated with the intended recipient code.
+ */
+int library_send_vector(int nseg, const void* const* bufs, const size_t* nbytes, MDI_Comm comm) {
+  code* this_code = get_code(active_context->current_code);
+  communicator* this = get_communicator(active_context->current_code, comm);
+  library_data* libd = (library_data*) this->method_data;
+
+  // only send from rank 0
+  if ( library_engine_rank(this_code, libd) == 0 ) {
+    size_t total_bytes = 0;
+    int iseg;
+    for ( iseg = 0; iseg < nseg; iseg++ ) {
+      total_bytes += nbytes[iseg];
+    }
+    char* body = library_body_buffer(libd, total_bytes);
+    if ( body == NULL ) {
+      return 1;
+    }
+    for ( iseg = 0; iseg < nseg; iseg++ ) {
+      memcpy(body, bufs[iseg], nbytes[iseg]);
+      body += nbytes[iseg];
+    }
+
+    library_body_sent(libd, comm);
+  }
+
+  return 0;
+}
+
+
+
+/*! \brief Receive the body of a vectored message, using library-based communication
+ *
+ * The message buffer is copied directly into the buffer of each segment.
+ *
+ * \param [in]       nseg
+ *                   Number of segments in the message.
+ * \param [out]      bufs
+ *                   Pointer to the buffer where each segment will be stored.
+ * \param [in]       nbytes
+ *                   Size of each segment, in bytes.
+ * \param [in]       comm
+ *                   MDI communicator associated with the connection to the sending code.
+ */
+int library_recv_vector(int nseg, void* const* bufs, const size_t* nbytes, MDI_Comm comm) {
+  code* this_code = get_code(active_context->current_code);
+  communicator* this = get_communicator(active_context->current_code, comm);
+  library_data* libd = (library_data*) this->method_data;
+
+  communicator* other_comm = library_get_peer(libd, comm);
+  library_data* other_lib = (library_data*) other_comm->method_data;
+
+  // only recv from rank 0 of the engine
+  if ( library_engine_rank(this_code, libd) != 0 ) {
+    return 0;
+  }
+
+  // confirm that libd->buf holds a message
+  if ( other_lib->buf_in_use != 1 ) {
+    mdi_error("MDI send buffer is not allocated");
+    return 1;
+  }
+
+  const char* body = library_sent_body(other_lib);
+  int iseg;
+  for ( iseg = 0; iseg < nseg; iseg++ ) {
+    memcpy(bufs[iseg], body, nbytes[iseg]);
+    body += nbytes[iseg];
+  }
+
+  // release libd->buf, which is retained for the next message
+  other_lib->buf_in_use = 0;
+
+  return 0;
+}
+
+
+
 /*! \brief Function for LIBRARY-specific deletion operations for communicator deletion
  */
 int communicator_delete_lib(void* comm) {
@@ -629,15 +1095,20 @@ int communicator_delete_lib(void* comm) {
   code* this_code = get_code(this_comm->code_id);
   library_data* libd = (library_data*) this_comm->method_data;
 
+  // the matching communicator no longer connects to this one
+  if ( libd->peer != NULL ) {
+    ((library_data*) libd->peer->method_data)->peer = NULL;
+  }
+
   // if this is the driver, delete the engine code
-  if ( this_code->is_library == 0 ) {
+  // a plugin whose init function failed before calling MDI_Init never created its engine code
+  if ( this_code->is_library == 0 &&
+       slot_map_get(&active_context->codes, libd->connected_code) != NULL ) {
     delete_code(libd->connected_code);
   }
 
   // delete the method-specific information
-  if ( libd->buf_allocated ) {
-    free( libd->buf );
-  }
+  free( libd->buf );
   free( libd );
 
   return 0;
@@ -8,6 +8,7 @@
 
 #include "mdi.h"
 #include "mdi_global.h"
+#include "mdi_strided.h"
 
 typedef struct library_data_struct {
   /*! \brief Handle of the code to which this communicator connects */
@@ -15,8 +16,8 @@ typedef struct library_data_struct {
   /*! \brief Name of the next command to be executed on this code.
   This is only used by engines. */
   char command[COMMAND_LENGTH];
-  /*! \brief Flag whether buf is allocated */
-  int buf_allocated;
+  /*! \brief Flag whether buf holds a message that has not yet been received */
+  int buf_in_use;
   /*! \brief Flag whether the next MDI_Send call should trigger execution of the engine's command */
   int execute_on_send;
   /*! \brief MPI intra-communicator for the engine */
@@ -25,25 +26,58 @@ typedef struct library_data_struct {
   void* driver_callback_obj;
   /*! \brief Function pointer to the driver node's callback function */
   MDI_Driver_node_callback_t driver_node_callback;
-  /*! \brief Buffer used for communication of data */
+  /*! \brief Value returned by the most recent call to driver_node_callback */
+  int driver_node_ret;
+  /*! \brief Buffer used for communication of data, which is reused by each message */
   void* buf;
+  /*! \brief Size of buf, in bytes */
+  size_t buf_capacity;
+  /*! \brief Offset, in bytes, of the body of the message within buf */
+  size_t body_offset;
+  /*! \brief Body of the message, lent by the sender while the command of the recipient executes,
+  or NULL if the body is held in buf */
+  const void* lent_body;
+  /*! \brief Matching communicator of the connected code, which is cached when the codes connect */
+  communicator* peer;
 } library_data;
 
 typedef int (*MDI_Plugin_init_t)();
 
+typedef struct plugin_entry_struct {
+  /*! \brief Name of the plugin */
+  char name[PLUGIN_PATH_LENGTH];
+  /*! \brief Handle of the loaded plugin library */
+  void* handle;
+  /*! \brief The plugin's initialization function */
+  MDI_Plugin_init_t plugin_init;
+  /*! \brief Handle of the driver code that launched the resident engine */
+  int driver_code;
+  /*! \brief Communicator of the driver to the resident engine, or MDI_COMM_NULL if the plugin
+  is loaded without an engine */
+  MDI_Comm comm;
+} plugin_entry;
+
 int library_launch_plugin(const char* plugin_name, const char* options, void* mpi_comm_ptr,
                           MDI_Driver_node_callback_t driver_node_callback,
                           void* driver_callback_object);
+int library_open_plugin(const char* plugin_name, void** handle_ptr, MDI_Plugin_init_t* init_ptr);
+void library_close_plugin(void* handle);
+int library_unload_plugin(const char* plugin_name);
+int library_free_plugins();
 int library_initialize();
 int library_accept_communicator();
 int library_set_driver_current();
 int library_get_matching_handle(MDI_Comm comm);
 int library_set_command(const char* command, MDI_Comm comm);
 int library_execute_command(MDI_Comm comm);
-int library_send(const void* buf, int count, MDI_Datatype datatype, MDI_Comm comm, int msg_flag);
-int library_recv(void* buf, int count, MDI_Datatype datatype, MDI_Comm comm, int msg_flag);
-int library_send_msg(const void* buf, int count, MDI_Datatype datatype, MDI_Comm comm);
-int library_recv_msg(void* buf, int count, MDI_Datatype datatype, MDI_Comm comm);
+int library_send(const void* buf, size_t count, MDI_Datatype datatype, MDI_Comm comm, int msg_flag);
+int library_recv(void* buf, size_t count, MDI_Datatype datatype, MDI_Comm comm, int msg_flag);
+int library_send_strided(const void* buf, const strided_desc* desc, MDI_Datatype datatype, MDI_Comm comm);
+int library_recv_strided(void* buf, const strided_desc* desc, MDI_Datatype datatype, MDI_Comm comm);
+int library_send_vector(int nseg, const void* const* bufs, const size_t* nbytes, MDI_Comm comm);
+int library_recv_vector(int nseg, void* const* bufs, const size_t* nbytes, MDI_Comm comm);
+int library_send_msg(const void* buf, size_t count, MDI_Datatype datatype, MDI_Comm comm);
+int library_recv_msg(void* buf, size_t count, MDI_Datatype datatype, MDI_Comm comm);
 
 int communicator_delete_lib(void* comm);
 
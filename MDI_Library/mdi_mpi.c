@@ -8,9 +8,13 @@
 #include <string.h>
 #include <signal.h>
 #include <errno.h>
+#include <limits.h>
 #include "mdi.h"
 #include "mdi_mpi.h"
 #include "mdi_global.h"
+#include "mdi_general.h"
+#include "mdi_datatype.h"
+#include "mdi_request.h"
 
 /*! \brief Size of MPI_COMM_WORLD */
 int world_size = -1;
@@ -59,7 +63,7 @@ int mpi_identify_codes(const char* code_name, int use_mpi4py, MPI_Comm world_com
   int i, j, ret;
   int driver_rank;
   int nunique_names = 0;
-  code* this_code = get_code(current_code);
+  code* this_code = get_code(active_context->current_code);
 
   // get the number of processes
   if ( use_mpi4py == 0 ) {
@@ -175,6 +179,11 @@ int mpi_identify_codes(const char* code_name, int use_mpi4py, MPI_Comm world_com
 	new_comm->delete = communicator_delete_mpi;
 	new_comm->send = mpi_send;
 	new_comm->recv = mpi_recv;
+	// derived datatypes are only available through the linked MPI library
+	if ( use_mpi4py == 0 ) {
+	  new_comm->send_strided = mpi_send_strided;
+	  new_comm->recv_strided = mpi_recv_strided;
+	}
 
 	// allocate the method data
 	mpi_method_data* method_data = malloc(sizeof(mpi_method_data));
@@ -213,17 +222,20 @@ int mpi_identify_codes(const char* code_name, int use_mpi4py, MPI_Comm world_com
 
   // communicate the version number between codes
   int icomm;
-  for ( icomm = 0; icomm < this_code->comms->size; icomm++ ) {
-    communicator* this_comm = vector_get(this_code->comms, icomm);
-    if (this_comm->method == MDI_MPI) {
+  for ( icomm = 0; icomm < this_code->comms->slots.size; icomm++ ) {
+    communicator* this_comm = slot_map_at(this_code->comms, icomm);
+    if ( this_comm != NULL && this_comm->method == MDI_MPI ) {
       // only communicate the version number if not using i-PI compatibility mode
-      if ( ipi_compatibility != 1 ) {
+      if ( active_context->ipi_compatibility != 1 ) {
 	int version[3];
 	version[0] = MDI_MAJOR_VERSION;
 	version[1] = MDI_MINOR_VERSION;
 	version[2] = MDI_PATCH_VERSION;
 	mpi_send(&version[0], 3, MDI_INT, this_comm->id, 0);
 	mpi_recv(&this_comm->mdi_version[0], 3, MDI_INT, this_comm->id, 0);
+
+	// negotiate any optional features
+	general_negotiate_features(this_comm->id);
       }
     }
   }
@@ -246,7 +258,7 @@ int mpi_identify_codes(const char* code_name, int use_mpi4py, MPI_Comm world_com
  *                   On output, the MPI communicator that spans the single code corresponding to the calling rank.
  */
 int mpi_update_world_comm(void* world_comm) {
-  code* this_code = get_code(current_code);
+  code* this_code = get_code(active_context->current_code);
   MPI_Comm* world_comm_ptr = (MPI_Comm*) world_comm;
   *world_comm_ptr = this_code->intra_MPI_comm;
   return 0;
@@ -269,42 +281,43 @@ int mpi_update_world_comm(void* world_comm) {
  *                   1: The header of a message.
  *                   2: The body (data) of a message.
  */
-int mpi_send(const void* buf, int count, MDI_Datatype datatype, MDI_Comm comm, int msg_flag) {
+int mpi_send(const void* buf, size_t count, MDI_Datatype datatype, MDI_Comm comm, int msg_flag) {
   // only send from rank 0
-  code* this_code = get_code(current_code);
+  code* this_code = get_code(active_context->current_code);
   if ( this_code->intra_rank != 0 ) {
     return 0;
   }
 
-  communicator* this = get_communicator(current_code, comm);
+  communicator* this = get_communicator(active_context->current_code, comm);
   mpi_method_data* method_data = (mpi_method_data*) this->method_data;
 
   // determine the datatype of the send buffer
-  MPI_Datatype mpi_type;
-  if (datatype == MDI_INT) {
-    mpi_type = MPI_INT;
-  }
-  else if (datatype == MDI_DOUBLE) {
-    mpi_type = MPI_DOUBLE;
-  }
-  else if (datatype == MDI_CHAR) {
-    mpi_type = MPI_CHAR;
-  }
-  else if (datatype == MDI_BYTE) {
-    mpi_type = MPI_BYTE;
-  }
-  else {
+  const datatype_info* info = datatype_get_info(datatype);
+  if ( info == NULL ) {
     mdi_error("MDI data type not recognized in mpi_send");
     return 1;
   }
 
+  // complex elements are transferred as pairs of scalar components
+  size_t ncomponents = info->size / info->word_size;
+
   // send the data
-  if ( method_data->use_mpi4py == 0 ) {
-    MPI_Send((void*)buf, count, mpi_type, (method_data->mpi_rank+1)%2, 0, method_data->mpi_comm);
-  }
-  else {
-    mpi4py_send_callback( (void*)buf, count, datatype, (method_data->mpi_rank+1)%2, this->id );
-  }
+  // MPI counts are limited to the range of an int, so large messages are sent in chunks
+  size_t offset = 0;
+  do {
+    size_t chunk = count - offset;
+    if ( chunk > MDI_MPI_MAX_CHUNK / ncomponents ) {
+      chunk = MDI_MPI_MAX_CHUNK / ncomponents;
+    }
+    char* chunk_buf = (char*)buf + offset * info->size;
+    if ( method_data->use_mpi4py == 0 ) {
+      MPI_Send((void*)chunk_buf, (int)( chunk * ncomponents ), info->mpi_type, (method_data->mpi_rank+1)%2, 0, method_data->mpi_comm);
+    }
+    else {
+      mpi4py_send_callback( (void*)chunk_buf, (int)chunk, datatype, (method_data->mpi_rank+1)%2, this->id );
+    }
+    offset += chunk;
+  } while ( offset < count );
 
   return 0;
 }
@@ -326,43 +339,177 @@ int mpi_send(const void* buf, int count, MDI_Datatype datatype, MDI_Comm comm, i
  *                   1: The header of a message.
  *                   2: The body (data) of a message.
  */
-int mpi_recv(void* buf, int count, MDI_Datatype datatype, MDI_Comm comm, int msg_flag) {
+int mpi_recv(void* buf, size_t count, MDI_Datatype datatype, MDI_Comm comm, int msg_flag) {
   // only recv from rank 0
-  code* this_code = get_code(current_code);
+  code* this_code = get_code(active_context->current_code);
   if ( this_code->intra_rank != 0 ) {
     return 0;
   }
 
-  communicator* this = get_communicator(current_code, comm);
+  communicator* this = get_communicator(active_context->current_code, comm);
   mpi_method_data* method_data = (mpi_method_data*) this->method_data;
 
   // determine the datatype of the receive buffer
-  MPI_Datatype mpi_type;
-  if (datatype == MDI_INT) {
-    mpi_type = MPI_INT;
+  const datatype_info* info = datatype_get_info(datatype);
+  if ( info == NULL ) {
+    mdi_error("MDI data type not recognized in mpi_recv");
+    return 1;
   }
-  else if (datatype == MDI_DOUBLE) {
-    mpi_type = MPI_DOUBLE;
+
+  // complex elements are transferred as pairs of scalar components
+  size_t ncomponents = info->size / info->word_size;
+
+  // receive the data
+  // MPI counts are limited to the range of an int, so large messages are received in chunks
+  size_t offset = 0;
+  do {
+    size_t chunk = count - offset;
+    if ( chunk > MDI_MPI_MAX_CHUNK / ncomponents ) {
+      chunk = MDI_MPI_MAX_CHUNK / ncomponents;
+    }
+    char* chunk_buf = (char*)buf + offset * info->size;
+    if ( method_data->use_mpi4py == 0 ) {
+      MPI_Recv((void*)chunk_buf, (int)( chunk * ncomponents ), info->mpi_type, (method_data->mpi_rank+1)%2, 0, method_data->mpi_comm, MPI_STATUS_IGNORE);
+    }
+    else {
+      mpi4py_recv_callback( (void*)chunk_buf, (int)chunk, datatype, (method_data->mpi_rank+1)%2, this->id );
+    }
+    offset += chunk;
+  } while ( offset < count );
+
+  return 0;
+}
+
+
+/*! \brief Create an MPI derived datatype that describes the layout of a strided array
+ *
+ * The function returns \p 0 on a success, and \p 1 if the layout cannot be described by a single
+ * MPI message that matches the messages sent by mpi_send and received by mpi_recv.
+ *
+ * \param [in]       desc
+ *                   Descriptor of the layout of the array.
+ * \param [in]       datatype
+ *                   MDI handle (MDI_INT, MDI_DOUBLE, MDI_CHAR, etc.) of the elements of the array.
+ * \param [out]      mpi_type
+ *                   Committed MPI datatype, which must be freed by the caller.
+ */
+static int mpi_strided_type(const strided_desc* desc, MDI_Datatype datatype, MPI_Datatype* mpi_type) {
+  const datatype_info* info = datatype_get_info(datatype);
+  if ( info == NULL ) {
+    return 1;
   }
-  else if (datatype == MDI_CHAR) {
-    mpi_type = MPI_CHAR;
+
+  // messages that mpi_send would split into chunks cannot be matched by a single derived datatype
+  size_t ncomponents = info->size / info->word_size;
+  if ( desc->count > MDI_MPI_MAX_CHUNK / ncomponents ) {
+    return 1;
   }
-  else if (datatype == MDI_BYTE) {
-    mpi_type = MPI_BYTE;
+  int idim;
+  for ( idim = 0; idim < desc->nouter; idim++ ) {
+    if ( desc->outer_shape[idim] > INT_MAX ) {
+      return 1;
+    }
   }
-  else {
-    mdi_error("MDI data type not recognized in mpi_send");
-    return 1;
+
+  // describe a single run, and then each dimension over which the runs are distributed
+  MPI_Datatype run_type;
+  MPI_Type_contiguous( (int)( desc->run_bytes / info->word_size ), info->mpi_type, &run_type );
+  for ( idim = desc->nouter - 1; idim >= 0; idim-- ) {
+    MPI_Datatype dim_type;
+    MPI_Type_create_hvector( (int)desc->outer_shape[idim], 1, (MPI_Aint)desc->outer_strides[idim],
+                             run_type, &dim_type );
+    MPI_Type_free( &run_type );
+    run_type = dim_type;
   }
+  MPI_Type_commit( &run_type );
+  *mpi_type = run_type;
 
-  // receive the data
-  if ( method_data->use_mpi4py == 0 ) {
-    MPI_Recv(buf, count, mpi_type, (method_data->mpi_rank+1)%2, 0, method_data->mpi_comm, MPI_STATUS_IGNORE);
+  return 0;
+}
+
+
+/*! \brief Send the body of a message from a strided array through an MDI connection, using MPI
+ *
+ * \param [in]       buf
+ *                   Pointer to the first element of the array.
+ * \param [in]       desc
+ *                   Descriptor of the layout of the array.
+ * \param [in]       datatype
+ *                   MDI handle (MDI_INT, MDI_DOUBLE, MDI_CHAR, etc.) corresponding to the type of data to be sent.
+ * \param [in]       comm
+ *                   MDI communicator associated with the intended recipient code.
+ */
+int mpi_send_strided(const void* buf, const strided_desc* desc, MDI_Datatype datatype, MDI_Comm comm) {
+  // only send from rank 0
+  code* this_code = get_code(active_context->current_code);
+  if ( this_code->intra_rank != 0 ) {
+    return 0;
   }
-  else {
-    mpi4py_recv_callback( buf, count, datatype, (method_data->mpi_rank+1)%2, this->id );
+
+  communicator* this = get_communicator(active_context->current_code, comm);
+  mpi_method_data* method_data = (mpi_method_data*) this->method_data;
+
+  // if the layout cannot be described by a derived datatype, pack the array
+  MPI_Datatype mpi_type;
+  if ( mpi_strided_type(desc, datatype, &mpi_type) != 0 ) {
+    void* packed = pool_alloc( desc->count * desc->elemsize );
+    if ( packed == NULL ) {
+      mdi_error("Error in MDI_Send_strided: unable to allocate packing buffer");
+      return 1;
+    }
+    strided_pack(desc, buf, 0, desc->nruns, packed);
+    int ret = mpi_send(packed, desc->count, datatype, comm, 2);
+    pool_free( packed );
+    return ret;
   }
 
+  MPI_Send((void*)buf, 1, mpi_type, (method_data->mpi_rank+1)%2, 0, method_data->mpi_comm);
+  MPI_Type_free( &mpi_type );
+
+  return 0;
+}
+
+
+/*! \brief Receive the body of a message into a strided array through an MDI connection, using MPI
+ *
+ * \param [out]      buf
+ *                   Pointer to the first element of the array.
+ * \param [in]       desc
+ *                   Descriptor of the layout of the array.
+ * \param [in]       datatype
+ *                   MDI handle (MDI_INT, MDI_DOUBLE, MDI_CHAR, etc.) corresponding to the type of data to be received.
+ * \param [in]       comm
+ *                   MDI communicator associated with the connection to the sending code.
+ */
+int mpi_recv_strided(void* buf, const strided_desc* desc, MDI_Datatype datatype, MDI_Comm comm) {
+  // only recv from rank 0
+  code* this_code = get_code(active_context->current_code);
+  if ( this_code->intra_rank != 0 ) {
+    return 0;
+  }
+
+  communicator* this = get_communicator(active_context->current_code, comm);
+  mpi_method_data* method_data = (mpi_method_data*) this->method_data;
+
+  // if the layout cannot be described by a derived datatype, receive into a packed buffer
+  MPI_Datatype mpi_type;
+  if ( mpi_strided_type(desc, datatype, &mpi_type) != 0 ) {
+    void* packed = pool_alloc( desc->count * desc->elemsize );
+    if ( packed == NULL ) {
+      mdi_error("Error in MDI_Recv_strided: unable to allocate packing buffer");
+      return 1;
+    }
+    int ret = mpi_recv(packed, desc->count, datatype, comm, 2);
+    if ( ret == 0 ) {
+      strided_unpack(desc, packed, 0, desc->nruns, buf);
+    }
+    pool_free( packed );
+    return ret;
+  }
+
+  MPI_Recv(buf, 1, mpi_type, (method_data->mpi_rank+1)%2, 0, method_data->mpi_comm, MPI_STATUS_IGNORE);
+  MPI_Type_free( &mpi_type );
+
   return 0;
 }
 
@@ -378,3 +525,116 @@ int communicator_delete_mpi(void* comm) {
 
   return 0;
 }
+
+
+/*! \brief MPI-specific information for a persistent request */
+typedef struct mpi_request_data_struct {
+  /*! \brief Persistent MPI request for the header of the message */
+  MPI_Request header_request;
+  /*! \brief Persistent MPI request for the body of the message */
+  MPI_Request body_request;
+  /*! \brief Header buffer bound to header_request */
+  int header[MDI_HEADER_LENGTH_EXT];
+} mpi_request_data;
+
+
+/*! \brief Transfer the header or body of a message through a persistent MPI request
+ *
+ * \param [in]       req
+ *                   The persistent request.
+ * \param [in]       msg_flag
+ *                   1: The header of the message.
+ *                   2: The body (data) of the message.
+ */
+static int mpi_request_transfer(request* req, int msg_flag) {
+  mpi_request_data* data = (mpi_request_data*) req->method_data;
+  if ( msg_flag == 1 ) {
+    MPI_Start( &data->header_request );
+    MPI_Wait( &data->header_request, MPI_STATUS_IGNORE );
+    if ( ! req->is_send ) {
+      memcpy(req->recv_header, data->header, req->nheader * sizeof(int));
+    }
+  }
+  else {
+    MPI_Start( &data->body_request );
+    MPI_Wait( &data->body_request, MPI_STATUS_IGNORE );
+  }
+  return 0;
+}
+
+
+/*! \brief Release the persistent MPI requests of a persistent request
+ *
+ * \param [in]       req
+ *                   The persistent request.
+ */
+static int mpi_request_delete(request* req) {
+  mpi_request_data* data = (mpi_request_data*) req->method_data;
+  MPI_Request_free( &data->header_request );
+  MPI_Request_free( &data->body_request );
+  free( data );
+  req->method_data = NULL;
+  return 0;
+}
+
+
+/*! \brief Bind persistent MPI requests to a persistent request
+ *
+ * The header and body of the message are each bound to a persistent MPI request, so that each
+ * use of the request only starts and completes the MPI requests.
+ * If the message is too large to be transferred in a single MPI call, or if mpi4py is used,
+ * no MPI requests are created and the request is serviced by mpi_send and mpi_recv.
+ * The function returns \p 0 on a success.
+ *
+ * \param [in,out]   req
+ *                   The persistent request.
+ * \param [in]       this_comm
+ *                   The communicator of the request.
+ */
+int mpi_request_init(request* req, communicator* this_comm) {
+  // only rank 0 communicates
+  code* this_code = get_code(active_context->current_code);
+  if ( this_code->intra_rank != 0 ) {
+    return 0;
+  }
+
+  mpi_method_data* method_data = (mpi_method_data*) this_comm->method_data;
+  if ( method_data->use_mpi4py != 0 ) {
+    return 0;
+  }
+
+  // messages that mpi_send would split into chunks are not bound to a single MPI request
+  const datatype_info* info = datatype_get_info(req->datatype);
+  const datatype_info* header_info = datatype_get_info(MDI_INT);
+  size_t ncomponents = info->size / info->word_size;
+  if ( req->count > MDI_MPI_MAX_CHUNK / ncomponents ) {
+    return 0;
+  }
+
+  mpi_request_data* data = malloc( sizeof(mpi_request_data) );
+  if ( data == NULL ) {
+    mdi_error("Error in persistent request: unable to allocate MPI request data");
+    return 1;
+  }
+  memcpy(data->header, req->header, sizeof(data->header));
+
+  int peer = (method_data->mpi_rank+1)%2;
+  int nheader = (int)req->nheader;
+  int nbody = (int)( req->count * ncomponents );
+  if ( req->is_send ) {
+    MPI_Send_init((void*)data->header, nheader, header_info->mpi_type, peer, 0, method_data->mpi_comm,
+                  &data->header_request);
+    MPI_Send_init(req->buf, nbody, info->mpi_type, peer, 0, method_data->mpi_comm, &data->body_request);
+  }
+  else {
+    MPI_Recv_init((void*)data->header, nheader, header_info->mpi_type, peer, 0, method_data->mpi_comm,
+                  &data->header_request);
+    MPI_Recv_init(req->buf, nbody, info->mpi_type, peer, 0, method_data->mpi_comm, &data->body_request);
+  }
+
+  req->method_data = data;
+  req->transfer = mpi_request_transfer;
+  req->delete = mpi_request_delete;
+
+  return 0;
+}
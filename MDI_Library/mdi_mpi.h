@@ -8,6 +8,11 @@
 
 #include <mpi.h>
 #include "mdi.h"
+#include "mdi_strided.h"
+#include "mdi_request.h"
+
+// Largest number of elements passed to a single MPI call, since MPI counts are of type int
+#define MDI_MPI_MAX_CHUNK 1073741824
 
 typedef struct mpi_data_struct {
   /*! \brief Inter-code MPI communicator */
@@ -26,10 +31,14 @@ int set_world_rank(int world_rank_in);
 
 int mpi_identify_codes(const char* code_name, int use_mpi4py, MPI_Comm world_comm);
 int mpi_update_world_comm(void* world_comm);
-int mpi_send_msg(const void* buf, int count, MDI_Datatype datatype, MDI_Comm comm);
-int mpi_recv_msg(void* buf, int count, MDI_Datatype datatype, MDI_Comm comm);
-int mpi_send(const void* buf, int count, MDI_Datatype datatype, MDI_Comm comm, int msg_flag);
-int mpi_recv(void* buf, int count, MDI_Datatype datatype, MDI_Comm comm, int msg_flag);
+int mpi_send_msg(const void* buf, size_t count, MDI_Datatype datatype, MDI_Comm comm);
+int mpi_recv_msg(void* buf, size_t count, MDI_Datatype datatype, MDI_Comm comm);
+int mpi_send(const void* buf, size_t count, MDI_Datatype datatype, MDI_Comm comm, int msg_flag);
+int mpi_recv(void* buf, size_t count, MDI_Datatype datatype, MDI_Comm comm, int msg_flag);
+int mpi_send_strided(const void* buf, const strided_desc* desc, MDI_Datatype datatype, MDI_Comm comm);
+int mpi_recv_strided(void* buf, const strided_desc* desc, MDI_Datatype datatype, MDI_Comm comm);
+
+int mpi_request_init(request* req, communicator* this_comm);
 
 int communicator_delete_mpi(void* comm);
 
@@ -0,0 +1,166 @@
+/*! \file
+ *
+ * \brief Reduced-precision wire format for double precision messages
+ *
+ * When a reduced precision has been negotiated for a communicator, every \p MDI_DOUBLE message
+ * is converted to IEEE single precision (float32) or to bfloat16 by the sender, and converted
+ * back to double precision by the receiver, so that the calling code always sees a buffer of
+ * doubles.  The conversion loops are written so that they are straightforward for compilers
+ * to vectorize.
+ *
+ * Error bounds, for finite values within the range of float32 (magnitude below 3.4e38):
+ *   - float32: round-to-nearest, relative error at most 2^-24 (about 6.0e-8) for normal
+ *     values; values with magnitude below 1.2e-38 lose relative precision, with an absolute
+ *     error of at most 7.0e-46.
+ *   - bfloat16: round-to-nearest-even, relative error at most 2^-9 + 2^-24 (about 2.0e-3) for
+ *     normal values; values with magnitude below 1.2e-38 have an absolute error of at most 4.6e-41.
+ * Values of larger magnitude become infinite, and infinities and NaNs are preserved.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include "mdi.h"
+#include "mdi_precision.h"
+
+/*! \brief Convert an array of doubles to float32 */
+static void double_to_float32(const double* in, size_t count, float* out) {
+  size_t i;
+  for ( i = 0; i < count; i++ ) {
+    out[i] = (float)in[i];
+  }
+}
+
+
+/*! \brief Convert an array of float32 values to doubles */
+static void float32_to_double(const float* in, size_t count, double* out) {
+  size_t i;
+  for ( i = 0; i < count; i++ ) {
+    out[i] = (double)in[i];
+  }
+}
+
+
+/*! \brief Convert an array of doubles to bfloat16, rounding to nearest even */
+static void double_to_bfloat16(const double* in, size_t count, uint16_t* out) {
+  size_t i;
+  for ( i = 0; i < count; i++ ) {
+    float value = (float)in[i];
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(uint32_t));
+    uint32_t rounded = ( bits + 0x7FFFu + ( ( bits >> 16 ) & 1u ) ) >> 16;
+    // keep NaNs quiet, rather than allowing the rounding to turn them into infinities
+    uint32_t is_nan = ( ( bits & 0x7FFFFFFFu ) > 0x7F800000u );
+    out[i] = (uint16_t)( is_nan ? ( ( bits >> 16 ) | 0x0040u ) : rounded );
+  }
+}
+
+
+/*! \brief Convert an array of bfloat16 values to doubles */
+static void bfloat16_to_double(const uint16_t* in, size_t count, double* out) {
+  size_t i;
+  for ( i = 0; i < count; i++ ) {
+    uint32_t bits = (uint32_t)in[i] << 16;
+    float value;
+    memcpy(&value, &bits, sizeof(float));
+    out[i] = (double)value;
+  }
+}
+
+
+/*! \brief Convert a double precision message to the precision negotiated for a communicator
+ *
+ * If a reduced precision applies to the message, the appropriate header flag is added to
+ * \p header_type, and \p wire_buf points to a buffer of \p wire_bytes bytes that was
+ * allocated from the buffer pool and must be returned to it by the caller.
+ * The function returns \p 0 on a success.
+ *
+ * \param [in]       comm
+ *                   Pointer to the communicator.
+ * \param [in]       buf
+ *                   Pointer to the data to be sent.
+ * \param [in]       count
+ *                   Number of elements in the message.
+ * \param [in]       datatype
+ *                   MDI handle (MDI_INT, MDI_DOUBLE, etc.) of the message.
+ * \param [out]      wire_buf
+ *                   Pointer to the data that should be sent.
+ * \param [out]      wire_bytes
+ *                   Number of bytes that should be sent.
+ * \param [in, out]  header_type
+ *                   Header flags describing the encoding.
+ */
+int precision_encode(communicator* comm, const void* buf, size_t count, MDI_Datatype datatype,
+                     void** wire_buf, size_t* wire_bytes, int* header_type) {
+  if ( datatype != MDI_DOUBLE || count == 0 ||
+       ! ( comm->features & ( MDI_FEATURE_FLOAT32 | MDI_FEATURE_BFLOAT16 ) ) ) {
+    return 0;
+  }
+
+  // messages are only exchanged by rank 0
+  code* this_code = get_code(active_context->current_code);
+  if ( this_code->intra_rank != 0 ) {
+    return 0;
+  }
+
+  if ( comm->features & MDI_FEATURE_BFLOAT16 ) {
+    uint16_t* out = pool_alloc( count * sizeof(uint16_t) );
+    if ( out == NULL ) {
+      mdi_error("Error in MDI_Send: unable to allocate reduced-precision buffer");
+      return 1;
+    }
+    double_to_bfloat16((const double*)buf, count, out);
+    *wire_buf = out;
+    *wire_bytes = count * sizeof(uint16_t);
+    *header_type |= MDI_HEADER_BFLOAT16;
+  }
+  else {
+    float* out = pool_alloc( count * sizeof(float) );
+    if ( out == NULL ) {
+      mdi_error("Error in MDI_Send: unable to allocate reduced-precision buffer");
+      return 1;
+    }
+    double_to_float32((const double*)buf, count, out);
+    *wire_buf = out;
+    *wire_bytes = count * sizeof(float);
+    *header_type |= MDI_HEADER_FLOAT32;
+  }
+
+  return 0;
+}
+
+
+/*! \brief Convert a reduced-precision message back to double precision
+ *
+ * The function returns \p 0 on a success.
+ *
+ * \param [in]       wire_buf
+ *                   Pointer to the reduced-precision data.
+ * \param [in]       wire_bytes
+ *                   Number of bytes of reduced-precision data.
+ * \param [in]       header_type
+ *                   Header flags describing the encoding.
+ * \param [out]      buf
+ *                   Pointer to the buffer of doubles where the data will be stored.
+ * \param [in]       count
+ *                   Number of elements in the message.
+ */
+int precision_decode(const void* wire_buf, size_t wire_bytes, int header_type,
+                     void* buf, size_t count) {
+  if ( header_type & MDI_HEADER_BFLOAT16 ) {
+    if ( wire_bytes != count * sizeof(uint16_t) ) {
+      mdi_error("Error in MDI_Recv: reduced-precision message has an inconsistent size");
+      return 1;
+    }
+    bfloat16_to_double((const uint16_t*)wire_buf, count, (double*)buf);
+  }
+  else {
+    if ( wire_bytes != count * sizeof(float) ) {
+      mdi_error("Error in MDI_Recv: reduced-precision message has an inconsistent size");
+      return 1;
+    }
+    float32_to_double((const float*)wire_buf, count, (double*)buf);
+  }
+  return 0;
+}
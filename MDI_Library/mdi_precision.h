@@ -0,0 +1,17 @@
+/*! \file
+ *
+ * \brief Reduced-precision wire format for double precision messages
+ */
+
+#ifndef MDI_PRECISION
+#define MDI_PRECISION
+
+#include "mdi.h"
+#include "mdi_global.h"
+
+int precision_encode(communicator* comm, const void* buf, size_t count, MDI_Datatype datatype,
+                     void** wire_buf, size_t* wire_bytes, int* header_type);
+int precision_decode(const void* wire_buf, size_t wire_bytes, int header_type,
+                     void* buf, size_t count);
+
+#endif
@@ -0,0 +1,288 @@
+/*! \file
+ *
+ * \brief Cache of the registries of connected codes
+ *
+ * A driver learns the nodes, commands, and callbacks of each engine through several queries.
+ * Engines that support MDI_FEATURE_REGISTRY_KEY identify their registry with a key, which
+ * consists of their name, their MDI version, and a hash of the lists that describe their registry.
+ * The first registry obtained for each key is held by the context, and is shared by every
+ * communicator to a code with that key, so that identical engines are only queried once.
+ * If a code sets the -registry_cache option, the cache is also read from, and appended to,
+ * a file, so that later runs do not need to query the engines at all.
+ */
+#ifdef _WIN32
+  #include <io.h>
+  #include <sys/stat.h>
+#else
+  #include <unistd.h>
+#endif
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "mdi.h"
+#include "mdi_regcache.h"
+#include "mdi_general.h"
+#include "mdi_global.h"
+
+// Largest number of characters in a list that is read from a registry cache file
+#define REGCACHE_MAX_LIST_COUNT ( 1 << 24 )
+
+
+/*! \brief Compute a hash of the lists that describe a registry
+ *
+ * \param [in]       lists
+ *                   The lists, indexed by MDI_LIST_COMMANDS, MDI_LIST_CALLBACKS, and MDI_LIST_NODES.
+ */
+int64_t regcache_hash(const name_list* lists) {
+  // 64-bit FNV-1a hash
+  uint64_t hash = 14695981039346656037ULL;
+  int ilist, ichar;
+  for (ilist = 0; ilist < MDI_NLISTS; ilist++) {
+    hash ^= (uint64_t)(unsigned int) lists[ilist].count;
+    hash *= 1099511628211ULL;
+    for (ichar = 0; ichar < lists[ilist].count; ichar++) {
+      hash ^= (unsigned char) lists[ilist].data[ichar];
+      hash *= 1099511628211ULL;
+    }
+  }
+  return (int64_t) hash;
+}
+
+
+/*! \brief Determine whether two registry keys are equal
+ */
+static int regcache_key_equal(const registry_key* a, const registry_key* b) {
+  return strncmp(a->name, b->name, NAME_LENGTH) == 0 &&
+    a->mdi_version[0] == b->mdi_version[0] &&
+    a->mdi_version[1] == b->mdi_version[1] &&
+    a->mdi_version[2] == b->mdi_version[2] &&
+    a->hash == b->hash;
+}
+
+
+/*! \brief Return the cached registry with a particular key, or NULL if there is none
+ *
+ * The file is not consulted.
+ *
+ * \param [in]       key
+ *                   Key that identifies the registry.
+ */
+static registry* regcache_lookup(const registry_key* key) {
+  if ( ! active_context->registry_cache_initialized ) {
+    return NULL;
+  }
+  size_t ientry;
+  for (ientry = 0; ientry < active_context->registry_cache.size; ientry++) {
+    registry_cache_entry* entry = vector_get(&active_context->registry_cache, ientry);
+    if ( regcache_key_equal(&entry->key, key) ) {
+      return entry->nodes;
+    }
+  }
+  return NULL;
+}
+
+
+/*! \brief Add a registry to the cache of the active context, which takes ownership of it
+ *
+ * \param [in]       key
+ *                   Key that identifies the registry.
+ * \param [in]       nodes
+ *                   The registry.
+ */
+static int regcache_add(const registry_key* key, registry* nodes) {
+  if ( ! active_context->registry_cache_initialized ) {
+    vector_init(&active_context->registry_cache, sizeof(registry_cache_entry));
+    active_context->registry_cache_initialized = 1;
+  }
+  registry_cache_entry entry;
+  entry.key = *key;
+  entry.nodes = nodes;
+  return vector_push_back(&active_context->registry_cache, &entry);
+}
+
+
+/*! \brief Read the registries in a registry cache file into the cache of the active context
+ *
+ * A missing file is treated as an empty cache.
+ * Reading stops at the first record that is incomplete or not recognized, and records whose
+ * lists do not match their hash are skipped.
+ * The function returns \p 0 on a success.
+ *
+ * \param [in]       path
+ *                   Path to the file.
+ */
+static int regcache_load(const char* path) {
+  FILE* file = fopen(path, "rb");
+  if ( file == NULL ) {
+    return 0;
+  }
+
+  registry_cache_record record;
+  while ( fread(&record, sizeof(registry_cache_record), 1, file) == 1 ) {
+    if ( memcmp(record.magic, REGCACHE_MAGIC, sizeof(record.magic)) != 0 ) {
+      break;
+    }
+
+    // read the lists
+    name_list lists[MDI_NLISTS];
+    int ilist;
+    int complete = 1;
+    for (ilist = 0; ilist < MDI_NLISTS; ilist++) {
+      lists[ilist].data = NULL;
+    }
+    for (ilist = 0; ilist < MDI_NLISTS && complete; ilist++) {
+      lists[ilist].count = record.count[ilist];
+      lists[ilist].nnames = record.nnames[ilist];
+      if ( record.count[ilist] < 0 || record.count[ilist] > REGCACHE_MAX_LIST_COUNT ) {
+        complete = 0;
+        break;
+      }
+      lists[ilist].data = malloc( ( record.count[ilist] + 1 ) * sizeof(char) );
+      if ( fread(lists[ilist].data, 1, record.count[ilist], file) != (size_t) record.count[ilist] ) {
+        complete = 0;
+        break;
+      }
+      lists[ilist].data[ record.count[ilist] ] = '\0';
+    }
+
+    // form the registry, unless it is already cached
+    record.key.name[NAME_LENGTH - 1] = '\0';
+    if ( complete && regcache_hash(lists) == record.key.hash && regcache_lookup(&record.key) == NULL ) {
+      registry* nodes = new_node_registry();
+      if ( parse_name_lists(nodes, lists) == 0 ) {
+        regcache_add(&record.key, nodes);
+      }
+      else {
+        free_node_registry(nodes);
+      }
+    }
+
+    for (ilist = 0; ilist < MDI_NLISTS; ilist++) {
+      free( lists[ilist].data );
+    }
+    if ( ! complete ) {
+      break;
+    }
+  }
+
+  fclose(file);
+  return 0;
+}
+
+
+/*! \brief Return the cached registry with a particular key, or NULL if there is none
+ *
+ * The first time this is called by a code with the -registry_cache option, the file is read.
+ *
+ * \param [in]       this_code
+ *                   The code that is looking up the registry of a connected code.
+ * \param [in]       key
+ *                   Key that identifies the registry.
+ */
+registry* regcache_find(code* this_code, const registry_key* key) {
+  if ( this_code->registry_cache_path != NULL && ! this_code->registry_cache_loaded ) {
+    regcache_load(this_code->registry_cache_path);
+    this_code->registry_cache_loaded = 1;
+  }
+  return regcache_lookup(key);
+}
+
+
+/*! \brief Add the registry of a connected code to the cache, which takes ownership of it
+ *
+ * If the code has the -registry_cache option, the registry is also appended to the file.
+ * The function returns \p 0 on a success.
+ * If the registry could not be added to the cache, \p owned is set to \p 0 and the caller
+ * keeps ownership of the registry; otherwise \p owned is set to \p 1, even if the registry could
+ * not be written to the file.
+ *
+ * \param [in]       this_code
+ *                   The code that obtained the registry.
+ * \param [in]       key
+ *                   Key that identifies the registry.
+ * \param [in]       nodes
+ *                   The registry, which must not be modified after this call.
+ * \param [in]       lists
+ *                   The lists from which the registry was formed.
+ * \param [out]      owned
+ *                   Flag whether the cache took ownership of the registry.
+ */
+int regcache_insert(code* this_code, const registry_key* key, registry* nodes, const name_list* lists,
+                    int* owned) {
+  *owned = 0;
+  int ret = regcache_add(key, nodes);
+  if ( ret != 0 ) {
+    mdi_error("Error in MDI: Unable to add a registry to the registry cache");
+    return ret;
+  }
+  *owned = 1;
+  if ( this_code->registry_cache_path == NULL ) {
+    return 0;
+  }
+
+  // each record is appended with a single write to a descriptor opened with O_APPEND, so that
+  // the records of several codes that share the file are not interleaved
+  registry_cache_record record;
+  memset(&record, 0, sizeof(registry_cache_record));
+  memcpy(record.magic, REGCACHE_MAGIC, sizeof(record.magic));
+  record.key = *key;
+  size_t nbytes = sizeof(registry_cache_record);
+  int ilist;
+  for (ilist = 0; ilist < MDI_NLISTS; ilist++) {
+    record.count[ilist] = lists[ilist].count;
+    record.nnames[ilist] = lists[ilist].nnames;
+    nbytes += lists[ilist].count;
+  }
+  char* buf = malloc(nbytes);
+  memcpy(buf, &record, sizeof(registry_cache_record));
+  size_t offset = sizeof(registry_cache_record);
+  for (ilist = 0; ilist < MDI_NLISTS; ilist++) {
+    memcpy(buf + offset, lists[ilist].data, lists[ilist].count);
+    offset += lists[ilist].count;
+  }
+
+#ifdef _WIN32
+  int fd = _open(this_code->registry_cache_path, _O_WRONLY | _O_APPEND | _O_CREAT | _O_BINARY,
+                 _S_IREAD | _S_IWRITE);
+#else
+  int fd = open(this_code->registry_cache_path, O_WRONLY | O_APPEND | O_CREAT, 0644);
+#endif
+  if ( fd < 0 ) {
+    free( buf );
+    mdi_error("Error in MDI: Unable to open the registry cache file");
+    return 1;
+  }
+#ifdef _WIN32
+  int nwritten = _write(fd, buf, (unsigned int)nbytes);
+  _close(fd);
+#else
+  ssize_t nwritten = write(fd, buf, nbytes);
+  close(fd);
+#endif
+  if ( nwritten < 0 || (size_t)nwritten != nbytes ) {
+    ret = 1;
+    mdi_error("Error in MDI: Unable to write to the registry cache file");
+  }
+  free( buf );
+  return ret;
+}
+
+
+/*! \brief Free the registry cache of the active context
+ *
+ * Any communicators that share a cached registry must already have been deleted.
+ */
+int regcache_free() {
+  if ( ! active_context->registry_cache_initialized ) {
+    return 0;
+  }
+  size_t ientry;
+  for (ientry = 0; ientry < active_context->registry_cache.size; ientry++) {
+    registry_cache_entry* entry = vector_get(&active_context->registry_cache, ientry);
+    free_node_registry(entry->nodes);
+  }
+  vector_free(&active_context->registry_cache);
+  active_context->registry_cache_initialized = 0;
+  return 0;
+}
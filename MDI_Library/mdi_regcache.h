@@ -0,0 +1,50 @@
+/*! \file
+ *
+ * \brief Cache of the registries of connected codes
+ */
+
+#ifndef MDI_REGCACHE
+#define MDI_REGCACHE
+
+#include <stdint.h>
+#include "mdi.h"
+#include "mdi_global.h"
+
+// Marker at the start of each record of a registry cache file
+#define REGCACHE_MAGIC "MDIREGC1"
+
+typedef struct registry_key_struct {
+  /*! \brief Name of the connected code */
+  char name[NAME_LENGTH];
+  /*! \brief MDI version of the connected code */
+  int mdi_version[3];
+  /*! \brief Hash of the lists that describe the registry of the connected code */
+  int64_t hash;
+} registry_key;
+
+typedef struct registry_cache_entry_struct {
+  /*! \brief Key that identifies the registry */
+  registry_key key;
+  /*! \brief The registry, which is shared by every communicator to a code with this key */
+  registry* nodes;
+} registry_cache_entry;
+
+typedef struct registry_cache_record_struct {
+  /*! \brief REGCACHE_MAGIC, without a terminating null character */
+  char magic[8];
+  /*! \brief Key that identifies the registry */
+  registry_key key;
+  /*! \brief Number of characters in each list, indexed by MDI_LIST_COMMANDS, MDI_LIST_CALLBACKS, and MDI_LIST_NODES.
+  The lists follow the record in the same order. */
+  int count[MDI_NLISTS];
+  /*! \brief Number of commands or callbacks in each list */
+  int nnames[MDI_NLISTS];
+} registry_cache_record;
+
+int64_t regcache_hash(const name_list* lists);
+registry* regcache_find(code* this_code, const registry_key* key);
+int regcache_insert(code* this_code, const registry_key* key, registry* nodes, const name_list* lists,
+                    int* owned);
+int regcache_free();
+
+#endif
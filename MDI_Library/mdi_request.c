@@ -0,0 +1,275 @@
+/*! \file
+ *
+ * \brief Persistent send and receive operations
+ *
+ * A persistent request binds a buffer, count, datatype, and communicator once, so that the
+ * same message can be sent or received repeatedly with little per-message overhead.
+ * When a request is created, its datatype and count are validated, its header is built,
+ * and any method-specific resources are bound to it.
+ * Each call to request_start then only transfers the header and body of the message.
+ *
+ * If the header of the message cannot be built in advance, either because the connected code
+ * does not exchange headers or because codecs were negotiated for the communicator,
+ * request_start falls back to general_send and general_recv.
+ * It also falls back to them while filter stages are attached to the communicator.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include "mdi.h"
+#include "mdi_global.h"
+#include "mdi_general.h"
+#include "mdi_request.h"
+#include "mdi_datatype.h"
+#include "mdi_units.h"
+#include "mdi_mpi.h"
+
+
+/*! \brief Return the request that corresponds to a request handle, or NULL if there is none
+ *
+ * \param [in]       handle
+ *                   Handle of the request.
+ */
+static request* get_request(MDI_Request handle) {
+  if ( ! active_context->requests_initialized || handle < 1 || (size_t)handle > active_context->requests.size ) {
+    return NULL;
+  }
+  request* req = vector_get(&active_context->requests, handle - 1);
+  if ( ! req->active ) {
+    return NULL;
+  }
+  return req;
+}
+
+
+/*! \brief Create a persistent send or receive request
+ *
+ * The function returns \p 0 on a success.
+ *
+ * \param [in]       buf
+ *                   Buffer from which data is sent, or into which data is received.
+ * \param [in]       count
+ *                   Number of values (integers, double precision floats, characters, etc.) in the buffer.
+ * \param [in]       datatype
+ *                   MDI handle (MDI_INT, MDI_DOUBLE, MDI_CHAR, etc.) of the values in the buffer.
+ * \param [in]       comm
+ *                   MDI communicator through which the data is transferred.
+ * \param [in]       is_send
+ *                   \p 1 for a send request, or \p 0 for a receive request.
+ * \param [out]      handle
+ *                   Handle of the new request.
+ */
+int request_init(void* buf, size_t count, MDI_Datatype datatype, MDI_Comm comm, int is_send,
+                 MDI_Request* handle) {
+  *handle = MDI_REQUEST_NULL;
+
+  if ( datatype_size(datatype) == 0 ) {
+    mdi_error("MDI data type not recognized when creating a persistent request");
+    return 1;
+  }
+
+  // find the communicator
+  communicator* this_comm = get_communicator(active_context->current_code, comm);
+  if ( this_comm == NULL ) {
+    mdi_error("Communicator not found when creating a persistent request");
+    return 1;
+  }
+
+  request new_req;
+  new_req.active = 1;
+  new_req.is_send = is_send;
+  new_req.buf = buf;
+  new_req.count = count;
+  new_req.datatype = datatype;
+  new_req.code_id = active_context->current_code;
+  new_req.comm = comm;
+  new_req.method_data = NULL;
+  new_req.transfer = NULL;
+  new_req.delete = NULL;
+
+  // build the header, if it does not change from one message to the next
+  new_req.prebuilt = ( this_comm->mdi_version[0] > 1 ||
+                       ( this_comm->mdi_version[0] == 1 && this_comm->mdi_version[1] >= 1 ) )
+                     && active_context->ipi_compatibility != 1
+                     && ! ( this_comm->features & MDI_FEATURE_CODECS );
+  new_req.nheader = ( this_comm->features != 0 ) ? MDI_HEADER_LENGTH_EXT : MDI_HEADER_LENGTH;
+  if ( count > INT_MAX && ! ( this_comm->features & MDI_FEATURE_LARGE_COUNT ) ) {
+    mdi_error("Error in persistent request: count exceeds the limit supported by the connected code");
+    return 1;
+  }
+  new_req.header[0] = 0;
+  new_req.header[1] = 0;
+  new_req.header[2] = datatype;
+  new_req.header[3] = (int)( count & 0x7FFFFFFF );
+  new_req.header[4] = 0;
+  new_req.header[5] = 0;
+  new_req.header[6] = (int)( count >> 31 );
+  new_req.header[7] = 0;
+
+  // bind any method-specific resources
+  if ( new_req.prebuilt && this_comm->method == MDI_MPI ) {
+    int ret = mpi_request_init(&new_req, this_comm);
+    if ( ret != 0 ) {
+      mdi_error("Error in persistent request: unable to create MPI requests");
+      return ret;
+    }
+  }
+
+  // store the request, reusing the slot of a freed request if possible
+  if ( ! active_context->requests_initialized ) {
+    vector_init(&active_context->requests, sizeof(request));
+    active_context->requests_initialized = 1;
+  }
+  size_t ireq;
+  for ( ireq = 0; ireq < active_context->requests.size; ireq++ ) {
+    request* old_req = vector_get(&active_context->requests, (int)ireq);
+    if ( ! old_req->active ) {
+      *old_req = new_req;
+      *handle = (MDI_Request)( ireq + 1 );
+      return 0;
+    }
+  }
+  vector_push_back(&active_context->requests, &new_req);
+  *handle = (MDI_Request)active_context->requests.size;
+
+  return 0;
+}
+
+
+/*! \brief Perform the send or receive described by a persistent request
+ *
+ * The function returns once the operation has completed.
+ * If running with MPI, this function must be called only by rank \p 0.
+ * The function returns \p 0 on a success.
+ *
+ * \param [in]       handle
+ *                   Handle of the request.
+ */
+int request_start(MDI_Request handle) {
+  int ret;
+  request* req = get_request(handle);
+  if ( req == NULL ) {
+    mdi_error("MDI_Start called with an invalid request");
+    return 1;
+  }
+
+  // if the header may change, use the ordinary path
+  if ( ! req->prebuilt ) {
+    if ( req->is_send ) {
+      return general_send(req->buf, req->count, req->datatype, req->comm);
+    }
+    return general_recv(req->buf, req->count, req->datatype, req->comm);
+  }
+
+  communicator* this = get_communicator(req->code_id, req->comm);
+  if ( this == NULL ) {
+    return 1;
+  }
+
+  // the prebuilt path bypasses any filter stages attached after the request was created
+  if ( this->nfilters > 0 ) {
+    if ( req->is_send ) {
+      return general_send(req->buf, req->count, req->datatype, req->comm);
+    }
+    return general_recv(req->buf, req->count, req->datatype, req->comm);
+  }
+
+  if ( req->is_send ) {
+    // send the header
+    if ( req->transfer != NULL ) {
+      ret = req->transfer(req, 1);
+    }
+    else {
+      ret = this->send((void*)req->header, req->nheader, MDI_INT, req->comm, 1);
+    }
+    if ( ret != 0 ) { return ret; }
+
+    // send the data
+    if ( req->transfer != NULL ) {
+      ret = req->transfer(req, 2);
+    }
+    else {
+      ret = this->send(req->buf, req->count, req->datatype, req->comm, 2);
+    }
+    if ( ret != 0 ) { return ret; }
+    this->command_msg++;
+  }
+  else {
+    // receive the header
+    // it is initialized with the expected data, which is important when ranks other than 0 call this function
+    memcpy(req->recv_header, req->header, req->nheader * sizeof(int));
+    if ( req->transfer != NULL ) {
+      ret = req->transfer(req, 1);
+    }
+    else {
+      ret = this->recv((void*)req->recv_header, req->nheader, MDI_INT, req->comm, 1);
+    }
+    if ( ret != 0 ) { return ret; }
+
+    // verify that the header matches the request
+    // the only difference that is accepted is a unit tag
+    int unit_id = 0;
+    if ( memcmp(req->recv_header, req->header, req->nheader * sizeof(int)) != 0 ) {
+      if ( req->recv_header[0] != 0 ) {
+        mdi_error("Error in MDI_Start: nonzero error flag received");
+        return req->recv_header[0];
+      }
+      if ( req->nheader != MDI_HEADER_LENGTH_EXT || req->recv_header[1] != MDI_HEADER_UNITS ||
+           ! ( this->features & MDI_FEATURE_UNITS ) ||
+           memcmp(&req->recv_header[2], &req->header[2], 5 * sizeof(int)) != 0 ) {
+        mdi_error("Error in MDI_Start: received message does not match the request");
+        return 1;
+      }
+      unit_id = req->recv_header[7];
+    }
+
+    // receive the data
+    if ( req->transfer != NULL ) {
+      ret = req->transfer(req, 2);
+    }
+    else {
+      ret = this->recv(req->buf, req->count, req->datatype, req->comm, 2);
+    }
+    if ( ret != 0 ) { return ret; }
+    this->command_msg++;
+
+    // convert data that was sent in a unit other than atomic units
+    if ( unit_id != 0 ) {
+      double factor = 1.0;
+      ret = units_factor(unit_id, NULL, &factor);
+      if ( ret == 0 && factor != 1.0 ) {
+        ret = units_scale(req->buf, req->count, req->datatype, factor);
+      }
+      if ( ret != 0 ) { return ret; }
+    }
+  }
+
+  return 0;
+}
+
+
+/*! \brief Free a persistent request
+ *
+ * The function returns \p 0 on a success.
+ *
+ * \param [in,out]   handle
+ *                   Handle of the request, which is set to \p MDI_REQUEST_NULL.
+ */
+int request_free(MDI_Request* handle) {
+  request* req = get_request(*handle);
+  if ( req == NULL ) {
+    mdi_error("MDI_Request_free called with an invalid request");
+    return 1;
+  }
+
+  // release any method-specific resources
+  if ( req->delete != NULL ) {
+    req->delete(req);
+  }
+  req->active = 0;
+  *handle = MDI_REQUEST_NULL;
+
+  return 0;
+}
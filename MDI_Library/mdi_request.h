@@ -0,0 +1,50 @@
+/*! \file
+ *
+ * \brief Persistent send and receive operations
+ */
+
+#ifndef MDI_REQUEST
+#define MDI_REQUEST
+
+#include "mdi.h"
+#include "mdi_global.h"
+
+typedef struct request_struct {
+  /*! \brief Flag whether this request handle is in use */
+  int active;
+  /*! \brief Flag whether this is a send request (1) or a receive request (0) */
+  int is_send;
+  /*! \brief Buffer from which data is sent, or into which data is received */
+  void* buf;
+  /*! \brief Number of elements in the buffer */
+  size_t count;
+  /*! \brief MDI datatype of the elements in the buffer */
+  MDI_Datatype_Type datatype;
+  /*! \brief Handle of the code that created this request */
+  int code_id;
+  /*! \brief MDI communicator through which the data is transferred */
+  MDI_Comm_Type comm;
+  /*! \brief Flag whether the header is fixed, so that it can be built once when the request is created.
+  This is not the case if the connected code does not exchange headers, or if any codecs were negotiated. */
+  int prebuilt;
+  /*! \brief Number of elements in the header */
+  size_t nheader;
+  /*! \brief The header that is sent, or that is expected to be received */
+  int header[MDI_HEADER_LENGTH_EXT];
+  /*! \brief Buffer into which the header is received */
+  int recv_header[MDI_HEADER_LENGTH_EXT];
+  /*! \brief Method-specific information for this request */
+  void* method_data;
+  /*! \brief Function pointer for method-specific transfers of the header (msg_flag 1) or body
+  (msg_flag 2) of the message, or NULL if the communicator's send and recv functions are used */
+  int (*transfer)(struct request_struct*, int);
+  /*! \brief Function pointer for method-specific deletion operations, or NULL */
+  int (*delete)(struct request_struct*);
+} request;
+
+int request_init(void* buf, size_t count, MDI_Datatype datatype, MDI_Comm comm, int is_send,
+                 MDI_Request* handle);
+int request_start(MDI_Request handle);
+int request_free(MDI_Request* handle);
+
+#endif
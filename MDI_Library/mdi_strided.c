@@ -0,0 +1,315 @@
+/*! \file
+ *
+ * \brief Strided and multi-dimensional array descriptors
+ *
+ * A strided array is described by a base pointer, an element type, and the extent and byte
+ * stride of each of its dimensions, listed from the slowest-varying dimension to the fastest.
+ * On the wire, a strided array is identical to the contiguous array obtained by walking its
+ * elements in that order, so a strided send can be matched by an ordinary receive and vice
+ * versa.
+ *
+ * When a descriptor is created, dimensions of extent one are discarded, the innermost
+ * dimensions that are contiguous in memory are merged into runs of bytes, and the remaining
+ * dimensions are merged wherever they are contiguous with respect to each other.  Transports
+ * then move whole runs at a time.
+ *
+ * The most common use is the conversion between a structure-of-arrays layout, in which the
+ * x, y, and z coordinates of N atoms are stored as a 3xN array, and the Nx3 layout used on the
+ * wire.  Such an array is described by a shape of {N, 3} and strides of
+ * {sizeof(double), N * sizeof(double)}, and has a dedicated copy loop.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include "mdi.h"
+#include "mdi_global.h"
+#include "mdi_strided.h"
+#include "mdi_datatype.h"
+
+/*! \brief Initialize a descriptor for a strided array
+ *
+ * The function returns \p 0 on a success.
+ *
+ * \param [out]      desc
+ *                   Descriptor to initialize.
+ * \param [in]       ndims
+ *                   Number of dimensions of the array.
+ * \param [in]       shape
+ *                   Extent of each dimension of the array, slowest first.
+ * \param [in]       strides
+ *                   Distance in memory, in bytes, between consecutive elements of each dimension.
+ * \param [in]       datatype
+ *                   MDI handle (MDI_INT, MDI_DOUBLE, MDI_CHAR, etc.) of the elements of the array.
+ */
+int strided_init(strided_desc* desc, int ndims, const int64_t* shape, const int64_t* strides,
+                 MDI_Datatype datatype) {
+  if ( ndims < 1 || ndims > STRIDED_MAX_DIMS ) {
+    mdi_error("Invalid number of dimensions for a strided array");
+    return 1;
+  }
+  size_t elemsize = datatype_size(datatype);
+  if ( elemsize == 0 ) {
+    mdi_error("MDI data type not recognized for a strided array");
+    return 1;
+  }
+
+  // discard any dimensions of extent one
+  size_t dims_shape[STRIDED_MAX_DIMS];
+  ptrdiff_t dims_strides[STRIDED_MAX_DIMS];
+  size_t count = 1;
+  int ndims_kept = 0;
+  int idim;
+  for ( idim = 0; idim < ndims; idim++ ) {
+    if ( shape[idim] < 0 ) {
+      mdi_error("Negative extent for a strided array");
+      return 1;
+    }
+    count *= (size_t)shape[idim];
+    if ( shape[idim] != 1 ) {
+      dims_shape[ndims_kept] = (size_t)shape[idim];
+      dims_strides[ndims_kept] = (ptrdiff_t)strides[idim];
+      ndims_kept++;
+    }
+  }
+
+  desc->count = count;
+  desc->elemsize = elemsize;
+  desc->run_bytes = elemsize;
+  desc->nruns = 0;
+  desc->nouter = 0;
+  if ( count == 0 ) {
+    return 0;
+  }
+
+  // merge the innermost contiguous dimensions into runs
+  while ( ndims_kept > 0 && dims_strides[ndims_kept - 1] == (ptrdiff_t)desc->run_bytes ) {
+    desc->run_bytes *= dims_shape[ndims_kept - 1];
+    ndims_kept--;
+  }
+
+  // merge the remaining dimensions wherever they are contiguous with respect to each other
+  desc->nruns = 1;
+  for ( idim = 0; idim < ndims_kept; idim++ ) {
+    int last = desc->nouter - 1;
+    if ( last >= 0 &&
+         desc->outer_strides[last] == dims_strides[idim] * (ptrdiff_t)dims_shape[idim] ) {
+      desc->outer_shape[last] *= dims_shape[idim];
+      desc->outer_strides[last] = dims_strides[idim];
+    }
+    else {
+      desc->outer_shape[desc->nouter] = dims_shape[idim];
+      desc->outer_strides[desc->nouter] = dims_strides[idim];
+      desc->nouter++;
+    }
+    desc->nruns *= dims_shape[idim];
+  }
+
+  return 0;
+}
+
+
+/*! \brief Return the offset, in bytes, of a run of a strided array from its base pointer
+ *
+ * \param [in]       desc
+ *                   Descriptor of the array.
+ * \param [in]       irun
+ *                   Index of the run.
+ */
+ptrdiff_t strided_run_offset(const strided_desc* desc, size_t irun) {
+  ptrdiff_t offset = 0;
+  int idim;
+  for ( idim = desc->nouter - 1; idim >= 0; idim-- ) {
+    offset += (ptrdiff_t)( irun % desc->outer_shape[idim] ) * desc->outer_strides[idim];
+    irun /= desc->outer_shape[idim];
+  }
+  return offset;
+}
+
+
+/*! \brief Copy equally spaced runs between a strided array and a contiguous buffer
+ */
+static inline void strided_copy_runs(char* ptr, ptrdiff_t stride, size_t nruns, size_t run_bytes,
+                                     char* packed, int unpack) {
+  size_t irun;
+  if ( run_bytes == sizeof(uint64_t) ) {
+    for ( irun = 0; irun < nruns; irun++ ) {
+      if ( unpack ) { memcpy(ptr, packed, sizeof(uint64_t)); }
+      else          { memcpy(packed, ptr, sizeof(uint64_t)); }
+      ptr += stride;
+      packed += sizeof(uint64_t);
+    }
+  }
+  else if ( run_bytes == sizeof(uint32_t) ) {
+    for ( irun = 0; irun < nruns; irun++ ) {
+      if ( unpack ) { memcpy(ptr, packed, sizeof(uint32_t)); }
+      else          { memcpy(packed, ptr, sizeof(uint32_t)); }
+      ptr += stride;
+      packed += sizeof(uint32_t);
+    }
+  }
+  else {
+    for ( irun = 0; irun < nruns; irun++ ) {
+      if ( unpack ) { memcpy(ptr, packed, run_bytes); }
+      else          { memcpy(packed, ptr, run_bytes); }
+      ptr += stride;
+      packed += run_bytes;
+    }
+  }
+}
+
+
+/*! \brief Copy complete rows of doubles between a 3xN array and a contiguous Nx3 buffer
+ */
+static void strided_copy_xyz(char* ptr, ptrdiff_t row_stride, ptrdiff_t col_stride, size_t nrows,
+                             double* packed, int unpack) {
+  size_t irow;
+  if ( unpack ) {
+    for ( irow = 0; irow < nrows; irow++ ) {
+      memcpy(ptr, &packed[0], sizeof(double));
+      memcpy(ptr + col_stride, &packed[1], sizeof(double));
+      memcpy(ptr + 2 * col_stride, &packed[2], sizeof(double));
+      ptr += row_stride;
+      packed += 3;
+    }
+  }
+  else {
+    for ( irow = 0; irow < nrows; irow++ ) {
+      memcpy(&packed[0], ptr, sizeof(double));
+      memcpy(&packed[1], ptr + col_stride, sizeof(double));
+      memcpy(&packed[2], ptr + 2 * col_stride, sizeof(double));
+      ptr += row_stride;
+      packed += 3;
+    }
+  }
+}
+
+
+/*! \brief Copy a range of runs between a strided array and a contiguous buffer
+ */
+static void strided_copy(const strided_desc* desc, char* base, size_t first_run, size_t nruns,
+                         char* packed, int unpack) {
+  size_t run_bytes = desc->run_bytes;
+  if ( nruns == 0 ) {
+    return;
+  }
+
+  // the array is contiguous
+  if ( desc->nouter == 0 ) {
+    if ( unpack ) { memcpy(base, packed, nruns * run_bytes); }
+    else          { memcpy(packed, base, nruns * run_bytes); }
+    return;
+  }
+
+  // the runs are equally spaced
+  int inner = desc->nouter - 1;
+  if ( desc->nouter == 1 ) {
+    strided_copy_runs(base + (ptrdiff_t)first_run * desc->outer_strides[0], desc->outer_strides[0],
+                      nruns, run_bytes, packed, unpack);
+    return;
+  }
+
+  // conversion between 3xN and Nx3 arrays of doubles
+  if ( desc->nouter == 2 && desc->outer_shape[1] == 3 && run_bytes == sizeof(double) ) {
+    size_t icol = first_run % 3;
+
+    // complete any partial row at the start of the range
+    if ( icol != 0 ) {
+      size_t n = 3 - icol;
+      if ( n > nruns ) {
+        n = nruns;
+      }
+      strided_copy_runs(base + strided_run_offset(desc, first_run), desc->outer_strides[1],
+                        n, run_bytes, packed, unpack);
+      first_run += n;
+      nruns -= n;
+      packed += n * run_bytes;
+    }
+
+    // copy the complete rows
+    size_t nrows = nruns / 3;
+    if ( nrows > 0 ) {
+      strided_copy_xyz(base + strided_run_offset(desc, first_run), desc->outer_strides[0],
+                       desc->outer_strides[1], nrows, (double*)packed, unpack);
+      first_run += 3 * nrows;
+      nruns -= 3 * nrows;
+      packed += 3 * nrows * run_bytes;
+    }
+
+    // copy any partial row at the end of the range
+    if ( nruns > 0 ) {
+      strided_copy_runs(base + strided_run_offset(desc, first_run), desc->outer_strides[1],
+                        nruns, run_bytes, packed, unpack);
+    }
+    return;
+  }
+
+  // general case: walk the innermost dimension in blocks, carrying into the outer dimensions
+  size_t index[STRIDED_MAX_DIMS];
+  size_t irun = first_run;
+  int idim;
+  for ( idim = inner; idim >= 0; idim-- ) {
+    index[idim] = irun % desc->outer_shape[idim];
+    irun /= desc->outer_shape[idim];
+  }
+  while ( nruns > 0 ) {
+    ptrdiff_t offset = 0;
+    for ( idim = 0; idim <= inner; idim++ ) {
+      offset += (ptrdiff_t)index[idim] * desc->outer_strides[idim];
+    }
+    size_t n = desc->outer_shape[inner] - index[inner];
+    if ( n > nruns ) {
+      n = nruns;
+    }
+    strided_copy_runs(base + offset, desc->outer_strides[inner], n, run_bytes, packed, unpack);
+    packed += n * run_bytes;
+    nruns -= n;
+
+    // advance to the start of the next block
+    index[inner] = 0;
+    for ( idim = inner - 1; idim >= 0; idim-- ) {
+      index[idim]++;
+      if ( index[idim] < desc->outer_shape[idim] ) {
+        break;
+      }
+      index[idim] = 0;
+    }
+  }
+}
+
+
+/*! \brief Gather a range of runs of a strided array into a contiguous buffer
+ *
+ * \param [in]       desc
+ *                   Descriptor of the array.
+ * \param [in]       base
+ *                   Pointer to the first element of the array.
+ * \param [in]       first_run
+ *                   Index of the first run to gather.
+ * \param [in]       nruns
+ *                   Number of runs to gather.
+ * \param [out]      out
+ *                   Pointer to a buffer of at least \p nruns times \p desc->run_bytes bytes.
+ */
+void strided_pack(const strided_desc* desc, const void* base, size_t first_run, size_t nruns, void* out) {
+  strided_copy(desc, (char*)base, first_run, nruns, (char*)out, 0);
+}
+
+
+/*! \brief Scatter a contiguous buffer into a range of runs of a strided array
+ *
+ * \param [in]       desc
+ *                   Descriptor of the array.
+ * \param [in]       in
+ *                   Pointer to a buffer of \p nruns times \p desc->run_bytes bytes.
+ * \param [in]       first_run
+ *                   Index of the first run to scatter into.
+ * \param [in]       nruns
+ *                   Number of runs to scatter into.
+ * \param [out]      base
+ *                   Pointer to the first element of the array.
+ */
+void strided_unpack(const strided_desc* desc, const void* in, size_t first_run, size_t nruns, void* base) {
+  strided_copy(desc, (char*)base, first_run, nruns, (char*)in, 1);
+}
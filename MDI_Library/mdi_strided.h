@@ -0,0 +1,39 @@
+/*! \file
+ *
+ * \brief Strided and multi-dimensional array descriptors
+ */
+
+#ifndef MDI_STRIDED
+#define MDI_STRIDED
+
+#include <stddef.h>
+#include <stdint.h>
+#include "mdi.h"
+
+// Largest number of dimensions of a strided array
+#define STRIDED_MAX_DIMS 8
+
+typedef struct strided_desc_struct {
+  /*! \brief Number of elements in the array */
+  size_t count;
+  /*! \brief Size of a single element, in bytes */
+  size_t elemsize;
+  /*! \brief Number of contiguous bytes in each run of the array */
+  size_t run_bytes;
+  /*! \brief Number of runs in the array */
+  size_t nruns;
+  /*! \brief Number of dimensions over which the runs are distributed */
+  int nouter;
+  /*! \brief Extent of each dimension over which the runs are distributed, slowest first */
+  size_t outer_shape[STRIDED_MAX_DIMS];
+  /*! \brief Stride, in bytes, of each dimension over which the runs are distributed */
+  ptrdiff_t outer_strides[STRIDED_MAX_DIMS];
+} strided_desc;
+
+int strided_init(strided_desc* desc, int ndims, const int64_t* shape, const int64_t* strides,
+                 MDI_Datatype datatype);
+ptrdiff_t strided_run_offset(const strided_desc* desc, size_t irun);
+void strided_pack(const strided_desc* desc, const void* base, size_t first_run, size_t nruns, void* out);
+void strided_unpack(const strided_desc* desc, const void* in, size_t first_run, size_t nruns, void* base);
+
+#endif
@@ -10,15 +10,31 @@
   #include <sys/socket.h>
   #include <netdb.h>
   #include <unistd.h>
+  #include <sys/uio.h>
 #endif
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <limits.h>
 #include <signal.h>
 #include <errno.h>
 #include "mdi.h"
 #include "mdi_tcp.h"
+#include "mdi_datatype.h"
 #include "mdi_global.h"
+#include "mdi_general.h"
+
+// Size of the buffer through which short runs of a strided array are staged, in bytes
+#define TCP_STAGING_BYTES 65536
+
+// Shortest run of a strided array that is written directly from the array, in bytes
+#define TCP_IOVEC_MIN_RUN 256
+
+#ifndef _WIN32
+  #ifndef IOV_MAX
+    #define IOV_MAX 1024
+  #endif
+#endif
 
 static sock_t sigint_sockfd;
 
@@ -35,9 +51,6 @@ void sigint_handler(int dummy) {
 #endif
 }
 
-/*! \brief Socket over which a driver will listen for incoming connections */
-sock_t tcp_socket = -1;
-
 /*! \brief Begin listening for incoming TCP connections
  *
  * \param [in]       port
@@ -95,12 +108,86 @@ int tcp_listen(int port) {
   }
 
   //return sockfd;
-  tcp_socket = sockfd;
+  active_context->tcp_socket = sockfd;
 
   return 0;
 }
 
 
+/*! \brief Stop listening for incoming TCP connections, if the active context is listening
+ */
+int tcp_stop_listening() {
+  if ( active_context->tcp_socket > 0 ) {
+#ifdef _WIN32
+    closesocket(active_context->tcp_socket);
+#else
+    close(active_context->tcp_socket);
+#endif
+    active_context->tcp_socket = -1;
+  }
+  return 0;
+}
+
+
+/*! \brief Close the socket of a TCP communicator that is being deleted
+ *
+ * \param [in]       comm
+ *                   Pointer to the communicator.
+ */
+int communicator_delete_tcp(void* comm) {
+  communicator* this_comm = (communicator*) comm;
+#ifdef _WIN32
+  closesocket(this_comm->sockfd);
+#else
+  close(this_comm->sockfd);
+#endif
+  return 0;
+}
+
+
+/*! \brief Exchange version numbers with a driver to which a socket has just connected
+ *
+ * The function returns \p 0 on a success, and \p 1 if the driver closed the connection.
+ *
+ * \param [in]       sockfd
+ *                   Socket connected to the driver.
+ * \param [out]      driver_version
+ *                   Version of the MDI Library used by the driver.
+ */
+static int tcp_exchange_version(sock_t sockfd, int* driver_version) {
+  int version[3];
+  version[0] = MDI_MAJOR_VERSION;
+  version[1] = MDI_MINOR_VERSION;
+  version[2] = MDI_PATCH_VERSION;
+  size_t nbytes = 3 * sizeof(int);
+  size_t total = 0;
+  while ( total < nbytes ) {
+#ifdef _WIN32
+    int n = send(sockfd, (const char*)version + total, (int)(nbytes - total), 0);
+#else
+    ssize_t n = write(sockfd, (const char*)version + total, nbytes - total);
+#endif
+    if ( n <= 0 ) {
+      return 1;
+    }
+    total += n;
+  }
+  total = 0;
+  while ( total < nbytes ) {
+#ifdef _WIN32
+    int n = recv(sockfd, (char*)driver_version + total, (int)(nbytes - total), 0);
+#else
+    ssize_t n = read(sockfd, (char*)driver_version + total, nbytes - total);
+#endif
+    if ( n <= 0 ) {
+      return 1;
+    }
+    total += n;
+  }
+  return 0;
+}
+
+
 /*! \brief Request a connection over TCP
  *
  * \param [in]       port
@@ -118,7 +205,7 @@ int tcp_request_connection(int port, char* hostname_ptr) {
   ret = WSAStartup(MAKEWORD(2,2), &wsa_data);
 #endif
 
-  code* this_code = get_code(current_code);
+  code* this_code = get_code(active_context->current_code);
 
   struct sockaddr_in driver_address;
   struct hostent* host_ptr;
@@ -144,6 +231,7 @@ int tcp_request_connection(int port, char* hostname_ptr) {
   // connect to the driver
   // if the connection is refused, try again
   //   this allows the production code to start before the driver
+  int driver_version[3];
   int try_connect = 1;
   while (try_connect == 1) {
 
@@ -180,25 +268,43 @@ int tcp_request_connection(int port, char* hostname_ptr) {
     }
     else {
       try_connect = 0;
+
+      // communicate the version number between codes
+      // only do this if not in i-PI compatibility mode
+      // a driver that exits after the connection is made closes it without accepting it,
+      //   in which case the connection is made again, possibly to a later driver
+      if ( active_context->ipi_compatibility != 1 ) {
+        if ( tcp_exchange_version(sockfd, &driver_version[0]) != 0 ) {
+#ifdef _WIN32
+          closesocket(sockfd);
+#else
+          close(sockfd);
+#endif
+          try_connect = 1;
+        }
+      }
     }
   }
 
   MDI_Comm comm_id = new_communicator(this_code->id, MDI_TCP);
   communicator* new_comm = get_communicator(this_code->id, comm_id);
   new_comm->sockfd = sockfd;
+  new_comm->delete = communicator_delete_tcp;
   new_comm->send = tcp_send;
   new_comm->recv = tcp_recv;
-
-
-  // communicate the version number between codes
-  // only do this if not in i-PI compatibility mode
-  if ( ipi_compatibility != 1 ) {
-    int version[3];
-    version[0] = MDI_MAJOR_VERSION;
-    version[1] = MDI_MINOR_VERSION;
-    version[2] = MDI_PATCH_VERSION;
-    tcp_send(&version[0], 3, MDI_INT, new_comm->id, 0);
-    tcp_recv(&new_comm->mdi_version[0], 3, MDI_INT, new_comm->id, 0);
+  new_comm->send_strided = tcp_send_strided;
+  new_comm->recv_strided = tcp_recv_strided;
+  new_comm->send_vector = tcp_send_vector;
+  new_comm->recv_vector = tcp_recv_vector;
+  new_comm->partial_body = 1;
+
+  if ( active_context->ipi_compatibility != 1 ) {
+    new_comm->mdi_version[0] = driver_version[0];
+    new_comm->mdi_version[1] = driver_version[1];
+    new_comm->mdi_version[2] = driver_version[2];
+
+    // negotiate any optional features
+    general_negotiate_features(new_comm->id);
   }
 
   return 0;
@@ -209,9 +315,9 @@ int tcp_request_connection(int port, char* hostname_ptr) {
  */
 int tcp_accept_connection() {
   sock_t connection;
-  code* this_code = get_code(current_code);
+  code* this_code = get_code(active_context->current_code);
 
-  connection = accept(tcp_socket, NULL, NULL);
+  connection = accept(active_context->tcp_socket, NULL, NULL);
   if (connection < 0) {
     mdi_error("Could not accept connection");
     return 1;
@@ -220,18 +326,27 @@ int tcp_accept_connection() {
   MDI_Comm comm_id = new_communicator(this_code->id, MDI_TCP);
   communicator* new_comm = get_communicator(this_code->id, comm_id);
   new_comm->sockfd = connection;
+  new_comm->delete = communicator_delete_tcp;
   new_comm->send = tcp_send;
   new_comm->recv = tcp_recv;
+  new_comm->send_strided = tcp_send_strided;
+  new_comm->recv_strided = tcp_recv_strided;
+  new_comm->send_vector = tcp_send_vector;
+  new_comm->recv_vector = tcp_recv_vector;
+  new_comm->partial_body = 1;
 
   // communicate the version number between codes
   // only do this if not in i-PI compatibility mode
-  if ( ipi_compatibility != 1 ) {
+  if ( active_context->ipi_compatibility != 1 ) {
     int version[3];
     version[0] = MDI_MAJOR_VERSION;
     version[1] = MDI_MINOR_VERSION;
     version[2] = MDI_PATCH_VERSION;
     tcp_send(&version[0], 3, MDI_INT, new_comm->id, 0);
     tcp_recv(&new_comm->mdi_version[0], 3, MDI_INT, new_comm->id, 0);
+
+    // negotiate any optional features
+    general_negotiate_features(new_comm->id);
   }
 
   return 0;
@@ -255,14 +370,14 @@ int tcp_accept_connection() {
  *                   1: The header of a message.
  *                   2: The body (data) of a message.
  */
-int tcp_send(const void* buf, int count, MDI_Datatype datatype, MDI_Comm comm, int msg_flag) {
+int tcp_send(const void* buf, size_t count, MDI_Datatype datatype, MDI_Comm comm, int msg_flag) {
   // only send from rank 0
-  code* this_code = get_code(current_code);
+  code* this_code = get_code(active_context->current_code);
   if ( this_code->intra_rank != 0 ) {
     return 0;
   }
 
-  communicator* this = get_communicator(current_code, comm);
+  communicator* this = get_communicator(active_context->current_code, comm);
   size_t count_t = count;
 #ifdef _WIN32
   int n = 0;
@@ -274,32 +389,27 @@ int tcp_send(const void* buf, int count, MDI_Datatype datatype, MDI_Comm comm, i
   size_t datasize;
   n = 0;
   size_t total_sent = 0;
-  if (datatype == MDI_INT) {
-    datasize = sizeof(int);
-  }
-  else if (datatype == MDI_DOUBLE) {
-    datasize = sizeof(double);
-  }
-  else if (datatype == MDI_CHAR) {
-    datasize = sizeof(char);
-  }
-  else if (datatype == MDI_BYTE) {
-    datasize = sizeof(char);
-  }
-  else {
-    mdi_error("MDI data type not recognized in tcp_send"); 
+  datasize = datatype_size(datatype);
+  if ( datasize == 0 ) {
+    mdi_error("MDI data type not recognized in tcp_send");
     return 1;
   }
 
   while ( n >= 0 && total_sent < count_t*datasize ) {
 #ifdef _WIN32
-    n = send(this->sockfd, (char*)buf+total_sent, (int)(count_t*datasize-total_sent), 0);
+    // the length argument of send is an int, so large messages are sent in chunks
+    size_t chunk = count_t*datasize-total_sent;
+    if ( chunk > INT_MAX ) {
+      chunk = INT_MAX;
+    }
+    n = send(this->sockfd, (char*)buf+total_sent, (int)chunk, 0);
 #else
     n = write(this->sockfd, (char*)buf+total_sent, count_t*datasize-total_sent);
 #endif
     total_sent += n;
   }
   if (n < 0) { 
+    this->broken = 1;
     mdi_error("Error writing to socket: server has quit or connection broke");
     return 1;
   }
@@ -325,59 +435,334 @@ int tcp_send(const void* buf, int count, MDI_Datatype datatype, MDI_Comm comm, i
  *                   1: The header of a message.
  *                   2: The body (data) of a message.
  */
-int tcp_recv(void* buf, int count, MDI_Datatype datatype, MDI_Comm comm, int msg_flag) {
+int tcp_recv(void* buf, size_t count, MDI_Datatype datatype, MDI_Comm comm, int msg_flag) {
   // only recv from rank 0
-  code* this_code = get_code(current_code);
+  code* this_code = get_code(active_context->current_code);
   if ( this_code->intra_rank != 0 ) {
     return 0;
   }
 
 #ifdef _WIN32
-  int n, nr;
+  int nr;
 #else
-  ssize_t n, nr;
+  ssize_t nr;
 #endif
-  communicator* this = get_communicator(current_code, comm);
+  communicator* this = get_communicator(active_context->current_code, comm);
   size_t count_t = count;
 
   // determine the byte size of the data type being sent
   size_t datasize;
-  if (datatype == MDI_INT) {
-    datasize = sizeof(int);
-  }
-  else if (datatype == MDI_DOUBLE) {
-    datasize = sizeof(double);
-  }
-  else if (datatype == MDI_CHAR) {
-    datasize = sizeof(char);
-  }
-  else if (datatype == MDI_BYTE) {
-    datasize = sizeof(char);
-  }
-  else {
+  datasize = datatype_size(datatype);
+  if ( datasize == 0 ) {
     mdi_error("MDI data type not recognized in tcp_recv");
     return 1;
   }
 
+  size_t total_received = 0;
+  nr = 1;
+  while ( nr > 0 && total_received < count_t*datasize ) {
 #ifdef _WIN32
-  n = nr = recv(this->sockfd,(char*)buf,(int)(count_t*datasize),0);
+    // the length argument of recv is an int, so large messages are received in chunks
+    size_t chunk = count_t*datasize-total_received;
+    if ( chunk > INT_MAX ) {
+      chunk = INT_MAX;
+    }
+    nr = recv(this->sockfd,(char*)buf+total_received,(int)chunk,0);
 #else
-  n = nr = read(this->sockfd,(char*)buf,count_t*datasize);
+    nr = read(this->sockfd,(char*)buf+total_received,count_t*datasize-total_received);
 #endif
+    if ( nr > 0 ) {
+      total_received += nr;
+    }
+  }
 
-  while (nr>0 && n<count_t*datasize ) {
-#ifdef _WIN32
-    nr=recv(this->sockfd,(char*)buf+n,(int)(count_t*datasize-n),0);
+  if ( total_received < count_t*datasize ) {
+    this->broken = 1;
+    mdi_error("Error reading from socket: server has quit or connection broke");
+    return 1;
+  }
+
+  return 0;
+}
+
+
+
+#ifndef _WIN32
+/*! \brief Write or read a batch of buffers, using scatter/gather I/O
+ *
+ * The function returns \p 0 on a success.
+ *
+ * \param [in]       sockfd
+ *                   Socket descriptor of the connection.
+ * \param [in]       iov
+ *                   Buffers to transfer, which are modified as the transfer proceeds.
+ * \param [in]       niov
+ *                   Number of buffers to transfer, at most \p IOV_MAX.
+ * \param [in]       do_read
+ *                   If nonzero, read into the buffers; otherwise, write from them.
+ */
+static int tcp_transfer_iovec(sock_t sockfd, struct iovec* iov, int niov, int do_read) {
+  // transfer the batch, resuming after any partial transfer
+  struct iovec* next = iov;
+  while ( niov > 0 ) {
+    ssize_t n = do_read ? readv(sockfd, next, niov) : writev(sockfd, next, niov);
+    if ( n <= 0 ) {
+      return 1;
+    }
+    while ( niov > 0 && (size_t)n >= next->iov_len ) {
+      n -= next->iov_len;
+      next++;
+      niov--;
+    }
+    if ( niov > 0 ) {
+      next->iov_base = (char*)next->iov_base + n;
+      next->iov_len -= n;
+    }
+  }
+  return 0;
+}
+
+
+/*! \brief Write or read the runs of a strided array directly, using scatter/gather I/O
+ *
+ * \param [in]       sockfd
+ *                   Socket descriptor of the connection.
+ * \param [in]       base
+ *                   Pointer to the first element of the array.
+ * \param [in]       desc
+ *                   Descriptor of the layout of the array.
+ * \param [in]       do_read
+ *                   If nonzero, read into the array; otherwise, write from it.
+ */
+static int tcp_iovec_strided(sock_t sockfd, char* base, const strided_desc* desc, int do_read) {
+  struct iovec iov[IOV_MAX];
+  size_t irun = 0;
+  while ( irun < desc->nruns ) {
+    // describe the next batch of runs
+    int niov = 0;
+    while ( niov < IOV_MAX && irun < desc->nruns ) {
+      iov[niov].iov_base = base + strided_run_offset(desc, irun);
+      iov[niov].iov_len = desc->run_bytes;
+      niov++;
+      irun++;
+    }
+    if ( tcp_transfer_iovec(sockfd, iov, niov, do_read) != 0 ) {
+      return 1;
+    }
+  }
+  return 0;
+}
+#endif
+
+
+/*! \brief Send the body of a message from a strided array through an MDI connection, using TCP
+ *
+ * Long runs are written directly from the array.
+ * Short runs are gathered through a small staging buffer.
+ *
+ * \param [in]       buf
+ *                   Pointer to the first element of the array.
+ * \param [in]       desc
+ *                   Descriptor of the layout of the array.
+ * \param [in]       datatype
+ *                   MDI handle (MDI_INT, MDI_DOUBLE, MDI_CHAR, etc.) corresponding to the type of data to be sent.
+ * \param [in]       comm
+ *                   MDI communicator associated with the intended recipient code.
+ */
+int tcp_send_strided(const void* buf, const strided_desc* desc, MDI_Datatype datatype, MDI_Comm comm) {
+  // only send from rank 0
+  code* this_code = get_code(active_context->current_code);
+  if ( this_code->intra_rank != 0 ) {
+    return 0;
+  }
+
+#ifndef _WIN32
+  if ( desc->run_bytes >= TCP_IOVEC_MIN_RUN ) {
+    communicator* this = get_communicator(active_context->current_code, comm);
+    if ( tcp_iovec_strided(this->sockfd, (char*)buf, desc, 0) != 0 ) {
+      this->broken = 1;
+      mdi_error("Error writing to socket: server has quit or connection broke");
+      return 1;
+    }
+    return 0;
+  }
+#endif
+
+  // gather whole runs into the staging buffer
+  char staging[TCP_STAGING_BYTES];
+  size_t runs_per_chunk = TCP_STAGING_BYTES / desc->run_bytes;
+  if ( runs_per_chunk == 0 ) {
+    runs_per_chunk = 1;
+  }
+  size_t irun;
+  for ( irun = 0; irun < desc->nruns; irun += runs_per_chunk ) {
+    size_t nruns = desc->nruns - irun;
+    if ( nruns > runs_per_chunk ) {
+      nruns = runs_per_chunk;
+    }
+
+    // runs longer than the staging buffer are sent directly
+    if ( desc->run_bytes > TCP_STAGING_BYTES ) {
+      const char* run = (const char*)buf + strided_run_offset(desc, irun);
+      if ( tcp_send(run, desc->run_bytes, MDI_BYTE, comm, 2) != 0 ) { return 1; }
+      continue;
+    }
+    strided_pack(desc, buf, irun, nruns, staging);
+    if ( tcp_send(staging, nruns * desc->run_bytes, MDI_BYTE, comm, 2) != 0 ) { return 1; }
+  }
+
+  return 0;
+}
+
+
+/*! \brief Receive the body of a message into a strided array through an MDI connection, using TCP
+ *
+ * Long runs are read directly into the array.
+ * Short runs are scattered through a small staging buffer.
+ *
+ * \param [out]      buf
+ *                   Pointer to the first element of the array.
+ * \param [in]       desc
+ *                   Descriptor of the layout of the array.
+ * \param [in]       datatype
+ *                   MDI handle (MDI_INT, MDI_DOUBLE, MDI_CHAR, etc.) corresponding to the type of data to be received.
+ * \param [in]       comm
+ *                   MDI communicator associated with the connection to the sending code.
+ */
+int tcp_recv_strided(void* buf, const strided_desc* desc, MDI_Datatype datatype, MDI_Comm comm) {
+  // only recv from rank 0
+  code* this_code = get_code(active_context->current_code);
+  if ( this_code->intra_rank != 0 ) {
+    return 0;
+  }
+
+#ifndef _WIN32
+  if ( desc->run_bytes >= TCP_IOVEC_MIN_RUN ) {
+    communicator* this = get_communicator(active_context->current_code, comm);
+    if ( tcp_iovec_strided(this->sockfd, (char*)buf, desc, 1) != 0 ) {
+      this->broken = 1;
+      mdi_error("Error reading from socket: server has quit or connection broke");
+      return 1;
+    }
+    return 0;
+  }
+#endif
+
+  // scatter whole runs from the staging buffer
+  char staging[TCP_STAGING_BYTES];
+  size_t runs_per_chunk = TCP_STAGING_BYTES / desc->run_bytes;
+  if ( runs_per_chunk == 0 ) {
+    runs_per_chunk = 1;
+  }
+  size_t irun;
+  for ( irun = 0; irun < desc->nruns; irun += runs_per_chunk ) {
+    size_t nruns = desc->nruns - irun;
+    if ( nruns > runs_per_chunk ) {
+      nruns = runs_per_chunk;
+    }
+
+    // runs longer than the staging buffer are received directly
+    if ( desc->run_bytes > TCP_STAGING_BYTES ) {
+      char* run = (char*)buf + strided_run_offset(desc, irun);
+      if ( tcp_recv(run, desc->run_bytes, MDI_BYTE, comm, 2) != 0 ) { return 1; }
+      continue;
+    }
+    if ( tcp_recv(staging, nruns * desc->run_bytes, MDI_BYTE, comm, 2) != 0 ) { return 1; }
+    strided_unpack(desc, staging, irun, nruns, buf);
+  }
+
+  return 0;
+}
+
+
+
+/*! \brief Send the body of a vectored message through an MDI connection, using TCP
+ *
+ * All of the segments are written by a single scatter/gather call where possible.
+ *
+ * \param [in]       nseg
+ *                   Number of segments in the message.
+ * \param [in]       bufs
+ *                   Pointer to the data of each segment.
+ * \param [in]       nbytes
+ *                   Size of each segment, in bytes.
+ * \param [in]       comm
+ *                   MDI communicator associated with the intended recipient code.
+ */
+int tcp_send_vector(int nseg, const void* const* bufs, const size_t* nbytes, MDI_Comm comm) {
+  // only send from rank 0
+  code* this_code = get_code(active_context->current_code);
+  if ( this_code->intra_rank != 0 ) {
+    return 0;
+  }
+
+  int iseg;
+#ifndef _WIN32
+  communicator* this = get_communicator(active_context->current_code, comm);
+  struct iovec iov[MDI_VECTOR_MAX_SEGMENTS];
+  int niov = 0;
+  for ( iseg = 0; iseg < nseg; iseg++ ) {
+    if ( nbytes[iseg] > 0 ) {
+      iov[niov].iov_base = (void*)bufs[iseg];
+      iov[niov].iov_len = nbytes[iseg];
+      niov++;
+    }
+  }
+  if ( tcp_transfer_iovec(this->sockfd, iov, niov, 0) != 0 ) {
+    this->broken = 1;
+    mdi_error("Error writing to socket: server has quit or connection broke");
+    return 1;
+  }
 #else
-    nr=read(this->sockfd,(char*)buf+n,count_t*datasize-n);
+  for ( iseg = 0; iseg < nseg; iseg++ ) {
+    if ( tcp_send(bufs[iseg], nbytes[iseg], MDI_BYTE, comm, 2) != 0 ) { return 1; }
+  }
 #endif
-    n+=nr;
+
+  return 0;
+}
+
+
+/*! \brief Receive the body of a vectored message through an MDI connection, using TCP
+ *
+ * \param [in]       nseg
+ *                   Number of segments in the message.
+ * \param [out]      bufs
+ *                   Pointer to the buffer where each segment will be stored.
+ * \param [in]       nbytes
+ *                   Size of each segment, in bytes.
+ * \param [in]       comm
+ *                   MDI communicator associated with the connection to the sending code.
+ */
+int tcp_recv_vector(int nseg, void* const* bufs, const size_t* nbytes, MDI_Comm comm) {
+  // only recv from rank 0
+  code* this_code = get_code(active_context->current_code);
+  if ( this_code->intra_rank != 0 ) {
+    return 0;
   }
 
-  if (n == 0) { 
+  int iseg;
+#ifndef _WIN32
+  communicator* this = get_communicator(active_context->current_code, comm);
+  struct iovec iov[MDI_VECTOR_MAX_SEGMENTS];
+  int niov = 0;
+  for ( iseg = 0; iseg < nseg; iseg++ ) {
+    if ( nbytes[iseg] > 0 ) {
+      iov[niov].iov_base = bufs[iseg];
+      iov[niov].iov_len = nbytes[iseg];
+      niov++;
+    }
+  }
+  if ( tcp_transfer_iovec(this->sockfd, iov, niov, 1) != 0 ) {
+    this->broken = 1;
     mdi_error("Error reading from socket: server has quit or connection broke");
     return 1;
   }
+#else
+  for ( iseg = 0; iseg < nseg; iseg++ ) {
+    if ( tcp_recv(bufs[iseg], nbytes[iseg], MDI_BYTE, comm, 2) != 0 ) { return 1; }
+  }
+#endif
 
   return 0;
 }
@@ -8,15 +8,20 @@
 
 #include "mdi.h"
 #include "mdi_global.h"
-
-extern sock_t tcp_socket;
+#include "mdi_strided.h"
 
 void sigint_handler(int dummy);
 
 int tcp_listen(int port);
+int tcp_stop_listening();
+int communicator_delete_tcp(void* comm);
 int tcp_request_connection(int port, char* hostname_ptr);
 int tcp_accept_connection();
-int tcp_send(const void* buf, int count, MDI_Datatype datatype, MDI_Comm comm, int msg_flag);
-int tcp_recv(void* buf, int count, MDI_Datatype datatype, MDI_Comm comm, int msg_flag);
+int tcp_send(const void* buf, size_t count, MDI_Datatype datatype, MDI_Comm comm, int msg_flag);
+int tcp_recv(void* buf, size_t count, MDI_Datatype datatype, MDI_Comm comm, int msg_flag);
+int tcp_send_strided(const void* buf, const strided_desc* desc, MDI_Datatype datatype, MDI_Comm comm);
+int tcp_recv_strided(void* buf, const strided_desc* desc, MDI_Datatype datatype, MDI_Comm comm);
+int tcp_send_vector(int nseg, const void* const* bufs, const size_t* nbytes, MDI_Comm comm);
+int tcp_recv_vector(int nseg, void* const* bufs, const size_t* nbytes, MDI_Comm comm);
 
 #endif
@@ -10,12 +10,13 @@
 #include "mdi.h"
 #include "mdi_test.h"
 #include "mdi_global.h"
+#include "mdi_datatype.h"
 
 /*! \brief Perform initialization of a dummy communicator for testing purposes
  *
  */
 int test_initialize() {
-  code* this_code = get_code(current_code);
+  code* this_code = get_code(active_context->current_code);
 
   MDI_Comm comm_id = new_communicator(this_code->id, MDI_TEST);
   communicator* new_comm = get_communicator(this_code->id, comm_id);
@@ -41,10 +42,9 @@ int test_initialize() {
  *                   1: The header of a message.
  *                   2: The body (data) of a message.
  */
-int test_send(const void* buf, int count, MDI_Datatype datatype, MDI_Comm comm, int msg_flag) {
+int test_send(const void* buf, size_t count, MDI_Datatype datatype, MDI_Comm comm, int msg_flag) {
 
-  if ( datatype != MDI_INT && datatype != MDI_DOUBLE && datatype != MDI_CHAR 
-       && datatype != MDI_BYTE) {
+  if ( datatype_size(datatype) == 0 ) {
     mdi_error("MDI data type not recognized in test_send");
     return 1;
   }
@@ -69,10 +69,9 @@ int test_send(const void* buf, int count, MDI_Datatype datatype, MDI_Comm comm,
  *                   1: The header of a message.
  *                   2: The body (data) of a message.
  */
-int test_recv(void* buf, int count, MDI_Datatype datatype, MDI_Comm comm, int msg_flag) {
+int test_recv(void* buf, size_t count, MDI_Datatype datatype, MDI_Comm comm, int msg_flag) {
 
-  if ( datatype != MDI_INT && datatype != MDI_DOUBLE && datatype != MDI_CHAR 
-       && datatype != MDI_BYTE) {
+  if ( datatype_size(datatype) == 0 ) {
     mdi_error("MDI data type not recognized in test_send");
     return 1;
   }
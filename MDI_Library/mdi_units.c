@@ -0,0 +1,171 @@
+/*! \file
+ *
+ * \brief Unit tags for unit-aware transfers
+ *
+ * A message sent with MDI_Send_units() is tagged with the identifier of its unit, so that the
+ * receiving code can convert it while receiving it.
+ * The identifier of a unit is its position in the table in this file, plus one, and is part of
+ * the wire protocol: new units must only be appended to the table.
+ * An identifier of \p 0 denotes an untagged message, which is in atomic units.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "mdi.h"
+#include "mdi_global.h"
+#include "mdi_units.h"
+
+typedef struct unit_info_struct {
+  /*! \brief Name of the unit, as accepted by MDI_Conversion_factor() */
+  const char* name;
+  /*! \brief Name of the atomic unit of the same quantity */
+  const char* atomic_name;
+} unit_info;
+
+/*! \brief Units that may be used to tag a message, in the order of their identifiers */
+static const unit_info unit_table[] = {
+  { "atomic_unit_of_mass",    "atomic_unit_of_mass" },    // 1
+  { "kilogram",               "atomic_unit_of_mass" },    // 2
+  { "gram",                   "atomic_unit_of_mass" },    // 3
+  { "atomic_mass_unit",       "atomic_unit_of_mass" },    // 4
+  { "atomic_unit_of_charge",  "atomic_unit_of_charge" },  // 5
+  { "coulomb",                "atomic_unit_of_charge" },  // 6
+  { "atomic_unit_of_energy",  "atomic_unit_of_energy" },  // 7
+  { "hartree",                "atomic_unit_of_energy" },  // 8
+  { "joule",                  "atomic_unit_of_energy" },  // 9
+  { "kilojoule",              "atomic_unit_of_energy" },  // 10
+  { "kilojoule_per_mol",      "atomic_unit_of_energy" },  // 11
+  { "calorie",                "atomic_unit_of_energy" },  // 12
+  { "kilocalorie",            "atomic_unit_of_energy" },  // 13
+  { "kilocalorie_per_mol",    "atomic_unit_of_energy" },  // 14
+  { "electron_volt",          "atomic_unit_of_energy" },  // 15
+  { "rydberg",                "atomic_unit_of_energy" },  // 16
+  { "kelvin_energy",          "atomic_unit_of_energy" },  // 17
+  { "inverse_meter_energy",   "atomic_unit_of_energy" },  // 18
+  { "atomic_unit_of_force",   "atomic_unit_of_force" },   // 19
+  { "newton",                 "atomic_unit_of_force" },   // 20
+  { "atomic_unit_of_length",  "atomic_unit_of_length" },  // 21
+  { "bohr",                   "atomic_unit_of_length" },  // 22
+  { "meter",                  "atomic_unit_of_length" },  // 23
+  { "nanometer",              "atomic_unit_of_length" },  // 24
+  { "picometer",              "atomic_unit_of_length" },  // 25
+  { "angstrom",               "atomic_unit_of_length" },  // 26
+  { "atomic_unit_of_time",    "atomic_unit_of_time" },    // 27
+  { "second",                 "atomic_unit_of_time" },    // 28
+  { "picosecond",             "atomic_unit_of_time" },    // 29
+};
+
+/*! \brief Number of units in the table */
+static const int nunits = (int)( sizeof(unit_table) / sizeof(unit_table[0]) );
+
+
+/*! \brief Return the identifier of a unit, or \p 0 if the unit is not recognized
+ *
+ * \param [in]       name
+ *                   Name of the unit.
+ */
+int units_get_id(const char* name) {
+  int iunit;
+  for ( iunit = 0; iunit < nunits; iunit++ ) {
+    if ( strcmp( unit_table[iunit].name, name ) == 0 ) {
+      return iunit + 1;
+    }
+  }
+  return 0;
+}
+
+
+/*! \brief Return the name of a unit, or \p NULL if the identifier is not recognized
+ *
+ * \param [in]       id
+ *                   Identifier of the unit.
+ */
+const char* units_get_name(int id) {
+  if ( id < 1 || id > nunits ) {
+    return NULL;
+  }
+  return unit_table[id - 1].name;
+}
+
+
+/*! \brief Determine the factor that converts data in a tagged unit to another unit
+ *
+ * The function returns \p 0 on a success.
+ *
+ * \param [in]       from_id
+ *                   Identifier of the unit of the data, or \p 0 if the data is in atomic units.
+ * \param [in]       to_unit
+ *                   Name of the unit to convert to, or \p NULL to convert to atomic units.
+ * \param [out]      factor
+ *                   Factor by which the data must be multiplied.
+ */
+int units_factor(int from_id, const char* to_unit, double* factor) {
+  *factor = 1.0;
+  if ( from_id != 0 && ( from_id < 1 || from_id > nunits ) ) {
+    mdi_error("Error in MDI: unit tag not recognized");
+    return 1;
+  }
+
+  // untagged data is in atomic units
+  const char* from_name = NULL;
+  if ( from_id != 0 ) {
+    from_name = unit_table[from_id - 1].name;
+  }
+  if ( to_unit == NULL ) {
+    if ( from_name == NULL ) {
+      return 0;
+    }
+    to_unit = unit_table[from_id - 1].atomic_name;
+  }
+  if ( from_name == NULL ) {
+    int to_id = units_get_id(to_unit);
+    if ( to_id == 0 ) {
+      mdi_error("Unit name not recognized");
+      return 1;
+    }
+    from_name = unit_table[to_id - 1].atomic_name;
+  }
+
+  if ( strcmp( from_name, to_unit ) == 0 ) {
+    return 0;
+  }
+  return MDI_Conversion_factor(from_name, to_unit, factor);
+}
+
+
+/*! \brief Multiply each value of a floating-point array by a factor
+ *
+ * The function returns \p 0 on a success.
+ *
+ * \param [in,out]   buf
+ *                   Pointer to the array.
+ * \param [in]       count
+ *                   Number of values in the array.
+ * \param [in]       datatype
+ *                   MDI handle (MDI_DOUBLE, MDI_FLOAT, or MDI_COMPLEX_DOUBLE) of the values in the array.
+ * \param [in]       factor
+ *                   Factor by which each value is multiplied.
+ */
+int units_scale(void* buf, size_t count, MDI_Datatype datatype, double factor) {
+  size_t i;
+  if ( datatype == MDI_DOUBLE || datatype == MDI_COMPLEX_DOUBLE ) {
+    double* values = (double*) buf;
+    size_t n = ( datatype == MDI_COMPLEX_DOUBLE ) ? 2 * count : count;
+    for ( i = 0; i < n; i++ ) {
+      values[i] *= factor;
+    }
+  }
+  else if ( datatype == MDI_FLOAT ) {
+    float* values = (float*) buf;
+    float f = (float) factor;
+    for ( i = 0; i < count; i++ ) {
+      values[i] *= f;
+    }
+  }
+  else {
+    mdi_error("Error in MDI: units may only be attached to floating-point data");
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,21 @@
+/*! \file
+ *
+ * \brief Unit tags for unit-aware transfers
+ */
+
+#ifndef MDI_UNITS
+#define MDI_UNITS
+
+#include <stddef.h>
+#include "mdi.h"
+
+// Size, in bytes, of the pieces in which a message body is received and converted, so that
+// each piece is converted while it is still in cache
+#define MDI_UNITS_CHUNK_BYTES 65536
+
+int units_get_id(const char* name);
+const char* units_get_name(int id);
+int units_factor(int from_id, const char* to_unit, double* factor);
+int units_scale(void* buf, size_t count, MDI_Datatype datatype, double factor);
+
+#endif
@@ -0,0 +1,223 @@
+# CMAKE generated file: DO NOT EDIT!
+# Generated by "Unix Makefiles" Generator, CMake Version 3.25
+
+# The generator used is:
+set(CMAKE_DEPENDS_GENERATOR "Unix Makefiles")
+
+# The top level Makefile was generated from the following files:
+set(CMAKE_MAKEFILE_DEPENDS
+  "CMakeCache.txt"
+  "/root/repo/CMakeLists.txt"
+  "/root/repo/MDI_Library/CMakeLists.txt"
+  "/root/repo/MDI_Library/__init__.py"
+  "/root/repo/MDI_Library/mdi.h"
+  "/root/repo/MDI_Library/mdi.py"
+  "CMakeFiles/3.25.1/CMakeCCompiler.cmake"
+  "CMakeFiles/3.25.1/CMakeCXXCompiler.cmake"
+  "CMakeFiles/3.25.1/CMakeFortranCompiler.cmake"
+  "CMakeFiles/3.25.1/CMakeSystem.cmake"
+  "/root/repo/cmake/mdiConfig.cmake.in"
+  "/root/repo/tests/CMakeLists.txt"
+  "/root/repo/tests/MDI_Test_Codes/CMakeLists.txt"
+  "/root/repo/tests/MDI_Test_Codes/STUBS_MPI/CMakeLists.txt"
+  "/root/repo/tests/MDI_Test_Codes/alloc_count_cxx/CMakeLists.txt"
+  "/root/repo/tests/MDI_Test_Codes/async_plugin_cxx/CMakeLists.txt"
+  "/root/repo/tests/MDI_Test_Codes/bench_comms_cxx/CMakeLists.txt"
+  "/root/repo/tests/MDI_Test_Codes/bench_filter_cxx/CMakeLists.txt"
+  "/root/repo/tests/MDI_Test_Codes/bench_plugin_cxx/CMakeLists.txt"
+  "/root/repo/tests/MDI_Test_Codes/driver_api_f90/CMakeLists.txt"
+  "/root/repo/tests/MDI_Test_Codes/driver_api_py/CMakeLists.txt"
+  "/root/repo/tests/MDI_Test_Codes/driver_api_py/driver_api_py.py"
+  "/root/repo/tests/MDI_Test_Codes/driver_cxx/CMakeLists.txt"
+  "/root/repo/tests/MDI_Test_Codes/driver_f90/CMakeLists.txt"
+  "/root/repo/tests/MDI_Test_Codes/driver_ipicomp_py/CMakeLists.txt"
+  "/root/repo/tests/MDI_Test_Codes/driver_ipicomp_py/driver_ipicomp_py.py"
+  "/root/repo/tests/MDI_Test_Codes/driver_loop_cxx/CMakeLists.txt"
+  "/root/repo/tests/MDI_Test_Codes/driver_plug_cxx/CMakeLists.txt"
+  "/root/repo/tests/MDI_Test_Codes/driver_py/CMakeLists.txt"
+  "/root/repo/tests/MDI_Test_Codes/driver_py/driver_py.py"
+  "/root/repo/tests/MDI_Test_Codes/driver_serial_cxx/CMakeLists.txt"
+  "/root/repo/tests/MDI_Test_Codes/engine_cxx/CMakeLists.txt"
+  "/root/repo/tests/MDI_Test_Codes/engine_f90/CMakeLists.txt"
+  "/root/repo/tests/MDI_Test_Codes/engine_ipi_cxx/CMakeLists.txt"
+  "/root/repo/tests/MDI_Test_Codes/engine_py/CMakeLists.txt"
+  "/root/repo/tests/MDI_Test_Codes/engine_py/engine_py.py"
+  "/root/repo/tests/MDI_Test_Codes/lib_cxx_cxx/CMakeLists.txt"
+  "/root/repo/tests/MDI_Test_Codes/lib_cxx_cxx/engine_lib_cxx_cxx.h"
+  "/root/repo/tests/MDI_Test_Codes/lib_cxx_py/CMakeLists.txt"
+  "/root/repo/tests/MDI_Test_Codes/lib_cxx_py/engine_lib_cxx_py.py"
+  "/root/repo/tests/MDI_Test_Codes/lib_f90/CMakeLists.txt"
+  "/root/repo/tests/MDI_Test_Codes/lib_py/CMakeLists.txt"
+  "/root/repo/tests/MDI_Test_Codes/lib_py/lib_py.py"
+  "/root/repo/tests/MDI_Test_Codes/method_fifo_cxx/CMakeLists.txt"
+  "/root/repo/tests/MDI_Test_Codes/misc_py/CMakeLists.txt"
+  "/root/repo/tests/MDI_Test_Codes/misc_py/ut_init_double.py"
+  "/root/repo/tests/MDI_Test_Codes/misc_py/ut_init_fake_method.py"
+  "/root/repo/tests/MDI_Test_Codes/misc_py/ut_init_fake_opt.py"
+  "/root/repo/tests/MDI_Test_Codes/misc_py/ut_init_fake_role.py"
+  "/root/repo/tests/MDI_Test_Codes/misc_py/ut_init_no_hostname.py"
+  "/root/repo/tests/MDI_Test_Codes/misc_py/ut_init_no_method.py"
+  "/root/repo/tests/MDI_Test_Codes/misc_py/ut_init_no_name.py"
+  "/root/repo/tests/MDI_Test_Codes/misc_py/ut_init_no_port_d.py"
+  "/root/repo/tests/MDI_Test_Codes/misc_py/ut_init_no_port_e.py"
+  "/root/repo/tests/MDI_Test_Codes/misc_py/ut_init_no_role.py"
+  "/root/repo/tests/MDI_Test_Codes/misc_py/ut_init_noarg_driver_name.py"
+  "/root/repo/tests/MDI_Test_Codes/misc_py/ut_init_noarg_hostname.py"
+  "/root/repo/tests/MDI_Test_Codes/misc_py/ut_init_noarg_language.py"
+  "/root/repo/tests/MDI_Test_Codes/misc_py/ut_init_noarg_method.py"
+  "/root/repo/tests/MDI_Test_Codes/misc_py/ut_init_noarg_name.py"
+  "/root/repo/tests/MDI_Test_Codes/misc_py/ut_init_noarg_out.py"
+  "/root/repo/tests/MDI_Test_Codes/misc_py/ut_init_noarg_port.py"
+  "/root/repo/tests/MDI_Test_Codes/misc_py/ut_init_noarg_role.py"
+  "/root/repo/tests/MDI_Test_Codes/misc_py/ut_tmethod.py"
+  "/root/repo/tests/MDI_Test_Codes/regcache_cxx/CMakeLists.txt"
+  "/root/repo/tests/MDI_Test_Codes/serve_cxx/CMakeLists.txt"
+  "/root/repo/tests/MDI_Test_Codes/serve_py/CMakeLists.txt"
+  "/root/repo/tests/MDI_Test_Codes/serve_py/serve_py.py"
+  "/root/repo/tests/MDI_Test_Codes/threads_cxx/CMakeLists.txt"
+  "/usr/share/cmake-3.25/Modules/BasicConfigVersion-AnyNewerVersion.cmake.in"
+  "/usr/share/cmake-3.25/Modules/CMakeCInformation.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeCXXInformation.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeCommonLanguageInclude.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeFindFrameworks.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeFortranInformation.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeGenericSystem.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeInitializeConfigs.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeLanguageInformation.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakePackageConfigHelpers.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeSystemSpecificInformation.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeSystemSpecificInitialize.cmake"
+  "/usr/share/cmake-3.25/Modules/CheckCSourceCompiles.cmake"
+  "/usr/share/cmake-3.25/Modules/CheckIncludeFile.cmake"
+  "/usr/share/cmake-3.25/Modules/CheckLibraryExists.cmake"
+  "/usr/share/cmake-3.25/Modules/Compiler/CMakeCommonCompilerMacros.cmake"
+  "/usr/share/cmake-3.25/Modules/Compiler/GNU-C.cmake"
+  "/usr/share/cmake-3.25/Modules/Compiler/GNU-CXX.cmake"
+  "/usr/share/cmake-3.25/Modules/Compiler/GNU-Fortran.cmake"
+  "/usr/share/cmake-3.25/Modules/Compiler/GNU.cmake"
+  "/usr/share/cmake-3.25/Modules/FindMPI.cmake"
+  "/usr/share/cmake-3.25/Modules/FindPackageHandleStandardArgs.cmake"
+  "/usr/share/cmake-3.25/Modules/FindPackageMessage.cmake"
+  "/usr/share/cmake-3.25/Modules/FindPkgConfig.cmake"
+  "/usr/share/cmake-3.25/Modules/FindPythonLibs.cmake"
+  "/usr/share/cmake-3.25/Modules/FindThreads.cmake"
+  "/usr/share/cmake-3.25/Modules/GNUInstallDirs.cmake"
+  "/usr/share/cmake-3.25/Modules/Internal/CheckSourceCompiles.cmake"
+  "/usr/share/cmake-3.25/Modules/Platform/Linux-GNU-C.cmake"
+  "/usr/share/cmake-3.25/Modules/Platform/Linux-GNU-CXX.cmake"
+  "/usr/share/cmake-3.25/Modules/Platform/Linux-GNU-Fortran.cmake"
+  "/usr/share/cmake-3.25/Modules/Platform/Linux-GNU.cmake"
+  "/usr/share/cmake-3.25/Modules/Platform/Linux.cmake"
+  "/usr/share/cmake-3.25/Modules/Platform/UnixPaths.cmake"
+  "/usr/share/cmake-3.25/Modules/SelectLibraryConfigurations.cmake"
+  "/usr/share/cmake-3.25/Modules/WriteBasicConfigVersionFile.cmake"
+  )
+
+# The corresponding makefile is:
+set(CMAKE_MAKEFILE_OUTPUTS
+  "Makefile"
+  "CMakeFiles/cmake.check_cache"
+  )
+
+# Byproducts of CMake generate step:
+set(CMAKE_MAKEFILE_PRODUCTS
+  "CMakeFiles/CMakeDirectoryInformation.cmake"
+  "MDI_Library/mdi.py"
+  "MDI_Library/__init__.py"
+  "MDI_Library/mdi.h"
+  "MDI_Library/mdiConfig.cmake"
+  "MDI_Library/mdiConfigVersion.cmake"
+  "MDI_Library/mdi_name"
+  "MDI_Library/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "tests/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "tests/MDI_Test_Codes/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "tests/MDI_Test_Codes/driver_cxx/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "tests/MDI_Test_Codes/driver_serial_cxx/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "tests/MDI_Test_Codes/driver_loop_cxx/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "tests/MDI_Test_Codes/engine_cxx/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "tests/MDI_Test_Codes/driver_plug_cxx/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "engine_lib_cxx_cxx.h"
+  "tests/MDI_Test_Codes/lib_cxx_cxx/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "tests/MDI_Test_Codes/threads_cxx/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "tests/MDI_Test_Codes/bench_filter_cxx/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "tests/MDI_Test_Codes/serve_cxx/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "tests/MDI_Test_Codes/regcache_cxx/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "tests/MDI_Test_Codes/bench_plugin_cxx/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "tests/MDI_Test_Codes/async_plugin_cxx/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "engine_lib_cxx_py.py"
+  "tests/MDI_Test_Codes/lib_cxx_py/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "tests/MDI_Test_Codes/engine_ipi_cxx/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "tests/MDI_Test_Codes/bench_comms_cxx/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "tests/MDI_Test_Codes/method_fifo_cxx/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "tests/MDI_Test_Codes/alloc_count_cxx/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "tests/MDI_Test_Codes/STUBS_MPI/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "tests/MDI_Test_Codes/driver_f90/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "tests/MDI_Test_Codes/driver_api_f90/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "tests/MDI_Test_Codes/engine_f90/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "tests/MDI_Test_Codes/lib_f90/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "driver_py.py"
+  "tests/MDI_Test_Codes/driver_py/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "driver_api_py.py"
+  "tests/MDI_Test_Codes/driver_api_py/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "driver_ipicomp_py.py"
+  "tests/MDI_Test_Codes/driver_ipicomp_py/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "engine_py.py"
+  "tests/MDI_Test_Codes/engine_py/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "lib_py.py"
+  "tests/MDI_Test_Codes/lib_py/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "ut_tmethod.py"
+  "ut_init_no_method.py"
+  "ut_init_no_name.py"
+  "ut_init_no_role.py"
+  "ut_init_no_port_d.py"
+  "ut_init_no_port_e.py"
+  "ut_init_no_hostname.py"
+  "ut_init_fake_opt.py"
+  "ut_init_fake_role.py"
+  "ut_init_fake_method.py"
+  "ut_init_noarg_role.py"
+  "ut_init_noarg_method.py"
+  "ut_init_noarg_name.py"
+  "ut_init_noarg_hostname.py"
+  "ut_init_noarg_port.py"
+  "ut_init_noarg_out.py"
+  "ut_init_noarg_driver_name.py"
+  "ut_init_noarg_language.py"
+  "ut_init_double.py"
+  "tests/MDI_Test_Codes/misc_py/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "serve_py.py"
+  "tests/MDI_Test_Codes/serve_py/CMakeFiles/CMakeDirectoryInformation.cmake"
+  )
+
+# Dependency information for all targets:
+set(CMAKE_DEPEND_INFO_FILES
+  "MDI_Library/CMakeFiles/mdi.dir/DependInfo.cmake"
+  "tests/MDI_Test_Codes/driver_cxx/CMakeFiles/driver_cxx.dir/DependInfo.cmake"
+  "tests/MDI_Test_Codes/driver_serial_cxx/CMakeFiles/driver_serial_cxx.dir/DependInfo.cmake"
+  "tests/MDI_Test_Codes/driver_loop_cxx/CMakeFiles/driver_loop_cxx.dir/DependInfo.cmake"
+  "tests/MDI_Test_Codes/engine_cxx/CMakeFiles/engine_cxx.dir/DependInfo.cmake"
+  "tests/MDI_Test_Codes/engine_cxx/CMakeFiles/engine_cxx_lib.dir/DependInfo.cmake"
+  "tests/MDI_Test_Codes/driver_plug_cxx/CMakeFiles/driver_plug_cxx.dir/DependInfo.cmake"
+  "tests/MDI_Test_Codes/lib_cxx_cxx/CMakeFiles/engine_lib_cxx_cxx.dir/DependInfo.cmake"
+  "tests/MDI_Test_Codes/lib_cxx_cxx/CMakeFiles/driver_lib_cxx_cxx.dir/DependInfo.cmake"
+  "tests/MDI_Test_Codes/threads_cxx/CMakeFiles/threads_cxx.dir/DependInfo.cmake"
+  "tests/MDI_Test_Codes/bench_filter_cxx/CMakeFiles/bench_filter_cxx.dir/DependInfo.cmake"
+  "tests/MDI_Test_Codes/serve_cxx/CMakeFiles/serve_cxx.dir/DependInfo.cmake"
+  "tests/MDI_Test_Codes/regcache_cxx/CMakeFiles/regcache_cxx.dir/DependInfo.cmake"
+  "tests/MDI_Test_Codes/bench_plugin_cxx/CMakeFiles/bench_plugin_engine_cxx.dir/DependInfo.cmake"
+  "tests/MDI_Test_Codes/bench_plugin_cxx/CMakeFiles/bench_plugin_cxx.dir/DependInfo.cmake"
+  "tests/MDI_Test_Codes/async_plugin_cxx/CMakeFiles/async_plugin_engine_cxx.dir/DependInfo.cmake"
+  "tests/MDI_Test_Codes/async_plugin_cxx/CMakeFiles/async_plugin_cxx.dir/DependInfo.cmake"
+  "tests/MDI_Test_Codes/lib_cxx_py/CMakeFiles/driver_lib_cxx_py.dir/DependInfo.cmake"
+  "tests/MDI_Test_Codes/engine_ipi_cxx/CMakeFiles/engine_ipi_cxx.dir/DependInfo.cmake"
+  "tests/MDI_Test_Codes/bench_comms_cxx/CMakeFiles/bench_comms_cxx.dir/DependInfo.cmake"
+  "tests/MDI_Test_Codes/method_fifo_cxx/CMakeFiles/method_fifo_cxx.dir/DependInfo.cmake"
+  "tests/MDI_Test_Codes/alloc_count_cxx/CMakeFiles/alloc_count_cxx.dir/DependInfo.cmake"
+  "tests/MDI_Test_Codes/STUBS_MPI/CMakeFiles/mpi.dir/DependInfo.cmake"
+  "tests/MDI_Test_Codes/driver_f90/CMakeFiles/driver_f90.dir/DependInfo.cmake"
+  "tests/MDI_Test_Codes/driver_api_f90/CMakeFiles/driver_api_f90.dir/DependInfo.cmake"
+  "tests/MDI_Test_Codes/engine_f90/CMakeFiles/engine_f90.dir/DependInfo.cmake"
+  "tests/MDI_Test_Codes/engine_f90/CMakeFiles/engine_f90_lib.dir/DependInfo.cmake"
+  "tests/MDI_Test_Codes/lib_f90/CMakeFiles/engine_lib_f90.dir/DependInfo.cmake"
+  "tests/MDI_Test_Codes/lib_f90/CMakeFiles/driver_lib_f90.dir/DependInfo.cmake"
+  )
@@ -0,0 +1,19 @@
+#----------------------------------------------------------------
+# Generated CMake target import file.
+#----------------------------------------------------------------
+
+# Commands may need to know the format version.
+set(CMAKE_IMPORT_FILE_VERSION 1)
+
+# Import target "mdi::mdi" for configuration ""
+set_property(TARGET mdi::mdi APPEND PROPERTY IMPORTED_CONFIGURATIONS NOCONFIG)
+set_target_properties(mdi::mdi PROPERTIES
+  IMPORTED_LOCATION_NOCONFIG "${_IMPORT_PREFIX}/lib/mdi/libmdi.so.1"
+  IMPORTED_SONAME_NOCONFIG "libmdi.so.1"
+  )
+
+list(APPEND _cmake_import_check_targets mdi::mdi )
+list(APPEND _cmake_import_check_files_for_mdi::mdi "${_IMPORT_PREFIX}/lib/mdi/libmdi.so.1" )
+
+# Commands beyond this point should not need to know the version.
+set(CMAKE_IMPORT_FILE_VERSION)
@@ -0,0 +1,63 @@
+
+# Consider dependencies only in project.
+set(CMAKE_DEPENDS_IN_PROJECT_ONLY OFF)
+
+# The set of languages for which implicit dependencies are needed:
+set(CMAKE_DEPENDS_LANGUAGES
+  "Fortran"
+  )
+# The set of files for implicit dependencies of each language:
+set(CMAKE_DEPENDS_CHECK_Fortran
+  "/root/repo/MDI_Library/mdi_f90.F90" "/root/repo/build/MDI_Library/CMakeFiles/mdi.dir/mdi_f90.F90.o"
+  )
+set(CMAKE_Fortran_COMPILER_ID "GNU")
+set(CMAKE_Fortran_SUBMODULE_SEP "@")
+set(CMAKE_Fortran_SUBMODULE_EXT ".smod")
+
+# Preprocessor definitions for this target.
+set(CMAKE_TARGET_DEFINITIONS_Fortran
+  "MDI_WINDOWS=0"
+  "mdi_EXPORTS"
+  )
+
+# The include file search paths:
+set(CMAKE_Fortran_TARGET_INCLUDE_PATH
+  "/usr/lib/x86_64-linux-gnu/openmpi/include"
+  "/usr/lib/x86_64-linux-gnu/openmpi/include/openmpi"
+  )
+
+# The set of dependency files which are needed:
+set(CMAKE_DEPENDS_DEPENDENCY_FILES
+  "/root/repo/MDI_Library/mdi.c" "MDI_Library/CMakeFiles/mdi.dir/mdi.c.o" "gcc" "MDI_Library/CMakeFiles/mdi.dir/mdi.c.o.d"
+  "/root/repo/MDI_Library/mdi_async.c" "MDI_Library/CMakeFiles/mdi.dir/mdi_async.c.o" "gcc" "MDI_Library/CMakeFiles/mdi.dir/mdi_async.c.o.d"
+  "/root/repo/MDI_Library/mdi_compress.c" "MDI_Library/CMakeFiles/mdi.dir/mdi_compress.c.o" "gcc" "MDI_Library/CMakeFiles/mdi.dir/mdi_compress.c.o.d"
+  "/root/repo/MDI_Library/mdi_custom.c" "MDI_Library/CMakeFiles/mdi.dir/mdi_custom.c.o" "gcc" "MDI_Library/CMakeFiles/mdi.dir/mdi_custom.c.o.d"
+  "/root/repo/MDI_Library/mdi_datatype.c" "MDI_Library/CMakeFiles/mdi.dir/mdi_datatype.c.o" "gcc" "MDI_Library/CMakeFiles/mdi.dir/mdi_datatype.c.o.d"
+  "/root/repo/MDI_Library/mdi_delta.c" "MDI_Library/CMakeFiles/mdi.dir/mdi_delta.c.o" "gcc" "MDI_Library/CMakeFiles/mdi.dir/mdi_delta.c.o.d"
+  "/root/repo/MDI_Library/mdi_ensemble.c" "MDI_Library/CMakeFiles/mdi.dir/mdi_ensemble.c.o" "gcc" "MDI_Library/CMakeFiles/mdi.dir/mdi_ensemble.c.o.d"
+  "/root/repo/MDI_Library/mdi_filter.c" "MDI_Library/CMakeFiles/mdi.dir/mdi_filter.c.o" "gcc" "MDI_Library/CMakeFiles/mdi.dir/mdi_filter.c.o.d"
+  "/root/repo/MDI_Library/mdi_general.c" "MDI_Library/CMakeFiles/mdi.dir/mdi_general.c.o" "gcc" "MDI_Library/CMakeFiles/mdi.dir/mdi_general.c.o.d"
+  "/root/repo/MDI_Library/mdi_global.c" "MDI_Library/CMakeFiles/mdi.dir/mdi_global.c.o" "gcc" "MDI_Library/CMakeFiles/mdi.dir/mdi_global.c.o.d"
+  "/root/repo/MDI_Library/mdi_lib.c" "MDI_Library/CMakeFiles/mdi.dir/mdi_lib.c.o" "gcc" "MDI_Library/CMakeFiles/mdi.dir/mdi_lib.c.o.d"
+  "/root/repo/MDI_Library/mdi_mpi.c" "MDI_Library/CMakeFiles/mdi.dir/mdi_mpi.c.o" "gcc" "MDI_Library/CMakeFiles/mdi.dir/mdi_mpi.c.o.d"
+  "/root/repo/MDI_Library/mdi_precision.c" "MDI_Library/CMakeFiles/mdi.dir/mdi_precision.c.o" "gcc" "MDI_Library/CMakeFiles/mdi.dir/mdi_precision.c.o.d"
+  "/root/repo/MDI_Library/mdi_regcache.c" "MDI_Library/CMakeFiles/mdi.dir/mdi_regcache.c.o" "gcc" "MDI_Library/CMakeFiles/mdi.dir/mdi_regcache.c.o.d"
+  "/root/repo/MDI_Library/mdi_request.c" "MDI_Library/CMakeFiles/mdi.dir/mdi_request.c.o" "gcc" "MDI_Library/CMakeFiles/mdi.dir/mdi_request.c.o.d"
+  "/root/repo/MDI_Library/mdi_strided.c" "MDI_Library/CMakeFiles/mdi.dir/mdi_strided.c.o" "gcc" "MDI_Library/CMakeFiles/mdi.dir/mdi_strided.c.o.d"
+  "/root/repo/MDI_Library/mdi_tcp.c" "MDI_Library/CMakeFiles/mdi.dir/mdi_tcp.c.o" "gcc" "MDI_Library/CMakeFiles/mdi.dir/mdi_tcp.c.o.d"
+  "/root/repo/MDI_Library/mdi_test.c" "MDI_Library/CMakeFiles/mdi.dir/mdi_test.c.o" "gcc" "MDI_Library/CMakeFiles/mdi.dir/mdi_test.c.o.d"
+  "/root/repo/MDI_Library/mdi_units.c" "MDI_Library/CMakeFiles/mdi.dir/mdi_units.c.o" "gcc" "MDI_Library/CMakeFiles/mdi.dir/mdi_units.c.o.d"
+  )
+
+# Pairs of files generated by the same build rule.
+set(CMAKE_MULTIPLE_OUTPUT_PAIRS
+  "/root/repo/build/MDI_Library/libmdi.so" "/root/repo/build/MDI_Library/libmdi.so.1"
+  )
+
+
+# Targets to which this target links.
+set(CMAKE_TARGET_LINKED_INFO_FILES
+  )
+
+# Fortran module output directory.
+set(CMAKE_Fortran_TARGET_MODULE_DIR "")
@@ -0,0 +1,49 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/mdi.dir/mdi.c.o"
+  "CMakeFiles/mdi.dir/mdi.c.o.d"
+  "CMakeFiles/mdi.dir/mdi_async.c.o"
+  "CMakeFiles/mdi.dir/mdi_async.c.o.d"
+  "CMakeFiles/mdi.dir/mdi_compress.c.o"
+  "CMakeFiles/mdi.dir/mdi_compress.c.o.d"
+  "CMakeFiles/mdi.dir/mdi_custom.c.o"
+  "CMakeFiles/mdi.dir/mdi_custom.c.o.d"
+  "CMakeFiles/mdi.dir/mdi_datatype.c.o"
+  "CMakeFiles/mdi.dir/mdi_datatype.c.o.d"
+  "CMakeFiles/mdi.dir/mdi_delta.c.o"
+  "CMakeFiles/mdi.dir/mdi_delta.c.o.d"
+  "CMakeFiles/mdi.dir/mdi_ensemble.c.o"
+  "CMakeFiles/mdi.dir/mdi_ensemble.c.o.d"
+  "CMakeFiles/mdi.dir/mdi_f90.F90.o"
+  "CMakeFiles/mdi.dir/mdi_filter.c.o"
+  "CMakeFiles/mdi.dir/mdi_filter.c.o.d"
+  "CMakeFiles/mdi.dir/mdi_general.c.o"
+  "CMakeFiles/mdi.dir/mdi_general.c.o.d"
+  "CMakeFiles/mdi.dir/mdi_global.c.o"
+  "CMakeFiles/mdi.dir/mdi_global.c.o.d"
+  "CMakeFiles/mdi.dir/mdi_lib.c.o"
+  "CMakeFiles/mdi.dir/mdi_lib.c.o.d"
+  "CMakeFiles/mdi.dir/mdi_mpi.c.o"
+  "CMakeFiles/mdi.dir/mdi_mpi.c.o.d"
+  "CMakeFiles/mdi.dir/mdi_precision.c.o"
+  "CMakeFiles/mdi.dir/mdi_precision.c.o.d"
+  "CMakeFiles/mdi.dir/mdi_regcache.c.o"
+  "CMakeFiles/mdi.dir/mdi_regcache.c.o.d"
+  "CMakeFiles/mdi.dir/mdi_request.c.o"
+  "CMakeFiles/mdi.dir/mdi_request.c.o.d"
+  "CMakeFiles/mdi.dir/mdi_strided.c.o"
+  "CMakeFiles/mdi.dir/mdi_strided.c.o.d"
+  "CMakeFiles/mdi.dir/mdi_tcp.c.o"
+  "CMakeFiles/mdi.dir/mdi_tcp.c.o.d"
+  "CMakeFiles/mdi.dir/mdi_test.c.o"
+  "CMakeFiles/mdi.dir/mdi_test.c.o.d"
+  "CMakeFiles/mdi.dir/mdi_units.c.o"
+  "CMakeFiles/mdi.dir/mdi_units.c.o.d"
+  "libmdi.pdb"
+  "libmdi.so"
+  "libmdi.so.1"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang C Fortran)
+  include(CMakeFiles/mdi.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
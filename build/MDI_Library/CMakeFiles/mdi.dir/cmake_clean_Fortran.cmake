@@ -0,0 +1,14 @@
+# Remove fortran modules provided by this target.
+FILE(REMOVE
+  "mdi.mod"
+  "MDI.mod"
+  "CMakeFiles/mdi.dir/mdi.mod.stamp"
+
+  "mdi_global.mod"
+  "MDI_GLOBAL.mod"
+  "CMakeFiles/mdi.dir/mdi_global.mod.stamp"
+
+  "mdi_internal.mod"
+  "MDI_INTERNAL.mod"
+  "CMakeFiles/mdi.dir/mdi_internal.mod.stamp"
+  )
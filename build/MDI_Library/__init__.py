@@ -0,0 +1,22 @@
+from .mdi import MDI_COMMAND_LENGTH, MDI_NAME_LENGTH, MDI_LABEL_LENGTH, \
+    MDI_COMM_NULL, MDI_REQUEST_NULL, MDI_CONTEXT_DEFAULT, \
+    MDI_INT, MDI_DOUBLE, MDI_CHAR, MDI_BYTE, \
+    MDI_FLOAT, MDI_INT64, MDI_INT8, MDI_COMPLEX_DOUBLE, \
+    MDI_TCP, MDI_MPI, MDI_LINK, MDI_TEST, \
+    MDI_DRIVER, MDI_ENGINE, \
+    MDI_MAJOR_VERSION, MDI_MINOR_VERSION, MDI_PATCH_VERSION, \
+    MDI_Init, MDI_Accept_Communicator, \
+    MDI_Send, MDI_Recv, MDI_Send_Command, MDI_Recv_Command, \
+    MDI_Send_c, MDI_Recv_c, \
+    MDI_Send_strided, MDI_Recv_strided, \
+    MDI_Sendv, MDI_Recvv, \
+    MDI_Send_init, MDI_Recv_init, MDI_Start, MDI_Request_free, \
+    MDI_Send_stream, MDI_Recv_stream, \
+    MDI_Send_units, MDI_Recv_units, \
+    MDI_Conversion_Factor, MDI_Get_Role, MDI_MPI_get_world_comm, \
+    MDI_Set_Execute_Command_Func, \
+    MDI_Register_Node, MDI_Check_Node_Exists, MDI_Get_NNodes, MDI_Get_Node, \
+    MDI_Register_Command, MDI_Check_Command_Exists, MDI_Get_NCommands, MDI_Get_Command, \
+    MDI_Register_Callback, MDI_Check_Callback_Exists, MDI_Get_NCallbacks, MDI_Get_Callback, \
+    MDI_Freeze_Registry, MDI_Register_Command_Handler, MDI_Serve, \
+    MDI_Context_create, MDI_Context_free, MDI_Set_context, MDI_Get_context
@@ -0,0 +1,285 @@
+/* ----------------------------------------------------------------------
+   MDI - MolSSI Driver Interface
+   https://molssi.org/, Molecular Sciences Software Institute
+   Taylor Barnes, tbarnes1@vt.edu
+-------------------------------------------------------------------------
+
+Contents:
+   MDI_Init: Initializes a socket and sets it to listen
+   MDI_Accept_Communicator: Accepts a new MDI communicator
+   MDI_Send: Sends data through the socket
+   MDI_Recv: Receives data from the socket
+   MDI_Send_c: Sends data through the socket, with a 64-bit count
+   MDI_Recv_c: Receives data from the socket, with a 64-bit count
+   MDI_Send_strided: Sends a strided array through the socket
+   MDI_Recv_strided: Receives data from the socket into a strided array
+   MDI_Sendv: Sends several arrays through the socket as a single message
+   MDI_Recvv: Receives several arrays from the socket as a single message
+   MDI_Send_init: Creates a persistent request for sending data
+   MDI_Recv_init: Creates a persistent request for receiving data
+   MDI_Start: Performs the transfer described by a persistent request
+   MDI_Request_free: Frees a persistent request
+   MDI_Send_stream: Sends data that is produced in chunks by a callback
+   MDI_Recv_stream: Receives data that is delivered in chunks to a callback
+   MDI_Send_units: Sends data in a specified unit
+   MDI_Recv_units: Receives data, converting it to a specified unit
+   MDI_Send_Command: Sends a string of length MDI_COMMAND_LENGTH over the
+      socket
+   MDI_Recv_Command: Receives a string of length MDI_COMMAND_LENGTH over the
+      socket
+*/
+
+#ifndef MDI_LIBRARY
+#define MDI_LIBRARY
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+//namespace MDI_STUBS { }
+extern "C" {
+#endif
+
+// ensure that symbols are exported to Windows .dll files
+#ifdef _WIN32
+  #define DllExport   __declspec( dllexport )
+#else
+  #define DllExport 
+#endif
+
+// type of an MDI communicator handle
+typedef int MDI_Comm;
+
+// type of an MDI datatype handle
+typedef int MDI_Datatype;
+
+// type of an MDI persistent request handle
+typedef int MDI_Request;
+
+// type of an MDI context handle
+typedef int MDI_Context;
+
+typedef int (*MDI_Driver_node_callback_t)(void*, int, void*);
+
+// type of a callback that drives a plugin instance of an ensemble through one task
+// the arguments are the MPI intra-communicator of the instance, the communicator to its engine,
+// the index of the task, and a context pointer
+typedef int (*MDI_Ensemble_task_callback_t)(void*, int, int, void*);
+
+// type of a callback that produces or consumes a chunk of a streamed message
+// the arguments are the chunk buffer, the offset and number of elements in the chunk, and a context pointer
+typedef int (*MDI_Stream_callback_t)(void*, int64_t, int64_t, void*);
+
+// types of the functions of a filter stage, which are passed the body of a message, its count and
+// datatype, the communicator, and the state of the stage
+// on_send may point the body at a transformed copy that it owns, while on_recv transforms the body in place
+typedef int (*MDI_Filter_send_t)(const void**, int64_t, MDI_Datatype, MDI_Comm, void*);
+typedef int (*MDI_Filter_recv_t)(void*, int64_t, MDI_Datatype, MDI_Comm, void*);
+
+// types of the functions that implement a communication method registered with MDI_Register_Method
+// init is passed the role and options of MDI_Init, and may set a pointer to the state of the method
+typedef int (*MDI_Method_init_t)(const char*, const char*, void**);
+// accept and connect are passed the state of the method, and set a pointer to a new connection
+typedef int (*MDI_Method_connect_t)(void*, void**);
+// send and recv are passed a buffer, a number of bytes, and a connection
+typedef int (*MDI_Method_send_t)(const void*, int64_t, void*);
+typedef int (*MDI_Method_recv_t)(void*, int64_t, void*);
+// delete is passed a connection that is no longer used
+typedef int (*MDI_Method_delete_t)(void*);
+
+// type of a function that responds to a command, which is passed the command, the communicator,
+// and the pointer given when the handler was registered
+typedef int (*MDI_Command_handler_t)(const char*, MDI_Comm, void*);
+
+// MDI version numbers
+DllExport extern const int MDI_MAJOR_VERSION;
+DllExport extern const int MDI_MINOR_VERSION;
+DllExport extern const int MDI_PATCH_VERSION;
+
+// length of an MDI command in characters
+DllExport extern const int MDI_COMMAND_LENGTH;
+
+// length of an MDI name in characters
+DllExport extern const int MDI_NAME_LENGTH;
+
+// length of an MDI label in characters
+DllExport extern const int MDI_LABEL_LENGTH;
+
+// value of a null communicator
+DllExport extern const MDI_Comm MDI_COMM_NULL;
+
+// value of a null persistent request
+DllExport extern const MDI_Request MDI_REQUEST_NULL;
+
+// value of the default context
+DllExport extern const MDI_Context MDI_CONTEXT_DEFAULT;
+
+// MDI data types
+DllExport extern const int MDI_INT;
+DllExport extern const int MDI_DOUBLE;
+DllExport extern const int MDI_CHAR;
+DllExport extern const int MDI_BYTE;
+DllExport extern const int MDI_FLOAT;
+DllExport extern const int MDI_INT64;
+DllExport extern const int MDI_INT8;
+DllExport extern const int MDI_COMPLEX_DOUBLE;
+
+// MDI communication types
+DllExport extern const int MDI_TCP;
+DllExport extern const int MDI_MPI;
+DllExport extern const int MDI_LINK;
+DllExport extern const int MDI_TEST;
+
+// MDI role types
+DllExport extern const int MDI_DRIVER;
+DllExport extern const int MDI_ENGINE;
+
+// plugin cache modes
+DllExport extern const int MDI_PLUGIN_UNLOAD;
+DllExport extern const int MDI_PLUGIN_RESIDENT;
+DllExport extern const int MDI_PLUGIN_KEEPALIVE;
+
+// asynchronous plugin modes
+DllExport extern const int MDI_ASYNC_THREAD;
+DllExport extern const int MDI_ASYNC_COROUTINE;
+
+// functions for handling MDI communication
+DllExport int MDI_Init(const char* options, void* world_comm);
+DllExport int MDI_Accept_Communicator(MDI_Comm* comm);
+DllExport int MDI_Accept_communicator(MDI_Comm* comm);
+DllExport int MDI_Send(const void* buf, int count, MDI_Datatype datatype, MDI_Comm comm);
+DllExport int MDI_Recv(void* buf, int count, MDI_Datatype datatype, MDI_Comm comm);
+DllExport int MDI_Send_c(const void* buf, int64_t count, MDI_Datatype datatype, MDI_Comm comm);
+DllExport int MDI_Recv_c(void* buf, int64_t count, MDI_Datatype datatype, MDI_Comm comm);
+DllExport int MDI_Send_strided(const void* buf, int ndims, const int64_t* shape, const int64_t* strides,
+                               MDI_Datatype datatype, MDI_Comm comm);
+DllExport int MDI_Recv_strided(void* buf, int ndims, const int64_t* shape, const int64_t* strides,
+                               MDI_Datatype datatype, MDI_Comm comm);
+DllExport int MDI_Sendv(int nseg, const void* const* bufs, const int64_t* counts,
+                        const MDI_Datatype* datatypes, MDI_Comm comm);
+DllExport int MDI_Recvv(int nseg, void* const* bufs, const int64_t* counts,
+                        const MDI_Datatype* datatypes, MDI_Comm comm);
+DllExport int MDI_Send_init(const void* buf, int64_t count, MDI_Datatype datatype, MDI_Comm comm,
+                            MDI_Request* request);
+DllExport int MDI_Recv_init(void* buf, int64_t count, MDI_Datatype datatype, MDI_Comm comm,
+                            MDI_Request* request);
+DllExport int MDI_Start(MDI_Request request);
+DllExport int MDI_Request_free(MDI_Request* request);
+DllExport int MDI_Send_stream(int64_t count, MDI_Datatype datatype, int64_t chunk_size,
+                              MDI_Stream_callback_t producer, void* ctx, MDI_Comm comm);
+DllExport int MDI_Recv_stream(int64_t count, MDI_Datatype datatype, int64_t chunk_size,
+                              MDI_Stream_callback_t consumer, void* ctx, MDI_Comm comm);
+DllExport int MDI_Send_units(const void* buf, int64_t count, MDI_Datatype datatype, const char* units,
+                             MDI_Comm comm);
+DllExport int MDI_Recv_units(void* buf, int64_t count, MDI_Datatype datatype, const char* units,
+                             MDI_Comm comm);
+DllExport int MDI_Send_Command(const char* buf, MDI_Comm comm);
+DllExport int MDI_Send_command(const char* buf, MDI_Comm comm);
+DllExport int MDI_Recv_Command(char* buf, MDI_Comm comm);
+DllExport int MDI_Recv_command(char* buf, MDI_Comm comm);
+DllExport int MDI_Conversion_Factor(const char* in_unit, const char* out_unit, double* conv);
+DllExport int MDI_Conversion_factor(const char* in_unit, const char* out_unit, double* conv);
+DllExport int MDI_Get_Role(int* role);
+DllExport int MDI_Get_role(int* role);
+
+// functions for managing Nodes, Commands, and Callbacks
+DllExport int MDI_Register_Node(const char* node_name);
+DllExport int MDI_Register_node(const char* node_name);
+DllExport int MDI_Check_Node_Exists(const char* node_name, MDI_Comm comm, int* flag);
+DllExport int MDI_Check_node_exists(const char* node_name, MDI_Comm comm, int* flag);
+DllExport int MDI_Get_NNodes(MDI_Comm comm, int* nnodes);
+DllExport int MDI_Get_nnodes(MDI_Comm comm, int* nnodes);
+DllExport int MDI_Get_Node(int index, MDI_Comm comm, char* name);
+DllExport int MDI_Get_node(int index, MDI_Comm comm, char* name);
+DllExport int MDI_Register_Command(const char* node_name, const char* command_name);
+DllExport int MDI_Register_command(const char* node_name, const char* command_name);
+DllExport int MDI_Check_Command_Exists(const char* node_name, const char* command_name, MDI_Comm comm, int* flag);
+DllExport int MDI_Check_command_exists(const char* node_name, const char* command_name, MDI_Comm comm, int* flag);
+DllExport int MDI_Get_NCommands(const char* node_name, MDI_Comm comm, int* ncommands);
+DllExport int MDI_Get_ncommands(const char* node_name, MDI_Comm comm, int* ncommands);
+DllExport int MDI_Get_Command(const char* node_name, int index, MDI_Comm comm, char* name);
+DllExport int MDI_Get_command(const char* node_name, int index, MDI_Comm comm, char* name);
+DllExport int MDI_Register_Callback(const char* node_name, const char* callback_name);
+DllExport int MDI_Register_callback(const char* node_name, const char* callback_name);
+DllExport int MDI_Check_Callback_Exists(const char* node_name, const char* callback_name, MDI_Comm comm, int* flag);
+DllExport int MDI_Check_callback_exists(const char* node_name, const char* callback_name, MDI_Comm comm, int* flag);
+DllExport int MDI_Get_NCallbacks(const char* node_name, MDI_Comm comm, int* ncallbacks);
+DllExport int MDI_Get_ncallbacks(const char* node_name, MDI_Comm comm, int* ncallbacks);
+DllExport int MDI_Get_Callback(const char* node_name, int index, MDI_Comm comm, char* name);
+DllExport int MDI_Get_callback(const char* node_name, int index, MDI_Comm comm, char* name);
+DllExport int MDI_Freeze_Registry();
+
+// functions for responding to commands through a table of command handlers
+DllExport int MDI_Register_Command_Handler(const char* node_name, const char* command_name,
+                                           MDI_Command_handler_t handler, void* ctx);
+DllExport int MDI_Register_command_handler(const char* node_name, const char* command_name,
+                                           MDI_Command_handler_t handler, void* ctx);
+DllExport int MDI_Serve(MDI_Comm comm);
+
+// functions for managing contexts, each of which holds library state that is independent of other contexts
+DllExport int MDI_Context_create(MDI_Context* context);
+DllExport int MDI_Context_free(MDI_Context context);
+DllExport int MDI_Set_context(MDI_Context context);
+DllExport int MDI_Get_context(MDI_Context* context);
+DllExport int MDI_Init_ctx(MDI_Context context, const char* options, void* world_comm);
+DllExport int MDI_Accept_communicator_ctx(MDI_Context context, MDI_Comm* comm);
+DllExport int MDI_Send_ctx(MDI_Context context, const void* buf, int count, MDI_Datatype datatype, MDI_Comm comm);
+DllExport int MDI_Recv_ctx(MDI_Context context, void* buf, int count, MDI_Datatype datatype, MDI_Comm comm);
+DllExport int MDI_Send_command_ctx(MDI_Context context, const char* buf, MDI_Comm comm);
+DllExport int MDI_Recv_command_ctx(MDI_Context context, char* buf, MDI_Comm comm);
+DllExport int MDI_Set_execute_command_func_ctx(MDI_Context context,
+                                               int (*generic_command)(const char*, MDI_Comm, void*),
+                                               void* class_object);
+
+// functions for registering communication methods
+DllExport int MDI_Register_Method(const char* name, MDI_Method_init_t init, MDI_Method_connect_t accept,
+                                  MDI_Method_connect_t connect, MDI_Method_send_t send,
+                                  MDI_Method_recv_t recv, MDI_Method_delete_t del);
+DllExport int MDI_Register_method(const char* name, MDI_Method_init_t init, MDI_Method_connect_t accept,
+                                  MDI_Method_connect_t connect, MDI_Method_send_t send,
+                                  MDI_Method_recv_t recv, MDI_Method_delete_t del);
+
+// functions for managing the filter stages through which the bodies of messages pass
+DllExport int MDI_Register_filter(const char* name, MDI_Filter_send_t on_send, MDI_Filter_recv_t on_recv,
+                                  void* state);
+DllExport int MDI_Filter_push(MDI_Comm comm, const char* name);
+DllExport int MDI_Filter_pop(MDI_Comm comm);
+
+// functions for handling MPI in combination with MDI
+DllExport int MDI_MPI_get_world_comm(void* world_comm);
+
+// functions for managing callback functions (used only with the LINK communication method)
+DllExport int MDI_Launch_plugin(const char* plugin_name, const char* options, void* mpi_comm_ptr,
+                                MDI_Driver_node_callback_t driver_node_callback,
+                                void* driver_callback_object);
+DllExport int MDI_Launch_plugin_async(const char* plugin_name, const char* options, void* mpi_comm_ptr,
+                                      MDI_Comm* comm);
+DllExport int MDI_Set_async_plugin_mode(int mode, int64_t stack_size);
+DllExport int MDI_Launch_plugin_ensemble(const char* plugin_name, const char* options, void* mpi_comm_ptr,
+                                         int driver_nranks, int plugin_nranks, int ntasks,
+                                         MDI_Ensemble_task_callback_t task_callback,
+                                         void* class_object);
+DllExport int MDI_Set_plugin_cache(int mode);
+DllExport int MDI_Unload_plugin(const char* plugin_name);
+DllExport int MDI_Set_Execute_Command_Func(int (*generic_command)(const char*, MDI_Comm, void*), void* class_object);
+DllExport int MDI_Set_execute_command_func(int (*generic_command)(const char*, MDI_Comm, void*), void* class_object);
+
+// functions for managing callback functions for mpi4py
+DllExport int MDI_Set_Mpi4py_Recv_Callback(int (*mpi4py_recv)(void*, int, int, int, MDI_Comm));
+DllExport int MDI_Set_Mpi4py_Send_Callback(int (*mpi4py_send)(void*, int, int, int, MDI_Comm));
+DllExport int MDI_Set_Mpi4py_Gather_Names_Callback(int (*mpi4py_gather_names)(void*, void*));
+DllExport int MDI_Set_Mpi4py_Split_Callback(int (*mpi4py_split)(int, int, MDI_Comm, int));
+DllExport int MDI_Set_Mpi4py_Rank_Callback(int (*mpi4py_rank)(int));
+DllExport int MDI_Set_Mpi4py_Size_Callback(int (*mpi4py_size)(int));
+DllExport int MDI_Set_Mpi4py_Barrier_Callback(int (*mpi4py_barrier)(int));
+
+// only used internally by MDI
+DllExport void mdi_error(const char* message);
+DllExport void MDI_Set_World_Size(int world_size_in);
+DllExport void MDI_Set_World_Rank(int world_rank_in);
+DllExport int MDI_Get_Current_Code();
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,192 @@
+import sys
+
+try: # Check for local build
+    import MDI_Library as mdi
+except: # Check for installed package
+    import mdi
+
+import numpy as np
+
+# Exercise the functions of the Python binding that transfer arrays, against engine_cxx
+# The -test argument selects the functions that are exercised
+natoms = 10
+coords = [ 0.25 * icoord for icoord in range( 3 * natoms ) ]
+
+ntypes = 4
+floats = [ 0.5 + float(i) for i in range(ntypes) ]
+int64s = [ 2**40 + i for i in range(ntypes) ]
+int8s = [ -i for i in range(ntypes) ]
+complexes = [ complex(i, -0.5 * i) for i in range(ntypes) ]
+floats_np = np.array(floats, dtype=np.float32)
+int64s_np = np.array(int64s, dtype=np.int64)
+int8s_np = np.array(int8s, dtype=np.int8)
+complexes_np = np.array(complexes, dtype=np.complex128)
+
+test = "send_c"
+for iarg in range( len(sys.argv) - 1 ):
+    if sys.argv[iarg] == "-test":
+        test = sys.argv[iarg + 1]
+
+def report(name, passed):
+    if passed:
+        print(" " + name + ": OK")
+    else:
+        print(" " + name + ": FAILED")
+
+# 64-bit element counts
+def test_send_c(comm):
+    mdi.MDI_Send_Command(">COORDS", comm)
+    mdi.MDI_Send_c(coords, 3 * natoms, mdi.MDI_DOUBLE, comm)
+    mdi.MDI_Send_Command("<COORDS", comm)
+    received = mdi.MDI_Recv_c(3 * natoms, mdi.MDI_DOUBLE, comm)
+    report("Send_c", received == coords)
+
+# Extended datatypes, sent and received first as lists and then as numpy arrays
+def test_types(comm):
+    mdi.MDI_Send_Command(">TYPES", comm)
+    mdi.MDI_Send(ntypes, 1, mdi.MDI_INT, comm)
+    mdi.MDI_Send(floats, ntypes, mdi.MDI_FLOAT, comm)
+    mdi.MDI_Send(int64s, ntypes, mdi.MDI_INT64, comm)
+    mdi.MDI_Send(int8s, ntypes, mdi.MDI_INT8, comm)
+    mdi.MDI_Send(complexes, ntypes, mdi.MDI_COMPLEX_DOUBLE, comm)
+    mdi.MDI_Send_Command("<TYPES", comm)
+    size = mdi.MDI_Recv(1, mdi.MDI_INT, comm)
+    passed = ( size == ntypes )
+    passed = mdi.MDI_Recv(size, mdi.MDI_FLOAT, comm) == floats and passed
+    passed = mdi.MDI_Recv(size, mdi.MDI_INT64, comm) == int64s and passed
+    passed = mdi.MDI_Recv(size, mdi.MDI_INT8, comm) == int8s and passed
+    passed = mdi.MDI_Recv(size, mdi.MDI_COMPLEX_DOUBLE, comm) == complexes and passed
+    report("Types", passed)
+
+    mdi.MDI_Send_Command(">TYPES", comm)
+    mdi.MDI_Send(ntypes, 1, mdi.MDI_INT, comm)
+    mdi.MDI_Send(floats_np, ntypes, mdi.MDI_FLOAT, comm)
+    mdi.MDI_Send(int64s_np, ntypes, mdi.MDI_INT64, comm)
+    mdi.MDI_Send(int8s_np, ntypes, mdi.MDI_INT8, comm)
+    mdi.MDI_Send(complexes_np, ntypes, mdi.MDI_COMPLEX_DOUBLE, comm)
+    mdi.MDI_Send_Command("<TYPES", comm)
+    size = mdi.MDI_Recv(1, mdi.MDI_INT, comm)
+    arrays = [ np.zeros(size, dtype=np.float32), np.zeros(size, dtype=np.int64),
+               np.zeros(size, dtype=np.int8), np.zeros(size, dtype=np.complex128) ]
+    mdi.MDI_Recv(size, mdi.MDI_FLOAT, comm, buf = arrays[0])
+    mdi.MDI_Recv(size, mdi.MDI_INT64, comm, buf = arrays[1])
+    mdi.MDI_Recv(size, mdi.MDI_INT8, comm, buf = arrays[2])
+    mdi.MDI_Recv(size, mdi.MDI_COMPLEX_DOUBLE, comm, buf = arrays[3])
+    report("Types_numpy", np.array_equal(arrays[0], floats_np) and np.array_equal(arrays[1], int64s_np) and
+           np.array_equal(arrays[2], int8s_np) and np.array_equal(arrays[3], complexes_np))
+
+# Strided arrays, which are the first three columns of an array with four columns
+def test_strided(comm):
+    padded = np.zeros((natoms, 4), dtype=np.float64)
+    padded[:, :3] = np.array(coords).reshape((natoms, 3))
+    mdi.MDI_Send_Command(">COORDS", comm)
+    mdi.MDI_Send_strided(padded[:, :3], mdi.MDI_DOUBLE, comm)
+    mdi.MDI_Send_Command("<COORDS", comm)
+    received_padded = np.full((natoms, 4), -1.0, dtype=np.float64)
+    mdi.MDI_Recv_strided(received_padded[:, :3], mdi.MDI_DOUBLE, comm)
+    report("Strided", np.array_equal(received_padded[:, :3], padded[:, :3]) and np.all(received_padded[:, 3] == -1.0))
+
+# Vectored messages
+def test_sendv(comm):
+    datatypes = [ mdi.MDI_FLOAT, mdi.MDI_INT64, mdi.MDI_INT8, mdi.MDI_COMPLEX_DOUBLE ]
+    mdi.MDI_Send_Command(">TYPESV", comm)
+    mdi.MDI_Send(ntypes, 1, mdi.MDI_INT, comm)
+    mdi.MDI_Sendv([ 2 * floats_np, 2 * int64s_np, 2 * int8s_np, 2 * complexes_np ], datatypes, comm)
+    mdi.MDI_Send_Command("<TYPESV", comm)
+    arrays = [ np.zeros(ntypes, dtype=np.float32), np.zeros(ntypes, dtype=np.int64),
+               np.zeros(ntypes, dtype=np.int8), np.zeros(ntypes, dtype=np.complex128) ]
+    mdi.MDI_Recvv(arrays, datatypes, comm)
+    report("Sendv", np.array_equal(arrays[0], 2 * floats_np) and np.array_equal(arrays[1], 2 * int64s_np) and
+           np.array_equal(arrays[2], 2 * int8s_np) and np.array_equal(arrays[3], 2 * complexes_np))
+
+# Persistent requests, which are started once per step
+def test_send_init(comm):
+    send_coords = np.zeros(3 * natoms, dtype=np.float64)
+    recv_coords = np.zeros(3 * natoms, dtype=np.float64)
+    send_request = mdi.MDI_Send_init(send_coords, mdi.MDI_DOUBLE, comm)
+    recv_request = mdi.MDI_Recv_init(recv_coords, mdi.MDI_DOUBLE, comm)
+    passed = True
+    for istep in range(3):
+        send_coords[:] = np.array(coords) + istep
+        mdi.MDI_Send_Command(">COORDS", comm)
+        mdi.MDI_Start(send_request)
+        mdi.MDI_Send_Command("<COORDS", comm)
+        mdi.MDI_Start(recv_request)
+        passed = np.array_equal(recv_coords, send_coords) and passed
+    mdi.MDI_Request_free(send_request)
+    mdi.MDI_Request_free(recv_request)
+    report("Send_init", passed)
+
+# Streams, which are produced and consumed in chunks
+def test_stream(comm):
+    grid_size = 1000
+    chunk_size = 128
+    grid = np.zeros(grid_size, dtype=np.float64)
+    def grid_producer(offset, count):
+        return 0.5 * np.arange(offset, offset + count, dtype=np.float64)
+    def grid_consumer(chunk, offset):
+        grid[offset:offset + chunk.size] = chunk
+    mdi.MDI_Send_Command(">GRID", comm)
+    mdi.MDI_Send(grid_size, 1, mdi.MDI_INT, comm)
+    mdi.MDI_Send_stream(grid_size, mdi.MDI_DOUBLE, chunk_size, grid_producer, comm)
+    mdi.MDI_Send_Command("<GRID", comm)
+    size = mdi.MDI_Recv(1, mdi.MDI_INT, comm)
+    mdi.MDI_Recv_stream(size, mdi.MDI_DOUBLE, chunk_size, grid_consumer, comm)
+    report("Stream", size == grid_size and np.array_equal(grid, grid_producer(0, grid_size)))
+
+# Unit-aware transfers, which the engine stores in atomic units
+def test_units(comm):
+    factor = mdi.MDI_Conversion_Factor("angstrom", "atomic_unit_of_length")
+    coords_angstrom = np.array(coords, dtype=np.float64)
+    mdi.MDI_Send_Command(">COORDS", comm)
+    mdi.MDI_Send_units(coords_angstrom, mdi.MDI_DOUBLE, "angstrom", comm)
+    mdi.MDI_Send_Command("<COORDS", comm)
+    coords_bohr = np.array(mdi.MDI_Recv(3 * natoms, mdi.MDI_DOUBLE, comm))
+    mdi.MDI_Send_Command("<COORDS", comm)
+    received = np.zeros(3 * natoms, dtype=np.float64)
+    mdi.MDI_Recv_units(received, mdi.MDI_DOUBLE, "angstrom", comm)
+    report("Units", np.allclose(coords_bohr, factor * coords_angstrom, rtol=1.0e-12, atol=0.0) and
+           np.allclose(received, coords_angstrom, rtol=1.0e-12, atol=1.0e-15))
+
+tests = { "send_c": test_send_c,
+          "types": test_types,
+          "strided": test_strided,
+          "sendv": test_sendv,
+          "send_init": test_send_init,
+          "stream": test_stream,
+          "units": test_units,
+          "context": test_send_c }
+if test not in tests:
+    raise Exception("Unrecognized test: " + test)
+
+# Run every call within a context of its own
+if test == "context":
+    default_context = mdi.MDI_Get_context()
+    context = mdi.MDI_Context_create()
+    mdi.MDI_Set_context(context)
+    report("Context", default_context == mdi.MDI_CONTEXT_DEFAULT and mdi.MDI_Get_context() == context)
+
+# Initialize the MDI Library
+mdi.MDI_Init(sys.argv[2], None)
+
+# Confirm that this code is being used as a driver
+role = mdi.MDI_Get_Role()
+if not role == mdi.MDI_DRIVER:
+    raise Exception("Must run driver_api_py.py as a DRIVER")
+
+# Connect to the engine
+comm = mdi.MDI_Accept_Communicator()
+
+mdi.MDI_Send_Command("<NAME", comm)
+name = mdi.MDI_Recv(mdi.MDI_NAME_LENGTH, mdi.MDI_CHAR, comm)
+print(" Engine name: " + str(name))
+
+tests[test](comm)
+
+# Send the "EXIT" command to the engine
+mdi.MDI_Send_Command("EXIT", comm)
+
+# Return to the default context, and free the context of this code
+if test == "context":
+    mdi.MDI_Set_context(mdi.MDI_CONTEXT_DEFAULT)
+    mdi.MDI_Context_free(context)
@@ -0,0 +1,63 @@
+import sys
+
+try: # Check for local build
+    import MDI_Library as mdi
+except: # Check for installed package
+    import mdi
+
+# Respond to the commands of a driver through handlers registered with MDI_Register_Command_Handler
+# The library matches each command to its handler, so the handlers never decode the command
+
+class MDIEngine:
+
+    def __init__(self):
+        self.natoms = 10
+        self.coords = [ 0.0 for i in range( 3 * self.natoms ) ]
+        self.nhandled = 0
+        self.exit_flag = False
+
+def recv_coords(comm, self):
+    self.coords = mdi.MDI_Recv(3 * self.natoms, mdi.MDI_DOUBLE, comm)
+    self.nhandled += 1
+    return 0
+
+def send_coords(comm, self):
+    mdi.MDI_Send(self.coords, 3 * self.natoms, mdi.MDI_DOUBLE, comm)
+    self.nhandled += 1
+    return 0
+
+def send_nhandled(comm, self):
+    mdi.MDI_Send(self.nhandled, 1, mdi.MDI_INT, comm)
+    return 0
+
+def exit_engine(comm, self):
+    self.exit_flag = True
+    return 0
+
+if __name__== "__main__":
+    engine = MDIEngine()
+
+    # Read the number of drivers that a persistent engine serves
+    nsessions = 1
+    if len(sys.argv) > 4 and sys.argv[3] == "-nsessions":
+        nsessions = int(sys.argv[4])
+
+    # Initialize the MDI Library
+    mdi.MDI_Init(sys.argv[2], None)
+
+    # Register the handlers, some of which are registered after the registry is frozen
+    mdi.MDI_Register_Node("@DEFAULT")
+    mdi.MDI_Register_Command_Handler("@DEFAULT", ">COORDS", recv_coords, engine)
+    mdi.MDI_Register_Command_Handler("@DEFAULT", "<COORDS", send_coords, engine)
+    mdi.MDI_Freeze_Registry()
+    mdi.MDI_Register_Command_Handler("@DEFAULT", "<NHANDLED", send_nhandled, engine)
+    mdi.MDI_Register_Command_Handler("@DEFAULT", "EXIT", exit_engine, engine)
+
+    # Connect to each driver, and respond to its commands until it sends EXIT
+    for isession in range(nsessions):
+        engine.exit_flag = False
+        comm = mdi.MDI_Accept_Communicator()
+        mdi.MDI_Serve(comm)
+
+        if not engine.exit_flag:
+            raise Exception("Error in serve_py.py: the engine did not receive EXIT")
@@ -0,0 +1,10 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/mpi.dir/mpi.F90.o"
+  "libmpi.pdb"
+  "libmpi.so"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang Fortran)
+  include(CMakeFiles/mpi.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,6 @@
+# Remove fortran modules provided by this target.
+FILE(REMOVE
+  "mpi.mod"
+  "MPI.mod"
+  "CMakeFiles/mpi.dir/mpi.mod.stamp"
+  )
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "../../../alloc_count_cxx"
+  "../../../alloc_count_cxx.pdb"
+  "CMakeFiles/alloc_count_cxx.dir/alloc_count_cxx.cpp.o"
+  "CMakeFiles/alloc_count_cxx.dir/alloc_count_cxx.cpp.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/alloc_count_cxx.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "../../../async_plugin_cxx"
+  "../../../async_plugin_cxx.pdb"
+  "CMakeFiles/async_plugin_cxx.dir/async_plugin_cxx.cpp.o"
+  "CMakeFiles/async_plugin_cxx.dir/async_plugin_cxx.cpp.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/async_plugin_cxx.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
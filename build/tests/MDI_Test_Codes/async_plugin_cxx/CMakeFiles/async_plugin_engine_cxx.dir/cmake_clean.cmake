@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "../../../libasync_plugin_engine_cxx.pdb"
+  "../../../libasync_plugin_engine_cxx.so"
+  "CMakeFiles/async_plugin_engine_cxx.dir/async_plugin_engine_cxx.cpp.o"
+  "CMakeFiles/async_plugin_engine_cxx.dir/async_plugin_engine_cxx.cpp.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/async_plugin_engine_cxx.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
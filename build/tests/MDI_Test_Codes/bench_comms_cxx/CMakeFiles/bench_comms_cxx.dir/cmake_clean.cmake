@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "../../../bench_comms_cxx"
+  "../../../bench_comms_cxx.pdb"
+  "CMakeFiles/bench_comms_cxx.dir/bench_comms_cxx.cpp.o"
+  "CMakeFiles/bench_comms_cxx.dir/bench_comms_cxx.cpp.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/bench_comms_cxx.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "../../../bench_filter_cxx"
+  "../../../bench_filter_cxx.pdb"
+  "CMakeFiles/bench_filter_cxx.dir/bench_filter_cxx.cpp.o"
+  "CMakeFiles/bench_filter_cxx.dir/bench_filter_cxx.cpp.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/bench_filter_cxx.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "../../../bench_plugin_cxx"
+  "../../../bench_plugin_cxx.pdb"
+  "CMakeFiles/bench_plugin_cxx.dir/bench_plugin_cxx.cpp.o"
+  "CMakeFiles/bench_plugin_cxx.dir/bench_plugin_cxx.cpp.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/bench_plugin_cxx.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,20 @@
+
+# Consider dependencies only in project.
+set(CMAKE_DEPENDS_IN_PROJECT_ONLY OFF)
+
+# The set of languages for which implicit dependencies are needed:
+set(CMAKE_DEPENDS_LANGUAGES
+  )
+
+# The set of dependency files which are needed:
+set(CMAKE_DEPENDS_DEPENDENCY_FILES
+  "/root/repo/tests/MDI_Test_Codes/bench_plugin_cxx/bench_plugin_engine_cxx.cpp" "tests/MDI_Test_Codes/bench_plugin_cxx/CMakeFiles/bench_plugin_engine_cxx.dir/bench_plugin_engine_cxx.cpp.o" "gcc" "tests/MDI_Test_Codes/bench_plugin_cxx/CMakeFiles/bench_plugin_engine_cxx.dir/bench_plugin_engine_cxx.cpp.o.d"
+  )
+
+# Targets to which this target links.
+set(CMAKE_TARGET_LINKED_INFO_FILES
+  "/root/repo/build/MDI_Library/CMakeFiles/mdi.dir/DependInfo.cmake"
+  )
+
+# Fortran module output directory.
+set(CMAKE_Fortran_TARGET_MODULE_DIR "")
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "../../../libbench_plugin_engine_cxx.pdb"
+  "../../../libbench_plugin_engine_cxx.so"
+  "CMakeFiles/bench_plugin_engine_cxx.dir/bench_plugin_engine_cxx.cpp.o"
+  "CMakeFiles/bench_plugin_engine_cxx.dir/bench_plugin_engine_cxx.cpp.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/bench_plugin_engine_cxx.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,78 @@
+# Install script for directory: /root/repo/tests/MDI_Test_Codes
+
+# Set the install prefix
+if(NOT DEFINED CMAKE_INSTALL_PREFIX)
+  set(CMAKE_INSTALL_PREFIX "/usr/local")
+endif()
+string(REGEX REPLACE "/$" "" CMAKE_INSTALL_PREFIX "${CMAKE_INSTALL_PREFIX}")
+
+# Set the install configuration name.
+if(NOT DEFINED CMAKE_INSTALL_CONFIG_NAME)
+  if(BUILD_TYPE)
+    string(REGEX REPLACE "^[^A-Za-z0-9_]+" ""
+           CMAKE_INSTALL_CONFIG_NAME "${BUILD_TYPE}")
+  else()
+    set(CMAKE_INSTALL_CONFIG_NAME "")
+  endif()
+  message(STATUS "Install configuration: \"${CMAKE_INSTALL_CONFIG_NAME}\"")
+endif()
+
+# Set the component getting installed.
+if(NOT CMAKE_INSTALL_COMPONENT)
+  if(COMPONENT)
+    message(STATUS "Install component: \"${COMPONENT}\"")
+    set(CMAKE_INSTALL_COMPONENT "${COMPONENT}")
+  else()
+    set(CMAKE_INSTALL_COMPONENT)
+  endif()
+endif()
+
+# Install shared libraries without execute permission?
+if(NOT DEFINED CMAKE_INSTALL_SO_NO_EXE)
+  set(CMAKE_INSTALL_SO_NO_EXE "1")
+endif()
+
+# Is this installation the result of a crosscompile?
+if(NOT DEFINED CMAKE_CROSSCOMPILING)
+  set(CMAKE_CROSSCOMPILING "FALSE")
+endif()
+
+# Set default install directory permissions.
+if(NOT DEFINED CMAKE_OBJDUMP)
+  set(CMAKE_OBJDUMP "/usr/bin/objdump")
+endif()
+
+if(NOT CMAKE_INSTALL_LOCAL_ONLY)
+  # Include the install script for each subdirectory.
+  include("/root/repo/build/tests/MDI_Test_Codes/driver_cxx/cmake_install.cmake")
+  include("/root/repo/build/tests/MDI_Test_Codes/driver_serial_cxx/cmake_install.cmake")
+  include("/root/repo/build/tests/MDI_Test_Codes/driver_loop_cxx/cmake_install.cmake")
+  include("/root/repo/build/tests/MDI_Test_Codes/engine_cxx/cmake_install.cmake")
+  include("/root/repo/build/tests/MDI_Test_Codes/driver_plug_cxx/cmake_install.cmake")
+  include("/root/repo/build/tests/MDI_Test_Codes/lib_cxx_cxx/cmake_install.cmake")
+  include("/root/repo/build/tests/MDI_Test_Codes/threads_cxx/cmake_install.cmake")
+  include("/root/repo/build/tests/MDI_Test_Codes/bench_filter_cxx/cmake_install.cmake")
+  include("/root/repo/build/tests/MDI_Test_Codes/serve_cxx/cmake_install.cmake")
+  include("/root/repo/build/tests/MDI_Test_Codes/regcache_cxx/cmake_install.cmake")
+  include("/root/repo/build/tests/MDI_Test_Codes/bench_plugin_cxx/cmake_install.cmake")
+  include("/root/repo/build/tests/MDI_Test_Codes/async_plugin_cxx/cmake_install.cmake")
+  include("/root/repo/build/tests/MDI_Test_Codes/lib_cxx_py/cmake_install.cmake")
+  include("/root/repo/build/tests/MDI_Test_Codes/engine_ipi_cxx/cmake_install.cmake")
+  include("/root/repo/build/tests/MDI_Test_Codes/bench_comms_cxx/cmake_install.cmake")
+  include("/root/repo/build/tests/MDI_Test_Codes/method_fifo_cxx/cmake_install.cmake")
+  include("/root/repo/build/tests/MDI_Test_Codes/alloc_count_cxx/cmake_install.cmake")
+  include("/root/repo/build/tests/MDI_Test_Codes/STUBS_MPI/cmake_install.cmake")
+  include("/root/repo/build/tests/MDI_Test_Codes/driver_f90/cmake_install.cmake")
+  include("/root/repo/build/tests/MDI_Test_Codes/driver_api_f90/cmake_install.cmake")
+  include("/root/repo/build/tests/MDI_Test_Codes/engine_f90/cmake_install.cmake")
+  include("/root/repo/build/tests/MDI_Test_Codes/lib_f90/cmake_install.cmake")
+  include("/root/repo/build/tests/MDI_Test_Codes/driver_py/cmake_install.cmake")
+  include("/root/repo/build/tests/MDI_Test_Codes/driver_api_py/cmake_install.cmake")
+  include("/root/repo/build/tests/MDI_Test_Codes/driver_ipicomp_py/cmake_install.cmake")
+  include("/root/repo/build/tests/MDI_Test_Codes/engine_py/cmake_install.cmake")
+  include("/root/repo/build/tests/MDI_Test_Codes/lib_py/cmake_install.cmake")
+  include("/root/repo/build/tests/MDI_Test_Codes/misc_py/cmake_install.cmake")
+  include("/root/repo/build/tests/MDI_Test_Codes/serve_py/cmake_install.cmake")
+
+endif()
+
@@ -0,0 +1,10 @@
+file(REMOVE_RECURSE
+  "../../../driver_api_f90"
+  "../../../driver_api_f90.pdb"
+  "CMakeFiles/driver_api_f90.dir/driver_api_f90.f90.o"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang Fortran)
+  include(CMakeFiles/driver_api_f90.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
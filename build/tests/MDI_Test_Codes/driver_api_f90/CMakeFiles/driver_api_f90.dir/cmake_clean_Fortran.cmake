@@ -0,0 +1,6 @@
+# Remove fortran modules provided by this target.
+FILE(REMOVE
+  "driver_api_callbacks.mod"
+  "DRIVER_API_CALLBACKS.mod"
+  "CMakeFiles/driver_api_f90.dir/driver_api_callbacks.mod.stamp"
+  )
@@ -0,0 +1,10 @@
+file(REMOVE_RECURSE
+  "../../../driver_f90"
+  "../../../driver_f90.pdb"
+  "CMakeFiles/driver_f90.dir/driver_f90.f90.o"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang Fortran)
+  include(CMakeFiles/driver_f90.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "../../../driver_loop_cxx"
+  "../../../driver_loop_cxx.pdb"
+  "CMakeFiles/driver_loop_cxx.dir/driver_loop_cxx.cpp.o"
+  "CMakeFiles/driver_loop_cxx.dir/driver_loop_cxx.cpp.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/driver_loop_cxx.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "../../../driver_serial_cxx"
+  "../../../driver_serial_cxx.pdb"
+  "CMakeFiles/driver_serial_cxx.dir/driver_serial_cxx.cpp.o"
+  "CMakeFiles/driver_serial_cxx.dir/driver_serial_cxx.cpp.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/driver_serial_cxx.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
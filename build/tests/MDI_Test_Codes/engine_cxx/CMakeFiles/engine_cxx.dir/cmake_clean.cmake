@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "../../../engine_cxx"
+  "../../../engine_cxx.pdb"
+  "CMakeFiles/engine_cxx.dir/engine_cxx.cpp.o"
+  "CMakeFiles/engine_cxx.dir/engine_cxx.cpp.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/engine_cxx.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "../../../libengine_cxx.pdb"
+  "../../../libengine_cxx.so"
+  "CMakeFiles/engine_cxx_lib.dir/engine_cxx.cpp.o"
+  "CMakeFiles/engine_cxx_lib.dir/engine_cxx.cpp.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/engine_cxx_lib.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
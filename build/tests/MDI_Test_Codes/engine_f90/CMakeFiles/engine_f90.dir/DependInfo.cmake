@@ -0,0 +1,35 @@
+
+# Consider dependencies only in project.
+set(CMAKE_DEPENDS_IN_PROJECT_ONLY OFF)
+
+# The set of languages for which implicit dependencies are needed:
+set(CMAKE_DEPENDS_LANGUAGES
+  "Fortran"
+  )
+# The set of files for implicit dependencies of each language:
+set(CMAKE_DEPENDS_CHECK_Fortran
+  "/root/repo/tests/MDI_Test_Codes/engine_f90/engine_f90.f90" "/root/repo/build/tests/MDI_Test_Codes/engine_f90/CMakeFiles/engine_f90.dir/engine_f90.f90.o"
+  "/root/repo/tests/MDI_Test_Codes/engine_f90/mdi_implementation.f90" "/root/repo/build/tests/MDI_Test_Codes/engine_f90/CMakeFiles/engine_f90.dir/mdi_implementation.f90.o"
+  )
+set(CMAKE_Fortran_COMPILER_ID "GNU")
+set(CMAKE_Fortran_SUBMODULE_SEP "@")
+set(CMAKE_Fortran_SUBMODULE_EXT ".smod")
+
+# The include file search paths:
+set(CMAKE_Fortran_TARGET_INCLUDE_PATH
+  "/usr/lib/x86_64-linux-gnu/fortran/gfortran-mod-15/openmpi"
+  "/usr/lib/x86_64-linux-gnu/openmpi/lib"
+  "tests/../MDI_Library"
+  )
+
+# The set of dependency files which are needed:
+set(CMAKE_DEPENDS_DEPENDENCY_FILES
+  )
+
+# Targets to which this target links.
+set(CMAKE_TARGET_LINKED_INFO_FILES
+  "/root/repo/build/MDI_Library/CMakeFiles/mdi.dir/DependInfo.cmake"
+  )
+
+# Fortran module output directory.
+set(CMAKE_Fortran_TARGET_MODULE_DIR "")
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "../../../engine_f90"
+  "../../../engine_f90.pdb"
+  "CMakeFiles/engine_f90.dir/engine_f90.f90.o"
+  "CMakeFiles/engine_f90.dir/mdi_implementation.f90.o"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang Fortran)
+  include(CMakeFiles/engine_f90.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
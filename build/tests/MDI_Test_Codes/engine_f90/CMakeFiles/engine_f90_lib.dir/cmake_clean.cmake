@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "../../../libengine_f90.pdb"
+  "../../../libengine_f90.so"
+  "CMakeFiles/engine_f90_lib.dir/engine_f90.f90.o"
+  "CMakeFiles/engine_f90_lib.dir/mdi_implementation.f90.o"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang Fortran)
+  include(CMakeFiles/engine_f90_lib.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,6 @@
+# Remove fortran modules provided by this target.
+FILE(REMOVE
+  "mdi_implementation.mod"
+  "MDI_IMPLEMENTATION.mod"
+  "CMakeFiles/engine_f90_lib.dir/mdi_implementation.mod.stamp"
+  )
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "../../../engine_ipi_cxx"
+  "../../../engine_ipi_cxx.pdb"
+  "CMakeFiles/engine_ipi_cxx.dir/engine_ipi_cxx.cpp.o"
+  "CMakeFiles/engine_ipi_cxx.dir/engine_ipi_cxx.cpp.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/engine_ipi_cxx.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "../../../driver_lib_cxx_cxx"
+  "../../../driver_lib_cxx_cxx.pdb"
+  "CMakeFiles/driver_lib_cxx_cxx.dir/driver_lib_cxx_cxx.cpp.o"
+  "CMakeFiles/driver_lib_cxx_cxx.dir/driver_lib_cxx_cxx.cpp.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/driver_lib_cxx_cxx.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
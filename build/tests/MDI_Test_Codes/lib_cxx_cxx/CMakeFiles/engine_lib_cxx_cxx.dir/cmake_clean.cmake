@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "../../../libengine_lib_cxx_cxx.pdb"
+  "../../../libengine_lib_cxx_cxx.so"
+  "CMakeFiles/engine_lib_cxx_cxx.dir/engine_lib_cxx_cxx.cpp.o"
+  "CMakeFiles/engine_lib_cxx_cxx.dir/engine_lib_cxx_cxx.cpp.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/engine_lib_cxx_cxx.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
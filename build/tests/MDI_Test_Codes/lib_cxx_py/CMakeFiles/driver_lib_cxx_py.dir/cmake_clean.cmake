@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "../../../driver_lib_cxx_py"
+  "../../../driver_lib_cxx_py.pdb"
+  "CMakeFiles/driver_lib_cxx_py.dir/driver_lib_cxx_py.cpp.o"
+  "CMakeFiles/driver_lib_cxx_py.dir/driver_lib_cxx_py.cpp.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/driver_lib_cxx_py.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,10 @@
+file(REMOVE_RECURSE
+  "../../../driver_lib_f90"
+  "../../../driver_lib_f90.pdb"
+  "CMakeFiles/driver_lib_f90.dir/driver_lib_f90.F90.o"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang Fortran)
+  include(CMakeFiles/driver_lib_f90.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
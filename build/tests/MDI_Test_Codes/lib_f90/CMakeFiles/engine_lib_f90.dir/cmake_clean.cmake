@@ -0,0 +1,10 @@
+file(REMOVE_RECURSE
+  "../../../libengine_lib_f90.pdb"
+  "../../../libengine_lib_f90.so"
+  "CMakeFiles/engine_lib_f90.dir/engine_lib_f90.F90.o"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang Fortran)
+  include(CMakeFiles/engine_lib_f90.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,6 @@
+# Remove fortran modules provided by this target.
+FILE(REMOVE
+  "engine_lib_f90.mod"
+  "ENGINE_LIB_F90.mod"
+  "CMakeFiles/engine_lib_f90.dir/engine_lib_f90.mod.stamp"
+  )
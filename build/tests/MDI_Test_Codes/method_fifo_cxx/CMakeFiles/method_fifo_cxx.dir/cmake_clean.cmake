@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "../../../method_fifo_cxx"
+  "../../../method_fifo_cxx.pdb"
+  "CMakeFiles/method_fifo_cxx.dir/method_fifo_cxx.cpp.o"
+  "CMakeFiles/method_fifo_cxx.dir/method_fifo_cxx.cpp.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/method_fifo_cxx.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "../../../regcache_cxx"
+  "../../../regcache_cxx.pdb"
+  "CMakeFiles/regcache_cxx.dir/regcache_cxx.cpp.o"
+  "CMakeFiles/regcache_cxx.dir/regcache_cxx.cpp.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/regcache_cxx.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "../../../serve_cxx"
+  "../../../serve_cxx.pdb"
+  "CMakeFiles/serve_cxx.dir/serve_cxx.cpp.o"
+  "CMakeFiles/serve_cxx.dir/serve_cxx.cpp.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/serve_cxx.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
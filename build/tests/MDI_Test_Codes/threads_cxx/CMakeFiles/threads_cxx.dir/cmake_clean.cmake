@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "../../../threads_cxx"
+  "../../../threads_cxx.pdb"
+  "CMakeFiles/threads_cxx.dir/threads_cxx.cpp.o"
+  "CMakeFiles/threads_cxx.dir/threads_cxx.cpp.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/threads_cxx.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,152 @@
+#include <iostream>
+#include <stdexcept>
+#include <vector>
+#include <string.h>
+#include <stdlib.h>
+#include "mdi.h"
+
+// Count the calls to malloc, calloc, and realloc made by the driver, by the MDI Library, and,
+// with the LINK method, by the engine, over a number of round trips with the engine
+// The allocation functions of the C library are wrapped, which requires glibc
+// With the TCP method, the allocations of the engine, which runs in another process, are not counted
+
+extern "C" {
+void* __libc_malloc(size_t size);
+void* __libc_calloc(size_t nmemb, size_t size);
+void* __libc_realloc(void* ptr, size_t size);
+
+static long long nallocs = 0;
+
+void* malloc(size_t size) noexcept {
+  nallocs++;
+  return __libc_malloc(size);
+}
+
+void* calloc(size_t nmemb, size_t size) noexcept {
+  nallocs++;
+  return __libc_calloc(nmemb, size);
+}
+
+void* realloc(void* ptr, size_t size) noexcept {
+  nallocs++;
+  return __libc_realloc(ptr, size);
+}
+}
+
+// Number of atoms of the in-process engine
+static const int engine_natoms = 10;
+
+// Coordinates received by the in-process engine
+static double engine_coords[3 * engine_natoms];
+
+// Respond to a command sent to the in-process engine, which is used by the LINK method
+int execute_command(const char* command, MDI_Comm comm, void* class_obj) {
+  if ( strcmp(command, "<NATOMS") == 0 ) {
+    MDI_Send(&engine_natoms, 1, MDI_INT, comm);
+  }
+  else if ( strcmp(command, ">COORDS") == 0 ) {
+    MDI_Recv(engine_coords, 3 * engine_natoms, MDI_DOUBLE, comm);
+  }
+  else if ( strcmp(command, "<COORDS") == 0 ) {
+    MDI_Send(engine_coords, 3 * engine_natoms, MDI_DOUBLE, comm);
+  }
+  else if ( strcmp(command, "EXIT") != 0 ) {
+    throw std::runtime_error("Unrecognized command.");
+  }
+  return 0;
+}
+
+int main(int argc, char **argv) {
+
+  // Read through all the command line options
+  int iarg = 1;
+  bool initialized_mdi = false;
+  bool link = false;
+  int nsteps = 100000;
+  int nwarmup = 100;
+  while ( iarg < argc ) {
+
+    if ( strcmp(argv[iarg],"-mdi") == 0 ) {
+
+      // Ensure that the argument to the -mdi option was provided
+      if ( argc-iarg < 2 ) {
+	throw std::runtime_error("The -mdi argument was not provided.");
+      }
+
+      // Initialize the MDI Library
+      int ret = MDI_Init(argv[iarg+1], NULL);
+      if ( ret != 0 ) {
+	throw std::runtime_error("The MDI library was not initialized correctly.");
+      }
+      link = ( strstr(argv[iarg+1], "LINK") != NULL );
+      initialized_mdi = true;
+      iarg += 2;
+
+    }
+    else if ( strcmp(argv[iarg],"-nsteps") == 0 ) {
+      if ( argc-iarg < 2 ) {
+	throw std::runtime_error("The -nsteps argument was not provided.");
+      }
+      nsteps = atoi(argv[iarg+1]);
+      iarg += 2;
+    }
+    else if ( strcmp(argv[iarg],"-nwarmup") == 0 ) {
+      if ( argc-iarg < 2 ) {
+	throw std::runtime_error("The -nwarmup argument was not provided.");
+      }
+      nwarmup = atoi(argv[iarg+1]);
+      iarg += 2;
+    }
+    else {
+      throw std::runtime_error("Unrecognized option.");
+    }
+
+  }
+  if ( not initialized_mdi ) {
+    throw std::runtime_error("The -mdi command line option was not provided.");
+  }
+
+  // With the LINK method, initialize an engine in this process
+  if ( link ) {
+    if ( MDI_Init("-role ENGINE -method LINK -name MM -driver_name driver", NULL) != 0 ) {
+      throw std::runtime_error("The engine was not initialized correctly.");
+    }
+    MDI_Set_execute_command_func(execute_command, NULL);
+  }
+
+  // Connect to the engine
+  MDI_Comm comm;
+  MDI_Accept_communicator(&comm);
+
+  // Get the number of atoms
+  int natoms;
+  MDI_Send_command("<NATOMS", comm);
+  MDI_Recv(&natoms, 1, MDI_INT, comm);
+  std::vector<double> coords(3 * natoms);
+  std::vector<double> received(3 * natoms);
+
+  // Exchange the coordinates with the engine
+  // The allocations are only counted after the warm-up steps, during which buffers may be allocated
+  long long warm_nallocs = 0;
+  for ( int istep = 0; istep < nwarmup + nsteps; istep++ ) {
+    if ( istep == nwarmup ) {
+      warm_nallocs = nallocs;
+    }
+    for ( int icoord = 0; icoord < 3 * natoms; icoord++ ) {
+      coords[icoord] = 0.1 * double(icoord) + 0.001 * double(istep % 64);
+    }
+    MDI_Send_command(">COORDS", comm);
+    MDI_Send(coords.data(), 3 * natoms, MDI_DOUBLE, comm);
+    MDI_Send_command("<COORDS", comm);
+    MDI_Recv(received.data(), 3 * natoms, MDI_DOUBLE, comm);
+  }
+  long long steady_nallocs = nallocs - warm_nallocs;
+
+  // Send the "EXIT" command to the engine
+  MDI_Send_command("EXIT", comm);
+
+  std::cout << " Round trips: " << nsteps << std::endl;
+  std::cout << " Allocations: " << steady_nallocs << std::endl;
+
+  return 0;
+}
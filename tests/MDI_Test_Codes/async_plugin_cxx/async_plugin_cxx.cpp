@@ -0,0 +1,181 @@
+#include <iostream>
+#include <iomanip>
+#include <mpi.h>
+#include <stdexcept>
+#include <chrono>
+#include <vector>
+#include <string.h>
+#include <stdlib.h>
+#include "mdi.h"
+
+// Drive several instances of a plugin, first one after another with MDI_Launch_plugin, and then
+// all at once with MDI_Launch_plugin_async, and check that both give the same forces
+// With MDI_Launch_plugin_async, each engine computes on its own worker thread, so the driver
+// sends the coordinates to every instance before it waits for any of the forces
+// With the -coroutines option, the engines instead run as coroutines on the driver's thread
+
+// Number of atoms of the engine
+static const int natoms = 10;
+
+// Coordinates sent to an instance of the plugin at a step
+void get_coords(int instance, int istep, double* coords) {
+  for ( int icoord = 0; icoord < 3 * natoms; icoord++ ) {
+    coords[icoord] = 0.1 * double(instance) + 0.01 * double(istep) + 0.001 * double(icoord);
+  }
+}
+
+// Settings and results of the instance that is driven by the plugin callback
+struct instance_state {
+  int instance;
+  int nsteps;
+  int nterms;
+  std::vector<double> forces;
+};
+
+int drive_instance(void* mpi_comm_ptr, MDI_Comm comm, void* class_object) {
+  instance_state* state = (instance_state*) class_object;
+  double coords[3 * natoms];
+  MDI_Send_command(">NTERMS", comm);
+  MDI_Send(&state->nterms, 1, MDI_INT, comm);
+  for ( int istep = 0; istep < state->nsteps; istep++ ) {
+    get_coords(state->instance, istep, coords);
+    MDI_Send_command(">COORDS", comm);
+    MDI_Send(coords, 3 * natoms, MDI_DOUBLE, comm);
+    MDI_Send_command("<FORCES", comm);
+    MDI_Recv(&state->forces[3 * natoms * istep], 3 * natoms, MDI_DOUBLE, comm);
+  }
+  MDI_Send_command("EXIT", comm);
+  return 0;
+}
+
+int main(int argc, char **argv) {
+
+  // Initialize the MPI environment
+  MPI_Init(&argc, &argv);
+  MPI_Comm self_comm = MPI_COMM_SELF;
+
+  // Read through all the command line options
+  int iarg = 1;
+  bool initialized_mdi = false;
+  int ninstances = 4;
+  int nsteps = 5;
+  int nterms = 20000;
+  bool coroutines = false;
+  while ( iarg < argc ) {
+
+    if ( strcmp(argv[iarg],"-mdi") == 0 ) {
+
+      // Ensure that the argument to the -mdi option was provided
+      if ( argc-iarg < 2 ) {
+	throw std::runtime_error("The -mdi argument was not provided.");
+      }
+
+      // Initialize the MDI Library
+      MPI_Comm world_comm = MPI_COMM_WORLD;
+      int ret = MDI_Init(argv[iarg+1], &world_comm);
+      if ( ret != 0 ) {
+	throw std::runtime_error("The MDI library was not initialized correctly.");
+      }
+      initialized_mdi = true;
+      iarg += 2;
+
+    }
+    else if ( strcmp(argv[iarg],"-ninstances") == 0 ) {
+      if ( argc-iarg < 2 ) {
+	throw std::runtime_error("The -ninstances argument was not provided.");
+      }
+      ninstances = atoi(argv[iarg+1]);
+      iarg += 2;
+    }
+    else if ( strcmp(argv[iarg],"-nsteps") == 0 ) {
+      if ( argc-iarg < 2 ) {
+	throw std::runtime_error("The -nsteps argument was not provided.");
+      }
+      nsteps = atoi(argv[iarg+1]);
+      iarg += 2;
+    }
+    else if ( strcmp(argv[iarg],"-nterms") == 0 ) {
+      if ( argc-iarg < 2 ) {
+	throw std::runtime_error("The -nterms argument was not provided.");
+      }
+      nterms = atoi(argv[iarg+1]);
+      iarg += 2;
+    }
+    else if ( strcmp(argv[iarg],"-coroutines") == 0 ) {
+      coroutines = true;
+      iarg += 1;
+    }
+    else {
+      throw std::runtime_error("Unrecognized option.");
+    }
+
+  }
+  if ( not initialized_mdi ) {
+    throw std::runtime_error("The -mdi command line option was not provided.");
+  }
+
+  // Drive each instance in turn
+  std::vector<instance_state> states(ninstances);
+  auto start = std::chrono::steady_clock::now();
+  for ( int instance = 0; instance < ninstances; instance++ ) {
+    states[instance].instance = instance;
+    states[instance].nsteps = nsteps;
+    states[instance].nterms = nterms;
+    states[instance].forces.resize(3 * natoms * nsteps);
+    if ( MDI_Launch_plugin("async_plugin_engine_cxx", "", &self_comm, drive_instance, &states[instance]) != 0 ) {
+      throw std::runtime_error("MDI_Launch_plugin failed.");
+    }
+  }
+  auto stop = std::chrono::steady_clock::now();
+  double sequential_ms = std::chrono::duration<double, std::milli>(stop - start).count();
+
+  // Drive every instance at once
+  if ( coroutines ) {
+    if ( MDI_Set_async_plugin_mode(MDI_ASYNC_COROUTINE, 0) != 0 ) {
+      throw std::runtime_error("MDI_Set_async_plugin_mode failed.");
+    }
+  }
+  start = std::chrono::steady_clock::now();
+  std::vector<MDI_Comm> comms(ninstances);
+  for ( int instance = 0; instance < ninstances; instance++ ) {
+    if ( MDI_Launch_plugin_async("async_plugin_engine_cxx", "", &self_comm, &comms[instance]) != 0 ) {
+      throw std::runtime_error("MDI_Launch_plugin_async failed.");
+    }
+    MDI_Send_command(">NTERMS", comms[instance]);
+    MDI_Send(&nterms, 1, MDI_INT, comms[instance]);
+  }
+  int mismatches = 0;
+  double coords[3 * natoms];
+  double forces[3 * natoms];
+  for ( int istep = 0; istep < nsteps; istep++ ) {
+    for ( int instance = 0; instance < ninstances; instance++ ) {
+      get_coords(instance, istep, coords);
+      MDI_Send_command(">COORDS", comms[instance]);
+      MDI_Send(coords, 3 * natoms, MDI_DOUBLE, comms[instance]);
+      MDI_Send_command("<FORCES", comms[instance]);
+    }
+    for ( int instance = 0; instance < ninstances; instance++ ) {
+      MDI_Recv(forces, 3 * natoms, MDI_DOUBLE, comms[instance]);
+      for ( int icoord = 0; icoord < 3 * natoms; icoord++ ) {
+        if ( forces[icoord] != states[instance].forces[3 * natoms * istep + icoord] ) {
+          mismatches++;
+        }
+      }
+    }
+  }
+  for ( int instance = 0; instance < ninstances; instance++ ) {
+    MDI_Send_command("EXIT", comms[instance]);
+  }
+  stop = std::chrono::steady_clock::now();
+  double async_ms = std::chrono::duration<double, std::milli>(stop - start).count();
+
+  std::cout << " Instances: " << ninstances << std::endl;
+  std::cout << " Steps: " << nsteps << std::endl;
+  std::cout << " Mismatches: " << mismatches << std::endl;
+  std::cout << std::fixed << std::setprecision(1)
+            << " Sequential: " << sequential_ms << " ms" << std::endl
+            << " Asynchronous: " << async_ms << " ms" << std::endl;
+
+  MPI_Finalize();
+  return 0;
+}
@@ -0,0 +1,61 @@
+#include <math.h>
+#include <mpi.h>
+#include "mdi.h"
+
+// A plugin whose engine computes forces from the coordinates it receives
+// Several instances of the plugin may run at once on different threads or coroutines, so each
+// instance keeps its state within its initialization function, rather than in global variables
+
+// Number of atoms of the engine
+static const int natoms = 10;
+
+// State of one instance of the engine, which is passed to each handler
+struct engine_state {
+  // number of terms in the force on each coordinate, which sets the cost of each evaluation
+  int nterms;
+  double coords[3 * natoms];
+  double forces[3 * natoms];
+};
+
+int recv_nterms(const char* command, MDI_Comm comm, void* ctx) {
+  engine_state* engine = (engine_state*) ctx;
+  return MDI_Recv(&engine->nterms, 1, MDI_INT, comm);
+}
+
+int recv_coords(const char* command, MDI_Comm comm, void* ctx) {
+  engine_state* engine = (engine_state*) ctx;
+  return MDI_Recv(engine->coords, 3 * natoms, MDI_DOUBLE, comm);
+}
+
+int send_forces(const char* command, MDI_Comm comm, void* ctx) {
+  engine_state* engine = (engine_state*) ctx;
+  for ( int icoord = 0; icoord < 3 * natoms; icoord++ ) {
+    double force = 0.0;
+    for ( int iterm = 1; iterm <= engine->nterms; iterm++ ) {
+      force += sin( engine->coords[icoord] * iterm ) / iterm;
+    }
+    engine->forces[icoord] = force;
+  }
+  return MDI_Send(engine->forces, 3 * natoms, MDI_DOUBLE, comm);
+}
+
+extern "C" DllExport int MDI_Plugin_init_async_plugin_engine_cxx() {
+  MPI_Comm mpi_world_comm = MPI_COMM_WORLD;
+  if ( MDI_Init("-role ENGINE -method LINK -name FORCES -driver_name driver", &mpi_world_comm) != 0 ) {
+    return 1;
+  }
+
+  engine_state engine;
+  engine.nterms = 20000;
+  MDI_Register_node("@DEFAULT");
+  if ( MDI_Register_command_handler("@DEFAULT", ">NTERMS", recv_nterms, &engine) != 0 ||
+       MDI_Register_command_handler("@DEFAULT", ">COORDS", recv_coords, &engine) != 0 ||
+       MDI_Register_command_handler("@DEFAULT", "<FORCES", send_forces, &engine) != 0 ) {
+    return 1;
+  }
+
+  // Respond to the commands of the driver until it sends EXIT
+  MDI_Comm comm;
+  MDI_Accept_communicator(&comm);
+  return MDI_Serve(comm);
+}
@@ -0,0 +1,97 @@
+#include <iostream>
+#include <iomanip>
+#include <stdexcept>
+#include <chrono>
+#include <vector>
+#include <string.h>
+#include <stdlib.h>
+#include "mdi.h"
+extern "C" {
+#include "mdi_test.h"
+}
+
+// Measure the time of each MDI_Send call as the number of communicators grows
+// The communicators use the TEST method, so only the overhead of the library is measured
+
+int main(int argc, char **argv) {
+
+  // Read through all the command line options
+  int iarg = 1;
+  bool initialized_mdi = false;
+  int max_comms = 10000;
+  int nsends = 100000;
+  while ( iarg < argc ) {
+
+    if ( strcmp(argv[iarg],"-mdi") == 0 ) {
+
+      // Ensure that the argument to the -mdi option was provided
+      if ( argc-iarg < 2 ) {
+	throw std::runtime_error("The -mdi argument was not provided.");
+      }
+
+      // Initialize the MDI Library
+      int ret = MDI_Init(argv[iarg+1], NULL);
+      if ( ret != 0 ) {
+	throw std::runtime_error("The MDI library was not initialized correctly.");
+      }
+      initialized_mdi = true;
+      iarg += 2;
+
+    }
+    else if ( strcmp(argv[iarg],"-ncomms") == 0 ) {
+      if ( argc-iarg < 2 ) {
+	throw std::runtime_error("The -ncomms argument was not provided.");
+      }
+      max_comms = atoi(argv[iarg+1]);
+      iarg += 2;
+    }
+    else if ( strcmp(argv[iarg],"-nsends") == 0 ) {
+      if ( argc-iarg < 2 ) {
+	throw std::runtime_error("The -nsends argument was not provided.");
+      }
+      nsends = atoi(argv[iarg+1]);
+      iarg += 2;
+    }
+    else {
+      throw std::runtime_error("Unrecognized option.");
+    }
+
+  }
+  if ( not initialized_mdi ) {
+    throw std::runtime_error("The -mdi command line option was not provided.");
+  }
+
+  // Accept the communicator created by MDI_Init
+  MDI_Comm comm;
+  MDI_Accept_communicator(&comm);
+  if ( comm == MDI_COMM_NULL ) {
+    throw std::runtime_error("Must run bench_comms_cxx with the TEST method");
+  }
+  int ncomms = 1;
+
+  std::vector<double> coords(3, 0.0);
+  std::cout << " Communicators    ns/send" << std::endl;
+  for ( int target = 1; target <= max_comms; target *= 10 ) {
+
+    // Create communicators until there are as many as the target
+    // The most recent communicator is the one that is used, which is the worst case for a search
+    while ( ncomms < target ) {
+      test_initialize();
+      MDI_Accept_communicator(&comm);
+      ncomms++;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    for ( int isend = 0; isend < nsends; isend++ ) {
+      if ( MDI_Send(&coords[0], 3, MDI_DOUBLE, comm) != 0 ) {
+	throw std::runtime_error("MDI_Send failed.");
+      }
+    }
+    auto stop = std::chrono::steady_clock::now();
+    double ns = std::chrono::duration<double, std::nano>(stop - start).count() / nsends;
+
+    std::cout << std::setw(14) << ncomms << std::setw(11) << std::fixed << std::setprecision(1) << ns << std::endl;
+  }
+
+  return 0;
+}
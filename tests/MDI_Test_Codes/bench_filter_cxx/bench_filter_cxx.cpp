@@ -0,0 +1,129 @@
+#include <iostream>
+#include <iomanip>
+#include <stdexcept>
+#include <chrono>
+#include <vector>
+#include <string.h>
+#include <stdlib.h>
+#include "mdi.h"
+
+// Measure the time of each MDI_Send call as filter stages are attached to the communicator
+// The communicator uses the TEST method, so only the overhead of the library is measured
+// The stages pass each message through without copying it, so that only the cost of the
+// chain itself is measured
+
+// Number of calls to the filter stage
+static long long nfiltered = 0;
+
+// A filter stage that passes each message through unchanged
+int pass_send(const void** buf, int64_t count, MDI_Datatype datatype, MDI_Comm comm, void* state) {
+  nfiltered++;
+  return 0;
+}
+
+// Time a number of sends, returning the best time per send over several trials, in nanoseconds
+double time_sends(MDI_Comm comm, int nsends, int ntrials) {
+  std::vector<double> coords(3, 0.0);
+  double best = 0.0;
+  for ( int itrial = 0; itrial < ntrials; itrial++ ) {
+    auto start = std::chrono::steady_clock::now();
+    for ( int isend = 0; isend < nsends; isend++ ) {
+      if ( MDI_Send(&coords[0], 3, MDI_DOUBLE, comm) != 0 ) {
+	throw std::runtime_error("MDI_Send failed.");
+      }
+    }
+    auto stop = std::chrono::steady_clock::now();
+    double ns = std::chrono::duration<double, std::nano>(stop - start).count() / nsends;
+    if ( itrial == 0 || ns < best ) {
+      best = ns;
+    }
+  }
+  return best;
+}
+
+int main(int argc, char **argv) {
+
+  // Read through all the command line options
+  int iarg = 1;
+  bool initialized_mdi = false;
+  int nsends = 1000000;
+  int ntrials = 5;
+  while ( iarg < argc ) {
+
+    if ( strcmp(argv[iarg],"-mdi") == 0 ) {
+
+      // Ensure that the argument to the -mdi option was provided
+      if ( argc-iarg < 2 ) {
+	throw std::runtime_error("The -mdi argument was not provided.");
+      }
+
+      // Initialize the MDI Library
+      int ret = MDI_Init(argv[iarg+1], NULL);
+      if ( ret != 0 ) {
+	throw std::runtime_error("The MDI library was not initialized correctly.");
+      }
+      initialized_mdi = true;
+      iarg += 2;
+
+    }
+    else if ( strcmp(argv[iarg],"-nsends") == 0 ) {
+      if ( argc-iarg < 2 ) {
+	throw std::runtime_error("The -nsends argument was not provided.");
+      }
+      nsends = atoi(argv[iarg+1]);
+      iarg += 2;
+    }
+    else if ( strcmp(argv[iarg],"-ntrials") == 0 ) {
+      if ( argc-iarg < 2 ) {
+	throw std::runtime_error("The -ntrials argument was not provided.");
+      }
+      ntrials = atoi(argv[iarg+1]);
+      iarg += 2;
+    }
+    else {
+      throw std::runtime_error("Unrecognized option.");
+    }
+
+  }
+  if ( not initialized_mdi ) {
+    throw std::runtime_error("The -mdi command line option was not provided.");
+  }
+
+  // Accept the communicator created by MDI_Init
+  MDI_Comm comm;
+  MDI_Accept_communicator(&comm);
+  if ( comm == MDI_COMM_NULL ) {
+    throw std::runtime_error("Must run bench_filter_cxx with the TEST method");
+  }
+
+  if ( MDI_Register_filter("pass", pass_send, NULL, NULL) != 0 ) {
+    throw std::runtime_error("The filter was not registered.");
+  }
+
+  // Without any stages, and with a chain that was emptied after stages were attached
+  std::cout << " Stages    ns/send" << std::endl;
+  std::cout << "   none" << std::setw(11) << std::fixed << std::setprecision(1)
+            << time_sends(comm, nsends, ntrials) << std::endl;
+  MDI_Filter_push(comm, "pass");
+  MDI_Filter_pop(comm);
+  std::cout << "  empty" << std::setw(11) << std::fixed << std::setprecision(1)
+            << time_sends(comm, nsends, ntrials) << std::endl;
+
+  // With a growing number of stages
+  int nstages = 0;
+  for ( int target = 1; target <= 4; target *= 2 ) {
+    while ( nstages < target ) {
+      MDI_Filter_push(comm, "pass");
+      nstages++;
+    }
+    std::cout << std::setw(7) << nstages << std::setw(11) << std::fixed << std::setprecision(1)
+              << time_sends(comm, nsends, ntrials) << std::endl;
+  }
+
+  // Every send should have passed through every stage
+  if ( nfiltered != (long long)nsends * ntrials * ( 1 + 2 + 4 ) ) {
+    throw std::runtime_error("The filter stages were not called for every send.");
+  }
+
+  return 0;
+}
@@ -0,0 +1,165 @@
+#include <iostream>
+#include <iomanip>
+#include <mpi.h>
+#include <stdexcept>
+#include <chrono>
+#include <string.h>
+#include <stdlib.h>
+#include "mdi.h"
+
+// Measure the time of each MDI_Launch_plugin call in each plugin cache mode
+// Each launch only queries two counters of the engine, so the time is dominated by the launch itself
+// With the -fail_init option, it instead checks that the driver can launch the plugin again after a failed init
+
+// Counters reported by the engine during the most recent launch
+struct launch_result {
+  int ninit;
+  int nhandled;
+};
+
+int query_counters(void* mpi_comm_ptr, MDI_Comm comm, void* class_object) {
+  launch_result* result = (launch_result*) class_object;
+  MDI_Send_command("<NINIT", comm);
+  MDI_Recv(&result->ninit, 1, MDI_INT, comm);
+  MDI_Send_command("<NHANDLED", comm);
+  MDI_Recv(&result->nhandled, 1, MDI_INT, comm);
+  MDI_Send_command("EXIT", comm);
+  return 0;
+}
+
+int request_failed_init(void* mpi_comm_ptr, MDI_Comm comm, void* class_object) {
+  MDI_Send_command("FAILINIT", comm);
+  MDI_Send_command("EXIT", comm);
+  return 0;
+}
+
+// Make one launch of a cached plugin fail during its initialization, and check that the next launch succeeds
+void check_failed_init(MPI_Comm world_comm) {
+  if ( MDI_Set_plugin_cache(MDI_PLUGIN_RESIDENT) != 0 ) {
+    throw std::runtime_error("MDI_Set_plugin_cache failed.");
+  }
+
+  launch_result result;
+  if ( MDI_Launch_plugin("bench_plugin_engine_cxx", "", &world_comm, request_failed_init, &result) != 0 ) {
+    throw std::runtime_error("MDI_Launch_plugin failed.");
+  }
+  if ( MDI_Launch_plugin("bench_plugin_engine_cxx", "", &world_comm, query_counters, &result) == 0 ) {
+    throw std::runtime_error("MDI_Launch_plugin did not report the failed initialization.");
+  }
+  result.ninit = 0;
+  if ( MDI_Launch_plugin("bench_plugin_engine_cxx", "", &world_comm, query_counters, &result) != 0 ) {
+    throw std::runtime_error("MDI_Launch_plugin failed after a failed initialization.");
+  }
+  if ( MDI_Unload_plugin("bench_plugin_engine_cxx") != 0 ) {
+    throw std::runtime_error("MDI_Unload_plugin failed.");
+  }
+  std::cout << " Launches after a failed init: " << result.ninit << std::endl;
+}
+
+// Launch the plugin a number of times, check the counters of each launch, and print the time per launch
+void time_launches(const char* label, int mode, int nlaunches, MPI_Comm world_comm) {
+  if ( MDI_Set_plugin_cache(mode) != 0 ) {
+    throw std::runtime_error("MDI_Set_plugin_cache failed.");
+  }
+
+  launch_result result;
+  int first_ninit = 0;
+  auto start = std::chrono::steady_clock::now();
+  for ( int ilaunch = 0; ilaunch < nlaunches; ilaunch++ ) {
+    if ( MDI_Launch_plugin("bench_plugin_engine_cxx", "", &world_comm, query_counters, &result) != 0 ) {
+      throw std::runtime_error("MDI_Launch_plugin failed.");
+    }
+    if ( ilaunch == 0 ) {
+      first_ninit = result.ninit;
+    }
+
+    // a resident plugin is initialized by each launch, while a kept-alive engine handles every launch
+    if ( mode == MDI_PLUGIN_RESIDENT && result.ninit != first_ninit + ilaunch ) {
+      throw std::runtime_error("A resident plugin was not initialized by each launch.");
+    }
+    if ( mode == MDI_PLUGIN_KEEPALIVE && ( result.ninit != first_ninit || result.nhandled != 2 * ( ilaunch + 1 ) ) ) {
+      throw std::runtime_error("A kept-alive engine did not keep its state between launches.");
+    }
+    if ( mode != MDI_PLUGIN_KEEPALIVE && result.nhandled != 2 ) {
+      throw std::runtime_error("A new engine was not created by each launch.");
+    }
+  }
+  auto stop = std::chrono::steady_clock::now();
+  double us = std::chrono::duration<double, std::micro>(stop - start).count() / nlaunches;
+
+  if ( mode != MDI_PLUGIN_UNLOAD ) {
+    if ( MDI_Unload_plugin("bench_plugin_engine_cxx") != 0 ) {
+      throw std::runtime_error("MDI_Unload_plugin failed.");
+    }
+  }
+
+  std::cout << std::setw(10) << label << std::setw(13) << std::fixed << std::setprecision(2)
+            << us << std::endl;
+}
+
+int main(int argc, char **argv) {
+
+  // Initialize the MPI environment
+  MPI_Comm world_comm;
+  MPI_Init(&argc, &argv);
+
+  // Read through all the command line options
+  int iarg = 1;
+  bool initialized_mdi = false;
+  int nlaunches = 1000;
+  bool fail_init = false;
+  while ( iarg < argc ) {
+
+    if ( strcmp(argv[iarg],"-mdi") == 0 ) {
+
+      // Ensure that the argument to the -mdi option was provided
+      if ( argc-iarg < 2 ) {
+	throw std::runtime_error("The -mdi argument was not provided.");
+      }
+
+      // Initialize the MDI Library
+      world_comm = MPI_COMM_WORLD;
+      int ret = MDI_Init(argv[iarg+1], &world_comm);
+      if ( ret != 0 ) {
+	throw std::runtime_error("The MDI library was not initialized correctly.");
+      }
+      initialized_mdi = true;
+      iarg += 2;
+
+    }
+    else if ( strcmp(argv[iarg],"-nlaunches") == 0 ) {
+      if ( argc-iarg < 2 ) {
+	throw std::runtime_error("The -nlaunches argument was not provided.");
+      }
+      nlaunches = atoi(argv[iarg+1]);
+      iarg += 2;
+    }
+    else if ( strcmp(argv[iarg],"-fail_init") == 0 ) {
+      fail_init = true;
+      iarg += 1;
+    }
+    else {
+      throw std::runtime_error("Unrecognized option.");
+    }
+
+  }
+  if ( not initialized_mdi ) {
+    throw std::runtime_error("The -mdi command line option was not provided.");
+  }
+
+  if ( fail_init ) {
+    check_failed_init(world_comm);
+    MPI_Barrier(world_comm);
+    MPI_Finalize();
+    return 0;
+  }
+
+  std::cout << "      Mode    us/launch" << std::endl;
+  time_launches("unload", MDI_PLUGIN_UNLOAD, nlaunches, world_comm);
+  time_launches("resident", MDI_PLUGIN_RESIDENT, nlaunches, world_comm);
+  time_launches("keepalive", MDI_PLUGIN_KEEPALIVE, nlaunches, world_comm);
+
+  MPI_Barrier(world_comm);
+  MPI_Finalize();
+  return 0;
+}
@@ -0,0 +1,52 @@
+#include <mpi.h>
+#include "mdi.h"
+
+// A plugin whose engine counts how many times the plugin has been initialized, and how many
+// commands the engine has handled since it was created
+// The counters are static, so they persist for as long as the plugin remains loaded
+// After the FAILINIT command, the next initialization of the plugin fails
+
+static int ninit = 0;
+static int nhandled = 0;
+static int fail_init = 0;
+
+int send_ninit(const char* command, MDI_Comm comm, void* ctx) {
+  nhandled++;
+  return MDI_Send(&ninit, 1, MDI_INT, comm);
+}
+
+int send_nhandled(const char* command, MDI_Comm comm, void* ctx) {
+  nhandled++;
+  return MDI_Send(&nhandled, 1, MDI_INT, comm);
+}
+
+int set_fail_init(const char* command, MDI_Comm comm, void* ctx) {
+  nhandled++;
+  fail_init = 1;
+  return 0;
+}
+
+extern "C" DllExport int MDI_Plugin_init_bench_plugin_engine_cxx() {
+  ninit++;
+  nhandled = 0;
+
+  MPI_Comm mpi_world_comm = MPI_COMM_WORLD;
+  if ( MDI_Init("-role ENGINE -method LINK -name COUNTER -driver_name driver", &mpi_world_comm) != 0 ) {
+    return 1;
+  }
+  if ( fail_init ) {
+    fail_init = 0;
+    return 1;
+  }
+  MDI_Register_node("@DEFAULT");
+  if ( MDI_Register_command_handler("@DEFAULT", "<NINIT", send_ninit, NULL) != 0 ||
+       MDI_Register_command_handler("@DEFAULT", "<NHANDLED", send_nhandled, NULL) != 0 ||
+       MDI_Register_command_handler("@DEFAULT", "FAILINIT", set_fail_init, NULL) != 0 ) {
+    return 1;
+  }
+
+  // Respond to the commands of the driver until it sends EXIT
+  MDI_Comm comm;
+  MDI_Accept_communicator(&comm);
+  return MDI_Serve(comm);
+}
@@ -0,0 +1,287 @@
+MODULE DRIVER_API_CALLBACKS
+
+USE ISO_C_binding
+
+IMPLICIT NONE
+
+   ! grid that is received through MDI_Recv_stream
+   REAL(KIND=C_DOUBLE), ALLOCATABLE, TARGET :: received_grid(:)
+
+CONTAINS
+
+   ! Produce a chunk of the grid, in which element i has the value 0.5 * i
+   FUNCTION grid_producer(buf, offset, count, ctx) BIND(C)
+      TYPE(C_PTR), VALUE                  :: buf, ctx
+      INTEGER(KIND=C_INT64_T), VALUE      :: offset, count
+      INTEGER(KIND=C_INT)                 :: grid_producer
+
+      REAL(KIND=C_DOUBLE), POINTER        :: chunk(:)
+      INTEGER(KIND=C_INT64_T)             :: i
+
+      CALL c_f_pointer(buf, chunk, [count])
+      DO i = 1, count
+         chunk(i) = 0.5d0 * DBLE(offset + i - 1)
+      END DO
+      grid_producer = 0
+   END FUNCTION grid_producer
+
+   ! Store a chunk of the grid in received_grid
+   FUNCTION grid_consumer(buf, offset, count, ctx) BIND(C)
+      TYPE(C_PTR), VALUE                  :: buf, ctx
+      INTEGER(KIND=C_INT64_T), VALUE      :: offset, count
+      INTEGER(KIND=C_INT)                 :: grid_consumer
+
+      REAL(KIND=C_DOUBLE), POINTER        :: chunk(:)
+
+      CALL c_f_pointer(buf, chunk, [count])
+      received_grid(offset + 1:offset + count) = chunk
+      grid_consumer = 0
+   END FUNCTION grid_consumer
+
+   ! Write whether a check passed
+   SUBROUTINE report(name, passed)
+      CHARACTER(LEN=*), INTENT(IN)        :: name
+      LOGICAL, INTENT(IN)                 :: passed
+
+      IF ( passed ) THEN
+         WRITE(6,'(A)')' '//name//': OK'
+      ELSE
+         WRITE(6,'(A)')' '//name//': FAILED'
+      END IF
+   END SUBROUTINE report
+
+END MODULE DRIVER_API_CALLBACKS
+
+
+PROGRAM DRIVER_API_F90
+
+USE mpi
+USE ISO_C_binding
+USE mdi,              ONLY : MDI_CHAR, MDI_INT, MDI_DOUBLE, MDI_FLOAT, MDI_INT64, MDI_INT8, &
+     MDI_COMPLEX_DOUBLE, MDI_NAME_LENGTH, MDI_COMMAND_LENGTH, MDI_DRIVER, MDI_CONTEXT_DEFAULT, &
+     MDI_Init, MDI_MPI_get_world_comm, MDI_Get_role, MDI_Accept_communicator, &
+     MDI_Send_command, MDI_Send, MDI_Recv, MDI_Send_c, MDI_Recv_c, &
+     MDI_Send_strided, MDI_Recv_strided, MDI_Sendv, MDI_Recvv, &
+     MDI_Send_init, MDI_Recv_init, MDI_Start, MDI_Request_free, &
+     MDI_Send_stream, MDI_Recv_stream, MDI_Send_units, MDI_Recv_units, MDI_Conversion_factor, &
+     MDI_Context_create, MDI_Context_free, MDI_Set_context, MDI_Get_context
+USE DRIVER_API_CALLBACKS
+
+IMPLICIT NONE
+
+   INTEGER, PARAMETER :: natoms = 10, ntypes = 4
+   INTEGER(KIND=C_INT64_T), PARAMETER :: ncoords = 3 * natoms
+   INTEGER(KIND=C_INT64_T), PARAMETER :: grid_size = 1000, chunk_size = 128
+
+   INTEGER :: iarg, ierr, role, i, istep, size
+   INTEGER :: world_comm
+   INTEGER :: comm, context, default_context, current_context
+   INTEGER :: send_request, recv_request
+   CHARACTER(len=1024) :: arg, mdi_options, test
+   CHARACTER(len=:), ALLOCATABLE :: message
+   LOGICAL :: passed
+   DOUBLE PRECISION :: factor
+
+   REAL(KIND=8), TARGET :: coords(ncoords), received(ncoords), coords_bohr(ncoords)
+   REAL(KIND=8), TARGET :: padded(4, natoms), received_padded(4, natoms)
+   REAL(KIND=8), TARGET :: send_coords(ncoords), recv_coords(ncoords)
+   REAL(KIND=8) :: expected_grid(grid_size)
+   INTEGER(KIND=C_INT64_T) :: shape(2), strides(2)
+
+   REAL(KIND=C_FLOAT), TARGET :: floats(ntypes), received_floats(ntypes)
+   INTEGER(KIND=C_INT64_T), TARGET :: int64s(ntypes), received_int64s(ntypes)
+   INTEGER(KIND=C_INT8_T), TARGET :: int8s(ntypes), received_int8s(ntypes)
+   COMPLEX(KIND=C_DOUBLE_COMPLEX), TARGET :: complexes(ntypes), received_complexes(ntypes)
+   TYPE(C_PTR) :: bufs(ntypes)
+   INTEGER(KIND=C_INT64_T) :: counts(ntypes)
+   INTEGER(KIND=C_INT) :: datatypes(ntypes)
+   TYPE(C_FUNPTR) :: producer, consumer
+
+   ALLOCATE( character(MDI_NAME_LENGTH) :: message )
+
+   ! Initialize the MPI environment
+   call MPI_Init(ierr)
+
+   ! Read through all the command line options
+   ! The -test option selects the functions that are exercised
+   test = "send_c"
+   iarg = 0
+   DO
+      CALL get_command_argument(iarg, arg)
+      IF (LEN_TRIM(arg) == 0) EXIT
+
+      IF (TRIM(arg) .eq. "-mdi") THEN
+         CALL get_command_argument(iarg + 1, mdi_options)
+      ELSE IF (TRIM(arg) .eq. "-test") THEN
+         CALL get_command_argument(iarg + 1, test)
+      END IF
+
+      iarg = iarg + 1
+   END DO
+
+   ! Run every call within a context of its own
+   IF (TRIM(test) .eq. "context") THEN
+      call MDI_Get_context(default_context, ierr)
+      call MDI_Context_create(context, ierr)
+      call MDI_Set_context(context, ierr)
+      call MDI_Get_context(current_context, ierr)
+      call report("Context", default_context .eq. MDI_CONTEXT_DEFAULT .and. current_context .eq. context)
+   END IF
+
+   ! Initialize the MDI Library
+   world_comm = MPI_COMM_WORLD
+   call MDI_Init( mdi_options, world_comm, ierr)
+   call MDI_MPI_get_world_comm( world_comm, ierr )
+
+   ! Confirm that the code is being run as a driver
+   call MDI_Get_role(role, ierr)
+   IF ( role .ne. MDI_DRIVER ) THEN
+      WRITE(6,*)'ERROR: Must run driver_api_f90 as a DRIVER',role,MDI_DRIVER
+   END IF
+
+   ! Connect to the engine
+   call MDI_Accept_communicator(comm, ierr)
+
+   call MDI_Send_command("<NAME", comm, ierr)
+   call MDI_Recv(message, MDI_NAME_LENGTH, MDI_CHAR, comm, ierr)
+   WRITE(6,'(A)')' Engine name: '//TRIM(message)
+
+   DO i = 1, INT(ncoords)
+      coords(i) = 0.25d0 * DBLE(i - 1)
+   END DO
+
+   DO i = 1, ntypes
+      floats(i) = 0.5 + REAL(i - 1)
+      int64s(i) = 2_C_INT64_T**40 + (i - 1)
+      int8s(i) = INT(1 - i, C_INT8_T)
+      complexes(i) = CMPLX(DBLE(i - 1), -0.5d0 * DBLE(i - 1), C_DOUBLE_COMPLEX)
+   END DO
+
+   SELECT CASE (TRIM(test))
+
+   CASE ("send_c", "context")
+      ! 64-bit element counts
+      call MDI_Send_command(">COORDS", comm, ierr)
+      call MDI_Send_c(coords, ncoords, MDI_DOUBLE, comm, ierr)
+      call MDI_Send_command("<COORDS", comm, ierr)
+      call MDI_Recv_c(received, ncoords, MDI_DOUBLE, comm, ierr)
+      call report("Send_c", ALL(received .eq. coords))
+
+   CASE ("types")
+      ! Extended datatypes
+      call MDI_Send_command(">TYPES", comm, ierr)
+      call MDI_Send(ntypes, 1, MDI_INT, comm, ierr)
+      call MDI_Send(floats, ntypes, MDI_FLOAT, comm, ierr)
+      call MDI_Send(int64s, ntypes, MDI_INT64, comm, ierr)
+      call MDI_Send(int8s, ntypes, MDI_INT8, comm, ierr)
+      call MDI_Send(complexes, ntypes, MDI_COMPLEX_DOUBLE, comm, ierr)
+      call MDI_Send_command("<TYPES", comm, ierr)
+      call MDI_Recv(size, 1, MDI_INT, comm, ierr)
+      call MDI_Recv(received_floats, ntypes, MDI_FLOAT, comm, ierr)
+      call MDI_Recv(received_int64s, ntypes, MDI_INT64, comm, ierr)
+      call MDI_Recv(received_int8s, ntypes, MDI_INT8, comm, ierr)
+      call MDI_Recv(received_complexes, ntypes, MDI_COMPLEX_DOUBLE, comm, ierr)
+      passed = ( size .eq. ntypes ) .and. ALL(received_floats .eq. floats) .and. &
+           ALL(received_int64s .eq. int64s) .and. ALL(received_int8s .eq. int8s) .and. &
+           ALL(received_complexes .eq. complexes)
+      call report("Types", passed)
+
+   CASE ("strided")
+      ! Strided arrays, which are the first three rows of an array with four rows
+      padded = 0.0d0
+      padded(1:3, :) = RESHAPE(coords, [3, natoms])
+      received_padded = -1.0d0
+      shape = [ INT(natoms, C_INT64_T), 3_C_INT64_T ]
+      strides = [ 4_C_INT64_T * 8_C_INT64_T, 8_C_INT64_T ]
+      call MDI_Send_command(">COORDS", comm, ierr)
+      call MDI_Send_strided(padded(1, 1), 2, shape, strides, MDI_DOUBLE, comm, ierr)
+      call MDI_Send_command("<COORDS", comm, ierr)
+      call MDI_Recv_strided(received_padded(1, 1), 2, shape, strides, MDI_DOUBLE, comm, ierr)
+      call report("Strided", ALL(received_padded(1:3, :) .eq. padded(1:3, :)) .and. &
+           ALL(received_padded(4, :) .eq. -1.0d0))
+
+   CASE ("sendv")
+      ! Vectored messages
+      floats = 2.0 * floats
+      int64s = 2_C_INT64_T * int64s
+      int8s = 2_C_INT8_T * int8s
+      complexes = 2.0d0 * complexes
+      counts = ntypes
+      datatypes = [ MDI_FLOAT, MDI_INT64, MDI_INT8, MDI_COMPLEX_DOUBLE ]
+      bufs = [ c_loc(floats), c_loc(int64s), c_loc(int8s), c_loc(complexes) ]
+      call MDI_Send_command(">TYPESV", comm, ierr)
+      call MDI_Send(ntypes, 1, MDI_INT, comm, ierr)
+      call MDI_Sendv(ntypes, bufs, counts, datatypes, comm, ierr)
+      call MDI_Send_command("<TYPESV", comm, ierr)
+      bufs = [ c_loc(received_floats), c_loc(received_int64s), c_loc(received_int8s), c_loc(received_complexes) ]
+      call MDI_Recvv(ntypes, bufs, counts, datatypes, comm, ierr)
+      passed = ALL(received_floats .eq. floats) .and. ALL(received_int64s .eq. int64s) .and. &
+           ALL(received_int8s .eq. int8s) .and. ALL(received_complexes .eq. complexes)
+      call report("Sendv", passed)
+
+   CASE ("send_init")
+      ! Persistent requests, which are started once per step
+      call MDI_Send_init(send_coords, ncoords, MDI_DOUBLE, comm, send_request, ierr)
+      call MDI_Recv_init(recv_coords, ncoords, MDI_DOUBLE, comm, recv_request, ierr)
+      passed = .true.
+      DO istep = 0, 2
+         send_coords = coords + DBLE(istep)
+         call MDI_Send_command(">COORDS", comm, ierr)
+         call MDI_Start(send_request, ierr)
+         call MDI_Send_command("<COORDS", comm, ierr)
+         call MDI_Start(recv_request, ierr)
+         passed = passed .and. ALL(recv_coords .eq. send_coords)
+      END DO
+      call MDI_Request_free(send_request, ierr)
+      call MDI_Request_free(recv_request, ierr)
+      call report("Send_init", passed)
+
+   CASE ("stream")
+      ! Streams, which are produced and consumed in chunks
+      ALLOCATE( received_grid(grid_size) )
+      received_grid = 0.0d0
+      DO i = 1, INT(grid_size)
+         expected_grid(i) = 0.5d0 * DBLE(i - 1)
+      END DO
+      producer = c_funloc(grid_producer)
+      consumer = c_funloc(grid_consumer)
+      call MDI_Send_command(">GRID", comm, ierr)
+      call MDI_Send(INT(grid_size), 1, MDI_INT, comm, ierr)
+      call MDI_Send_stream(grid_size, MDI_DOUBLE, chunk_size, producer, c_null_ptr, comm, ierr)
+      call MDI_Send_command("<GRID", comm, ierr)
+      call MDI_Recv(size, 1, MDI_INT, comm, ierr)
+      call MDI_Recv_stream(INT(size, C_INT64_T), MDI_DOUBLE, chunk_size, consumer, c_null_ptr, &
+           comm, ierr)
+      call report("Stream", size .eq. grid_size .and. ALL(received_grid .eq. expected_grid))
+      DEALLOCATE( received_grid )
+
+   CASE ("units")
+      ! Unit-aware transfers, which the engine stores in atomic units
+      call MDI_Conversion_factor("angstrom", "atomic_unit_of_length", factor, ierr)
+      call MDI_Send_command(">COORDS", comm, ierr)
+      call MDI_Send_units(coords, ncoords, MDI_DOUBLE, "angstrom", comm, ierr)
+      call MDI_Send_command("<COORDS", comm, ierr)
+      call MDI_Recv(coords_bohr, INT(ncoords), MDI_DOUBLE, comm, ierr)
+      call MDI_Send_command("<COORDS", comm, ierr)
+      call MDI_Recv_units(received, ncoords, MDI_DOUBLE, "angstrom", comm, ierr)
+      call report("Units", ALL(ABS(coords_bohr - factor * coords) .le. 1.0d-12 * ABS(factor * coords)) .and. &
+           ALL(ABS(received - coords) .le. 1.0d-12 * ABS(coords) + 1.0d-15))
+
+   CASE DEFAULT
+      WRITE(6,*)'ERROR: Unrecognized test: '//TRIM(test)
+
+   END SELECT
+
+   call MDI_Send_command("EXIT", comm, ierr)
+
+   ! Return to the default context, and free the context of this code
+   IF (TRIM(test) .eq. "context") THEN
+      call MDI_Set_context(MDI_CONTEXT_DEFAULT, ierr)
+      call MDI_Context_free(context, ierr)
+   END IF
+
+   ! Synchronize all MPI ranks
+   call MPI_Barrier( world_comm, ierr )
+   call MPI_Finalize( ierr )
+
+END PROGRAM DRIVER_API_F90
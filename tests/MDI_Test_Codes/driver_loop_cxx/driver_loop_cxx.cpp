@@ -0,0 +1,433 @@
+#include <iostream>
+#include <stdexcept>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <stdint.h>
+#include "mdi.h"
+
+// Check whether two arrays agree to within a relative tolerance
+// A tolerance of zero requires the arrays to be bitwise identical
+bool arrays_match(const double* a, const double* b, int n, double tolerance) {
+  if ( tolerance == 0.0 ) {
+    return memcmp(a, b, n * sizeof(double)) == 0;
+  }
+  for (int i = 0; i < n; i++) {
+    if ( fabs(a[i] - b[i]) > tolerance * fabs(a[i]) ) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Value of a point on a smooth grid, which changes slightly on each step
+double grid_value(int64_t igrid, int istep) {
+  double x = double(igrid % 32) - 16.0;
+  double y = double(igrid / 32) - 16.0;
+  return exp( -0.01 * double(istep + 1) * ( x*x + y*y ) );
+}
+
+// State shared with the stream callbacks
+struct grid_stream {
+  int istep;
+  double tolerance;
+  int64_t nmismatch;
+};
+
+// Produce a chunk of the grid for MDI_Send_stream
+int produce_grid(void* chunk, int64_t offset, int64_t count, void* ctx) {
+  grid_stream* stream = (grid_stream*) ctx;
+  double* values = (double*) chunk;
+  for (int64_t i = 0; i < count; i++) {
+    values[i] = grid_value(offset + i, stream->istep);
+  }
+  return 0;
+}
+
+// Check a chunk of the grid received by MDI_Recv_stream
+int consume_grid(void* chunk, int64_t offset, int64_t count, void* ctx) {
+  grid_stream* stream = (grid_stream*) ctx;
+  double* expected = new double[count];
+  produce_grid(expected, offset, count, ctx);
+  if ( not arrays_match(expected, (double*) chunk, int(count), stream->tolerance) ) {
+    stream->nmismatch++;
+  }
+  delete [] expected;
+  return 0;
+}
+
+int main(int argc, char **argv) {
+
+  // Read through all the command line options
+  int iarg = 1;
+  int nsteps = 100;
+  int grid_size = 0;
+  int types_size = 0;
+  double tolerance = 0.0;
+  bool strided = false;
+  bool vectored = false;
+  bool persistent = false;
+  bool stream = false;
+  bool units = false;
+  bool initialized_mdi = false;
+  while ( iarg < argc ) {
+
+    if ( strcmp(argv[iarg],"-mdi") == 0 ) {
+
+      // Ensure that the argument to the -mdi option was provided
+      if ( argc-iarg < 2 ) {
+	throw std::runtime_error("The -mdi argument was not provided.");
+      }
+
+      // Initialize the MDI Library
+      int ret = MDI_Init(argv[iarg+1], NULL);
+      if ( ret != 0 ) {
+	throw std::runtime_error("The MDI library was not initialized correctly.");
+      }
+      initialized_mdi = true;
+      iarg += 2;
+
+    }
+    else if ( strcmp(argv[iarg],"-nsteps") == 0 ) {
+
+      // Ensure that the argument to the -nsteps option was provided
+      if ( argc-iarg < 2 ) {
+	throw std::runtime_error("The -nsteps argument was not provided.");
+      }
+      nsteps = atoi(argv[iarg+1]);
+      iarg += 2;
+
+    }
+    else if ( strcmp(argv[iarg],"-tolerance") == 0 ) {
+
+      // Ensure that the argument to the -tolerance option was provided
+      if ( argc-iarg < 2 ) {
+	throw std::runtime_error("The -tolerance argument was not provided.");
+      }
+      tolerance = atof(argv[iarg+1]);
+      iarg += 2;
+
+    }
+    else if ( strcmp(argv[iarg],"-grid") == 0 ) {
+
+      // Ensure that the argument to the -grid option was provided
+      if ( argc-iarg < 2 ) {
+	throw std::runtime_error("The -grid argument was not provided.");
+      }
+      grid_size = atoi(argv[iarg+1]);
+      iarg += 2;
+
+    }
+    else if ( strcmp(argv[iarg],"-types") == 0 ) {
+
+      // Ensure that the argument to the -types option was provided
+      if ( argc-iarg < 2 ) {
+	throw std::runtime_error("The -types argument was not provided.");
+      }
+      types_size = atoi(argv[iarg+1]);
+      iarg += 2;
+
+    }
+    else if ( strcmp(argv[iarg],"-strided") == 0 ) {
+      strided = true;
+      iarg += 1;
+    }
+    else if ( strcmp(argv[iarg],"-vectored") == 0 ) {
+      vectored = true;
+      iarg += 1;
+    }
+    else if ( strcmp(argv[iarg],"-persistent") == 0 ) {
+      persistent = true;
+      iarg += 1;
+    }
+    else if ( strcmp(argv[iarg],"-stream") == 0 ) {
+      stream = true;
+      iarg += 1;
+    }
+    else if ( strcmp(argv[iarg],"-units") == 0 ) {
+      units = true;
+      iarg += 1;
+    }
+    else {
+      throw std::runtime_error("Unrecognized option.");
+    }
+
+  }
+  if ( not initialized_mdi ) {
+    throw std::runtime_error("The -mdi command line option was not provided.");
+  }
+
+  // Confirm that the code is being run as a driver
+  int role;
+  MDI_Get_role(&role);
+  if ( role != MDI_DRIVER ) {
+    throw std::runtime_error("Must run driver_loop_cxx as a DRIVER");
+  }
+
+  // Connect to the engine
+  MDI_Comm comm;
+  MDI_Accept_communicator(&comm);
+
+  // Determine the number of atoms
+  int natoms;
+  MDI_Send_command("<NATOMS", comm);
+  MDI_Recv(&natoms, 1, MDI_INT, comm);
+
+  // Repeatedly send slightly perturbed coordinates to the engine, and confirm that they round-trip
+  double* coords = new double[3*natoms];
+  double* returned_coords = new double[3*natoms];
+  for (int icoord = 0; icoord < 3 * natoms; icoord++) {
+    coords[icoord] = 0.1 * double(icoord);
+  }
+
+  // with -persistent, the coordinates are sent and received through persistent requests
+  MDI_Request send_request = MDI_REQUEST_NULL;
+  MDI_Request recv_request = MDI_REQUEST_NULL;
+  if ( persistent ) {
+    MDI_Send_init(coords, 3 * natoms, MDI_DOUBLE, comm, &send_request);
+    MDI_Recv_init(returned_coords, 3 * natoms, MDI_DOUBLE, comm, &recv_request);
+  }
+
+  int nmismatch = 0;
+  for (int istep = 0; istep < nsteps; istep++) {
+    // move one Cartesian component of every atom on each step
+    for (int icoord = istep % 3; icoord < 3 * natoms; icoord += 3) {
+      coords[icoord] += 0.001 * sin( double(istep + icoord) );
+    }
+
+    // with -units, the coordinates are sent in angstrom and received in nanometers
+    MDI_Send_command(">COORDS", comm);
+    if ( persistent ) {
+      MDI_Start(send_request);
+    }
+    else if ( units ) {
+      MDI_Send_units(coords, 3 * natoms, MDI_DOUBLE, "angstrom", comm);
+    }
+    else {
+      MDI_Send(coords, 3 * natoms, MDI_DOUBLE, comm);
+    }
+
+    MDI_Send_command("<COORDS", comm);
+    if ( persistent ) {
+      MDI_Start(recv_request);
+    }
+    else if ( units ) {
+      MDI_Recv_units(returned_coords, 3 * natoms, MDI_DOUBLE, "nanometer", comm);
+    }
+    else {
+      MDI_Recv(returned_coords, 3 * natoms, MDI_DOUBLE, comm);
+    }
+
+    if ( units ) {
+      for (int icoord = 0; icoord < 3 * natoms; icoord++) {
+        returned_coords[icoord] *= 10.0;
+      }
+      if ( not arrays_match(coords, returned_coords, 3 * natoms, 1.0e-12) ) {
+        nmismatch++;
+      }
+    }
+    else if ( not arrays_match(coords, returned_coords, 3 * natoms, tolerance) ) {
+      nmismatch++;
+    }
+  }
+
+  std::cout << " Steps: " << nsteps << std::endl;
+  std::cout << " Mismatches: " << nmismatch << std::endl;
+
+  if ( persistent ) {
+    MDI_Request_free(&send_request);
+    MDI_Request_free(&recv_request);
+  }
+  delete [] coords;
+  delete [] returned_coords;
+
+  // Send a large, smooth grid to the engine, and confirm that it round-trips
+  if ( grid_size > 0 ) {
+    double* grid = new double[grid_size];
+    double* returned_grid = new double[grid_size];
+    int ngrid_mismatch = 0;
+    for (int istep = 0; istep < 3; istep++) {
+      for (int igrid = 0; igrid < grid_size; igrid++) {
+        grid[igrid] = grid_value(igrid, istep);
+      }
+
+      // with -stream, the grid is produced and checked in chunks, without a full buffer
+      grid_stream grid_ctx;
+      grid_ctx.istep = istep;
+      grid_ctx.tolerance = tolerance;
+      grid_ctx.nmismatch = 0;
+
+      MDI_Send_command(">GRID", comm);
+      MDI_Send(&grid_size, 1, MDI_INT, comm);
+      if ( stream ) {
+        MDI_Send_stream(int64_t(grid_size), MDI_DOUBLE, 1000, produce_grid, &grid_ctx, comm);
+      }
+      else {
+        MDI_Send_c(grid, int64_t(grid_size), MDI_DOUBLE, comm);
+      }
+
+      int returned_size;
+      MDI_Send_command("<GRID", comm);
+      MDI_Recv(&returned_size, 1, MDI_INT, comm);
+      if ( returned_size != grid_size ) {
+        throw std::runtime_error("The engine returned a grid of the wrong size.");
+      }
+      if ( stream ) {
+        MDI_Recv_stream(int64_t(grid_size), MDI_DOUBLE, 1000, consume_grid, &grid_ctx, comm);
+        if ( grid_ctx.nmismatch > 0 ) {
+          ngrid_mismatch++;
+        }
+      }
+      else {
+        MDI_Recv_c(returned_grid, int64_t(grid_size), MDI_DOUBLE, comm);
+        if ( not arrays_match(grid, returned_grid, grid_size, tolerance) ) {
+          ngrid_mismatch++;
+        }
+      }
+    }
+    std::cout << " Grid mismatches: " << ngrid_mismatch << std::endl;
+
+    delete [] grid;
+    delete [] returned_grid;
+  }
+
+  // Send arrays of each extended datatype to the engine, and confirm that they round-trip
+  if ( types_size > 0 ) {
+    float* types_float = new float[types_size];
+    int64_t* types_int64 = new int64_t[types_size];
+    int8_t* types_int8 = new int8_t[types_size];
+    double* types_complex = new double[2 * types_size];
+    float* returned_float = new float[types_size];
+    int64_t* returned_int64 = new int64_t[types_size];
+    int8_t* returned_int8 = new int8_t[types_size];
+    double* returned_complex = new double[2 * types_size];
+    int ntypes_mismatch = 0;
+    for (int istep = 0; istep < 3; istep++) {
+      for (int i = 0; i < types_size; i++) {
+        types_float[i] = 0.5f * float(i) + 0.25f * float(istep);
+        types_int64[i] = ( int64_t(1) << 40 ) + int64_t(i) * 1000 + istep;
+        types_int8[i] = int8_t( ( i + istep ) % 128 - 64 );
+        types_complex[2*i] = cos( 0.1 * double(i + istep) );
+        types_complex[2*i+1] = sin( 0.1 * double(i + istep) );
+      }
+
+      // with -vectored, the arrays are sent and received as single vectored messages
+      int64_t counts[4] = { types_size, types_size, types_size, types_size };
+      MDI_Datatype datatypes[4] = { MDI_FLOAT, MDI_INT64, MDI_INT8, MDI_COMPLEX_DOUBLE };
+      if ( vectored ) {
+        const void* bufs[4] = { types_float, types_int64, types_int8, types_complex };
+        MDI_Send_command(">TYPESV", comm);
+        MDI_Send(&types_size, 1, MDI_INT, comm);
+        MDI_Sendv(4, bufs, counts, datatypes, comm);
+      }
+      else {
+        MDI_Send_command(">TYPES", comm);
+        MDI_Send(&types_size, 1, MDI_INT, comm);
+        MDI_Send(types_float, types_size, MDI_FLOAT, comm);
+        MDI_Send(types_int64, types_size, MDI_INT64, comm);
+        MDI_Send(types_int8, types_size, MDI_INT8, comm);
+        MDI_Send(types_complex, types_size, MDI_COMPLEX_DOUBLE, comm);
+      }
+
+      if ( vectored ) {
+        void* bufs[4] = { returned_float, returned_int64, returned_int8, returned_complex };
+        MDI_Send_command("<TYPESV", comm);
+        MDI_Recvv(4, bufs, counts, datatypes, comm);
+      }
+      else {
+        int returned_size;
+        MDI_Send_command("<TYPES", comm);
+        MDI_Recv(&returned_size, 1, MDI_INT, comm);
+        if ( returned_size != types_size ) {
+          throw std::runtime_error("The engine returned arrays of the wrong size.");
+        }
+        MDI_Recv(returned_float, types_size, MDI_FLOAT, comm);
+        MDI_Recv(returned_int64, types_size, MDI_INT64, comm);
+        MDI_Recv(returned_int8, types_size, MDI_INT8, comm);
+        MDI_Recv(returned_complex, types_size, MDI_COMPLEX_DOUBLE, comm);
+      }
+
+      if ( memcmp(types_float, returned_float, types_size * sizeof(float)) != 0 ||
+           memcmp(types_int64, returned_int64, types_size * sizeof(int64_t)) != 0 ||
+           memcmp(types_int8, returned_int8, types_size * sizeof(int8_t)) != 0 ||
+           memcmp(types_complex, returned_complex, 2 * types_size * sizeof(double)) != 0 ) {
+        ntypes_mismatch++;
+      }
+    }
+    std::cout << " Type mismatches: " << ntypes_mismatch << std::endl;
+
+    delete [] types_float;
+    delete [] types_int64;
+    delete [] types_int8;
+    delete [] types_complex;
+    delete [] returned_float;
+    delete [] returned_int64;
+    delete [] returned_int8;
+    delete [] returned_complex;
+  }
+
+  // Send strided arrays to the engine, and confirm that they round-trip
+  if ( strided ) {
+    int nstrided_mismatch = 0;
+
+    // coordinates stored as separate arrays of x, y, and z values are sent in Nx3 order
+    double* coords_soa = new double[3*natoms];
+    double* returned_soa = new double[3*natoms];
+    for (int iatom = 0; iatom < natoms; iatom++) {
+      for (int idim = 0; idim < 3; idim++) {
+        coords_soa[idim * natoms + iatom] = 0.1 * double(3 * iatom + idim);
+      }
+    }
+    int64_t soa_shape[2] = { natoms, 3 };
+    int64_t soa_strides[2] = { int64_t(sizeof(double)), int64_t(natoms * sizeof(double)) };
+    MDI_Send_command(">COORDS", comm);
+    MDI_Send_strided(coords_soa, 2, soa_shape, soa_strides, MDI_DOUBLE, comm);
+    MDI_Send_command("<COORDS", comm);
+    MDI_Recv_strided(returned_soa, 2, soa_shape, soa_strides, MDI_DOUBLE, comm);
+    if ( not arrays_match(coords_soa, returned_soa, 3 * natoms, tolerance) ) {
+      nstrided_mismatch++;
+    }
+    delete [] coords_soa;
+    delete [] returned_soa;
+
+    // the grid is stored in rows of 32 values, each padded to 40 values
+    if ( grid_size > 0 ) {
+      int nrows = grid_size / 32;
+      double* padded = new double[40 * nrows];
+      double* returned_padded = new double[40 * nrows];
+      for (int i = 0; i < 40 * nrows; i++) {
+        padded[i] = double(i % 40) + 0.5 * double(i / 40);
+        returned_padded[i] = 0.0;
+      }
+      int64_t grid_shape[2] = { nrows, 32 };
+      int64_t grid_strides[2] = { int64_t(40 * sizeof(double)), int64_t(sizeof(double)) };
+      int packed_size = 32 * nrows;
+      MDI_Send_command(">GRID", comm);
+      MDI_Send(&packed_size, 1, MDI_INT, comm);
+      MDI_Send_strided(padded, 2, grid_shape, grid_strides, MDI_DOUBLE, comm);
+
+      int returned_size;
+      MDI_Send_command("<GRID", comm);
+      MDI_Recv(&returned_size, 1, MDI_INT, comm);
+      if ( returned_size != packed_size ) {
+        throw std::runtime_error("The engine returned a grid of the wrong size.");
+      }
+      MDI_Recv_strided(returned_padded, 2, grid_shape, grid_strides, MDI_DOUBLE, comm);
+      for (int irow = 0; irow < nrows; irow++) {
+        if ( not arrays_match(&padded[40 * irow], &returned_padded[40 * irow], 32, tolerance) ) {
+          nstrided_mismatch++;
+          break;
+        }
+      }
+      delete [] padded;
+      delete [] returned_padded;
+    }
+
+    std::cout << " Strided mismatches: " << nstrided_mismatch << std::endl;
+  }
+
+  // Send the "EXIT" command to the engine
+  MDI_Send_command("EXIT", comm);
+
+  return 0;
+}
@@ -3,8 +3,18 @@
 #include <stdexcept>
 #include <string.h>
 #include <cstdlib>
+#include <vector>
 #include "mdi.h"
 
+// Run plugin instances on groups of MPI ranks, split off from the ranks that run the driver
+// With the -ntasks option, MDI_Launch_plugin_ensemble splits the ranks, and shares out the tasks
+// among the instances, rather than each instance running once
+// With the -fail_task option, one of those tasks fails
+
+
+// Index of the task that fails, or -1 if every task succeeds
+static int fail_task = -1;
+
 
 void mpi_error(const char* errormsg) {
   std::cerr << errormsg << std::endl;
@@ -12,13 +22,9 @@ void mpi_error(const char* errormsg) {
 }
 
 
-int code_for_plugin_instance(void* mpi_comm_ptr, MDI_Comm mdi_comm, void* class_object) {
-  MPI_Comm mpi_comm = *(MPI_Comm*) mpi_comm_ptr;
-  int my_rank;
-  MPI_Comm_rank(mpi_comm, &my_rank);
-
+// Query the engine, and then send it the "EXIT" command
+void query_engine(MPI_Comm mpi_comm, MDI_Comm mdi_comm, char* engine_name) {
   // Determine the name of the engine
-  char* engine_name = new char[MDI_NAME_LENGTH];
   if ( MDI_Send_command("<NAME", mdi_comm) != 0 ) {
     mpi_error("MDI_Send_command returned non-zero exit code.");
   }
@@ -48,14 +54,43 @@ int code_for_plugin_instance(void* mpi_comm_ptr, MDI_Comm mdi_comm, void* class_
   }
   delete[] coords;
 
+  // Send the "EXIT" command to the engine
+  if ( MDI_Send_command("EXIT", mdi_comm) != 0 ) {
+    mpi_error("MDI_Send_command returned non-zero exit code.");
+  }
+}
+
+
+int code_for_plugin_instance(void* mpi_comm_ptr, MDI_Comm mdi_comm, void* class_object) {
+  MPI_Comm mpi_comm = *(MPI_Comm*) mpi_comm_ptr;
+  int my_rank;
+  MPI_Comm_rank(mpi_comm, &my_rank);
+
+  char* engine_name = new char[MDI_NAME_LENGTH];
+  query_engine(mpi_comm, mdi_comm, engine_name);
   if ( my_rank == 0 ) {
     std::cout << " Engine name: " << engine_name << std::endl;
   }
-  free( engine_name );
+  delete[] engine_name;
 
-  // Send the "EXIT" command to the engine
-  if ( MDI_Send_command("EXIT", mdi_comm) != 0 ) {
-    mpi_error("MDI_Send_command returned non-zero exit code.");
+  return 0;
+}
+
+
+// Run one task of an ensemble, and count the tasks that each instance runs
+int code_for_task(void* mpi_comm_ptr, MDI_Comm mdi_comm, int task, void* class_object) {
+  std::vector<int>* task_counts = (std::vector<int>*) class_object;
+  MPI_Comm mpi_comm = *(MPI_Comm*) mpi_comm_ptr;
+  int my_rank;
+  MPI_Comm_rank(mpi_comm, &my_rank);
+
+  char engine_name[MDI_NAME_LENGTH];
+  query_engine(mpi_comm, mdi_comm, engine_name);
+  if ( task == fail_task ) {
+    return 1;
+  }
+  if ( my_rank == 0 ) {
+    (*task_counts)[task]++;
   }
 
   return 0;
@@ -81,6 +116,10 @@ int main(int argc, char **argv) {
   // The value of this variable is read from the command-line options
   char* plugin_name = NULL;
 
+  // Number of tasks to share out among the plugin instances, or -1 to run each instance once
+  // The value of this variable is read from the command-line options
+  int ntasks = -1;
+
   // Read through all the command line options
   int iarg = 1;
   bool initialized_mdi = false;
@@ -142,6 +181,32 @@ int main(int argc, char **argv) {
       plugin_name = argv[iarg+1];
       iarg += 2;
 
+    }
+    else if ( strcmp(argv[iarg],"-ntasks") == 0 ) {
+
+      // Ensure that the argument to the -ntasks option was provided
+      if ( argc-iarg < 2 ) {
+	mpi_error("The -ntasks argument was not provided.");
+      }
+
+      // Set ntasks
+      char* strtol_ptr;
+      ntasks = strtol( argv[iarg+1], &strtol_ptr, 10 );
+      iarg += 2;
+
+    }
+    else if ( strcmp(argv[iarg],"-fail_task") == 0 ) {
+
+      // Ensure that the argument to the -fail_task option was provided
+      if ( argc-iarg < 2 ) {
+	mpi_error("The -fail_task argument was not provided.");
+      }
+
+      // Set fail_task
+      char* strtol_ptr;
+      fail_task = strtol( argv[iarg+1], &strtol_ptr, 10 );
+      iarg += 2;
+
     }
     else {
       mpi_error("Unrecognized option.");
@@ -173,7 +238,42 @@ int main(int argc, char **argv) {
   if ( plugin_name == NULL ) {
     mpi_error("Plugin name was not provided.");
   }
-  
+
+  // Share out the tasks among the plugin instances, and check that each task ran exactly once
+  if ( ntasks >= 0 ) {
+    std::vector<int> task_counts(ntasks, 0);
+    int failed = MDI_Launch_plugin_ensemble(plugin_name, "", &world_comm, driver_nranks, plugin_nranks, ntasks,
+                                            code_for_task, &task_counts) != 0;
+    if ( failed && fail_task < 0 ) {
+      mpi_error("MDI_Launch_plugin_ensemble returned non-zero exit code.");
+    }
+    std::vector<int> total_counts(ntasks, 0);
+    MPI_Reduce(task_counts.data(), total_counts.data(), ntasks, MPI_INT, MPI_SUM, 0, world_comm);
+    int nfailed = 0;
+    MPI_Reduce(&failed, &nfailed, 1, MPI_INT, MPI_SUM, 0, world_comm);
+
+    int my_rank;
+    MPI_Comm_rank(world_comm, &my_rank);
+    if ( my_rank == 0 ) {
+      int ncompleted = 0;
+      for ( int task = 0; task < ntasks; task++ ) {
+        if ( total_counts[task] == 1 ) {
+          ncompleted++;
+        }
+      }
+      std::cout << " Instances: " << ( world_size - driver_nranks ) / plugin_nranks << std::endl;
+      std::cout << " Tasks: " << ntasks << std::endl;
+      std::cout << " Completed once: " << ncompleted << std::endl;
+      if ( fail_task >= 0 ) {
+        std::cout << " Failed ranks: " << nfailed << std::endl;
+      }
+    }
+
+    MPI_Finalize();
+    return 0;
+  }
+
+
   // Split world_comm into MPI intra-comms for the driver and each plugin
   MPI_Comm intra_comm;
   int my_rank, color, intra_rank;
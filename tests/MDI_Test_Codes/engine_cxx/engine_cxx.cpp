@@ -1,11 +1,26 @@
 #include <iostream>
 #include <stdexcept>
+#include <vector>
 #include <string.h>
+#include <stdint.h>
 #include "mdi.h"
 #include "engine_cxx.h"
 
 bool exit_signal = false;
 
+// coordinates received from the driver through the >COORDS command
+double received_coords[30];
+bool has_received_coords = false;
+
+// grid received from the driver through the >GRID command
+std::vector<double> grid;
+
+// arrays of each extended datatype received from the driver through the >TYPES command
+std::vector<float> types_float;
+std::vector<int64_t> types_int64;
+std::vector<int8_t> types_int8;
+std::vector<double> types_complex;
+
 
 int initialize_mdi(MDI_Comm* comm_ptr) {
   // Confirm that the code is being run as an engine
@@ -20,8 +35,17 @@ int initialize_mdi(MDI_Comm* comm_ptr) {
   MDI_Register_command("@DEFAULT","EXIT");
   MDI_Register_command("@DEFAULT","<NATOMS");
   MDI_Register_command("@DEFAULT","<COORDS");
+  MDI_Register_command("@DEFAULT",">COORDS");
+  MDI_Register_command("@DEFAULT","<GRID");
+  MDI_Register_command("@DEFAULT",">GRID");
+  MDI_Register_command("@DEFAULT","<TYPES");
+  MDI_Register_command("@DEFAULT",">TYPES");
+  MDI_Register_command("@DEFAULT","<TYPESV");
+  MDI_Register_command("@DEFAULT",">TYPESV");
   MDI_Register_command("@DEFAULT","<FORCES");
   MDI_Register_command("@DEFAULT","<FORCES_B");
+  // freeze the registry, then register the remaining nodes, which update the frozen registry
+  MDI_Freeze_Registry();
   MDI_Register_node("@FORCES");
   MDI_Register_command("@FORCES","EXIT");
   MDI_Register_command("@FORCES","<FORCES");
@@ -76,7 +100,67 @@ int execute_command(const char* command, MDI_Comm comm, void* class_obj) {
     MDI_Send(&natoms, 1, MDI_INT, comm);
   }
   else if ( strcmp(command, "<COORDS") == 0 ) {
-    MDI_Send(&coords, 3 * natoms, MDI_DOUBLE, comm);
+    if ( has_received_coords ) {
+      MDI_Send(&received_coords, 3 * natoms, MDI_DOUBLE, comm);
+    }
+    else {
+      MDI_Send(&coords, 3 * natoms, MDI_DOUBLE, comm);
+    }
+  }
+  else if ( strcmp(command, ">COORDS") == 0 ) {
+    MDI_Recv(&received_coords, 3 * natoms, MDI_DOUBLE, comm);
+    has_received_coords = true;
+  }
+  else if ( strcmp(command, ">GRID") == 0 ) {
+    int grid_size;
+    MDI_Recv(&grid_size, 1, MDI_INT, comm);
+    grid.resize(grid_size);
+    MDI_Recv(grid.data(), grid_size, MDI_DOUBLE, comm);
+  }
+  else if ( strcmp(command, "<GRID") == 0 ) {
+    int grid_size = grid.size();
+    MDI_Send(&grid_size, 1, MDI_INT, comm);
+    MDI_Send(grid.data(), grid_size, MDI_DOUBLE, comm);
+  }
+  else if ( strcmp(command, ">TYPES") == 0 ) {
+    int types_size;
+    MDI_Recv(&types_size, 1, MDI_INT, comm);
+    types_float.resize(types_size);
+    types_int64.resize(types_size);
+    types_int8.resize(types_size);
+    types_complex.resize(2 * types_size);
+    MDI_Recv(types_float.data(), types_size, MDI_FLOAT, comm);
+    MDI_Recv(types_int64.data(), types_size, MDI_INT64, comm);
+    MDI_Recv(types_int8.data(), types_size, MDI_INT8, comm);
+    MDI_Recv(types_complex.data(), types_size, MDI_COMPLEX_DOUBLE, comm);
+  }
+  else if ( strcmp(command, "<TYPES") == 0 ) {
+    int types_size = types_float.size();
+    MDI_Send(&types_size, 1, MDI_INT, comm);
+    MDI_Send(types_float.data(), types_size, MDI_FLOAT, comm);
+    MDI_Send(types_int64.data(), types_size, MDI_INT64, comm);
+    MDI_Send(types_int8.data(), types_size, MDI_INT8, comm);
+    MDI_Send(types_complex.data(), types_size, MDI_COMPLEX_DOUBLE, comm);
+  }
+  else if ( strcmp(command, ">TYPESV") == 0 ) {
+    int types_size;
+    MDI_Recv(&types_size, 1, MDI_INT, comm);
+    types_float.resize(types_size);
+    types_int64.resize(types_size);
+    types_int8.resize(types_size);
+    types_complex.resize(2 * types_size);
+    void* bufs[4] = { types_float.data(), types_int64.data(), types_int8.data(), types_complex.data() };
+    int64_t counts[4] = { types_size, types_size, types_size, types_size };
+    MDI_Datatype datatypes[4] = { MDI_FLOAT, MDI_INT64, MDI_INT8, MDI_COMPLEX_DOUBLE };
+    MDI_Recvv(4, bufs, counts, datatypes, comm);
+  }
+  else if ( strcmp(command, "<TYPESV") == 0 ) {
+    // the arrays are returned as a single message, so the driver must already know their size
+    int types_size = types_float.size();
+    const void* bufs[4] = { types_float.data(), types_int64.data(), types_int8.data(), types_complex.data() };
+    int64_t counts[4] = { types_size, types_size, types_size, types_size };
+    MDI_Datatype datatypes[4] = { MDI_FLOAT, MDI_INT64, MDI_INT8, MDI_COMPLEX_DOUBLE };
+    MDI_Sendv(4, bufs, counts, datatypes, comm);
   }
   else if ( strcmp(command, "<FORCES") == 0 ) {
     MDI_Send(&forces, 3 * natoms, MDI_DOUBLE, comm);
@@ -89,6 +89,8 @@ class MDIEngine:
         mdi.MDI_Register_Command("@DEFAULT","<COORDS")
         mdi.MDI_Register_Command("@DEFAULT","<FORCES")
         mdi.MDI_Register_Command("@DEFAULT","<FORCES_B")
+        # freeze the registry, then register the remaining nodes, which update the frozen registry
+        mdi.MDI_Freeze_Registry()
         mdi.MDI_Register_Node("@FORCES")
         mdi.MDI_Register_Command("@FORCES","EXIT")
         mdi.MDI_Register_Command("@FORCES","<FORCES")
@@ -0,0 +1,315 @@
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <string.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include "mdi.h"
+
+// Connect a driver and an engine through a communication method that is registered with
+// MDI_Register_Method, and which moves bytes through a pair of named pipes
+// The same executable acts as either the driver or the engine, depending on its role
+// With the -perturb option, the coordinates only change slightly from one step to the next, and
+// the driver reports how the coordinates were encoded on the wire, which the method can observe
+
+// Prefix of the paths of the named pipes
+static std::string fifo_prefix = "mdi_fifo";
+
+// Flag whether the driver has already accepted its engine
+static bool accepted = false;
+
+// Size, and the second integer, of each of the two most recent sends
+// The header of a message is sent on its own, and its second integer holds the flags that
+// describe how the body was encoded
+struct fifo_send_record {
+  int64_t nbytes;
+  int flags;
+};
+static fifo_send_record recent_sends[2] = { { 0, 0 }, { 0, 0 } };
+
+// Flag of a message header, indicating that the body is a delta frame
+static const int header_delta_flag = 2;
+
+// A connection through the named pipes
+struct fifo_connection {
+  int read_fd;
+  int write_fd;
+};
+
+std::string driver_to_engine() { return fifo_prefix + "_d2e"; }
+std::string engine_to_driver() { return fifo_prefix + "_e2d"; }
+
+// Create the named pipes
+int fifo_init(const char* role, const char* options, void** method_state) {
+  if ( strcmp(role, "DRIVER") == 0 ) {
+    unlink(driver_to_engine().c_str());
+    unlink(engine_to_driver().c_str());
+    if ( mkfifo(driver_to_engine().c_str(), 0600) != 0 || mkfifo(engine_to_driver().c_str(), 0600) != 0 ) {
+      return 1;
+    }
+  }
+  *method_state = NULL;
+  return 0;
+}
+
+// Accept the engine, which is the only connection of the driver
+int fifo_accept(void* method_state, void** connection) {
+  if ( accepted ) {
+    *connection = NULL;
+    return 0;
+  }
+  fifo_connection* conn = new fifo_connection;
+  conn->write_fd = open(driver_to_engine().c_str(), O_WRONLY);
+  conn->read_fd = open(engine_to_driver().c_str(), O_RDONLY);
+  if ( conn->write_fd < 0 || conn->read_fd < 0 ) {
+    delete conn;
+    return 1;
+  }
+
+  // both codes have opened the named pipes, so their paths are no longer needed
+  unlink(driver_to_engine().c_str());
+  unlink(engine_to_driver().c_str());
+  accepted = true;
+  *connection = conn;
+  return 0;
+}
+
+// Connect to the driver, waiting for it to create the named pipes
+int fifo_connect(void* method_state, void** connection) {
+  fifo_connection* conn = new fifo_connection;
+  conn->read_fd = -1;
+  while ( conn->read_fd < 0 ) {
+    conn->read_fd = open(driver_to_engine().c_str(), O_RDONLY);
+    if ( conn->read_fd < 0 ) {
+      if ( errno != ENOENT ) {
+        delete conn;
+        return 1;
+      }
+      usleep(10000);
+    }
+  }
+  conn->write_fd = open(engine_to_driver().c_str(), O_WRONLY);
+  if ( conn->write_fd < 0 ) {
+    delete conn;
+    return 1;
+  }
+  *connection = conn;
+  return 0;
+}
+
+int fifo_send(const void* buf, int64_t nbytes, void* connection) {
+  fifo_connection* conn = (fifo_connection*) connection;
+  recent_sends[0] = recent_sends[1];
+  recent_sends[1].nbytes = nbytes;
+  recent_sends[1].flags = ( nbytes >= (int64_t)( 2 * sizeof(int) ) ) ? ((const int*)buf)[1] : 0;
+  int64_t total = 0;
+  while ( total < nbytes ) {
+    ssize_t n = write(conn->write_fd, (const char*)buf + total, nbytes - total);
+    if ( n <= 0 ) {
+      return 1;
+    }
+    total += n;
+  }
+  return 0;
+}
+
+int fifo_recv(void* buf, int64_t nbytes, void* connection) {
+  fifo_connection* conn = (fifo_connection*) connection;
+  int64_t total = 0;
+  while ( total < nbytes ) {
+    ssize_t n = read(conn->read_fd, (char*)buf + total, nbytes - total);
+    if ( n <= 0 ) {
+      return 1;
+    }
+    total += n;
+  }
+  return 0;
+}
+
+int fifo_delete(void* connection) {
+  fifo_connection* conn = (fifo_connection*) connection;
+  close(conn->read_fd);
+  close(conn->write_fd);
+  delete conn;
+  return 0;
+}
+
+// Number of atoms of the engine
+static const int natoms = 10;
+
+// Respond to the commands of the driver
+void run_engine(MDI_Comm comm) {
+  double coords[3 * natoms];
+  char command[MDI_COMMAND_LENGTH];
+  bool exit_signal = false;
+  while ( not exit_signal ) {
+    MDI_Recv_command(command, comm);
+    if ( strcmp(command, "EXIT") == 0 ) {
+      exit_signal = true;
+    }
+    else if ( strcmp(command, "<NAME") == 0 ) {
+      char name[MDI_NAME_LENGTH];
+      strcpy(name, "MM");
+      MDI_Send(name, MDI_NAME_LENGTH, MDI_CHAR, comm);
+    }
+    else if ( strcmp(command, ">COORDS") == 0 ) {
+      MDI_Recv(coords, 3 * natoms, MDI_DOUBLE, comm);
+    }
+    else if ( strcmp(command, "<COORDS") == 0 ) {
+      MDI_Send(coords, 3 * natoms, MDI_DOUBLE, comm);
+    }
+    else {
+      throw std::runtime_error("Unrecognized command.");
+    }
+  }
+}
+
+// Exchange coordinates with the engine, and count the coordinates that are not returned intact
+void run_driver(MDI_Comm comm, int nsteps, bool perturb) {
+  char name[MDI_NAME_LENGTH];
+  MDI_Send_command("<NAME", comm);
+  MDI_Recv(name, MDI_NAME_LENGTH, MDI_CHAR, comm);
+
+  std::vector<double> coords(3 * natoms);
+  std::vector<double> received(3 * natoms);
+  int mismatches = 0;
+  int delta_frames = 0;
+  int64_t body_bytes = 0;
+  for ( int istep = 0; istep < nsteps; istep++ ) {
+    for ( int icoord = 0; icoord < 3 * natoms; icoord++ ) {
+      if ( perturb ) {
+        coords[icoord] = 1.0 + 0.01 * double(icoord) + 1.0e-12 * double(istep);
+      }
+      else {
+        coords[icoord] = double(istep) + 0.01 * double(icoord);
+      }
+    }
+    MDI_Send_command(">COORDS", comm);
+    MDI_Send(coords.data(), 3 * natoms, MDI_DOUBLE, comm);
+
+    // the two most recent sends were the header and the body of the coordinates
+    if ( recent_sends[0].flags & header_delta_flag ) {
+      delta_frames++;
+    }
+    body_bytes += recent_sends[1].nbytes;
+    MDI_Send_command("<COORDS", comm);
+    MDI_Recv(received.data(), 3 * natoms, MDI_DOUBLE, comm);
+    for ( int icoord = 0; icoord < 3 * natoms; icoord++ ) {
+      if ( received[icoord] != coords[icoord] ) {
+        mismatches++;
+      }
+    }
+  }
+  MDI_Send_command("EXIT", comm);
+
+  std::cout << " Engine name: " << name << std::endl;
+  std::cout << " Steps: " << nsteps << std::endl;
+  std::cout << " Mismatches: " << mismatches << std::endl;
+  if ( perturb ) {
+    std::cout << " Delta frames: " << delta_frames << std::endl;
+    std::cout << " Body bytes: " << body_bytes << std::endl;
+  }
+}
+
+int main(int argc, char **argv) {
+
+  // Register the method before initializing MDI
+  if ( MDI_Register_Method("FIFO", fifo_init, fifo_accept, fifo_connect,
+                           fifo_send, fifo_recv, fifo_delete) != 0 ) {
+    throw std::runtime_error("The method was not registered.");
+  }
+
+  // Read through all the command line options
+  int iarg = 1;
+  bool initialized_mdi = false;
+  int nsteps = 1000;
+  bool hangup = false;
+  bool perturb = false;
+  while ( iarg < argc ) {
+
+    if ( strcmp(argv[iarg],"-fifo") == 0 ) {
+      if ( argc-iarg < 2 ) {
+	throw std::runtime_error("The -fifo argument was not provided.");
+      }
+      fifo_prefix = argv[iarg+1];
+      iarg += 2;
+    }
+    else if ( strcmp(argv[iarg],"-mdi") == 0 ) {
+
+      // Ensure that the argument to the -mdi option was provided
+      if ( argc-iarg < 2 ) {
+	throw std::runtime_error("The -mdi argument was not provided.");
+      }
+
+      // Initialize the MDI Library
+      int ret = MDI_Init(argv[iarg+1], NULL);
+      if ( ret != 0 ) {
+	throw std::runtime_error("The MDI library was not initialized correctly.");
+      }
+      initialized_mdi = true;
+      iarg += 2;
+
+    }
+    else if ( strcmp(argv[iarg],"-hangup") == 0 ) {
+      // act as an engine that closes its connection before sending its version number
+      hangup = true;
+      iarg += 1;
+    }
+    else if ( strcmp(argv[iarg],"-perturb") == 0 ) {
+      perturb = true;
+      iarg += 1;
+    }
+    else if ( strcmp(argv[iarg],"-nsteps") == 0 ) {
+      if ( argc-iarg < 2 ) {
+	throw std::runtime_error("The -nsteps argument was not provided.");
+      }
+      nsteps = atoi(argv[iarg+1]);
+      iarg += 2;
+    }
+    else {
+      throw std::runtime_error("Unrecognized option.");
+    }
+
+  }
+  if ( hangup ) {
+    void* connection;
+    if ( fifo_connect(NULL, &connection) != 0 ) {
+      throw std::runtime_error("Unable to connect to the driver.");
+    }
+    int version[3];
+    fifo_recv(version, sizeof(version), connection);
+    fifo_delete(connection);
+    return 0;
+  }
+  if ( not initialized_mdi ) {
+    throw std::runtime_error("The -mdi command line option was not provided.");
+  }
+
+  // Connect to the other code
+  int role;
+  MDI_Get_role(&role);
+  MDI_Comm comm;
+  MDI_Accept_communicator(&comm);
+  if ( comm == MDI_COMM_NULL && role == MDI_DRIVER ) {
+    // a connection that failed must never be returned by a later call
+    MDI_Accept_communicator(&comm);
+    std::cout << " Accepted: " << ( comm == MDI_COMM_NULL ? "none" : "failed connection" ) << std::endl;
+    return 0;
+  }
+  if ( comm == MDI_COMM_NULL ) {
+    throw std::runtime_error("No connection was accepted.");
+  }
+
+  if ( role == MDI_DRIVER ) {
+    run_driver(comm, nsteps, perturb);
+  }
+  else {
+    run_engine(comm);
+  }
+
+  return 0;
+}
@@ -0,0 +1,110 @@
+#include <iostream>
+#include <stdexcept>
+#include <vector>
+#include <string.h>
+#include <stdlib.h>
+#include "mdi.h"
+
+// Query the registries of several identical engines
+// The same executable acts as either the driver or an engine, depending on its role
+
+// Register the nodes, commands, and callbacks of the engine
+void register_engine() {
+  MDI_Register_node("@DEFAULT");
+  MDI_Register_command("@DEFAULT", "<COORDS");
+  MDI_Register_command("@DEFAULT", ">COORDS");
+  MDI_Register_command("@DEFAULT", "<FORCES");
+  MDI_Register_command("@DEFAULT", "@FORCES");
+  MDI_Register_command("@DEFAULT", "EXIT");
+  MDI_Register_node("@FORCES");
+  MDI_Register_command("@FORCES", "<FORCES");
+  MDI_Register_command("@FORCES", ">FORCES");
+  MDI_Register_command("@FORCES", "EXIT");
+  MDI_Register_callback("@FORCES", ">FORCES");
+}
+
+// Describe the registry of an engine
+void describe_engine(int iengine, MDI_Comm comm) {
+  int nnodes, ndefault, nforces, ncallbacks, exists, missing;
+  MDI_Get_nnodes(comm, &nnodes);
+  MDI_Get_ncommands("@DEFAULT", comm, &ndefault);
+  MDI_Get_ncommands("@FORCES", comm, &nforces);
+  MDI_Get_ncallbacks("@FORCES", comm, &ncallbacks);
+  MDI_Check_command_exists("@FORCES", ">FORCES", comm, &exists);
+  MDI_Check_command_exists("@DEFAULT", ">FORCES", comm, &missing);
+  char node[MDI_COMMAND_LENGTH];
+  MDI_Get_node(1, comm, node);
+  std::cout << " Engine " << iengine << ": " << nnodes << " nodes, " << ndefault << " + " << nforces
+            << " commands, " << ncallbacks << " callbacks, " << node << " " << exists << missing << std::endl;
+}
+
+int main(int argc, char **argv) {
+
+  // Read through all the command line options
+  int iarg = 1;
+  bool initialized_mdi = false;
+  int nengines = 1;
+  while ( iarg < argc ) {
+
+    if ( strcmp(argv[iarg],"-mdi") == 0 ) {
+
+      // Ensure that the argument to the -mdi option was provided
+      if ( argc-iarg < 2 ) {
+	throw std::runtime_error("The -mdi argument was not provided.");
+      }
+
+      // Initialize the MDI Library
+      int ret = MDI_Init(argv[iarg+1], NULL);
+      if ( ret != 0 ) {
+	throw std::runtime_error("The MDI library was not initialized correctly.");
+      }
+      initialized_mdi = true;
+      iarg += 2;
+
+    }
+    else if ( strcmp(argv[iarg],"-nengines") == 0 ) {
+      if ( argc-iarg < 2 ) {
+	throw std::runtime_error("The -nengines argument was not provided.");
+      }
+      nengines = atoi(argv[iarg+1]);
+      iarg += 2;
+    }
+    else {
+      throw std::runtime_error("Unrecognized option.");
+    }
+
+  }
+  if ( not initialized_mdi ) {
+    throw std::runtime_error("The -mdi command line option was not provided.");
+  }
+
+  int role;
+  MDI_Get_role(&role);
+  if ( role == MDI_ENGINE ) {
+    register_engine();
+    MDI_Comm comm;
+    MDI_Accept_communicator(&comm);
+    if ( MDI_Serve(comm) != 0 ) {
+      throw std::runtime_error("MDI_Serve failed.");
+    }
+    return 0;
+  }
+
+  // Connect to each engine
+  std::vector<MDI_Comm> comms(nengines);
+  for ( int iengine = 0; iengine < nengines; iengine++ ) {
+    MDI_Accept_communicator(&comms[iengine]);
+    if ( comms[iengine] == MDI_COMM_NULL ) {
+      throw std::runtime_error("No connection was accepted.");
+    }
+  }
+
+  for ( int iengine = 0; iengine < nengines; iengine++ ) {
+    describe_engine(iengine, comms[iengine]);
+  }
+  for ( int iengine = 0; iengine < nengines; iengine++ ) {
+    MDI_Send_command("EXIT", comms[iengine]);
+  }
+
+  return 0;
+}
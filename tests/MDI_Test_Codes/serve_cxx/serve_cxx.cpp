@@ -0,0 +1,388 @@
+#include <iostream>
+#include <chrono>
+#include <math.h>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#include <string.h>
+#include <stdlib.h>
+#include "mdi.h"
+
+// Respond to the commands of a driver through handlers registered with MDI_Register_Command_Handler
+// The same executable acts as either the driver or the engine, depending on its role
+// With the -link option, the driver also creates an engine that is linked to it as a library
+// With the -nsessions option, an engine that was initialized with -persistent serves several
+// drivers in turn, keeping its state between them, and moves on to the next driver if one of
+// them quits without sending EXIT
+// With the -hang option, the driver stops after its steps and waits to be killed, without
+// sending EXIT
+// With the -filter option, the driver sends the coordinates through MDI_Sendv and a filter stage
+// that doubles them, and checks that a segment rejected by the finite filter leaves the
+// connection usable
+// With the -nodes option, the driver moves the engine between two nodes, each of which has its
+// own handler for the <@ command
+// With the -reject option, the driver sends two messages after each >PAIR command, and the
+// engine's finite filter rejects the first of them on one step, which must not affect how the
+// second is decoded
+
+// Number of atoms of the engine
+static const int natoms = 10;
+
+// State of the engine, which is passed to each handler
+struct engine_state {
+  double coords[3 * natoms];
+  int nhandled;
+  int nrejected;
+  bool exit_flag;
+};
+
+int recv_coords(const char* command, MDI_Comm comm, void* ctx) {
+  engine_state* engine = (engine_state*) ctx;
+  engine->nhandled++;
+  return MDI_Recv(engine->coords, 3 * natoms, MDI_DOUBLE, comm);
+}
+
+int send_coords(const char* command, MDI_Comm comm, void* ctx) {
+  engine_state* engine = (engine_state*) ctx;
+  engine->nhandled++;
+  return MDI_Send(engine->coords, 3 * natoms, MDI_DOUBLE, comm);
+}
+
+int recv_segments(const char* command, MDI_Comm comm, void* ctx) {
+  engine_state* engine = (engine_state*) ctx;
+  engine->nhandled++;
+  void* bufs[2] = { engine->coords, engine->coords + 3 * natoms / 2 };
+  int64_t counts[2] = { 3 * natoms / 2, 3 * natoms - 3 * natoms / 2 };
+  MDI_Datatype datatypes[2] = { MDI_DOUBLE, MDI_DOUBLE };
+  return MDI_Recvv(2, bufs, counts, datatypes, comm);
+}
+
+int recv_pair(const char* command, MDI_Comm comm, void* ctx) {
+  engine_state* engine = (engine_state*) ctx;
+  engine->nhandled++;
+  double offsets[3 * natoms];
+  if ( MDI_Recv(offsets, 3 * natoms, MDI_DOUBLE, comm) != 0 ) {
+    engine->nrejected++;
+  }
+  return MDI_Recv(engine->coords, 3 * natoms, MDI_DOUBLE, comm);
+}
+
+int send_nrejected(const char* command, MDI_Comm comm, void* ctx) {
+  engine_state* engine = (engine_state*) ctx;
+  return MDI_Send(&engine->nrejected, 1, MDI_INT, comm);
+}
+
+int send_nhandled(const char* command, MDI_Comm comm, void* ctx) {
+  engine_state* engine = (engine_state*) ctx;
+  return MDI_Send(&engine->nhandled, 1, MDI_INT, comm);
+}
+
+int send_default_node(const char* command, MDI_Comm comm, void* ctx) {
+  char node_name[MDI_COMMAND_LENGTH] = "@DEFAULT";
+  return MDI_Send(node_name, MDI_COMMAND_LENGTH, MDI_CHAR, comm);
+}
+
+int send_forces_node(const char* command, MDI_Comm comm, void* ctx) {
+  char node_name[MDI_COMMAND_LENGTH] = "@FORCES";
+  return MDI_Send(node_name, MDI_COMMAND_LENGTH, MDI_CHAR, comm);
+}
+
+int exit_engine(const char* command, MDI_Comm comm, void* ctx) {
+  engine_state* engine = (engine_state*) ctx;
+  engine->exit_flag = true;
+  return 0;
+}
+
+// Register the nodes, commands, and handlers of the engine
+void register_handlers(engine_state* engine) {
+  MDI_Register_node("@DEFAULT");
+  if ( MDI_Register_command_handler("@DEFAULT", ">COORDS", recv_coords, engine) != 0 ||
+       MDI_Register_command_handler("@DEFAULT", "<COORDS", send_coords, engine) != 0 ||
+       MDI_Register_command_handler("@DEFAULT", ">SEGMENTS", recv_segments, engine) != 0 ||
+       MDI_Register_command_handler("@DEFAULT", ">PAIR", recv_pair, engine) != 0 ||
+       MDI_Register_command_handler("@DEFAULT", "<NREJECTED", send_nrejected, engine) != 0 ||
+       MDI_Register_command_handler("@DEFAULT", "<NHANDLED", send_nhandled, engine) != 0 ||
+       MDI_Register_command_handler("@DEFAULT", "EXIT", exit_engine, engine) != 0 ) {
+    throw std::runtime_error("The command handlers were not registered.");
+  }
+
+  // the same command has a different handler on each node
+  MDI_Register_node("@FORCES");
+  if ( MDI_Register_command_handler("@DEFAULT", "<@", send_default_node, engine) != 0 ||
+       MDI_Register_command_handler("@FORCES", "<@", send_forces_node, engine) != 0 ||
+       MDI_Register_command_handler("@FORCES", "EXIT", exit_engine, engine) != 0 ) {
+    throw std::runtime_error("The node handlers were not registered.");
+  }
+}
+
+// A filter stage that doubles each value, writing into a single buffer that it reuses, so that
+// its output is only valid until it is next called
+int double_send(const void** buf, int64_t count, MDI_Datatype datatype, MDI_Comm comm, void* state) {
+  std::vector<double>* doubled = (std::vector<double>*) state;
+  const double* values = (const double*) *buf;
+  doubled->resize(count);
+  for ( int64_t i = 0; i < count; i++ ) {
+    (*doubled)[i] = 2.0 * values[i];
+  }
+  *buf = doubled->data();
+  return 0;
+}
+
+// Send coordinates to the engine in two segments
+int send_segments(const double* coords, MDI_Comm comm) {
+  const void* bufs[2] = { coords, coords + 3 * natoms / 2 };
+  int64_t counts[2] = { 3 * natoms / 2, 3 * natoms - 3 * natoms / 2 };
+  MDI_Datatype datatypes[2] = { MDI_DOUBLE, MDI_DOUBLE };
+  return MDI_Sendv(2, bufs, counts, datatypes, comm);
+}
+
+// Ask the engine for the name of its current node
+std::string get_node(MDI_Comm comm) {
+  char node_name[MDI_COMMAND_LENGTH];
+  MDI_Send_command("<@", comm);
+  MDI_Recv(node_name, MDI_COMMAND_LENGTH, MDI_CHAR, comm);
+  return std::string(node_name);
+}
+
+// Exchange coordinates with the engine, and count the coordinates that are not returned intact
+void run_driver(MDI_Comm comm, int nsteps, bool filter, bool nodes, bool reject, bool hang) {
+  char name[MDI_NAME_LENGTH];
+  MDI_Send_command("<NAME", comm);
+  MDI_Recv(name, MDI_NAME_LENGTH, MDI_CHAR, comm);
+
+  std::vector<double> coords(3 * natoms);
+  std::vector<double> received(3 * natoms);
+  int mismatches = 0;
+  int rejected = 0;
+  std::vector<double> doubled;
+  if ( filter ) {
+    if ( MDI_Register_filter("double", double_send, NULL, &doubled) != 0 ||
+         MDI_Filter_push(comm, "finite") != 0 ||
+         MDI_Filter_push(comm, "double") != 0 ) {
+      throw std::runtime_error("The filters were not attached.");
+    }
+  }
+  for ( int istep = 0; istep < nsteps; istep++ ) {
+    for ( int icoord = 0; icoord < 3 * natoms; icoord++ ) {
+      coords[icoord] = double(istep) + 0.01 * double(icoord);
+    }
+    if ( filter ) {
+      // a value that is not finite is rejected before anything is sent, so the same command
+      // can then be completed with the intended values
+      MDI_Send_command(">SEGMENTS", comm);
+      if ( istep == 0 ) {
+        double saved = coords[3 * natoms - 1];
+        coords[3 * natoms - 1] = NAN;
+        if ( send_segments(coords.data(), comm) != 0 ) {
+          rejected++;
+        }
+        coords[3 * natoms - 1] = saved;
+      }
+      send_segments(coords.data(), comm);
+    }
+    else if ( reject ) {
+      // the first message is an offset copy of the coordinates, so that decoding the second
+      // message against the frame of the first would not return the coordinates
+      std::vector<double> offsets(3 * natoms);
+      for ( int icoord = 0; icoord < 3 * natoms; icoord++ ) {
+        offsets[icoord] = coords[icoord] + 100.0;
+      }
+      if ( istep == 2 ) {
+        offsets[3 * natoms - 1] = NAN;
+      }
+      MDI_Send_command(">PAIR", comm);
+      MDI_Send(offsets.data(), 3 * natoms, MDI_DOUBLE, comm);
+      MDI_Send(coords.data(), 3 * natoms, MDI_DOUBLE, comm);
+    }
+    else {
+      MDI_Send_command(">COORDS", comm);
+      MDI_Send(coords.data(), 3 * natoms, MDI_DOUBLE, comm);
+    }
+    MDI_Send_command("<COORDS", comm);
+    MDI_Recv(received.data(), 3 * natoms, MDI_DOUBLE, comm);
+    double factor = filter ? 2.0 : 1.0;
+    for ( int icoord = 0; icoord < 3 * natoms; icoord++ ) {
+      if ( received[icoord] != factor * coords[icoord] ) {
+        mismatches++;
+      }
+    }
+  }
+  if ( filter ) {
+    MDI_Filter_pop(comm);
+    MDI_Filter_pop(comm);
+  }
+
+  // the engine starts at its first node, and moves to each node that the driver names
+  std::string visited;
+  if ( nodes ) {
+    visited = get_node(comm);
+    MDI_Send_command("@FORCES", comm);
+    visited += " " + get_node(comm);
+    MDI_Send_command("@DEFAULT", comm);
+    visited += " " + get_node(comm);
+  }
+
+  if ( hang ) {
+    std::cout << " Steps: " << nsteps << std::endl;
+    while ( true ) {
+      std::this_thread::sleep_for(std::chrono::seconds(1));
+    }
+  }
+
+  int nhandled;
+  MDI_Send_command("<NHANDLED", comm);
+  MDI_Recv(&nhandled, 1, MDI_INT, comm);
+  int nrejected = 0;
+  if ( reject ) {
+    MDI_Send_command("<NREJECTED", comm);
+    MDI_Recv(&nrejected, 1, MDI_INT, comm);
+  }
+  MDI_Send_command("EXIT", comm);
+
+  std::cout << " Engine name: " << name << std::endl;
+  std::cout << " Steps: " << nsteps << std::endl;
+  std::cout << " Mismatches: " << mismatches << std::endl;
+  std::cout << " Handled: " << nhandled << std::endl;
+  if ( filter ) {
+    std::cout << " Rejected: " << rejected << std::endl;
+  }
+  if ( reject ) {
+    std::cout << " Rejected: " << nrejected << std::endl;
+  }
+  if ( nodes ) {
+    std::cout << " Nodes: " << visited << std::endl;
+  }
+}
+
+int main(int argc, char **argv) {
+
+  // Read through all the command line options
+  int iarg = 1;
+  bool initialized_mdi = false;
+  bool link = false;
+  int nsteps = 10;
+  int nsessions = 1;
+  bool filter = false;
+  bool nodes = false;
+  bool reject = false;
+  bool hang = false;
+  while ( iarg < argc ) {
+
+    if ( strcmp(argv[iarg],"-mdi") == 0 ) {
+
+      // Ensure that the argument to the -mdi option was provided
+      if ( argc-iarg < 2 ) {
+	throw std::runtime_error("The -mdi argument was not provided.");
+      }
+
+      // Initialize the MDI Library
+      int ret = MDI_Init(argv[iarg+1], NULL);
+      if ( ret != 0 ) {
+	throw std::runtime_error("The MDI library was not initialized correctly.");
+      }
+      initialized_mdi = true;
+      iarg += 2;
+
+    }
+    else if ( strcmp(argv[iarg],"-link") == 0 ) {
+      link = true;
+      iarg += 1;
+    }
+    else if ( strcmp(argv[iarg],"-nodes") == 0 ) {
+      nodes = true;
+      iarg += 1;
+    }
+    else if ( strcmp(argv[iarg],"-hang") == 0 ) {
+      hang = true;
+      iarg += 1;
+    }
+    else if ( strcmp(argv[iarg],"-reject") == 0 ) {
+      reject = true;
+      iarg += 1;
+    }
+    else if ( strcmp(argv[iarg],"-filter") == 0 ) {
+      filter = true;
+      iarg += 1;
+    }
+    else if ( strcmp(argv[iarg],"-nsteps") == 0 ) {
+      if ( argc-iarg < 2 ) {
+	throw std::runtime_error("The -nsteps argument was not provided.");
+      }
+      nsteps = atoi(argv[iarg+1]);
+      iarg += 2;
+    }
+    else if ( strcmp(argv[iarg],"-nsessions") == 0 ) {
+      if ( argc-iarg < 2 ) {
+	throw std::runtime_error("The -nsessions argument was not provided.");
+      }
+      nsessions = atoi(argv[iarg+1]);
+      iarg += 2;
+    }
+    else {
+      throw std::runtime_error("Unrecognized option.");
+    }
+
+  }
+  if ( not initialized_mdi ) {
+    throw std::runtime_error("The -mdi command line option was not provided.");
+  }
+
+  // Create an engine library, which responds to each command when the driver sends it
+  engine_state engine;
+  engine.nhandled = 0;
+  engine.nrejected = 0;
+  engine.exit_flag = false;
+  if ( link ) {
+    if ( MDI_Init("-role ENGINE -method LINK -name MM -driver_name driver", NULL) != 0 ) {
+      throw std::runtime_error("The engine library was not initialized correctly.");
+    }
+    register_handlers(&engine);
+    if ( MDI_Serve(MDI_COMM_NULL) != 0 ) {
+      throw std::runtime_error("MDI_Serve failed.");
+    }
+  }
+
+  // Connect to the other code
+  MDI_Comm comm;
+  MDI_Accept_communicator(&comm);
+  if ( comm == MDI_COMM_NULL ) {
+    throw std::runtime_error("No connection was accepted.");
+  }
+
+  int role;
+  MDI_Get_role(&role);
+  if ( role == MDI_DRIVER ) {
+    run_driver(comm, nsteps, filter, nodes, reject, hang);
+  }
+  else {
+    register_handlers(&engine);
+    if ( reject && MDI_Filter_push(comm, "finite") != 0 ) {
+      throw std::runtime_error("The finite filter was not attached.");
+    }
+    for ( int isession = 0; isession < nsessions; isession++ ) {
+
+      // a persistent engine connects to the next driver once the previous driver sends EXIT or quits
+      if ( isession > 0 ) {
+        engine.exit_flag = false;
+        MDI_Accept_communicator(&comm);
+        if ( comm == MDI_COMM_NULL ) {
+          throw std::runtime_error("No connection was accepted from the next driver.");
+        }
+      }
+
+      // only a driver that is followed by another one may quit without sending EXIT
+      if ( MDI_Serve(comm) != 0 && isession == nsessions - 1 ) {
+        throw std::runtime_error("MDI_Serve failed.");
+      }
+    }
+  }
+
+  if ( link || role == MDI_ENGINE ) {
+    if ( not engine.exit_flag ) {
+      throw std::runtime_error("The engine did not receive EXIT.");
+    }
+  }
+
+  return 0;
+}
@@ -0,0 +1,125 @@
+#include <iostream>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+#include <string.h>
+#include <stdlib.h>
+#include "mdi.h"
+
+// Drive one engine from each of several threads
+// Each thread creates its own context, in which it initializes both a driver and an engine
+// that are connected through the LINK method, so that the engines run concurrently
+
+// Number of atoms of each engine
+static const int natoms = 10;
+
+// State of an engine
+struct engine_state {
+  double coords[3 * natoms];
+};
+
+// Respond to a command sent to an engine
+int execute_command(const char* command, MDI_Comm comm, void* class_obj) {
+  engine_state* engine = (engine_state*) class_obj;
+  if ( strcmp(command, ">COORDS") == 0 ) {
+    MDI_Recv(engine->coords, 3 * natoms, MDI_DOUBLE, comm);
+  }
+  else if ( strcmp(command, "<COORDS") == 0 ) {
+    MDI_Send(engine->coords, 3 * natoms, MDI_DOUBLE, comm);
+  }
+  else if ( strcmp(command, "EXIT") != 0 ) {
+    throw std::runtime_error("Unrecognized command.");
+  }
+  return 0;
+}
+
+// Exchange coordinates with an engine, and count the coordinates that are not returned intact
+void drive_engine(int ithread, int nsteps, int* mismatches) {
+  MDI_Context context;
+  if ( MDI_Context_create(&context) != 0 ) {
+    throw std::runtime_error("Unable to create context.");
+  }
+
+  // Initialize a driver and an engine within the context
+  if ( MDI_Init_ctx(context, "-role DRIVER -name driver -method LINK", NULL) != 0 ) {
+    throw std::runtime_error("The driver was not initialized correctly.");
+  }
+  if ( MDI_Init_ctx(context, "-role ENGINE -name MM -method LINK -driver_name driver", NULL) != 0 ) {
+    throw std::runtime_error("The engine was not initialized correctly.");
+  }
+  engine_state engine;
+  MDI_Set_execute_command_func_ctx(context, execute_command, &engine);
+
+  // Connect to the engine
+  MDI_Comm comm;
+  MDI_Accept_communicator_ctx(context, &comm);
+
+  std::vector<double> coords(3 * natoms);
+  std::vector<double> received(3 * natoms);
+  *mismatches = 0;
+  for ( int istep = 0; istep < nsteps; istep++ ) {
+    for ( int icoord = 0; icoord < 3 * natoms; icoord++ ) {
+      coords[icoord] = 1000.0 * double(ithread) + double(istep) + 0.01 * double(icoord);
+    }
+    MDI_Send_command_ctx(context, ">COORDS", comm);
+    MDI_Send_ctx(context, coords.data(), 3 * natoms, MDI_DOUBLE, comm);
+    MDI_Send_command_ctx(context, "<COORDS", comm);
+    MDI_Recv_ctx(context, received.data(), 3 * natoms, MDI_DOUBLE, comm);
+    for ( int icoord = 0; icoord < 3 * natoms; icoord++ ) {
+      if ( received[icoord] != coords[icoord] ) {
+	(*mismatches)++;
+      }
+    }
+  }
+
+  // Send the "EXIT" command to the engine
+  MDI_Send_command_ctx(context, "EXIT", comm);
+  MDI_Context_free(context);
+}
+
+int main(int argc, char **argv) {
+
+  // Read through all the command line options
+  int iarg = 1;
+  int nthreads = 4;
+  int nsteps = 1000;
+  while ( iarg < argc ) {
+
+    if ( strcmp(argv[iarg],"-nthreads") == 0 ) {
+      if ( argc-iarg < 2 ) {
+	throw std::runtime_error("The -nthreads argument was not provided.");
+      }
+      nthreads = atoi(argv[iarg+1]);
+      iarg += 2;
+    }
+    else if ( strcmp(argv[iarg],"-nsteps") == 0 ) {
+      if ( argc-iarg < 2 ) {
+	throw std::runtime_error("The -nsteps argument was not provided.");
+      }
+      nsteps = atoi(argv[iarg+1]);
+      iarg += 2;
+    }
+    else {
+      throw std::runtime_error("Unrecognized option.");
+    }
+
+  }
+
+  // Drive one engine from each thread
+  std::vector<std::thread> threads;
+  std::vector<int> mismatches(nthreads, 0);
+  for ( int ithread = 0; ithread < nthreads; ithread++ ) {
+    threads.push_back(std::thread(drive_engine, ithread, nsteps, &mismatches[ithread]));
+  }
+  int total_mismatches = 0;
+  for ( int ithread = 0; ithread < nthreads; ithread++ ) {
+    threads[ithread].join();
+    total_mismatches += mismatches[ithread];
+  }
+
+  std::cout << " Threads: " << nthreads << std::endl;
+  std::cout << " Steps: " << nsteps << std::endl;
+  std::cout << " Mismatches: " << total_mismatches << std::endl;
+
+  return 0;
+}
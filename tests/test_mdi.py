@@ -23,6 +23,11 @@ driver_out_expected_f90 = """ Engine name: MM
  CALLBACK: >FORCES
 """
 
+# Output expected from the drivers that exercise the array transfer functions of each binding,
+# for each value of their -test option
+def driver_api_out_expected(*checks):
+    return " Engine name: MM\n" + "".join([ " " + check + ": OK\n" for check in checks ])
+
 # Output expected from each of the drivers
 driver_out_expected_py = """ Engine name: MM
 NNODES: 2
@@ -50,6 +55,34 @@ def format_return(input_string):
 
     return my_string
 
+def run_api_driver(driver_command, test):
+    # get the name of the engine code, which includes a .exe extension on Windows
+    engine_name = glob.glob("../build/engine_cxx*")[0]
+
+    # run the calculation
+    driver_proc = subprocess.Popen(driver_command + ["-mdi", "-role DRIVER -name driver -method TCP -port 8021", "-test", test],
+                                   stdout=subprocess.PIPE, stderr=subprocess.PIPE, cwd=build_dir)
+    engine_proc = subprocess.Popen([engine_name, "-mdi", "-role ENGINE -name MM -method TCP -port 8021 -hostname localhost"])
+    driver_tup = driver_proc.communicate()
+    engine_proc.communicate()
+
+    # convert the driver's output into a string
+    driver_out = format_return(driver_tup[0])
+    driver_err = format_return(driver_tup[1])
+
+    assert driver_err == ""
+    return driver_out
+
+def run_api_driver_f90(test):
+    # get the name of the driver code, which includes a .exe extension on Windows
+    driver_name = glob.glob("../build/driver_api_f90*")[0]
+    return run_api_driver([driver_name], test)
+
+def run_api_driver_py(test):
+    # the array transfer functions of the Python binding require numpy
+    pytest.importorskip("numpy")
+    return run_api_driver([sys.executable, "../build/driver_api_py.py"], test)
+
 ##########################
 # LIBRARY Method         #
 ##########################
@@ -76,6 +109,22 @@ def test_cxx_cxx_lib():
     assert driver_err == ""
     assert driver_out == " Engine name: MM\n"
 
+def test_cxx_threads():
+    # get the name of the driver code, which includes a .exe extension on Windows
+    driver_name = glob.glob("../build/threads_cxx*")[0]
+
+    # drive one engine from each thread, with each thread using its own context
+    driver_proc = subprocess.Popen([driver_name, "-nthreads", "8", "-nsteps", "1000"],
+                                   stdout=subprocess.PIPE, stderr=subprocess.PIPE)
+    driver_tup = driver_proc.communicate()
+
+    # convert the driver's output into a string
+    driver_out = format_return(driver_tup[0])
+    driver_err = format_return(driver_tup[1])
+
+    assert driver_err == ""
+    assert driver_out == " Threads: 8\n Steps: 1000\n Mismatches: 0\n"
+
 def test_cxx_py_lib_mpi():
     # run the calculation
     driver_name = glob.glob("../build/driver_lib_cxx_py*")[0]
@@ -224,6 +273,101 @@ def test_cxx_cxx_mpi_serial():
     assert driver_out == " Engine name: MM\n"
     assert driver_err == ""
 
+def test_cxx_cxx_mpi_strided():
+    # get the names of the driver and engine codes, which include a .exe extension on Windows
+    driver_name = glob.glob("../build/driver_loop_cxx*")[0]
+    engine_name = glob.glob("../build/engine_cxx*")[0]
+
+    # run the calculation
+    driver_proc = subprocess.Popen(["mpiexec","-n","1",driver_name, "-mdi", "-role DRIVER -name driver -method MPI",
+                                    "-nsteps", "1", "-grid", "1024", "-strided",":",
+                                    "-n","1",engine_name,"-mdi","-role ENGINE -name MM -method MPI"],
+                                   stdout=subprocess.PIPE, stderr=subprocess.PIPE, cwd=build_dir)
+    driver_tup = driver_proc.communicate()
+
+    # convert the driver's output into a string
+    driver_out = format_return(driver_tup[0])
+    driver_err = format_return(driver_tup[1])
+
+    assert driver_out == " Steps: 1\n Mismatches: 0\n Grid mismatches: 0\n Strided mismatches: 0\n"
+    assert driver_err == ""
+
+def test_cxx_cxx_mpi_persistent():
+    # get the names of the driver and engine codes, which include a .exe extension on Windows
+    driver_name = glob.glob("../build/driver_loop_cxx*")[0]
+    engine_name = glob.glob("../build/engine_cxx*")[0]
+
+    # run the calculation
+    driver_proc = subprocess.Popen(["mpiexec","-n","1",driver_name, "-mdi", "-role DRIVER -name driver -method MPI",
+                                    "-nsteps", "20", "-persistent",":",
+                                    "-n","1",engine_name,"-mdi","-role ENGINE -name MM -method MPI"],
+                                   stdout=subprocess.PIPE, stderr=subprocess.PIPE, cwd=build_dir)
+    driver_tup = driver_proc.communicate()
+
+    # convert the driver's output into a string
+    driver_out = format_return(driver_tup[0])
+    driver_err = format_return(driver_tup[1])
+
+    assert driver_out == " Steps: 20\n Mismatches: 0\n"
+    assert driver_err == ""
+
+def test_cxx_cxx_mpi_stream():
+    # get the names of the driver and engine codes, which include a .exe extension on Windows
+    driver_name = glob.glob("../build/driver_loop_cxx*")[0]
+    engine_name = glob.glob("../build/engine_cxx*")[0]
+
+    # run the calculation
+    driver_proc = subprocess.Popen(["mpiexec","-n","1",driver_name, "-mdi", "-role DRIVER -name driver -method MPI",
+                                    "-nsteps", "1", "-grid", "4096", "-stream",":",
+                                    "-n","1",engine_name,"-mdi","-role ENGINE -name MM -method MPI"],
+                                   stdout=subprocess.PIPE, stderr=subprocess.PIPE, cwd=build_dir)
+    driver_tup = driver_proc.communicate()
+
+    # convert the driver's output into a string
+    driver_out = format_return(driver_tup[0])
+    driver_err = format_return(driver_tup[1])
+
+    assert driver_out == " Steps: 1\n Mismatches: 0\n Grid mismatches: 0\n"
+    assert driver_err == ""
+
+def test_cxx_cxx_mpi_units():
+    # get the names of the driver and engine codes, which include a .exe extension on Windows
+    driver_name = glob.glob("../build/driver_loop_cxx*")[0]
+    engine_name = glob.glob("../build/engine_cxx*")[0]
+
+    # run the calculation
+    driver_proc = subprocess.Popen(["mpiexec","-n","1",driver_name, "-mdi", "-role DRIVER -name driver -method MPI",
+                                    "-nsteps", "20", "-units",":",
+                                    "-n","1",engine_name,"-mdi","-role ENGINE -name MM -method MPI"],
+                                   stdout=subprocess.PIPE, stderr=subprocess.PIPE, cwd=build_dir)
+    driver_tup = driver_proc.communicate()
+
+    # convert the driver's output into a string
+    driver_out = format_return(driver_tup[0])
+    driver_err = format_return(driver_tup[1])
+
+    assert driver_out == " Steps: 20\n Mismatches: 0\n"
+    assert driver_err == ""
+
+def test_cxx_cxx_mpi_vectored():
+    # get the names of the driver and engine codes, which include a .exe extension on Windows
+    driver_name = glob.glob("../build/driver_loop_cxx*")[0]
+    engine_name = glob.glob("../build/engine_cxx*")[0]
+
+    # run the calculation
+    driver_proc = subprocess.Popen(["mpiexec","-n","1",driver_name, "-mdi", "-role DRIVER -name driver -method MPI",
+                                    "-nsteps", "1", "-types", "64", "-vectored",":",
+                                    "-n","1",engine_name,"-mdi","-role ENGINE -name MM -method MPI"],
+                                   stdout=subprocess.PIPE, stderr=subprocess.PIPE, cwd=build_dir)
+    driver_tup = driver_proc.communicate()
+
+    # convert the driver's output into a string
+    driver_out = format_return(driver_tup[0])
+    driver_err = format_return(driver_tup[1])
+
+    assert driver_out == " Steps: 1\n Mismatches: 0\n Type mismatches: 0\n"
+    assert driver_err == ""
+
 def test_cxx_f90_mpi():
     # get the names of the driver and engine codes, which include a .exe extension on Windows
     driver_name = glob.glob("../build/driver_cxx*")[0]
@@ -415,6 +559,717 @@ def test_cxx_cxx_tcp():
     assert driver_err == ""
     assert driver_out == " Engine name: MM\n"
 
+def test_cxx_cxx_tcp_loop():
+    # get the names of the driver and engine codes, which include a .exe extension on Windows
+    driver_name = glob.glob("../build/driver_loop_cxx*")[0]
+    engine_name = glob.glob("../build/engine_cxx*")[0]
+
+    # run the calculation
+    driver_proc = subprocess.Popen([driver_name, "-mdi", "-role DRIVER -name driver -method TCP -port 8021"],
+                                   stdout=subprocess.PIPE, stderr=subprocess.PIPE)
+    engine_proc = subprocess.Popen([engine_name, "-mdi", "-role ENGINE -name MM -method TCP -port 8021 -hostname localhost"])
+    driver_tup = driver_proc.communicate()
+    engine_proc.communicate()
+
+    # convert the driver's output into a string
+    driver_out = format_return(driver_tup[0])
+    driver_err = format_return(driver_tup[1])
+
+    assert driver_err == ""
+    assert driver_out == " Steps: 100\n Mismatches: 0\n"
+
+def test_cxx_cxx_tcp_delta():
+    # get the names of the driver and engine codes, which include a .exe extension on Windows
+    driver_name = glob.glob("../build/driver_loop_cxx*")[0]
+    engine_name = glob.glob("../build/engine_cxx*")[0]
+
+    # run the calculation, with more steps than the keyframe interval
+    driver_proc = subprocess.Popen([driver_name, "-mdi", "-role DRIVER -name driver -method TCP -port 8021 -delta", "-nsteps", "200"],
+                                   stdout=subprocess.PIPE, stderr=subprocess.PIPE)
+    engine_proc = subprocess.Popen([engine_name, "-mdi", "-role ENGINE -name MM -method TCP -port 8021 -hostname localhost -delta"])
+    driver_tup = driver_proc.communicate()
+    engine_proc.communicate()
+
+    # convert the driver's output into a string
+    driver_out = format_return(driver_tup[0])
+    driver_err = format_return(driver_tup[1])
+
+    assert driver_err == ""
+    assert driver_out == " Steps: 200\n Mismatches: 0\n"
+
+def test_cxx_cxx_tcp_compress():
+    # get the names of the driver and engine codes, which include a .exe extension on Windows
+    driver_name = glob.glob("../build/driver_loop_cxx*")[0]
+    engine_name = glob.glob("../build/engine_cxx*")[0]
+
+    # run the calculation, with a fixed compression threshold for the driver and a calibrated threshold for the engine
+    driver_proc = subprocess.Popen([driver_name, "-mdi", "-role DRIVER -name driver -method TCP -port 8021 -compress -compress_threshold 1024",
+                                    "-nsteps", "10", "-grid", "65536"],
+                                   stdout=subprocess.PIPE, stderr=subprocess.PIPE)
+    engine_proc = subprocess.Popen([engine_name, "-mdi", "-role ENGINE -name MM -method TCP -port 8021 -hostname localhost -compress"])
+    driver_tup = driver_proc.communicate()
+    engine_proc.communicate()
+
+    # convert the driver's output into a string
+    driver_out = format_return(driver_tup[0])
+    driver_err = format_return(driver_tup[1])
+
+    assert driver_err == ""
+    assert driver_out == " Steps: 10\n Mismatches: 0\n Grid mismatches: 0\n"
+
+def test_cxx_cxx_tcp_precision():
+    # get the names of the driver and engine codes, which include a .exe extension on Windows
+    driver_name = glob.glob("../build/driver_loop_cxx*")[0]
+    engine_name = glob.glob("../build/engine_cxx*")[0]
+
+    # run the calculation with each reduced precision, each of which round-trips twice
+    for precision, tolerance in [ ("float", "1.2e-7"), ("bfloat16", "7.9e-3") ]:
+        driver_proc = subprocess.Popen([driver_name, "-mdi", "-role DRIVER -name driver -method TCP -port 8021 -precision " + precision,
+                                        "-nsteps", "10", "-grid", "1024", "-tolerance", tolerance],
+                                       stdout=subprocess.PIPE, stderr=subprocess.PIPE)
+        engine_proc = subprocess.Popen([engine_name, "-mdi", "-role ENGINE -name MM -method TCP -port 8021 -hostname localhost -precision " + precision])
+        driver_tup = driver_proc.communicate()
+        engine_proc.communicate()
+
+        # convert the driver's output into a string
+        driver_out = format_return(driver_tup[0])
+        driver_err = format_return(driver_tup[1])
+
+        assert driver_err == ""
+        assert driver_out == " Steps: 10\n Mismatches: 0\n Grid mismatches: 0\n"
+
+def test_cxx_cxx_tcp_types():
+    # get the names of the driver and engine codes, which include a .exe extension on Windows
+    driver_name = glob.glob("../build/driver_loop_cxx*")[0]
+    engine_name = glob.glob("../build/engine_cxx*")[0]
+
+    # run the calculation both without and with the optional codecs
+    for options in [ "", " -delta -compress -compress_threshold 64" ]:
+        driver_proc = subprocess.Popen([driver_name, "-mdi", "-role DRIVER -name driver -method TCP -port 8021" + options,
+                                        "-nsteps", "1", "-types", "64"],
+                                       stdout=subprocess.PIPE, stderr=subprocess.PIPE)
+        engine_proc = subprocess.Popen([engine_name, "-mdi", "-role ENGINE -name MM -method TCP -port 8021 -hostname localhost" + options])
+        driver_tup = driver_proc.communicate()
+        engine_proc.communicate()
+
+        # convert the driver's output into a string
+        driver_out = format_return(driver_tup[0])
+        driver_err = format_return(driver_tup[1])
+
+        assert driver_err == ""
+        assert driver_out == " Steps: 1\n Mismatches: 0\n Type mismatches: 0\n"
+
+def test_cxx_cxx_tcp_strided():
+    # get the names of the driver and engine codes, which include a .exe extension on Windows
+    driver_name = glob.glob("../build/driver_loop_cxx*")[0]
+    engine_name = glob.glob("../build/engine_cxx*")[0]
+
+    # run the calculation both without and with the optional codecs
+    for options in [ "", " -delta -compress -compress_threshold 64" ]:
+        driver_proc = subprocess.Popen([driver_name, "-mdi", "-role DRIVER -name driver -method TCP -port 8021" + options,
+                                        "-nsteps", "1", "-grid", "65536", "-strided"],
+                                       stdout=subprocess.PIPE, stderr=subprocess.PIPE)
+        engine_proc = subprocess.Popen([engine_name, "-mdi", "-role ENGINE -name MM -method TCP -port 8021 -hostname localhost" + options])
+        driver_tup = driver_proc.communicate()
+        engine_proc.communicate()
+
+        # convert the driver's output into a string
+        driver_out = format_return(driver_tup[0])
+        driver_err = format_return(driver_tup[1])
+
+        assert driver_err == ""
+        assert driver_out == " Steps: 1\n Mismatches: 0\n Grid mismatches: 0\n Strided mismatches: 0\n"
+
+def test_cxx_cxx_tcp_vectored():
+    # get the names of the driver and engine codes, which include a .exe extension on Windows
+    driver_name = glob.glob("../build/driver_loop_cxx*")[0]
+    engine_name = glob.glob("../build/engine_cxx*")[0]
+
+    # run the calculation
+    driver_proc = subprocess.Popen([driver_name, "-mdi", "-role DRIVER -name driver -method TCP -port 8021",
+                                    "-nsteps", "1", "-types", "64", "-vectored"],
+                                   stdout=subprocess.PIPE, stderr=subprocess.PIPE)
+    engine_proc = subprocess.Popen([engine_name, "-mdi", "-role ENGINE -name MM -method TCP -port 8021 -hostname localhost"])
+    driver_tup = driver_proc.communicate()
+    engine_proc.communicate()
+
+    # convert the driver's output into a string
+    driver_out = format_return(driver_tup[0])
+    driver_err = format_return(driver_tup[1])
+
+    assert driver_err == ""
+    assert driver_out == " Steps: 1\n Mismatches: 0\n Type mismatches: 0\n"
+
+def test_cxx_cxx_tcp_persistent():
+    # get the names of the driver and engine codes, which include a .exe extension on Windows
+    driver_name = glob.glob("../build/driver_loop_cxx*")[0]
+    engine_name = glob.glob("../build/engine_cxx*")[0]
+
+    # run the calculation both without and with the optional codecs
+    for options in [ "", " -delta -compress -compress_threshold 64" ]:
+        driver_proc = subprocess.Popen([driver_name, "-mdi", "-role DRIVER -name driver -method TCP -port 8021" + options,
+                                        "-nsteps", "20", "-persistent"],
+                                       stdout=subprocess.PIPE, stderr=subprocess.PIPE)
+        engine_proc = subprocess.Popen([engine_name, "-mdi", "-role ENGINE -name MM -method TCP -port 8021 -hostname localhost" + options])
+        driver_tup = driver_proc.communicate()
+        engine_proc.communicate()
+
+        # convert the driver's output into a string
+        driver_out = format_return(driver_tup[0])
+        driver_err = format_return(driver_tup[1])
+
+        assert driver_err == ""
+        assert driver_out == " Steps: 20\n Mismatches: 0\n"
+
+def test_cxx_cxx_tcp_stream():
+    # get the names of the driver and engine codes, which include a .exe extension on Windows
+    driver_name = glob.glob("../build/driver_loop_cxx*")[0]
+    engine_name = glob.glob("../build/engine_cxx*")[0]
+
+    # run the calculation both without and with the optional codecs
+    for options in [ "", " -delta -compress -compress_threshold 64" ]:
+        driver_proc = subprocess.Popen([driver_name, "-mdi", "-role DRIVER -name driver -method TCP -port 8021" + options,
+                                        "-nsteps", "1", "-grid", "65536", "-stream"],
+                                       stdout=subprocess.PIPE, stderr=subprocess.PIPE)
+        engine_proc = subprocess.Popen([engine_name, "-mdi", "-role ENGINE -name MM -method TCP -port 8021 -hostname localhost" + options])
+        driver_tup = driver_proc.communicate()
+        engine_proc.communicate()
+
+        # convert the driver's output into a string
+        driver_out = format_return(driver_tup[0])
+        driver_err = format_return(driver_tup[1])
+
+        assert driver_err == ""
+        assert driver_out == " Steps: 1\n Mismatches: 0\n Grid mismatches: 0\n"
+
+def test_cxx_bench_comms():
+    # get the name of the benchmark, which includes a .exe extension on Windows
+    bench_name = glob.glob("../build/bench_comms_cxx*")[0]
+
+    # run the benchmark with a reduced number of sends
+    bench_proc = subprocess.Popen([bench_name, "-mdi", "-role DRIVER -name driver -method TEST",
+                                   "-ncomms", "1000", "-nsends", "1000"],
+                                  stdout=subprocess.PIPE, stderr=subprocess.PIPE)
+    bench_tup = bench_proc.communicate()
+
+    # convert the benchmark's output into a string
+    bench_out = format_return(bench_tup[0])
+    bench_err = format_return(bench_tup[1])
+
+    assert bench_err == ""
+    assert bench_proc.returncode == 0
+    assert len(bench_out.splitlines()) == 5
+
+def test_cxx_bench_filter():
+    # get the name of the benchmark, which includes a .exe extension on Windows
+    bench_name = glob.glob("../build/bench_filter_cxx*")[0]
+
+    # run the benchmark with a reduced number of sends
+    bench_proc = subprocess.Popen([bench_name, "-mdi", "-role DRIVER -name driver -method TEST",
+                                   "-nsends", "1000", "-ntrials", "2"],
+                                  stdout=subprocess.PIPE, stderr=subprocess.PIPE)
+    bench_tup = bench_proc.communicate()
+
+    # convert the benchmark's output into a string
+    bench_out = format_return(bench_tup[0])
+    bench_err = format_return(bench_tup[1])
+
+    assert bench_err == ""
+    assert bench_proc.returncode == 0
+    assert len(bench_out.splitlines()) == 6
+
+def test_cxx_bench_plugin():
+    # get the name of the benchmark, which includes a .exe extension on Windows
+    bench_name = glob.glob("../build/bench_plugin_cxx*")[0]
+
+    # get the directory of the plugins
+    repo_path = os.path.dirname( os.path.dirname(os.path.realpath(__file__)) )
+    build_path = os.path.join( repo_path, "build" )
+
+    # run the benchmark with a reduced number of launches
+    bench_proc = subprocess.Popen([bench_name, "-mdi",
+                                   "-role DRIVER -name driver -method LINK -plugin_path " + str(build_path),
+                                   "-nlaunches", "20"],
+                                  stdout=subprocess.PIPE, stderr=subprocess.PIPE)
+    bench_tup = bench_proc.communicate()
+
+    # convert the benchmark's output into a string
+    bench_out = format_return(bench_tup[0])
+    bench_err = format_return(bench_tup[1])
+
+    # the benchmark checks the state of the engine after each launch in each cache mode
+    assert bench_err == ""
+    assert bench_proc.returncode == 0
+    assert [ line.split()[0] for line in bench_out.splitlines()[1:] ] == ["unload", "resident", "keepalive"]
+
+def test_cxx_plugin_failed_init():
+    # get the name of the benchmark, which includes a .exe extension on Windows
+    bench_name = glob.glob("../build/bench_plugin_cxx*")[0]
+
+    # get the directory of the plugins
+    repo_path = os.path.dirname( os.path.dirname(os.path.realpath(__file__)) )
+    build_path = os.path.join( repo_path, "build" )
+
+    # make one launch fail in the init function of the plugin, and then launch the plugin again
+    bench_proc = subprocess.Popen([bench_name, "-mdi",
+                                   "-role DRIVER -name driver -method LINK -plugin_path " + str(build_path),
+                                   "-fail_init"],
+                                  stdout=subprocess.PIPE, stderr=subprocess.PIPE)
+    bench_tup = bench_proc.communicate()
+
+    # convert the benchmark's output into a string
+    bench_out = format_return(bench_tup[0])
+    bench_err = format_return(bench_tup[1])
+
+    assert bench_err == "MDI plugin init function returned non-zero exit code\n"
+    assert bench_proc.returncode == 0
+    assert bench_out == " Launches after a failed init: 3\n"
+
+def test_cxx_async_plugin():
+    # get the name of the driver code, which includes a .exe extension on Windows
+    driver_name = glob.glob("../build/async_plugin_cxx*")[0]
+
+    # get the directory of the plugins
+    repo_path = os.path.dirname( os.path.dirname(os.path.realpath(__file__)) )
+    build_path = os.path.join( repo_path, "build" )
+
+    # drive several plugin instances in turn, and then all at once on worker threads
+    driver_proc = subprocess.Popen([driver_name, "-mdi",
+                                    "-role DRIVER -name driver -method LINK -plugin_path " + str(build_path),
+                                    "-ninstances", "4", "-nsteps", "3"],
+                                   stdout=subprocess.PIPE, stderr=subprocess.PIPE)
+    driver_tup = driver_proc.communicate()
+
+    # convert the driver's output into a string
+    driver_out = format_return(driver_tup[0])
+    driver_err = format_return(driver_tup[1])
+
+    # the output ends with the time taken each way
+    assert driver_err == ""
+    assert driver_proc.returncode == 0
+    assert driver_out.startswith(" Instances: 4\n Steps: 3\n Mismatches: 0\n")
+
+def test_cxx_async_plugin_coroutines():
+    # get the name of the driver code, which includes a .exe extension on Windows
+    driver_name = glob.glob("../build/async_plugin_cxx*")[0]
+
+    # get the directory of the plugins
+    repo_path = os.path.dirname( os.path.dirname(os.path.realpath(__file__)) )
+    build_path = os.path.join( repo_path, "build" )
+
+    # drive a thousand cheap plugin instances at once as coroutines
+    driver_proc = subprocess.Popen([driver_name, "-mdi",
+                                    "-role DRIVER -name driver -method LINK -plugin_path " + str(build_path),
+                                    "-ninstances", "1000", "-nsteps", "2", "-nterms", "10", "-coroutines"],
+                                   stdout=subprocess.PIPE, stderr=subprocess.PIPE)
+    driver_tup = driver_proc.communicate()
+
+    # convert the driver's output into a string
+    driver_out = format_return(driver_tup[0])
+    driver_err = format_return(driver_tup[1])
+
+    # the output ends with the time taken each way
+    assert driver_err == ""
+    assert driver_proc.returncode == 0
+    assert driver_out.startswith(" Instances: 1000\n Steps: 2\n Mismatches: 0\n")
+
+def test_cxx_plug_ensemble():
+    # get the name of the driver code, which includes a .exe extension on Windows
+    driver_name = glob.glob("../build/driver_plug_cxx*")[0]
+
+    # get the directory of the plugins
+    repo_path = os.path.dirname( os.path.dirname(os.path.realpath(__file__)) )
+    build_path = os.path.join( repo_path, "build" )
+
+    # share out more tasks than there are plugin instances
+    driver_proc = subprocess.Popen(["mpiexec","-n","4", driver_name, "-mdi",
+                                    "-role DRIVER -name driver -method LINK -plugin_path " + str(build_path),
+                                    "-driver_nranks", "1", "-plugin_nranks", "1",
+                                    "-plugin_name", "engine_cxx", "-ntasks", "20"],
+                                   stdout=subprocess.PIPE, stderr=subprocess.PIPE)
+    driver_tup = driver_proc.communicate()
+
+    # convert the driver's output into a string
+    driver_out = format_return(driver_tup[0])
+    driver_err = format_return(driver_tup[1])
+
+    assert driver_err == ""
+    assert driver_proc.returncode == 0
+    assert driver_out == " Instances: 3\n Tasks: 20\n Completed once: 20\n"
+
+def test_cxx_plug_ensemble_failed_task():
+    # get the name of the driver code, which includes a .exe extension on Windows
+    driver_name = glob.glob("../build/driver_plug_cxx*")[0]
+
+    # get the directory of the plugins
+    repo_path = os.path.dirname( os.path.dirname(os.path.realpath(__file__)) )
+    build_path = os.path.join( repo_path, "build" )
+
+    # one task fails, so its instance stops, and the other instances run the remaining tasks
+    driver_proc = subprocess.Popen(["mpiexec","-n","4", driver_name, "-mdi",
+                                    "-role DRIVER -name driver -method LINK -plugin_path " + str(build_path),
+                                    "-driver_nranks", "1", "-plugin_nranks", "1",
+                                    "-plugin_name", "engine_cxx", "-ntasks", "20", "-fail_task", "5"],
+                                   stdout=subprocess.PIPE, stderr=subprocess.PIPE)
+    driver_tup = driver_proc.communicate()
+
+    # convert the driver's output into a string
+    driver_out = format_return(driver_tup[0])
+    driver_err = format_return(driver_tup[1])
+
+    # both the driver and the instance that ran the failed task report the failure
+    assert "Error in MDI_Launch_plugin_ensemble: A task failed\n" in driver_err
+    assert "Error in MDI_Launch_plugin_ensemble: 1 tasks failed, and 0 tasks were not run\n" in driver_err
+    assert driver_proc.returncode == 0
+    assert driver_out == " Instances: 3\n Tasks: 20\n Completed once: 19\n Failed ranks: 2\n"
+
+@pytest.mark.skipif(not sys.platform.startswith('linux'),
+                    reason="the allocation count requires glibc")
+def test_cxx_alloc_count():
+    # get the name of the allocation count code
+    driver_name = glob.glob("../build/alloc_count_cxx*")[0]
+
+    # exchange coordinates with an engine in the same process
+    driver_proc = subprocess.Popen([driver_name, "-mdi", "-role DRIVER -name driver -method LINK",
+                                    "-nsteps", "100000"],
+                                   stdout=subprocess.PIPE, stderr=subprocess.PIPE, cwd=build_dir)
+    driver_tup = driver_proc.communicate()
+
+    # convert the driver's output into a string
+    driver_out = format_return(driver_tup[0])
+    driver_err = format_return(driver_tup[1])
+
+    assert driver_err == ""
+    assert driver_out == " Round trips: 100000\n Allocations: 0\n"
+
+@pytest.mark.skipif(not sys.platform.startswith('linux'),
+                    reason="the allocation count requires glibc")
+def test_cxx_cxx_tcp_alloc_count():
+    # get the names of the allocation count code and the engine
+    driver_name = glob.glob("../build/alloc_count_cxx*")[0]
+    engine_name = glob.glob("../build/engine_cxx*")[0]
+
+    # exchange coordinates with an engine in another process, both without and with the optional codecs
+    # the coordinates repeat every 64 steps, so the warm-up steps use every size of compressed message
+    for options in [ "", " -delta -compress -compress_threshold 64" ]:
+        driver_proc = subprocess.Popen([driver_name, "-mdi", "-role DRIVER -name driver -method TCP -port 8021" + options,
+                                        "-nwarmup", "64", "-nsteps", "16"],
+                                       stdout=subprocess.PIPE, stderr=subprocess.PIPE, cwd=build_dir)
+        engine_proc = subprocess.Popen([engine_name, "-mdi", "-role ENGINE -name MM -method TCP -port 8021 -hostname localhost" + options],
+                                       cwd=build_dir)
+        driver_tup = driver_proc.communicate()
+        engine_proc.communicate()
+
+        # convert the driver's output into a string
+        driver_out = format_return(driver_tup[0])
+        driver_err = format_return(driver_tup[1])
+
+        assert driver_err == ""
+        assert driver_out == " Round trips: 16\n Allocations: 0\n"
+
+@pytest.mark.skipif(sys.platform.startswith('win'),
+                    reason="the registered method communicates through named pipes")
+def test_cxx_cxx_registered_method():
+    # get the name of the code, which acts as both the driver and the engine
+    code_name = glob.glob("../build/method_fifo_cxx*")[0]
+
+    # run the calculation through a method registered with MDI_Register_Method
+    driver_proc = subprocess.Popen([code_name, "-fifo", "mdi_fifo_test", "-nsteps", "1000",
+                                    "-mdi", "-role DRIVER -name driver -method FIFO"],
+                                   stdout=subprocess.PIPE, stderr=subprocess.PIPE)
+    engine_proc = subprocess.Popen([code_name, "-fifo", "mdi_fifo_test",
+                                    "-mdi", "-role ENGINE -name MM -method FIFO"])
+    driver_tup = driver_proc.communicate()
+    engine_proc.communicate()
+
+    # convert the driver's output into a string
+    driver_out = format_return(driver_tup[0])
+    driver_err = format_return(driver_tup[1])
+
+    assert driver_err == ""
+    assert driver_out == " Engine name: MM\n Steps: 1000\n Mismatches: 0\n"
+    assert engine_proc.returncode == 0
+
+@pytest.mark.skipif(sys.platform.startswith('win'),
+                    reason="the registered method communicates through named pipes")
+def test_cxx_cxx_registered_method_delta():
+    # get the name of the code, which acts as both the driver and the engine
+    code_name = glob.glob("../build/method_fifo_cxx*")[0]
+
+    # send slightly perturbed coordinates, and observe the bodies that the registered method sends
+    nsteps = 200
+    stats = {}
+    for options in [ "", " -delta" ]:
+        driver_proc = subprocess.Popen([code_name, "-fifo", "mdi_fifo_delta", "-nsteps", str(nsteps), "-perturb",
+                                        "-mdi", "-role DRIVER -name driver -method FIFO" + options],
+                                       stdout=subprocess.PIPE, stderr=subprocess.PIPE)
+        engine_proc = subprocess.Popen([code_name, "-fifo", "mdi_fifo_delta",
+                                        "-mdi", "-role ENGINE -name MM -method FIFO" + options])
+        driver_tup = driver_proc.communicate()
+        engine_proc.communicate()
+
+        # convert the driver's output into a string
+        driver_out = format_return(driver_tup[0])
+        driver_err = format_return(driver_tup[1])
+
+        assert driver_err == ""
+        assert driver_out.startswith(" Engine name: MM\n Steps: " + str(nsteps) + "\n Mismatches: 0\n")
+        lines = driver_out.splitlines()
+        stats[options] = ( int(lines[3].split()[-1]), int(lines[4].split()[-1]) )
+
+    # without the codec, each body holds the 30 coordinates as they are
+    assert stats[""] == ( 0, nsteps * 30 * 8 )
+
+    # with the codec, every message except the first of every 64 is a delta frame, and the bodies shrink
+    delta_frames, body_bytes = stats[" -delta"]
+    assert delta_frames == nsteps - ( nsteps + 63 ) // 64
+    assert body_bytes < stats[""][1] // 2
+
+@pytest.mark.skipif(sys.platform.startswith('win'),
+                    reason="the registered method communicates through named pipes")
+def test_cxx_cxx_registered_method_hangup():
+    # get the name of the code, which acts as both the driver and the engine
+    code_name = glob.glob("../build/method_fifo_cxx*")[0]
+
+    # connect to an engine that closes its connection before sending its version number
+    driver_proc = subprocess.Popen([code_name, "-fifo", "mdi_fifo_hangup",
+                                    "-mdi", "-role DRIVER -name driver -method FIFO"],
+                                   stdout=subprocess.PIPE, stderr=subprocess.PIPE)
+    engine_proc = subprocess.Popen([code_name, "-fifo", "mdi_fifo_hangup", "-hangup"])
+    driver_tup = driver_proc.communicate()
+    engine_proc.communicate()
+
+    # convert the driver's output into a string
+    driver_out = format_return(driver_tup[0])
+    driver_err = format_return(driver_tup[1])
+
+    assert driver_err == "Error in MDI: The recv function of a registered method failed\nError in MDI: unable to exchange version numbers through a registered method\n"
+    assert driver_out == " Accepted: none\n"
+    assert driver_proc.returncode == 0
+
+def test_cxx_cxx_serve_link():
+    # get the name of the code, which acts as both the driver and an engine library
+    code_name = glob.glob("../build/serve_cxx*")[0]
+
+    # run the calculation, with each command dispatched to a handler by the driver
+    driver_proc = subprocess.Popen([code_name, "-link", "-nsteps", "100",
+                                    "-mdi", "-role DRIVER -name driver -method LINK"],
+                                   stdout=subprocess.PIPE, stderr=subprocess.PIPE)
+    driver_tup = driver_proc.communicate()
+
+    # convert the driver's output into a string
+    driver_out = format_return(driver_tup[0])
+    driver_err = format_return(driver_tup[1])
+
+    assert driver_err == ""
+    assert driver_out == " Engine name: MM\n Steps: 100\n Mismatches: 0\n Handled: 200\n"
+
+def test_cxx_cxx_serve_nodes():
+    # get the name of the code, which acts as both the driver and an engine library
+    code_name = glob.glob("../build/serve_cxx*")[0]
+
+    # move the engine between nodes that each have their own handler for the same command
+    driver_proc = subprocess.Popen([code_name, "-link", "-nodes", "-nsteps", "3",
+                                    "-mdi", "-role DRIVER -name driver -method LINK"],
+                                   stdout=subprocess.PIPE, stderr=subprocess.PIPE)
+    driver_tup = driver_proc.communicate()
+
+    # convert the driver's output into a string
+    driver_out = format_return(driver_tup[0])
+    driver_err = format_return(driver_tup[1])
+
+    assert driver_err == ""
+    assert driver_out == " Engine name: MM\n Steps: 3\n Mismatches: 0\n Handled: 6\n Nodes: @DEFAULT @FORCES @DEFAULT\n"
+
+def test_cxx_cxx_serve_reject_delta():
+    # get the name of the code, which acts as both the driver and the engine
+    code_name = glob.glob("../build/serve_cxx*")[0]
+
+    # the engine rejects one message of a command, and then decodes the delta-encoded message after it
+    driver_proc = subprocess.Popen([code_name, "-reject", "-nsteps", "5",
+                                    "-mdi", "-role DRIVER -name driver -method TCP -port 8021 -delta"],
+                                   stdout=subprocess.PIPE, stderr=subprocess.PIPE)
+    engine_proc = subprocess.Popen([code_name, "-reject",
+                                    "-mdi", "-role ENGINE -name MM -method TCP -port 8021 -hostname localhost -delta"],
+                                   stdout=subprocess.PIPE, stderr=subprocess.PIPE)
+    driver_tup = driver_proc.communicate()
+    engine_tup = engine_proc.communicate()
+
+    # convert the output into strings
+    driver_out = format_return(driver_tup[0])
+    driver_err = format_return(driver_tup[1])
+    engine_err = format_return(engine_tup[1])
+
+    assert driver_err == ""
+    assert engine_err == "Error in MDI: the finite filter found a value that is not finite\nError in MDI_Recv: A filter rejected the message\n"
+    assert driver_proc.returncode == 0
+    assert engine_proc.returncode == 0
+    assert driver_out == " Engine name: MM\n Steps: 5\n Mismatches: 0\n Handled: 10\n Rejected: 1\n"
+
+def test_cxx_cxx_serve_filter_vector():
+    # get the name of the code, which acts as both the driver and the engine
+    code_name = glob.glob("../build/serve_cxx*")[0]
+
+    # send vectored messages through filter stages, over both LINK and TCP
+    filter_err = "Error in MDI: the finite filter found a value that is not finite\nError in MDI_Send: A filter rejected the message\n"
+    for method in ["LINK", "TCP"]:
+        if method == "LINK":
+            driver_proc = subprocess.Popen([code_name, "-link", "-filter", "-nsteps", "5",
+                                            "-mdi", "-role DRIVER -name driver -method LINK"],
+                                           stdout=subprocess.PIPE, stderr=subprocess.PIPE)
+            driver_tup = driver_proc.communicate()
+        else:
+            driver_proc = subprocess.Popen([code_name, "-filter", "-nsteps", "5",
+                                            "-mdi", "-role DRIVER -name driver -method TCP -port 8021"],
+                                           stdout=subprocess.PIPE, stderr=subprocess.PIPE)
+            engine_proc = subprocess.Popen([code_name, "-mdi", "-role ENGINE -name MM -method TCP -port 8021 -hostname localhost"])
+            driver_tup = driver_proc.communicate()
+            engine_proc.communicate()
+            assert engine_proc.returncode == 0
+
+        # convert the driver's output into a string
+        driver_out = format_return(driver_tup[0])
+        driver_err = format_return(driver_tup[1])
+
+        # the rejected segment is reported, and the doubled coordinates are returned intact
+        assert driver_err == filter_err
+        assert driver_proc.returncode == 0
+        assert driver_out == " Engine name: MM\n Steps: 5\n Mismatches: 0\n Handled: 10\n Rejected: 1\n"
+
+def test_cxx_cxx_registry_cache():
+    # get the name of the code, which acts as both the driver and the engines
+    code_name = glob.glob("../build/regcache_cxx*")[0]
+    cache_file = "regcache_test.bin"
+    if os.path.exists(cache_file):
+        os.remove(cache_file)
+
+    engine_out = " 2 nodes, 5 + 3 commands, 1 callbacks, @FORCES 10\n"
+    cache_sizes = []
+    for nengines in [1, 2]:
+        driver_proc = subprocess.Popen([code_name, "-nengines", str(nengines),
+                                        "-mdi", "-role DRIVER -name driver -method TCP -port 8021 -registry_cache " + cache_file],
+                                       stdout=subprocess.PIPE, stderr=subprocess.PIPE)
+        engine_procs = [ subprocess.Popen([code_name, "-mdi", "-role ENGINE -name MM -method TCP -port 8021 -hostname localhost"])
+                         for iengine in range(nengines) ]
+        driver_tup = driver_proc.communicate()
+        for engine_proc in engine_procs:
+            engine_proc.communicate()
+            assert engine_proc.returncode == 0
+
+        # convert the driver's output into a string
+        driver_out = format_return(driver_tup[0])
+        driver_err = format_return(driver_tup[1])
+
+        assert driver_err == ""
+        assert driver_out == "".join( [ " Engine " + str(iengine) + ":" + engine_out for iengine in range(nengines) ] )
+        cache_sizes.append(os.path.getsize(cache_file))
+
+    # the identical engines share a single cached registry, which the second run reads from the file
+    assert cache_sizes[0] > 0
+    assert cache_sizes[1] == cache_sizes[0]
+    os.remove(cache_file)
+
+def test_cxx_serve_tcp():
+    # get the name of the code, which acts as both the driver and the engine
+    code_name = glob.glob("../build/serve_cxx*")[0]
+
+    # run the calculation with engines written in C++ and Python, each of which calls MDI_Serve
+    for engine in [ [code_name], [sys.executable, "serve_py.py"] ]:
+        driver_proc = subprocess.Popen([code_name, "-nsteps", "5",
+                                        "-mdi", "-role DRIVER -name driver -method TCP -port 8021"],
+                                       stdout=subprocess.PIPE, stderr=subprocess.PIPE)
+        engine_proc = subprocess.Popen(engine + ["-mdi", "-role ENGINE -name MM -method TCP -port 8021 -hostname localhost"],
+                                       cwd=build_dir)
+        driver_tup = driver_proc.communicate()
+        engine_proc.communicate()
+
+        # convert the driver's output into a string
+        driver_out = format_return(driver_tup[0])
+        driver_err = format_return(driver_tup[1])
+
+        assert driver_err == ""
+        assert driver_out == " Engine name: MM\n Steps: 5\n Mismatches: 0\n Handled: 10\n"
+        assert engine_proc.returncode == 0
+
+def test_cxx_serve_persistent_tcp():
+    # get the name of the code, which acts as both the driver and the engine
+    code_name = glob.glob("../build/serve_cxx*")[0]
+
+    # run two drivers in turn, each served by the same persistent engine written in C++ or Python
+    for engine in [ [code_name], [sys.executable, "serve_py.py"] ]:
+        engine_proc = subprocess.Popen(engine + ["-mdi", "-role ENGINE -name MM -method TCP -port 8021 -hostname localhost -persistent",
+                                                 "-nsessions", "2"],
+                                       cwd=build_dir)
+        for isession in range(2):
+            driver_proc = subprocess.Popen([code_name, "-nsteps", "5",
+                                            "-mdi", "-role DRIVER -name driver -method TCP -port 8021"],
+                                           stdout=subprocess.PIPE, stderr=subprocess.PIPE)
+            driver_tup = driver_proc.communicate()
+
+            # convert the driver's output into a string
+            driver_out = format_return(driver_tup[0])
+            driver_err = format_return(driver_tup[1])
+
+            # the engine keeps its count of handled commands from one driver to the next
+            assert driver_err == ""
+            assert driver_out == " Engine name: MM\n Steps: 5\n Mismatches: 0\n Handled: " + str(10 * (isession + 1)) + "\n"
+
+        engine_proc.communicate()
+        assert engine_proc.returncode == 0
+
+def test_cxx_cxx_serve_persistent_killed():
+    # get the name of the code, which acts as either the driver or the engine
+    code_name = glob.glob("../build/serve_cxx*")[0]
+
+    # the first driver is killed partway through its session, and a second driver then connects
+    engine_proc = subprocess.Popen([code_name, "-mdi", "-role ENGINE -name MM -method TCP -port 8021 -hostname localhost -persistent",
+                                    "-nsessions", "2"],
+                                   stdout=subprocess.PIPE, stderr=subprocess.PIPE)
+    driver_proc = subprocess.Popen([code_name, "-nsteps", "5", "-hang",
+                                    "-mdi", "-role DRIVER -name driver -method TCP -port 8021"],
+                                   stdout=subprocess.PIPE, stderr=subprocess.PIPE)
+    assert format_return(driver_proc.stdout.readline()) == " Steps: 5\n"
+    driver_proc.kill()
+    driver_proc.communicate()
+
+    driver_proc = subprocess.Popen([code_name, "-nsteps", "5",
+                                    "-mdi", "-role DRIVER -name driver -method TCP -port 8021"],
+                                   stdout=subprocess.PIPE, stderr=subprocess.PIPE)
+    driver_tup = driver_proc.communicate()
+    engine_tup = engine_proc.communicate()
+
+    # convert the output into strings
+    driver_out = format_return(driver_tup[0])
+    driver_err = format_return(driver_tup[1])
+    engine_err = format_return(engine_tup[1])
+
+    # the engine keeps the commands that it handled for the killed driver
+    assert driver_err == ""
+    assert driver_out == " Engine name: MM\n Steps: 5\n Mismatches: 0\n Handled: 20\n"
+    assert engine_err.startswith("Error reading from socket: server has quit or connection broke\n")
+    assert engine_proc.returncode == 0
+
+def test_cxx_cxx_tcp_units():
+    # get the names of the driver and engine codes, which include a .exe extension on Windows
+    driver_name = glob.glob("../build/driver_loop_cxx*")[0]
+    engine_name = glob.glob("../build/engine_cxx*")[0]
+
+    # run the calculation both without and with the optional codecs
+    for options in [ "", " -delta -compress -compress_threshold 64" ]:
+        driver_proc = subprocess.Popen([driver_name, "-mdi", "-role DRIVER -name driver -method TCP -port 8021" + options,
+                                        "-nsteps", "20", "-units"],
+                                       stdout=subprocess.PIPE, stderr=subprocess.PIPE)
+        engine_proc = subprocess.Popen([engine_name, "-mdi", "-role ENGINE -name MM -method TCP -port 8021 -hostname localhost" + options])
+        driver_tup = driver_proc.communicate()
+        engine_proc.communicate()
+
+        # convert the driver's output into a string
+        driver_out = format_return(driver_tup[0])
+        driver_err = format_return(driver_tup[1])
+
+        assert driver_err == ""
+        assert driver_out == " Steps: 20\n Mismatches: 0\n"
+
 def test_cxx_f90_tcp():
     # get the names of the driver and engine codes, which include a .exe extension on Windows
     driver_name = glob.glob("../build/driver_cxx*")[0]
@@ -495,6 +1350,30 @@ def test_f90_f90_tcp():
     assert driver_err == ""
     assert driver_out == driver_out_expected_f90
 
+def test_f90_cxx_tcp_api():
+    assert run_api_driver_f90("send_c") == driver_api_out_expected("Send_c")
+
+def test_f90_cxx_tcp_api_types():
+    assert run_api_driver_f90("types") == driver_api_out_expected("Types")
+
+def test_f90_cxx_tcp_api_strided():
+    assert run_api_driver_f90("strided") == driver_api_out_expected("Strided")
+
+def test_f90_cxx_tcp_api_sendv():
+    assert run_api_driver_f90("sendv") == driver_api_out_expected("Sendv")
+
+def test_f90_cxx_tcp_api_send_init():
+    assert run_api_driver_f90("send_init") == driver_api_out_expected("Send_init")
+
+def test_f90_cxx_tcp_api_stream():
+    assert run_api_driver_f90("stream") == driver_api_out_expected("Stream")
+
+def test_f90_cxx_tcp_api_units():
+    assert run_api_driver_f90("units") == driver_api_out_expected("Units")
+
+def test_f90_cxx_tcp_api_context():
+    assert run_api_driver_f90("context") == " Context: OK\n" + driver_api_out_expected("Send_c")
+
 def test_f90_py_tcp():
     global driver_out_expected_f90
 
@@ -536,6 +1415,30 @@ def test_py_cxx_tcp():
     assert driver_err == ""
     assert driver_out == driver_out_expected_py
 
+def test_py_cxx_tcp_api():
+    assert run_api_driver_py("send_c") == driver_api_out_expected("Send_c")
+
+def test_py_cxx_tcp_api_types():
+    assert run_api_driver_py("types") == driver_api_out_expected("Types", "Types_numpy")
+
+def test_py_cxx_tcp_api_strided():
+    assert run_api_driver_py("strided") == driver_api_out_expected("Strided")
+
+def test_py_cxx_tcp_api_sendv():
+    assert run_api_driver_py("sendv") == driver_api_out_expected("Sendv")
+
+def test_py_cxx_tcp_api_send_init():
+    assert run_api_driver_py("send_init") == driver_api_out_expected("Send_init")
+
+def test_py_cxx_tcp_api_stream():
+    assert run_api_driver_py("stream") == driver_api_out_expected("Stream")
+
+def test_py_cxx_tcp_api_units():
+    assert run_api_driver_py("units") == driver_api_out_expected("Units")
+
+def test_py_cxx_tcp_api_context():
+    assert run_api_driver_py("context") == " Context: OK\n" + driver_api_out_expected("Send_c")
+
 def test_py_f90_tcp():
     global driver_out_expected_py
 